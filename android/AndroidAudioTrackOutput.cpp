@@ -222,6 +222,26 @@ jmethodID getEncodingMethod(QJniEnvironment& env)
     return methodId;
 }
 
+jmethodID getSampleRateMethod(QJniEnvironment& env)
+{
+    static jmethodID methodId = nullptr;
+    if (methodId != nullptr) {
+        return methodId;
+    }
+
+    jclass klass = audioTrackPlayerClass(env);
+    if (klass == nullptr) {
+        return nullptr;
+    }
+
+    methodId = env->GetStaticMethodID(klass, "getSampleRate", "()I");
+    if (methodId == nullptr) {
+        env.checkAndClearExceptions();
+        qWarning() << "AndroidAudioTrackOutput: Failed to resolve getSampleRate()";
+    }
+    return methodId;
+}
+
 jmethodID setPlaybackRouteMethod(QJniEnvironment& env)
 {
     static jmethodID methodId = nullptr;
@@ -251,6 +271,8 @@ constexpr jint kEncodingPcmFloat = 4;
 
 AndroidAudioTrackOutput::AndroidAudioTrackOutput(AudioJitterBuffer* jitterBuffer)
     : m_jitterBuffer(jitterBuffer)
+    , m_sampleRate(AudioEngine::SAMPLE_RATE)
+    , m_timeStretcher(jitterBuffer, m_sampleRate)
 {
 }
 
@@ -306,6 +328,20 @@ bool AndroidAudioTrackOutput::start()
         }
     }
 
+    // The track runs at the mixer's rate when Opus can decode at it.
+    int sampleRate = AudioEngine::SAMPLE_RATE;
+    jmethodID sampleRateMethodId = getSampleRateMethod(env);
+    if (sampleRateMethodId != nullptr) {
+        const jint rate = env->CallStaticIntMethod(klass, sampleRateMethodId);
+        if (!env.checkAndClearExceptions() && rate > 0) {
+            sampleRate = static_cast<int>(rate);
+        }
+    }
+    if (sampleRate != m_sampleRate) {
+        m_sampleRate = sampleRate;
+        m_timeStretcher = AudioTimeStretcher(m_jitterBuffer, m_sampleRate);
+    }
+
     {
         std::lock_guard<std::mutex> lock(m_stateMutex);
         m_running = true;
@@ -314,7 +350,9 @@ bool AndroidAudioTrackOutput::start()
         m_useFloatPlayback = useFloat;
     }
 
-    qDebug() << "AndroidAudioTrackOutput: playback encoding =" << (useFloat ? "FLOAT" : "INT16");
+    qDebug() << "AndroidAudioTrackOutput: playback encoding =" << (useFloat ? "FLOAT" : "INT16")
+             << "at" << m_sampleRate << "Hz";
+    m_timeStretcher.reset();
     m_playbackThread = std::thread(&AndroidAudioTrackOutput::playbackLoop, this);
     return true;
 #else
@@ -471,7 +509,7 @@ void AndroidAudioTrackOutput::playbackLoop()
         }
     }
 
-    std::vector<float> frame(AudioEngine::FRAME_SIZE_SAMPLES, 0.0f);
+    std::vector<float> frame(static_cast<size_t>(m_sampleRate * AudioEngine::FRAME_SIZE_MS / 1000), 0.0f);
     auto nextWake = std::chrono::steady_clock::now();
 
     while (true) {
@@ -485,15 +523,9 @@ void AndroidAudioTrackOutput::playbackLoop()
             }
         }
 
-        int samplesToWrite = 0;
-        if (m_jitterBuffer != nullptr) {
-            samplesToWrite = static_cast<int>(std::min(
-                static_cast<unsigned>(frame.size()),
-                m_jitterBuffer->samplesReadyForPlayback()));
-            if (samplesToWrite > 0) {
-                samplesToWrite = m_jitterBuffer->readSamples(frame.data(), samplesToWrite);
-            }
-        }
+        // The stretcher nudges the buffer depth toward the prebuffer target
+        // and only returns fewer samples once the buffer is empty.
+        const int samplesToWrite = m_timeStretcher.read(frame.data(), static_cast<int>(frame.size()));
 
         if (samplesToWrite > 0) {
             writeSamplesBlocking(frame.data(), samplesToWrite);
@@ -2,6 +2,7 @@
 #define ANDROIDAUDIOTRACKOUTPUT_H
 
 #include <QString>
+#include "AudioTimeStretcher.h"
 #include <thread>
 #include <mutex>
 #include <condition_variable>
@@ -21,6 +22,8 @@ public:
     void resume();
     bool isActive() const;
     bool applyCurrentRoute();
+    // Rate of the running track, which the jitter buffer has to be fed at.
+    int sampleRate() const { return m_sampleRate; }
 
 private:
     void playbackLoop();
@@ -29,7 +32,10 @@ private:
     void releaseSampleArray();
     QString currentRoute() const;
 
-    AudioJitterBuffer* m_jitterBuffer = nullptr;
+    AudioJitterBuffer* m_jitterBuffer;
+    int m_sampleRate;
+    // Reads the jitter buffer; owned by the playback thread once it is running.
+    AudioTimeStretcher m_timeStretcher;
     mutable std::mutex m_stateMutex;
     std::condition_variable m_stateCondition;
     std::thread m_playbackThread;
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2025 Silviu YO6SAY
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "AudioCaptureQueue.h"
+
+#include <algorithm>
+#include <cstring>
+
+AudioCaptureQueue::AudioCaptureQueue(int capacityBlocks)
+{
+    uint32_t capacity = 1;
+    while (capacity < static_cast<uint32_t>(std::max(capacityBlocks, 1))) {
+        capacity <<= 1;
+    }
+    m_slots.resize(capacity);
+    m_mask = capacity - 1;
+}
+
+bool AudioCaptureQueue::push(const float* samples, int count, int sampleRate, int64_t captureUs)
+{
+    if (samples == nullptr || count <= 0 || sampleRate <= 0) {
+        return false;
+    }
+
+    for (int offset = 0; offset < count; offset += MAX_BLOCK_SAMPLES) {
+        Block* block = claimSlot();
+        if (block == nullptr) {
+            return false;
+        }
+        const int blockSamples = std::min(count - offset, MAX_BLOCK_SAMPLES);
+        std::memcpy(block->samples.data(), samples + offset, static_cast<size_t>(blockSamples) * sizeof(float));
+        publish(*block, blockSamples, sampleRate, captureUs);
+    }
+    return true;
+}
+
+bool AudioCaptureQueue::push(const short* samples, int count, int sampleRate, int64_t captureUs)
+{
+    if (samples == nullptr || count <= 0 || sampleRate <= 0) {
+        return false;
+    }
+
+    constexpr float kInt16Scale = 1.0f / 32768.0f;
+    for (int offset = 0; offset < count; offset += MAX_BLOCK_SAMPLES) {
+        Block* block = claimSlot();
+        if (block == nullptr) {
+            return false;
+        }
+        const int blockSamples = std::min(count - offset, MAX_BLOCK_SAMPLES);
+        for (int i = 0; i < blockSamples; ++i) {
+            block->samples[static_cast<size_t>(i)] = samples[offset + i] * kInt16Scale;
+        }
+        publish(*block, blockSamples, sampleRate, captureUs);
+    }
+    return true;
+}
+
+AudioCaptureQueue::Block* AudioCaptureQueue::claimSlot()
+{
+    const uint32_t head = m_head.load(std::memory_order_relaxed);
+    const uint32_t tail = m_tail.load(std::memory_order_acquire);
+    if (head - tail >= static_cast<uint32_t>(m_slots.size())) {
+        m_droppedBlocks.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    return &m_slots[head & m_mask];
+}
+
+void AudioCaptureQueue::publish(Block& block, int count, int sampleRate, int64_t captureUs)
+{
+    block.sampleRate = sampleRate;
+    block.count = count;
+    block.durationUs = static_cast<int64_t>(count) * 1000000 / sampleRate;
+    block.captureUs = captureUs;
+
+    m_queuedUs.fetch_add(block.durationUs, std::memory_order_relaxed);
+    m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+AudioCaptureQueue::Block* AudioCaptureQueue::front()
+{
+    const uint32_t tail = m_tail.load(std::memory_order_relaxed);
+    if (m_head.load(std::memory_order_acquire) == tail) {
+        return nullptr;
+    }
+    return &m_slots[tail & m_mask];
+}
+
+void AudioCaptureQueue::pop()
+{
+    const uint32_t tail = m_tail.load(std::memory_order_relaxed);
+    if (m_head.load(std::memory_order_acquire) != tail) {
+        m_queuedUs.fetch_sub(m_slots[tail & m_mask].durationUs, std::memory_order_relaxed);
+        m_tail.store(tail + 1, std::memory_order_release);
+    }
+}
+
+void AudioCaptureQueue::clear()
+{
+    while (front() != nullptr) {
+        pop();
+    }
+}
+
+int AudioCaptureQueue::size() const
+{
+    return static_cast<int>(m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire));
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2025 Silviu YO6SAY
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef AUDIOCAPTUREQUEUE_H
+#define AUDIOCAPTUREQUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Wait-free single-producer / single-consumer handoff of captured PCM
+// blocks from the native capture thread to the TX encode stage.
+//
+// Like AudioPacketQueue, every slot owns fixed sample storage allocated
+// once at construction, so pushing a capture block is a copy and nothing
+// is allocated per block.  16-bit capture is converted to float on the way
+// in, so the consumer sees one format; a block longer than a slot is split
+// across slots.  The consumer may process a block in place until it pops
+// it.  When the ring is full the newest audio is dropped and counted.
+class AudioCaptureQueue
+{
+public:
+    // 20 ms at 48 kHz, the block AndroidAudioRecordInput reads at that rate.
+    static constexpr int MAX_BLOCK_SAMPLES = 960;
+
+    struct Block {
+        int sampleRate = 0;
+        int count = 0;
+        int64_t durationUs = 0;
+        int64_t captureUs = 0;
+        std::array<float, MAX_BLOCK_SAMPLES> samples{};
+    };
+
+    explicit AudioCaptureQueue(int capacityBlocks = 32);
+
+    // Producer side.  False when some of the audio had to be dropped.
+    bool push(const float* samples, int count, int sampleRate, int64_t captureUs);
+    bool push(const short* samples, int count, int sampleRate, int64_t captureUs);
+    uint64_t droppedBlocks() const { return m_droppedBlocks.load(std::memory_order_relaxed); }
+
+    // Consumer side.  front() stays valid until pop().
+    Block* front();
+    void pop();
+    void clear();
+
+    int size() const;
+    int capacity() const { return static_cast<int>(m_slots.size()); }
+    // Audio queued, the front block included.
+    int64_t queuedUs() const { return m_queuedUs.load(std::memory_order_acquire); }
+
+private:
+    Block* claimSlot();
+    void publish(Block& block, int count, int sampleRate, int64_t captureUs);
+
+    std::vector<Block> m_slots;
+    uint32_t m_mask = 0;
+
+    std::atomic<uint32_t> m_head{0};
+    std::atomic<uint32_t> m_tail{0};
+    std::atomic<int64_t> m_queuedUs{0};
+    std::atomic<uint64_t> m_droppedBlocks{0};
+};
+
+#endif // AUDIOCAPTUREQUEUE_H
@@ -61,12 +61,20 @@ AudioEngine::AudioEngine(QObject *parent)
     m_meterDecayTimer->setInterval(60);
     connect(m_meterDecayTimer, &QTimer::timeout, this, &AudioEngine::onMeterDecayTimer);
 
+    // Playout clock for packets held behind a reorder gap
+    m_packetPlayoutTimer = new QTimer(this);
+    m_packetPlayoutTimer->setTimerType(Qt::PreciseTimer);
+    m_packetPlayoutTimer->setInterval(5);
+    connect(m_packetPlayoutTimer, &QTimer::timeout, this, &AudioEngine::onPacketPlayoutTimer);
+
     // Pre-allocate buffers for performance optimization
     m_reusableFloatBuffer.reserve(8192);  // Reserve space for large audio chunks
+    m_resampledInputBuffer.reserve(8192);
     m_reusableOpusBuffer.resize(OPUS_BUFFER_SIZE);
-    m_transcriptionPcmBuffer.reserve(FRAME_SIZE_SAMPLES);
-    m_txLeadInSilenceFrame.assign(FRAME_SIZE_SAMPLES, 0.0f);
-    m_txStartupBuffer.reserve(FRAME_SIZE_SAMPLES * 4);
+    m_transcriptionPcmBuffer.reserve(MAX_FRAME_SIZE_SAMPLES * CHANNELS);
+    m_rxFrameBuffer.resize(MAX_FRAME_SIZE_SAMPLES * CHANNELS);
+    m_txLeadInSilenceFrame.assign(MAX_FRAME_SIZE_SAMPLES, 0.0f);
+    configureTxBacklog();
 }
 
 AudioEngine::~AudioEngine()
@@ -134,7 +142,9 @@ void AudioEngine::updateMeterState(float level, float peak, float& currentLevel,
         }
     }
 
-    emit (this->*signal)(currentLevel, currentPeak);
+    if (signal != nullptr) {
+        emit (this->*signal)(currentLevel, currentPeak);
+    }
 }
 
 void AudioEngine::decayMeterState(float& currentLevel, float& currentPeak, qint64& lastUpdateMs,
@@ -188,11 +198,14 @@ void AudioEngine::updateRxMeter(const float* samples, int count)
     }
 
     const float rmsAmplitude = std::sqrt(sumSquares / static_cast<float>(count));
+    // Published from the meter timer: a queued signal per received frame
+    // would allocate on the decode path.
     updateMeterState(meterLevelFromAmplitude(rmsAmplitude),
                      meterLevelFromAmplitude(peakAmplitude),
                      m_rxMeterLevel, m_rxMeterPeakLevel,
                      m_rxMeterLastUpdateMs, m_rxMeterPeakHoldUntilMs,
-                     &AudioEngine::rxMeterLevelsChanged);
+                     nullptr);
+    m_rxMeterPending = true;
 }
 
 void AudioEngine::updateTxMeter(const float* samples, int count)
@@ -210,11 +223,16 @@ void AudioEngine::updateTxMeter(const float* samples, int count)
     }
 
     const float rmsAmplitude = std::sqrt(sumSquares / static_cast<float>(count));
+    // Published from the meter timer, as for RX: this may run on the
+    // real-time encode thread.
     updateMeterState(meterLevelFromAmplitude(rmsAmplitude),
                      meterLevelFromAmplitude(peakAmplitude),
                      m_txMeterLevel, m_txMeterPeakLevel,
                      m_txMeterLastUpdateMs, m_txMeterPeakHoldUntilMs,
-                     &AudioEngine::txMeterLevelsChanged);
+                     nullptr);
+    m_pendingTxMeterLevel.store(m_txMeterLevel, std::memory_order_relaxed);
+    m_pendingTxMeterPeakLevel.store(m_txMeterPeakLevel, std::memory_order_relaxed);
+    m_txMeterPending.store(true, std::memory_order_release);
 }
 
 void AudioEngine::resetRxMeter()
@@ -223,6 +241,7 @@ void AudioEngine::resetRxMeter()
     m_rxMeterPeakLevel = 0.0f;
     m_rxMeterLastUpdateMs = 0;
     m_rxMeterPeakHoldUntilMs = 0;
+    m_rxMeterPending = false;
     emit rxMeterLevelsChanged(0.0f, 0.0f);
 }
 
@@ -232,6 +251,7 @@ void AudioEngine::resetTxMeter()
     m_txMeterPeakLevel = 0.0f;
     m_txMeterLastUpdateMs = 0;
     m_txMeterPeakHoldUntilMs = 0;
+    m_txMeterPending.store(false, std::memory_order_relaxed);
     emit txMeterLevelsChanged(0.0f, 0.0f);
 }
 
@@ -247,9 +267,217 @@ void AudioEngine::setRxAudioLevelDb(float levelDb)
              << "(" << m_rxGainMultiplier << "x )";
 }
 
+void AudioEngine::setAdaptiveJitterBufferEnabled(bool enabled)
+{
+    if (m_adaptiveJitterBuffer == enabled) {
+        return;
+    }
+    m_adaptiveJitterBuffer = enabled;
+    qDebug() << "AudioEngine: adaptive jitter buffer" << (enabled ? "enabled" : "disabled");
+    applyJitterBufferTarget(true);
+    publishJitterBufferStats();
+}
+
+void AudioEngine::setJitterBufferUnderrunProbability(float probability)
+{
+    m_jitterEstimator.setUnderrunProbability(probability);
+    qDebug() << "AudioEngine: jitter buffer underrun probability set to"
+             << m_jitterEstimator.underrunProbability();
+    applyJitterBufferTarget(true);
+    publishJitterBufferStats();
+}
+
+void AudioEngine::setTxFecEnabled(bool enabled)
+{
+    const std::lock_guard<std::mutex> txLock(m_txMutex);
+    if (m_txFecEnabled == enabled) {
+        return;
+    }
+    m_txFecEnabled = enabled;
+    qDebug() << "AudioEngine: TX in-band FEC" << (enabled ? "enabled" : "disabled");
+    applyTxEncoderSettings();
+}
+
+void AudioEngine::setTxDtxEnabled(bool enabled)
+{
+    const std::lock_guard<std::mutex> txLock(m_txMutex);
+    if (m_txDtxEnabled == enabled) {
+        return;
+    }
+    m_txDtxEnabled = enabled;
+    qDebug() << "AudioEngine: TX DTX" << (enabled ? "enabled" : "disabled");
+}
+
+void AudioEngine::applyTxEncoderSettings(bool force)
+{
+    if (!m_encoder) {
+        return;
+    }
+
+    // The reflector reports nothing about uplink loss; the loss seen on the
+    // downlink of the same network path is the best available estimate.
+    m_txEncoderController.setFecEnabled(m_txFecEnabled);
+    m_txEncoderController.setLossFraction(m_rxLossFraction.load(std::memory_order_relaxed));
+    if (m_udpAudioSender) {
+        m_txEncoderController.reportSendErrors(m_udpAudioSender->sendErrors());
+    }
+    const bool changed = m_txEncoderController.update();
+    const OpusEncoderController::Settings& settings = m_txEncoderController.settings();
+
+    // The packet size holds for a whole transmission.
+    if (!m_recording && settings.frameSizeMs != m_txFrameSizeMs) {
+        m_txFrameSizeMs = settings.frameSizeMs;
+        m_txFrameSamples = txSamplesForMs(m_txFrameSizeMs);
+        configureTxBacklog();
+        qDebug() << "AudioEngine: TX packets carry" << m_txFrameSizeMs << "ms,"
+                 << 1000 / m_txFrameSizeMs << "packets/s,"
+                 << OpusEncoderController::overheadBytesPerSecond(FRAME_SIZE_MS)
+                        - OpusEncoderController::overheadBytesPerSecond(m_txFrameSizeMs)
+                 << "header bytes/s saved over 20 ms packets";
+        emit txFrameSizeChanged(m_txFrameSizeMs);
+    }
+
+    if (!changed && !force) {
+        return;
+    }
+
+    const bool narrowband = settings.bandwidth == OpusEncoderController::Bandwidth::Narrowband;
+    m_encoder->setBitrate(settings.bitrate);
+    m_encoder->setMaxBandwidth(narrowband ? OPUS_BANDWIDTH_NARROWBAND : OPUS_BANDWIDTH_MEDIUMBAND);
+    m_encoder->setComplexity(settings.complexity);
+    m_encoder->setInbandFec(settings.inbandFec, settings.expectedLossPercent);
+    // Retuning mid-transmission may happen on the real-time encode thread,
+    // which does not log.
+    if (m_txEncodeThreadActive.load(std::memory_order_acquire)) {
+        return;
+    }
+    qDebug() << "AudioEngine: TX encoder" << settings.bitrate << "bit/s"
+             << (narrowband ? "narrowband" : "mediumband")
+             << "complexity" << settings.complexity
+             << "FEC" << (settings.inbandFec ? "on" : "off")
+             << "expected loss" << settings.expectedLossPercent << "%";
+}
+
+void AudioEngine::controlTxEncoder()
+{
+    // Retune between frames every half second or so of transmitted audio.
+    m_txFramesSinceControl += m_txFrameSizeMs / FRAME_SIZE_MS;
+    if (m_txFramesSinceControl < OpusEncoderController::UPDATE_INTERVAL_FRAMES) {
+        return;
+    }
+    m_txFramesSinceControl = 0;
+    applyTxEncoderSettings();
+}
+
+void AudioEngine::setNetworkTransport(int transport, bool metered)
+{
+    const auto networkTransport = static_cast<OpusEncoderController::Transport>(
+        std::clamp(transport, static_cast<int>(OpusEncoderController::Transport::Unknown),
+                   static_cast<int>(OpusEncoderController::Transport::Other)));
+    const std::lock_guard<std::mutex> txLock(m_txMutex);
+    if (networkTransport == m_txEncoderController.transport()
+            && metered == m_txEncoderController.metered()) {
+        return;
+    }
+    m_txEncoderController.setTransport(networkTransport, metered);
+    qDebug() << "AudioEngine: network transport" << transport << (metered ? "metered" : "unmetered");
+    applyTxEncoderSettings();
+}
+
+void AudioEngine::setNetworkRoundTripMs(int roundTripMs)
+{
+    const std::lock_guard<std::mutex> txLock(m_txMutex);
+    m_txEncoderController.setRoundTripMs(roundTripMs);
+    if (m_txEncoderController.packetization() == 0 && !m_recording) {
+        applyTxEncoderSettings();
+    }
+}
+
+void AudioEngine::setTxPacketizationMs(int frameSizeMs)
+{
+    const std::lock_guard<std::mutex> txLock(m_txMutex);
+    m_txEncoderController.setPacketization(frameSizeMs);
+    qDebug() << "AudioEngine: TX packetization"
+             << (m_txEncoderController.packetization() == 0
+                     ? QStringLiteral("automatic")
+                     : QStringLiteral("%1 ms").arg(m_txEncoderController.packetization()));
+    applyTxEncoderSettings();
+}
+
+void AudioEngine::setTxMaxBacklogMs(int backlogMs)
+{
+    const int normalizedBacklogMs = std::clamp(backlogMs, MIN_TX_BACKLOG_MS, MAX_TX_BACKLOG_MS);
+    const std::lock_guard<std::mutex> txLock(m_txMutex);
+    if (normalizedBacklogMs == m_txMaxBacklogMs) {
+        return;
+    }
+    m_txMaxBacklogMs = normalizedBacklogMs;
+
+    // Resizing drops what is waiting, so not under the speaker.
+    if (!m_recording) {
+        configureTxBacklog();
+    }
+    qDebug() << "AudioEngine: TX backlog capped at" << m_txMaxBacklogMs << "ms";
+}
+
+void AudioEngine::setTxEncodeThreadEnabled(bool enabled)
+{
+    if (m_txEncodeThreadEnabled == enabled) {
+        return;
+    }
+    m_txEncodeThreadEnabled = enabled;
+    qDebug() << "AudioEngine: TX encode thread" << (enabled ? "enabled" : "disabled");
+}
+
+void AudioEngine::setTxLookAheadMs(int lookAheadMs)
+{
+    const int normalizedLookAheadMs = std::clamp(lookAheadMs, 0, FRAME_SIZE_MS);
+    bool applyNow = false;
+    {
+        const std::lock_guard<std::mutex> txLock(m_txMutex);
+        if (normalizedLookAheadMs == m_txLookAheadMs) {
+            return;
+        }
+        m_txLookAheadMs = normalizedLookAheadMs;
+
+        // Mid-transmission changes wait for resetTxForTransmission() so the
+        // delay line is not cut short under the speaker; the latency is
+        // reported from there too.
+        applyNow = !m_recording;
+        if (applyNow) {
+            m_audioLimiter.setLookAheadSamples(txSamplesForMs(m_txLookAheadMs));
+        }
+    }
+    qDebug() << "AudioEngine: TX limiter look-ahead set to" << m_txLookAheadMs << "ms";
+    if (applyNow) {
+        reportTxProcessingLatency();
+    }
+}
+
+void AudioEngine::reportTxProcessingLatency()
+{
+    const int latencyMs = m_audioLimiter.latencySamples() * 1000 / m_txSampleRate;
+    if (latencyMs == m_reportedTxLatencyMs) {
+        return;
+    }
+    m_reportedTxLatencyMs = latencyMs;
+    emit txProcessingLatencyChanged(latencyMs);
+}
+
+void AudioEngine::setTxAgcEnabled(bool enabled)
+{
+    const std::lock_guard<std::mutex> txLock(m_txMutex);
+    if (m_audioLimiter.agcEnabled() == enabled) {
+        return;
+    }
+    m_audioLimiter.setAgcEnabled(enabled);
+    qDebug() << "AudioEngine: TX AGC" << (enabled ? "on" : "off");
+}
+
 void AudioEngine::setTxAudioLevelDb(float levelDb)
 {
     const float normalizedLevel = std::clamp(levelDb, -12.0f, 12.0f);
+    const std::lock_guard<std::mutex> txLock(m_txMutex);
     if (qFuzzyCompare(m_txAudioLevelDb + 1.0f, normalizedLevel + 1.0f)) {
         return;
     }
@@ -261,9 +489,19 @@ void AudioEngine::setTxAudioLevelDb(float levelDb)
 
 void AudioEngine::onMeterDecayTimer()
 {
+    if (m_rxMeterPending) {
+        m_rxMeterPending = false;
+        emit rxMeterLevelsChanged(m_rxMeterLevel, m_rxMeterPeakLevel);
+    }
+    publishJitterBufferStats();
+    if (m_txMeterPending.exchange(false, std::memory_order_acq_rel)) {
+        emit txMeterLevelsChanged(m_pendingTxMeterLevel.load(std::memory_order_relaxed),
+                                  m_pendingTxMeterPeakLevel.load(std::memory_order_relaxed));
+    }
     decayMeterState(m_rxMeterLevel, m_rxMeterPeakLevel,
                     m_rxMeterLastUpdateMs, m_rxMeterPeakHoldUntilMs,
                     &AudioEngine::rxMeterLevelsChanged);
+    const std::lock_guard<std::mutex> txLock(m_txMutex);
     decayMeterState(m_txMeterLevel, m_txMeterPeakLevel,
                     m_txMeterLastUpdateMs, m_txMeterPeakHoldUntilMs,
                     &AudioEngine::txMeterLevelsChanged);
@@ -272,15 +510,65 @@ void AudioEngine::onMeterDecayTimer()
 void AudioEngine::initializeAudioComponents()
 {
     // Create Opus encoder/decoder - they are thread-safe
-    m_encoder = std::make_unique<OpusEncoder>(SAMPLE_RATE, CHANNELS, OPUS_APPLICATION_VOIP);
+    m_encoder = std::make_unique<OpusEncoder>(m_txSampleRate, CHANNELS, OPUS_APPLICATION_VOIP);
     m_encoder->applySvxlinkDefaults();
-    m_decoder = std::make_unique<OpusDecoder>(SAMPLE_RATE, CHANNELS);
+    applyTxEncoderSettings(true);
+    m_decoder = std::make_unique<OpusDecoder>(m_rxSampleRate, CHANNELS);
+
+    resizeJitterBuffer();
+}
 
+void AudioEngine::resizeJitterBuffer()
+{
     // Initialize jitter buffer with enough headroom for bursty Android scheduling.
-    m_jitterBuffer.setSize(FRAME_SIZE_SAMPLES * m_maxBufferFrames);
-    // Start playback after 150 ms of buffered audio, aligned with mainstream VoIP defaults.
-    const int prebufFrames = (150 / FRAME_SIZE_MS); // 20 ms per frame
-    m_jitterBuffer.setPrebufSamples(FRAME_SIZE_SAMPLES * prebufFrames);
+    m_jitterBuffer.setSize(static_cast<unsigned>(rxSamplesForMs(FRAME_SIZE_MS) * m_maxBufferFrames));
+    // Adaptive targets stay below three quarters of the headroom so a late
+    // burst does not immediately trip the drop-half overflow policy.
+    m_jitterEstimator.setTargetLimitsMs(2 * FRAME_SIZE_MS, m_maxBufferFrames * FRAME_SIZE_MS * 3 / 4);
+    // Start playback after 150 ms of buffered audio, aligned with mainstream VoIP defaults,
+    // until the adaptive estimator has seen enough packets to pick its own depth.
+    const int prebufMs = m_adaptiveJitterBuffer ? m_jitterEstimator.targetDelayMs() : DEFAULT_PREBUF_MS;
+    m_jitterBuffer.setPrebufSamples(static_cast<unsigned>(rxSamplesForMs(prebufMs)));
+}
+
+void AudioEngine::configureRxSampleRate(int outputSampleRate)
+{
+    const int sampleRate = codecSampleRateFor(outputSampleRate);
+    if (sampleRate == m_rxSampleRate) {
+        return;
+    }
+    m_rxSampleRate = sampleRate;
+
+    // Only called while the output is stopped: the jitter buffer cannot be
+    // resized under a running reader.
+    m_rxFrameBuffer.resize(static_cast<size_t>(rxSamplesForMs(MAX_FRAME_SIZE_MS) * CHANNELS));
+    m_lastDecodedFrameSamples = rxSamplesForMs(FRAME_SIZE_MS);
+    resizeJitterBuffer();
+    if (m_decoder) {
+        m_decoder = std::make_unique<OpusDecoder>(m_rxSampleRate, CHANNELS);
+    }
+    if (m_rxSampleRate != SAMPLE_RATE) {
+        m_transcriptionResampler = std::make_unique<Resampler>(m_rxSampleRate, SAMPLE_RATE, CHANNELS);
+    } else {
+        m_transcriptionResampler.reset();
+    }
+    qDebug() << "AudioEngine: decoding RX at" << m_rxSampleRate << "Hz";
+}
+
+const float* AudioEngine::svxlinkRateTap(Resampler* decimator, const float* samples,
+                                         int& count, std::vector<float>& buffer)
+{
+    if (decimator == nullptr) {
+        return samples;
+    }
+
+    // Grows only when a longer frame than any before comes through.
+    const int capacity = decimator->maxOutputSamples(count);
+    if (buffer.size() < static_cast<size_t>(capacity)) {
+        buffer.resize(static_cast<size_t>(capacity));
+    }
+    count = std::max(0, decimator->process(samples, count, buffer.data(), capacity));
+    return buffer.data();
 }
 
 void AudioEngine::setupAudio()
@@ -324,23 +612,35 @@ void AudioEngine::setupAudio()
         outFormat.setChannelCount(CHANNELS);
         outFormat.setSampleFormat(QAudioFormat::Float);
 
-        std::unique_ptr<Resampler> resampler;
+        // Play at the device's own rate when Opus can decode straight to it,
+        // so neither we nor the audio server resample.
+        const int preferredRate = outputDevice.preferredFormat().sampleRate();
+        if (isOpusSampleRate(preferredRate)) {
+            QAudioFormat native = outFormat;
+            native.setSampleRate(preferredRate);
+            if (outputDevice.isFormatSupported(native)) {
+                outFormat = native;
+            }
+        }
+
         if (!outputDevice.isFormatSupported(outFormat)) {
-            // Try 48kHz first — this is guaranteed to work with the FIR filters
+            // Try 48kHz first — Opus decodes straight to it
             QAudioFormat alt = outFormat;
             alt.setSampleRate(48000);
             if (outputDevice.isFormatSupported(alt)) {
                 qWarning() << "Using 48 kHz output format";
                 outFormat = alt;
-                resampler = std::make_unique<Resampler>(SAMPLE_RATE, 48000, CHANNELS);
             } else {
                 qWarning() << "Falling back to preferred output format";
                 outFormat = outputDevice.preferredFormat();
-                if (outFormat.sampleRate() != SAMPLE_RATE)
-                    resampler = std::make_unique<Resampler>(SAMPLE_RATE, outFormat.sampleRate(), CHANNELS);
             }
         }
 
+        configureRxSampleRate(outFormat.sampleRate());
+        m_outputResampler.reset();
+        if (outFormat.sampleRate() != m_rxSampleRate)
+            m_outputResampler = std::make_unique<Resampler>(m_rxSampleRate, outFormat.sampleRate(), CHANNELS);
+
         // Create sink and output device
         m_audioSink = new QAudioSink(outputDevice, outFormat, this);
         connect(m_audioSink, &QAudioSink::stateChanged, this, [](QAudio::State state){
@@ -351,7 +651,7 @@ void AudioEngine::setupAudio()
         const int outFrameSamples = outFormat.sampleRate() * FRAME_SIZE_MS / 1000;
         m_audioSink->setBufferSize(outFrameSamples * bytesPerSample * m_maxBufferFrames);
         // Create our custom IODevice bridge
-        m_audioStreamDevice = new AudioStreamDevice(&m_jitterBuffer, m_outputResampler.get(), outFormat.sampleRate(), outFormat.sampleFormat(), this);
+        m_audioStreamDevice = new AudioStreamDevice(&m_jitterBuffer, m_outputResampler.get(), m_rxSampleRate, outFormat.sampleRate(), outFormat.sampleFormat(), this);
 
         // Start the audio sink in pull mode
         m_audioSink->start(m_audioStreamDevice);
@@ -359,8 +659,6 @@ void AudioEngine::setupAudio()
 
         // Store objects created in audio thread
         m_outputFormat = outFormat;
-        if (resampler)
-            m_outputResampler = std::move(resampler);
 
         // Set audio ready flag
         if (!m_audioReady) {
@@ -429,8 +727,14 @@ void AudioEngine::setupAudioInput()
         QAudioFormat inFormat;
         bool formatFound = false;
 
-        // Try multiple format combinations to find one that works
-        const QList<int> sampleRates = {SAMPLE_RATE, 48000, 44100, 22050, 8000};
+        // Try multiple format combinations to find one that works, starting
+        // with the device's own rate when Opus can encode at it
+        QList<int> sampleRates = {SAMPLE_RATE, 48000, 44100, 22050, 8000};
+        const int preferredRate = inputDevice.preferredFormat().sampleRate();
+        if (isOpusSampleRate(preferredRate)) {
+            sampleRates.removeAll(preferredRate);
+            sampleRates.prepend(preferredRate);
+        }
         const QList<QAudioFormat::SampleFormat> sampleFormats = {
             QAudioFormat::Int16, QAudioFormat::Float, QAudioFormat::Int32
         };
@@ -446,10 +750,6 @@ void AudioEngine::setupAudioInput()
                     if (inputDevice.isFormatSupported(inFormat)) {
                         qDebug() << "Found supported input format:" << sampleRate << "Hz," << channels << "channels," << sampleFormat;
                         formatFound = true;
-
-                        if (sampleRate != SAMPLE_RATE) {
-                            m_inputResampler = std::make_unique<Resampler>(sampleRate, SAMPLE_RATE, CHANNELS);
-                        }
                         break;
                     }
                 }
@@ -466,10 +766,6 @@ void AudioEngine::setupAudioInput()
             if (inFormat.isValid()) {
                 qDebug() << "Using preferred format:" << inFormat.sampleRate() << "Hz,"
                          << inFormat.channelCount() << "channels," << inFormat.sampleFormat();
-
-                if (inFormat.sampleRate() != SAMPLE_RATE) {
-                    m_inputResampler = std::make_unique<Resampler>(inFormat.sampleRate(), SAMPLE_RATE, CHANNELS);
-                }
                 formatFound = true;
             }
         }
@@ -479,6 +775,7 @@ void AudioEngine::setupAudioInput()
             return;
         }
 
+        configureTxSampleRate(inFormat.sampleRate());
         m_audioSource = new QAudioSource(inputDevice, inFormat, this);
 
         // Set optimal buffer size for network resilience
@@ -504,6 +801,7 @@ void AudioEngine::setupAudioInput()
 void AudioEngine::cleanupAudio()
 {
     qDebug() << "AudioEngine::cleanupAudio() - Starting cleanup";
+    stopTxEncodeThread();
 
     // Reset audio mode first
     resetAudioMode();
@@ -515,6 +813,10 @@ void AudioEngine::cleanupAudio()
     if (m_meterDecayTimer) {
         m_meterDecayTimer->stop();
     }
+    if (m_packetPlayoutTimer) {
+        m_packetPlayoutTimer->stop();
+    }
+    m_packetBuffer.reset();
 
     // Stop recording safely
     if (m_recording) {
@@ -23,13 +23,24 @@
 #include <QAudioSink>
 #include <QTimer>
 #include <QDateTime>
+#include <atomic>
 #include <cstdint>
 #include "OpusWrapper.h"
 #include "Resampler.h"
 #include "AudioJitterBuffer.h"
+#include "AudioJitterEstimator.h"
+#include "AudioPacketBuffer.h"
+#include "AudioPacketQueue.h"
+#include "AudioCaptureQueue.h"
 #include "AudioStreamDevice.h"
 #include "AudioLimiter.h"
+#include "AudioFrameRing.h"
+#include "OpusEncoderController.h"
+#include "TxEncodeThread.h"
+#include "UdpAudioSender.h"
+#include "VoiceActivityDetector.h"
 #include <memory>
+#include <mutex>
 #include <vector>
 
 class AndroidAudioTrackOutput;
@@ -43,24 +54,52 @@ public:
     explicit AudioEngine(QObject *parent = nullptr);
     ~AudioEngine();
 
-    // Audio configuration constants
+    // Audio configuration constants.  SAMPLE_RATE is the SvxLink rate:
+    // the codec runs at the device rate instead when Opus supports it, and
+    // everything tuned to 16 kHz gets a tap at this rate.
     static inline const int SAMPLE_RATE = 16000;
     static inline const int CHANNELS = 1;
     static inline const int FRAME_SIZE_MS = 20;
     static inline const int FRAME_SIZE_SAMPLES = SAMPLE_RATE * FRAME_SIZE_MS / 1000;
     // Maximum frame size to support SVXLink clients with up to 60ms frames
-    static inline const int MAX_FRAME_SIZE_SAMPLES = SAMPLE_RATE * 60 / 1000;
+    static inline const int MAX_FRAME_SIZE_MS = 60;
+    static inline const int MAX_FRAME_SIZE_SAMPLES = SAMPLE_RATE * MAX_FRAME_SIZE_MS / 1000;
+    // Fixed prebuffer, also the adaptive starting point before jitter is known
+    static inline const int DEFAULT_PREBUF_MS = 150;
+    // TX limiter look-ahead the client applies by default (the engine
+    // itself starts without); capped at one Opus frame
+    static inline const int DEFAULT_TX_LOOKAHEAD_MS = 5;
+    // Captured audio waiting to be encoded, beyond which the oldest is
+    // dropped rather than sent late
+    static inline const int DEFAULT_TX_MAX_BACKLOG_MS = 200;
+    static inline const int MIN_TX_BACKLOG_MS = 2 * MAX_FRAME_SIZE_MS;
+    static inline const int MAX_TX_BACKLOG_MS = 2000;
 
     bool isAudioReady() const { return m_audioReady; }
     bool isRecording() const { return m_recording; }
 
+    // Thread-safe for a single producer (the socket thread).  Copies the
+    // payload into a preallocated slot and wakes the audio thread only when
+    // it is not already draining, so steady-state receive never allocates.
+    bool enqueueReceivedAudio(const unsigned char* payload, int size, quint16 sequence, qint64 arrivalUs);
+    // Same producer as enqueueReceivedAudio.  The flush takes effect after
+    // the packets queued before it and before any queued after it.
+    void enqueueReceivedFlush();
+
+    // While the sender is active, encoded TX frames go straight to it from
+    // the audio thread instead of through audioDataEncoded.  Set before the
+    // engine is used; the sender must outlive it.
+    void setUdpAudioSender(UdpAudioSender* sender) { m_udpAudioSender = sender; }
+
 public slots:
     void setupAudio();
     void setupAudioInput();
     void restartAudio();
     void startRecording();
     void stopRecording();
-    void processReceivedAudio(const QByteArray &audioData, quint16 sequence);
+    // arrivalUs is a steady_clock timestamp taken when the datagram was read;
+    // -1 stamps the packet on arrival at the audio thread instead.
+    void processReceivedAudio(const QByteArray &audioData, quint16 sequence, qint64 arrivalUs = -1);
     void flushAudioBuffers();
     void cleanup();
     void checkAudioHealth();
@@ -72,6 +111,26 @@ public slots:
     void handleAudioRouteChanged();
     void setRxAudioLevelDb(float levelDb);
     void setTxAudioLevelDb(float levelDb);
+    void setAdaptiveJitterBufferEnabled(bool enabled);
+    void setJitterBufferUnderrunProbability(float probability);
+    void setTxFecEnabled(bool enabled);
+    // Holds TX packets back through pauses in speech, keeping one alive
+    // every few hundred ms.
+    void setTxDtxEnabled(bool enabled);
+    void setTxLookAheadMs(int lookAheadMs);
+    void setTxAgcEnabled(bool enabled);
+    // transport takes ReflectorClient::AndroidNetworkTransport values.
+    void setNetworkTransport(int transport, bool metered);
+    // Smoothed TCP round-trip time to the reflector, -1 when unknown.
+    void setNetworkRoundTripMs(int roundTripMs);
+    // 20, 40 or 60 ms of audio per TX packet, or 0 to choose from the link.
+    // Takes effect from the next transmission.
+    void setTxPacketizationMs(int frameSizeMs);
+    // Takes effect from the next transmission.
+    void setTxMaxBacklogMs(int backlogMs);
+    // Encode native capture on a real-time thread of its own instead of
+    // this one.  Takes effect from the next transmission.
+    void setTxEncodeThreadEnabled(bool enabled);
     void setTranscriptionPipeFd(int fd);
     void allSamplesFlushed();
 
@@ -83,16 +142,47 @@ signals:
     void txDrainComplete();
     void rxMeterLevelsChanged(float level, float peakLevel);
     void txMeterLevelsChanged(float level, float peakLevel);
+    void jitterBufferStatsChanged(int targetMs, float jitterMs);
+    // Delay the TX chain adds ahead of the encoder
+    void txProcessingLatencyChanged(int latencyMs);
+    // Audio per TX packet the next (or current) transmission uses
+    void txFrameSizeChanged(int frameSizeMs);
+    // Once per transmission: Opus time per packet, and packets encoded
+    // more than a packet's duration after their audio was captured
+    void txEncodeStatsChanged(int meanEncodeUs, int maxEncodeUs, int missedDeadlines);
 
 private slots:
     void onAudioInputReadyRead();
     void onAudioRecoveryTimer();
     void onMeterDecayTimer();
+    void onPacketPlayoutTimer();
+    void drainReceivedAudio();
+    void drainCapturedAudio();
+    void drainEncodedAudio();
 
 private:
     friend class AudioEngineTest;
+    friend class LatencyBench;
+    friend class JitterImpairmentBench;
 
     void initializeAudioComponents();
+    // Decoder, jitter buffer and playout follow the output device's rate,
+    // the encoder and TX chain the capture device's, whenever Opus runs at
+    // it; otherwise they stay at SAMPLE_RATE behind a Resampler.
+    void configureRxSampleRate(int outputSampleRate);
+    void configureTxSampleRate(int captureSampleRate);
+    void resizeJitterBuffer();
+    static int codecSampleRateFor(int deviceSampleRate)
+    {
+        return isOpusSampleRate(deviceSampleRate) ? deviceSampleRate : SAMPLE_RATE;
+    }
+    int rxSamplesForMs(int ms) const { return m_rxSampleRate * ms / 1000; }
+    int txSamplesForMs(int ms) const { return m_txSampleRate * ms / 1000; }
+    // samples at SAMPLE_RATE for consumers tuned to it: returns samples
+    // itself without a decimator, else the decimated copy in buffer.
+    // count is updated to the tap's length.
+    static const float* svxlinkRateTap(Resampler* decimator, const float* samples,
+                                       int& count, std::vector<float>& buffer);
     void cleanupAudio();
     void configureAudioForVoIP();
     void resetAudioMode();
@@ -120,14 +210,43 @@ private:
     void stopAndroidCaptureInput();
     void releaseAndroidCaptureInput();
     bool usesAndroidNativeInput() const;
+    void processReceivedPacket(const unsigned char* payload, int size, quint16 sequence, qint64 arrivalUs);
+    // Everything flushAudioBuffers() resets except the packet queue.
+    void resetReceivePath();
+    void trackPacketArrival(quint16 sequence, qint64 arrivalUs);
+    void releaseBufferedPackets(bool force, qint64 nowUs);
+    bool packetGapIsDue(qint64 nowUs) const;
+    void decodeReceivedPacket(const unsigned char* payload, int size);
+    void concealLostFrames(unsigned missing);
+    bool recoverLostFrameFromFec(const unsigned char* nextPayload, int size);
+    void recordRxPacketOutcome(bool lost);
+    void applyTxEncoderSettings(bool force = false);
+    void controlTxEncoder();
+    void applyJitterBufferTarget(bool forceReport);
+    void publishJitterBufferStats();
     void flushPendingTxSamples();
+    // The per-transmission TX state startRecording() starts from.
+    void resetTxForTransmission();
+    // Emits txProcessingLatencyChanged with the delay the limiter really
+    // adds, once it differs from what was last reported.
+    void reportTxProcessingLatency();
+    void configureTxBacklog();
+    void pushPendingTxSamples(const float* samples, int count);
+    bool txCaptureIsStale(qint64 blockUs);
+    void wakeCaptureConsumer();
+    void processCaptureQueue();
+    void startTxEncodeThread();
+    void stopTxEncodeThread();
+    void drainTxLimiter();
     void processCapturedFloatSamples(float* samples, int count);
     void processCapturedNativeFloatSamples(float* samples, int count, int sampleRate);
-    void processCapturedInt16Samples(const short* samples, int count, int sampleRate);
     void queueCapturedNativeFloatSamples(const float* samples, int count, int sampleRate);
     void queueCapturedInt16Samples(const short* samples, int count, int sampleRate);
     int encodeTxFrame(const float* frameSamples);
-    void encodeReadyTxFrames(const char* logContext);
+    void encodeReadyTxFrames();
+    bool txPacketIsDue(const float* packetSamples);
+    int resampleCapturedSamples(const float* samples, int count);
+    void sendEncodedTxFrames();
     void prepareTxStartupPriming();
     void sendTxStartupLeadIn();
     void flushBufferedTxStartupAudio();
@@ -148,19 +267,84 @@ private:
     std::unique_ptr<OpusDecoder> m_decoder;
     std::unique_ptr<Resampler> m_outputResampler;
     std::unique_ptr<Resampler> m_inputResampler;
-    std::vector<float> m_pendingInputSamples;
-    std::vector<float> m_txStartupBuffer;
+    int m_rxSampleRate = SAMPLE_RATE;
+    int m_txSampleRate = SAMPLE_RATE;
+    // 16 kHz taps for the transcriber and the TX VAD; null at 16 kHz.
+    std::unique_ptr<Resampler> m_transcriptionResampler;
+    std::unique_ptr<Resampler> m_txVadResampler;
+    std::vector<float> m_transcriptionTapBuffer;
+    std::vector<float> m_txVadTapBuffer;
+    // Whole TX packets for the encoder; also holds the startup priming.
+    AudioFrameRing m_pendingInputSamples;
     std::vector<float> m_txLeadInSilenceFrame;
     bool m_txStartupPrimingActive = false;
     int m_txStartupPrimingTargetSamples = 0;
+    UdpAudioSender* m_udpAudioSender = nullptr;
 
     // Audio buffering and pacing
     AudioStreamDevice* m_audioStreamDevice = nullptr;
     AudioJitterBuffer m_jitterBuffer;
+    AudioPacketBuffer m_packetBuffer;
+    AudioPacketQueue m_rxPacketQueue;
+    std::atomic<bool> m_rxDrainScheduled{false};
+    QTimer* m_packetPlayoutTimer = nullptr;
     const int m_maxBufferFrames = 24; // 480ms headroom (0.0.6 working value)
     bool m_hasLastAudioSeq = false;
     quint16 m_lastAudioSeq = 0;
     int m_lastDecodedFrameSamples = FRAME_SIZE_SAMPLES;
+    AudioJitterEstimator m_jitterEstimator{FRAME_SIZE_MS};
+    bool m_adaptiveJitterBuffer = true;
+    int m_reportedJitterTargetMs = -1;
+    int m_packetsSinceJitterReport = 0;
+    // Handed to the meter timer like the RX meter; a queued signal from
+    // the decode path would allocate.
+    std::atomic<bool> m_jitterStatsPending{false};
+    std::atomic<int> m_pendingJitterTargetMs{0};
+    std::atomic<float> m_pendingJitterMs{0.0f};
+    // Written by RX, read by the TX encoder controller.
+    std::atomic<double> m_rxLossFraction{0.0};
+    // Receive outcomes, for the tests and bench_jitter_impairment.
+    quint64 m_rxFecRecoveredFrames = 0;
+    quint64 m_rxConcealedFrames = 0;
+    quint64 m_rxSkippedFrames = 0;
+    quint64 m_rxLatePackets = 0;
+    bool m_txFecEnabled = false;
+    OpusEncoderController m_txEncoderController;
+    int m_txFramesSinceControl = 0;
+    int m_txFrameSizeMs = FRAME_SIZE_MS;
+    int m_txFrameSamples = FRAME_SIZE_SAMPLES;
+    bool m_txDtxEnabled = false;
+    VoiceActivityDetector m_txVad;
+    int m_txDtxPausedMs = 0;
+    quint64 m_txDtxHeldPackets = 0;
+    int m_txMaxBacklogMs = DEFAULT_TX_MAX_BACKLOG_MS;
+    // Native capture waiting for this thread, and what was dropped this
+    // transmission for falling too far behind.
+    AudioCaptureQueue m_txCaptureQueue;
+    std::atomic<bool> m_txCaptureDrainScheduled{false};
+    qint64 m_txBacklogDroppedUs = 0;
+    // Encode timing this transmission; a block's capture time is kept
+    // while the packets it completes are encoded.
+    qint64 m_txCaptureBlockUs = 0;
+    int m_txEncodedPackets = 0;
+    qint64 m_txEncodeTotalUs = 0;
+    int m_txEncodeMaxUs = 0;
+    int m_txMissedDeadlines = 0;
+    // Counted rather than logged on the encode path; reported at the end
+    // of the transmission.
+    int m_txEncodeErrors = 0;
+    int m_txLastEncodeError = 0;
+    int m_txCaptureRateMismatches = 0;
+    // Encoded packets waiting for this thread to emit audioDataEncoded,
+    // when TxEncodeThread encodes and UdpAudioSender is not in use.
+    AudioPacketQueue m_txPacketQueue;
+    std::atomic<bool> m_txPacketDrainScheduled{false};
+    // Held by whichever thread runs the TX path, and by anything on this
+    // thread that changes TX state while TxEncodeThread may be running it.
+    std::mutex m_txMutex;
+    bool m_txEncodeThreadEnabled = false;
+    std::atomic<bool> m_txEncodeThreadActive{false};
+    std::unique_ptr<TxEncodeThread> m_txEncodeThread;
     std::unique_ptr<AndroidAudioTrackOutput> m_androidAudioTrackOutput;
     std::unique_ptr<AndroidAudioRecordInput> m_androidAudioRecordInput;
 
@@ -169,12 +353,15 @@ private:
     QTimer* m_meterDecayTimer = nullptr;
     bool m_audioFocusLost = false;
     bool m_audioFocusPaused = false;
-    QDateTime m_lastAudioWrite;
+    qint64 m_lastAudioWriteMs = 0;
     
     // Pre-allocated buffers for performance optimization
     std::vector<float> m_reusableFloatBuffer;
+    std::vector<float> m_resampledInputBuffer;
     std::vector<unsigned char> m_reusableOpusBuffer;
     std::vector<int16_t> m_transcriptionPcmBuffer;
+    // One decoded, concealed or FEC-recovered frame of up to 60 ms.
+    std::vector<float> m_rxFrameBuffer;
     static constexpr int OPUS_BUFFER_SIZE = 4000;
     int m_transcriptionPipeFd = -1;
 
@@ -188,10 +375,18 @@ private:
     float m_txMeterPeakLevel = 0.0f;
     qint64 m_rxMeterLastUpdateMs = 0;
     qint64 m_rxMeterPeakHoldUntilMs = 0;
+    bool m_rxMeterPending = false;
     qint64 m_txMeterLastUpdateMs = 0;
     qint64 m_txMeterPeakHoldUntilMs = 0;
+    // The TX meter may be updated on TxEncodeThread, so it reaches the
+    // meter timer through atomics.
+    std::atomic<bool> m_txMeterPending{false};
+    std::atomic<float> m_pendingTxMeterLevel{0.0f};
+    std::atomic<float> m_pendingTxMeterPeakLevel{0.0f};
 
     AudioLimiter m_audioLimiter;
+    int m_txLookAheadMs = 0;
+    int m_reportedTxLatencyMs = -1;
 };
 
 #endif // AUDIOENGINE_H
@@ -37,18 +37,21 @@ void AudioEngine::restartAudio()
         resumeAndroidPlaybackOutput();
 
         // Update last audio write time
-        m_lastAudioWrite = QDateTime::currentDateTime();
+        m_lastAudioWriteMs = QDateTime::currentMSecsSinceEpoch();
 
         // Clear focus flags
         m_audioFocusLost = false;
         m_audioFocusPaused = false;
 
-        if (m_inputResampler) {
-            m_inputResampler->reset();
-        }
+        {
+            const std::lock_guard<std::mutex> txLock(m_txMutex);
+            if (m_inputResampler) {
+                m_inputResampler->reset();
+            }
 
-        m_pendingInputSamples.clear();
-        resetTxStartupPriming();
+            m_pendingInputSamples.clear();
+            resetTxStartupPriming();
+        }
 
         if (!m_audioReady) {
             m_audioReady = true;
@@ -72,20 +75,23 @@ void AudioEngine::restartAudio()
         }
 
         // Update last audio write time
-        m_lastAudioWrite = QDateTime::currentDateTime();
+        m_lastAudioWriteMs = QDateTime::currentMSecsSinceEpoch();
 
         // Clear focus flags
         m_audioFocusLost = false;
         m_audioFocusPaused = false;
 
-        // Reset input resampler to clear stale buffered samples
-        if (m_inputResampler) {
-            m_inputResampler->reset();
-        }
+        {
+            const std::lock_guard<std::mutex> txLock(m_txMutex);
+            // Reset input resampler to clear stale buffered samples
+            if (m_inputResampler) {
+                m_inputResampler->reset();
+            }
 
-        // Clear pending input samples to avoid audio artifacts
-        m_pendingInputSamples.clear();
-        resetTxStartupPriming();
+            // Clear pending input samples to avoid audio artifacts
+            m_pendingInputSamples.clear();
+            resetTxStartupPriming();
+        }
 
         // Ensure audioReady is set after successful restart
         if (!m_audioReady) {
@@ -109,18 +115,19 @@ void AudioEngine::checkAudioHealth()
     }
 
     // Check if we haven't received audio in a while (more than 5 seconds)
-    if (m_lastAudioWrite.isValid() &&
-        m_lastAudioWrite.secsTo(QDateTime::currentDateTime()) > 5) {
+    if (m_lastAudioWriteMs > 0 &&
+        QDateTime::currentMSecsSinceEpoch() - m_lastAudioWriteMs > 5000) {
         // Flush jitter buffer (SVXLink equivalent of flushEncodedSamples)
         m_jitterBuffer.clear();
 
         // Reset audio sequence tracking
         m_lastAudioSeq = 0;
         m_hasLastAudioSeq = false;
-        m_lastDecodedFrameSamples = FRAME_SIZE_SAMPLES;
+        m_packetBuffer.reset();
+        m_lastDecodedFrameSamples = rxSamplesForMs(FRAME_SIZE_MS);
 
         // Clear the timestamp to prevent repeated flushing
-        m_lastAudioWrite = QDateTime();
+        m_lastAudioWriteMs = 0;
 
         // Re-request audio focus if needed
         #if defined(Q_OS_ANDROID)
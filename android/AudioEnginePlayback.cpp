@@ -18,8 +18,10 @@
 #include "AudioEngine.h"
 #include "AndroidAudioTrackOutput.h"
 #include <algorithm>
+#include <chrono>
 #include <QDebug>
 #include <QDateTime>
+#include <QMetaObject>
 #include <opus.h>
 
 #if defined(Q_OS_ANDROID)
@@ -28,6 +30,20 @@
 #  include <unistd.h>
 #endif
 
+namespace {
+// Stats are pushed to the UI at most about once per second of audio unless
+// the target itself moves.
+constexpr int kJitterStatsReportIntervalPackets = 50;
+// Receive loss is averaged over roughly the last two seconds of packets.
+constexpr double kRxLossAverageWeight = 1.0 / 100.0;
+
+qint64 steadyNowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}
+
 bool AudioEngine::startAndroidPlaybackOutput()
 {
 #if defined(Q_OS_ANDROID)
@@ -35,7 +51,20 @@ bool AudioEngine::startAndroidPlaybackOutput()
         m_androidAudioTrackOutput = std::make_unique<AndroidAudioTrackOutput>(&m_jitterBuffer);
     }
 
-    return m_androidAudioTrackOutput->start();
+    if (!m_androidAudioTrackOutput->start()) {
+        return false;
+    }
+
+    // The track opens at the mixer's rate.  The decoder and jitter buffer
+    // follow it, which has to happen with the playback thread stopped; only
+    // the first start, or a change of output, pays for the restart.
+    const int trackSampleRate = m_androidAudioTrackOutput->sampleRate();
+    if (codecSampleRateFor(trackSampleRate) != m_rxSampleRate) {
+        m_androidAudioTrackOutput->stop();
+        configureRxSampleRate(trackSampleRate);
+        return m_androidAudioTrackOutput->start();
+    }
+    return true;
 #else
     return false;
 #endif
@@ -119,7 +148,91 @@ void AudioEngine::setTranscriptionPipeFd(int fd)
 #endif
 }
 
-void AudioEngine::processReceivedAudio(const QByteArray &audioData, quint16 sequence)
+void AudioEngine::trackPacketArrival(quint16 sequence, qint64 arrivalUs)
+{
+    const int frameMs = std::clamp(m_lastDecodedFrameSamples,
+                                   rxSamplesForMs(FRAME_SIZE_MS),
+                                   rxSamplesForMs(MAX_FRAME_SIZE_MS)) * 1000 / m_rxSampleRate;
+    m_jitterEstimator.setFrameDurationMs(frameMs);
+    m_jitterEstimator.addArrival(sequence, arrivalUs);
+
+    applyJitterBufferTarget(++m_packetsSinceJitterReport >= kJitterStatsReportIntervalPackets);
+}
+
+void AudioEngine::applyJitterBufferTarget(bool forceReport)
+{
+    const int targetMs = m_adaptiveJitterBuffer ? m_jitterEstimator.targetDelayMs() : DEFAULT_PREBUF_MS;
+    const unsigned prebufSamples = static_cast<unsigned>(rxSamplesForMs(targetMs));
+    if (m_jitterBuffer.prebufSamples() != prebufSamples) {
+        // Takes effect the next time the buffer primes: at the start of a
+        // talk spurt or after an underrun.
+        m_jitterBuffer.setPrebufSamples(prebufSamples);
+    }
+
+    if (!forceReport && targetMs == m_reportedJitterTargetMs) {
+        return;
+    }
+    m_reportedJitterTargetMs = targetMs;
+    m_packetsSinceJitterReport = 0;
+    m_pendingJitterTargetMs.store(targetMs, std::memory_order_relaxed);
+    m_pendingJitterMs.store(static_cast<float>(m_jitterEstimator.jitterMs()), std::memory_order_relaxed);
+    m_jitterStatsPending.store(true, std::memory_order_release);
+}
+
+void AudioEngine::publishJitterBufferStats()
+{
+    if (m_jitterStatsPending.exchange(false, std::memory_order_acq_rel)) {
+        emit jitterBufferStatsChanged(m_pendingJitterTargetMs.load(std::memory_order_relaxed),
+                                      m_pendingJitterMs.load(std::memory_order_relaxed));
+    }
+}
+
+bool AudioEngine::enqueueReceivedAudio(const unsigned char* payload, int size, quint16 sequence, qint64 arrivalUs)
+{
+    if (!m_rxPacketQueue.push(sequence, payload, size, arrivalUs)) {
+        return false;
+    }
+    if (!m_rxDrainScheduled.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(this, &AudioEngine::drainReceivedAudio, Qt::QueuedConnection);
+    }
+    return true;
+}
+
+void AudioEngine::enqueueReceivedFlush()
+{
+    if (!m_rxPacketQueue.pushFlush()) {
+        // The audio thread is stalled with a full queue; nothing in it is
+        // worth keeping, so flush the lot.
+        QMetaObject::invokeMethod(this, &AudioEngine::flushAudioBuffers, Qt::QueuedConnection);
+        return;
+    }
+    if (!m_rxDrainScheduled.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(this, &AudioEngine::drainReceivedAudio, Qt::QueuedConnection);
+    }
+}
+
+void AudioEngine::drainReceivedAudio()
+{
+    // Cleared before draining: a packet pushed from here on either gets
+    // picked up by this loop or schedules the next drain.
+    m_rxDrainScheduled.store(false, std::memory_order_release);
+    while (const AudioPacketQueue::Packet* packet = m_rxPacketQueue.front()) {
+        if (packet->flush) {
+            resetReceivePath();
+        } else {
+            processReceivedPacket(packet->payload.data(), packet->size, packet->sequence, packet->arrivalUs);
+        }
+        m_rxPacketQueue.pop();
+    }
+}
+
+void AudioEngine::processReceivedAudio(const QByteArray &audioData, quint16 sequence, qint64 arrivalUs)
+{
+    processReceivedPacket(reinterpret_cast<const unsigned char*>(audioData.constData()),
+                          static_cast<int>(audioData.size()), sequence, arrivalUs);
+}
+
+void AudioEngine::processReceivedPacket(const unsigned char* payload, int size, quint16 sequence, qint64 arrivalUs)
 {
     if (!m_decoder || !m_audioReady) {
         qDebug() << "AudioEngine::processReceivedAudio - Audio not ready, skipping"
@@ -128,70 +241,184 @@ void AudioEngine::processReceivedAudio(const QByteArray &audioData, quint16 sequ
         return;
     }
 
-    // Sequence number gap handling with bounded PLC
-    if (m_hasLastAudioSeq) {
-        const quint16 expected = static_cast<quint16>(m_lastAudioSeq + 1);
-        const quint16 diff = static_cast<quint16>(sequence - expected);
+    if (arrivalUs < 0) {
+        arrivalUs = steadyNowUs();
+    }
+
+    // Late and reordered packets are still part of the arrival statistics.
+    trackPacketArrival(sequence, arrivalUs);
+
+    AudioPacketBuffer::InsertResult result = m_packetBuffer.insert(sequence, payload, size, arrivalUs);
+
+    if (result == AudioPacketBuffer::InsertResult::TooFarAhead) {
+        // A jump past the reorder window: play out what is held, conceal the
+        // start of the gap and continue from the new sequence.
+        releaseBufferedPackets(true, arrivalUs);
+        concealLostFrames(static_cast<quint16>(sequence - m_packetBuffer.nextSequence()));
+        m_packetBuffer.skipTo(sequence);
+        result = m_packetBuffer.insert(sequence, payload, size, arrivalUs);
+    }
+
+    if (result != AudioPacketBuffer::InsertResult::Accepted) {
+        // Behind the playout point or a duplicate — drop (SvxLink convention)
+        ++m_rxLatePackets;
+        return;
+    }
+
+    releaseBufferedPackets(false, arrivalUs);
+}
 
-        if (diff > 0x7fff) {
-            // Out-of-order / stale packet — drop (SvxLink convention)
-            return;
+void AudioEngine::onPacketPlayoutTimer()
+{
+    releaseBufferedPackets(false, steadyNowUs());
+}
+
+bool AudioEngine::packetGapIsDue(qint64 nowUs) const
+{
+    // Once playing, the missing packet is needed when the PCM buffer is down
+    // to its last frame.  While priming nothing drains, so bound the wait by
+    // the prebuffer depth instead.
+    if (!m_jitterBuffer.isPriming()
+            && m_jitterBuffer.samplesInBuffer() <= static_cast<unsigned>(rxSamplesForMs(FRAME_SIZE_MS))) {
+        return true;
+    }
+
+    const qint64 heldUs = nowUs - m_packetBuffer.oldestHeldArrivalUs();
+    const qint64 prebufUs = static_cast<qint64>(m_jitterBuffer.prebufSamples()) * 1000000 / m_rxSampleRate;
+    return heldUs >= prebufUs;
+}
+
+void AudioEngine::releaseBufferedPackets(bool force, qint64 nowUs)
+{
+    while (m_packetBuffer.heldCount() > 0) {
+        if (const AudioPacketBuffer::Packet* packet = m_packetBuffer.next()) {
+            decodeReceivedPacket(packet->payload.data(), static_cast<int>(packet->payload.size()));
+            recordRxPacketOutcome(false);
+            m_lastAudioSeq = packet->sequence;
+            m_hasLastAudioSeq = true;
+            m_packetBuffer.advance();
+            continue;
         }
 
-        if (diff > 0) {
-            // Lost frames — apply PLC for up to 3 frames (60ms), skip the rest
-            constexpr unsigned kMaxPlcFrames = 3;
-            const unsigned plcCount = std::min(static_cast<unsigned>(diff), kMaxPlcFrames);
-            const int plcFrameSamples = std::clamp(m_lastDecodedFrameSamples,
-                                                   FRAME_SIZE_SAMPLES,
-                                                   MAX_FRAME_SIZE_SAMPLES);
-            for (unsigned i = 0; i < plcCount; ++i) {
-                std::vector<float> plc(static_cast<size_t>(plcFrameSamples * CHANNELS));
-                int plcSamples = m_decoder->decode(nullptr, 0, plc.data(), plcFrameSamples);
-                if (plcSamples > 0) {
-                    applyRxGain(plc.data(), plcSamples);
-                    updateRxMeter(plc.data(), plcSamples);
-                    m_jitterBuffer.writeSamples(plc.data(), plcSamples);
-                }
-            }
-            if (diff > kMaxPlcFrames) {
-                qDebug() << "AudioEngine: skipped" << (diff - kMaxPlcFrames)
-                         << "lost frames beyond PLC limit";
-            }
+        if (!force && !packetGapIsDue(nowUs)) {
+            break;
+        }
+
+        const int missing = m_packetBuffer.gapBeforeNextHeld();
+        for (int i = 0; i < missing; ++i) {
+            recordRxPacketOutcome(true);
+        }
+
+        // A single lost frame can be rebuilt from the LBRR copy the sender
+        // piggybacks on the following packet.
+        const AudioPacketBuffer::Packet* following = m_packetBuffer.peek(missing);
+        if (missing != 1 || following == nullptr
+                || !recoverLostFrameFromFec(following->payload.data(),
+                                            static_cast<int>(following->payload.size()))) {
+            concealLostFrames(static_cast<unsigned>(missing));
+        }
+        for (int i = 0; i < missing; ++i) {
+            m_packetBuffer.advance();
+        }
+    }
+
+    if (m_packetBuffer.heldCount() > 0) {
+        if (m_packetPlayoutTimer && !m_packetPlayoutTimer->isActive()) {
+            m_packetPlayoutTimer->start();
+        }
+    } else if (m_packetPlayoutTimer) {
+        m_packetPlayoutTimer->stop();
+    }
+}
+
+void AudioEngine::concealLostFrames(unsigned missing)
+{
+    if (missing == 0 || !m_decoder) {
+        return;
+    }
+
+    // Lost frames — apply PLC for up to 3 frames (60ms), skip the rest
+    constexpr unsigned kMaxPlcFrames = 3;
+    const unsigned plcCount = std::min(missing, kMaxPlcFrames);
+    const int plcFrameSamples = std::clamp(m_lastDecodedFrameSamples,
+                                           rxSamplesForMs(FRAME_SIZE_MS),
+                                           rxSamplesForMs(MAX_FRAME_SIZE_MS));
+    float* plc = m_rxFrameBuffer.data();
+    for (unsigned i = 0; i < plcCount; ++i) {
+        int plcSamples = m_decoder->decode(nullptr, 0, plc, plcFrameSamples);
+        if (plcSamples > 0) {
+            applyRxGain(plc, plcSamples);
+            updateRxMeter(plc, plcSamples);
+            m_jitterBuffer.writeSamples(plc, plcSamples);
+            ++m_rxConcealedFrames;
         }
     }
+    if (missing > kMaxPlcFrames) {
+        m_rxSkippedFrames += missing - kMaxPlcFrames;
+        qDebug() << "AudioEngine: skipped" << (missing - kMaxPlcFrames)
+                 << "lost frames beyond PLC limit";
+    }
+}
+
+bool AudioEngine::recoverLostFrameFromFec(const unsigned char* nextPayload, int size)
+{
+    // Without LBRR data libopus answers a FEC decode with plain PLC; let the
+    // caller's concealment path handle that so the FEC count stays honest.
+    if (!m_decoder || !OpusDecoder::packetHasLbrr(nextPayload, size)) {
+        return false;
+    }
+
+    // The FEC frame has to be requested at the duration of the lost packet.
+    const int frameSamples = std::clamp(m_lastDecodedFrameSamples,
+                                        rxSamplesForMs(FRAME_SIZE_MS),
+                                        rxSamplesForMs(MAX_FRAME_SIZE_MS));
+    float* recovered = m_rxFrameBuffer.data();
+    const int recoveredSamples = m_decoder->decode(nextPayload, size, recovered, frameSamples, true);
+    if (recoveredSamples <= 0) {
+        return false;
+    }
 
-    // Decode the Opus audio data - hybrid approach for optimal performance
-    // Try normal 20ms buffer first, fallback to larger buffer for v1 clients with 40/60ms frames
-    std::vector<float> decodedSamples(FRAME_SIZE_SAMPLES * CHANNELS);
-    int decodedSampleCount = m_decoder->decode(
-        reinterpret_cast<const unsigned char*>(audioData.constData()),
-        audioData.size(),
-        decodedSamples.data(),
-        FRAME_SIZE_SAMPLES
-    );
+    applyRxGain(recovered, recoveredSamples);
+    updateRxMeter(recovered, recoveredSamples);
+    m_jitterBuffer.writeSamples(recovered, recoveredSamples);
+    ++m_rxFecRecoveredFrames;
+    return true;
+}
 
-    // If buffer too small, retry with larger buffer for legacy clients
-    if (decodedSampleCount == OPUS_BUFFER_TOO_SMALL) {
-        decodedSamples.resize(MAX_FRAME_SIZE_SAMPLES * CHANNELS);
-        decodedSampleCount = m_decoder->decode(
-            reinterpret_cast<const unsigned char*>(audioData.constData()),
-            audioData.size(),
-            decodedSamples.data(),
-            MAX_FRAME_SIZE_SAMPLES
-        );
+void AudioEngine::recordRxPacketOutcome(bool lost)
+{
+    const double lossFraction = m_rxLossFraction.load(std::memory_order_relaxed);
+    m_rxLossFraction.store(lossFraction + ((lost ? 1.0 : 0.0) - lossFraction) * kRxLossAverageWeight,
+                           std::memory_order_relaxed);
+}
+
+void AudioEngine::decodeReceivedPacket(const unsigned char* payload, int size)
+{
+    // The TOC byte gives the frame length up front (20 ms here, up to 60 ms
+    // from v1 clients), so one decode into the preallocated frame suffices.
+    const int packetSamples = m_decoder->packetSamples(payload, size);
+    if (packetSamples <= 0 || packetSamples > rxSamplesForMs(MAX_FRAME_SIZE_MS)) {
+        qWarning() << "Opus decode error: unsupported packet of" << packetSamples << "samples";
+        return;
     }
 
+    float* decodedSamples = m_rxFrameBuffer.data();
+    const int decodedSampleCount = m_decoder->decode(payload, size, decodedSamples, packetSamples);
+
     if (decodedSampleCount > 0) {
         m_lastDecodedFrameSamples = decodedSampleCount;
-        applyRxGain(decodedSamples.data(), decodedSampleCount);
-        updateRxMeter(decodedSamples.data(), decodedSampleCount);
+        applyRxGain(decodedSamples, decodedSampleCount);
+        updateRxMeter(decodedSamples, decodedSampleCount);
 
 #if defined(Q_OS_ANDROID)
         if (m_transcriptionPipeFd >= 0) {
-            m_transcriptionPcmBuffer.resize(static_cast<size_t>(decodedSampleCount));
-            for (int i = 0; i < decodedSampleCount; ++i) {
-                const float sample = clampAudioSample(decodedSamples[i]);
+            // The transcriber takes 16 kHz PCM whatever the decode rate.
+            int tapSampleCount = decodedSampleCount;
+            const float* tapSamples = svxlinkRateTap(m_transcriptionResampler.get(), decodedSamples,
+                                                     tapSampleCount, m_transcriptionTapBuffer);
+            m_transcriptionPcmBuffer.resize(static_cast<size_t>(tapSampleCount));
+            for (int i = 0; i < tapSampleCount; ++i) {
+                const float sample = clampAudioSample(tapSamples[i]);
                 m_transcriptionPcmBuffer[static_cast<size_t>(i)] =
                         static_cast<int16_t>(sample * 32767.0f);
             }
@@ -216,9 +443,9 @@ void AudioEngine::processReceivedAudio(const QByteArray &audioData, quint16 sequ
         }
 #endif
 
-        // Write the NATIVE 16kHz samples directly to the jitter buffer
+        // Write the samples at the decode rate directly to the jitter buffer
         // DO NOT RESAMPLE HERE - AudioStreamDevice will handle resampling
-        m_jitterBuffer.writeSamples(decodedSamples.data(), decodedSampleCount);
+        m_jitterBuffer.writeSamples(decodedSamples, decodedSampleCount);
 
         // Trigger the AudioStreamDevice to notify QAudioSink that data is available
         if (m_audioStreamDevice) {
@@ -226,31 +453,39 @@ void AudioEngine::processReceivedAudio(const QByteArray &audioData, quint16 sequ
         }
 
         // Update last audio write time
-        m_lastAudioWrite = QDateTime::currentDateTime();
+        m_lastAudioWriteMs = QDateTime::currentMSecsSinceEpoch();
     } else {
         qWarning() << "Opus decode error:" << opus_strerror(decodedSampleCount);
     }
-
-    m_lastAudioSeq = sequence;
-    m_hasLastAudioSeq = true;
 }
 
 void AudioEngine::flushAudioBuffers()
+{
+    // Drop anything still queued from the socket thread too
+    m_rxPacketQueue.clear();
+    resetReceivePath();
+}
+
+void AudioEngine::resetReceivePath()
 {
     qDebug() << "AudioEngine::flushAudioBuffers - Starting flush";
 
-    // Clear jitter buffer
     m_jitterBuffer.clear();
 
     // Reset last audio sequence
     m_lastAudioSeq = 0;
     m_hasLastAudioSeq = false;
-    m_lastDecodedFrameSamples = FRAME_SIZE_SAMPLES;
+    m_lastDecodedFrameSamples = rxSamplesForMs(FRAME_SIZE_MS);
+    m_jitterEstimator.startNewTalkSpurt();
+    m_packetBuffer.reset();
+    if (m_packetPlayoutTimer) {
+        m_packetPlayoutTimer->stop();
+    }
 
     // Reset Opus decoder to clear internal state (prevents "corrupted stream" errors)
     if (m_decoder) {
         m_decoder.reset();
-        m_decoder = std::make_unique<OpusDecoder>(SAMPLE_RATE, CHANNELS);
+        m_decoder = std::make_unique<OpusDecoder>(m_rxSampleRate, CHANNELS);
     }
 
     qDebug() << "AudioEngine::flushAudioBuffers - Flush completed";
@@ -21,6 +21,7 @@
 #include <QTimer>
 #include <QMetaObject>
 #include <algorithm>
+#include <chrono>
 #include <opus.h>
 
 #if defined(Q_OS_ANDROID)
@@ -29,8 +30,20 @@
 
 namespace {
 constexpr int kTxStartupLeadInFrames = 2;
+// SvxReflector drops a talker after 3 s without audio; one packet this
+// often through a pause keeps the talkgroup, like Opus's own DTX refresh.
+constexpr int kTxDtxKeepAliveMs = 400;
+
+qint64 steadyNowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 }
 
+static_assert(VoiceActivityDetector::FRAME_SAMPLES == AudioEngine::FRAME_SIZE_SAMPLES,
+              "the TX VAD scores 20 ms frames");
+
 void AudioEngine::startRecording()
 {
     qDebug() << "AudioEngine::startRecording called - audioSource:" << (m_audioSource ? "OK" : "NULL")
@@ -61,6 +74,8 @@ void AudioEngine::startRecording()
         return;
     }
 
+    resetTxForTransmission();
+
 #if defined(Q_OS_ANDROID)
     if (m_androidAudioRecordInput) {
         // Set MODE_IN_COMMUNICATION and request exclusive focus for TX
@@ -76,6 +91,7 @@ void AudioEngine::startRecording()
         if (startAndroidCaptureInput()) {
             m_audioInputDevice = nullptr;
             sendTxStartupLeadIn();
+            startTxEncodeThread();
             qDebug() << "AudioEngine::startRecording - Android native capture started (TX mode)";
             return;
         }
@@ -110,6 +126,31 @@ void AudioEngine::startRecording()
     }
 }
 
+void AudioEngine::resetTxForTransmission()
+{
+    // Size the FEC and bitrate for the link as measured since the last
+    // transmission.
+    m_txFramesSinceControl = 0;
+    applyTxEncoderSettings();
+    m_audioLimiter.setLookAheadSamples(txSamplesForMs(m_txLookAheadMs));
+    m_audioLimiter.reset();
+    reportTxProcessingLatency();
+    m_txVad.reset();
+    if (m_txVadResampler) {
+        m_txVadResampler->reset();
+    }
+    m_txDtxPausedMs = 0;
+    m_txDtxHeldPackets = 0;
+    m_txBacklogDroppedUs = 0;
+    m_txEncodedPackets = 0;
+    m_txEncodeTotalUs = 0;
+    m_txEncodeMaxUs = 0;
+    m_txMissedDeadlines = 0;
+    m_txEncodeErrors = 0;
+    m_txCaptureRateMismatches = 0;
+    configureTxBacklog();
+}
+
 void AudioEngine::stopRecording()
 {
     if (!m_recording) {
@@ -121,6 +162,7 @@ void AudioEngine::stopRecording()
 #if defined(Q_OS_ANDROID)
     if (usesAndroidNativeInput()) {
         stopAndroidCaptureInput();
+        stopTxEncodeThread();
         m_recording = false;
         flushPendingTxSamples();
         m_pendingInputSamples.clear();
@@ -280,11 +322,9 @@ void AudioEngine::onAudioInputReadyRead()
 
     // Apply resampling if needed
     const float* sampleData = m_reusableFloatBuffer.data();
-    std::vector<float> resampledData;
     if (m_inputResampler) {
-        resampledData = m_inputResampler->process(sampleData, samplesRead);
-        sampleData = resampledData.data();
-        samplesRead = resampledData.size();
+        samplesRead = resampleCapturedSamples(sampleData, samplesRead);
+        sampleData = m_resampledInputBuffer.data();
     }
 
     processCapturedFloatSamples(const_cast<float*>(sampleData), samplesRead);
@@ -313,11 +353,9 @@ bool AudioEngine::startAndroidCaptureInput()
     m_inputFormat.setSampleFormat(
         m_androidAudioRecordInput->usesFloatCapture() ? QAudioFormat::Float : QAudioFormat::Int16);
 
-    if (captureSampleRate != SAMPLE_RATE) {
-        m_inputResampler = std::make_unique<Resampler>(captureSampleRate, SAMPLE_RATE, CHANNELS);
-    } else {
-        m_inputResampler.reset();
-    }
+    // Nothing has been captured or encoded yet, so the encoder can still
+    // move to the capture rate.
+    configureTxSampleRate(captureSampleRate);
 
     return true;
 #else
@@ -354,19 +392,14 @@ bool AudioEngine::usesAndroidNativeInput() const
 
 void AudioEngine::queueCapturedNativeFloatSamples(const float* samples, int count, int sampleRate)
 {
+    // Runs on the capture thread: a copy into a preallocated slot, and one
+    // wake-up for however many blocks arrive before the engine thread
+    // gets to them.
     if (samples == nullptr || count <= 0) {
         return;
     }
-
-    std::vector<float> sampleCopy(samples, samples + count);
-    QMetaObject::invokeMethod(
-        this,
-        [this, sampleCopy = std::move(sampleCopy), sampleRate]() mutable {
-            processCapturedNativeFloatSamples(sampleCopy.data(),
-                                             static_cast<int>(sampleCopy.size()),
-                                             sampleRate);
-        },
-        Qt::QueuedConnection);
+    m_txCaptureQueue.push(samples, count, sampleRate, steadyNowUs());
+    wakeCaptureConsumer();
 }
 
 void AudioEngine::queueCapturedInt16Samples(const short* samples, int count, int sampleRate)
@@ -374,18 +407,111 @@ void AudioEngine::queueCapturedInt16Samples(const short* samples, int count, int
     if (samples == nullptr || count <= 0) {
         return;
     }
+    m_txCaptureQueue.push(samples, count, sampleRate, steadyNowUs());
+    wakeCaptureConsumer();
+}
+
+void AudioEngine::wakeCaptureConsumer()
+{
+    if (m_txEncodeThreadActive.load(std::memory_order_acquire)) {
+        m_txEncodeThread->wake();
+        return;
+    }
+    if (!m_txCaptureDrainScheduled.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(this, &AudioEngine::drainCapturedAudio, Qt::QueuedConnection);
+    }
+}
+
+void AudioEngine::drainCapturedAudio()
+{
+    // Cleared before draining, as for received audio.  A drain queued
+    // just before the encode thread took over waits for it here.
+    m_txCaptureDrainScheduled.store(false, std::memory_order_release);
+    const std::lock_guard<std::mutex> txLock(m_txMutex);
+    processCaptureQueue();
+}
+
+void AudioEngine::processCaptureQueue()
+{
+    while (AudioCaptureQueue::Block* block = m_txCaptureQueue.front()) {
+        if (!txCaptureIsStale(block->durationUs)) {
+            m_txCaptureBlockUs = block->captureUs;
+            processCapturedNativeFloatSamples(block->samples.data(), block->count, block->sampleRate);
+        }
+        m_txCaptureQueue.pop();
+    }
+    m_txCaptureBlockUs = 0;
+}
 
-    // Marshal native capture back onto the AudioEngine thread so TX state
-    // and the Opus encoder are never mutated concurrently from the JNI thread.
-    std::vector<short> sampleCopy(samples, samples + count);
-    QMetaObject::invokeMethod(
-        this,
-        [this, sampleCopy = std::move(sampleCopy), sampleRate]() mutable {
-            processCapturedInt16Samples(sampleCopy.data(),
-                                       static_cast<int>(sampleCopy.size()),
-                                       sampleRate);
-        },
-        Qt::QueuedConnection);
+void AudioEngine::startTxEncodeThread()
+{
+    if (!m_txEncodeThreadEnabled) {
+        return;
+    }
+    if (!m_txEncodeThread) {
+        m_txEncodeThread = std::make_unique<TxEncodeThread>([this]() {
+            const std::lock_guard<std::mutex> txLock(m_txMutex);
+            processCaptureQueue();
+        });
+    }
+    if (!m_txEncodeThread->start()) {
+        qWarning() << "AudioEngine::startTxEncodeThread - Could not start, encoding on the engine thread";
+        return;
+    }
+    m_txEncodeThreadActive.store(true, std::memory_order_release);
+    // Whatever was captured before the handover.
+    m_txEncodeThread->wake();
+}
+
+void AudioEngine::stopTxEncodeThread()
+{
+    if (!m_txEncodeThreadActive.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    const TxEncodeThread::Priority priority = m_txEncodeThread->priority();
+    m_txEncodeThread->stop();
+    qDebug() << "AudioEngine::stopTxEncodeThread - TX encode thread ran"
+             << (priority == TxEncodeThread::Priority::RealTime ? "SCHED_FIFO"
+                 : priority == TxEncodeThread::Priority::Nice ? "at nice -19"
+                 : "at normal priority");
+
+    // The tail captured before capture stopped goes out from here, after
+    // the packets the thread already encoded.
+    const std::lock_guard<std::mutex> txLock(m_txMutex);
+    drainEncodedAudio();
+    processCaptureQueue();
+}
+
+bool AudioEngine::txCaptureIsStale(qint64 blockUs)
+{
+    if (!m_recording) {
+        return false;
+    }
+
+    // What was captured after this block and is still queued, plus what
+    // waits for the encoder, is how late this block would go on air.
+    const qint64 newerUs = m_txCaptureQueue.queuedUs() - blockUs;
+    const qint64 pendingUs = static_cast<qint64>(m_pendingInputSamples.size()) * 1000000 / m_txSampleRate;
+    if (newerUs + pendingUs <= static_cast<qint64>(m_txMaxBacklogMs) * 1000) {
+        return false;
+    }
+    m_txBacklogDroppedUs += blockUs;
+    return true;
+}
+
+void AudioEngine::configureTxBacklog()
+{
+    // One packet of headroom so a full backlog still completes a packet.
+    m_pendingInputSamples.configure(m_txFrameSamples, txSamplesForMs(m_txMaxBacklogMs) + m_txFrameSamples);
+}
+
+void AudioEngine::pushPendingTxSamples(const float* samples, int count)
+{
+    const int droppedSamples = m_pendingInputSamples.push(samples, count);
+    if (droppedSamples > 0) {
+        m_txBacklogDroppedUs += static_cast<qint64>(droppedSamples) * 1000000 / m_txSampleRate;
+    }
 }
 
 int AudioEngine::encodeTxFrame(const float* frameSamples)
@@ -394,37 +520,119 @@ int AudioEngine::encodeTxFrame(const float* frameSamples)
         return OPUS_BAD_ARG;
     }
 
+    controlTxEncoder();
+
+    // Encode straight into the next datagram when the sender is active;
+    // sent by sendEncodedTxFrames().
+    const bool direct = m_udpAudioSender && m_udpAudioSender->isActive();
+    unsigned char* output = direct ? m_udpAudioSender->beginFrame() : m_reusableOpusBuffer.data();
+    const auto encodeStart = std::chrono::steady_clock::now();
     const int encodedBytes = m_encoder->encode(
         frameSamples,
-        FRAME_SIZE_SAMPLES,
-        m_reusableOpusBuffer.data(),
-        OPUS_BUFFER_SIZE);
+        m_txFrameSamples,
+        output,
+        direct ? UdpAudioSender::MAX_PAYLOAD_BYTES : OPUS_BUFFER_SIZE);
+    const auto encodeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - encodeStart).count();
+    m_txEncoderController.reportEncodeTime(static_cast<int>(encodeUs), m_txFrameSizeMs * 1000);
+    ++m_txEncodedPackets;
+    m_txEncodeTotalUs += encodeUs;
+    m_txEncodeMaxUs = std::max(m_txEncodeMaxUs, static_cast<int>(encodeUs));
+    // Due one packet after the capture block that completed it.
+    if (m_txCaptureBlockUs > 0 && steadyNowUs() - m_txCaptureBlockUs > m_txFrameSizeMs * 1000LL) {
+        ++m_txMissedDeadlines;
+    }
+
     if (encodedBytes <= 0) {
         return encodedBytes;
     }
+    if (direct) {
+        m_udpAudioSender->commitFrame(encodedBytes);
+        return encodedBytes;
+    }
 
+    if (m_txEncodeThreadActive.load(std::memory_order_acquire)) {
+        // No signals from the real-time thread: the packet is copied into a
+        // preallocated slot and this thread emits it.
+        m_txPacketQueue.push(0, m_reusableOpusBuffer.data(), encodedBytes, 0);
+        if (!m_txPacketDrainScheduled.exchange(true, std::memory_order_acq_rel)) {
+            QMetaObject::invokeMethod(this, &AudioEngine::drainEncodedAudio, Qt::QueuedConnection);
+        }
+        return encodedBytes;
+    }
+
+    // Whatever the encode thread left goes out first.
+    drainEncodedAudio();
     QByteArray encodedData(reinterpret_cast<const char*>(m_reusableOpusBuffer.data()), encodedBytes);
     emit audioDataEncoded(encodedData);
     return encodedBytes;
 }
 
-void AudioEngine::encodeReadyTxFrames(const char* logContext)
+void AudioEngine::drainEncodedAudio()
 {
-    while (m_pendingInputSamples.size() >= FRAME_SIZE_SAMPLES) {
-        const int encodedBytes = encodeTxFrame(m_pendingInputSamples.data());
-        if (encodedBytes > 0) {
-            if (logContext != nullptr) {
-                qDebug() << logContext << encodedBytes
-                         << "bytes, emitted audioDataEncoded signal";
-            }
-        } else {
-            qWarning() << "Opus encode error:" << opus_strerror(encodedBytes);
+    m_txPacketDrainScheduled.store(false, std::memory_order_release);
+    while (const AudioPacketQueue::Packet* packet = m_txPacketQueue.front()) {
+        emit audioDataEncoded(QByteArray(reinterpret_cast<const char*>(packet->payload.data()), packet->size));
+        m_txPacketQueue.pop();
+    }
+}
+
+void AudioEngine::encodeReadyTxFrames()
+{
+    while (m_pendingInputSamples.hasFrame()) {
+        if (!txPacketIsDue(m_pendingInputSamples.frame())) {
+            m_pendingInputSamples.popFrame();
+            continue;
+        }
+
+        const int encodedBytes = encodeTxFrame(m_pendingInputSamples.frame());
+        if (encodedBytes <= 0) {
+            ++m_txEncodeErrors;
+            m_txLastEncodeError = encodedBytes;
             break;
         }
 
-        m_pendingInputSamples.erase(
-            m_pendingInputSamples.begin(),
-            m_pendingInputSamples.begin() + FRAME_SIZE_SAMPLES);
+        m_pendingInputSamples.popFrame();
+    }
+    sendEncodedTxFrames();
+}
+
+bool AudioEngine::txPacketIsDue(const float* packetSamples)
+{
+    if (!m_txDtxEnabled) {
+        return true;
+    }
+
+    // Every 20 ms frame of the packet is scored so the VAD keeps its pace;
+    // it is tuned to 16 kHz, so it listens to the tap.
+    int vadSamples = m_txFrameSamples;
+    const float* vadInput = svxlinkRateTap(m_txVadResampler.get(), packetSamples, vadSamples, m_txVadTapBuffer);
+    bool voice = false;
+    for (int offset = 0; offset + FRAME_SIZE_SAMPLES <= vadSamples; offset += FRAME_SIZE_SAMPLES) {
+        voice = m_txVad.process(vadInput + offset) || voice;
+    }
+    if (voice) {
+        m_txDtxPausedMs = 0;
+        return true;
+    }
+
+    // Held packets are neither encoded nor numbered, so the encoder and
+    // every receiver's decoder skip the same frames and nobody conceals.
+    m_txDtxPausedMs += m_txFrameSizeMs;
+    if (m_txDtxPausedMs >= kTxDtxKeepAliveMs) {
+        m_txDtxPausedMs = 0;
+        return true;
+    }
+    ++m_txDtxHeldPackets;
+    return false;
+}
+
+void AudioEngine::sendEncodedTxFrames()
+{
+    // Frames encoded in one pass (the lead-in, the primed startup audio)
+    // leave in a single batch.
+    if (m_udpAudioSender) {
+        m_udpAudioSender->flush();
     }
 }
 
@@ -432,8 +640,7 @@ void AudioEngine::prepareTxStartupPriming()
 {
     resetTxStartupPriming();
     m_txStartupPrimingActive = true;
-    m_txStartupPrimingTargetSamples = kTxStartupLeadInFrames * FRAME_SIZE_SAMPLES;
-    m_txStartupBuffer.reserve(static_cast<size_t>(m_txStartupPrimingTargetSamples) * 2U);
+    m_txStartupPrimingTargetSamples = txSamplesForMs(kTxStartupLeadInFrames * FRAME_SIZE_MS);
 }
 
 void AudioEngine::sendTxStartupLeadIn()
@@ -442,8 +649,11 @@ void AudioEngine::sendTxStartupLeadIn()
         return;
     }
 
+    // The same lead-in duration whatever the packet size, at least one packet.
+    const int leadInPackets = std::max(
+        1, kTxStartupLeadInFrames * FRAME_SIZE_MS / m_txFrameSizeMs);
     int sentFrames = 0;
-    for (int i = 0; i < kTxStartupLeadInFrames; ++i) {
+    for (int i = 0; i < leadInPackets; ++i) {
         const int encodedBytes = encodeTxFrame(m_txLeadInSilenceFrame.data());
         if (encodedBytes <= 0) {
             qWarning() << "Opus encode error while sending TX lead-in silence:"
@@ -452,29 +662,18 @@ void AudioEngine::sendTxStartupLeadIn()
         }
         ++sentFrames;
     }
+    sendEncodedTxFrames();
 
     if (sentFrames > 0) {
         qDebug() << "AudioEngine::sendTxStartupLeadIn - Sent" << sentFrames
-                 << "TX lead-in silence frames before releasing buffered speech";
+                 << m_txFrameSizeMs << "ms TX lead-in silence frames before releasing buffered speech";
     }
 }
 
 void AudioEngine::flushBufferedTxStartupAudio()
 {
-    if (m_txStartupBuffer.empty()) {
-        resetTxStartupPriming();
-        return;
-    }
-
-    m_pendingInputSamples.reserve(m_pendingInputSamples.size() + m_txStartupBuffer.size());
-    m_pendingInputSamples.insert(
-        m_pendingInputSamples.end(),
-        m_txStartupBuffer.begin(),
-        m_txStartupBuffer.end());
-
-    qDebug() << "AudioEngine::flushBufferedTxStartupAudio - Released"
-             << m_txStartupBuffer.size() << "startup TX samples after priming";
-
+    // The primed audio is already queued; releasing it just lets the
+    // encoder at it.  Not logged: this runs on the encode path.
     resetTxStartupPriming();
 }
 
@@ -482,7 +681,6 @@ void AudioEngine::resetTxStartupPriming()
 {
     m_txStartupPrimingActive = false;
     m_txStartupPrimingTargetSamples = 0;
-    m_txStartupBuffer.clear();
 }
 
 void AudioEngine::flushPendingTxSamples()
@@ -495,17 +693,47 @@ void AudioEngine::flushPendingTxSamples()
     if (m_txStartupPrimingActive) {
         flushBufferedTxStartupAudio();
     }
+    drainTxLimiter();
 
-    if (m_pendingInputSamples.empty()) {
-        return;
+    if (m_txDtxHeldPackets > 0) {
+        qDebug() << "AudioEngine::flushPendingTxSamples - DTX held back" << m_txDtxHeldPackets
+                 << "TX packets during pauses";
+        m_txDtxHeldPackets = 0;
+    }
+    if (m_txBacklogDroppedUs > 0) {
+        qDebug() << "AudioEngine::flushPendingTxSamples - Dropped" << m_txBacklogDroppedUs / 1000
+                 << "ms of TX audio that fell more than" << m_txMaxBacklogMs << "ms behind";
+        m_txBacklogDroppedUs = 0;
+    }
+    if (m_txCaptureRateMismatches > 0) {
+        qWarning() << "AudioEngine::flushPendingTxSamples - Dropped" << m_txCaptureRateMismatches
+                   << "capture blocks at a rate the TX resampler was not built for";
+        m_txCaptureRateMismatches = 0;
+    }
+    if (m_txEncodeErrors > 0) {
+        qWarning() << "AudioEngine::flushPendingTxSamples - Opus encode failed" << m_txEncodeErrors
+                   << "times, last error:" << opus_strerror(m_txLastEncodeError);
+        m_txEncodeErrors = 0;
+    }
+    if (m_txEncodedPackets > 0) {
+        const int meanEncodeUs = static_cast<int>(m_txEncodeTotalUs / m_txEncodedPackets);
+        qDebug() << "AudioEngine::flushPendingTxSamples - Encoded" << m_txEncodedPackets
+                 << "TX packets in" << meanEncodeUs << "us mean," << m_txEncodeMaxUs << "us max;"
+                 << m_txMissedDeadlines << "missed their deadline";
+        emit txEncodeStatsChanged(meanEncodeUs, m_txEncodeMaxUs, m_txMissedDeadlines);
+        m_txEncodedPackets = 0;
+        m_txEncodeTotalUs = 0;
+        m_txEncodeMaxUs = 0;
+        m_txMissedDeadlines = 0;
     }
 
-    if (m_pendingInputSamples.size() < FRAME_SIZE_SAMPLES) {
-        m_pendingInputSamples.resize(FRAME_SIZE_SAMPLES, 0.0f);
+    if (m_pendingInputSamples.empty()) {
+        return;
     }
 
-    while (m_pendingInputSamples.size() >= FRAME_SIZE_SAMPLES) {
-        const int encodedBytes = encodeTxFrame(m_pendingInputSamples.data());
+    m_pendingInputSamples.padToFrame();
+    while (m_pendingInputSamples.hasFrame()) {
+        const int encodedBytes = encodeTxFrame(m_pendingInputSamples.frame());
         if (encodedBytes > 0) {
             qDebug() << "AudioEngine::flushPendingTxSamples - Encoded final" << encodedBytes
                      << "byte TX frame during drain";
@@ -514,10 +742,26 @@ void AudioEngine::flushPendingTxSamples()
             break;
         }
 
-        m_pendingInputSamples.erase(
-            m_pendingInputSamples.begin(),
-            m_pendingInputSamples.begin() + FRAME_SIZE_SAMPLES);
+        m_pendingInputSamples.popFrame();
     }
+    sendEncodedTxFrames();
+}
+
+void AudioEngine::drainTxLimiter()
+{
+    // The last look-ahead worth of speech is still in the limiter's delay
+    // line; push it out with silence so the over ends where PTT did.
+    const int latencySamples = m_audioLimiter.latencySamples();
+    if (latencySamples <= 0) {
+        return;
+    }
+
+    if (m_reusableFloatBuffer.size() < static_cast<size_t>(latencySamples)) {
+        m_reusableFloatBuffer.resize(static_cast<size_t>(latencySamples));
+    }
+    std::fill_n(m_reusableFloatBuffer.begin(), latencySamples, 0.0f);
+    m_audioLimiter.processAudio(m_reusableFloatBuffer.data(), latencySamples);
+    pushPendingTxSamples(m_reusableFloatBuffer.data(), latencySamples);
 }
 
 void AudioEngine::processCapturedFloatSamples(float* samples, int count)
@@ -530,79 +774,96 @@ void AudioEngine::processCapturedFloatSamples(float* samples, int count)
     m_audioLimiter.processAudio(samples, count);
     updateTxMeter(samples, count);
 
+    pushPendingTxSamples(samples, count);
     if (m_txStartupPrimingActive) {
-        m_txStartupBuffer.insert(m_txStartupBuffer.end(), samples, samples + count);
-        if (static_cast<int>(m_txStartupBuffer.size()) < m_txStartupPrimingTargetSamples) {
+        if (static_cast<int>(m_pendingInputSamples.size()) < m_txStartupPrimingTargetSamples) {
             return;
         }
 
         flushBufferedTxStartupAudio();
-    } else {
-        m_pendingInputSamples.reserve(m_pendingInputSamples.size() + count);
-        m_pendingInputSamples.insert(m_pendingInputSamples.end(), samples, samples + count);
     }
 
-    encodeReadyTxFrames(nullptr);
+    encodeReadyTxFrames();
 }
 
-void AudioEngine::processCapturedNativeFloatSamples(float* samples, int count, int sampleRate)
+int AudioEngine::resampleCapturedSamples(const float* samples, int count)
 {
-    if (!m_recording || samples == nullptr || count <= 0) {
-        return;
+    // Grows only when a larger capture chunk than any before arrives.
+    const int capacity = m_inputResampler->maxOutputSamples(count);
+    if (m_resampledInputBuffer.size() < static_cast<size_t>(capacity)) {
+        m_resampledInputBuffer.resize(static_cast<size_t>(capacity));
     }
+    return std::max(0, m_inputResampler->process(samples, count, m_resampledInputBuffer.data(), capacity));
+}
 
-    float* sampleData = samples;
-    int samplesRead = count;
-    std::vector<float> resampledData;
-
-    if (sampleRate != SAMPLE_RATE) {
-        if (!m_inputResampler
-                || m_inputFormat.sampleRate() != sampleRate
-                || m_inputFormat.sampleFormat() != QAudioFormat::Float) {
-            m_inputResampler = std::make_unique<Resampler>(sampleRate, SAMPLE_RATE, CHANNELS);
-            m_inputFormat.setSampleRate(sampleRate);
-            m_inputFormat.setChannelCount(CHANNELS);
-            m_inputFormat.setSampleFormat(QAudioFormat::Float);
+void AudioEngine::configureTxSampleRate(int captureSampleRate)
+{
+    const int sampleRate = codecSampleRateFor(captureSampleRate);
+    if (captureSampleRate != sampleRate) {
+        m_inputResampler = std::make_unique<Resampler>(captureSampleRate, sampleRate, CHANNELS);
+        // Sized for a whole native capture block, so the encode thread
+        // never grows it.
+        const int capacity = m_inputResampler->maxOutputSamples(AudioCaptureQueue::MAX_BLOCK_SAMPLES);
+        if (m_resampledInputBuffer.size() < static_cast<size_t>(capacity)) {
+            m_resampledInputBuffer.resize(static_cast<size_t>(capacity));
         }
-
-        resampledData = m_inputResampler->process(sampleData, samplesRead);
-        sampleData = resampledData.data();
-        samplesRead = static_cast<int>(resampledData.size());
+    } else {
+        m_inputResampler.reset();
+    }
+    if (sampleRate == m_txSampleRate) {
+        return;
+    }
+    m_txSampleRate = sampleRate;
+
+    // Gain, limiter, meter and packetizer all run at the encoder's rate.
+    m_txFrameSamples = txSamplesForMs(m_txFrameSizeMs);
+    m_txLeadInSilenceFrame.assign(static_cast<size_t>(txSamplesForMs(MAX_FRAME_SIZE_MS)), 0.0f);
+    m_audioLimiter.setSampleRate(m_txSampleRate);
+    m_audioLimiter.setLookAheadSamples(txSamplesForMs(m_txLookAheadMs));
+    reportTxProcessingLatency();
+    configureTxBacklog();
+    if (m_txSampleRate != SAMPLE_RATE) {
+        m_txVadResampler = std::make_unique<Resampler>(m_txSampleRate, SAMPLE_RATE, CHANNELS);
+    } else {
+        m_txVadResampler.reset();
+    }
+    if (m_txStartupPrimingActive) {
+        prepareTxStartupPriming();
     }
 
-    processCapturedFloatSamples(sampleData, samplesRead);
+    // Opus takes the input rate at creation.  The SvxLink bandwidth cap
+    // goes back on, so a 48 kHz encoder still sends mediumband.
+    if (m_encoder) {
+        m_encoder = std::make_unique<OpusEncoder>(m_txSampleRate, CHANNELS, OPUS_APPLICATION_VOIP);
+        m_encoder->applySvxlinkDefaults();
+        applyTxEncoderSettings(true);
+    }
+    qDebug() << "AudioEngine: encoding TX at" << m_txSampleRate << "Hz";
 }
 
-void AudioEngine::processCapturedInt16Samples(const short* samples, int count, int sampleRate)
+void AudioEngine::processCapturedNativeFloatSamples(float* samples, int count, int sampleRate)
 {
     if (!m_recording || samples == nullptr || count <= 0) {
         return;
     }
 
-    if (m_reusableFloatBuffer.size() < static_cast<size_t>(count)) {
-        m_reusableFloatBuffer.resize(static_cast<size_t>(count));
-    }
-
-    constexpr float kInt16Scale = 1.0f / 32768.0f;
-    for (int i = 0; i < count; ++i) {
-        m_reusableFloatBuffer[static_cast<size_t>(i)] = samples[i] * kInt16Scale;
-    }
-
-    float* sampleData = m_reusableFloatBuffer.data();
+    float* sampleData = samples;
     int samplesRead = count;
-    std::vector<float> resampledData;
-
-    if (sampleRate != SAMPLE_RATE) {
-        if (!m_inputResampler || m_inputFormat.sampleRate() != sampleRate) {
-            m_inputResampler = std::make_unique<Resampler>(sampleRate, SAMPLE_RATE, CHANNELS);
-            m_inputFormat.setSampleRate(sampleRate);
-            m_inputFormat.setChannelCount(CHANNELS);
-            m_inputFormat.setSampleFormat(QAudioFormat::Int16);
+
+    // The encoder keeps its rate for the whole transmission.  The resampler
+    // from the capture rate was built by configureTxSampleRate() before
+    // capture started; this may be the real-time encode thread, so nothing
+    // is built here, and a block at a rate it was not built for is dropped.
+    if (sampleRate != m_txSampleRate) {
+        if (!m_inputResampler
+                || m_inputResampler->inputRate() != sampleRate
+                || m_inputResampler->outputRate() != m_txSampleRate) {
+            ++m_txCaptureRateMismatches;
+            return;
         }
 
-        resampledData = m_inputResampler->process(sampleData, samplesRead);
-        sampleData = resampledData.data();
-        samplesRead = static_cast<int>(resampledData.size());
+        samplesRead = resampleCapturedSamples(sampleData, samplesRead);
+        sampleData = m_resampledInputBuffer.data();
     }
 
     processCapturedFloatSamples(sampleData, samplesRead);
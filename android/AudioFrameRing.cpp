@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2025 Silviu YO6SAY
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "AudioFrameRing.h"
+
+#include <algorithm>
+#include <cstring>
+
+AudioFrameRing::AudioFrameRing(int frameSamples, int capacitySamples)
+{
+    configure(frameSamples, capacitySamples);
+}
+
+void AudioFrameRing::configure(int frameSamples, int capacitySamples)
+{
+    m_frameSamples = std::max(frameSamples, 1);
+    const int frames = std::max(2, (capacitySamples + m_frameSamples - 1) / m_frameSamples);
+    m_samples.assign(static_cast<size_t>(frames) * static_cast<size_t>(m_frameSamples), 0.0f);
+    m_droppedSamples = 0;
+    clear();
+}
+
+void AudioFrameRing::clear()
+{
+    m_head = 0;
+    m_size = 0;
+}
+
+int AudioFrameRing::push(const float* samples, int count)
+{
+    if (samples == nullptr || count <= 0) {
+        return 0;
+    }
+
+    // Only the newest capacity's worth can survive; older input never
+    // needs copying.
+    int dropped = 0;
+    const int capacitySamples = capacity();
+    if (count > capacitySamples) {
+        dropped += count - capacitySamples;
+        samples += count - capacitySamples;
+        count = capacitySamples;
+    }
+
+    // Make room by whole frames so m_head stays aligned.  A lone partial
+    // frame starts at m_head, so dropping it leaves m_head where it is.
+    while (m_size + count > capacitySamples) {
+        if (m_size < m_frameSamples) {
+            dropped += m_size;
+            m_size = 0;
+            break;
+        }
+        m_head = (m_head + m_frameSamples) % capacitySamples;
+        m_size -= m_frameSamples;
+        dropped += m_frameSamples;
+    }
+
+    const int tail = (m_head + m_size) % capacitySamples;
+    const int firstPart = std::min(count, capacitySamples - tail);
+    std::memcpy(m_samples.data() + tail, samples, static_cast<size_t>(firstPart) * sizeof(float));
+    if (count > firstPart) {
+        std::memcpy(m_samples.data(), samples + firstPart,
+                    static_cast<size_t>(count - firstPart) * sizeof(float));
+    }
+    m_size += count;
+
+    m_droppedSamples += static_cast<uint64_t>(dropped);
+    return dropped;
+}
+
+int AudioFrameRing::padToFrame()
+{
+    const int partial = m_size % m_frameSamples;
+    if (partial == 0) {
+        return 0;
+    }
+
+    // The partial frame ends inside its own aligned slot, so the padding
+    // never wraps.
+    const int padding = m_frameSamples - partial;
+    const int tail = (m_head + m_size) % capacity();
+    std::fill_n(m_samples.data() + tail, padding, 0.0f);
+    m_size += padding;
+    return padding;
+}
+
+void AudioFrameRing::popFrame()
+{
+    if (!hasFrame()) {
+        return;
+    }
+    m_head = (m_head + m_frameSamples) % capacity();
+    m_size -= m_frameSamples;
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2025 Silviu YO6SAY
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef AUDIOFRAMERING_H
+#define AUDIOFRAMERING_H
+
+#include <cstdint>
+#include <vector>
+
+// Fixed-capacity FIFO of TX samples waiting for the encoder.
+//
+// Storage is a whole number of frames and every frame starts at a multiple
+// of the frame size, so a complete frame is always contiguous however the
+// writes were split: the encoder reads it in place and popping it is an
+// index update, not a memmove of everything behind it.  Pushing more than
+// the capacity drops the oldest whole frames and counts them, so a TX path
+// that fell behind goes on with current speech instead of sending the
+// backlog late.
+//
+// Owned by the audio thread; not thread-safe.
+class AudioFrameRing
+{
+public:
+    explicit AudioFrameRing(int frameSamples = 320, int capacitySamples = 3200);
+
+    // Reallocates and clears.  The capacity is rounded up to whole frames,
+    // at least two.
+    void configure(int frameSamples, int capacitySamples);
+    void clear();
+
+    // Returns how many of the oldest samples had to be dropped to fit.
+    int push(const float* samples, int count);
+    // Zeros up to the next frame boundary; returns how many were added.
+    int padToFrame();
+
+    bool hasFrame() const { return m_size >= m_frameSamples; }
+    // Oldest complete frame; valid until the next push() or popFrame().
+    const float* frame() const { return m_samples.data() + m_head; }
+    void popFrame();
+
+    int size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    int frameSamples() const { return m_frameSamples; }
+    int capacity() const { return static_cast<int>(m_samples.size()); }
+    uint64_t droppedSamples() const { return m_droppedSamples; }
+
+private:
+    std::vector<float> m_samples;
+    int m_frameSamples = 0;
+    // m_head is always frame-aligned.
+    int m_head = 0;
+    int m_size = 0;
+    uint64_t m_droppedSamples = 0;
+};
+
+#endif // AUDIOFRAMERING_H
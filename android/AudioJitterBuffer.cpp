@@ -19,47 +19,89 @@
 
 namespace {
 constexpr auto kShortGapRebufferWindow = std::chrono::milliseconds(100);
+
+int64_t steadyNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Positions are free-running, so "later" has to be decided on the signed
+// distance rather than the raw value.
+uint32_t laterPosition(uint32_t a, uint32_t b)
+{
+    return static_cast<int32_t>(a - b) > 0 ? a : b;
+}
+
+unsigned distance(uint32_t from, uint32_t to)
+{
+    const int32_t delta = static_cast<int32_t>(to - from);
+    return delta > 0 ? static_cast<unsigned>(delta) : 0u;
+}
 }
 
 AudioJitterBuffer::AudioJitterBuffer(unsigned fifoSize)
-    : m_fifoSize(fifoSize), m_fifo(fifoSize)
+    : m_fifoSize(fifoSize)
 {
+    setSize(fifoSize);
+}
+
+unsigned AudioJitterBuffer::ringCapacityFor(unsigned fifoSize)
+{
+    unsigned capacity = 1;
+    while (capacity < fifoSize * 2u) {
+        capacity <<= 1;
+    }
+    return capacity;
 }
 
 void AudioJitterBuffer::setSize(unsigned newSize)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
     m_fifoSize = newSize ? newSize : 1;
-    m_prebufSamples = std::min(m_prebufSamples, m_fifoSize - 1);
-    m_fifo.assign(m_fifoSize, 0.0f);
-    m_head = m_tail = 0;
-    m_prebuf = (m_prebufSamples > 0);
-    m_lastWriteTime = std::chrono::steady_clock::time_point{};
+    m_prebufSamples.store(std::min(m_prebufSamples.load(std::memory_order_relaxed), m_fifoSize - 1),
+                          std::memory_order_relaxed);
+
+    const unsigned capacity = ringCapacityFor(m_fifoSize);
+    m_fifo = std::make_unique<std::atomic<float>[]>(capacity);
+    m_mask = capacity - 1;
+
+    m_head.store(0, std::memory_order_relaxed);
+    m_readFloor.store(0, std::memory_order_relaxed);
+    m_tail.store(0, std::memory_order_relaxed);
+    m_prebuf.store(prebufSamples() > 0, std::memory_order_relaxed);
+    m_lastWriteNs.store(0, std::memory_order_release);
 }
 
 void AudioJitterBuffer::setPrebufSamples(unsigned prebufSamples)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_prebufSamples = std::min(prebufSamples, m_fifoSize - 1);
-    const unsigned available = (m_head + m_fifoSize - m_tail) % m_fifoSize;
+    const unsigned clamped = std::min(prebufSamples, m_fifoSize - 1);
+    m_prebufSamples.store(clamped, std::memory_order_relaxed);
+
+    const unsigned available = samplesInBuffer();
     if (available == 0) {
-        m_prebuf = (m_prebufSamples > 0);
-    } else if (m_prebuf && available >= m_prebufSamples) {
-        m_prebuf = false;
+        m_prebuf.store(clamped > 0, std::memory_order_relaxed);
+    } else if (m_prebuf.load(std::memory_order_relaxed) && available >= clamped) {
+        m_prebuf.store(false, std::memory_order_relaxed);
     }
 }
 
+uint32_t AudioJitterBuffer::readStart(uint32_t tail) const
+{
+    return laterPosition(m_readFloor.load(std::memory_order_acquire), tail);
+}
+
 unsigned AudioJitterBuffer::samplesInBuffer() const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return (m_head + m_fifoSize - m_tail) % m_fifoSize;
+    const uint32_t head = m_head.load(std::memory_order_acquire);
+    const uint32_t start = readStart(m_tail.load(std::memory_order_acquire));
+    return distance(start, head);
 }
 
 unsigned AudioJitterBuffer::samplesReadyForPlayback() const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    const unsigned available = (m_head + m_fifoSize - m_tail) % m_fifoSize;
-    if (m_prebuf && available < m_prebufSamples) {
+    const unsigned available = samplesInBuffer();
+    if (m_prebuf.load(std::memory_order_relaxed)
+            && available < m_prebufSamples.load(std::memory_order_relaxed)) {
         return 0;
     }
     return available;
@@ -67,68 +109,125 @@ unsigned AudioJitterBuffer::samplesReadyForPlayback() const
 
 void AudioJitterBuffer::clear()
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_head = m_tail = 0;
-    m_prebuf = (m_prebufSamples > 0);
-    m_lastWriteTime = std::chrono::steady_clock::time_point{};
+    // Producer-side: dropping everything is just moving the floor up to the
+    // write position; the consumer skips the stale samples on its next read.
+    m_readFloor.store(m_head.load(std::memory_order_relaxed), std::memory_order_release);
+    m_prebuf.store(prebufSamples() > 0, std::memory_order_relaxed);
+    m_lastWriteNs.store(0, std::memory_order_release);
+}
+
+void AudioJitterBuffer::copyIn(uint32_t position, const float* samples, unsigned count)
+{
+    for (unsigned i = 0; i < count; ++i) {
+        m_fifo[(position + i) & m_mask].store(samples[i], std::memory_order_relaxed);
+    }
+}
+
+void AudioJitterBuffer::copyOut(uint32_t position, float* output, unsigned count) const
+{
+    for (unsigned i = 0; i < count; ++i) {
+        output[i] = m_fifo[(position + i) & m_mask].load(std::memory_order_relaxed);
+    }
 }
 
 void AudioJitterBuffer::writeSamples(const float* samples, int count)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
     if (count <= 0) return;
-    for (int i = 0; i < count; ++i) {
-        m_fifo[m_head] = samples[i];
-        m_head = (m_head + 1) % m_fifoSize;
-        if (m_head == m_tail) {
-            // Drop half of the buffered samples when full
-            m_tail = (m_tail + (m_fifoSize >> 1)) % m_fifoSize;
-            m_prebuf = false;
-        }
+
+    const uint32_t head = m_head.load(std::memory_order_relaxed);
+    const uint32_t floor = m_readFloor.load(std::memory_order_relaxed);
+    const uint32_t start = laterPosition(floor, m_tail.load(std::memory_order_acquire));
+
+    // Drop half of the buffered samples whenever the logical size fills up,
+    // exactly as the per-sample loop used to.  The playout stretcher keeps
+    // the depth near the prebuffer target, so this is only a last resort.
+    // A stalled consumer loses its oldest audio the same way: the producer
+    // never waits for m_tail, it only raises the floor.
+    const unsigned dropStep = std::max(1u, m_fifoSize >> 1);
+    unsigned buffered = distance(start, head) + static_cast<unsigned>(count);
+    uint32_t newFloor = start;
+    while (buffered >= m_fifoSize) {
+        newFloor += dropStep;
+        buffered -= dropStep;
     }
-    m_lastWriteTime = std::chrono::steady_clock::now();
 
-    const unsigned available = (m_head + m_fifoSize - m_tail) % m_fifoSize;
-    if (m_prebuf && available >= m_prebufSamples) {
-        m_prebuf = false;
+    // The floor goes out before any slot is rewritten and before the new
+    // head, so a reader that sees the head also sees the floor that belongs
+    // to it, and a reader still copying a dropped slot notices the drop when
+    // it re-checks the floor.
+    if (newFloor != start) {
+        m_readFloor.store(newFloor, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_prebuf.store(false, std::memory_order_relaxed);
+    }
+
+    const uint32_t newHead = head + static_cast<uint32_t>(count);
+    const uint32_t writeFrom = laterPosition(newFloor, head);
+    const unsigned toWrite = distance(writeFrom, newHead);
+    if (toWrite > 0) {
+        copyIn(writeFrom, samples + (writeFrom - head), toWrite);
+    }
+
+    m_head.store(newHead, std::memory_order_release);
+    m_lastWriteNs.store(steadyNowNs(), std::memory_order_release);
+
+    if (m_prebuf.load(std::memory_order_relaxed)
+            && buffered >= m_prebufSamples.load(std::memory_order_relaxed)) {
+        m_prebuf.store(false, std::memory_order_relaxed);
     }
 }
 
 int AudioJitterBuffer::readSamples(float* output, int count)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
     if (count <= 0) {
         return 0;
     }
 
-    unsigned available = (m_head + m_fifoSize - m_tail) % m_fifoSize;
-    if (m_prebuf && available < m_prebufSamples) {
-        if (output != nullptr) {
-            std::fill(output, output + count, 0.0f);
+    // Head first: the producer publishes the floor before the head, so the
+    // floor read afterwards is never older than the head it is paired with.
+    const uint32_t head = m_head.load(std::memory_order_acquire);
+    const uint32_t tail = m_tail.load(std::memory_order_relaxed);
+    const uint32_t start = readStart(tail);
+    const unsigned available = distance(start, head);
+    const unsigned prebufSamples = m_prebufSamples.load(std::memory_order_relaxed);
+
+    if (m_prebuf.load(std::memory_order_relaxed)) {
+        if (available < prebufSamples) {
+            if (output != nullptr) {
+                std::fill(output, output + count, 0.0f);
+            }
+            return 0;
         }
-        return 0;
-    }
-
-    if (m_prebuf && available >= m_prebufSamples) {
-        m_prebuf = false;
+        m_prebuf.store(false, std::memory_order_relaxed);
     }
 
-    const int readCount = std::min(count, static_cast<int>(available));
-    for (int i = 0; i < readCount; ++i) {
-        output[i] = m_fifo[m_tail];
-        m_tail = (m_tail + 1) % m_fifoSize;
+    const unsigned readCount = std::min(static_cast<unsigned>(count), available);
+    unsigned delivered = readCount;
+    if (output != nullptr && readCount > 0) {
+        copyOut(start, output, readCount);
+
+        // If the producer overran us while we copied, the slots below the new
+        // floor may hold newer audio; keep only what is still above it.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const unsigned overrun = std::min(readCount,
+            distance(start, m_readFloor.load(std::memory_order_relaxed)));
+        if (overrun > 0) {
+            delivered = readCount - overrun;
+            std::memmove(output, output + overrun, delivered * sizeof(float));
+        }
     }
+    m_tail.store(start + readCount, std::memory_order_release);
 
-    if (output != nullptr && readCount < count) {
-        std::fill(output + readCount, output + count, 0.0f);
+    if (output != nullptr && static_cast<int>(delivered) < count) {
+        std::fill(output + delivered, output + count, 0.0f);
     }
 
-    const unsigned remaining = (m_head + m_fifoSize - m_tail) % m_fifoSize;
-    if (remaining == 0 && m_prebufSamples > 0 && !m_prebuf && m_lastWriteTime != std::chrono::steady_clock::time_point{}) {
-        const auto now = std::chrono::steady_clock::now();
-        if (now - m_lastWriteTime <= kShortGapRebufferWindow) {
-            m_prebuf = true;
+    const int64_t lastWriteNs = m_lastWriteNs.load(std::memory_order_acquire);
+    if (readCount == available && prebufSamples > 0 && lastWriteNs != 0) {
+        const auto sinceWrite = std::chrono::nanoseconds(steadyNowNs() - lastWriteNs);
+        if (sinceWrite <= kShortGapRebufferWindow) {
+            m_prebuf.store(true, std::memory_order_relaxed);
         }
     }
-    return readCount;
+    return static_cast<int>(delivered);
 }
@@ -21,9 +21,30 @@
 #include <vector>
 #include <algorithm>
 #include <cstring>
-#include <mutex>
+#include <cstdint>
+#include <atomic>
 #include <chrono>
+#include <memory>
 
+// Wait-free single-producer / single-consumer sample FIFO shared by the
+// Android and iOS builds.
+//
+// The decode thread is the only writer (writeSamples, clear) and the
+// playback thread (AudioTrack loop or QAudioSink pull) is the only reader
+// (readSamples).  Positions are free-running 32-bit counters over a
+// power-of-two ring, so wrap-around is a mask instead of a modulo.
+//
+// The consumer owns m_tail.  When the logical size is exceeded the producer
+// never touches it; instead it raises m_readFloor, the oldest position the
+// consumer is still allowed to read, and the consumer skips ahead on its
+// next read.  The floor is published before the head and before any slot is
+// rewritten, so overflow always drops the oldest audio, even while the
+// consumer is stalled, and a consumer that was overrun mid-copy discards the
+// slots that fell below the floor.  The ring is twice the logical size so a
+// consumer keeping up is never overrun.
+//
+// setSize() reallocates storage and must only be called while neither side
+// is running.
 class AudioJitterBuffer
 {
 public:
@@ -32,24 +53,39 @@ public:
     void setSize(unsigned newSize);
     void setPrebufSamples(unsigned prebufSamples);
 
-    bool empty() const { return m_head == m_tail; }
+    bool empty() const { return samplesInBuffer() == 0; }
     unsigned samplesInBuffer() const;
     unsigned samplesReadyForPlayback() const;
-    unsigned prebufSamples() const { return m_prebufSamples; }
+    unsigned prebufSamples() const { return m_prebufSamples.load(std::memory_order_relaxed); }
+    bool isPriming() const { return m_prebuf.load(std::memory_order_relaxed); }
 
     void clear();
     void writeSamples(const float* samples, int count);
     int readSamples(float* output, int count);
 
 private:
-    std::vector<float> m_fifo;
+    static unsigned ringCapacityFor(unsigned fifoSize);
+    uint32_t readStart(uint32_t tail) const;
+    void copyIn(uint32_t position, const float* samples, unsigned count);
+    void copyOut(uint32_t position, float* output, unsigned count) const;
+
+    // A producer overrunning a stalled consumer rewrites slots the consumer
+    // may still be copying.  Relaxed atomics keep that overlap defined; the
+    // fences around m_readFloor order it, and the consumer re-checks the
+    // floor after copying and drops whatever it read below it, as a seqlock
+    // reader would, so a slot caught mid-rewrite is never played.
+    std::unique_ptr<std::atomic<float>[]> m_fifo;
     unsigned m_fifoSize;
-    unsigned m_head = 0;
-    unsigned m_tail = 0;
-    unsigned m_prebufSamples = 0;
-    bool m_prebuf = true;
-    std::chrono::steady_clock::time_point m_lastWriteTime{};
-    mutable std::mutex m_mutex;
+    uint32_t m_mask = 0;
+
+    // Producer-owned write position and drop floor; consumer-owned read position.
+    std::atomic<uint32_t> m_head{0};
+    std::atomic<uint32_t> m_readFloor{0};
+    std::atomic<uint32_t> m_tail{0};
+
+    std::atomic<unsigned> m_prebufSamples{0};
+    std::atomic<bool> m_prebuf{true};
+    std::atomic<int64_t> m_lastWriteNs{0};
 };
 
 #endif // AUDIOJITTERBUFFER_H
@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2025 Silviu YO6SAY
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "AudioJitterEstimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Matches the fixed 150 ms prebuffer used before enough packets were seen.
+constexpr int kInitialTargetMs = 150;
+constexpr int kMaximumTargetMs = 400;
+// An in-sequence packet this many frames late may follow a sender pause.
+constexpr int kPauseCandidateFrames = 2;
+}
+
+AudioJitterEstimator::AudioJitterEstimator(int frameDurationMs)
+    : m_frameDurationUs(frameDurationMs * 1000)
+    , m_minimumTargetMs(frameDurationMs * 2)
+    , m_maximumTargetMs(kMaximumTargetMs)
+    , m_targetDelayMs(kInitialTargetMs)
+{
+}
+
+void AudioJitterEstimator::reset()
+{
+    startNewTalkSpurt();
+    m_histogram.fill(0.0);
+    m_jitterUs = 0.0;
+    m_packetCount = 0;
+    m_targetDelayMs = std::clamp(kInitialTargetMs, m_minimumTargetMs, m_maximumTargetMs);
+}
+
+void AudioJitterEstimator::startNewTalkSpurt()
+{
+    m_hasReference = false;
+    m_extendedSequence = 0;
+    m_lastSequence = 0;
+    m_lastArrivalUs = 0;
+    m_lastExpectedUs = 0;
+    m_transitCount = 0;
+    m_transitIndex = 0;
+    m_pausePending = false;
+}
+
+void AudioJitterEstimator::setFrameDurationMs(int frameDurationMs)
+{
+    const int frameDurationUs = std::max(1, frameDurationMs) * 1000;
+    if (frameDurationUs == m_frameDurationUs) {
+        return;
+    }
+    m_frameDurationUs = frameDurationUs;
+    // Expected arrival times were derived from the old packet duration.
+    startNewTalkSpurt();
+}
+
+void AudioJitterEstimator::setUnderrunProbability(double probability)
+{
+    m_underrunProbability = std::clamp(probability, 0.001, 0.25);
+    updateTarget();
+}
+
+void AudioJitterEstimator::setTargetLimitsMs(int minimumMs, int maximumMs)
+{
+    m_minimumTargetMs = std::max(0, minimumMs);
+    m_maximumTargetMs = std::max(m_minimumTargetMs, maximumMs);
+    m_targetDelayMs = std::clamp(m_targetDelayMs, m_minimumTargetMs, m_maximumTargetMs);
+}
+
+void AudioJitterEstimator::addArrival(uint16_t sequence, int64_t arrivalUs)
+{
+    if (m_pausePending) {
+        m_pausePending = false;
+        const bool nextInSequence = static_cast<uint16_t>(sequence - m_lastSequence) == 1;
+        if (nextInSequence && arrivalUs - m_lastArrivalUs >= m_frameDurationUs / 2) {
+            // Back to the normal cadence: the sender paused and the held
+            // packet opened a new talk spurt.
+            const uint16_t heldSequence = m_lastSequence;
+            const int64_t heldArrivalUs = m_lastArrivalUs;
+            const double jitterUs = m_jitterBeforePendingUs;
+            startNewTalkSpurt();
+            m_jitterUs = jitterUs;
+            m_hasReference = true;
+            m_lastSequence = heldSequence;
+            m_lastArrivalUs = heldArrivalUs;
+            recordTransit(heldArrivalUs);
+        } else {
+            recordTransit(m_pendingTransitUs);
+        }
+    }
+
+    int64_t expectedUs = 0;
+    bool pauseCandidate = false;
+    if (!m_hasReference) {
+        m_hasReference = true;
+        m_extendedSequence = 0;
+        m_lastSequence = sequence;
+    } else {
+        const int16_t delta = static_cast<int16_t>(sequence - m_lastSequence);
+        const int64_t extended = m_extendedSequence + delta;
+        if (delta > 0) {
+            m_extendedSequence = extended;
+            m_lastSequence = sequence;
+        }
+        expectedUs = extended * m_frameDurationUs;
+
+        // RFC 3550: D(i,j) = (Rj - Ri) - (Sj - Si), J += (|D| - J) / 16
+        const double d = static_cast<double>((arrivalUs - m_lastArrivalUs) - (expectedUs - m_lastExpectedUs));
+        pauseCandidate = delta == 1 && d >= kPauseCandidateFrames * m_frameDurationUs;
+        if (pauseCandidate) {
+            m_jitterBeforePendingUs = m_jitterUs;
+        }
+        m_jitterUs += (std::fabs(d) - m_jitterUs) / 16.0;
+    }
+    m_lastArrivalUs = arrivalUs;
+    m_lastExpectedUs = expectedUs;
+    ++m_packetCount;
+
+    const int64_t transitUs = arrivalUs - expectedUs;
+    if (pauseCandidate) {
+        m_pausePending = true;
+        m_pendingTransitUs = transitUs;
+        return;
+    }
+    recordTransit(transitUs);
+}
+
+void AudioJitterEstimator::recordTransit(int64_t transitUs)
+{
+    // Delay relative to the fastest packet of the recent window.
+    m_transits[static_cast<size_t>(m_transitIndex)] = transitUs;
+    m_transitIndex = (m_transitIndex + 1) % kTransitWindow;
+    m_transitCount = std::min(m_transitCount + 1, kTransitWindow);
+    const int64_t baseTransitUs = *std::min_element(m_transits.begin(),
+                                                    m_transits.begin() + m_transitCount);
+    const int64_t relativeDelayUs = transitUs - baseTransitUs;
+
+    const int bucket = std::min(static_cast<int>(relativeDelayUs / (kBucketMs * 1000)), kBucketCount - 1);
+    for (double &weight : m_histogram) {
+        weight *= kForgetFactor;
+    }
+    m_histogram[static_cast<size_t>(bucket)] += 1.0 - kForgetFactor;
+    updateTarget();
+}
+
+void AudioJitterEstimator::updateTarget()
+{
+    if (m_packetCount < kMinPacketsForTarget) {
+        return;
+    }
+
+    double total = 0.0;
+    for (double weight : m_histogram) {
+        total += weight;
+    }
+    if (total <= 0.0) {
+        return;
+    }
+
+    const double threshold = (1.0 - m_underrunProbability) * total;
+    double cumulative = 0.0;
+    int bucket = 0;
+    for (; bucket < kBucketCount - 1; ++bucket) {
+        cumulative += m_histogram[static_cast<size_t>(bucket)];
+        if (cumulative >= threshold) {
+            break;
+        }
+    }
+
+    // A packet delayed by the quantile still has to find one frame queued
+    // ahead of it, because each packet's samples land in the buffer at once.
+    const int quantileMs = (bucket + 1) * kBucketMs;
+    m_targetDelayMs = std::clamp(quantileMs + m_frameDurationUs / 1000,
+                                 m_minimumTargetMs, m_maximumTargetMs);
+}
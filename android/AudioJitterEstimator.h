@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2025 Silviu YO6SAY
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef AUDIOJITTERESTIMATOR_H
+#define AUDIOJITTERESTIMATOR_H
+
+#include <array>
+#include <cstdint>
+
+// Packet inter-arrival jitter tracker for the RX jitter buffer.
+//
+// Two estimates are kept from (sequence, arrival time) pairs:
+//  - the RFC 3550 section 6.4.1 interarrival jitter, J += (|D| - J) / 16,
+//    reported for display;
+//  - a forgetting histogram of each packet's delay relative to the fastest
+//    packet seen in the recent window.  The (1 - p) quantile of that
+//    histogram is the buffer depth that underruns with probability p.
+//
+// A sender using DTX stops sending through pauses without skipping sequence
+// numbers, so the first packet after a pause looks very late.  Such a packet
+// is held back until the next one arrives: if that one follows in a burst
+// the network delayed both and the delay is counted; if it follows a frame
+// later at the normal cadence the sender had paused, and the late packet
+// starts a new talk spurt instead.
+class AudioJitterEstimator
+{
+public:
+    explicit AudioJitterEstimator(int frameDurationMs = 20);
+
+    void reset();
+    // Sequence numbers restart with each talker; keep the statistics but
+    // forget the per-stream reference points.
+    void startNewTalkSpurt();
+
+    // Legacy clients send 40 or 60 ms per sequence number.
+    void setFrameDurationMs(int frameDurationMs);
+    int frameDurationMs() const { return m_frameDurationUs / 1000; }
+
+    void setUnderrunProbability(double probability);
+    double underrunProbability() const { return m_underrunProbability; }
+    void setTargetLimitsMs(int minimumMs, int maximumMs);
+
+    void addArrival(uint16_t sequence, int64_t arrivalUs);
+
+    double jitterMs() const { return m_jitterUs / 1000.0; }
+    int targetDelayMs() const { return m_targetDelayMs; }
+    int packetCount() const { return m_packetCount; }
+
+private:
+    static constexpr int kBucketMs = 5;
+    static constexpr int kBucketCount = 120;   // 0 .. 600 ms
+    static constexpr int kTransitWindow = 250; // ~5 s at 50 packets/s
+    static constexpr double kForgetFactor = 0.995;
+    static constexpr int kMinPacketsForTarget = 25;
+
+    void recordTransit(int64_t transitUs);
+    void updateTarget();
+
+    int m_frameDurationUs;
+    double m_underrunProbability = 0.02;
+    int m_minimumTargetMs;
+    int m_maximumTargetMs;
+    int m_targetDelayMs;
+    int m_packetCount = 0;
+
+    bool m_hasReference = false;
+    int64_t m_extendedSequence = 0;
+    uint16_t m_lastSequence = 0;
+    int64_t m_lastArrivalUs = 0;
+    int64_t m_lastExpectedUs = 0;
+    double m_jitterUs = 0.0;
+
+    // Late in-sequence packet waiting for the next arrival to tell a
+    // network delay from a sender pause.
+    bool m_pausePending = false;
+    int64_t m_pendingTransitUs = 0;
+    double m_jitterBeforePendingUs = 0.0;
+
+    std::array<int64_t, kTransitWindow> m_transits{};
+    int m_transitCount = 0;
+    int m_transitIndex = 0;
+
+    std::array<double, kBucketCount> m_histogram{};
+};
+
+#endif // AUDIOJITTERESTIMATOR_H
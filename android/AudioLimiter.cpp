@@ -16,36 +16,393 @@
  */
 
 #include "AudioLimiter.h"
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define LATRY_LIMITER_SSE 1
+#  include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  define LATRY_LIMITER_NEON 1
+#  include <arm_neon.h>
+#endif
+
+namespace {
+constexpr float kDbPerLog2 = 6.0205999132796239f;  // 20 * log10(2)
+
+// log2(1 + f) = f * P(f) on [0, 1), max error 2.5e-6 (1.5e-5 dB)
+constexpr float kLog2C1 = 1.44253478f;
+constexpr float kLog2C2 = -0.718033587f;
+constexpr float kLog2C3 = 0.457158108f;
+constexpr float kLog2C4 = -0.27734162f;
+constexpr float kLog2C5 = 0.121472925f;
+constexpr float kLog2C6 = -0.0257923372f;
+
+// 2^f on [0, 1), max relative error 1.1e-7
+constexpr float kExp2C0 = 0.999999896f;
+constexpr float kExp2C1 = 0.69315462f;
+constexpr float kExp2C2 = 0.24014077f;
+constexpr float kExp2C3 = 0.0558632821f;
+constexpr float kExp2C4 = 0.00894621529f;
+constexpr float kExp2C5 = 0.00189510704f;
+
+// Below 1e-6 dB of remaining release the gain is treated as settled.
+constexpr float kReleaseSnap = 1.0e-6f / kDbPerLog2;
+
+constexpr float kMinExp2 = -126.0f;
+constexpr float kMaxExp2 = 126.0f;
+
+// x must be a positive normal float.
+inline float fastLog2(float x)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    const float exponent = static_cast<float>(static_cast<int32_t>(bits >> 23) - 127);
+    bits = (bits & 0x007fffffu) | 0x3f800000u;
+    float mantissa;
+    std::memcpy(&mantissa, &bits, sizeof(mantissa));
+    const float f = mantissa - 1.0f;
+    float p = kLog2C6;
+    p = p * f + kLog2C5;
+    p = p * f + kLog2C4;
+    p = p * f + kLog2C3;
+    p = p * f + kLog2C2;
+    p = p * f + kLog2C1;
+    return exponent + f * p;
+}
+
+inline float fastExp2(float y)
+{
+    y = std::min(std::max(y, kMinExp2), kMaxExp2);
+    const float whole = std::floor(y);
+    const float f = y - whole;
+    float p = kExp2C5;
+    p = p * f + kExp2C4;
+    p = p * f + kExp2C3;
+    p = p * f + kExp2C2;
+    p = p * f + kExp2C1;
+    p = p * f + kExp2C0;
+    const uint32_t bits = static_cast<uint32_t>(static_cast<int32_t>(whole) + 127) << 23;
+    float scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    return p * scale;
+}
+
+// levels[i] = log2(|samples[i]| + offset)
+void computeLevels(const float* samples, float* levels, int count, float offset)
+{
+    int i = 0;
+#if defined(LATRY_LIMITER_SSE)
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 dc = _mm_set1_ps(offset);
+    const __m128i mantissaMask = _mm_set1_epi32(0x007fffff);
+    const __m128i oneBits = _mm_set1_epi32(0x3f800000);
+    const __m128i bias = _mm_set1_epi32(127);
+    const __m128 one = _mm_set1_ps(1.0f);
+    for (; i + 4 <= count; i += 4) {
+        const __m128 x = _mm_add_ps(_mm_and_ps(_mm_loadu_ps(samples + i), absMask), dc);
+        const __m128i bits = _mm_castps_si128(x);
+        const __m128 exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), bias));
+        const __m128 f = _mm_sub_ps(
+            _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, mantissaMask), oneBits)), one);
+        __m128 p = _mm_set1_ps(kLog2C6);
+        p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(kLog2C5));
+        p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(kLog2C4));
+        p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(kLog2C3));
+        p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(kLog2C2));
+        p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(kLog2C1));
+        _mm_storeu_ps(levels + i, _mm_add_ps(exponent, _mm_mul_ps(f, p)));
+    }
+#elif defined(LATRY_LIMITER_NEON)
+    const float32x4_t dc = vdupq_n_f32(offset);
+    const uint32x4_t mantissaMask = vdupq_n_u32(0x007fffffu);
+    const uint32x4_t oneBits = vdupq_n_u32(0x3f800000u);
+    const int32x4_t bias = vdupq_n_s32(127);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    for (; i + 4 <= count; i += 4) {
+        const float32x4_t x = vaddq_f32(vabsq_f32(vld1q_f32(samples + i)), dc);
+        const uint32x4_t bits = vreinterpretq_u32_f32(x);
+        const float32x4_t exponent = vcvtq_f32_s32(
+            vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(bits, 23)), bias));
+        const float32x4_t f = vsubq_f32(
+            vreinterpretq_f32_u32(vorrq_u32(vandq_u32(bits, mantissaMask), oneBits)), one);
+        float32x4_t p = vdupq_n_f32(kLog2C6);
+        p = vmlaq_f32(vdupq_n_f32(kLog2C5), p, f);
+        p = vmlaq_f32(vdupq_n_f32(kLog2C4), p, f);
+        p = vmlaq_f32(vdupq_n_f32(kLog2C3), p, f);
+        p = vmlaq_f32(vdupq_n_f32(kLog2C2), p, f);
+        p = vmlaq_f32(vdupq_n_f32(kLog2C1), p, f);
+        vst1q_f32(levels + i, vmlaq_f32(exponent, f, p));
+    }
+#endif
+    for (; i < count; ++i) {
+        levels[i] = fastLog2(std::fabs(samples[i]) + offset);
+    }
+}
+
+// samples[i] *= gain * 2^gainLog2[i]
+void applyGainLog2(float* samples, const float* gainLog2, int count, float gain)
+{
+    int i = 0;
+#if defined(LATRY_LIMITER_SSE)
+    const __m128 lo = _mm_set1_ps(kMinExp2);
+    const __m128 hi = _mm_set1_ps(kMaxExp2);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128i bias = _mm_set1_epi32(127);
+    const __m128 outputGain = _mm_set1_ps(gain);
+    for (; i + 4 <= count; i += 4) {
+        const __m128 y = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(gainLog2 + i), lo), hi);
+        // floor(): truncate, then step down where truncation rounded up.
+        __m128i whole = _mm_cvttps_epi32(y);
+        __m128 wholeF = _mm_cvtepi32_ps(whole);
+        const __m128 roundedUp = _mm_cmpgt_ps(wholeF, y);
+        whole = _mm_add_epi32(whole, _mm_castps_si128(roundedUp));
+        wholeF = _mm_sub_ps(wholeF, _mm_and_ps(roundedUp, one));
+        const __m128 f = _mm_sub_ps(y, wholeF);
+        __m128 p = _mm_set1_ps(kExp2C5);
+        p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(kExp2C4));
+        p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(kExp2C3));
+        p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(kExp2C2));
+        p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(kExp2C1));
+        p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(kExp2C0));
+        const __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(whole, bias), 23));
+        const __m128 x = _mm_mul_ps(_mm_loadu_ps(samples + i), outputGain);
+        _mm_storeu_ps(samples + i, _mm_mul_ps(x, _mm_mul_ps(p, scale)));
+    }
+#elif defined(LATRY_LIMITER_NEON)
+    const float32x4_t lo = vdupq_n_f32(kMinExp2);
+    const float32x4_t hi = vdupq_n_f32(kMaxExp2);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const int32x4_t bias = vdupq_n_s32(127);
+    const float32x4_t outputGain = vdupq_n_f32(gain);
+    for (; i + 4 <= count; i += 4) {
+        const float32x4_t y = vminq_f32(vmaxq_f32(vld1q_f32(gainLog2 + i), lo), hi);
+        int32x4_t whole = vcvtq_s32_f32(y);
+        float32x4_t wholeF = vcvtq_f32_s32(whole);
+        const uint32x4_t roundedUp = vcgtq_f32(wholeF, y);
+        whole = vaddq_s32(whole, vreinterpretq_s32_u32(roundedUp));
+        wholeF = vsubq_f32(wholeF, vreinterpretq_f32_u32(vandq_u32(roundedUp, vreinterpretq_u32_f32(one))));
+        const float32x4_t f = vsubq_f32(y, wholeF);
+        float32x4_t p = vdupq_n_f32(kExp2C5);
+        p = vmlaq_f32(vdupq_n_f32(kExp2C4), p, f);
+        p = vmlaq_f32(vdupq_n_f32(kExp2C3), p, f);
+        p = vmlaq_f32(vdupq_n_f32(kExp2C2), p, f);
+        p = vmlaq_f32(vdupq_n_f32(kExp2C1), p, f);
+        p = vmlaq_f32(vdupq_n_f32(kExp2C0), p, f);
+        const float32x4_t scale = vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(whole, bias), 23));
+        const float32x4_t x = vmulq_f32(vld1q_f32(samples + i), outputGain);
+        vst1q_f32(samples + i, vmulq_f32(x, vmulq_f32(p, scale)));
+    }
+#endif
+    for (; i < count; ++i) {
+        samples[i] = gain * samples[i] * fastExp2(gainLog2[i]);
+    }
+}
+}
+
+void AudioLimiter::setGainBlockSize(int samples) {
+    gainBlockSize_ = std::clamp(samples, 1, BLOCK_SIZE);
+}
+
+void AudioLimiter::setLookAheadSamples(int samples) {
+    const int lookAhead = std::clamp(samples, 0, MAX_LOOKAHEAD_SAMPLES);
+    if (lookAhead != lookAhead_) {
+        lookAhead_ = lookAhead;
+        reset();
+    }
+}
+
+void AudioLimiter::setSampleRate(int sampleRate) {
+    if (sampleRate <= 0 || sampleRate == sampleRate_) {
+        return;
+    }
+    sampleRate_ = sampleRate;
+
+    // c^(16000 / rate) per sample decays as far in a millisecond as c
+    // does at 16 kHz.
+    const double samplesPerTunedSample = static_cast<double>(TUNED_SAMPLE_RATE) / sampleRate;
+    attackCoef_ = static_cast<float>(std::pow(static_cast<double>(ATTACK_COEF), samplesPerTunedSample));
+    releaseCoef_ = static_cast<float>(std::pow(static_cast<double>(RELEASE_COEF), samplesPerTunedSample));
+    agcRateScale_ = static_cast<float>(samplesPerTunedSample);
+    reset();
+}
+
+void AudioLimiter::setAgcEnabled(bool enabled) {
+    agcEnabled_ = enabled;
+    if (!enabled) {
+        agcGainDb_ = 0.0f;
+        agcGain_ = 1.0f;
+    }
+}
+
+void AudioLimiter::reset() {
+    envDb_ = DC_OFFSET;
+    lastGain_ = 1.0f;
+    delayLine_.fill(0.0f);
+    delayPos_ = 0;
+    minHead_ = 0;
+    minSize_ = 0;
+    sampleIndex_ = 0;
+    releasedGain_ = 0.0f;
+    rampValues_.fill(0.0f);
+    rampPos_ = 0;
+    rampSum_ = 0.0;
+}
 
 void AudioLimiter::processAudio(float* samples, int count) {
+    while (count > 0) {
+        const int blockCount = std::min(count, BLOCK_SIZE);
+        processBlock(samples, blockCount);
+        samples += blockCount;
+        count -= blockCount;
+    }
+}
+
+void AudioLimiter::applyAgc(float* samples, int count) {
+    // Ramp from where the last block ended to the current AGC gain and
+    // measure what the limiter will see on the way.
+    const float target = fastExp2(agcGainDb_ / kDbPerLog2);
+    const float step = (target - agcGain_) / static_cast<float>(count);
+    float gain = agcGain_;
+    float energy = 0.0f;
     for (int i = 0; i < count; ++i) {
-        double rectified = fabs(samples[i]);  // Rectify input signal
-        rectified += DC_OFFSET;               // Add DC offset to avoid log(0)
-        double keyDb = lin2dB(rectified);     // Convert linear to dB
-
-        // Calculate overdB (how much above threshold)
-        double overDb = keyDb - thresholdDb_;
-        if (overDb < 0.0) {
-            overDb = 0.0;
-        }
+        gain += step;
+        samples[i] *= gain;
+        energy += samples[i] * samples[i];
+    }
+    agcGain_ = target;
+
+    const float levelDb = 0.5f * kDbPerLog2 * fastLog2(energy / static_cast<float>(count) + DC_OFFSET);
+    if (levelDb - agcGainDb_ < AGC_GATE_DB) {
+        return;  // Pauses and background noise hold the gain
+    }
 
-        overDb += DC_OFFSET;  // Add DC offset to avoid denormal
+    const float error = AGC_TARGET_DB - levelDb;
+    const float rate = (error < 0.0f ? AGC_DECAY_RATE : AGC_GROW_RATE) * agcRateScale_;
+    agcGainDb_ = std::clamp(agcGainDb_ + error * rate * static_cast<float>(count),
+                            AGC_MIN_GAIN_DB, AGC_MAX_GAIN_DB);
+}
 
-        // Envelope detector with attack/release
-        if (overDb > envDb_) {
-            envDb_ = overDb + ATTACK_COEF * (envDb_ - overDb);   // Fast attack
+void AudioLimiter::computeLookAheadGain(float* samples, const float* levels, float* gainLog2, int count) {
+    const float thresholdLog2 = thresholdDb_ / kDbPerLog2;
+    const uint32_t window = static_cast<uint32_t>(lookAhead_) + 1;
+    const double rampScale = 1.0 / static_cast<double>(window);
+    constexpr int kQueueCapacity = MAX_LOOKAHEAD_SAMPLES + 1;
+
+    for (int i = 0; i < count; ++i) {
+        // 10:1 curve for the sample entering the delay line
+        const float overLog2 = std::max(levels[i] - thresholdLog2, 0.0f);
+        const float target = overLog2 * (ratio_ - 1.0f);
+
+        // Deepest reduction any sample still in the delay line needs
+        if (minSize_ > 0 && sampleIndex_ - minIndices_[minHead_] >= window) {
+            minHead_ = minHead_ + 1 == kQueueCapacity ? 0 : minHead_ + 1;
+            --minSize_;
+        }
+        int back = minHead_ + minSize_;
+        back = back >= kQueueCapacity ? back - kQueueCapacity : back;
+        while (minSize_ > 0) {
+            const int last = back == 0 ? kQueueCapacity - 1 : back - 1;
+            if (minValues_[last] < target) {
+                break;
+            }
+            back = last;
+            --minSize_;
+        }
+        minValues_[back] = target;
+        minIndices_[back] = sampleIndex_;
+        ++minSize_;
+        const float held = minValues_[minHead_];
+        ++sampleIndex_;
+
+        // Take more reduction at once, give it back slowly
+        if (held < releasedGain_) {
+            releasedGain_ = held;
         } else {
-            envDb_ = overDb + RELEASE_COEF * (envDb_ - overDb);  // Slow release
+            releasedGain_ = held + releaseCoef_ * (releasedGain_ - held);
+            if (releasedGain_ - held > -kReleaseSnap) {
+                releasedGain_ = held;  // Settled; keeps the decay out of denormals
+            }
         }
 
-        overDb = envDb_ - DC_OFFSET;  // Remove DC offset
+        // Averaging over the window turns the step into an attack ramp that
+        // is complete by the time the sample that caused it comes out.
+        rampSum_ += static_cast<double>(releasedGain_) - rampValues_[rampPos_];
+        rampValues_[rampPos_] = releasedGain_;
+        rampPos_ = rampPos_ + 1 == static_cast<int>(window) ? 0 : rampPos_ + 1;
+        gainLog2[i] = static_cast<float>(rampSum_ * rampScale);
 
-        // Calculate gain reduction using compression ratio
-        double gainReductionDb = overDb * (ratio_ - 1.0);  // Gain reduction in dB
-        double gainReduction = dB2lin(gainReductionDb);    // Convert to linear
+        const float delayed = delayLine_[delayPos_];
+        delayLine_[delayPos_] = samples[i];
+        samples[i] = delayed;
+        delayPos_ = delayPos_ + 1 == lookAhead_ ? 0 : delayPos_ + 1;
+    }
+}
 
-        // Apply gain reduction to input sample
-        samples[i] = outputGain_ * samples[i] * gainReduction;
+void AudioLimiter::processBlock(float* samples, int count) {
+    alignas(16) float levels[BLOCK_SIZE];
+    alignas(16) float gainLog2[BLOCK_SIZE];
+
+    if (agcEnabled_) {
+        applyAgc(samples, count);
+    }
+
+    // Rectify, add DC offset to avoid log(0), convert to log2 units
+    computeLevels(samples, levels, count, DC_OFFSET);
+
+    if (lookAhead_ > 0) {
+        computeLookAheadGain(samples, levels, gainLog2, count);
+    } else {
+        const float gainSlope = (ratio_ - 1.0f) / kDbPerLog2;
+        const float attackCoef = attackCoef_;
+        const float releaseCoef = releaseCoef_;
+        float envDb = envDb_;
+        for (int i = 0; i < count; ++i) {
+            // Calculate overdB (how much above threshold)
+            float overDb = levels[i] * kDbPerLog2 - thresholdDb_;
+            if (overDb < 0.0f) {
+                overDb = 0.0f;
+            }
+
+            overDb += DC_OFFSET;  // Add DC offset to avoid denormal
+
+            // Envelope detector with attack/release
+            if (overDb > envDb) {
+                envDb = overDb + attackCoef * (envDb - overDb);   // Fast attack
+            } else {
+                envDb = overDb + releaseCoef * (envDb - overDb);  // Slow release
+            }
+
+            // Gain reduction in log2 units using compression ratio
+            gainLog2[i] = (envDb - DC_OFFSET) * gainSlope;
+        }
+        envDb_ = envDb;
+    }
+
+    if (gainBlockSize_ == 1) {
+        applyGainLog2(samples, gainLog2, count, outputGain_);
+        lastGain_ = fastExp2(gainLog2[count - 1]);
+        return;
+    }
+
+    // Gain curve: exact at each sub-block end, linear in between.
+    // levels[] is no longer needed, so it holds the curve.
+    float gain = lastGain_;
+    for (int start = 0; start < count; start += gainBlockSize_) {
+        const int length = std::min(gainBlockSize_, count - start);
+        const float target = fastExp2(gainLog2[start + length - 1]);
+        const float step = (target - gain) / static_cast<float>(length);
+        for (int i = 0; i < length; ++i) {
+            levels[start + i] = gain + step * static_cast<float>(i + 1);
+        }
+        gain = target;
+    }
+    lastGain_ = gain;
+
+    const float outputGain = outputGain_;
+    for (int i = 0; i < count; ++i) {
+        samples[i] *= outputGain * levels[i];
     }
 }
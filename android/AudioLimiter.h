@@ -18,36 +18,114 @@
 #ifndef AUDIOLIMITER_H
 #define AUDIOLIMITER_H
 
-#include <cmath>
+#include <array>
+#include <cstdint>
 
 // SVXLink-style audio limiter for FM transmission (-6dBFS)
 // Fast attack (~2ms) / slow release (~20ms) envelope detector
 // with 10:1 compression ratio
+//
+// Works in float on blocks of BLOCK_SIZE samples: the level of a whole
+// block is taken with a polynomial log2, the envelope runs per sample,
+// and the gain is applied with a polynomial exp2.  Both the level and the
+// gain loops use SSE2 or NEON where available.  Stays within 0.01 dB of
+// the original double-precision log()/exp() limiter.
+//
+// Two optional stages share the same pass over each block:
+//  - Look-ahead: the audio is delayed by N samples while the gain is worked
+//    out from the undelayed input, so a transient is already attenuated
+//    when it leaves instead of overshooting for the first milliseconds.
+//    The 2 ms attack becomes a ramp over the look-ahead window, peaks
+//    never exceed the 10:1 curve, and release stays ~20 ms.
+//  - AGC: a slow gain (seconds) ahead of the limiter that pulls speech
+//    towards AGC_TARGET_DB, frozen while the input is below the gate.
+//
+// The time constants are per sample at TUNED_SAMPLE_RATE; setSampleRate()
+// rescales them so attack, release and AGC keep their durations when the
+// TX chain runs at the capture rate.
 class AudioLimiter {
 public:
-    AudioLimiter() : thresholdDb_(-6.0), ratio_(0.1), outputGain_(1.0), envDb_(DC_OFFSET) {}
+    static constexpr int BLOCK_SIZE = 64;
+    static constexpr int TUNED_SAMPLE_RATE = 16000;
+    // One 20 ms Opus frame at 48 kHz
+    static constexpr int MAX_LOOKAHEAD_SAMPLES = 960;
+    static constexpr float AGC_TARGET_DB = -18.0f;
+    static constexpr float AGC_MIN_GAIN_DB = -12.0f;
+    static constexpr float AGC_MAX_GAIN_DB = 15.0f;
 
     void processAudio(float* samples, int count);
 
+    // Clears the delay line and detector state.  The AGC gain is kept, so
+    // the next transmission starts at the level the last one settled on.
+    void reset();
+
+    // With n > 1 the gain is evaluated once per n samples and ramped
+    // linearly in between instead of per sample.  Sub-blocks are counted
+    // from the start of each call and of each BLOCK_SIZE block, so pick n
+    // dividing both.  n = 1 (the default) is per sample.  Only pays off
+    // where neither SSE2 nor NEON is available for the per-sample exp2.
+    void setGainBlockSize(int samples);
+    int gainBlockSize() const { return gainBlockSize_; }
+
+    // 0 (the default) keeps the original feed-forward limiter.  Changing
+    // it resets the limiter.
+    void setLookAheadSamples(int samples);
+    int lookAheadSamples() const { return lookAhead_; }
+    // Samples of delay the limiter adds; processing that many samples of
+    // silence pushes out the tail of the last real audio.
+    int latencySamples() const { return lookAhead_; }
+
+    // TUNED_SAMPLE_RATE by default.  Changing it resets the limiter; the
+    // look-ahead stays in samples, so set it again for the new rate.
+    void setSampleRate(int sampleRate);
+    int sampleRate() const { return sampleRate_; }
+
+    void setAgcEnabled(bool enabled);
+    bool agcEnabled() const { return agcEnabled_; }
+    float agcGainDb() const { return agcGainDb_; }
+
 private:
-    double thresholdDb_;  // -6dB threshold for FM
-    double ratio_;        // 0.1 = 10:1 compression ratio
-    double outputGain_;   // Output gain
-    double envDb_;        // Envelope detector state
-
-    static constexpr double ATTACK_COEF = 0.99;   // ~2ms attack
-    static constexpr double RELEASE_COEF = 0.9995; // ~20ms release
-    static constexpr double DC_OFFSET = 1.0E-25;
-
-    inline double lin2dB(double lin) const {
-        static const double LOG_2_DB = 8.6858896380650365530225783783321;
-        return log(lin) * LOG_2_DB;
-    }
-
-    inline double dB2lin(double dB) const {
-        static const double DB_2_LOG = 0.11512925464970228420089957273422;
-        return exp(dB * DB_2_LOG);
-    }
+    float thresholdDb_ = -6.0f;  // -6dB threshold for FM
+    float ratio_ = 0.1f;         // 0.1 = 10:1 compression ratio
+    float outputGain_ = 1.0f;    // Output gain
+    float envDb_ = DC_OFFSET;    // Envelope detector state
+    float lastGain_ = 1.0f;      // Gain at the end of the last sub-block
+    int gainBlockSize_ = 1;
+    int sampleRate_ = TUNED_SAMPLE_RATE;
+    float attackCoef_ = ATTACK_COEF;
+    float releaseCoef_ = RELEASE_COEF;
+    float agcRateScale_ = 1.0f;
+
+    // Look-ahead state, in log2 gain units.  The window minimum is a
+    // monotonic queue; the attack ramp is a moving average over the window.
+    int lookAhead_ = 0;
+    int delayPos_ = 0;
+    std::array<float, MAX_LOOKAHEAD_SAMPLES> delayLine_{};
+    std::array<float, MAX_LOOKAHEAD_SAMPLES + 1> minValues_{};
+    std::array<uint32_t, MAX_LOOKAHEAD_SAMPLES + 1> minIndices_{};
+    int minHead_ = 0;
+    int minSize_ = 0;
+    uint32_t sampleIndex_ = 0;
+    float releasedGain_ = 0.0f;
+    std::array<float, MAX_LOOKAHEAD_SAMPLES + 1> rampValues_{};
+    int rampPos_ = 0;
+    double rampSum_ = 0.0;
+
+    bool agcEnabled_ = false;
+    float agcGainDb_ = 0.0f;
+    float agcGain_ = 1.0f;
+
+    static constexpr float ATTACK_COEF = 0.99f;    // ~2ms attack
+    static constexpr float RELEASE_COEF = 0.9995f; // ~20ms release
+    static constexpr float DC_OFFSET = 1.0E-25f;
+    // AGC reaction per sample: ~0.5 s to come down, ~3 s to come up
+    static constexpr float AGC_DECAY_RATE = 1.0f / 8000.0f;
+    static constexpr float AGC_GROW_RATE = 1.0f / 48000.0f;
+    static constexpr float AGC_GATE_DB = -50.0f;
+
+    void processBlock(float* samples, int count);
+    void applyAgc(float* samples, int count);
+    void computeLookAheadGain(float* samples, const float* levels, float* gainLog2, int count);
 };
 
 #endif // AUDIOLIMITER_H
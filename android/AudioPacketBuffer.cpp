@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2025 Silviu YO6SAY
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "AudioPacketBuffer.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+// Large enough for a 60 ms multi-frame Opus packet from a legacy client.
+constexpr size_t kReservedPayloadBytes = 1500;
+}
+
+AudioPacketBuffer::AudioPacketBuffer(int windowPackets)
+{
+    int slotCount = 1;
+    while (slotCount < std::max(windowPackets, 2)) {
+        slotCount <<= 1;
+    }
+    m_slots.resize(static_cast<size_t>(slotCount));
+    for (Packet &slot : m_slots) {
+        slot.payload.reserve(kReservedPayloadBytes);
+    }
+    m_mask = static_cast<uint16_t>(slotCount - 1);
+}
+
+void AudioPacketBuffer::reset()
+{
+    for (Packet &slot : m_slots) {
+        slot.occupied = false;
+        slot.payload.clear();
+    }
+    m_anchored = false;
+    m_nextSequence = 0;
+    m_heldCount = 0;
+}
+
+AudioPacketBuffer::InsertResult AudioPacketBuffer::insert(uint16_t sequence, const unsigned char* data,
+                                                          int size, int64_t arrivalUs)
+{
+    if (!m_anchored) {
+        m_anchored = true;
+        m_nextSequence = sequence;
+    }
+
+    const int16_t ahead = static_cast<int16_t>(sequence - m_nextSequence);
+    if (ahead < 0) {
+        return InsertResult::Late;
+    }
+    if (ahead >= windowPackets()) {
+        return InsertResult::TooFarAhead;
+    }
+
+    Packet &slot = slotFor(sequence);
+    if (slot.occupied) {
+        return InsertResult::Duplicate;
+    }
+
+    slot.occupied = true;
+    slot.sequence = sequence;
+    slot.arrivalUs = arrivalUs;
+    slot.payload.assign(data, data + std::max(size, 0));
+    ++m_heldCount;
+    return InsertResult::Accepted;
+}
+
+const AudioPacketBuffer::Packet* AudioPacketBuffer::peek(int offset) const
+{
+    if (offset < 0 || offset >= windowPackets()) {
+        return nullptr;
+    }
+    const Packet &slot = slotFor(static_cast<uint16_t>(m_nextSequence + offset));
+    return slot.occupied ? &slot : nullptr;
+}
+
+void AudioPacketBuffer::advance()
+{
+    Packet &slot = slotFor(m_nextSequence);
+    if (slot.occupied) {
+        slot.occupied = false;
+        --m_heldCount;
+    }
+    ++m_nextSequence;
+}
+
+void AudioPacketBuffer::skipTo(uint16_t sequence)
+{
+    if (!m_anchored) {
+        m_anchored = true;
+        m_nextSequence = sequence;
+        return;
+    }
+
+    int16_t ahead = static_cast<int16_t>(sequence - m_nextSequence);
+    if (ahead >= windowPackets()) {
+        // Everything held lies before the new anchor.
+        for (Packet &slot : m_slots) {
+            slot.occupied = false;
+        }
+        m_heldCount = 0;
+        m_nextSequence = sequence;
+        return;
+    }
+    while (ahead-- > 0) {
+        advance();
+    }
+}
+
+int AudioPacketBuffer::gapBeforeNextHeld() const
+{
+    if (m_heldCount == 0) {
+        return -1;
+    }
+    for (int offset = 0; offset < windowPackets(); ++offset) {
+        if (slotFor(static_cast<uint16_t>(m_nextSequence + offset)).occupied) {
+            return offset;
+        }
+    }
+    return -1;
+}
+
+int64_t AudioPacketBuffer::oldestHeldArrivalUs() const
+{
+    int64_t oldest = std::numeric_limits<int64_t>::max();
+    for (const Packet &slot : m_slots) {
+        if (slot.occupied) {
+            oldest = std::min(oldest, slot.arrivalUs);
+        }
+    }
+    return oldest;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2025 Silviu YO6SAY
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef AUDIOPACKETBUFFER_H
+#define AUDIOPACKETBUFFER_H
+
+#include <cstdint>
+#include <vector>
+
+// Reorder buffer for received Opus payloads, keyed by the 16-bit UDP
+// sequence number.
+//
+// Packets are released strictly in sequence order.  A packet that arrives
+// ahead of a gap is held until either the missing one shows up or the
+// caller decides the gap is due for playout and skips it.  Packets behind
+// the next sequence to be released are late and rejected.
+//
+// Slots are preallocated and indexed by sequence & mask, so the window is
+// a power of two and holding a packet never allocates for typical payloads.
+class AudioPacketBuffer
+{
+public:
+    enum class InsertResult {
+        Accepted,
+        Duplicate,
+        Late,
+        TooFarAhead
+    };
+
+    struct Packet {
+        bool occupied = false;
+        uint16_t sequence = 0;
+        int64_t arrivalUs = 0;
+        std::vector<unsigned char> payload;
+    };
+
+    explicit AudioPacketBuffer(int windowPackets = 16);
+
+    void reset();
+
+    InsertResult insert(uint16_t sequence, const unsigned char* data, int size, int64_t arrivalUs);
+
+    bool isAnchored() const { return m_anchored; }
+    uint16_t nextSequence() const { return m_nextSequence; }
+    int heldCount() const { return m_heldCount; }
+    int windowPackets() const { return static_cast<int>(m_slots.size()); }
+
+    // The packet for nextSequence(), or nullptr when it has not arrived.
+    const Packet* next() const { return peek(0); }
+    // The packet offset slots past nextSequence(), or nullptr.
+    const Packet* peek(int offset) const;
+    // Releases (or gives up on) nextSequence() and moves to the one after.
+    void advance();
+    // Re-anchors the window at sequence, dropping anything held before it.
+    void skipTo(uint16_t sequence);
+
+    // Number of missing sequences in front of the earliest held packet, or
+    // -1 when nothing is held.
+    int gapBeforeNextHeld() const;
+    int64_t oldestHeldArrivalUs() const;
+
+private:
+    Packet& slotFor(uint16_t sequence) { return m_slots[sequence & m_mask]; }
+    const Packet& slotFor(uint16_t sequence) const { return m_slots[sequence & m_mask]; }
+
+    std::vector<Packet> m_slots;
+    uint16_t m_mask = 0;
+    bool m_anchored = false;
+    uint16_t m_nextSequence = 0;
+    int m_heldCount = 0;
+};
+
+#endif // AUDIOPACKETBUFFER_H
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2025 Silviu YO6SAY
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "AudioPacketQueue.h"
+
+#include <algorithm>
+#include <cstring>
+
+AudioPacketQueue::AudioPacketQueue(int capacityPackets)
+{
+    uint32_t capacity = 1;
+    while (capacity < static_cast<uint32_t>(std::max(capacityPackets, 1))) {
+        capacity <<= 1;
+    }
+    m_slots.resize(capacity);
+    m_mask = capacity - 1;
+}
+
+bool AudioPacketQueue::push(uint16_t sequence, const unsigned char* data, int size, int64_t arrivalUs)
+{
+    if (data == nullptr || size <= 0 || size > MAX_PAYLOAD_BYTES) {
+        m_droppedPackets.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    const uint32_t head = m_head.load(std::memory_order_relaxed);
+    const uint32_t tail = m_tail.load(std::memory_order_acquire);
+    if (head - tail >= static_cast<uint32_t>(m_slots.size())) {
+        m_droppedPackets.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    Packet &slot = m_slots[head & m_mask];
+    slot.sequence = sequence;
+    slot.arrivalUs = arrivalUs;
+    slot.size = size;
+    slot.flush = false;
+    std::memcpy(slot.payload.data(), data, static_cast<size_t>(size));
+
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+bool AudioPacketQueue::pushFlush()
+{
+    const uint32_t head = m_head.load(std::memory_order_relaxed);
+    const uint32_t tail = m_tail.load(std::memory_order_acquire);
+    if (head - tail >= static_cast<uint32_t>(m_slots.size())) {
+        return false;
+    }
+
+    Packet &slot = m_slots[head & m_mask];
+    slot.sequence = 0;
+    slot.arrivalUs = 0;
+    slot.size = 0;
+    slot.flush = true;
+
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+const AudioPacketQueue::Packet* AudioPacketQueue::front() const
+{
+    const uint32_t tail = m_tail.load(std::memory_order_relaxed);
+    if (m_head.load(std::memory_order_acquire) == tail) {
+        return nullptr;
+    }
+    return &m_slots[tail & m_mask];
+}
+
+void AudioPacketQueue::pop()
+{
+    const uint32_t tail = m_tail.load(std::memory_order_relaxed);
+    if (m_head.load(std::memory_order_acquire) != tail) {
+        m_tail.store(tail + 1, std::memory_order_release);
+    }
+}
+
+void AudioPacketQueue::clear()
+{
+    m_tail.store(m_head.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+int AudioPacketQueue::size() const
+{
+    return static_cast<int>(m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire));
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2025 Silviu YO6SAY
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef AUDIOPACKETQUEUE_H
+#define AUDIOPACKETQUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Wait-free single-producer / single-consumer handoff of received Opus
+// payloads from the socket thread to the audio thread.
+//
+// Every slot carries its own fixed payload storage, so pushing a datagram
+// is a memcpy into memory allocated once at construction; nothing is
+// allocated per packet.  Positions are free-running counters over a
+// power-of-two ring, like AudioJitterBuffer.  When the ring is full the
+// newest packet is dropped and counted: the audio thread is stalled and the
+// reorder buffer would discard it as late anyway.
+//
+// A packet with flush set carries no payload; it marks the point in the
+// stream where the reflector flushed, so the consumer resets exactly there.
+class AudioPacketQueue
+{
+public:
+    // Opus packets are at most 1275 bytes; anything that fits an Ethernet
+    // MTU is accepted.
+    static constexpr int MAX_PAYLOAD_BYTES = 1500;
+
+    struct Packet {
+        uint16_t sequence = 0;
+        int64_t arrivalUs = 0;
+        int size = 0;
+        bool flush = false;
+        std::array<unsigned char, MAX_PAYLOAD_BYTES> payload{};
+    };
+
+    explicit AudioPacketQueue(int capacityPackets = 64);
+
+    // Producer side.
+    bool push(uint16_t sequence, const unsigned char* data, int size, int64_t arrivalUs);
+    bool pushFlush();
+    uint64_t droppedPackets() const { return m_droppedPackets.load(std::memory_order_relaxed); }
+
+    // Consumer side.  front() stays valid until pop().
+    const Packet* front() const;
+    void pop();
+    void clear();
+
+    int size() const;
+    int capacity() const { return static_cast<int>(m_slots.size()); }
+
+private:
+    std::vector<Packet> m_slots;
+    uint32_t m_mask = 0;
+
+    std::atomic<uint32_t> m_head{0};
+    std::atomic<uint32_t> m_tail{0};
+    std::atomic<uint64_t> m_droppedPackets{0};
+};
+
+#endif // AUDIOPACKETQUEUE_H
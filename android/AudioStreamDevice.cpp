@@ -21,11 +21,12 @@
 #include <algorithm>
 #include <QDebug>
 
-AudioStreamDevice::AudioStreamDevice(AudioJitterBuffer* jitterBuffer, Resampler* resampler, int outputSampleRate, QAudioFormat::SampleFormat sampleFormat, QObject *parent)
-    : QIODevice(parent), m_jitterBuffer(jitterBuffer), m_outputResampler(resampler), m_outputSampleRate(outputSampleRate), m_sampleFormat(sampleFormat)
+AudioStreamDevice::AudioStreamDevice(AudioJitterBuffer* jitterBuffer, Resampler* resampler, int sourceSampleRate, int outputSampleRate, QAudioFormat::SampleFormat sampleFormat, QObject *parent)
+    : QIODevice(parent), m_jitterBuffer(jitterBuffer), m_timeStretcher(jitterBuffer, sourceSampleRate), m_outputResampler(resampler), m_sourceSampleRate(sourceSampleRate), m_outputSampleRate(outputSampleRate), m_sampleFormat(sampleFormat)
 {
     open(QIODevice::ReadOnly);
-    qDebug() << "AudioStreamDevice created: outputSampleRate=" << outputSampleRate 
+    qDebug() << "AudioStreamDevice created: sourceSampleRate=" << sourceSampleRate
+             << "outputSampleRate=" << outputSampleRate
              << "resampler=" << (resampler ? "present" : "null");
 }
 
@@ -45,46 +46,54 @@ qint64 AudioStreamDevice::readData(char *data, qint64 maxSize)
         return 0; // It's OK to return 0 here. The sink will wait for the next readyRead.
     }
 
-    // How many 16kHz samples do we need to pull to generate that many output samples?
+    // How many decoded samples do we need to pull to generate that many output samples?
     int samplesToReadFromBuffer;
     if (m_outputResampler) {
-        samplesToReadFromBuffer = (samplesToGenerate * 16000) / m_outputSampleRate;
+        samplesToReadFromBuffer = (samplesToGenerate * m_sourceSampleRate) / m_outputSampleRate;
     } else {
         samplesToReadFromBuffer = samplesToGenerate;
     }
 
-    // Read the native 16kHz samples
-    std::vector<float> nativeSamples(samplesToReadFromBuffer);
-    const int nativeSamplesRead = m_jitterBuffer->readSamples(nativeSamples.data(), samplesToReadFromBuffer);
+    // Read the decoded samples.  The scratch buffers only grow, so a
+    // steady sink period reuses them without allocating.
+    if (m_nativeSamples.size() < static_cast<size_t>(samplesToReadFromBuffer)) {
+        m_nativeSamples.resize(static_cast<size_t>(samplesToReadFromBuffer));
+    }
+    const int nativeSamplesRead = m_timeStretcher.read(m_nativeSamples.data(), samplesToReadFromBuffer);
     if (nativeSamplesRead <= 0) {
         return 0;
     }
 
     // Resample them if needed
-    std::vector<float>* finalSamples = &nativeSamples;
-    std::vector<float> resampledSamples;
+    const float* finalSamples = m_nativeSamples.data();
+    int finalSampleCount = nativeSamplesRead;
     if (m_outputResampler) {
-        resampledSamples = m_outputResampler->process(nativeSamples.data(), nativeSamplesRead);
-        finalSamples = &resampledSamples;
-    } else if (nativeSamplesRead != samplesToReadFromBuffer) {
-        nativeSamples.resize(static_cast<size_t>(nativeSamplesRead));
+        const int capacity = m_outputResampler->maxOutputSamples(nativeSamplesRead);
+        if (m_resampledSamples.size() < static_cast<size_t>(capacity)) {
+            m_resampledSamples.resize(static_cast<size_t>(capacity));
+        }
+        finalSamples = m_resampledSamples.data();
+        finalSampleCount = std::max(0, m_outputResampler->process(
+            m_nativeSamples.data(), nativeSamplesRead, m_resampledSamples.data(), capacity));
     }
+    // Linear resampling can round one sample past what the sink asked for.
+    finalSampleCount = std::min(finalSampleCount, samplesSinkCanHold);
 
     // Write the resampled data to the buffer with format conversion if needed
-    qint64 bytesToWrite = finalSamples->size() * bytesPerSample;
+    qint64 bytesToWrite = static_cast<qint64>(finalSampleCount) * bytesPerSample;
     
     if (m_sampleFormat == QAudioFormat::Int16) {
         // Convert float samples to Int16
         qint16* int16Data = reinterpret_cast<qint16*>(data);
-        for (size_t i = 0; i < finalSamples->size(); ++i) {
-            float sample = finalSamples->at(i);
+        for (int i = 0; i < finalSampleCount; ++i) {
+            float sample = finalSamples[i];
             // Clamp to [-1.0, 1.0] and convert to Int16
             sample = std::max(-1.0f, std::min(1.0f, sample));
             int16Data[i] = static_cast<qint16>(sample * 32767.0f);
         }
     } else {
         // Float format - direct copy
-        memcpy(data, finalSamples->data(), bytesToWrite);
+        memcpy(data, finalSamples, bytesToWrite);
     }
 
     // Return the ACTUAL number of bytes written. Do not lie.
@@ -98,12 +107,12 @@ qint64 AudioStreamDevice::writeData(const char*, qint64)
 
 qint64 AudioStreamDevice::bytesAvailable() const
 {
-    const int availableNativeSamples = m_jitterBuffer->samplesReadyForPlayback();
+    const int availableNativeSamples = m_timeStretcher.samplesReadyForPlayback();
     const int bytesPerSample = (m_sampleFormat == QAudioFormat::Int16) ? sizeof(qint16) : sizeof(float);
 
     if (m_outputResampler) {
-        // The number of available bytes after resampling (16kHz -> output sample rate)
-        const int resampledSamples = (availableNativeSamples * m_outputSampleRate) / 16000;
+        // The number of available bytes after resampling (decode rate -> output sample rate)
+        const int resampledSamples = (availableNativeSamples * m_outputSampleRate) / m_sourceSampleRate;
         return resampledSamples * bytesPerSample;
     } else {
         // No resampling, so it's a 1:1 mapping
@@ -21,13 +21,17 @@
 #include <QIODevice>
 #include <QAudioFormat>
 #include "AudioJitterBuffer.h"
+#include "AudioTimeStretcher.h"
 #include "Resampler.h"
+#include <vector>
 
 class AudioStreamDevice : public QIODevice
 {
     Q_OBJECT
 public:
-    explicit AudioStreamDevice(AudioJitterBuffer* jitterBuffer, Resampler* resampler, int outputSampleRate, QAudioFormat::SampleFormat sampleFormat, QObject *parent = nullptr);
+    // jitterBuffer holds audio at sourceSampleRate; resampler, when set,
+    // converts it to outputSampleRate.
+    explicit AudioStreamDevice(AudioJitterBuffer* jitterBuffer, Resampler* resampler, int sourceSampleRate, int outputSampleRate, QAudioFormat::SampleFormat sampleFormat, QObject *parent = nullptr);
     qint64 readData(char *data, qint64 maxSize) override;
     qint64 writeData(const char *data, qint64 maxSize) override;
     qint64 bytesAvailable() const override;
@@ -37,9 +41,13 @@ public slots:
 
 private:
     AudioJitterBuffer* m_jitterBuffer;
+    AudioTimeStretcher m_timeStretcher;
     Resampler* m_outputResampler;
+    int m_sourceSampleRate;
     int m_outputSampleRate;
     QAudioFormat::SampleFormat m_sampleFormat;
+    std::vector<float> m_nativeSamples;
+    std::vector<float> m_resampledSamples;
 };
 
 #endif // AUDIOSTREAMDEVICE_H
\ No newline at end of file
@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2025 Silviu YO6SAY
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "AudioTimeStretcher.h"
+#include "AudioJitterBuffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+// Speech pitch periods lie roughly between 2.5 ms (400 Hz) and 15 ms (67 Hz).
+constexpr double kMinPeriodSeconds = 0.0025;
+constexpr double kMaxPeriodSeconds = 0.015;
+// Leave the depth alone while it is within one 20 ms packet of the target.
+constexpr double kHysteresisSeconds = 0.020;
+// At most this fraction of the output may be removed or repeated audio.
+constexpr double kMaxScaleRate = 0.05;
+// Below this similarity the join would be audible; play the block unchanged.
+constexpr float kMinCorrelation = 0.5f;
+// -60 dBFS mean square: treat as silence and cut anywhere.
+constexpr float kSilenceMeanSquare = 1.0e-6f;
+}
+
+AudioTimeStretcher::AudioTimeStretcher(AudioJitterBuffer* source, int sampleRate)
+    : m_source(source)
+    , m_minPeriod(std::max(1, static_cast<int>(sampleRate * kMinPeriodSeconds)))
+    , m_maxPeriod(std::max(2, static_cast<int>(sampleRate * kMaxPeriodSeconds)))
+    , m_hysteresis(static_cast<int>(sampleRate * kHysteresisSeconds))
+{
+    m_block.resize(static_cast<size_t>(m_maxPeriod * 2));
+    m_pending.resize(static_cast<size_t>(m_maxPeriod * 3));
+}
+
+void AudioTimeStretcher::reset()
+{
+    m_pendingStart = 0;
+    m_pendingCount = 0;
+    m_budget = 0.0;
+}
+
+unsigned AudioTimeStretcher::samplesReadyForPlayback() const
+{
+    const unsigned sourceReady = m_source ? m_source->samplesReadyForPlayback() : 0u;
+    return static_cast<unsigned>(m_pendingCount) + sourceReady;
+}
+
+AudioTimeStretcher::Mode AudioTimeStretcher::chooseMode(unsigned depth, unsigned target) const
+{
+    if (target == 0 || m_budget < m_minPeriod) {
+        return Mode::Normal;
+    }
+    if (depth > target + static_cast<unsigned>(m_hysteresis)) {
+        return Mode::Accelerate;
+    }
+    if (depth + static_cast<unsigned>(m_hysteresis / 2) < target) {
+        return Mode::Decelerate;
+    }
+    return Mode::Normal;
+}
+
+int AudioTimeStretcher::drainPending(float* output, int count)
+{
+    const int toCopy = std::min(count, m_pendingCount);
+    if (toCopy > 0) {
+        std::memcpy(output, m_pending.data() + m_pendingStart, static_cast<size_t>(toCopy) * sizeof(float));
+        m_pendingStart += toCopy;
+        m_pendingCount -= toCopy;
+    }
+    if (m_pendingCount == 0) {
+        m_pendingStart = 0;
+    }
+    return toCopy;
+}
+
+int AudioTimeStretcher::read(float* output, int count)
+{
+    if (output == nullptr || count <= 0 || m_source == nullptr) {
+        return 0;
+    }
+
+    int written = drainPending(output, count);
+    while (written < count) {
+        const unsigned ready = m_source->samplesReadyForPlayback();
+        if (ready == 0) {
+            break;
+        }
+
+        const Mode mode = chooseMode(ready, m_source->prebufSamples());
+        const int blockSamples = std::min(static_cast<int>(ready), static_cast<int>(m_block.size()));
+        if (mode != Mode::Normal && blockSamples >= 2 * m_minPeriod) {
+            processBlock(mode, blockSamples);
+            written += drainPending(output + written, count - written);
+            continue;
+        }
+
+        const int toRead = std::min(count - written, static_cast<int>(ready));
+        const int readCount = m_source->readSamples(output + written, toRead);
+        if (readCount <= 0) {
+            break;
+        }
+        written += readCount;
+    }
+
+    m_budget = std::min(m_budget + kMaxScaleRate * written, static_cast<double>(m_maxPeriod * 2));
+    return written;
+}
+
+void AudioTimeStretcher::processBlock(Mode mode, int blockSamples)
+{
+    const int length = m_source->readSamples(m_block.data(), blockSamples);
+    if (length <= 0) {
+        return;
+    }
+    const float* x = m_block.data();
+    float* y = m_pending.data();
+
+    const int maxPeriod = std::min({m_maxPeriod, length / 2, static_cast<int>(m_budget)});
+    float correlation = 0.0f;
+    const int period = maxPeriod >= m_minPeriod ? findPitchPeriod(x, length, correlation) : 0;
+
+    if (period == 0 || correlation < kMinCorrelation) {
+        std::memcpy(y, x, static_cast<size_t>(length) * sizeof(float));
+        m_pendingCount = length;
+        return;
+    }
+
+    const float step = 1.0f / static_cast<float>(period + 1);
+    if (mode == Mode::Accelerate) {
+        // Fade the first period into the second, then continue after both.
+        for (int i = 0; i < period; ++i) {
+            const float w = static_cast<float>(i + 1) * step;
+            y[i] = x[i] * (1.0f - w) + x[i + period] * w;
+        }
+        std::memcpy(y + period, x + 2 * period, static_cast<size_t>(length - 2 * period) * sizeof(float));
+        m_pendingCount = length - period;
+        m_removedSamples += period;
+    } else {
+        // Play the first period, fade the second back into the first, then
+        // play the second period again followed by the rest.
+        std::memcpy(y, x, static_cast<size_t>(period) * sizeof(float));
+        for (int i = 0; i < period; ++i) {
+            const float w = static_cast<float>(i + 1) * step;
+            y[period + i] = x[period + i] * (1.0f - w) + x[i] * w;
+        }
+        std::memcpy(y + 2 * period, x + period, static_cast<size_t>(length - period) * sizeof(float));
+        m_pendingCount = length + period;
+        m_insertedSamples += period;
+    }
+    m_budget -= period;
+}
+
+int AudioTimeStretcher::findPitchPeriod(const float* samples, int count, float &correlation) const
+{
+    const int maxPeriod = std::min({m_maxPeriod, count / 2, static_cast<int>(m_budget)});
+
+    float energy = 0.0f;
+    for (int i = 0; i < 2 * maxPeriod; ++i) {
+        energy += samples[i] * samples[i];
+    }
+    if (energy < kSilenceMeanSquare * static_cast<float>(2 * maxPeriod)) {
+        correlation = 1.0f;
+        return maxPeriod;
+    }
+
+    int bestPeriod = 0;
+    correlation = -1.0f;
+    for (int period = m_minPeriod; period <= maxPeriod; ++period) {
+        float cross = 0.0f;
+        float first = 0.0f;
+        float second = 0.0f;
+        for (int i = 0; i < period; ++i) {
+            cross += samples[i] * samples[i + period];
+            first += samples[i] * samples[i];
+            second += samples[i + period] * samples[i + period];
+        }
+        const float denominator = std::sqrt(first * second);
+        const float normalized = denominator > 0.0f ? cross / denominator : 0.0f;
+        if (normalized > correlation) {
+            correlation = normalized;
+            bestPeriod = period;
+        }
+    }
+    return bestPeriod;
+}
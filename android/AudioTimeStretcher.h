@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2025 Silviu YO6SAY
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef AUDIOTIMESTRETCHER_H
+#define AUDIOTIMESTRETCHER_H
+
+#include <cstdint>
+#include <vector>
+
+class AudioJitterBuffer;
+
+// Playout-side time-scale modification between the jitter buffer and the
+// audio output.
+//
+// Reads go through the stretcher instead of straight to the jitter buffer.
+// When the buffered depth sits above the jitter buffer's prebuffer target
+// the stretcher removes one pitch period from the next block; when it runs
+// low it repeats one.  The period is the lag with the highest normalized
+// cross-correlation (waveform similarity) and the two periods are joined
+// with a linear cross-fade, so pitch is preserved and there is no jump in
+// the waveform.  How often this may happen is capped, so playback speed
+// never moves by more than a few percent.
+//
+// Consumer-thread only, like AudioJitterBuffer::readSamples().
+class AudioTimeStretcher
+{
+public:
+    explicit AudioTimeStretcher(AudioJitterBuffer* source, int sampleRate = 16000);
+
+    void reset();
+
+    // Fills up to count samples and returns how many were written; fewer
+    // than count only when the jitter buffer has run dry.
+    int read(float* output, int count);
+    unsigned samplesReadyForPlayback() const;
+
+    int64_t removedSamples() const { return m_removedSamples; }
+    int64_t insertedSamples() const { return m_insertedSamples; }
+
+private:
+    enum class Mode {
+        Normal,
+        Accelerate,
+        Decelerate
+    };
+
+    Mode chooseMode(unsigned depth, unsigned target) const;
+    int drainPending(float* output, int count);
+    void processBlock(Mode mode, int blockSamples);
+    int findPitchPeriod(const float* samples, int count, float &correlation) const;
+
+    AudioJitterBuffer* m_source;
+    int m_minPeriod;
+    int m_maxPeriod;
+    int m_hysteresis;
+
+    std::vector<float> m_block;
+    std::vector<float> m_pending;
+    int m_pendingStart = 0;
+    int m_pendingCount = 0;
+    double m_budget = 0.0;
+
+    int64_t m_removedSamples = 0;
+    int64_t m_insertedSamples = 0;
+};
+
+#endif // AUDIOTIMESTRETCHER_H
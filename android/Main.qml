@@ -137,6 +137,16 @@ Window {
         property int pttHangTimeMs: 100
         property bool tapToTalkButtonVisible: true
         property bool liveTranscriptionEnabled: false
+        property bool adaptiveJitterBufferEnabled: true
+        property real jitterBufferUnderrunProbability: 0.02
+        property bool txFecEnabled: false
+        property bool txDtxEnabled: false
+        property bool txAgcEnabled: false
+        property int txLookAheadMs: 5
+        property int txPacketizationMs: 0
+        property int txMaxBacklogMs: ReflectorClient.txMaxBacklogDefaultMs
+        property bool udpReceiveThreadEnabled: false
+        property bool txEncodeThreadEnabled: false
         property string nodeInfoPropertiesJson: "[]"
     }
 
@@ -670,6 +680,85 @@ Window {
         saved.tapToTalkButtonVisible = !!visible
     }
 
+    function updateAdaptiveJitterBufferEnabled(enabled) {
+        saved.adaptiveJitterBufferEnabled = !!enabled
+        ReflectorClient.setAdaptiveJitterBufferEnabled(saved.adaptiveJitterBufferEnabled)
+    }
+
+    function updateJitterBufferUnderrunProbability(probability) {
+        const numericValue = Number(probability)
+        const normalizedProbability = Number.isFinite(numericValue)
+                ? Math.max(0.001, Math.min(0.25, numericValue))
+                : 0.02
+        saved.jitterBufferUnderrunProbability = normalizedProbability
+        ReflectorClient.setJitterBufferUnderrunProbability(normalizedProbability)
+    }
+
+    function updateTxFecEnabled(enabled) {
+        saved.txFecEnabled = !!enabled
+        ReflectorClient.setTxFecEnabled(saved.txFecEnabled)
+    }
+
+    function updateTxDtxEnabled(enabled) {
+        saved.txDtxEnabled = !!enabled
+        ReflectorClient.setTxDtxEnabled(saved.txDtxEnabled)
+    }
+
+    function updateTxAgcEnabled(enabled) {
+        saved.txAgcEnabled = !!enabled
+        ReflectorClient.setTxAgcEnabled(saved.txAgcEnabled)
+    }
+
+    function normalizeTxLookAheadMs(milliseconds) {
+        const numericValue = Number(milliseconds)
+        if (!Number.isFinite(numericValue) || !Number.isInteger(numericValue) || numericValue < 0)
+            return 5
+        return Math.min(numericValue, 20)
+    }
+
+    function updateTxLookAheadMs(milliseconds) {
+        const normalizedMilliseconds = normalizeTxLookAheadMs(milliseconds)
+        saved.txLookAheadMs = normalizedMilliseconds
+        ReflectorClient.setTxLookAheadMs(normalizedMilliseconds)
+    }
+
+    function normalizeTxPacketizationMs(milliseconds) {
+        const numericValue = Number(milliseconds)
+        if (numericValue === 20 || numericValue === 40 || numericValue === 60)
+            return numericValue
+        return 0
+    }
+
+    function updateTxPacketizationMs(milliseconds) {
+        const normalizedMilliseconds = normalizeTxPacketizationMs(milliseconds)
+        saved.txPacketizationMs = normalizedMilliseconds
+        ReflectorClient.setTxPacketizationMs(normalizedMilliseconds)
+    }
+
+    function normalizeTxMaxBacklogMs(milliseconds) {
+        const numericValue = Number(milliseconds)
+        if (!Number.isFinite(numericValue) || !Number.isInteger(numericValue))
+            return ReflectorClient.txMaxBacklogDefaultMs
+        return Math.max(ReflectorClient.txMaxBacklogMinMs,
+                        Math.min(numericValue, ReflectorClient.txMaxBacklogMaxMs))
+    }
+
+    function updateTxMaxBacklogMs(milliseconds) {
+        const normalizedMilliseconds = normalizeTxMaxBacklogMs(milliseconds)
+        saved.txMaxBacklogMs = normalizedMilliseconds
+        ReflectorClient.setTxMaxBacklogMs(normalizedMilliseconds)
+    }
+
+    function updateUdpReceiveThreadEnabled(enabled) {
+        saved.udpReceiveThreadEnabled = !!enabled
+        ReflectorClient.setUdpReceiveThreadEnabled(saved.udpReceiveThreadEnabled)
+    }
+
+    function updateTxEncodeThreadEnabled(enabled) {
+        saved.txEncodeThreadEnabled = !!enabled
+        ReflectorClient.setTxEncodeThreadEnabled(saved.txEncodeThreadEnabled)
+    }
+
     function updateLiveTranscriptionEnabled(enabled) {
         const allowLiveTranscription = uiMetrics.liveTranscriptionAllowed
         const normalizedEnabled = allowLiveTranscription && !!enabled
@@ -694,6 +783,16 @@ Window {
             window.updateTxAudioLevel(saved.txAudioLevelDb)
             window.updateTxTimeoutSeconds(saved.txTimeoutSeconds)
             window.updatePttHangTimeMs(saved.pttHangTimeMs)
+            window.updateJitterBufferUnderrunProbability(saved.jitterBufferUnderrunProbability)
+            window.updateAdaptiveJitterBufferEnabled(saved.adaptiveJitterBufferEnabled)
+            window.updateTxFecEnabled(saved.txFecEnabled)
+            window.updateTxDtxEnabled(saved.txDtxEnabled)
+            window.updateTxAgcEnabled(saved.txAgcEnabled)
+            window.updateTxLookAheadMs(saved.txLookAheadMs)
+            window.updateTxPacketizationMs(saved.txPacketizationMs)
+            window.updateTxMaxBacklogMs(saved.txMaxBacklogMs)
+            window.updateUdpReceiveThreadEnabled(saved.udpReceiveThreadEnabled)
+            window.updateTxEncodeThreadEnabled(saved.txEncodeThreadEnabled)
             window.updateLiveTranscriptionEnabled(saved.liveTranscriptionEnabled)
         })
     }
@@ -841,6 +940,9 @@ Window {
             txAudioLevelDb: ReflectorClient.txAudioLevelDb
             txTimeoutSeconds: ReflectorClient.txTimeoutSeconds
             pttHangTimeMs: ReflectorClient.pttHangTimeMs
+            txPacketizationMs: ReflectorClient.txPacketizationMs
+            txFrameSizeMs: ReflectorClient.txFrameSizeMs
+            txHeaderSavingsBitsPerSecond: ReflectorClient.txHeaderSavingsBitsPerSecond
             tapToTalkButtonVisible: saved.tapToTalkButtonVisible
 
             onBackRequested: stackView.pop()
@@ -863,6 +965,7 @@ Window {
             onTxAudioLevelRequested: levelDb => window.updateTxAudioLevel(levelDb)
             onTxTimeoutSecondsRequested: seconds => window.updateTxTimeoutSeconds(seconds)
             onPttHangTimeMsRequested: milliseconds => window.updatePttHangTimeMs(milliseconds)
+            onTxPacketizationMsRequested: milliseconds => window.updateTxPacketizationMs(milliseconds)
             onTapToTalkButtonVisibleRequested: visible => window.updateTapToTalkButtonVisible(visible)
             onHardwarePttEnabledRequested: enabled => ReflectorClient.setHardwarePttEnabled(enabled)
             onLearnedHardwarePttKeyCodeRequested: keyCode => ReflectorClient.setLearnedHardwarePttKeyCode(keyCode)
@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2025 Silviu YO6SAY
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "OpusEncoderController.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// The reflector reports nothing about uplink loss; the downlink loss
+// feeding this stands in for it.  Keep a floor so an idle or clean
+// downlink does not switch LBRR off.
+constexpr int kMinFecLossPercent = 2;
+constexpr int kMaxFecLossPercent = 25;
+// Above this loss LBRR gets extra bits on unmetered links.
+constexpr int kFecHeadroomLossPercent = 5;
+constexpr int kFecHeadroomBitrate = 4000;
+// Narrowband under heavy loss, back to mediumband once it clears.
+constexpr double kNarrowLossFraction = 0.10;
+constexpr double kWidenLossFraction = 0.06;
+// SILK mediumband needs about this much to beat narrowband.
+constexpr int kMinMediumbandBitrate = 12000;
+
+constexpr int kCongestionStepBitrate = 2000;
+constexpr int kMaxCongestionSteps = 6;
+constexpr int kCleanIntervalsPerStep = 10;
+
+constexpr double kEncodeLoadWeight = 0.05;
+constexpr double kHighEncodeLoad = 0.25;
+constexpr double kLowEncodeLoad = 0.10;
+}
+
+bool OpusEncoderController::Settings::operator==(const Settings& other) const
+{
+    return bitrate == other.bitrate
+            && bandwidth == other.bandwidth
+            && complexity == other.complexity
+            && inbandFec == other.inbandFec
+            && expectedLossPercent == other.expectedLossPercent
+            && frameSizeMs == other.frameSizeMs;
+}
+
+void OpusEncoderController::setTransport(Transport transport, bool metered)
+{
+    m_transport = transport;
+    m_metered = metered;
+}
+
+void OpusEncoderController::setFecEnabled(bool enabled)
+{
+    m_fecEnabled = enabled;
+}
+
+void OpusEncoderController::setLossFraction(double lossFraction)
+{
+    m_lossFraction = std::clamp(lossFraction, 0.0, 1.0);
+}
+
+void OpusEncoderController::reportSendErrors(uint64_t totalErrors)
+{
+    if (totalErrors < m_lastErrors) {
+        m_lastErrors = totalErrors;  // A new sender started counting from zero
+    }
+    m_pendingErrors += totalErrors - m_lastErrors;
+    m_lastErrors = totalErrors;
+}
+
+void OpusEncoderController::reportEncodeTime(int encodeMicroseconds, int frameMicroseconds)
+{
+    if (frameMicroseconds <= 0) {
+        return;
+    }
+    const double load = static_cast<double>(std::max(encodeMicroseconds, 0)) / frameMicroseconds;
+    m_encodeLoad += (load - m_encodeLoad) * kEncodeLoadWeight;
+}
+
+void OpusEncoderController::setPacketization(int frameSizeMs)
+{
+    if (frameSizeMs <= 0) {
+        m_packetizationMs = 0;
+        return;
+    }
+    const int frames = (frameSizeMs + MIN_FRAME_SIZE_MS / 2) / MIN_FRAME_SIZE_MS;
+    m_packetizationMs = std::clamp(frames * MIN_FRAME_SIZE_MS, MIN_FRAME_SIZE_MS, MAX_FRAME_SIZE_MS);
+}
+
+void OpusEncoderController::setRoundTripMs(int roundTripMs)
+{
+    m_roundTripMs = roundTripMs >= 0 ? roundTripMs : -1;
+}
+
+int OpusEncoderController::overheadBytesPerSecond(int frameSizeMs)
+{
+    return frameSizeMs > 0 ? PACKET_OVERHEAD_BYTES * 1000 / frameSizeMs : 0;
+}
+
+int OpusEncoderController::baseBitrate() const
+{
+    if (m_metered) {
+        return METERED_BITRATE;
+    }
+    return m_transport == Transport::Cellular ? CELLULAR_BITRATE : DEFAULT_BITRATE;
+}
+
+int OpusEncoderController::frameSizeMs() const
+{
+    if (m_packetizationMs > 0) {
+        return m_packetizationMs;
+    }
+    // Another 20 or 40 ms of delay is lost in a long round trip, while the
+    // header and radio savings are what a metered or distant link needs.
+    if (m_metered || m_roundTripMs >= VERY_HIGH_RTT_MS) {
+        return MAX_FRAME_SIZE_MS;
+    }
+    if (m_roundTripMs >= HIGH_RTT_MS) {
+        return 2 * MIN_FRAME_SIZE_MS;
+    }
+    return MIN_FRAME_SIZE_MS;
+}
+
+bool OpusEncoderController::update()
+{
+    Settings next = m_settings;
+
+    if (m_pendingErrors > 0) {
+        m_congestionSteps = std::min(m_congestionSteps + 1, kMaxCongestionSteps);
+        m_cleanIntervals = 0;
+    } else if (m_congestionSteps > 0 && ++m_cleanIntervals >= kCleanIntervalsPerStep) {
+        --m_congestionSteps;
+        m_cleanIntervals = 0;
+    }
+    m_pendingErrors = 0;
+
+    next.inbandFec = m_fecEnabled;
+    next.expectedLossPercent = m_fecEnabled
+            ? std::clamp(static_cast<int>(std::lround(m_lossFraction * 100.0)),
+                         kMinFecLossPercent, kMaxFecLossPercent)
+            : 0;
+
+    int bitrate = baseBitrate();
+    if (m_fecEnabled && !m_metered && next.expectedLossPercent >= kFecHeadroomLossPercent) {
+        bitrate += kFecHeadroomBitrate;
+    }
+    bitrate -= m_congestionSteps * kCongestionStepBitrate;
+    next.bitrate = std::clamp(bitrate, MIN_BITRATE, MAX_BITRATE);
+
+    if (m_lossFraction >= kNarrowLossFraction) {
+        m_narrowedForLoss = true;
+    } else if (m_lossFraction < kWidenLossFraction) {
+        m_narrowedForLoss = false;
+    }
+    next.bandwidth = (m_narrowedForLoss || next.bitrate < kMinMediumbandBitrate)
+            ? Bandwidth::Narrowband
+            : Bandwidth::Mediumband;
+
+    next.frameSizeMs = frameSizeMs();
+
+    if (m_encodeLoad > kHighEncodeLoad) {
+        next.complexity = std::max(next.complexity - 2, MIN_COMPLEXITY);
+    } else if (m_encodeLoad < kLowEncodeLoad) {
+        next.complexity = std::min(next.complexity + 1, MAX_COMPLEXITY);
+    }
+
+    if (next == m_settings) {
+        return false;
+    }
+    m_settings = next;
+    return true;
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2025 Silviu YO6SAY
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef OPUSENCODERCONTROLLER_H
+#define OPUSENCODERCONTROLLER_H
+
+#include <cstdint>
+
+// Chooses the TX Opus settings between frames from the network the phone
+// is on and what the link has been doing, inside the envelope SvxLink peers
+// handle well: SILK narrowband or mediumband voice at 8-24 kbit/s VBR.
+//
+// - Transport sets the base bitrate: the SvxLink 20 kbit/s on Wi-Fi and
+//   Ethernet, 16 kbit/s on cellular, 12 kbit/s on any metered network.
+// - Loss sizes in-band FEC (when enabled), adds bitrate headroom for the
+//   LBRR copy on unmetered links and, when heavy, narrows the bandwidth so
+//   the bits go to redundancy instead of the top octave.
+// - Send errors (the socket buffer or uplink backing up) step the bitrate
+//   down; clean intervals step it back up slowly.
+// - Encode time lowers the complexity when a frame takes a large share of
+//   its own duration to encode, and raises it again once there is room.
+// - Packetization puts 40 or 60 ms in each datagram instead of 20 ms when
+//   asked to, or automatically on metered and high round-trip links, where
+//   the 36 bytes of SvxLink, UDP and IP headers per packet and the radio
+//   wake-ups cost more than the extra delay.
+//
+// Feed it from the audio thread and call update() every
+// UPDATE_INTERVAL_FRAMES frames; it allocates nothing.
+class OpusEncoderController
+{
+public:
+    // Same values as ReflectorClient::AndroidNetworkTransport.
+    enum class Transport {
+        Unknown = 0,
+        Wifi = 1,
+        Cellular = 2,
+        Ethernet = 3,
+        Other = 4
+    };
+
+    enum class Bandwidth {
+        Narrowband,
+        Mediumband
+    };
+
+    struct Settings {
+        int bitrate = DEFAULT_BITRATE;
+        Bandwidth bandwidth = Bandwidth::Mediumband;
+        int complexity = MAX_COMPLEXITY;
+        bool inbandFec = false;
+        int expectedLossPercent = 0;
+        int frameSizeMs = MIN_FRAME_SIZE_MS;
+
+        bool operator==(const Settings& other) const;
+        bool operator!=(const Settings& other) const { return !(*this == other); }
+    };
+
+    static constexpr int DEFAULT_BITRATE = 20000;
+    static constexpr int CELLULAR_BITRATE = 16000;
+    static constexpr int METERED_BITRATE = 12000;
+    static constexpr int MIN_BITRATE = 8000;
+    static constexpr int MAX_BITRATE = 24000;
+    static constexpr int MIN_COMPLEXITY = 4;
+    static constexpr int MAX_COMPLEXITY = 10;
+    // Counted in 20 ms frames whatever the packetization.
+    static constexpr int UPDATE_INTERVAL_FRAMES = 25;
+    static constexpr int MIN_FRAME_SIZE_MS = 20;
+    static constexpr int MAX_FRAME_SIZE_MS = 60;
+    // Automatic packetization thresholds on the TCP round-trip time
+    static constexpr int HIGH_RTT_MS = 150;
+    static constexpr int VERY_HIGH_RTT_MS = 300;
+    // SvxLink audio header plus IPv4 and UDP headers
+    static constexpr int PACKET_OVERHEAD_BYTES = 36;
+
+    void setTransport(Transport transport, bool metered);
+    void setFecEnabled(bool enabled);
+    // Smoothed fraction of packets lost, 0..1.
+    void setLossFraction(double lossFraction);
+    // Running total, e.g. UdpAudioSender::sendErrors().
+    void reportSendErrors(uint64_t totalErrors);
+    void reportEncodeTime(int encodeMicroseconds, int frameMicroseconds);
+    // 20, 40 or 60 ms per packet, or 0 to choose from the link.  Other
+    // values round to the nearest of those.
+    void setPacketization(int frameSizeMs);
+    int packetization() const { return m_packetizationMs; }
+    // Smoothed round-trip time to the reflector, -1 when unknown.
+    void setRoundTripMs(int roundTripMs);
+
+    // Header bytes per second of audio at this frame size.
+    static int overheadBytesPerSecond(int frameSizeMs);
+
+    // Re-derives the settings; true when they changed.
+    bool update();
+    const Settings& settings() const { return m_settings; }
+
+    Transport transport() const { return m_transport; }
+    bool metered() const { return m_metered; }
+
+private:
+    int baseBitrate() const;
+    int frameSizeMs() const;
+
+    Settings m_settings;
+    Transport m_transport = Transport::Unknown;
+    bool m_metered = false;
+    bool m_fecEnabled = false;
+    double m_lossFraction = 0.0;
+    int m_packetizationMs = 0;
+    int m_roundTripMs = -1;
+
+    uint64_t m_lastErrors = 0;
+    uint64_t m_pendingErrors = 0;
+    int m_congestionSteps = 0;
+    int m_cleanIntervals = 0;
+
+    // Share of the frame spent encoding, smoothed over frames.
+    double m_encodeLoad = 0.0;
+    bool m_narrowedForLoss = false;
+};
+
+#endif // OPUSENCODERCONTROLLER_H
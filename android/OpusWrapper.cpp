@@ -69,6 +69,35 @@ void OpusEncoder::applySvxlinkDefaults()
 #endif
 }
 
+void OpusEncoder::setInbandFec(bool enabled, int expectedLossPercent)
+{
+    if (!m_encoder) return;
+
+    opus_encoder_ctl(m_encoder, OPUS_SET_INBAND_FEC(enabled ? 1 : 0));
+    opus_encoder_ctl(m_encoder, OPUS_SET_PACKET_LOSS_PERC(enabled ? expectedLossPercent : 0));
+}
+
+void OpusEncoder::setBitrate(opus_int32 bitsPerSecond)
+{
+    if (!m_encoder) return;
+
+    opus_encoder_ctl(m_encoder, OPUS_SET_BITRATE(bitsPerSecond));
+}
+
+void OpusEncoder::setMaxBandwidth(int opusBandwidth)
+{
+    if (!m_encoder) return;
+
+    opus_encoder_ctl(m_encoder, OPUS_SET_MAX_BANDWIDTH(opusBandwidth));
+}
+
+void OpusEncoder::setComplexity(int complexity)
+{
+    if (!m_encoder) return;
+
+    opus_encoder_ctl(m_encoder, OPUS_SET_COMPLEXITY(complexity));
+}
+
 // -----------------------------------------------------------------------------
 // OpusDecoder  – FIXED (scaling removed)
 // -----------------------------------------------------------------------------
@@ -92,12 +121,47 @@ OpusDecoder::~OpusDecoder()
 int OpusDecoder::decode(const unsigned char* data,
                         int                  len,
                         float*               pcm,
-                        int                  frame_size)
+                        int                  frame_size,
+                        bool                 decode_fec)
 {
     if (!m_decoder)
         return -1;
 
     /* opus_decode_float() already returns samples in [-1, +1]  */
     return opus_decode_float(m_decoder, data, len,
-                             pcm, frame_size, 0);
+                             pcm, frame_size, decode_fec ? 1 : 0);
+}
+
+int OpusDecoder::packetSamples(const unsigned char* data, int len) const
+{
+    if (!m_decoder)
+        return -1;
+
+    return opus_decoder_get_nb_samples(m_decoder, data, len);
+}
+
+bool OpusDecoder::packetHasLbrr(const unsigned char* data, int len)
+{
+    if (data == nullptr || len <= 0)
+        return false;
+
+    /* Configs 16..31 are CELT-only and never carry LBRR.  Otherwise the
+       first Opus frame opens with one equiprobable VAD bit per 20 ms SILK
+       frame, then the LBRR flag (per channel), so the flags sit in the top
+       bits of its first byte.  Same test as opus_packet_has_lbrr() in 1.5. */
+    if ((data[0] >> 3) >= 16)
+        return false;
+
+    const int samplesPerFrame = opus_packet_get_samples_per_frame(data, 48000);
+    const int silkFrames = samplesPerFrame > 960 ? samplesPerFrame / 960 : 1;
+
+    const unsigned char* frames[48];
+    opus_int16 sizes[48];
+    if (opus_packet_parse(data, len, nullptr, frames, sizes, nullptr) <= 0 || sizes[0] == 0)
+        return false;
+
+    bool lbrr = (frames[0][0] >> (7 - silkFrames)) & 0x1;
+    if (opus_packet_get_nb_channels(data) == 2)
+        lbrr = lbrr || ((frames[0][0] >> (6 - 2 * silkFrames)) & 0x1);
+    return lbrr;
 }
@@ -21,6 +21,15 @@
 #include <opus.h>
 #include <vector>
 
+// Rates libopus encodes and decodes at itself.  The bitstream does not
+// depend on them, so a device running at one of these needs no Resampler
+// in front of the codec.
+inline bool isOpusSampleRate(int sampleRate)
+{
+    return sampleRate == 8000 || sampleRate == 12000 || sampleRate == 16000
+            || sampleRate == 24000 || sampleRate == 48000;
+}
+
 class OpusEncoder {
 public:
     OpusEncoder(opus_int32 sample_rate, int channels, int application);
@@ -31,6 +40,12 @@ public:
     int encode(const float* pcm, int frame_size, unsigned char* output, int max_output_bytes);
 
     void applySvxlinkDefaults();
+    // In-band FEC (SILK LBRR) sized for the expected loss; off by default.
+    void setInbandFec(bool enabled, int expectedLossPercent);
+    // Safe between frames; OpusEncoderController drives these.
+    void setBitrate(opus_int32 bitsPerSecond);
+    void setMaxBandwidth(int opusBandwidth);
+    void setComplexity(int complexity);
 
 private:
     friend class AudioEngineTest;
@@ -44,7 +59,18 @@ public:
     OpusDecoder(const OpusDecoder&) = delete;
     OpusDecoder& operator=(const OpusDecoder&) = delete;
 
-    int decode(const unsigned char* data, int len, float* pcm, int frame_size);
+    // With decode_fec set, data is the packet *after* a lost one and the
+    // lost frame is rebuilt from its LBRR data (PLC when it carries none).
+    int decode(const unsigned char* data, int len, float* pcm, int frame_size,
+               bool decode_fec = false);
+
+    // Samples per channel the packet decodes to at this decoder's rate, or
+    // a negative Opus error code; lets callers size the output up front.
+    int packetSamples(const unsigned char* data, int len) const;
+
+    // Whether the packet carries SILK LBRR data for the frame before it.
+    // Without it a decode_fec call only yields PLC, so callers check first.
+    static bool packetHasLbrr(const unsigned char* data, int len);
 
 private:
     ::OpusDecoder* m_decoder = nullptr;
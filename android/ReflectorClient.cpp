@@ -52,6 +52,8 @@ constexpr qreal kMinRxAudioLevelDb = 0.0;
 constexpr qreal kMaxRxAudioLevelDb = 9.0;
 constexpr qreal kMinTxAudioLevelDb = -12.0;
 constexpr qreal kMaxTxAudioLevelDb = 12.0;
+constexpr qreal kMinJitterBufferUnderrunProbability = 0.001;
+constexpr qreal kMaxJitterBufferUnderrunProbability = 0.25;
 constexpr int kDefaultTgSelectTimeoutSeconds = 30;
 constexpr int kMinTgSelectTimeoutSeconds = 1;
 constexpr bool kDefaultTxTimeoutEnabled = true;
@@ -117,6 +119,12 @@ qreal normalizeTxAudioLevelDb(qreal levelDb)
     return std::clamp(levelDb, kMinTxAudioLevelDb, kMaxTxAudioLevelDb);
 }
 
+qreal normalizeJitterBufferUnderrunProbability(qreal probability)
+{
+    return std::clamp(probability, kMinJitterBufferUnderrunProbability,
+                      kMaxJitterBufferUnderrunProbability);
+}
+
 qreal normalizeMeterLevel(qreal level)
 {
     return std::clamp(level, 0.0, 1.0);
@@ -319,57 +327,45 @@ ReflectorClient::ReflectorClient(QObject *parent) : QObject{parent},
     m_txStopPending(false),
     m_audioReady(false),
     m_port(0),
-    m_talkgroup(0),
-    m_defaultTalkgroup(0),
-    m_clientId(0),
-    m_udpSequence(0),
     m_txSeconds(0),
-    m_lastAudioSeq(0),
     m_currentTalker(""),
     m_currentTalkerName(""),
     m_isReceivingAudio(false)
 {
     m_tcpSocket = new QTcpSocket(this);
     m_udpSocket = new QUdpSocket(this);
-    m_heartbeatTimer = new QTimer(this);
+    m_udpReceiveBuffer.resize(2048);
+    m_udpAudioSender = std::make_unique<UdpAudioSender>(m_session.udpSequence());
+    m_sessionClock.start();
+    m_sessionTimer = new QTimer(this);
+    m_sessionTimer->setSingleShot(true);
     m_txTimer = new QTimer(this);
     m_pttHangTimer = new QTimer(this);
     m_connectTimer = new QTimer(this);
     m_reconnectTimer = new QTimer(this);
-    m_protocolLivenessTimer = new QTimer(this);
     m_pttHangTimer->setSingleShot(true);
     m_connectTimer->setSingleShot(true);
     m_reconnectTimer->setSingleShot(true);
-    m_protocolLivenessTimer->setSingleShot(true);
     m_audioTimeoutTimer = new QTimer(this);
     m_audioTimeoutTimer->setSingleShot(true);
     m_audioTimeoutTimer->setInterval(3000); // 3 second timeout
     m_transcriptionSupportRefreshTimer = new QTimer(this);
     m_transcriptionSupportRefreshTimer->setSingleShot(false);
     m_transcriptionSupportRefreshTimer->setInterval(kTranscriptionSupportRefreshIntervalMs);
-    m_talkgroupSelectionTimer = new QTimer(this);
-    m_talkgroupSelectionTimer->setInterval(1000);
     m_networkManager = new QNetworkAccessManager(this);
 
     connect(m_tcpSocket, &QTcpSocket::connected, this, &ReflectorClient::onTcpConnected);
     connect(m_tcpSocket, &QTcpSocket::disconnected, this, &ReflectorClient::onTcpDisconnected);
     connect(m_tcpSocket, &QTcpSocket::readyRead, this, &ReflectorClient::onTcpReadyRead);
     connect(m_udpSocket, &QUdpSocket::readyRead, this, &ReflectorClient::onUdpReadyRead);
-    connect(m_heartbeatTimer, &QTimer::timeout, this, &ReflectorClient::onHeartbeatTimer);
+    connect(m_sessionTimer, &QTimer::timeout, this, &ReflectorClient::onSessionTimer);
     connect(m_txTimer, &QTimer::timeout, this, &ReflectorClient::onTxTimerTimeout);
     connect(m_pttHangTimer, &QTimer::timeout, this, &ReflectorClient::onPttHangTimerTimeout);
     connect(m_connectTimer, &QTimer::timeout, this, &ReflectorClient::onConnectTimeout);
     connect(m_reconnectTimer, &QTimer::timeout, this, &ReflectorClient::onReconnectBackoffTimeout);
-    connect(m_protocolLivenessTimer, &QTimer::timeout, this, &ReflectorClient::onProtocolLivenessTimeout);
-    connect(m_talkgroupSelectionTimer, &QTimer::timeout, this, &ReflectorClient::onTalkgroupSelectionTimer);
     connect(m_transcriptionSupportRefreshTimer, &QTimer::timeout,
             this, &ReflectorClient::refreshTranscriptionSupportState);
-    connect(m_audioTimeoutTimer, &QTimer::timeout, this, [this]() {
-        if (m_isReceivingAudio) {
-            qDebug() << "Audio timeout - stopping receive indicator";
-            setReceivingAudioState(false);
-        }
-    });
+    connect(m_audioTimeoutTimer, &QTimer::timeout, this, &ReflectorClient::onUdpAudioTimeout);
     connect(m_tcpSocket, &QTcpSocket::errorOccurred, this, &ReflectorClient::onTcpError);
     m_txTimer->setInterval(1000);
     m_txTimeoutEnabled = kDefaultTxTimeoutEnabled;
@@ -465,6 +461,9 @@ ReflectorClient::ReflectorClient(QObject *parent) : QObject{parent},
 
 ReflectorClient::~ReflectorClient()
 {
+    if (m_udpReceiveThread) {
+        m_udpReceiveThread->stop();
+    }
     if (!m_shutdownComplete) {
         // Fallback: prepareForShutdown() was not called (abnormal shutdown path).
         // This runs during static destruction / dlclose where the Qt event loop
@@ -488,6 +487,10 @@ void ReflectorClient::prepareForShutdown()
 
     qInfo() << "ReflectorClient::prepareForShutdown - cleaning up while event loop is alive";
 
+    // Its audio handler calls into the engine, which goes away with the audio thread.
+    stopUdpReceiveThread();
+    closeUdpAudioSender();
+
 #if defined(Q_OS_ANDROID)
     // Mark transcription inactive without the BlockingQueuedConnection to the
     // audio thread — the thread is about to be terminated, so synchronously
@@ -499,8 +502,8 @@ void ReflectorClient::prepareForShutdown()
 #endif
 
     // Stop all timers to prevent new work from being scheduled.
-    if (m_heartbeatTimer)
-        m_heartbeatTimer->stop();
+    if (m_sessionTimer)
+        m_sessionTimer->stop();
     if (m_txTimer) {
         m_txTimer->stop();
         m_txTimeoutWarningFeedbackSent = false;
@@ -512,12 +515,8 @@ void ReflectorClient::prepareForShutdown()
         m_connectTimer->stop();
     if (m_reconnectTimer)
         m_reconnectTimer->stop();
-    if (m_protocolLivenessTimer)
-        m_protocolLivenessTimer->stop();
     if (m_audioTimeoutTimer)
         m_audioTimeoutTimer->stop();
-    if (m_talkgroupSelectionTimer)
-        m_talkgroupSelectionTimer->stop();
     if (m_transcriptionSupportRefreshTimer)
         m_transcriptionSupportRefreshTimer->stop();
 
@@ -559,8 +558,9 @@ QString ReflectorClient::currentTalker() const { return m_currentTalker; }
 QVariantList ReflectorClient::monitoredTalkgroupsModel() const
 {
     QVariantList talkgroups;
-    talkgroups.reserve(m_monitoredTalkgroups.size());
-    for (quint32 talkgroup : m_monitoredTalkgroups) {
+    const std::vector<uint32_t> &monitored = m_session.monitoredTalkgroups();
+    talkgroups.reserve(int(monitored.size()));
+    for (quint32 talkgroup : monitored) {
         talkgroups.append(talkgroup);
     }
     return talkgroups;
@@ -646,24 +646,21 @@ void ReflectorClient::onTxTimerTimeout()
 
 void ReflectorClient::selectTalkgroup(quint32 talkgroup)
 {
-    selectTalkgroupInternal(talkgroup, TalkgroupSelectionOrigin::Manual);
+    m_session.selectTalkgroup(talkgroup, ReflectorSession::TalkgroupSelectionOrigin::Manual, sessionNowMs());
+    drainSession();
 }
 
 void ReflectorClient::updateProfileConfiguration(quint32 defaultTalkgroup,
                                                  const QString &monitoredTalkgroups,
                                                  int tgSelectTimeoutSeconds)
 {
-    m_defaultTalkgroup = defaultTalkgroup;
     m_tgSelectTimeoutSeconds = normalizeTgSelectTimeoutSeconds(tgSelectTimeoutSeconds);
-    applyMonitoredTalkgroups(monitoredTalkgroups);
+    m_session.setTalkgroupSelectTimeoutSeconds(m_tgSelectTimeoutSeconds);
+    // Sends TG_MONITOR and restarts the selection countdown when connected.
+    applyMonitoredTalkgroups(defaultTalkgroup, monitoredTalkgroups);
+    drainSession();
 
     if (m_state == Connected) {
-        sendTgMonitor(m_monitoredTalkgroups);
-        if (m_talkgroup > 0) {
-            resetTalkgroupSelectionTimer();
-        } else {
-            stopTalkgroupSelectionTimer();
-        }
         refreshConnectionStatus();
 #if defined(Q_OS_ANDROID)
         saveConnectionState();
@@ -733,10 +730,7 @@ void ReflectorClient::setCustomNodeInfoEntries(const QVariantList &entries)
     }
 
     m_customNodeInfoJson = sanitizedEntries;
-
-    if (m_state == Connected) {
-        sendNodeInfo();
-    }
+    updateSessionNodeInfo();
 }
 
 void ReflectorClient::setPreferredAudioRoute(const QString &routeId)
@@ -793,6 +787,153 @@ void ReflectorClient::setTxAudioLevelDb(qreal levelDb)
     applyAudioLevelsToEngine();
 }
 
+void ReflectorClient::setAdaptiveJitterBufferEnabled(bool enabled)
+{
+    if (m_adaptiveJitterBufferEnabled != enabled) {
+        m_adaptiveJitterBufferEnabled = enabled;
+        emit jitterBufferSettingsChanged();
+    }
+
+    applyJitterBufferSettingsToEngine();
+}
+
+void ReflectorClient::setJitterBufferUnderrunProbability(qreal probability)
+{
+    const qreal normalizedProbability = normalizeJitterBufferUnderrunProbability(probability);
+    if (m_jitterBufferUnderrunProbability != normalizedProbability) {
+        m_jitterBufferUnderrunProbability = normalizedProbability;
+        emit jitterBufferSettingsChanged();
+    }
+
+    applyJitterBufferSettingsToEngine();
+}
+
+void ReflectorClient::setTxFecEnabled(bool enabled)
+{
+    if (m_txFecEnabled != enabled) {
+        m_txFecEnabled = enabled;
+        emit txFecEnabledChanged();
+    }
+
+    if (m_audioEngine) {
+        QMetaObject::invokeMethod(m_audioEngine, "setTxFecEnabled",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(bool, m_txFecEnabled));
+    }
+}
+
+void ReflectorClient::setTxDtxEnabled(bool enabled)
+{
+    if (m_txDtxEnabled != enabled) {
+        m_txDtxEnabled = enabled;
+        emit txDtxEnabledChanged();
+    }
+
+    if (m_audioEngine) {
+        QMetaObject::invokeMethod(m_audioEngine, "setTxDtxEnabled",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(bool, m_txDtxEnabled));
+    }
+}
+
+void ReflectorClient::setTxAgcEnabled(bool enabled)
+{
+    if (m_txAgcEnabled != enabled) {
+        m_txAgcEnabled = enabled;
+        emit txAgcEnabledChanged();
+    }
+
+    if (m_audioEngine) {
+        QMetaObject::invokeMethod(m_audioEngine, "setTxAgcEnabled",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(bool, m_txAgcEnabled));
+    }
+}
+
+void ReflectorClient::setTxLookAheadMs(int milliseconds)
+{
+    const int normalizedMilliseconds = std::clamp(milliseconds, 0, AudioEngine::FRAME_SIZE_MS);
+    if (m_txLookAheadMs != normalizedMilliseconds) {
+        m_txLookAheadMs = normalizedMilliseconds;
+        emit txLookAheadMsChanged();
+    }
+
+    if (m_audioEngine) {
+        QMetaObject::invokeMethod(m_audioEngine, "setTxLookAheadMs",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(int, m_txLookAheadMs));
+    }
+}
+
+void ReflectorClient::setTxMaxBacklogMs(int milliseconds)
+{
+    const int normalizedMilliseconds = std::clamp(milliseconds, AudioEngine::MIN_TX_BACKLOG_MS,
+                                                  AudioEngine::MAX_TX_BACKLOG_MS);
+    if (m_txMaxBacklogMs != normalizedMilliseconds) {
+        m_txMaxBacklogMs = normalizedMilliseconds;
+        emit txMaxBacklogMsChanged();
+    }
+
+    if (m_audioEngine) {
+        QMetaObject::invokeMethod(m_audioEngine, "setTxMaxBacklogMs",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(int, m_txMaxBacklogMs));
+    }
+}
+
+int ReflectorClient::txHeaderSavingsBitsPerSecond() const
+{
+    return 8 * (OpusEncoderController::overheadBytesPerSecond(AudioEngine::FRAME_SIZE_MS)
+                - OpusEncoderController::overheadBytesPerSecond(m_txFrameSizeMs));
+}
+
+void ReflectorClient::setTxPacketizationMs(int milliseconds)
+{
+    const int normalizedMilliseconds = milliseconds <= 0
+            ? 0
+            : std::clamp((milliseconds + AudioEngine::FRAME_SIZE_MS / 2) / AudioEngine::FRAME_SIZE_MS,
+                         1, 3) * AudioEngine::FRAME_SIZE_MS;
+    if (m_txPacketizationMs != normalizedMilliseconds) {
+        m_txPacketizationMs = normalizedMilliseconds;
+        emit txPacketizationMsChanged();
+    }
+
+    if (m_audioEngine) {
+        QMetaObject::invokeMethod(m_audioEngine, "setTxPacketizationMs",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(int, m_txPacketizationMs));
+    }
+}
+
+void ReflectorClient::setTxEncodeThreadEnabled(bool enabled)
+{
+    if (m_txEncodeThreadEnabled != enabled) {
+        m_txEncodeThreadEnabled = enabled;
+        emit txEncodeThreadEnabledChanged();
+    }
+
+    if (m_audioEngine) {
+        QMetaObject::invokeMethod(m_audioEngine, "setTxEncodeThreadEnabled",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(bool, m_txEncodeThreadEnabled));
+    }
+}
+
+void ReflectorClient::setUdpReceiveThreadEnabled(bool enabled)
+{
+    if (m_udpReceiveThreadEnabled == enabled) {
+        return;
+    }
+    m_udpReceiveThreadEnabled = enabled;
+    emit udpReceiveThreadEnabledChanged();
+
+    if (enabled) {
+        startUdpReceiveThread();
+    } else {
+        stopUdpReceiveThread();
+    }
+}
+
 void ReflectorClient::setTxTimeoutSeconds(int seconds)
 {
     const int normalizedSeconds = normalizeTxTimeoutSeconds(seconds);
@@ -1198,24 +1339,30 @@ void ReflectorClient::refreshConnectionStatus()
         return;
     }
 
-    m_connectionStatus = (m_talkgroup == 0)
+    const quint32 talkgroup = m_session.selectedTalkgroup();
+    m_connectionStatus = (talkgroup == 0)
             ? QStringLiteral("Connected in monitor mode")
-            : QStringLiteral("Connected to TG %1").arg(m_talkgroup);
+            : QStringLiteral("Connected to TG %1").arg(talkgroup);
     emit connectionStatusChanged();
 #if defined(Q_OS_ANDROID)
-    updateServiceSelectedTalkgroup(m_talkgroup);
+    updateServiceSelectedTalkgroup(talkgroup);
     updateServiceConnectionStatus(m_connectionStatus, true);
 #endif
 }
 
 void ReflectorClient::refreshMonitoredTalkgroupsModel()
 {
-    emit monitoredTalkgroupsChanged(m_monitoredTalkgroups);
+    const std::vector<uint32_t> &monitored = m_session.monitoredTalkgroups();
+    emit monitoredTalkgroupsChanged(QList<quint32>(monitored.cbegin(), monitored.cend()));
     emit monitoredTalkgroupsModelChanged();
 }
 
 void ReflectorClient::setReceivingAudioState(bool receiving)
 {
+    if (!receiving) {
+        // The next audio packet starts a new stream.
+        m_udpAudioActive.store(false, std::memory_order_release);
+    }
     if (m_isReceivingAudio == receiving) {
 #if defined(Q_OS_ANDROID)
         if (!receiving) {
@@ -1626,6 +1773,30 @@ void ReflectorClient::applyAudioLevelsToEngine()
                               Q_ARG(float, static_cast<float>(m_txAudioLevelDb)));
 }
 
+void ReflectorClient::applyJitterBufferSettingsToEngine()
+{
+    if (!m_audioEngine) {
+        return;
+    }
+
+    QMetaObject::invokeMethod(m_audioEngine, "setJitterBufferUnderrunProbability",
+                              Qt::QueuedConnection,
+                              Q_ARG(float, static_cast<float>(m_jitterBufferUnderrunProbability)));
+    QMetaObject::invokeMethod(m_audioEngine, "setAdaptiveJitterBufferEnabled",
+                              Qt::QueuedConnection,
+                              Q_ARG(bool, m_adaptiveJitterBufferEnabled));
+}
+
+void ReflectorClient::setJitterBufferStats(int targetMs, qreal jitterMs)
+{
+    if (m_jitterBufferTargetMs == targetMs && qFuzzyCompare(m_rxJitterMs + 1.0, jitterMs + 1.0)) {
+        return;
+    }
+    m_jitterBufferTargetMs = targetMs;
+    m_rxJitterMs = jitterMs;
+    emit jitterBufferStatsChanged();
+}
+
 void ReflectorClient::setRxMeterState(qreal level, qreal peakLevel)
 {
     const qreal normalizedLevel = normalizeMeterLevel(level);
@@ -1662,124 +1833,16 @@ void ReflectorClient::resetAudioMeters()
     setTxMeterState(0.0, 0.0);
 }
 
-void ReflectorClient::resetTalkgroupSelectionTimer()
-{
-    if (m_talkgroup == 0) {
-        stopTalkgroupSelectionTimer();
-        return;
-    }
-
-    m_tgSelectTimeoutCounter = m_tgSelectTimeoutSeconds;
-    if (m_state == Connected && !m_talkgroupSelectionTimer->isActive()) {
-        m_talkgroupSelectionTimer->start();
-    }
-}
-
-void ReflectorClient::stopTalkgroupSelectionTimer()
-{
-    m_tgSelectTimeoutCounter = 0;
-    if (m_talkgroupSelectionTimer->isActive()) {
-        m_talkgroupSelectionTimer->stop();
-    }
-}
-
 void ReflectorClient::clearMonitoredTalkgroups()
 {
-    if (!m_monitoredTalkgroups.isEmpty()) {
-        m_monitoredTalkgroups.clear();
+    if (!m_session.monitoredTalkgroups().empty()) {
+        m_session.clearMonitoredTalkgroups();
         refreshMonitoredTalkgroupsModel();
     }
 }
 
-quint8 ReflectorClient::monitoredTalkgroupPriority(quint32 talkgroup) const
-{
-    for (const MonitoredTalkgroupEntry &entry : m_configuredMonitoredTalkgroups) {
-        if (entry.talkgroup == talkgroup) {
-            return entry.priority;
-        }
-    }
-    return 0;
-}
-
-bool ReflectorClient::isTalkgroupMonitored(quint32 talkgroup) const
-{
-    return m_monitoredTalkgroups.contains(talkgroup);
-}
-
-bool ReflectorClient::shouldHandleTalkerStart(quint32 talkgroup)
-{
-    if (talkgroup == 0) {
-        qWarning() << "Ignoring TALKER_START on TG 0 because TG 0 is only the local monitor parking state";
-        return false;
-    }
-
-    if (talkgroup == m_talkgroup) {
-        if (m_talkgroup > 0) {
-            resetTalkgroupSelectionTimer();
-        }
-        return true;
-    }
-
-    if (!isTalkgroupMonitored(talkgroup)) {
-        return false;
-    }
-
-    if (m_talkgroup == 0) {
-        selectTalkgroupInternal(talkgroup, TalkgroupSelectionOrigin::RemoteActivation);
-        return true;
-    }
-
-    if (!m_usePriorityMode) {
-        return false;
-    }
-
-    const quint8 incomingPriority = monitoredTalkgroupPriority(talkgroup);
-    const quint8 selectedPriority = monitoredTalkgroupPriority(m_talkgroup);
-    if (incomingPriority > selectedPriority) {
-        selectTalkgroupInternal(talkgroup, TalkgroupSelectionOrigin::RemotePriorityActivation);
-        return true;
-    }
-
-    return false;
-}
-
-bool ReflectorClient::selectTalkgroupInternal(quint32 talkgroup, TalkgroupSelectionOrigin origin)
-{
-    const bool talkgroupChanged = (m_talkgroup != talkgroup);
-    const bool manualSelection = (origin == TalkgroupSelectionOrigin::Manual
-                                  || origin == TalkgroupSelectionOrigin::TxDefaultActivation);
-
-    if (talkgroupChanged) {
-        m_talkgroup = talkgroup;
-        emit selectedTalkgroupChanged();
-    }
-
-    if (talkgroup == 0) {
-        m_usePriorityMode = true;
-        stopTalkgroupSelectionTimer();
-    } else {
-        if (manualSelection) {
-            m_usePriorityMode = false;
-        }
-        resetTalkgroupSelectionTimer();
-    }
-
-    if (m_state != Connected) {
-        qInfo() << "Stored talkgroup for next connection:" << m_talkgroup;
-        return talkgroupChanged;
-    }
-
-    if (talkgroupChanged) {
-        qInfo() << "Selecting talkgroup:" << m_talkgroup;
-        sendSelectTG(m_talkgroup);
-    }
-
-    refreshConnectionStatus();
-    return talkgroupChanged;
-}
-
 ReflectorClient::ParsedMonitoredTalkgroups ReflectorClient::parseMonitoredTalkgroupsSpec(
-        const QString &monitoredTalkgroups, quint32 primaryTalkgroup)
+        const QString &monitoredTalkgroups)
 {
     ParsedMonitoredTalkgroups parsed;
     QSet<quint32> seenConfigured;
@@ -1815,54 +1878,24 @@ ReflectorClient::ParsedMonitoredTalkgroups ReflectorClient::parseMonitoredTalkgr
     }
 
     parsed.normalizedSpec = normalizedEntries.join(QLatin1Char(','));
-
-    QSet<quint32> seenActive;
-    if (primaryTalkgroup > 0) {
-        parsed.activeTalkgroups.append(primaryTalkgroup);
-        seenActive.insert(primaryTalkgroup);
-    }
-
-    for (const MonitoredTalkgroupEntry &entry : parsed.configured) {
-        if (!seenActive.contains(entry.talkgroup)) {
-            parsed.activeTalkgroups.append(entry.talkgroup);
-            seenActive.insert(entry.talkgroup);
-        }
-    }
-
     return parsed;
 }
 
-void ReflectorClient::applyMonitoredTalkgroups(const QString &monitoredTalkgroups)
+void ReflectorClient::applyMonitoredTalkgroups(quint32 defaultTalkgroup, const QString &monitoredTalkgroups)
 {
-    const ParsedMonitoredTalkgroups parsed = parseMonitoredTalkgroupsSpec(monitoredTalkgroups, m_defaultTalkgroup);
+    const ParsedMonitoredTalkgroups parsed = parseMonitoredTalkgroupsSpec(monitoredTalkgroups);
     m_monitoredTalkgroupsSpec = parsed.normalizedSpec;
-    m_configuredMonitoredTalkgroups = parsed.configured;
 
-    if (m_monitoredTalkgroups != parsed.activeTalkgroups) {
-        m_monitoredTalkgroups = parsed.activeTalkgroups;
+    const std::vector<uint32_t> previous = m_session.monitoredTalkgroups();
+    m_session.setMonitoredTalkgroups(defaultTalkgroup,
+                                     std::vector<MonitoredTalkgroupEntry>(parsed.configured.cbegin(),
+                                                                          parsed.configured.cend()),
+                                     sessionNowMs());
+    if (m_session.monitoredTalkgroups() != previous) {
         refreshMonitoredTalkgroupsModel();
     }
 }
 
-void ReflectorClient::onTalkgroupSelectionTimer()
-{
-    if (m_state != Connected || m_talkgroup == 0 || m_tgSelectTimeoutCounter <= 0) {
-        if (m_tgSelectTimeoutCounter <= 0) {
-            stopTalkgroupSelectionTimer();
-        }
-        return;
-    }
-
-    if (m_pttActive || m_isReceivingAudio) {
-        return;
-    }
-
-    --m_tgSelectTimeoutCounter;
-    if (m_tgSelectTimeoutCounter == 0) {
-        selectTalkgroupInternal(0, TalkgroupSelectionOrigin::Timeout);
-    }
-}
-
 // --- Audio Engine Management ---
 
 void ReflectorClient::setupAudio()
@@ -1881,6 +1914,7 @@ void ReflectorClient::initializeAudioEngine()
 
     // Create audio engine and move to audio thread
     m_audioEngine = new AudioEngine();
+    m_audioEngine->setUdpAudioSender(m_udpAudioSender.get());
     m_audioEngine->moveToThread(m_audioThread);
 
     // Connect signals from AudioEngine to ReflectorClient
@@ -1905,6 +1939,24 @@ void ReflectorClient::initializeAudioEngine()
             [this](float level, float peakLevel) {
                 setTxMeterState(level, peakLevel);
             });
+    connect(m_audioEngine, &AudioEngine::jitterBufferStatsChanged, this,
+            [this](int targetMs, float jitterMs) {
+                setJitterBufferStats(targetMs, jitterMs);
+            });
+    connect(m_audioEngine, &AudioEngine::txProcessingLatencyChanged, this,
+            [this](int latencyMs) {
+                if (m_txProcessingLatencyMs != latencyMs) {
+                    m_txProcessingLatencyMs = latencyMs;
+                    emit txProcessingLatencyMsChanged();
+                }
+            });
+    connect(m_audioEngine, &AudioEngine::txFrameSizeChanged, this,
+            [this](int frameSizeMs) {
+                if (m_txFrameSizeMs != frameSizeMs) {
+                    m_txFrameSizeMs = frameSizeMs;
+                    emit txFrameSizeMsChanged();
+                }
+            });
 
     // Connect Android audio focus signals
     connect(this, &ReflectorClient::audioFocusLost, m_audioEngine, &AudioEngine::onAudioFocusLost);
@@ -1914,6 +1966,14 @@ void ReflectorClient::initializeAudioEngine()
     connect(this, &ReflectorClient::activityResumed, m_audioEngine, &AudioEngine::onActivityResumed);
 
     applyAudioLevelsToEngine();
+    applyJitterBufferSettingsToEngine();
+    setTxFecEnabled(m_txFecEnabled);
+    setTxDtxEnabled(m_txDtxEnabled);
+    setTxAgcEnabled(m_txAgcEnabled);
+    setTxLookAheadMs(m_txLookAheadMs);
+    setTxPacketizationMs(m_txPacketizationMs);
+    setTxMaxBacklogMs(m_txMaxBacklogMs);
+    setTxEncodeThreadEnabled(m_txEncodeThreadEnabled);
 }
 
 #if defined(Q_OS_ANDROID)
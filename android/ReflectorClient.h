@@ -24,9 +24,14 @@
 #include <QTimer>
 #include <QThread>
 #include <QAbstractSocket>
+#include <QHostAddress>
 #include <QVariantList>
 #include <QElapsedTimer>
 #include "AudioEngine.h"
+#include "UdpAudioSender.h"
+#include "UdpReceiveThread.h"
+#include "ReflectorSession.h"
+#include <atomic>
 #include <memory>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
@@ -36,8 +41,6 @@
 #include <QJniObject>
 #endif
 
-class QDataStream; // Forward declaration
-
 class ReflectorClient : public QObject
 {
     Q_OBJECT
@@ -71,6 +74,32 @@ class ReflectorClient : public QObject
     Q_PROPERTY(qreal rxMeterPeakLevel READ rxMeterPeakLevel NOTIFY rxMeterPeakLevelChanged)
     Q_PROPERTY(qreal txMeterLevel READ txMeterLevel NOTIFY txMeterLevelChanged)
     Q_PROPERTY(qreal txMeterPeakLevel READ txMeterPeakLevel NOTIFY txMeterPeakLevelChanged)
+    Q_PROPERTY(bool adaptiveJitterBufferEnabled READ adaptiveJitterBufferEnabled
+               NOTIFY jitterBufferSettingsChanged)
+    Q_PROPERTY(qreal jitterBufferUnderrunProbability READ jitterBufferUnderrunProbability
+               NOTIFY jitterBufferSettingsChanged)
+    Q_PROPERTY(bool txFecEnabled READ txFecEnabled NOTIFY txFecEnabledChanged)
+    Q_PROPERTY(bool txDtxEnabled READ txDtxEnabled NOTIFY txDtxEnabledChanged)
+    Q_PROPERTY(bool txAgcEnabled READ txAgcEnabled NOTIFY txAgcEnabledChanged)
+    Q_PROPERTY(int txLookAheadMs READ txLookAheadMs NOTIFY txLookAheadMsChanged)
+    Q_PROPERTY(int txProcessingLatencyMs READ txProcessingLatencyMs
+               NOTIFY txProcessingLatencyMsChanged)
+    Q_PROPERTY(int txPacketizationMs READ txPacketizationMs NOTIFY txPacketizationMsChanged)
+    Q_PROPERTY(int txMaxBacklogMs READ txMaxBacklogMs NOTIFY txMaxBacklogMsChanged)
+    // AudioEngine's limits for txMaxBacklogMs, so QML does not keep a copy.
+    Q_PROPERTY(int txMaxBacklogMinMs READ txMaxBacklogMinMs CONSTANT)
+    Q_PROPERTY(int txMaxBacklogMaxMs READ txMaxBacklogMaxMs CONSTANT)
+    Q_PROPERTY(int txMaxBacklogDefaultMs READ txMaxBacklogDefaultMs CONSTANT)
+    Q_PROPERTY(int txFrameSizeMs READ txFrameSizeMs NOTIFY txFrameSizeMsChanged)
+    // Header traffic the current TX frame size saves against 20 ms packets.
+    Q_PROPERTY(int txHeaderSavingsBitsPerSecond READ txHeaderSavingsBitsPerSecond
+               NOTIFY txFrameSizeMsChanged)
+    Q_PROPERTY(bool udpReceiveThreadEnabled READ udpReceiveThreadEnabled
+               NOTIFY udpReceiveThreadEnabledChanged)
+    Q_PROPERTY(bool txEncodeThreadEnabled READ txEncodeThreadEnabled
+               NOTIFY txEncodeThreadEnabledChanged)
+    Q_PROPERTY(int jitterBufferTargetMs READ jitterBufferTargetMs NOTIFY jitterBufferStatsChanged)
+    Q_PROPERTY(qreal rxJitterMs READ rxJitterMs NOTIFY jitterBufferStatsChanged)
     Q_PROPERTY(bool liveTranscriptionEnabled READ liveTranscriptionEnabled
                WRITE setLiveTranscriptionEnabled NOTIFY liveTranscriptionEnabledChanged)
     Q_PROPERTY(QString transcriptionText READ transcriptionText NOTIFY transcriptionTextChanged)
@@ -103,7 +132,7 @@ public:
     bool isDisconnected() const { return m_state == Disconnected; }
     bool audioReady() const { return m_audioReady; }
     bool isReceivingAudio() const { return m_isReceivingAudio; }
-    quint32 selectedTalkgroup() const { return m_talkgroup; }
+    quint32 selectedTalkgroup() const { return m_session.selectedTalkgroup(); }
     QVariantList monitoredTalkgroupsModel() const;
     QVariantList availableAudioRoutes() const { return m_availableAudioRoutes; }
     QString currentAudioRoute() const { return m_currentAudioRoute; }
@@ -121,6 +150,24 @@ public:
     qreal rxMeterPeakLevel() const { return m_rxMeterPeakLevel; }
     qreal txMeterLevel() const { return m_txMeterLevel; }
     qreal txMeterPeakLevel() const { return m_txMeterPeakLevel; }
+    bool adaptiveJitterBufferEnabled() const { return m_adaptiveJitterBufferEnabled; }
+    qreal jitterBufferUnderrunProbability() const { return m_jitterBufferUnderrunProbability; }
+    bool txFecEnabled() const { return m_txFecEnabled; }
+    bool txDtxEnabled() const { return m_txDtxEnabled; }
+    bool txAgcEnabled() const { return m_txAgcEnabled; }
+    int txLookAheadMs() const { return m_txLookAheadMs; }
+    int txProcessingLatencyMs() const { return m_txProcessingLatencyMs; }
+    int txPacketizationMs() const { return m_txPacketizationMs; }
+    int txMaxBacklogMs() const { return m_txMaxBacklogMs; }
+    int txMaxBacklogMinMs() const { return AudioEngine::MIN_TX_BACKLOG_MS; }
+    int txMaxBacklogMaxMs() const { return AudioEngine::MAX_TX_BACKLOG_MS; }
+    int txMaxBacklogDefaultMs() const { return AudioEngine::DEFAULT_TX_MAX_BACKLOG_MS; }
+    int txFrameSizeMs() const { return m_txFrameSizeMs; }
+    int txHeaderSavingsBitsPerSecond() const;
+    bool udpReceiveThreadEnabled() const { return m_udpReceiveThreadEnabled; }
+    bool txEncodeThreadEnabled() const { return m_txEncodeThreadEnabled; }
+    int jitterBufferTargetMs() const { return m_jitterBufferTargetMs; }
+    qreal rxJitterMs() const { return m_rxJitterMs; }
     bool liveTranscriptionEnabled() const { return m_liveTranscriptionEnabled; }
     QString transcriptionText() const { return m_transcriptionText; }
     bool transcriptionAvailable() const { return m_transcriptionAvailable; }
@@ -150,6 +197,20 @@ public:
     Q_INVOKABLE void setPreferredAudioRoute(const QString &routeId);
     Q_INVOKABLE void setRxAudioLevelDb(qreal levelDb);
     Q_INVOKABLE void setTxAudioLevelDb(qreal levelDb);
+    Q_INVOKABLE void setAdaptiveJitterBufferEnabled(bool enabled);
+    Q_INVOKABLE void setJitterBufferUnderrunProbability(qreal probability);
+    Q_INVOKABLE void setTxFecEnabled(bool enabled);
+    Q_INVOKABLE void setTxDtxEnabled(bool enabled);
+    Q_INVOKABLE void setTxAgcEnabled(bool enabled);
+    Q_INVOKABLE void setTxLookAheadMs(int milliseconds);
+    // 0 chooses the TX packet size from the link; 20, 40 or 60 fixes it.
+    Q_INVOKABLE void setTxPacketizationMs(int milliseconds);
+    // How far captured TX audio may fall behind before the oldest is
+    // dropped.  Takes effect from the next transmission.
+    Q_INVOKABLE void setTxMaxBacklogMs(int milliseconds);
+    Q_INVOKABLE void setUdpReceiveThreadEnabled(bool enabled);
+    // Takes effect from the next transmission.
+    Q_INVOKABLE void setTxEncodeThreadEnabled(bool enabled);
     Q_INVOKABLE void setTxTimeoutSeconds(int seconds);
     Q_INVOKABLE void setPttHangTimeMs(int milliseconds);
     Q_INVOKABLE void setHardwarePttEnabled(bool enabled);
@@ -192,6 +253,7 @@ public:
 
 private:
     friend class ReflectorClientTest;
+    friend class LatencyBench;
 
     void startTransmission();
     void cancelPendingPttRelease();
@@ -230,6 +292,18 @@ signals:
     void rxMeterPeakLevelChanged();
     void txMeterLevelChanged();
     void txMeterPeakLevelChanged();
+    void jitterBufferSettingsChanged();
+    void jitterBufferStatsChanged();
+    void txFecEnabledChanged();
+    void txDtxEnabledChanged();
+    void txAgcEnabledChanged();
+    void txLookAheadMsChanged();
+    void txProcessingLatencyMsChanged();
+    void txPacketizationMsChanged();
+    void txMaxBacklogMsChanged();
+    void txFrameSizeMsChanged();
+    void udpReceiveThreadEnabledChanged();
+    void txEncodeThreadEnabledChanged();
     void liveTranscriptionEnabledChanged();
     void transcriptionTextChanged();
     void transcriptionAvailabilityChanged();
@@ -258,8 +332,11 @@ private slots:
     void onTcpDisconnected();
     void onTcpReadyRead();
     void onUdpReadyRead();
+    void onUdpAudioStarted();
+    void onUdpFlushReceived();
+    void onUdpAudioTimeout();
     void onTcpError(QAbstractSocket::SocketError socketError);
-    void onHeartbeatTimer();
+    void onSessionTimer();
     void onTxTimerTimeout();
     void onNameLookupFinished();
     void startNameLookup(const QString &callsign);
@@ -269,7 +346,6 @@ private slots:
     void onTxDrainComplete();
     void onPttHangTimerTimeout();
     void checkAndReconnect();
-    void onTalkgroupSelectionTimer();
     void onReconnectBackoffTimeout();
     void onProtocolLivenessTimeout();
     void handleAndroidNetworkStateChanged(int generation,
@@ -291,14 +367,22 @@ private:
     ReflectorClient(const ReflectorClient&) = delete;
     ReflectorClient& operator=(const ReflectorClient&) = delete;
 
-    void sendFrame(const QByteArray &payload);
-    void sendProtoVer();
-    void sendAuthResponse(const QByteArray &hmac);
-    void sendNodeInfo();
-    void sendSelectTG(quint32 talkgroup);
-    void sendTgMonitor(const QList<quint32> &talkgroups);
-    void sendHeartbeat();
+    // Writes what m_session queued, handles its events and re-arms
+    // m_sessionTimer.  Called after every input to and command on it.
+    void drainSession(qint64 datagramArrivalUs = 0);
+    void handleSessionEvent(const ReflectorSession::Event &event, qint64 datagramArrivalUs);
+    void handleSessionAuthenticated();
+    void advanceSession(qint64 nowMs);
+    qint64 sessionNowMs() const;
+    void configureSession();
+    void updateSessionNodeInfo();
     void sendUdpMessage(const QByteArray &datagram);
+    void processUdpDatagram(const char* data, qint64 datagramSize, qint64 arrivalUs);
+    void noteUdpAudioActivity(qint64 arrivalUs);
+    void startUdpReceiveThread();
+    void stopUdpReceiveThread();
+    void openUdpAudioSender();
+    void closeUdpAudioSender();
     void sendTxFlushSamples();
     void setupAudio();
     void initializeAudioEngine();
@@ -312,9 +396,7 @@ private:
     bool hasValidatedNetworkForReconnect() const;
     void setWaitingForValidatedNetwork(bool waiting);
     QString reconnectStatusText() const;
-    void resetProtocolLivenessWatchdog();
-    void noteInboundProtocolHeartbeat();
-    int protocolLivenessTimeoutMs() const;
+    void updateNetworkRoundTrip();
     static int normalizeTgSelectTimeoutSeconds(int seconds);
     static QString nodeInfoSoftwareName();
     static QString nodeInfoSoftwareVersion();
@@ -347,12 +429,9 @@ private:
     void setRxMeterState(qreal level, qreal peakLevel);
     void setTxMeterState(qreal level, qreal peakLevel);
     void resetAudioMeters();
-    void resetTalkgroupSelectionTimer();
-    void stopTalkgroupSelectionTimer();
+    void applyJitterBufferSettingsToEngine();
+    void setJitterBufferStats(int targetMs, qreal jitterMs);
     void clearMonitoredTalkgroups();
-    quint8 monitoredTalkgroupPriority(quint32 talkgroup) const;
-    bool isTalkgroupMonitored(quint32 talkgroup) const;
-    bool shouldHandleTalkerStart(quint32 talkgroup);
 
     struct ReconnectContext {
         QString host;
@@ -378,30 +457,15 @@ private:
         Other = 4
     };
 
-    enum class TalkgroupSelectionOrigin {
-        Manual,
-        RemoteActivation,
-        RemotePriorityActivation,
-        RequestQsy,
-        Timeout,
-        TxDefaultActivation
-    };
-    bool selectTalkgroupInternal(quint32 talkgroup, TalkgroupSelectionOrigin origin);
-
-    struct MonitoredTalkgroupEntry {
-        quint32 talkgroup = 0;
-        quint8 priority = 0;
-    };
+    using MonitoredTalkgroupEntry = ReflectorSession::MonitoredTalkgroup;
 
     struct ParsedMonitoredTalkgroups {
         QString normalizedSpec;
         QList<MonitoredTalkgroupEntry> configured;
-        QList<quint32> activeTalkgroups;
     };
 
-    static ParsedMonitoredTalkgroups parseMonitoredTalkgroupsSpec(const QString &monitoredTalkgroups,
-                                                                  quint32 primaryTalkgroup);
-    void applyMonitoredTalkgroups(const QString &monitoredTalkgroups);
+    static ParsedMonitoredTalkgroups parseMonitoredTalkgroupsSpec(const QString &monitoredTalkgroups);
+    void applyMonitoredTalkgroups(quint32 defaultTalkgroup, const QString &monitoredTalkgroups);
     
 #if defined(Q_OS_ANDROID)
     void acquireWakeLock();
@@ -426,14 +490,6 @@ private:
     void refreshHardwarePttSettings();
 #endif
 
-    // --- Private Helper Functions for Message Handling ---
-    void handleAuthChallenge(QDataStream &stream);
-    void handleServerInfo(QDataStream &stream);
-    void handleTalkerStart(QDataStream &stream);
-    void handleTalkerStop(QDataStream &stream);
-    void handleTalkerStartV1(QDataStream &stream);
-    void handleTalkerStopV1(QDataStream &stream);
-
     enum State {
         Disconnected,
         Connecting,
@@ -449,23 +505,28 @@ private:
 
     QTcpSocket* m_tcpSocket = nullptr;
     QUdpSocket* m_udpSocket = nullptr;
-    QTimer* m_heartbeatTimer = nullptr;
-    QByteArray m_tcpBuffer;
+    // The protocol itself; this class feeds it the sockets and the clock
+    // and turns its events into signals.
+    ReflectorSession m_session;
+    QElapsedTimer m_sessionClock;
+    // Single-shot, for the session's next deadline.
+    QTimer* m_sessionTimer = nullptr;
+    qint64 m_sessionTimerDeadlineMs = -1;
+    // Reused for every datagram; grows once if a larger one ever arrives.
+    QByteArray m_udpReceiveBuffer;
     QString m_host;
     int m_port;
     QByteArray m_authKey;
     QString m_callsign;
-    quint32 m_talkgroup;
-    quint32 m_defaultTalkgroup;
-    quint16 m_clientId = 0;
-    uint16_t m_udpSequence = 0;
+    // Resolved once per session in onTcpConnected().
+    QHostAddress m_udpPeerAddress;
+    std::unique_ptr<UdpAudioSender> m_udpAudioSender;
 
     // Audio engine and thread
     AudioEngine* m_audioEngine = nullptr;
     QThread* m_audioThread = nullptr;
 
     QString m_currentTalker;
-    quint16 m_lastAudioSeq = 0;
     bool m_isReceivingAudio = false;
     QVariantList m_availableAudioRoutes;
     QString m_currentAudioRoute;
@@ -480,6 +541,29 @@ private:
     qreal m_rxMeterPeakLevel = 0.0;
     qreal m_txMeterLevel = 0.0;
     qreal m_txMeterPeakLevel = 0.0;
+    bool m_adaptiveJitterBufferEnabled = true;
+    qreal m_jitterBufferUnderrunProbability = 0.02;
+    bool m_txFecEnabled = false;
+    bool m_txDtxEnabled = false;
+    bool m_txAgcEnabled = false;
+    int m_txLookAheadMs = AudioEngine::DEFAULT_TX_LOOKAHEAD_MS;
+    // Reported back by the engine; the last this much of each over leaves
+    // during the drain after PTT release.
+    int m_txProcessingLatencyMs = 0;
+    int m_txPacketizationMs = 0;
+    int m_txMaxBacklogMs = AudioEngine::DEFAULT_TX_MAX_BACKLOG_MS;
+    // Packet size the engine settled on for the next transmission
+    int m_txFrameSizeMs = AudioEngine::FRAME_SIZE_MS;
+    // Kernel-smoothed TCP round trip to the reflector, -1 when unknown
+    int m_networkRoundTripMs = -1;
+    bool m_udpReceiveThreadEnabled = false;
+    std::unique_ptr<UdpReceiveThread> m_udpReceiveThread;
+    bool m_txEncodeThreadEnabled = false;
+    // Written by whichever thread reads the UDP socket.
+    std::atomic<bool> m_udpAudioActive{false};
+    std::atomic<qint64> m_lastUdpAudioArrivalUs{0};
+    int m_jitterBufferTargetMs = AudioEngine::DEFAULT_PREBUF_MS;
+    qreal m_rxJitterMs = 0.0;
     bool m_liveTranscriptionEnabled = false;
     QString m_transcriptionText;
     bool m_transcriptionAvailable = false;
@@ -497,21 +581,15 @@ private:
     QString m_transcriptionPendingText;
     QString m_lastFinalTranscriptionSegment;
     QTimer* m_transcriptionSupportRefreshTimer = nullptr;
-    QList<quint32> m_monitoredTalkgroups;
-    QList<MonitoredTalkgroupEntry> m_configuredMonitoredTalkgroups;
     QString m_monitoredTalkgroupsSpec;
     QJsonObject m_customNodeInfoJson;
     QTimer* m_audioTimeoutTimer = nullptr;
-    QTimer* m_talkgroupSelectionTimer = nullptr;
-    int m_tgSelectTimeoutCounter = 0;
     int m_tgSelectTimeoutSeconds = 30;
-    bool m_usePriorityMode = true;
 
     QTimer* m_txTimer = nullptr;
     QTimer* m_pttHangTimer = nullptr;
     QTimer* m_connectTimer = nullptr;
     QTimer* m_reconnectTimer = nullptr;
-    QTimer* m_protocolLivenessTimer = nullptr;
     bool m_txTimeoutEnabled = true;
     int m_txTimeoutSeconds = 175;
     int m_pttHangTimeMs = 100;
@@ -538,9 +616,6 @@ private:
     int m_reconnectBackoffStep = 0;
     bool m_ignoreNextSocketDisconnect = false;
     bool m_ignoreNextSocketError = false;
-    QElapsedTimer m_protocolHeartbeatClock;
-    qint64 m_lastInboundHeartbeatMs = -1;
-    QList<qint64> m_recentInboundHeartbeatIntervals;
     bool m_shutdownComplete = false;
 };
 
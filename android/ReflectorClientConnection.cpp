@@ -29,7 +29,6 @@ void ReflectorClient::connectToServer(const QString &host, int port, const QStri
     clearReconnectSchedule();
     resetReconnectBackoff();
     setWaitingForValidatedNetwork(false);
-    resetProtocolLivenessWatchdog();
     m_ignoreNextSocketDisconnect = false;
     m_ignoreNextSocketError = false;
 
@@ -38,37 +37,28 @@ void ReflectorClient::connectToServer(const QString &host, int port, const QStri
     m_port = port;
     m_authKey = authKey.trimmed().toUtf8();
     m_callsign = callsign.trimmed();
-    if (m_talkgroup != talkgroup) {
-        m_talkgroup = talkgroup;
-        emit selectedTalkgroupChanged();
-    } else {
-        m_talkgroup = talkgroup;
-    }
     m_tgSelectTimeoutSeconds = normalizeTgSelectTimeoutSeconds(tgSelectTimeoutSeconds);
-    if (m_defaultTalkgroup == 0) {
-        m_defaultTalkgroup = talkgroup;
-    }
-    applyMonitoredTalkgroups(monitoredTalkgroups);
-    stopTalkgroupSelectionTimer();
-    m_usePriorityMode = true;
+    const quint32 defaultTalkgroup = m_session.defaultTalkgroup() == 0
+            ? talkgroup
+            : m_session.defaultTalkgroup();
+    applyMonitoredTalkgroups(defaultTalkgroup, monitoredTalkgroups);
+    configureSession();
+    m_session.open(talkgroup, sessionNowMs());
+    drainSession();
 
 #if defined(Q_OS_ANDROID)
     startVoipService(true);
     saveConnectionState();
-    updateServiceSelectedTalkgroup(m_talkgroup);
+    updateServiceSelectedTalkgroup(talkgroup);
     updateServiceCurrentTalker(QString());
     updateServiceReceiveState(false, QString());
     updateServiceTransmitState(false);
 #endif
-    m_clientId = 0;
-    m_udpSequence = 0;
     m_state = Connecting; m_connectionStatus = "Connecting to " + m_host + "...";
     emit connectionStatusChanged();
 #if defined(Q_OS_ANDROID)
     updateServiceConnectionStatus(m_connectionStatus, false);
 #endif
-    m_tcpBuffer.clear();
-    m_lastAudioSeq = 0;
 
     m_currentTalker.clear();
     setReceivingAudioState(false);
@@ -95,7 +85,6 @@ void ReflectorClient::disconnectFromServer()
     clearReconnectSchedule();
     resetReconnectBackoff();
     setWaitingForValidatedNetwork(false);
-    resetProtocolLivenessWatchdog();
     m_ignoreNextSocketError = false;
     m_ignoreNextSocketDisconnect = false;
 
@@ -136,13 +125,17 @@ void ReflectorClient::onTcpConnected()
     updateServiceTransmitState(false);
 #endif
 
+    m_udpPeerAddress = m_tcpSocket->peerAddress();
+
     QHostAddress::SpecialAddress bindAddr = QHostAddress::AnyIPv4;
     bool udpBound = m_udpSocket->bind(bindAddr, 0);
     qDebug() << "ReflectorClient::onTcpConnected - UDP socket bind result:" << udpBound
              << "UDP local port:" << m_udpSocket->localPort()
              << "UDP state:" << m_udpSocket->state();
+    startUdpReceiveThread();
 
-    sendProtoVer();
+    m_session.transportConnected(sessionNowMs());
+    drainSession();
 }
 
 void ReflectorClient::onTcpDisconnected()
@@ -236,7 +229,9 @@ void ReflectorClient::checkAndReconnect()
         }
     } else if (state == QAbstractSocket::ConnectedState) {
         if (m_state == Connected) {
-            sendHeartbeat();
+            m_session.sendHeartbeat();
+            drainSession();
+            updateNetworkRoundTrip();
         }
     } else {
         qDebug() << "TCP socket in intermediate state:" << state << "- monitoring...";
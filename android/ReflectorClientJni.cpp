@@ -720,7 +720,7 @@ void ReflectorClient::handleAndroidControlEvent(int eventType)
             int port = m_port;
             QByteArray authKey = m_authKey;
             QString callsign = m_callsign;
-            quint32 talkgroup = m_talkgroup;
+            quint32 talkgroup = m_session.selectedTalkgroup();
             QString monitoredTalkgroups = m_monitoredTalkgroupsSpec;
             int tgSelectTimeoutSeconds = m_tgSelectTimeoutSeconds;
 
@@ -810,7 +810,7 @@ void ReflectorClient::startVoipService(bool monitorConnection)
         hostStr.object(),
         m_port,
         callsignStr.object(),
-        m_talkgroup,
+        m_session.selectedTalkgroup(),
         static_cast<jboolean>(monitorConnection)
     );
 }
@@ -953,7 +953,7 @@ void ReflectorClient::saveConnectionState()
         hostStr.object(),
         m_port,
         callsignStr.object(),
-        m_talkgroup,
+        m_session.selectedTalkgroup(),
         authKeyStr.object(),
         monitoredTalkgroupsStr.object(),
         m_tgSelectTimeoutSeconds
@@ -17,10 +17,6 @@
 
 #include "ReflectorClient.h"
 #include "ReflectorProtocol.h"
-#include <QMessageAuthenticationCode>
-#include <QCryptographicHash>
-#include <QDataStream>
-#include <QtEndian>
 #include <QJsonObject>
 #include <QJsonDocument>
 #include <QHostAddress>
@@ -28,69 +24,44 @@
 #include <QNetworkReply>
 #include <QDebug>
 #include <QMetaObject>
+#include <limits>
 
 #if defined(Q_OS_ANDROID)
 #  include <QtCore/QJniObject>
 #endif
 
 namespace {
-bool readLengthPrefixedUtf8(QDataStream &stream, QString &value)
-{
-    quint16 len = 0;
-    stream >> len;
-    if (stream.status() != QDataStream::Ok) {
-        return false;
-    }
+// Bytes available per socket read; a longer backlog is taken in turns so
+// the frame buffer stays this size plus one partial frame.
+constexpr qint64 kTcpReadChunkBytes = 64 * 1024;
 
-    QByteArray data(len, Qt::Uninitialized);
-    if (len > 0 && stream.readRawData(data.data(), len) != len) {
-        return false;
-    }
-
-    value = QString::fromUtf8(data);
-    return true;
-}
+QString utf8String(const std::string &bytes)
+{
+    return QString::fromUtf8(bytes.data(), qsizetype(bytes.size()));
 }
 
-// --- Protocol Serialization ---
-
-void ReflectorClient::sendFrame(const QByteArray &payload)
+// Fixed-width callsign fields are NUL-padded Latin-1.
+QString latin1Field(const std::string &bytes)
 {
-    if (m_tcpSocket->state() != QAbstractSocket::ConnectedState) return;
-    QByteArray frame;
-    QDataStream stream(&frame, QIODevice::WriteOnly);
-    stream.setByteOrder(QDataStream::BigEndian);
-    stream << (uint32_t)payload.size();
-    frame.append(payload);
-    m_tcpSocket->write(frame);
+    return QString::fromLatin1(bytes.data(), qsizetype(bytes.size())).trimmed();
+}
 }
 
-void ReflectorClient::sendProtoVer()
+// --- Session Plumbing ---
+
+qint64 ReflectorClient::sessionNowMs() const
 {
-    QByteArray payload;
-    QDataStream stream(&payload, QIODevice::WriteOnly);
-    stream.setByteOrder(QDataStream::BigEndian);
-    stream << (quint16)Svxlink::MsgType::PROTO_VER;
-    stream << (quint16)Svxlink::Protocol::MAJOR_VER;
-    stream << (quint16)Svxlink::Protocol::MINOR_VER;
-    sendFrame(payload);
+    return m_sessionClock.elapsed();
 }
 
-void ReflectorClient::sendAuthResponse(const QByteArray &hmac)
+void ReflectorClient::configureSession()
 {
-    QByteArray payload;
-    QDataStream stream(&payload, QIODevice::WriteOnly);
-    stream.setByteOrder(QDataStream::BigEndian);
-    QByteArray callsignData = m_callsign.toUtf8();
-    stream << (quint16)Svxlink::MsgType::AUTH_RESPONSE;
-    stream << (quint16)callsignData.size();
-    stream.writeRawData(callsignData.constData(), callsignData.size());
-    stream << (quint16)hmac.size();
-    stream.writeRawData(hmac.constData(), hmac.size());
-    sendFrame(payload);
+    m_session.setCredentials(m_callsign.toUtf8().toStdString(), m_authKey.toStdString());
+    m_session.setTalkgroupSelectTimeoutSeconds(m_tgSelectTimeoutSeconds);
+    updateSessionNodeInfo();
 }
 
-void ReflectorClient::sendNodeInfo()
+void ReflectorClient::updateSessionNodeInfo()
 {
     QJsonObject nodeInfoJson = m_customNodeInfoJson;
     nodeInfoJson["sw"] = nodeInfoSoftwareName();
@@ -99,470 +70,285 @@ void ReflectorClient::sendNodeInfo()
     nodeInfoJson["tip"] = nodeInfoTipHtml();
     nodeInfoJson["Website"] = nodeInfoWebsite();
     QJsonDocument doc(nodeInfoJson);
-    QByteArray jsonData = doc.toJson(QJsonDocument::Compact);
-    QByteArray payload;
-    QDataStream stream(&payload, QIODevice::WriteOnly);
-    stream.setByteOrder(QDataStream::BigEndian);
-    stream << (quint16)Svxlink::MsgType::NODE_INFO;
-    stream << (quint16)jsonData.size();
-    stream.writeRawData(jsonData.constData(), jsonData.size());
-    sendFrame(payload);
+    m_session.setNodeInfo(doc.toJson(QJsonDocument::Compact).toStdString(), sessionNowMs());
+    drainSession();
 }
 
-void ReflectorClient::sendSelectTG(quint32 talkgroup)
+void ReflectorClient::onSessionTimer()
 {
-    QByteArray payload;
-    QDataStream stream(&payload, QIODevice::WriteOnly);
-    stream.setByteOrder(QDataStream::BigEndian);
-    stream << (quint16)Svxlink::MsgType::SELECT_TG;
-    stream << talkgroup;
-    sendFrame(payload);
+    advanceSession(sessionNowMs());
 }
 
-void ReflectorClient::sendTgMonitor(const QList<quint32> &talkgroups)
+void ReflectorClient::advanceSession(qint64 nowMs)
 {
-    QByteArray payload;
-    QDataStream stream(&payload, QIODevice::WriteOnly);
-    stream.setByteOrder(QDataStream::BigEndian);
-    stream << (quint16)Svxlink::MsgType::TG_MONITOR;
-    stream << static_cast<quint16>(talkgroups.size());
-    for (quint32 talkgroup : talkgroups) {
-        stream << talkgroup;
+    m_session.setChannelBusy(m_pttActive || m_isReceivingAudio);
+    m_session.advance(nowMs);
+    drainSession();
+    if (m_state == Connected) {
+        updateNetworkRoundTrip();
     }
-    sendFrame(payload);
 }
 
-void ReflectorClient::sendHeartbeat()
+void ReflectorClient::drainSession(qint64 datagramArrivalUs)
 {
-    QByteArray payload;
-    QDataStream stream(&payload, QIODevice::WriteOnly);
-    stream.setByteOrder(QDataStream::BigEndian);
-    stream << (quint16)Svxlink::MsgType::HEARTBEAT;
-    sendFrame(payload);
-}
-
-// --- Message Handling ---
-
-void ReflectorClient::handleAuthChallenge(QDataStream &stream)
-{
-    quint16 len = 0;
-    stream >> len;
-    QByteArray challenge(len, 0);
-    stream.readRawData(challenge.data(), len);
-    QByteArray hmac = QMessageAuthenticationCode::hash(challenge, m_authKey, QCryptographicHash::Sha1);
-    sendAuthResponse(hmac);
-}
-
-void ReflectorClient::handleServerInfo(QDataStream &stream)
-{
-    quint16 reserved = 0;
-    stream >> reserved >> m_clientId;
-    m_state = Connected;
-    resetReconnectBackoff();
-    setWaitingForValidatedNetwork(false);
-    resetProtocolLivenessWatchdog();
-
-    qDebug() << "ReflectorClient::handleServerInfo - Authentication successful"
-             << "Client ID:" << m_clientId
-             << "Reserved field:" << reserved
-             << "Target talkgroup:" << m_talkgroup
-             << "TCP peer address for UDP:" << m_tcpSocket->peerAddress().toString();
+    // Handlers may call back into the session and drain it themselves; the
+    // queues are shared, so nothing is handled twice.
+    ReflectorSession::Event event;
+    while (m_session.nextEvent(event)) {
+        handleSessionEvent(event, datagramArrivalUs);
+    }
 
-    refreshConnectionStatus();
-    emit selectedTalkgroupChanged();
-#if defined(Q_OS_ANDROID)
-    updateServiceSelectedTalkgroup(m_talkgroup);
-#endif
-    qInfo() << "Authenticated! ClientID:" << m_clientId;
-    sendNodeInfo();
-    sendSelectTG(m_talkgroup);
-    sendTgMonitor(m_monitoredTalkgroups);
-    if (m_talkgroup > 0) {
-        resetTalkgroupSelectionTimer();
-    } else {
-        stopTalkgroupSelectionTimer();
+    if (m_session.tcpOutputBytes() > 0) {
+        if (m_tcpSocket->state() == QAbstractSocket::ConnectedState) {
+            m_tcpSocket->write(m_session.tcpOutput(), m_session.tcpOutputBytes());
+        }
+        m_session.clearTcpOutput();
     }
-    m_heartbeatTimer->start(5000);
 
-    // send initial UDP heartbeat to register our port immediately
-    setupAudio();
-    QByteArray datagram(sizeof(Svxlink::UdpMsgHeader), Qt::Uninitialized);
-    auto* header = reinterpret_cast<Svxlink::UdpMsgHeader*>(datagram.data());
-    header->type = qToBigEndian((quint16)Svxlink::UdpMsgType::UDP_HEARTBEAT);
-    header->clientId = qToBigEndian((quint16)m_clientId);
-    header->sequenceNum = qToBigEndian(m_udpSequence++);
-
-    qDebug() << "ReflectorClient::handleServerInfo - Sending initial UDP heartbeat, sequence:" << (m_udpSequence-1);
-    sendUdpMessage(datagram);
-#if defined(Q_OS_ANDROID)
-    resumeAndroidPttAfterReconnectIfReady();
-#endif
-}
+    const char *datagram = nullptr;
+    int datagramSize = 0;
+    while (m_session.nextDatagram(datagram, datagramSize)) {
+        sendUdpMessage(QByteArray::fromRawData(datagram, datagramSize));
+    }
 
-void ReflectorClient::handleTalkerStart(QDataStream &stream)
-{
-    quint32 tg = 0;
-    if (stream.device()->bytesAvailable() >= static_cast<int>(sizeof(quint32)))
-        stream >> tg;
-    quint16 len = 0;
-    stream >> len;
-    QByteArray cs(len, 0);
-    stream.readRawData(cs.data(), len);
-    QString callsign = QString::fromUtf8(cs);
-    if (callsign == m_callsign) {
-        if (!m_currentTalker.isEmpty()) {
-            m_currentTalker.clear();
-            emit currentTalkerChanged();
-#if defined(Q_OS_ANDROID)
-            updateServiceCurrentTalker(QString());
-#endif
-        }
-        if (!m_currentTalkerName.isEmpty()) {
-            m_currentTalkerName.clear();
-            emit currentTalkerNameChanged();
-        }
+    const qint64 deadlineMs = m_session.nextTimeoutMs();
+    if (deadlineMs < 0) {
+        m_sessionTimer->stop();
+        m_sessionTimerDeadlineMs = -1;
         return;
     }
-    if (!shouldHandleTalkerStart(tg)) {
+    // Most inputs leave the deadline alone; restarting the timer per audio
+    // packet would be wasted work.
+    if (deadlineMs == m_sessionTimerDeadlineMs && m_sessionTimer->isActive()) {
         return;
     }
-    m_currentTalker = callsign;
-    emit currentTalkerChanged();
-#if defined(Q_OS_ANDROID)
-    updateServiceCurrentTalker(m_currentTalker);
-    if (m_isReceivingAudio) {
-        updateServiceReceiveState(true, m_currentTalker);
-    }
-#endif
-    m_currentTalkerName.clear();
-    emit currentTalkerNameChanged();
-
-    startNameLookup(callsign);
+    m_sessionTimerDeadlineMs = deadlineMs;
+    m_sessionTimer->start(int(qBound<qint64>(0, deadlineMs - sessionNowMs(),
+                                             std::numeric_limits<int>::max())));
 }
 
-void ReflectorClient::handleTalkerStartV1(QDataStream &stream)
+// --- Session Events ---
+
+void ReflectorClient::handleSessionEvent(const ReflectorSession::Event &event, qint64 datagramArrivalUs)
 {
-    quint16 len = 0;
-    stream >> len;
-    QByteArray cs(len, 0);
-    stream.readRawData(cs.data(), len);
-    QString callsign = QString::fromUtf8(cs);
-    if (callsign == m_callsign) {
-        if (!m_currentTalker.isEmpty()) {
-            m_currentTalker.clear();
-            emit currentTalkerChanged();
+    using Type = ReflectorSession::Event::Type;
+
+    switch (event.type) {
+    case Type::Authenticated:
+        handleSessionAuthenticated();
+        break;
+    case Type::ProtocolUnsupported:
+        qWarning() << "Server requested protocol downgrade to" << (event.value >> 16) << "." << (event.value & 0xffff);
+        qWarning() << "Protocol downgrade not supported - disconnecting";
+
+        m_connectionStatus = "Protocol version incompatible";
+        emit connectionStatusChanged();
+        m_state = Disconnected;
 #if defined(Q_OS_ANDROID)
-            updateServiceCurrentTalker(QString());
+        updateServiceConnectionStatus(m_connectionStatus, false);
 #endif
+        break;
+    case Type::ServerError: {
+        const QString errorString = QString::fromLatin1(event.text.data(), qsizetype(event.text.size()));
+        qWarning() << "Server error:" << errorString;
+        m_connectionStatus = "Server error: " + errorString;
+        emit connectionStatusChanged();
+
+        if (event.flag) {
+            qDebug() << "Clearing cached auth key due to authentication failure";
+            m_authKey.clear();
         }
-        if (!m_currentTalkerName.isEmpty()) {
-            m_currentTalkerName.clear();
-            emit currentTalkerNameChanged();
-        }
-        return;
-    }
-    m_currentTalker = callsign;
-    emit currentTalkerChanged();
-#if defined(Q_OS_ANDROID)
-    updateServiceCurrentTalker(m_currentTalker);
-    if (m_isReceivingAudio) {
-        updateServiceReceiveState(true, m_currentTalker);
-    }
-#endif
-    m_currentTalkerName.clear();
-    emit currentTalkerNameChanged();
-
-    startNameLookup(callsign);
-}
 
-void ReflectorClient::handleTalkerStop(QDataStream &stream)
-{
-    quint32 tg = 0;
-    if (stream.device()->bytesAvailable() >= static_cast<int>(sizeof(quint32)))
-        stream >> tg;
-    quint16 len = 0;
-    stream >> len;
-    QByteArray cs(len, 0);
-    stream.readRawData(cs.data(), len);
-    QString callsign = QString::fromUtf8(cs);
-    if (callsign != m_currentTalker)
-        return;
-    m_currentTalker.clear();
-    emit currentTalkerChanged();
+        m_state = Disconnected;
 #if defined(Q_OS_ANDROID)
-    updateServiceCurrentTalker(QString());
-    updateServiceReceiveState(false, QString());
+        updateServiceConnectionStatus(m_connectionStatus, false);
 #endif
-    if (!m_currentTalkerName.isEmpty()) {
-        m_currentTalkerName.clear();
-        emit currentTalkerNameChanged();
+        break;
     }
-}
-
-void ReflectorClient::handleTalkerStopV1(QDataStream &stream)
-{
-    quint16 len = 0;
-    stream >> len;
-    QByteArray cs(len, 0);
-    stream.readRawData(cs.data(), len);
-    QString callsign = QString::fromUtf8(cs);
-    if (callsign != m_currentTalker)
-        return;
-    m_currentTalker.clear();
-    emit currentTalkerChanged();
+    case Type::FrameTooLarge:
+        qWarning() << "Received excessively large frame size, disconnecting."
+                   << "Declared size:" << event.value;
+        disconnectFromServer();
+        break;
+    case Type::LivenessExpired:
+        onProtocolLivenessTimeout();
+        break;
+    case Type::TalkgroupChanged:
+        emit selectedTalkgroupChanged();
+        if (m_state != Connected) {
+            qInfo() << "Stored talkgroup for next connection:" << event.talkgroup;
+            break;
+        }
+        qInfo() << "Selecting talkgroup:" << event.talkgroup;
+        refreshConnectionStatus();
+        break;
+    case Type::TalkerStarted:
+        m_currentTalker = utf8String(event.text);
+        emit currentTalkerChanged();
 #if defined(Q_OS_ANDROID)
-    updateServiceCurrentTalker(QString());
-    updateServiceReceiveState(false, QString());
+        updateServiceCurrentTalker(m_currentTalker);
+        if (m_isReceivingAudio) {
+            updateServiceReceiveState(true, m_currentTalker);
+        }
 #endif
-    if (!m_currentTalkerName.isEmpty()) {
         m_currentTalkerName.clear();
         emit currentTalkerNameChanged();
-    }
-}
 
-// --- TCP Message Dispatch ---
-
-void ReflectorClient::onTcpReadyRead()
-{
-    m_tcpBuffer.append(m_tcpSocket->readAll());
-
-    while (true) {
-        if (m_tcpBuffer.size() < sizeof(uint32_t)) {
-            break;
-        }
-        uint32_t payloadSize = qFromBigEndian<uint32_t>(m_tcpBuffer.constData());
-        if (payloadSize > 1024 * 1024) {
-            qWarning() << "Received excessively large frame size, disconnecting.";
-            disconnectFromServer();
-            return;
-        }
-        if (m_tcpBuffer.size() < (qint64)(sizeof(uint32_t) + payloadSize)) {
-            break;
+        startNameLookup(m_currentTalker);
+        break;
+    case Type::TalkerStopped:
+        if (!m_currentTalker.isEmpty()) {
+            m_currentTalker.clear();
+            emit currentTalkerChanged();
         }
-
-        m_tcpBuffer.remove(0, sizeof(uint32_t));
-        QByteArray payloadData = m_tcpBuffer.left(payloadSize);
-        m_tcpBuffer.remove(0, payloadSize);
-
-        QDataStream payloadStream(payloadData);
-        payloadStream.setByteOrder(QDataStream::BigEndian);
-        quint16 messageType;
-        payloadStream >> messageType;
-
-        switch(messageType) {
-        case Svxlink::MsgType::PROTO_VER:
-            qDebug() << "Received PROTO_VER from server. Waiting for challenge.";
-            break;
-        case Svxlink::MsgType::AUTH_CHALLENGE:
-            qDebug() << "Received AUTH_CHALLENGE from server.";
-            handleAuthChallenge(payloadStream);
-            break;
-        case Svxlink::MsgType::AUTH_OK:
-            qDebug() << "Received AUTH_OK from server. Waiting for SERVER_INFO.";
-            break;
-        case Svxlink::MsgType::PROTO_VER_DOWNGRADE: {
-            quint16 majorVer, minorVer;
-            payloadStream >> majorVer >> minorVer;
-
-            qWarning() << "Server requested protocol downgrade to" << majorVer << "." << minorVer;
-            qWarning() << "Protocol downgrade not supported - disconnecting";
-
-            m_connectionStatus = "Protocol version incompatible";
-            emit connectionStatusChanged();
-            m_state = Disconnected;
 #if defined(Q_OS_ANDROID)
-            updateServiceConnectionStatus(m_connectionStatus, false);
+        updateServiceCurrentTalker(QString());
+        updateServiceReceiveState(false, QString());
 #endif
-            break;
+        if (!m_currentTalkerName.isEmpty()) {
+            m_currentTalkerName.clear();
+            emit currentTalkerNameChanged();
         }
-        case Svxlink::MsgType::ERROR: {
-            quint16 messageLen = 0;
-            payloadStream >> messageLen;
-
-            QByteArray errorMessage(messageLen, Qt::Uninitialized);
-            payloadStream.readRawData(errorMessage.data(), messageLen);
-            QString errorString = QString::fromLatin1(errorMessage);
-
-            qWarning() << "Server error:" << errorString;
-            m_connectionStatus = "Server error: " + errorString;
-            emit connectionStatusChanged();
-
-            if (errorString.contains("Access denied", Qt::CaseInsensitive) ||
-                errorString.contains("Authentication", Qt::CaseInsensitive)) {
-                qDebug() << "Clearing cached auth key due to authentication failure";
-                m_authKey.clear();
-            }
-
-            m_state = Disconnected;
-#if defined(Q_OS_ANDROID)
-            updateServiceConnectionStatus(m_connectionStatus, false);
-#endif
-            break;
+        break;
+    case Type::NodeList: {
+        qDebug() << "Received NODE_LIST with" << event.strings.size() << "nodes";
+        QStringList nodes;
+        nodes.reserve(qsizetype(event.strings.size()));
+        for (const std::string &callsign : event.strings) {
+            nodes.append(utf8String(callsign));
         }
-        case Svxlink::MsgType::SERVER_INFO:
-            qDebug() << "Received SERVER_INFO from server.";
-            handleServerInfo(payloadStream);
-            break;
-        case Svxlink::MsgType::HEARTBEAT:
-            noteInboundProtocolHeartbeat();
-            break;
-        case Svxlink::MsgType::NODE_LIST: {
-            quint16 nodeCount = 0;
-            payloadStream >> nodeCount;
-            if (payloadStream.status() != QDataStream::Ok) {
-                qWarning() << "Malformed NODE_LIST frame: failed to read node count";
-                break;
-            }
-
-            qDebug() << "Received NODE_LIST with" << nodeCount << "nodes";
-            QStringList nodes;
-
-            for (int i = 0; i < nodeCount; i++) {
-                QString callsign;
-                if (!readLengthPrefixedUtf8(payloadStream, callsign)) {
-                    qWarning() << "Malformed NODE_LIST frame: failed to read node" << i;
-                    nodes.clear();
-                    break;
-                }
-                if (!callsign.isEmpty()) {
-                    nodes.append(callsign);
-                }
-            }
-
-            if (!nodes.isEmpty()) {
-                emit connectedNodesChanged(nodes);
-                qDebug() << "Connected nodes:" << nodes;
-            }
-            break;
+
+        if (!nodes.isEmpty()) {
+            emit connectedNodesChanged(nodes);
+            qDebug() << "Connected nodes:" << nodes;
         }
-        case Svxlink::MsgType::NODE_JOINED: {
-            QString callsign;
-            if (!readLengthPrefixedUtf8(payloadStream, callsign)) {
-                qWarning() << "Malformed NODE_JOINED frame";
-                break;
-            }
-
-            qDebug() << "Node joined:" << callsign;
-            emit nodeJoined(callsign);
-            break;
+        break;
+    }
+    case Type::NodeJoined: {
+        const QString callsign = utf8String(event.text);
+        qDebug() << "Node joined:" << callsign;
+        emit nodeJoined(callsign);
+        break;
+    }
+    case Type::NodeLeft: {
+        const QString callsign = utf8String(event.text);
+        qDebug() << "Node left:" << callsign;
+        emit nodeLeft(callsign);
+        break;
+    }
+    case Type::QsyRequested:
+        qDebug() << "QSY requested to talkgroup:" << event.talkgroup;
+        emit qsyRequested(event.talkgroup);
+        break;
+    case Type::StateEvent: {
+        const QString src = utf8String(event.strings[0]);
+        const QString name = utf8String(event.strings[1]);
+        const QString message = utf8String(event.strings[2]);
+
+        qDebug() << "State event from" << src << ":" << name << "=" << message;
+        emit stateEventReceived(src, name, message);
+        break;
+    }
+    case Type::SignalStrength: {
+        const QString callsign = latin1Field(event.text);
+        qDebug() << (event.flag ? "UDP Signal strength from" : "Signal strength from") << callsign
+                 << "- RX:" << event.rxSignal << "SQL:" << event.sqlOpen;
+        emit signalStrengthReceived(callsign, event.rxSignal, event.sqlOpen);
+        break;
+    }
+    case Type::TxStatus: {
+        const QString callsign = latin1Field(event.text);
+        qDebug() << "TX status from" << callsign << ":" << (event.flag ? "ON" : "OFF");
+        emit txStatusReceived(callsign, event.flag);
+        break;
+    }
+    case Type::AudioReceived:
+        if (m_audioEngine) {
+            // Copied straight into the engine's packet pool; no per-packet
+            // QByteArray or queued-call arguments.
+            m_audioEngine->enqueueReceivedAudio(reinterpret_cast<const unsigned char*>(event.data),
+                                                event.size, event.sequence, datagramArrivalUs);
+            noteUdpAudioActivity(datagramArrivalUs);
         }
-        case Svxlink::MsgType::NODE_LEFT: {
-            QString callsign;
-            if (!readLengthPrefixedUtf8(payloadStream, callsign)) {
-                qWarning() << "Malformed NODE_LEFT frame";
-                break;
-            }
-
-            qDebug() << "Node left:" << callsign;
-            emit nodeLeft(callsign);
-            break;
+        break;
+    case Type::FlushSamples:
+        // Behind the audio already queued, so it cannot land on the next
+        // talker's first packets.
+        if (m_audioEngine) {
+            m_audioEngine->enqueueReceivedFlush();
         }
-        case Svxlink::MsgType::TG_MONITOR: {
-            qWarning() << "Received unexpected inbound TG_MONITOR frame from server; ignoring";
-            break;
+        onUdpFlushReceived();
+        break;
+    case Type::AllSamplesFlushed:
+        qDebug() << "Received UDP all samples flushed";
+        if (m_audioEngine) {
+            QMetaObject::invokeMethod(m_audioEngine, "allSamplesFlushed", Qt::QueuedConnection);
         }
-        case Svxlink::MsgType::REQUEST_QSY: {
-            quint32 newTalkgroup;
-            payloadStream >> newTalkgroup;
-
-            qDebug() << "QSY requested to talkgroup:" << newTalkgroup;
-            selectTalkgroupInternal(newTalkgroup, TalkgroupSelectionOrigin::RequestQsy);
-            emit qsyRequested(newTalkgroup);
+        break;
+    case Type::MalformedMessage:
+        qWarning() << "Malformed" << (event.flag ? "UDP" : "TCP") << "message, type:" << event.value
+                   << "- dropped";
+        break;
+    case Type::UnknownMessage:
+        if (event.flag) {
+            qWarning() << "Received unhandled UDP message, type:" << event.value
+                       << "Known UDP types: UDP_HEARTBEAT(1), UDP_AUDIO(101), UDP_FLUSH_SAMPLES(102), UDP_ALL_SAMPLES_FLUSHED(103), UDP_SIGNAL_STRENGTH(104)";
             break;
         }
-        case Svxlink::MsgType::STATE_EVENT: {
-            quint16 srcLen, nameLen, msgLen;
-            payloadStream >> srcLen >> nameLen >> msgLen;
-
-            QByteArray srcData(srcLen, Qt::Uninitialized);
-            QByteArray nameData(nameLen, Qt::Uninitialized);
-            QByteArray msgData(msgLen, Qt::Uninitialized);
-
-            payloadStream.readRawData(srcData.data(), srcLen);
-            payloadStream.readRawData(nameData.data(), nameLen);
-            payloadStream.readRawData(msgData.data(), msgLen);
-
-            QString src = QString::fromUtf8(srcData);
-            QString name = QString::fromUtf8(nameData);
-            QString message = QString::fromUtf8(msgData);
+        qWarning() << "Received unhandled TCP message, type:" << event.value
+                   << "Payload size:" << event.size
+                   << "Connection state:" << m_state
+                   << "Known types: HEARTBEAT(1), PROTO_VER(5), PROTO_VER_DOWNGRADE(6), AUTH_CHALLENGE(10), AUTH_OK(12), ERROR(13), SERVER_INFO(100), NODE_LIST(101), NODE_JOINED(102), NODE_LEFT(103), TALKER_START(104), TALKER_STOP(105), SELECT_TG(106), TG_MONITOR(107), REQUEST_QSY(109), STATE_EVENT(110), NODE_INFO(111), SIGNAL_STRENGTH(112), TX_STATUS(113)";
 
-            qDebug() << "State event from" << src << ":" << name << "=" << message;
-            emit stateEventReceived(src, name, message);
-            break;
+        if (event.size <= 64) {
+            qDebug() << "Payload hex dump:" << QByteArray::fromRawData(event.data, event.size).toHex(' ');
         }
-        case Svxlink::MsgType::SIGNAL_STRENGTH: {
-            float rxSignal, rxSqlOpen;
-            QByteArray callsignData(20, Qt::Uninitialized);
+        break;
+    }
+}
 
-            payloadStream >> rxSignal >> rxSqlOpen;
-            payloadStream.readRawData(callsignData.data(), 20);
+void ReflectorClient::handleSessionAuthenticated()
+{
+    m_state = Connected;
+    resetReconnectBackoff();
+    setWaitingForValidatedNetwork(false);
 
-            QString callsign = QString::fromLatin1(callsignData).trimmed();
+    qDebug() << "ReflectorClient::handleSessionAuthenticated - Authentication successful"
+             << "Client ID:" << m_session.clientId()
+             << "Target talkgroup:" << m_session.selectedTalkgroup()
+             << "TCP peer address for UDP:" << m_tcpSocket->peerAddress().toString();
 
-            qDebug() << "Signal strength from" << callsign << "- RX:" << rxSignal << "SQL:" << rxSqlOpen;
-            emit signalStrengthReceived(callsign, rxSignal, rxSqlOpen);
-            break;
-        }
-        case Svxlink::MsgType::TX_STATUS: {
-            quint8 txState;
-            QByteArray callsignData(20, Qt::Uninitialized);
+    refreshConnectionStatus();
+    emit selectedTalkgroupChanged();
+#if defined(Q_OS_ANDROID)
+    updateServiceSelectedTalkgroup(m_session.selectedTalkgroup());
+#endif
+    qInfo() << "Authenticated! ClientID:" << m_session.clientId();
+    updateNetworkRoundTrip();
 
-            payloadStream >> txState;
-            payloadStream.readRawData(callsignData.data(), 20);
+    // The session has queued NODE_INFO, SELECT_TG, TG_MONITOR and the UDP
+    // heartbeat that registers our port.
+    setupAudio();
+    openUdpAudioSender();
+#if defined(Q_OS_ANDROID)
+    resumeAndroidPttAfterReconnectIfReady();
+#endif
+}
 
-            QString callsign = QString::fromLatin1(callsignData).trimmed();
-            bool isTransmitting = (txState != 0);
+// --- TCP Input ---
 
-            qDebug() << "TX status from" << callsign << ":" << (isTransmitting ? "ON" : "OFF");
-            emit txStatusReceived(callsign, isTransmitting);
-            break;
-        }
-        case Svxlink::MsgType::TALKER_START: {
-            QDataStream testStream(payloadData.mid(sizeof(quint16)));
-            testStream.setByteOrder(QDataStream::BigEndian);
-            bool v2 = false;
-            if (testStream.device()->bytesAvailable() >= static_cast<int>(sizeof(quint32)+sizeof(quint16))) {
-                quint32 tg;
-                quint16 len;
-                testStream >> tg;
-                testStream >> len;
-                if (testStream.device()->bytesAvailable() >= len)
-                    v2 = true;
-            }
-            if (v2)
-                handleTalkerStart(payloadStream);
-            else
-                handleTalkerStartV1(testStream);
-            break;
-        }
-        case Svxlink::MsgType::TALKER_STOP: {
-            QDataStream testStream(payloadData.mid(sizeof(quint16)));
-            testStream.setByteOrder(QDataStream::BigEndian);
-            bool v2 = false;
-            if (testStream.device()->bytesAvailable() >= static_cast<int>(sizeof(quint32)+sizeof(quint16))) {
-                quint32 tg;
-                quint16 len;
-                testStream >> tg;
-                testStream >> len;
-                if (testStream.device()->bytesAvailable() >= len)
-                    v2 = true;
-            }
-            if (v2)
-                handleTalkerStop(payloadStream);
-            else
-                handleTalkerStopV1(testStream);
+void ReflectorClient::onTcpReadyRead()
+{
+    while (m_tcpSocket->bytesAvailable() > 0) {
+        const qint64 chunkBytes = qMin(m_tcpSocket->bytesAvailable(), kTcpReadChunkBytes);
+        const qint64 bytesRead = m_tcpSocket->read(m_session.prepareTcpRead(int(chunkBytes)), chunkBytes);
+        if (bytesRead <= 0) {
             break;
         }
-        default:
-            qWarning() << "Received unhandled TCP message, type:" << messageType
-                       << "Payload size:" << payloadSize
-                       << "Connection state:" << m_state
-                       << "Known types: HEARTBEAT(1), PROTO_VER(5), PROTO_VER_DOWNGRADE(6), AUTH_CHALLENGE(10), AUTH_OK(12), ERROR(13), SERVER_INFO(100), NODE_LIST(101), NODE_JOINED(102), NODE_LEFT(103), TALKER_START(104), TALKER_STOP(105), SELECT_TG(106), TG_MONITOR(107), REQUEST_QSY(109), STATE_EVENT(110), NODE_INFO(111), SIGNAL_STRENGTH(112), TX_STATUS(113)";
-
-            if (payloadSize <= 64) {
-                qDebug() << "Payload hex dump:" << payloadData.toHex(' ');
-            }
-            break;
+        m_session.commitTcpRead(int(bytesRead), sessionNowMs());
+        drainSession();
+        if (m_tcpSocket->state() != QAbstractSocket::ConnectedState) {
+            return;
         }
     }
 }
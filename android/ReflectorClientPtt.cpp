@@ -16,10 +16,8 @@
  */
 
 #include "ReflectorClient.h"
-#include "ReflectorProtocol.h"
 #include <QMetaObject>
 #include <QTimer>
-#include <QtEndian>
 #include <QDebug>
 
 void ReflectorClient::togglePtt()
@@ -83,22 +81,18 @@ void ReflectorClient::startTransmission()
         return;
     }
 
-    if (m_talkgroup == 0) {
-        if (m_defaultTalkgroup == 0) {
-            qWarning() << "PTT pressed while parked in TG 0 but no default talkgroup is configured";
-            return;
-        }
-        selectTalkgroupInternal(m_defaultTalkgroup, TalkgroupSelectionOrigin::TxDefaultActivation);
-    } else {
-        m_usePriorityMode = false;
-        resetTalkgroupSelectionTimer();
+    if (!m_session.beginTransmit(sessionNowMs())) {
+        qWarning() << "PTT pressed while parked in TG 0 but no default talkgroup is configured";
+        return;
     }
+    drainSession();
 
 #if defined(Q_OS_ANDROID)
     QMetaObject::invokeMethod(m_audioEngine, "setupAudioInput", Qt::BlockingQueuedConnection);
 #endif
 
     m_pttActive = true;
+    m_udpAudioSender->setTransmitEnabled(true);
     emit pttActiveChanged();
 
 #if defined(Q_OS_ANDROID)
@@ -113,6 +107,7 @@ void ReflectorClient::startTransmission()
 
     if (!recordingStarted) {
         m_pttActive = false;
+        m_udpAudioSender->setTransmitEnabled(false);
         emit pttActiveChanged();
         qWarning() << "PTT pressed but Android TX capture did not start";
         return;
@@ -215,7 +210,9 @@ void ReflectorClient::beginImmediatePttRelease()
         onTxDrainComplete();
     }
 
-    qInfo() << "PTT Released: Draining remaining TX audio before flush.";
+    qInfo() << "PTT Released: Draining remaining TX audio before flush, including"
+            << m_txProcessingLatencyMs << "ms of limiter look-ahead;"
+            << m_txFrameSizeMs << "ms packets.";
 }
 
 void ReflectorClient::onPttHangTimerTimeout()
@@ -240,6 +237,7 @@ void ReflectorClient::onTxDrainComplete()
 
     if (m_pttActive) {
         m_pttActive = false;
+        m_udpAudioSender->setTransmitEnabled(false);
         emit pttActiveChanged();
     }
 
@@ -295,10 +293,6 @@ void ReflectorClient::resumeAndroidPttAfterReconnectIfReady()
 
 void ReflectorClient::sendTxFlushSamples()
 {
-    QByteArray flush(sizeof(Svxlink::UdpMsgHeader), Qt::Uninitialized);
-    auto* header = reinterpret_cast<Svxlink::UdpMsgHeader*>(flush.data());
-    header->type = qToBigEndian((quint16)Svxlink::UdpMsgType::UDP_FLUSH_SAMPLES);
-    header->clientId = qToBigEndian((quint16)m_clientId);
-    header->sequenceNum = qToBigEndian(m_udpSequence++);
-    sendUdpMessage(flush);
+    m_session.sendFlushSamples();
+    drainSession();
 }
@@ -20,15 +20,20 @@
 #include <QDebug>
 #include <QMetaObject>
 #include <QRandomGenerator>
+#include <cstdlib>
 #include <iterator>
 
+#if defined(__linux__)
+#  include <netinet/in.h>
+#  include <netinet/tcp.h>
+#  include <sys/socket.h>
+#endif
+
 namespace {
 constexpr int kReconnectBackoffScheduleMs[] = {0, 1000, 2000, 5000, 10000, 15000, 30000};
-constexpr int kHeartbeatMissThreshold = 3;
-constexpr int kMinimumLivenessTimeoutMs = 15000;
-constexpr int kMaximumLivenessTimeoutMs = 120000;
-constexpr int kMaxRecentHeartbeatIntervals = 5;
 constexpr int kAndroidNetworkReasonInitial = 1;
+// Round-trip changes smaller than this are not worth passing on.
+constexpr int kRoundTripReportStepMs = 10;
 }
 
 bool ReflectorClient::resolveReconnectContext(ReconnectContext &context)
@@ -37,7 +42,7 @@ bool ReflectorClient::resolveReconnectContext(ReconnectContext &context)
     context.port = m_port;
     context.authKey = m_authKey;
     context.callsign = m_callsign;
-    context.talkgroup = m_talkgroup;
+    context.talkgroup = m_session.selectedTalkgroup();
     context.monitoredTalkgroups = m_monitoredTalkgroupsSpec;
     context.tgSelectTimeoutSeconds = m_tgSelectTimeoutSeconds;
 
@@ -73,12 +78,10 @@ void ReflectorClient::transitionToDisconnectedState(const QString &status, bool
 
     if (m_pttActive) {
         m_pttActive = false;
+        m_udpAudioSender->setTransmitEnabled(false);
         emit pttActiveChanged();
     }
 
-    if (m_heartbeatTimer) {
-        m_heartbeatTimer->stop();
-    }
     if (m_txTimer) {
         const bool txStateChanged = m_txTimer->isActive() || m_txSeconds != 0;
         m_txTimer->stop();
@@ -98,9 +101,15 @@ void ReflectorClient::transitionToDisconnectedState(const QString &status, bool
         m_audioTimeoutTimer->stop();
     }
 
-    m_lastAudioSeq = 0;
-    m_tcpBuffer.clear();
+    // Stops the heartbeats, the watchdog and the selection countdown and
+    // drops anything still queued for the old connection.
+    m_session.close();
+    m_sessionTimer->stop();
+    m_sessionTimerDeadlineMs = -1;
+    stopUdpReceiveThread();
+    closeUdpAudioSender();
     m_udpSocket->close();
+    m_udpPeerAddress.clear();
 
     if (!m_currentTalker.isEmpty()) {
         m_currentTalker.clear();
@@ -108,8 +117,6 @@ void ReflectorClient::transitionToDisconnectedState(const QString &status, bool
     }
     setReceivingAudioState(false);
     resetAudioMeters();
-    stopTalkgroupSelectionTimer();
-    m_usePriorityMode = true;
 
     if (!m_currentTalkerName.isEmpty()) {
         m_currentTalkerName.clear();
@@ -133,10 +140,6 @@ void ReflectorClient::transitionToDisconnectedState(const QString &status, bool
 #endif
     }
 
-    m_clientId = 0;
-    m_udpSequence = 0;
-    resetProtocolLivenessWatchdog();
-
     const State previousState = m_state;
     const QString previousStatus = m_connectionStatus;
     m_state = Disconnected;
@@ -295,68 +298,6 @@ void ReflectorClient::onReconnectBackoffTimeout()
                     reconnectContext.tgSelectTimeoutSeconds);
 }
 
-void ReflectorClient::resetProtocolLivenessWatchdog()
-{
-    if (m_protocolLivenessTimer) {
-        m_protocolLivenessTimer->stop();
-    }
-    m_protocolHeartbeatClock.invalidate();
-    m_lastInboundHeartbeatMs = -1;
-    m_recentInboundHeartbeatIntervals.clear();
-}
-
-void ReflectorClient::noteInboundProtocolHeartbeat()
-{
-    if (m_state != Connected) {
-        return;
-    }
-
-    if (!m_protocolHeartbeatClock.isValid()) {
-        m_protocolHeartbeatClock.start();
-        m_lastInboundHeartbeatMs = 0;
-        return;
-    }
-
-    const qint64 nowMs = m_protocolHeartbeatClock.elapsed();
-    if (m_lastInboundHeartbeatMs >= 0) {
-        const qint64 intervalMs = nowMs - m_lastInboundHeartbeatMs;
-        if (intervalMs > 0) {
-            m_recentInboundHeartbeatIntervals.append(intervalMs);
-            while (m_recentInboundHeartbeatIntervals.size() > kMaxRecentHeartbeatIntervals) {
-                m_recentInboundHeartbeatIntervals.removeFirst();
-            }
-        }
-    }
-    m_lastInboundHeartbeatMs = nowMs;
-
-    const int timeoutMs = protocolLivenessTimeoutMs();
-    if (timeoutMs > 0) {
-        m_protocolLivenessTimer->start(timeoutMs);
-    }
-}
-
-int ReflectorClient::protocolLivenessTimeoutMs() const
-{
-    if (m_recentInboundHeartbeatIntervals.isEmpty()) {
-        return 0;
-    }
-
-    qint64 longestObservedInterval = 0;
-    for (qint64 intervalMs : m_recentInboundHeartbeatIntervals) {
-        longestObservedInterval = qMax(longestObservedInterval, intervalMs);
-    }
-
-    if (longestObservedInterval <= 0) {
-        return 0;
-    }
-
-    const qint64 timeoutMs = qMax<qint64>(
-            static_cast<qint64>(kMinimumLivenessTimeoutMs),
-            qMin<qint64>(longestObservedInterval * kHeartbeatMissThreshold,
-                         static_cast<qint64>(kMaximumLivenessTimeoutMs)));
-    return static_cast<int>(timeoutMs);
-}
-
 void ReflectorClient::onProtocolLivenessTimeout()
 {
     if (m_state != Connected && m_state != Authenticating && m_state != Connecting) {
@@ -383,6 +324,37 @@ void ReflectorClient::onProtocolLivenessTimeout()
     scheduleReconnectAttempt(QStringLiteral("protocol heartbeat watchdog"), true);
 }
 
+void ReflectorClient::updateNetworkRoundTrip()
+{
+    int roundTripMs = -1;
+#if defined(__linux__)
+    // The kernel already keeps a smoothed RTT for the control connection;
+    // the reflector protocol has no echo to time.
+    const qintptr descriptor = m_tcpSocket ? m_tcpSocket->socketDescriptor() : -1;
+    if (descriptor >= 0) {
+        tcp_info info{};
+        socklen_t length = sizeof(info);
+        if (::getsockopt(static_cast<int>(descriptor), IPPROTO_TCP, TCP_INFO, &info, &length) == 0
+                && info.tcpi_rtt > 0) {
+            roundTripMs = static_cast<int>(info.tcpi_rtt / 1000U);
+        }
+    }
+#endif
+
+    if ((roundTripMs < 0) == (m_networkRoundTripMs < 0)
+            && std::abs(roundTripMs - m_networkRoundTripMs) < kRoundTripReportStepMs) {
+        return;
+    }
+    m_networkRoundTripMs = roundTripMs;
+
+    // High round trips get longer TX packets when packetization is automatic.
+    if (m_audioEngine) {
+        QMetaObject::invokeMethod(m_audioEngine, "setNetworkRoundTripMs",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(int, m_networkRoundTripMs));
+    }
+}
+
 void ReflectorClient::handleAndroidNetworkStateChanged(int generation,
                                                        int reason,
                                                        bool hasDefaultNetwork,
@@ -403,6 +375,14 @@ void ReflectorClient::handleAndroidNetworkStateChanged(int generation,
     m_androidNetworkCaptivePortal = captivePortal;
     m_lastAndroidNetworkGeneration = generation;
 
+    // Metered and cellular links get a leaner TX encoder profile.
+    if (m_audioEngine) {
+        QMetaObject::invokeMethod(m_audioEngine, "setNetworkTransport",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(int, transport),
+                                  Q_ARG(bool, metered));
+    }
+
     const bool validatedNetworkAvailable = hasDefaultNetwork && validated && !captivePortal;
     if (!validatedNetworkAvailable) {
         const bool socketActive = m_tcpSocket
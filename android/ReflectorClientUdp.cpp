@@ -17,11 +17,13 @@
 
 #include "ReflectorClient.h"
 #include "ReflectorProtocol.h"
-#include <QDataStream>
+#include "ReflectorCodec.h"
 #include <QtEndian>
 #include <QHostAddress>
 #include <QDebug>
 #include <QMetaObject>
+#include <QThread>
+#include <chrono>
 
 namespace {
 QString udpMessageTypeName(quint16 messageType)
@@ -42,6 +44,15 @@ QString udpMessageTypeName(quint16 messageType)
     }
 }
 
+// Receive indicator drops after this long without audio.
+constexpr qint64 kUdpAudioTimeoutMs = 3000;
+
+qint64 steadyNowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 bool shouldLogInboundUdpMessage(quint16 messageType)
 {
     return messageType != Svxlink::UdpMsgType::UDP_HEARTBEAT
@@ -60,94 +71,145 @@ quint16 datagramMessageType(const QByteArray &datagram)
         return 0;
     }
 
-    const auto *header = reinterpret_cast<const Svxlink::UdpMsgHeader*>(datagram.constData());
-    return qFromBigEndian(header->type);
+    return Svxlink::Codec::loadU16(datagram.constData());
 }
 }
 
 void ReflectorClient::onUdpReadyRead()
 {
+    // The receive thread owns reading while it runs.
+    if (m_udpReceiveThread && m_udpReceiveThread->isRunning()) {
+        return;
+    }
+
     while (m_udpSocket->hasPendingDatagrams()) {
-        QByteArray datagram;
-        datagram.resize(m_udpSocket->pendingDatagramSize());
-        m_udpSocket->readDatagram(datagram.data(), datagram.size());
+        const qint64 pendingSize = m_udpSocket->pendingDatagramSize();
+        if (pendingSize > m_udpReceiveBuffer.size()) {
+            m_udpReceiveBuffer.resize(pendingSize);
+        }
+        const qint64 datagramSize = m_udpSocket->readDatagram(m_udpReceiveBuffer.data(),
+                                                              m_udpReceiveBuffer.size());
+        // Stamped here rather than on the audio thread so queueing delay there
+        // does not show up as network jitter.
+        processUdpDatagram(m_udpReceiveBuffer.constData(), datagramSize, steadyNowUs());
+    }
+}
 
-        const auto* header = reinterpret_cast<const Svxlink::UdpMsgHeader*>(datagram.constData());
+void ReflectorClient::processUdpDatagram(const char* data, qint64 datagramSize, qint64 arrivalUs)
+{
+    if (datagramSize < static_cast<qint64>(sizeof(Svxlink::UdpMsgHeader))) {
+        return;
+    }
 
-        uint16_t messageType = qFromBigEndian(header->type);
-        if (shouldLogInboundUdpMessage(messageType)) {
-            qDebug() << "ReflectorClient::onUdpReadyRead - Processing"
-                     << udpMessageTypeName(messageType);
-        }
+    const uint16_t messageType = Svxlink::Codec::loadU16(data);
+    if (shouldLogInboundUdpMessage(messageType)) {
+        qDebug() << "ReflectorClient::onUdpReadyRead - Processing"
+                 << udpMessageTypeName(messageType);
+    }
 
-        switch (messageType) {
-        case Svxlink::UdpMsgType::UDP_HEARTBEAT: {
-            break;
-        }
-        case Svxlink::UdpMsgType::UDP_AUDIO: {
-            const auto* msg = static_cast<const Svxlink::MsgUdpAudio*>(header);
-            quint16 seq = qFromBigEndian(header->sequenceNum);
-            int opusDataLen = qFromBigEndian(msg->audioLen);
-
-            if (m_audioEngine && opusDataLen > 0) {
-                QByteArray audioData(reinterpret_cast<const char*>(msg->audioData), opusDataLen);
-                QMetaObject::invokeMethod(m_audioEngine, "processReceivedAudio", Qt::QueuedConnection,
-                                          Q_ARG(QByteArray, audioData), Q_ARG(quint16, seq));
-
-                if (!m_isReceivingAudio) {
-                    setReceivingAudioState(true);
+    m_session.receiveDatagram(data, static_cast<int>(datagramSize), sessionNowMs());
+    drainSession(arrivalUs);
+}
+
+void ReflectorClient::noteUdpAudioActivity(qint64 arrivalUs)
+{
+    // Called per packet from whichever thread reads the socket; only the
+    // first packet of a stream touches the GUI-thread receive indicator.
+    m_lastUdpAudioArrivalUs.store(arrivalUs, std::memory_order_relaxed);
+    if (m_udpAudioActive.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    if (QThread::currentThread() == thread()) {
+        onUdpAudioStarted();
+    } else {
+        QMetaObject::invokeMethod(this, &ReflectorClient::onUdpAudioStarted, Qt::QueuedConnection);
+    }
+}
+
+void ReflectorClient::onUdpAudioStarted()
+{
+    if (!m_isReceivingAudio) {
+        setReceivingAudioState(true);
+    }
+    m_audioTimeoutTimer->start(kUdpAudioTimeoutMs);
+}
+
+void ReflectorClient::onUdpFlushReceived()
+{
+    if (m_isReceivingAudio) {
+        setReceivingAudioState(false);
+    }
+}
+
+void ReflectorClient::onUdpAudioTimeout()
+{
+    // The timer is not restarted per packet; re-arm it for whatever is left
+    // of the timeout after the most recent one.
+    const qint64 idleMs = (steadyNowUs() - m_lastUdpAudioArrivalUs.load(std::memory_order_relaxed)) / 1000;
+    if (m_isReceivingAudio && idleMs < kUdpAudioTimeoutMs) {
+        m_audioTimeoutTimer->start(static_cast<int>(kUdpAudioTimeoutMs - idleMs));
+        return;
+    }
+
+    if (m_isReceivingAudio) {
+        qDebug() << "Audio timeout - stopping receive indicator";
+        setReceivingAudioState(false);
+    }
+}
+
+void ReflectorClient::startUdpReceiveThread()
+{
+    if (!m_udpReceiveThreadEnabled || !UdpReceiveThread::isSupported()
+            || m_udpSocket->state() != QAbstractSocket::BoundState) {
+        return;
+    }
+    if (m_udpReceiveThread && m_udpReceiveThread->isRunning()) {
+        return;
+    }
+
+    if (!m_udpReceiveThread) {
+        m_udpReceiveThread = std::make_unique<UdpReceiveThread>(
+            [this](const unsigned char* payload, int size, uint16_t sequence, int64_t arrivalUs) {
+                if (m_audioEngine) {
+                    m_audioEngine->enqueueReceivedAudio(payload, size, sequence, arrivalUs);
+                    noteUdpAudioActivity(arrivalUs);
+                }
+            },
+            [this](const unsigned char* datagram, int size, int64_t arrivalUs) {
+                // The flush goes into the engine queue from here, in stream
+                // order with the audio; only the indicator is left to the GUI.
+                if (Svxlink::Codec::loadU16(reinterpret_cast<const char*>(datagram))
+                        == Svxlink::UdpMsgType::UDP_FLUSH_SAMPLES) {
+                    if (m_audioEngine) {
+                        m_audioEngine->enqueueReceivedFlush();
+                    }
+                    QMetaObject::invokeMethod(this, &ReflectorClient::onUdpFlushReceived, Qt::QueuedConnection);
+                    return;
                 }
-                m_audioTimeoutTimer->start();
-            }
 
-            m_lastAudioSeq = seq;
-            break;
-        }
-        case Svxlink::UdpMsgType::UDP_FLUSH_SAMPLES:
-            m_lastAudioSeq = 0;
-            if (m_audioEngine) {
-                QMetaObject::invokeMethod(m_audioEngine, "flushAudioBuffers", Qt::QueuedConnection);
-            }
-            if (m_isReceivingAudio) {
-                setReceivingAudioState(false);
-            }
-            break;
-        case Svxlink::UdpMsgType::UDP_ALL_SAMPLES_FLUSHED:
-            qDebug() << "Received UDP all samples flushed";
-            if (m_audioEngine) {
-                QMetaObject::invokeMethod(m_audioEngine, "allSamplesFlushed", Qt::QueuedConnection);
-            }
-            break;
-        case Svxlink::UdpMsgType::UDP_SIGNAL_STRENGTH: {
-            const auto* msg = static_cast<const Svxlink::MsgUdpSignalStrength*>(header);
-            float rxSignal = msg->rx_signal_strength;
-            float rxSqlOpen = msg->rx_sql_open;
-
-            QByteArray callsignData(msg->callsign, 20);
-            QString callsign = QString::fromLatin1(callsignData).trimmed();
-
-            qDebug() << "UDP Signal strength from" << callsign << "- RX:" << rxSignal << "SQL:" << rxSqlOpen;
-            emit signalStrengthReceived(callsign, rxSignal, rxSqlOpen);
-            break;
-        }
-        default:
-            qWarning() << "Received unhandled UDP message, type:" << messageType
-                       << "Known UDP types: UDP_HEARTBEAT(1), UDP_AUDIO(101), UDP_FLUSH_SAMPLES(102), UDP_ALL_SAMPLES_FLUSHED(103), UDP_SIGNAL_STRENGTH(104)";
-            break;
-        }
+                // Signal reports and the rest are rare; copy them to the GUI thread.
+                const QByteArray message(reinterpret_cast<const char*>(datagram), size);
+                QMetaObject::invokeMethod(this, [this, message, arrivalUs]() {
+                    processUdpDatagram(message.constData(), message.size(), arrivalUs);
+                }, Qt::QueuedConnection);
+            });
     }
+
+    const bool started = m_udpReceiveThread->start(m_udpSocket->socketDescriptor());
+    qDebug() << "ReflectorClient::startUdpReceiveThread - started:" << started;
 }
 
-void ReflectorClient::onHeartbeatTimer()
+void ReflectorClient::stopUdpReceiveThread()
 {
-    if (m_state == Connected) {
-        sendHeartbeat();
-        QByteArray datagram(sizeof(Svxlink::UdpMsgHeader), Qt::Uninitialized);
-        auto* udpBeat = reinterpret_cast<Svxlink::UdpMsgHeader*>(datagram.data());
-        udpBeat->type = qToBigEndian((quint16)Svxlink::UdpMsgType::UDP_HEARTBEAT);
-        udpBeat->clientId = qToBigEndian((quint16)m_clientId);
-        udpBeat->sequenceNum = qToBigEndian(m_udpSequence++);
-        sendUdpMessage(datagram);
+    if (m_udpReceiveThread && m_udpReceiveThread->isRunning()) {
+        m_udpReceiveThread->stop();
+        qDebug() << "ReflectorClient::stopUdpReceiveThread - stopped after"
+                 << m_udpReceiveThread->datagramsReceived() << "datagrams in"
+                 << m_udpReceiveThread->batchesReceived() << "batches";
+        // Anything that queued up meanwhile is read on the GUI thread again.
+        if (m_udpSocket->state() == QAbstractSocket::BoundState) {
+            QMetaObject::invokeMethod(this, &ReflectorClient::onUdpReadyRead, Qt::QueuedConnection);
+        }
     }
 }
 
@@ -158,45 +220,75 @@ void ReflectorClient::onAudioDataEncoded(const QByteArray &encodedData)
         return;
     }
 
-    QByteArray datagram(sizeof(Svxlink::UdpMsgHeader) + sizeof(quint16) + encodedData.size(), Qt::Uninitialized);
-    QDataStream ds(&datagram, QIODevice::WriteOnly);
-    ds.setByteOrder(QDataStream::BigEndian);
-    ds << (quint16)Svxlink::UdpMsgType::UDP_AUDIO
-       << (quint16)m_clientId
-       << (quint16)m_udpSequence++
-       << (quint16)encodedData.size();
-    ds.writeRawData(encodedData.constData(), encodedData.size());
-    sendUdpMessage(datagram);
+    // Only used when the audio thread cannot send itself; see UdpAudioSender.
+    m_session.sendAudio(encodedData.constData(), int(encodedData.size()));
+    drainSession();
 }
 
 void ReflectorClient::sendUdpMessage(const QByteArray &datagram)
 {
     const quint16 messageType = datagramMessageType(datagram);
-    const QString typeName = udpMessageTypeName(messageType);
 
     if (m_udpSocket->state() == QAbstractSocket::BoundState) {
-        QHostAddress addr = m_tcpSocket->peerAddress();
-
-        if (!addr.isNull()) {
-            qint64 bytesWritten = m_udpSocket->writeDatagram(datagram, addr, m_port);
+        if (!m_udpPeerAddress.isNull()) {
+            qint64 bytesWritten = m_udpSocket->writeDatagram(datagram, m_udpPeerAddress, m_port);
             if (bytesWritten < 0) {
-                qWarning() << "ReflectorClient::sendUdpMessage - Failed to send" << typeName
-                           << "to" << addr.toString() << ":" << m_port
+                qWarning() << "ReflectorClient::sendUdpMessage - Failed to send" << udpMessageTypeName(messageType)
+                           << "to" << m_udpPeerAddress.toString() << ":" << m_port
                            << "error:" << m_udpSocket->errorString();
             } else if (shouldLogOutboundUdpMessage(messageType)) {
-                qDebug() << "ReflectorClient::sendUdpMessage - Sent" << typeName
+                qDebug() << "ReflectorClient::sendUdpMessage - Sent" << udpMessageTypeName(messageType)
                          << "bytes:" << bytesWritten
-                         << "to" << addr.toString() << ":" << m_port;
+                         << "to" << m_udpPeerAddress.toString() << ":" << m_port;
             }
         } else {
             qWarning() << "ReflectorClient::sendUdpMessage - No valid TCP peer address available"
-                       << "for" << typeName
+                       << "for" << udpMessageTypeName(messageType)
                        << "TCP socket state:" << m_tcpSocket->state()
                        << "TCP socket peer:" << m_tcpSocket->peerName()
                        << "Host was:" << m_host;
         }
     } else {
-        qWarning() << "ReflectorClient::sendUdpMessage - UDP socket not bound for" << typeName
+        qWarning() << "ReflectorClient::sendUdpMessage - UDP socket not bound for" << udpMessageTypeName(messageType)
                    << "state:" << m_udpSocket->state();
     }
 }
+
+void ReflectorClient::openUdpAudioSender()
+{
+    if (!UdpAudioSender::isSupported()
+            || m_udpSocket->state() != QAbstractSocket::BoundState
+            || m_udpPeerAddress.isNull()) {
+        return;
+    }
+
+    // The socket is bound to AnyIPv4, so IPv4-mapped peers are sent to as IPv4.
+    bool isIpv4 = false;
+    const quint32 ipv4Address = m_udpPeerAddress.toIPv4Address(&isIpv4);
+    bool opened = false;
+    if (isIpv4) {
+        const quint32 networkOrder = qToBigEndian(ipv4Address);
+        opened = m_udpAudioSender->open(m_udpSocket->socketDescriptor(),
+                                        reinterpret_cast<const uint8_t*>(&networkOrder), sizeof(networkOrder),
+                                        static_cast<uint16_t>(m_port), m_session.clientId());
+    } else {
+        const Q_IPV6ADDR ipv6Address = m_udpPeerAddress.toIPv6Address();
+        opened = m_udpAudioSender->open(m_udpSocket->socketDescriptor(), ipv6Address.c, sizeof(ipv6Address.c),
+                                        static_cast<uint16_t>(m_port), m_session.clientId());
+    }
+    m_udpAudioSender->setTransmitEnabled(m_pttActive);
+    qDebug() << "ReflectorClient::openUdpAudioSender - audio thread sends TX audio:" << opened
+             << "to" << m_udpPeerAddress.toString() << ":" << m_port;
+}
+
+void ReflectorClient::closeUdpAudioSender()
+{
+    if (!m_udpAudioSender->isOpen()) {
+        return;
+    }
+    m_udpAudioSender->close();
+    qDebug() << "ReflectorClient::closeUdpAudioSender - sent"
+             << m_udpAudioSender->datagramsSent() << "audio datagrams in"
+             << m_udpAudioSender->batchesSent() << "batches,"
+             << m_udpAudioSender->sendErrors() << "send errors";
+}
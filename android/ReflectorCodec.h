@@ -0,0 +1,485 @@
+/*
+ * Copyright (C) 2025 Silviu YO6SAY
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef REFLECTORCODEC_H
+#define REFLECTORCODEC_H
+
+#include "ReflectorProtocol.h"
+#include "TcpFrameReader.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+// Wire descriptions of every Svxlink reflector message, from which the
+// compiler generates big-endian encoders and validating decoders.
+//
+// A message is its type plus a list of field codecs, e.g.
+//
+//     using SelectTg = Message<MsgType::SELECT_TG, U32>;
+//     SelectTg::encodeFrame(buffer, capacity, talkgroup);
+//     SelectTg::decodeFields(payload, talkgroup);
+//
+// Encoding writes straight into a caller-owned buffer, with the TCP length
+// prefix filled in place, and allocates nothing.  Decoding hands out
+// strings and byte fields as PayloadReader views into the received bytes
+// and fails, rather than reading on, when a field runs past the end.
+// Trailing bytes after the described fields are ignored so newer servers
+// can extend a message.
+//
+// Header-only and Qt-free so the Android and iOS clients and the test
+// tools share one description of the protocol.
+namespace Svxlink {
+namespace Codec {
+
+inline void storeU16(char* out, uint16_t value)
+{
+    out[0] = static_cast<char>(value >> 8);
+    out[1] = static_cast<char>(value);
+}
+
+inline void storeU32(char* out, uint32_t value)
+{
+    out[0] = static_cast<char>(value >> 24);
+    out[1] = static_cast<char>(value >> 16);
+    out[2] = static_cast<char>(value >> 8);
+    out[3] = static_cast<char>(value);
+}
+
+inline uint16_t loadU16(const char* in)
+{
+    return static_cast<uint16_t>((static_cast<uint8_t>(in[0]) << 8) | static_cast<uint8_t>(in[1]));
+}
+
+// Bytes to encode; the caller keeps them alive for the call.
+struct Bytes {
+    const char* data = nullptr;
+    int size = 0;
+};
+
+template <typename Container>
+Bytes bytesOf(const Container& container)
+{
+    return {reinterpret_cast<const char*>(container.data()), static_cast<int>(container.size())};
+}
+
+// Elements to encode; the caller keeps them alive for the call.
+template <typename T>
+struct Span {
+    const T* data = nullptr;
+    int size = 0;
+};
+
+template <typename Container>
+Span<typename Container::value_type> spanOf(const Container& container)
+{
+    return {container.data(), static_cast<int>(container.size())};
+}
+
+// --- Field codecs ---
+//
+// Each one names the value it encodes from and decodes into, its smallest
+// encoded size, the encoded size of a value (-1 if the value cannot be
+// represented), and how to write and read it.
+
+template <typename T>
+struct Scalar {
+    using EncodeValue = T;
+    using DecodeValue = T;
+    static constexpr int MIN_BYTES = sizeof(T);
+
+    static constexpr int size(EncodeValue) { return MIN_BYTES; }
+
+    static char* write(char* out, EncodeValue value)
+    {
+        if constexpr (sizeof(T) == 1) {
+            *out = static_cast<char>(value);
+        } else if constexpr (sizeof(T) == 2) {
+            storeU16(out, value);
+        } else {
+            storeU32(out, value);
+        }
+        return out + MIN_BYTES;
+    }
+
+    static void read(PayloadReader& in, DecodeValue& value)
+    {
+        if constexpr (sizeof(T) == 1) {
+            value = in.readU8();
+        } else if constexpr (sizeof(T) == 2) {
+            value = in.readU16();
+        } else {
+            value = in.readU32();
+        }
+    }
+};
+
+using U8 = Scalar<uint8_t>;
+using U16 = Scalar<uint16_t>;
+using U32 = Scalar<uint32_t>;
+
+// IEEE 754 single precision, sent as its 32-bit pattern.
+struct F32 {
+    using EncodeValue = float;
+    using DecodeValue = float;
+    static constexpr int MIN_BYTES = 4;
+
+    static constexpr int size(EncodeValue) { return MIN_BYTES; }
+
+    static char* write(char* out, EncodeValue value)
+    {
+        uint32_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        storeU32(out, bits);
+        return out + MIN_BYTES;
+    }
+
+    static void read(PayloadReader& in, DecodeValue& value) { value = in.readFloat(); }
+};
+
+// A 16-bit length followed by that many bytes.
+struct Str16 {
+    using EncodeValue = Bytes;
+    using DecodeValue = PayloadReader;
+    static constexpr int MIN_BYTES = 2;
+
+    static constexpr int size(const EncodeValue& value)
+    {
+        return value.size >= 0 && value.size <= 0xffff ? MIN_BYTES + value.size : -1;
+    }
+
+    static char* write(char* out, const EncodeValue& value)
+    {
+        storeU16(out, static_cast<uint16_t>(value.size));
+        if (value.size > 0) {
+            std::memcpy(out + MIN_BYTES, value.data, static_cast<size_t>(value.size));
+        }
+        return out + MIN_BYTES + value.size;
+    }
+
+    static void read(PayloadReader& in, DecodeValue& value) { value = in.readLengthPrefixed(); }
+};
+
+// Exactly N bytes; shorter values are NUL-padded, longer ones truncated.
+template <int N>
+struct Fixed {
+    using EncodeValue = Bytes;
+    using DecodeValue = PayloadReader;
+    static constexpr int MIN_BYTES = N;
+
+    static constexpr int size(const EncodeValue&) { return N; }
+
+    static char* write(char* out, const EncodeValue& value)
+    {
+        const int copied = value.size < N ? (value.size > 0 ? value.size : 0) : N;
+        if (copied > 0) {
+            std::memcpy(out, value.data, static_cast<size_t>(copied));
+        }
+        std::memset(out + copied, 0, static_cast<size_t>(N - copied));
+        return out + N;
+    }
+
+    static void read(PayloadReader& in, DecodeValue& value) { value = in.readBytes(N); }
+};
+
+// A 16-bit count followed by that many elements.  Decoding checks every
+// element fits and then hands out a view to walk them with next().
+template <typename Element>
+struct Array16 {
+    struct View {
+        int count = 0;
+        PayloadReader elements;
+
+        bool next(typename Element::DecodeValue& value)
+        {
+            if (count <= 0) {
+                return false;
+            }
+            --count;
+            Element::read(elements, value);
+            return elements.ok();
+        }
+    };
+
+    using EncodeValue = Span<typename Element::EncodeValue>;
+    using DecodeValue = View;
+    static constexpr int MIN_BYTES = 2;
+
+    static int size(const EncodeValue& value)
+    {
+        if (value.size < 0 || value.size > 0xffff) {
+            return -1;
+        }
+        int total = MIN_BYTES;
+        for (int i = 0; i < value.size; ++i) {
+            const int elementBytes = Element::size(value.data[i]);
+            if (elementBytes < 0) {
+                return -1;
+            }
+            total += elementBytes;
+        }
+        return total;
+    }
+
+    static char* write(char* out, const EncodeValue& value)
+    {
+        storeU16(out, static_cast<uint16_t>(value.size));
+        out += MIN_BYTES;
+        for (int i = 0; i < value.size; ++i) {
+            out = Element::write(out, value.data[i]);
+        }
+        return out;
+    }
+
+    static void read(PayloadReader& in, DecodeValue& value)
+    {
+        value = View();
+        const int count = in.readU16();
+        PayloadReader walk = in;
+        typename Element::DecodeValue element{};
+        for (int i = 0; i < count && walk.ok(); ++i) {
+            Element::read(walk, element);
+        }
+        if (!walk.ok()) {
+            // Leaves in failed, as a direct read past the end would.
+            in = walk;
+            return;
+        }
+        value.count = count;
+        value.elements = in.readBytes(in.remaining() - walk.remaining());
+    }
+};
+
+// N 16-bit lengths, then the N strings they measure (STATE_EVENT).
+template <int N>
+struct Strings16 {
+    using EncodeValue = std::array<Bytes, N>;
+    using DecodeValue = std::array<PayloadReader, N>;
+    static constexpr int MIN_BYTES = 2 * N;
+
+    static constexpr int size(const EncodeValue& value)
+    {
+        int total = MIN_BYTES;
+        for (const Bytes& string : value) {
+            if (string.size < 0 || string.size > 0xffff) {
+                return -1;
+            }
+            total += string.size;
+        }
+        return total;
+    }
+
+    static char* write(char* out, const EncodeValue& value)
+    {
+        for (const Bytes& string : value) {
+            storeU16(out, static_cast<uint16_t>(string.size));
+            out += 2;
+        }
+        for (const Bytes& string : value) {
+            if (string.size > 0) {
+                std::memcpy(out, string.data, static_cast<size_t>(string.size));
+            }
+            out += string.size;
+        }
+        return out;
+    }
+
+    static void read(PayloadReader& in, DecodeValue& value)
+    {
+        std::array<int, N> lengths{};
+        for (int& length : lengths) {
+            length = in.readU16();
+        }
+        for (int i = 0; i < N; ++i) {
+            value[static_cast<size_t>(i)] = in.readBytes(lengths[static_cast<size_t>(i)]);
+        }
+    }
+};
+
+template <typename... Fields>
+int fieldsSize(const typename Fields::EncodeValue&... values)
+{
+    const int sizes[] = {0, Fields::size(values)...};
+    int total = 0;
+    for (int size : sizes) {
+        if (size < 0) {
+            return -1;
+        }
+        total += size;
+    }
+    return total;
+}
+
+// --- Messages ---
+
+// A TCP message: its 16-bit type, then the fields, inside a frame with a
+// 32-bit length prefix.
+template <uint16_t Type, typename... Fields>
+struct Message {
+    static constexpr uint16_t TYPE = Type;
+    static constexpr int LENGTH_PREFIX_BYTES = 4;
+    static constexpr int MIN_PAYLOAD_BYTES = (2 + ... + Fields::MIN_BYTES);
+
+    // Payload bytes for these values, or -1 if one cannot be represented.
+    static int payloadSize(const typename Fields::EncodeValue&... values)
+    {
+        const int fieldBytes = fieldsSize<Fields...>(values...);
+        return fieldBytes < 0 ? -1 : 2 + fieldBytes;
+    }
+
+    static int frameSize(const typename Fields::EncodeValue&... values)
+    {
+        const int payloadBytes = payloadSize(values...);
+        return payloadBytes < 0 ? -1 : LENGTH_PREFIX_BYTES + payloadBytes;
+    }
+
+    // Writes the payload alone; returns its size, or 0 if it does not fit.
+    static int encode(char* out, int capacity, const typename Fields::EncodeValue&... values)
+    {
+        const int payloadBytes = payloadSize(values...);
+        if (out == nullptr || payloadBytes < 0 || payloadBytes > capacity) {
+            return 0;
+        }
+        storeU16(out, Type);
+        char* next = out + 2;
+        ((next = Fields::write(next, values)), ...);
+        (void)next;
+        return payloadBytes;
+    }
+
+    // Writes the whole frame, length prefix included; returns its size, or
+    // 0 if it does not fit.
+    static int encodeFrame(char* out, int capacity, const typename Fields::EncodeValue&... values)
+    {
+        if (out == nullptr || capacity < LENGTH_PREFIX_BYTES) {
+            return 0;
+        }
+        const int payloadBytes = encode(out + LENGTH_PREFIX_BYTES, capacity - LENGTH_PREFIX_BYTES, values...);
+        if (payloadBytes == 0) {
+            return 0;
+        }
+        storeU32(out, static_cast<uint32_t>(payloadBytes));
+        return LENGTH_PREFIX_BYTES + payloadBytes;
+    }
+
+    // Reads the fields that follow an already consumed type.
+    static bool decodeFields(PayloadReader& payload, typename Fields::DecodeValue&... values)
+    {
+        (Fields::read(payload, values), ...);
+        return payload.ok();
+    }
+
+    static bool decode(PayloadReader payload, typename Fields::DecodeValue&... values)
+    {
+        return payload.readU16() == Type && payload.ok() && decodeFields(payload, values...);
+    }
+};
+
+// A UDP message: type, client ID and sequence number, then the fields.
+template <uint16_t Type, typename... Fields>
+struct UdpMessage {
+    static constexpr uint16_t TYPE = Type;
+    static constexpr int HEADER_BYTES = 6;
+    static constexpr int MIN_BYTES = (HEADER_BYTES + ... + Fields::MIN_BYTES);
+
+    // Datagram bytes for these values, or -1 if one cannot be represented.
+    static int size(const typename Fields::EncodeValue&... values)
+    {
+        const int fieldBytes = fieldsSize<Fields...>(values...);
+        return fieldBytes < 0 ? -1 : HEADER_BYTES + fieldBytes;
+    }
+
+    // Returns the datagram size, or 0 if it does not fit.
+    static int encode(char* out, int capacity, uint16_t clientId, uint16_t sequence,
+                      const typename Fields::EncodeValue&... values)
+    {
+        const int datagramBytes = size(values...);
+        if (out == nullptr || datagramBytes < 0 || datagramBytes > capacity) {
+            return 0;
+        }
+        storeU16(out, Type);
+        storeU16(out + 2, clientId);
+        storeU16(out + 4, sequence);
+        char* next = out + HEADER_BYTES;
+        ((next = Fields::write(next, values)), ...);
+        (void)next;
+        return datagramBytes;
+    }
+
+    static bool decode(PayloadReader datagram, uint16_t& clientId, uint16_t& sequence,
+                       typename Fields::DecodeValue&... values)
+    {
+        if (datagram.readU16() != Type || !datagram.ok()) {
+            return false;
+        }
+        clientId = datagram.readU16();
+        sequence = datagram.readU16();
+        (Fields::read(datagram, values), ...);
+        return datagram.ok();
+    }
+};
+
+using StringList = Array16<Str16>;
+using TalkgroupList = Array16<U32>;
+using CallsignField = Fixed<Protocol::CALLSIGN_LEN>;
+
+using Heartbeat         = Message<MsgType::HEARTBEAT>;
+using ProtoVer          = Message<MsgType::PROTO_VER, U16, U16>;                  // major, minor
+using ProtoVerDowngrade = Message<MsgType::PROTO_VER_DOWNGRADE, U16, U16>;        // major, minor
+using AuthChallenge     = Message<MsgType::AUTH_CHALLENGE, Str16>;                // challenge
+using AuthResponse      = Message<MsgType::AUTH_RESPONSE, Str16, Str16>;          // callsign, digest
+using AuthOk            = Message<MsgType::AUTH_OK>;
+using Error             = Message<MsgType::ERROR, Str16>;                         // message
+using ServerInfo        = Message<MsgType::SERVER_INFO, U16, U16>;                // reserved, client ID
+using NodeList          = Message<MsgType::NODE_LIST, StringList>;                // callsigns
+using NodeJoined        = Message<MsgType::NODE_JOINED, Str16>;                   // callsign
+using NodeLeft          = Message<MsgType::NODE_LEFT, Str16>;                     // callsign
+using TalkerStart       = Message<MsgType::TALKER_START, U32, Str16>;             // talkgroup, callsign
+using TalkerStartV1     = Message<MsgType::TALKER_START, Str16>;                  // callsign
+using TalkerStop        = Message<MsgType::TALKER_STOP, U32, Str16>;              // talkgroup, callsign
+using TalkerStopV1      = Message<MsgType::TALKER_STOP, Str16>;                   // callsign
+using SelectTg          = Message<MsgType::SELECT_TG, U32>;                       // talkgroup
+using TgMonitor         = Message<MsgType::TG_MONITOR, TalkgroupList>;            // talkgroups
+using RequestQsy        = Message<MsgType::REQUEST_QSY, U32>;                     // talkgroup
+using StateEvent        = Message<MsgType::STATE_EVENT, Strings16<3>>;            // source, name, message
+using NodeInfo          = Message<MsgType::NODE_INFO, Str16>;                     // JSON
+using SignalStrength    = Message<MsgType::SIGNAL_STRENGTH, F32, F32, CallsignField>; // signal, squelch, callsign
+using TxStatus          = Message<MsgType::TX_STATUS, U8, CallsignField>;         // on, callsign
+
+using UdpHeartbeat         = UdpMessage<UdpMsgType::UDP_HEARTBEAT>;
+using UdpAudio             = UdpMessage<UdpMsgType::UDP_AUDIO, Str16>;            // Opus packet
+using UdpFlushSamples      = UdpMessage<UdpMsgType::UDP_FLUSH_SAMPLES>;
+using UdpAllSamplesFlushed = UdpMessage<UdpMsgType::UDP_ALL_SAMPLES_FLUSHED>;
+using UdpSignalStrength    = UdpMessage<UdpMsgType::UDP_SIGNAL_STRENGTH, F32, F32, CallsignField>;
+
+// The fixed-layout structs in ReflectorProtocol.h must agree.
+static_assert(ProtoVer::MIN_PAYLOAD_BYTES == sizeof(MsgProtoVer), "PROTO_VER layout");
+static_assert(ProtoVerDowngrade::MIN_PAYLOAD_BYTES == sizeof(MsgProtoVerDowngrade), "PROTO_VER_DOWNGRADE layout");
+static_assert(ServerInfo::MIN_PAYLOAD_BYTES == sizeof(MsgServerInfo), "SERVER_INFO layout");
+static_assert(SelectTg::MIN_PAYLOAD_BYTES == sizeof(MsgSelectTG), "SELECT_TG layout");
+static_assert(RequestQsy::MIN_PAYLOAD_BYTES == sizeof(MsgRequestQsy), "REQUEST_QSY layout");
+static_assert(StateEvent::MIN_PAYLOAD_BYTES == sizeof(MsgStateEvent), "STATE_EVENT layout");
+static_assert(SignalStrength::MIN_PAYLOAD_BYTES == sizeof(MsgSignalStrength), "SIGNAL_STRENGTH layout");
+static_assert(TxStatus::MIN_PAYLOAD_BYTES == sizeof(MsgTxStatus), "TX_STATUS layout");
+static_assert(UdpHeartbeat::MIN_BYTES == sizeof(MsgUdpHeartbeat), "UDP_HEARTBEAT layout");
+static_assert(UdpAudio::MIN_BYTES == sizeof(MsgUdpAudio), "UDP_AUDIO layout");
+static_assert(UdpSignalStrength::MIN_BYTES == sizeof(MsgUdpSignalStrength), "UDP_SIGNAL_STRENGTH layout");
+
+} // namespace Codec
+} // namespace Svxlink
+
+#endif // REFLECTORCODEC_H
@@ -0,0 +1,785 @@
+/*
+ * Copyright (C) 2025 Silviu YO6SAY
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ReflectorSession.h"
+#include "ReflectorCodec.h"
+
+#include <QMessageAuthenticationCode>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+
+using namespace Svxlink;
+
+namespace {
+std::string toString(const PayloadReader& bytes)
+{
+    return std::string(bytes.data(), static_cast<size_t>(bytes.size()));
+}
+
+// Fixed-width callsign fields are NUL-padded.
+std::string fixedField(const PayloadReader& bytes)
+{
+    const char* end = std::find(bytes.data(), bytes.data() + bytes.size(), '\0');
+    return std::string(bytes.data(), end);
+}
+
+bool containsIgnoringCase(const std::string& text, const char* needle)
+{
+    const std::string pattern(needle);
+    const auto match = std::search(text.begin(), text.end(), pattern.begin(), pattern.end(),
+                                   [](char a, char b) {
+        return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+    });
+    return match != text.end();
+}
+}
+
+ReflectorSession::ReflectorSession()
+{
+    m_events.reserve(16);
+}
+
+// --- Configuration ---
+
+void ReflectorSession::setCredentials(const std::string& callsign, const std::string& authKey)
+{
+    m_callsign = callsign;
+    m_authKey = authKey;
+}
+
+void ReflectorSession::setNodeInfo(const std::string& json, int64_t nowMs)
+{
+    touch(nowMs);
+    m_nodeInfo = json;
+    if (m_state == State::Connected) {
+        queueMessage<Codec::NodeInfo>(Codec::bytesOf(m_nodeInfo));
+    }
+}
+
+void ReflectorSession::setTalkgroupSelectTimeoutSeconds(int seconds)
+{
+    m_tgSelectTimeoutSeconds = std::max(1, seconds);
+}
+
+void ReflectorSession::setMonitoredTalkgroups(uint32_t defaultTalkgroup,
+                                              const std::vector<MonitoredTalkgroup>& configured,
+                                              int64_t nowMs)
+{
+    touch(nowMs);
+    m_defaultTalkgroup = defaultTalkgroup;
+    m_configuredTalkgroups = configured;
+
+    m_monitoredTalkgroups.clear();
+    const auto addMonitored = [this](uint32_t talkgroup) {
+        if (talkgroup > 0 && !isTalkgroupMonitored(talkgroup)) {
+            m_monitoredTalkgroups.push_back(talkgroup);
+        }
+    };
+    addMonitored(m_defaultTalkgroup);
+    for (const MonitoredTalkgroup& entry : m_configuredTalkgroups) {
+        addMonitored(entry.talkgroup);
+    }
+
+    if (m_state != State::Connected) {
+        return;
+    }
+    queueMessage<Codec::TgMonitor>(Codec::spanOf(m_monitoredTalkgroups));
+    if (m_talkgroup > 0) {
+        resetTalkgroupSelectionTimer();
+    } else {
+        stopTalkgroupSelectionTimer();
+    }
+}
+
+void ReflectorSession::clearMonitoredTalkgroups()
+{
+    m_defaultTalkgroup = 0;
+    m_configuredTalkgroups.clear();
+    m_monitoredTalkgroups.clear();
+}
+
+// --- Connection Lifecycle ---
+
+void ReflectorSession::open(uint32_t talkgroup, int64_t nowMs)
+{
+    close();
+    touch(nowMs);
+    m_state = State::Connecting;
+    if (m_talkgroup != talkgroup) {
+        m_talkgroup = talkgroup;
+        queueEvent(Event::Type::TalkgroupChanged).talkgroup = talkgroup;
+    }
+}
+
+void ReflectorSession::transportConnected(int64_t nowMs)
+{
+    touch(nowMs);
+    m_state = State::Authenticating;
+    queueMessage<Codec::ProtoVer>(Protocol::MAJOR_VER, Protocol::MINOR_VER);
+}
+
+void ReflectorSession::close()
+{
+    m_state = State::Disconnected;
+    stopTimers();
+    m_usePriorityMode = true;
+    m_clientId = 0;
+    m_udpSequence = 0;
+    m_currentTalker.clear();
+    m_tcpFrames.clear();
+    m_tcpOutput.clear();
+    m_datagramBytes.clear();
+    m_datagramSizes.clear();
+    m_nextDatagram = 0;
+    m_nextDatagramOffset = 0;
+    m_events.clear();
+    m_nextEvent = 0;
+}
+
+// --- Inputs ---
+
+char* ReflectorSession::prepareTcpRead(int count)
+{
+    return m_tcpFrames.prepareWrite(count);
+}
+
+void ReflectorSession::commitTcpRead(int count, int64_t nowMs)
+{
+    touch(nowMs);
+    m_tcpFrames.commitWrite(count);
+    processTcpFrames();
+}
+
+void ReflectorSession::receiveTcp(const char* data, int count, int64_t nowMs)
+{
+    touch(nowMs);
+    m_tcpFrames.append(data, count);
+    processTcpFrames();
+}
+
+void ReflectorSession::processTcpFrames()
+{
+    PayloadReader payload;
+    TcpFrameReader::Result result;
+    while ((result = m_tcpFrames.next(payload)) == TcpFrameReader::Result::Frame) {
+        handleTcpPayload(payload);
+    }
+    if (result == TcpFrameReader::Result::Oversized) {
+        fail(Event::Type::FrameTooLarge).value = m_tcpFrames.lastFrameBytes();
+        m_tcpFrames.clear();
+    }
+}
+
+void ReflectorSession::handleTcpPayload(PayloadReader payload)
+{
+    const PayloadReader frame = payload;
+    const uint16_t messageType = payload.readU16();
+    const auto malformed = [this, messageType]() {
+        queueEvent(Event::Type::MalformedMessage).value = messageType;
+    };
+
+    switch (messageType) {
+    case MsgType::PROTO_VER:
+    case MsgType::AUTH_OK:
+        break;
+    case MsgType::AUTH_CHALLENGE:
+        handleAuthChallenge(payload);
+        break;
+    case MsgType::PROTO_VER_DOWNGRADE: {
+        uint16_t majorVer = 0;
+        uint16_t minorVer = 0;
+        Codec::ProtoVerDowngrade::decodeFields(payload, majorVer, minorVer);
+        fail(Event::Type::ProtocolUnsupported).value = static_cast<uint32_t>(majorVer) << 16 | minorVer;
+        break;
+    }
+    case MsgType::ERROR: {
+        PayloadReader errorMessage;
+        Codec::Error::decodeFields(payload, errorMessage);
+        std::string text = toString(errorMessage);
+        const bool authRejected = containsIgnoringCase(text, "Access denied")
+                || containsIgnoringCase(text, "Authentication");
+        if (authRejected) {
+            m_authKey.clear();
+        }
+        Event& event = fail(Event::Type::ServerError);
+        event.text = std::move(text);
+        event.flag = authRejected;
+        break;
+    }
+    case MsgType::SERVER_INFO:
+        handleServerInfo(payload);
+        break;
+    case MsgType::HEARTBEAT:
+        noteInboundHeartbeat();
+        break;
+    case MsgType::NODE_LIST: {
+        Codec::StringList::View entries;
+        if (!Codec::NodeList::decodeFields(payload, entries)) {
+            malformed();
+            break;
+        }
+        Event& event = queueEvent(Event::Type::NodeList);
+        event.strings.reserve(static_cast<size_t>(entries.count));
+        PayloadReader callsign;
+        while (entries.next(callsign)) {
+            if (callsign.size() > 0) {
+                event.strings.push_back(toString(callsign));
+            }
+        }
+        break;
+    }
+    case MsgType::NODE_JOINED:
+    case MsgType::NODE_LEFT: {
+        // NODE_LEFT has the same layout.
+        PayloadReader callsign;
+        if (!Codec::NodeJoined::decodeFields(payload, callsign)) {
+            malformed();
+            break;
+        }
+        queueEvent(messageType == MsgType::NODE_JOINED ? Event::Type::NodeJoined
+                                                       : Event::Type::NodeLeft).text = toString(callsign);
+        break;
+    }
+    case MsgType::REQUEST_QSY: {
+        uint32_t talkgroup = 0;
+        if (!Codec::RequestQsy::decodeFields(payload, talkgroup)) {
+            malformed();
+            break;
+        }
+        selectTalkgroup(talkgroup, TalkgroupSelectionOrigin::RequestQsy, m_nowMs);
+        queueEvent(Event::Type::QsyRequested).talkgroup = talkgroup;
+        break;
+    }
+    case MsgType::STATE_EVENT: {
+        std::array<PayloadReader, 3> fields;
+        if (!Codec::StateEvent::decodeFields(payload, fields)) {
+            malformed();
+            break;
+        }
+        Event& event = queueEvent(Event::Type::StateEvent);
+        for (const PayloadReader& field : fields) {
+            event.strings.push_back(toString(field));
+        }
+        break;
+    }
+    case MsgType::SIGNAL_STRENGTH: {
+        float rxSignal = 0.0f;
+        float sqlOpen = 0.0f;
+        PayloadReader callsign;
+        if (!Codec::SignalStrength::decodeFields(payload, rxSignal, sqlOpen, callsign)) {
+            malformed();
+            break;
+        }
+        Event& event = queueEvent(Event::Type::SignalStrength);
+        event.text = fixedField(callsign);
+        event.rxSignal = rxSignal;
+        event.sqlOpen = sqlOpen;
+        break;
+    }
+    case MsgType::TX_STATUS: {
+        uint8_t txState = 0;
+        PayloadReader callsign;
+        if (!Codec::TxStatus::decodeFields(payload, txState, callsign)) {
+            malformed();
+            break;
+        }
+        Event& event = queueEvent(Event::Type::TxStatus);
+        event.text = fixedField(callsign);
+        event.flag = txState != 0;
+        break;
+    }
+    case MsgType::TALKER_START: {
+        // V2 carries the talkgroup ahead of the callsign; V1 only the callsign.
+        uint32_t talkgroup = 0;
+        PayloadReader callsign;
+        PayloadReader probe = payload;
+        if (Codec::TalkerStart::decodeFields(probe, talkgroup, callsign)) {
+            handleTalkerStart(talkgroup, callsign, true);
+        } else if (Codec::TalkerStartV1::decodeFields(payload, callsign)) {
+            handleTalkerStart(0, callsign, false);
+        } else {
+            malformed();
+        }
+        break;
+    }
+    case MsgType::TALKER_STOP: {
+        uint32_t talkgroup = 0;
+        PayloadReader callsign;
+        PayloadReader probe = payload;
+        if (Codec::TalkerStop::decodeFields(probe, talkgroup, callsign)
+                || Codec::TalkerStopV1::decodeFields(payload, callsign)) {
+            handleTalkerStop(callsign);
+        } else {
+            malformed();
+        }
+        break;
+    }
+    default: {
+        Event& event = queueEvent(Event::Type::UnknownMessage);
+        event.value = messageType;
+        event.data = frame.data();
+        event.size = frame.size();
+        break;
+    }
+    }
+}
+
+void ReflectorSession::handleAuthChallenge(PayloadReader& payload)
+{
+    PayloadReader challenge;
+    if (!Codec::AuthChallenge::decodeFields(payload, challenge)) {
+        queueEvent(Event::Type::MalformedMessage).value = MsgType::AUTH_CHALLENGE;
+        return;
+    }
+    const QByteArray digest = QMessageAuthenticationCode::hash(
+        QByteArrayView(challenge.data(), challenge.size()),
+        QByteArrayView(m_authKey.data(), static_cast<qsizetype>(m_authKey.size())),
+        QCryptographicHash::Sha1);
+    queueMessage<Codec::AuthResponse>(Codec::bytesOf(m_callsign), Codec::bytesOf(digest));
+}
+
+void ReflectorSession::handleServerInfo(PayloadReader& payload)
+{
+    uint16_t reserved = 0;
+    Codec::ServerInfo::decodeFields(payload, reserved, m_clientId);
+    m_state = State::Connected;
+    m_lastInboundHeartbeatMs = -1;
+    m_recentHeartbeatIntervals.clear();
+    m_livenessDeadlineMs = -1;
+
+    queueMessage<Codec::NodeInfo>(Codec::bytesOf(m_nodeInfo));
+    queueMessage<Codec::SelectTg>(m_talkgroup);
+    queueMessage<Codec::TgMonitor>(Codec::spanOf(m_monitoredTalkgroups));
+    if (m_talkgroup > 0) {
+        resetTalkgroupSelectionTimer();
+    } else {
+        stopTalkgroupSelectionTimer();
+    }
+    m_nextHeartbeatMs = m_nowMs + HEARTBEAT_INTERVAL_MS;
+    // Registers our UDP port with the reflector straight away.
+    queueDatagram<Codec::UdpHeartbeat>();
+
+    queueEvent(Event::Type::Authenticated).value = m_clientId;
+}
+
+void ReflectorSession::handleTalkerStart(uint32_t talkgroup, const PayloadReader& callsign,
+                                         bool checkTalkgroup)
+{
+    std::string talker = toString(callsign);
+    if (talker == m_callsign) {
+        // Our own transmission, echoed back.
+        if (!m_currentTalker.empty()) {
+            queueEvent(Event::Type::TalkerStopped).text = std::move(m_currentTalker);
+            m_currentTalker.clear();
+        }
+        return;
+    }
+    if (checkTalkgroup && !shouldHandleTalkerStart(talkgroup)) {
+        return;
+    }
+    m_currentTalker = talker;
+    Event& event = queueEvent(Event::Type::TalkerStarted);
+    event.text = std::move(talker);
+    event.talkgroup = talkgroup;
+}
+
+void ReflectorSession::handleTalkerStop(const PayloadReader& callsign)
+{
+    if (m_currentTalker.empty()
+            || m_currentTalker.compare(0, std::string::npos, callsign.data(),
+                                       static_cast<size_t>(callsign.size())) != 0) {
+        return;
+    }
+    queueEvent(Event::Type::TalkerStopped).text = std::move(m_currentTalker);
+    m_currentTalker.clear();
+}
+
+void ReflectorSession::receiveDatagram(const char* data, int size, int64_t nowMs)
+{
+    touch(nowMs);
+    const PayloadReader datagram(data, size);
+    PayloadReader header = datagram;
+    const uint16_t messageType = header.readU16();
+    if (!header.ok()) {
+        return;
+    }
+    const auto malformed = [this, messageType]() {
+        Event& event = queueEvent(Event::Type::MalformedMessage);
+        event.value = messageType;
+        event.flag = true;
+    };
+
+    uint16_t clientId = 0;
+    uint16_t sequence = 0;
+    switch (messageType) {
+    case UdpMsgType::UDP_HEARTBEAT:
+        break;
+    case UdpMsgType::UDP_AUDIO: {
+        PayloadReader opus;
+        if (!Codec::UdpAudio::decode(datagram, clientId, sequence, opus)) {
+            malformed();
+            break;
+        }
+        if (opus.size() > 0) {
+            Event& event = queueEvent(Event::Type::AudioReceived);
+            event.data = opus.data();
+            event.size = opus.size();
+            event.sequence = sequence;
+        }
+        break;
+    }
+    case UdpMsgType::UDP_FLUSH_SAMPLES:
+        queueEvent(Event::Type::FlushSamples);
+        break;
+    case UdpMsgType::UDP_ALL_SAMPLES_FLUSHED:
+        queueEvent(Event::Type::AllSamplesFlushed);
+        break;
+    case UdpMsgType::UDP_SIGNAL_STRENGTH: {
+        float rxSignal = 0.0f;
+        float sqlOpen = 0.0f;
+        PayloadReader callsign;
+        if (!Codec::UdpSignalStrength::decode(datagram, clientId, sequence, rxSignal, sqlOpen, callsign)) {
+            malformed();
+            break;
+        }
+        Event& event = queueEvent(Event::Type::SignalStrength);
+        event.text = fixedField(callsign);
+        event.rxSignal = rxSignal;
+        event.sqlOpen = sqlOpen;
+        event.flag = true;
+        break;
+    }
+    default: {
+        Event& event = queueEvent(Event::Type::UnknownMessage);
+        event.value = messageType;
+        event.data = datagram.data();
+        event.size = datagram.size();
+        event.flag = true;
+        break;
+    }
+    }
+}
+
+void ReflectorSession::advance(int64_t nowMs)
+{
+    touch(nowMs);
+
+    if (m_livenessDeadlineMs >= 0 && m_nowMs >= m_livenessDeadlineMs) {
+        fail(Event::Type::LivenessExpired);
+        return;
+    }
+
+    if (m_nextHeartbeatMs >= 0 && m_nowMs >= m_nextHeartbeatMs) {
+        // One heartbeat however late, as a periodic timer would coalesce.
+        sendHeartbeat();
+        queueDatagram<Codec::UdpHeartbeat>();
+        m_nextHeartbeatMs += HEARTBEAT_INTERVAL_MS;
+        if (m_nextHeartbeatMs <= m_nowMs) {
+            m_nextHeartbeatMs = m_nowMs + HEARTBEAT_INTERVAL_MS;
+        }
+    }
+
+    // Every elapsed second counts towards the selection timeout.
+    while (m_nextTgSelectTickMs >= 0 && m_nowMs >= m_nextTgSelectTickMs) {
+        m_nextTgSelectTickMs += TALKGROUP_SELECTION_TICK_MS;
+        tickTalkgroupSelection();
+    }
+}
+
+// --- Commands ---
+
+bool ReflectorSession::selectTalkgroup(uint32_t talkgroup, TalkgroupSelectionOrigin origin, int64_t nowMs)
+{
+    touch(nowMs);
+    const bool changed = m_talkgroup != talkgroup;
+    const bool isManualSelection = origin == TalkgroupSelectionOrigin::Manual
+            || origin == TalkgroupSelectionOrigin::TxDefaultActivation;
+
+    if (changed) {
+        m_talkgroup = talkgroup;
+        queueEvent(Event::Type::TalkgroupChanged).talkgroup = talkgroup;
+    }
+
+    if (talkgroup == 0) {
+        m_usePriorityMode = true;
+        stopTalkgroupSelectionTimer();
+    } else {
+        if (isManualSelection) {
+            m_usePriorityMode = false;
+        }
+        resetTalkgroupSelectionTimer();
+    }
+
+    if (m_state == State::Connected && changed) {
+        queueMessage<Codec::SelectTg>(talkgroup);
+    }
+    return changed;
+}
+
+bool ReflectorSession::beginTransmit(int64_t nowMs)
+{
+    touch(nowMs);
+    if (m_talkgroup == 0) {
+        if (m_defaultTalkgroup == 0) {
+            return false;
+        }
+        selectTalkgroup(m_defaultTalkgroup, TalkgroupSelectionOrigin::TxDefaultActivation, m_nowMs);
+        return true;
+    }
+    m_usePriorityMode = false;
+    resetTalkgroupSelectionTimer();
+    return true;
+}
+
+void ReflectorSession::sendHeartbeat()
+{
+    if (m_state == State::Connected) {
+        queueMessage<Codec::Heartbeat>();
+    }
+}
+
+void ReflectorSession::sendFlushSamples()
+{
+    queueDatagram<Codec::UdpFlushSamples>();
+}
+
+void ReflectorSession::sendAudio(const char* packet, int size)
+{
+    queueDatagram<Codec::UdpAudio>(Codec::Bytes{packet, size});
+}
+
+// --- Outputs ---
+
+bool ReflectorSession::nextDatagram(const char*& data, int& size)
+{
+    if (m_nextDatagram >= m_datagramSizes.size()) {
+        m_datagramBytes.clear();
+        m_datagramSizes.clear();
+        m_nextDatagram = 0;
+        m_nextDatagramOffset = 0;
+        return false;
+    }
+    data = m_datagramBytes.data() + m_nextDatagramOffset;
+    size = m_datagramSizes[m_nextDatagram++];
+    m_nextDatagramOffset += size;
+    return true;
+}
+
+bool ReflectorSession::nextEvent(Event& event)
+{
+    if (m_nextEvent >= m_events.size()) {
+        m_events.clear();
+        m_nextEvent = 0;
+        return false;
+    }
+    event = std::move(m_events[m_nextEvent++]);
+    return true;
+}
+
+int64_t ReflectorSession::nextTimeoutMs() const
+{
+    int64_t deadline = -1;
+    for (const int64_t candidate : {m_nextHeartbeatMs, m_nextTgSelectTickMs, m_livenessDeadlineMs}) {
+        if (candidate >= 0 && (deadline < 0 || candidate < deadline)) {
+            deadline = candidate;
+        }
+    }
+    return deadline;
+}
+
+int ReflectorSession::livenessTimeoutMs() const
+{
+    if (m_recentHeartbeatIntervals.empty()) {
+        return 0;
+    }
+    const int64_t longestObservedInterval = *std::max_element(m_recentHeartbeatIntervals.begin(),
+                                                              m_recentHeartbeatIntervals.end());
+    return static_cast<int>(std::clamp<int64_t>(longestObservedInterval * HEARTBEAT_MISS_THRESHOLD,
+                                                MIN_LIVENESS_TIMEOUT_MS, MAX_LIVENESS_TIMEOUT_MS));
+}
+
+// --- Internals ---
+
+template <typename Message, typename... Values>
+void ReflectorSession::queueMessage(const Values&... values)
+{
+    const int frameBytes = Message::frameSize(values...);
+    if (frameBytes < 0) {
+        // A field over 64 KiB; the server could not take it either.
+        return;
+    }
+    const size_t offset = m_tcpOutput.size();
+    m_tcpOutput.resize(offset + static_cast<size_t>(frameBytes));
+    Message::encodeFrame(m_tcpOutput.data() + offset, frameBytes, values...);
+}
+
+template <typename Message, typename... Values>
+void ReflectorSession::queueDatagram(const Values&... values)
+{
+    const int datagramBytes = Message::size(values...);
+    if (datagramBytes < 0) {
+        return;
+    }
+    const size_t offset = m_datagramBytes.size();
+    m_datagramBytes.resize(offset + static_cast<size_t>(datagramBytes));
+    Message::encode(m_datagramBytes.data() + offset, datagramBytes, m_clientId, m_udpSequence++, values...);
+    m_datagramSizes.push_back(datagramBytes);
+}
+
+ReflectorSession::Event& ReflectorSession::queueEvent(Event::Type type)
+{
+    m_events.emplace_back();
+    Event& event = m_events.back();
+    event.type = type;
+    return event;
+}
+
+void ReflectorSession::touch(int64_t nowMs)
+{
+    m_nowMs = std::max(m_nowMs, nowMs);
+}
+
+ReflectorSession::Event& ReflectorSession::fail(Event::Type type)
+{
+    m_state = State::Disconnected;
+    stopTimers();
+    return queueEvent(type);
+}
+
+void ReflectorSession::stopTimers()
+{
+    m_nextHeartbeatMs = -1;
+    m_lastInboundHeartbeatMs = -1;
+    m_recentHeartbeatIntervals.clear();
+    m_livenessDeadlineMs = -1;
+    stopTalkgroupSelectionTimer();
+}
+
+void ReflectorSession::noteInboundHeartbeat()
+{
+    if (m_state != State::Connected) {
+        return;
+    }
+
+    if (m_lastInboundHeartbeatMs >= 0) {
+        const int64_t intervalMs = m_nowMs - m_lastInboundHeartbeatMs;
+        if (intervalMs > 0) {
+            m_recentHeartbeatIntervals.push_back(intervalMs);
+            if (m_recentHeartbeatIntervals.size() > MAX_RECENT_HEARTBEAT_INTERVALS) {
+                m_recentHeartbeatIntervals.erase(m_recentHeartbeatIntervals.begin());
+            }
+        }
+    }
+    m_lastInboundHeartbeatMs = m_nowMs;
+
+    const int timeoutMs = livenessTimeoutMs();
+    if (timeoutMs > 0) {
+        m_livenessDeadlineMs = m_nowMs + timeoutMs;
+    }
+}
+
+// --- Talkgroup Policy ---
+
+void ReflectorSession::tickTalkgroupSelection()
+{
+    if (m_state != State::Connected || m_talkgroup == 0 || m_tgSelectSecondsLeft <= 0) {
+        if (m_tgSelectSecondsLeft <= 0) {
+            stopTalkgroupSelectionTimer();
+        }
+        return;
+    }
+
+    if (m_channelBusy) {
+        return;
+    }
+
+    if (--m_tgSelectSecondsLeft == 0) {
+        selectTalkgroup(0, TalkgroupSelectionOrigin::Timeout, m_nowMs);
+    }
+}
+
+void ReflectorSession::resetTalkgroupSelectionTimer()
+{
+    if (m_talkgroup == 0) {
+        stopTalkgroupSelectionTimer();
+        return;
+    }
+
+    m_tgSelectSecondsLeft = m_tgSelectTimeoutSeconds;
+    if (m_state == State::Connected && m_nextTgSelectTickMs < 0) {
+        m_nextTgSelectTickMs = m_nowMs + TALKGROUP_SELECTION_TICK_MS;
+    }
+}
+
+void ReflectorSession::stopTalkgroupSelectionTimer()
+{
+    m_tgSelectSecondsLeft = 0;
+    m_nextTgSelectTickMs = -1;
+}
+
+uint8_t ReflectorSession::monitoredTalkgroupPriority(uint32_t talkgroup) const
+{
+    if (talkgroup == 0) {
+        return 0;
+    }
+    for (const MonitoredTalkgroup& entry : m_configuredTalkgroups) {
+        if (entry.talkgroup == talkgroup) {
+            return entry.priority;
+        }
+    }
+    return 0;
+}
+
+bool ReflectorSession::isTalkgroupMonitored(uint32_t talkgroup) const
+{
+    return std::find(m_monitoredTalkgroups.begin(), m_monitoredTalkgroups.end(), talkgroup)
+            != m_monitoredTalkgroups.end();
+}
+
+bool ReflectorSession::shouldHandleTalkerStart(uint32_t talkgroup)
+{
+    if (talkgroup == 0) {
+        return false;
+    }
+
+    if (talkgroup == m_talkgroup) {
+        resetTalkgroupSelectionTimer();
+        return true;
+    }
+
+    if (!isTalkgroupMonitored(talkgroup)) {
+        return false;
+    }
+
+    if (m_talkgroup == 0) {
+        selectTalkgroup(talkgroup, TalkgroupSelectionOrigin::RemoteActivation, m_nowMs);
+        return true;
+    }
+
+    if (!m_usePriorityMode) {
+        return false;
+    }
+
+    if (monitoredTalkgroupPriority(talkgroup) > monitoredTalkgroupPriority(m_talkgroup)) {
+        selectTalkgroup(talkgroup, TalkgroupSelectionOrigin::RemotePriorityActivation, m_nowMs);
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,276 @@
+/*
+ * Copyright (C) 2025 Silviu YO6SAY
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef REFLECTORSESSION_H
+#define REFLECTORSESSION_H
+
+#include "TcpFrameReader.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// The Svxlink reflector protocol with the sockets, timers and UI left out.
+//
+// Bytes from the TCP stream, UDP datagrams and the current time go in;
+// frames to write, datagrams to send, events and the next deadline come
+// out.  The session runs the handshake (PROTO_VER, AUTH_CHALLENGE/
+// AUTH_RESPONSE, SERVER_INFO), picks the talkgroup (monitor priorities,
+// REQUEST_QSY, falling back to TG 0 after the selection timeout), tracks
+// the current talker and keeps the link alive (TCP and UDP heartbeats out,
+// a watchdog on the server's heartbeats in).
+//
+// Nothing here blocks, reads a clock or needs an event loop (QtCore is used
+// only for the AUTH_RESPONSE HMAC), so the owner decides the thread and
+// the time.  The caller drains the outputs after every
+// input:
+//
+//     session.receiveTcp(bytes, count, nowMs);
+//     write(session.tcpOutput(), session.tcpOutputBytes());
+//     session.clearTcpOutput();
+//     while (session.nextDatagram(data, size)) { sendto(data, size); }
+//     while (session.nextEvent(event)) { ... }
+//     arm a timer for session.nextTimeoutMs(), then call advance()
+//
+// Time is any monotonic millisecond clock; an input older than the newest
+// one seen counts as the newest.  Not thread-safe, apart from udpSequence()
+// which the audio thread shares.
+class ReflectorSession
+{
+public:
+    enum class State {
+        Disconnected,
+        Connecting,
+        Authenticating,
+        Connected
+    };
+
+    enum class TalkgroupSelectionOrigin {
+        Manual,
+        RemoteActivation,
+        RemotePriorityActivation,
+        RequestQsy,
+        Timeout,
+        TxDefaultActivation
+    };
+
+    struct MonitoredTalkgroup {
+        uint32_t talkgroup = 0;
+        uint8_t priority = 0;
+    };
+
+    struct Event {
+        enum class Type {
+            // value: client ID.  Connected; NODE_INFO, SELECT_TG, TG_MONITOR
+            // and the first UDP heartbeat are queued.
+            Authenticated,
+            // value: major << 16 | minor the server asked for.  Disconnected.
+            ProtocolUnsupported,
+            // text: the server's message; flag: it refused our credentials,
+            // and the auth key was dropped.  Disconnected.
+            ServerError,
+            // value: the declared frame size.  The stream cannot be resynced;
+            // disconnected.
+            FrameTooLarge,
+            // No server heartbeat for livenessTimeoutMs().  Disconnected.
+            LivenessExpired,
+            // talkgroup: the new selection.
+            TalkgroupChanged,
+            // text: the new talker; talkgroup: where, 0 from a V1 server.
+            TalkerStarted,
+            // text: the talker that stopped, or that our own transmission
+            // displaced.
+            TalkerStopped,
+            // strings: callsigns, empty entries skipped.
+            NodeList,
+            NodeJoined,
+            NodeLeft,
+            // talkgroup: requested and already selected.
+            QsyRequested,
+            // strings: source, name, message.
+            StateEvent,
+            // text: callsign; rxSignal, sqlOpen.  From TCP or UDP.
+            SignalStrength,
+            // text: callsign; flag: transmitting.
+            TxStatus,
+            // data/size: the Opus packet; sequence: its UDP sequence number.
+            AudioReceived,
+            FlushSamples,
+            AllSamplesFlushed,
+            // value: message type; flag: it came over UDP.  A field ran past
+            // the end; the message was dropped.
+            MalformedMessage,
+            // value: message type; data/size: the whole message; flag: it
+            // came over UDP.
+            UnknownMessage
+        };
+
+        Type type = Type::Authenticated;
+        uint32_t talkgroup = 0;
+        uint32_t value = 0;
+        uint16_t sequence = 0;
+        bool flag = false;
+        float rxSignal = 0.0f;
+        float sqlOpen = 0.0f;
+        std::string text;
+        std::vector<std::string> strings;
+        // Points into the bytes that came in; valid until the next input.
+        const char* data = nullptr;
+        int size = 0;
+    };
+
+    static constexpr int HEARTBEAT_INTERVAL_MS = 5000;
+    static constexpr int TALKGROUP_SELECTION_TICK_MS = 1000;
+    static constexpr int MIN_LIVENESS_TIMEOUT_MS = 15000;
+    static constexpr int MAX_LIVENESS_TIMEOUT_MS = 120000;
+    static constexpr int HEARTBEAT_MISS_THRESHOLD = 3;
+    static constexpr int MAX_RECENT_HEARTBEAT_INTERVALS = 5;
+
+    ReflectorSession();
+
+    // --- Configuration; kept across connections ---
+    void setCredentials(const std::string& callsign, const std::string& authKey);
+    // Sent as NODE_INFO after authentication, and at once when connected.
+    void setNodeInfo(const std::string& json, int64_t nowMs);
+    void setTalkgroupSelectTimeoutSeconds(int seconds);
+    // The default talkgroup is monitored first, then the configured ones
+    // in order.  Sent as TG_MONITOR at once when connected.
+    void setMonitoredTalkgroups(uint32_t defaultTalkgroup,
+                                const std::vector<MonitoredTalkgroup>& configured,
+                                int64_t nowMs);
+    void clearMonitoredTalkgroups();
+
+    // --- Connection lifecycle ---
+    // Starts a new connection on talkgroup; the owner is opening the socket.
+    void open(uint32_t talkgroup, int64_t nowMs);
+    // The TCP connection is up; queues PROTO_VER.
+    void transportConnected(int64_t nowMs);
+    // Forgets the connection and everything queued for it.  The talkgroup,
+    // monitor list and credentials stay for the next one.
+    void close();
+
+    // --- Inputs ---
+    // Room for count bytes of TCP stream, to fill and then commit.
+    char* prepareTcpRead(int count);
+    void commitTcpRead(int count, int64_t nowMs);
+    void receiveTcp(const char* data, int count, int64_t nowMs);
+    void receiveDatagram(const char* data, int size, int64_t nowMs);
+    // Runs whatever timers are due at nowMs.
+    void advance(int64_t nowMs);
+
+    // --- Commands ---
+    bool selectTalkgroup(uint32_t talkgroup, TalkgroupSelectionOrigin origin, int64_t nowMs);
+    // Leaves TG 0 for the default talkgroup, or pins the selected one, as a
+    // local transmission does.  False if there is nothing to transmit on.
+    bool beginTransmit(int64_t nowMs);
+    // The selection timeout does not run down while the channel is busy.
+    void setChannelBusy(bool busy) { m_channelBusy = busy; }
+    void sendHeartbeat();
+    void sendFlushSamples();
+    void sendAudio(const char* packet, int size);
+
+    // --- Outputs ---
+    const char* tcpOutput() const { return m_tcpOutput.data(); }
+    int tcpOutputBytes() const { return static_cast<int>(m_tcpOutput.size()); }
+    void clearTcpOutput() { m_tcpOutput.clear(); }
+    // The next datagram to send; the view stays valid until the next call.
+    bool nextDatagram(const char*& data, int& size);
+    bool nextEvent(Event& event);
+    // When advance() next has work, or -1 if no timer is running.
+    int64_t nextTimeoutMs() const;
+
+    // --- State ---
+    State state() const { return m_state; }
+    uint16_t clientId() const { return m_clientId; }
+    // Shared with UdpAudioSender, which numbers the audio it sends itself.
+    std::atomic<uint16_t>& udpSequence() { return m_udpSequence; }
+    uint32_t selectedTalkgroup() const { return m_talkgroup; }
+    uint32_t defaultTalkgroup() const { return m_defaultTalkgroup; }
+    const std::vector<uint32_t>& monitoredTalkgroups() const { return m_monitoredTalkgroups; }
+    bool usesPriorityMode() const { return m_usePriorityMode; }
+    int talkgroupSelectSecondsLeft() const { return m_tgSelectSecondsLeft; }
+    bool talkgroupSelectionTimerActive() const { return m_nextTgSelectTickMs >= 0; }
+    const std::string& currentTalker() const { return m_currentTalker; }
+    // How long the server may stay silent, from its heartbeat cadence; 0
+    // until two heartbeats have been seen.
+    int livenessTimeoutMs() const;
+    int bufferedTcpBytes() const { return m_tcpFrames.buffered(); }
+
+private:
+    friend class ReflectorClientTest;
+
+    template <typename Message, typename... Values>
+    void queueMessage(const Values&... values);
+    template <typename Message, typename... Values>
+    void queueDatagram(const Values&... values);
+    Event& queueEvent(Event::Type type);
+    void touch(int64_t nowMs);
+    void processTcpFrames();
+    void handleTcpPayload(PayloadReader payload);
+    void handleAuthChallenge(PayloadReader& payload);
+    void handleServerInfo(PayloadReader& payload);
+    void handleTalkerStart(uint32_t talkgroup, const PayloadReader& callsign, bool checkTalkgroup);
+    void handleTalkerStop(const PayloadReader& callsign);
+    void noteInboundHeartbeat();
+    Event& fail(Event::Type type);
+    void stopTimers();
+    void tickTalkgroupSelection();
+    void resetTalkgroupSelectionTimer();
+    void stopTalkgroupSelectionTimer();
+    uint8_t monitoredTalkgroupPriority(uint32_t talkgroup) const;
+    bool isTalkgroupMonitored(uint32_t talkgroup) const;
+    bool shouldHandleTalkerStart(uint32_t talkgroup);
+
+    State m_state = State::Disconnected;
+    int64_t m_nowMs = INT64_MIN;
+
+    std::string m_callsign;
+    std::string m_authKey;
+    std::string m_nodeInfo;
+    uint16_t m_clientId = 0;
+    std::atomic<uint16_t> m_udpSequence{0};
+
+    uint32_t m_talkgroup = 0;
+    uint32_t m_defaultTalkgroup = 0;
+    std::vector<MonitoredTalkgroup> m_configuredTalkgroups;
+    std::vector<uint32_t> m_monitoredTalkgroups;
+    bool m_usePriorityMode = true;
+    bool m_channelBusy = false;
+    int m_tgSelectTimeoutSeconds = 30;
+    int m_tgSelectSecondsLeft = 0;
+    int64_t m_nextTgSelectTickMs = -1;
+
+    std::string m_currentTalker;
+
+    int64_t m_nextHeartbeatMs = -1;
+    int64_t m_lastInboundHeartbeatMs = -1;
+    std::vector<int64_t> m_recentHeartbeatIntervals;
+    int64_t m_livenessDeadlineMs = -1;
+
+    TcpFrameReader m_tcpFrames;
+    std::vector<char> m_tcpOutput;
+    // Queued datagrams back to back, with their sizes alongside.
+    std::vector<char> m_datagramBytes;
+    std::vector<int> m_datagramSizes;
+    size_t m_nextDatagram = 0;
+    int m_nextDatagramOffset = 0;
+    std::vector<Event> m_events;
+    size_t m_nextEvent = 0;
+};
+
+#endif // REFLECTORSESSION_H
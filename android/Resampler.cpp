@@ -21,6 +21,25 @@
 #include <cstring>
 #include <algorithm>
 #include <iterator>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <tuple>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define LATRY_RESAMPLER_SSE 1
+#  include <emmintrin.h>
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#  define LATRY_RESAMPLER_AVX2 1
+#  include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  define LATRY_RESAMPLER_NEON 1
+#  include <arm_neon.h>
+#endif
 
 // FIR filter coefficients taken from SvxLink 24.02
 static const float coeff_48_16[] = {
@@ -64,97 +83,455 @@ static const float coeff_48_16_wide[] = {
     -0.0022883650051252883, -8.255590813253409E-4, 5.11059239270262E-4
 };
 
-Resampler::Resampler(int inRate, int outRate, int channels)
-    : m_inRate(inRate), m_outRate(outRate), m_channels(channels)
+namespace {
+// Filters are zero-padded to whole vectors so no kernel needs a scalar tail.
+constexpr int kTapAlignment = 8;
+
+int paddedTaps(int taps)
+{
+    return (taps + kTapAlignment - 1) / kTapAlignment * kTapAlignment;
+}
+
+struct SincTier {
+    // Sinc zero crossings on each side, counted at the lower of the two rates.
+    int zeroCrossings;
+    double kaiserBeta;
+    // Cutoff as a fraction of the lower Nyquist frequency, placed so the
+    // Kaiser transition band ends at Nyquist.
+    double rolloff;
+};
+
+SincTier sincTier(Resampler::Quality quality)
+{
+    switch (quality) {
+    case Resampler::Quality::Fast:
+        return {12, 6.0, 0.84};   // ~60 dB
+    case Resampler::Quality::High:
+        return {48, 11.0, 0.93};  // ~105 dB
+    case Resampler::Quality::Balanced:
+    case Resampler::Quality::Linear:
+        break;
+    }
+    return {24, 8.5, 0.88};       // ~85 dB
+}
+
+// Zeroth-order modified Bessel function of the first kind.
+double besselI0(double x)
 {
+    double sum = 1.0;
+    double term = 1.0;
+    const double halfX = x / 2.0;
+    for (int k = 1; k < 64 && term > sum * 1.0e-12; ++k) {
+        term *= (halfX / k) * (halfX / k);
+        sum += term;
+    }
+    return sum;
+}
+
+float dotScalar(const float* a, const float* b, int count)
+{
+    float sum = 0.0f;
+    for (int i = 0; i < count; ++i)
+        sum += a[i] * b[i];
+    return sum;
+}
+
+#if defined(LATRY_RESAMPLER_SSE)
+float dotSse(const float* a, const float* b, int count)
+{
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    for (; i + 4 <= count; i += 4)
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+
+    __m128 acc = _mm_add_ps(acc0, acc1);
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 0x55));
+    float sum = _mm_cvtss_f32(acc);
+    for (; i < count; ++i)
+        sum += a[i] * b[i];
+    return sum;
+}
+#endif
+
+#if defined(LATRY_RESAMPLER_AVX2)
+__attribute__((target("avx2,fma")))
+float dotAvx2(const float* a, const float* b, int count)
+{
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+    }
+    for (; i + 8 <= count; i += 8)
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+
+    const __m256 acc = _mm256_add_ps(acc0, acc1);
+    __m128 half = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+    half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 0x55));
+    float sum = _mm_cvtss_f32(half);
+    for (; i < count; ++i)
+        sum += a[i] * b[i];
+    return sum;
+}
+#endif
+
+#if defined(LATRY_RESAMPLER_NEON)
+float dotNeon(const float* a, const float* b, int count)
+{
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    for (; i + 4 <= count; i += 4)
+        acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+
+    const float32x4_t acc = vaddq_f32(acc0, acc1);
+    float32x2_t pair = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+    float sum = vget_lane_f32(vpadd_f32(pair, pair), 0);
+    for (; i < count; ++i)
+        sum += a[i] * b[i];
+    return sum;
+}
+#endif
+}
+
+Resampler::Resampler(int inRate, int outRate, int channels, Quality quality)
+    : m_inRate(inRate), m_outRate(outRate), m_channels(channels), m_quality(quality)
+{
+    const int divisor = (inRate > 0 && outRate > 0) ? std::gcd(inRate, outRate) : 1;
+    const int upFactor = outRate / divisor;
+    const int downFactor = inRate / divisor;
+
     if (inRate == 48000 && outRate == 16000) {
         m_mode = Decim48To16;
-        m_delay.assign(std::size(coeff_48_16_wide), 0.0f);
+        m_taps = paddedTaps(static_cast<int>(std::size(coeff_48_16_wide)));
+        m_decimCoeffs.assign(static_cast<size_t>(m_taps), 0.0f);
+        std::copy(std::begin(coeff_48_16_wide), std::end(coeff_48_16_wide), m_decimCoeffs.begin());
     } else if (inRate == 16000 && outRate == 48000) {
         m_mode = Interp16To48;
-        m_delay.assign(std::size(coeff_48_16) / 3, 0.0f);
+        // Phase p of the 48 kHz output uses every third tap starting at p.
+        const int phaseTaps = static_cast<int>(std::size(coeff_48_16)) / INTERP_PHASES;
+        m_taps = paddedTaps(phaseTaps);
+        for (int phase = 0; phase < INTERP_PHASES; ++phase) {
+            std::vector<float> &coeffs = m_phaseCoeffs[static_cast<size_t>(phase)];
+            coeffs.assign(static_cast<size_t>(m_taps), 0.0f);
+            for (int t = 0; t < phaseTaps; ++t)
+                coeffs[static_cast<size_t>(t)] = coeff_48_16[phase + t * INTERP_PHASES];
+        }
+    } else if (quality != Quality::Linear && channels == 1 && upFactor > 0 && downFactor > 0
+               && upFactor <= MAX_SINC_PHASES) {
+        m_mode = Sinc;
+        m_upFactor = upFactor;
+        m_downFactor = downFactor;
+        m_sincBank = sincFilterBank(upFactor, downFactor, quality);
+        m_taps = m_sincBank->taps;
     } else {
         m_mode = Linear;
+        m_quality = Quality::Linear;
         m_prevSamples.resize(m_channels, 0.0f);
     }
+    m_history.assign(static_cast<size_t>(m_taps) * 2, 0.0f);
+    setKernel(bestKernel());
 }
 
 Resampler::~Resampler() {}
 
+std::shared_ptr<const Resampler::SincFilterBank> Resampler::sincFilterBank(int upFactor, int downFactor,
+                                                                         Quality quality)
+{
+    static std::mutex mutex;
+    static std::map<std::tuple<int, int, Quality>, std::shared_ptr<const SincFilterBank>> banks;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<const SincFilterBank> &cached = banks[std::make_tuple(upFactor, downFactor, quality)];
+    if (cached) {
+        return cached;
+    }
+
+    // Prototype lowpass at upFactor * inRate, cut off below the lower of the
+    // two Nyquist frequencies, then split into upFactor phases.
+    // When decimating, the sinc widens by downFactor / upFactor input samples.
+    const SincTier tier = sincTier(quality);
+    const int tapsPerPhase = downFactor > upFactor
+            ? (2 * tier.zeroCrossings * downFactor + upFactor - 1) / upFactor
+            : 2 * tier.zeroCrossings;
+    auto bank = std::make_shared<SincFilterBank>();
+    bank->phases = upFactor;
+    bank->taps = paddedTaps(tapsPerPhase);
+    bank->coeffs.assign(static_cast<size_t>(bank->phases) * bank->taps, 0.0f);
+
+    const int length = tapsPerPhase * upFactor;
+    const double center = (length - 1) / 2.0;
+    const double cutoff = tier.rolloff * 0.5 / std::max(upFactor, downFactor);
+    const double windowNorm = besselI0(tier.kaiserBeta);
+    constexpr double kPi = 3.14159265358979323846;
+    for (int n = 0; n < length; ++n) {
+        const double offset = n - center;
+        const double sinc = offset == 0.0 ? 1.0 : std::sin(2.0 * kPi * cutoff * offset) / (2.0 * kPi * cutoff * offset);
+        const double ratio = offset / center;
+        const double window = besselI0(tier.kaiserBeta * std::sqrt(std::max(0.0, 1.0 - ratio * ratio))) / windowNorm;
+        // Scaled by upFactor so each phase has unity DC gain.
+        const double tap = 2.0 * cutoff * sinc * window * upFactor;
+        const int phase = n % upFactor;
+        const int index = n / upFactor;
+        bank->coeffs[static_cast<size_t>(phase) * bank->taps + index] = static_cast<float>(tap);
+    }
+
+    cached = std::move(bank);
+    return cached;
+}
+
+const char* Resampler::qualityName(Quality quality)
+{
+    switch (quality) {
+    case Quality::Linear:
+        return "linear";
+    case Quality::Fast:
+        return "fast";
+    case Quality::Balanced:
+        return "balanced";
+    case Quality::High:
+        return "high";
+    }
+    return "unknown";
+}
+
+Resampler::Kernel Resampler::bestKernel()
+{
+#if defined(LATRY_RESAMPLER_AVX2)
+    if (isKernelSupported(Kernel::Avx2))
+        return Kernel::Avx2;
+#endif
+#if defined(LATRY_RESAMPLER_SSE)
+    return Kernel::Sse;
+#elif defined(LATRY_RESAMPLER_NEON)
+    return Kernel::Neon;
+#else
+    return Kernel::Scalar;
+#endif
+}
+
+bool Resampler::isKernelSupported(Kernel kernel)
+{
+    switch (kernel) {
+    case Kernel::Scalar:
+        return true;
+    case Kernel::Sse:
+#if defined(LATRY_RESAMPLER_SSE)
+        return true;
+#else
+        return false;
+#endif
+    case Kernel::Avx2:
+#if defined(LATRY_RESAMPLER_AVX2)
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+        return false;
+#endif
+    case Kernel::Neon:
+#if defined(LATRY_RESAMPLER_NEON)
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+const char* Resampler::kernelName(Kernel kernel)
+{
+    switch (kernel) {
+    case Kernel::Scalar:
+        return "scalar";
+    case Kernel::Sse:
+        return "sse";
+    case Kernel::Avx2:
+        return "avx2";
+    case Kernel::Neon:
+        return "neon";
+    }
+    return "unknown";
+}
+
+bool Resampler::setKernel(Kernel kernel)
+{
+    if (!isKernelSupported(kernel))
+        return false;
+
+    switch (kernel) {
+    case Kernel::Scalar:
+        m_dot = dotScalar;
+        break;
+#if defined(LATRY_RESAMPLER_SSE)
+    case Kernel::Sse:
+        m_dot = dotSse;
+        break;
+#endif
+#if defined(LATRY_RESAMPLER_AVX2)
+    case Kernel::Avx2:
+        m_dot = dotAvx2;
+        break;
+#endif
+#if defined(LATRY_RESAMPLER_NEON)
+    case Kernel::Neon:
+        m_dot = dotNeon;
+        break;
+#endif
+    default:
+        return false;
+    }
+    m_kernel = kernel;
+    return true;
+}
+
+int Resampler::maxOutputSamples(int sampleCount) const
+{
+    if (sampleCount <= 0)
+        return 0;
+
+    switch (m_mode) {
+    case Decim48To16:
+        return (m_decimPhase + sampleCount) / 3;
+    case Interp16To48:
+        return sampleCount * INTERP_PHASES;
+    case Sinc:
+        return static_cast<int>((static_cast<int64_t>(sampleCount) * m_upFactor) / m_downFactor) + 1;
+    case Linear:
+        break;
+    }
+    // Frames still owed from the previous call plus rounding slack.
+    const int frames = static_cast<int>(sampleCount * (static_cast<double>(m_outRate) / m_inRate)) + 2;
+    return frames * m_channels;
+}
+
 std::vector<float> Resampler::process(const float* input, int sampleCount)
 {
     if (sampleCount <= 0)
         return {};
 
-    std::vector<float> output;
-
-    if (m_mode == Linear) {
-        double step = static_cast<double>(m_inRate) / m_outRate;
-        int estOut = static_cast<int>((sampleCount + 1) * (static_cast<double>(m_outRate) / m_inRate) + 2);
-        std::vector<float> data(m_channels * (sampleCount + 1));
-        for (int ch = 0; ch < m_channels; ++ch)
-            data[ch] = m_prevSamples[ch];
-        std::memcpy(data.data() + m_channels, input, sampleCount * m_channels * sizeof(float));
-
-        output.reserve(estOut * m_channels);
-        double pos = m_pos;
-        int avail = sampleCount + 1;
-        while (pos < avail - 1) {
-            int idx = static_cast<int>(pos);
-            double frac = pos - idx;
-            for (int ch = 0; ch < m_channels; ++ch) {
-                float s0 = data[idx * m_channels + ch];
-                float s1 = data[(idx + 1) * m_channels + ch];
-                output.push_back(s0 + (s1 - s0) * frac);
-            }
-            pos += step;
-        }
+    std::vector<float> output(static_cast<size_t>(maxOutputSamples(sampleCount)));
+    const int written = process(input, sampleCount, output.data(), static_cast<int>(output.size()));
+    output.resize(static_cast<size_t>(std::max(written, 0)));
+    return output;
+}
 
-        m_pos = pos - (avail - 1);
-        for (int ch = 0; ch < m_channels; ++ch)
-            m_prevSamples[ch] = data[(avail - 1) * m_channels + ch];
-    } else if (m_mode == Decim48To16) {
-        for (int i = 0; i < sampleCount; ++i)
-            m_queue.push_back(input[i]);
-        while (m_queue.size() >= 3) {
-            for (size_t i = m_delay.size(); i-- > 3;)
-                m_delay[i] = m_delay[i - 3];
-            for (int i = 2; i >= 0; --i) {
-                m_delay[i] = m_queue.front();
-                m_queue.pop_front();
-            }
-            float sum = 0.0f;
-            for (size_t t = 0; t < std::size(coeff_48_16_wide); ++t)
-                sum += coeff_48_16_wide[t] * m_delay[t];
-            output.push_back(sum);
-        }
-    } else if (m_mode == Interp16To48) {
-        for (int i = 0; i < sampleCount; ++i)
-            m_queue.push_back(input[i]);
-        const size_t tapsPerPhase = std::size(coeff_48_16) / 3;
-        while (!m_queue.empty()) {
-            for (size_t i = tapsPerPhase; i-- > 1;)
-                m_delay[i] = m_delay[i - 1];
-            m_delay[0] = m_queue.front();
-            m_queue.pop_front();
-
-            for (int phase = 0; phase < 3; ++phase) {
-                const float *coeff = coeff_48_16 + phase;
-                float sum = 0.0f;
-                for (size_t t = 0; t < tapsPerPhase; ++t)
-                    sum += coeff[t * 3] * m_delay[t];
-                output.push_back(sum * 3.0f);
-            }
+int Resampler::process(const float* input, int sampleCount, float* output, int outputCapacity)
+{
+    if (sampleCount <= 0)
+        return 0;
+    const int needed = maxOutputSamples(sampleCount);
+    if (input == nullptr || outputCapacity < needed || (needed > 0 && output == nullptr))
+        return -1;
+
+    switch (m_mode) {
+    case Decim48To16:
+        return processDecimation(input, sampleCount, output);
+    case Interp16To48:
+        return processInterpolation(input, sampleCount, output);
+    case Sinc:
+        return processSinc(input, sampleCount, output);
+    case Linear:
+        break;
+    }
+    return processLinear(input, sampleCount, output);
+}
+
+int Resampler::processLinear(const float* input, int sampleCount, float* output)
+{
+    // Position 0 is the last sample of the previous call, position i is input[i - 1].
+    const double step = static_cast<double>(m_inRate) / m_outRate;
+    double pos = m_pos;
+    int written = 0;
+    while (pos < sampleCount) {
+        const int idx = static_cast<int>(pos);
+        const double frac = pos - idx;
+        const float* next = input + idx * m_channels;
+        const float* prev = idx == 0 ? m_prevSamples.data() : next - m_channels;
+        for (int ch = 0; ch < m_channels; ++ch) {
+            const float s0 = prev[ch];
+            const float s1 = next[ch];
+            output[written++] = s0 + (s1 - s0) * frac;
         }
+        pos += step;
     }
 
-    return output;
+    m_pos = pos - sampleCount;
+    std::copy(input + (sampleCount - 1) * m_channels, input + sampleCount * m_channels, m_prevSamples.begin());
+    return written;
+}
+
+void Resampler::pushHistory(float sample)
+{
+    m_historyPos = (m_historyPos == 0 ? m_taps : m_historyPos) - 1;
+    m_history[static_cast<size_t>(m_historyPos)] = sample;
+    m_history[static_cast<size_t>(m_historyPos + m_taps)] = sample;
+}
+
+int Resampler::processDecimation(const float* input, int sampleCount, float* output)
+{
+    int written = 0;
+    for (int i = 0; i < sampleCount; ++i) {
+        pushHistory(input[i]);
+        if (++m_decimPhase < 3)
+            continue;
+        m_decimPhase = 0;
+        output[written++] = m_dot(m_decimCoeffs.data(), m_history.data() + m_historyPos, m_taps);
+    }
+    return written;
+}
+
+int Resampler::processInterpolation(const float* input, int sampleCount, float* output)
+{
+    int written = 0;
+    for (int i = 0; i < sampleCount; ++i) {
+        pushHistory(input[i]);
+        const float* window = m_history.data() + m_historyPos;
+        for (int phase = 0; phase < INTERP_PHASES; ++phase)
+            output[written++] = m_dot(m_phaseCoeffs[static_cast<size_t>(phase)].data(), window, m_taps) * 3.0f;
+    }
+    return written;
+}
+
+int Resampler::processSinc(const float* input, int sampleCount, float* output)
+{
+    const float* coeffs = m_sincBank->coeffs.data();
+    int written = 0;
+    for (int i = 0; i < sampleCount; ++i) {
+        pushHistory(input[i]);
+        if (--m_sincSkip > 0)
+            continue;
+
+        // Every output whose position falls on this input sample.
+        const float* window = m_history.data() + m_historyPos;
+        while (m_sincSkip == 0) {
+            output[written++] = m_dot(coeffs + static_cast<size_t>(m_sincPhase) * m_taps, window, m_taps);
+            m_sincPhase += m_downFactor;
+            m_sincSkip = m_sincPhase / m_upFactor;
+            m_sincPhase %= m_upFactor;
+        }
+    }
+    return written;
 }
 
 void Resampler::reset()
 {
     m_pos = 0.0;
     std::fill(m_prevSamples.begin(), m_prevSamples.end(), 0.0f);
-    m_queue.clear();
-    std::fill(m_delay.begin(), m_delay.end(), 0.0f);
+    std::fill(m_history.begin(), m_history.end(), 0.0f);
+    m_historyPos = 0;
+    m_decimPhase = 0;
+    m_sincPhase = 0;
+    m_sincSkip = 1;
 }
@@ -18,35 +18,105 @@
 #ifndef RESAMPLER_H
 #define RESAMPLER_H
 
+#include <array>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
-#include <deque>
-
+// 48 kHz <-> 16 kHz conversion uses the SvxLink polyphase FIR filters.  Any
+// other mono ratio that reduces to at most MAX_SINC_PHASES output phases
+// (44.1 kHz, 22.05 kHz, 8 kHz, ...) uses a Kaiser-windowed sinc polyphase
+// filter whose taps depend on the quality tier; everything else, and the
+// Linear tier, falls back to linear interpolation.
+//
+// FIR history lives in a doubled circular delay line, so each new sample is
+// one write and every output is a single dot product over contiguous memory.
+// The dot product runs on the widest kernel the CPU supports; the scalar
+// kernel sums in the same order as the original SvxLink filter.
 class Resampler {
 public:
-    Resampler(int inRate, int outRate, int channels);
+    enum class Kernel { Scalar, Sse, Avx2, Neon };
+    // Windowed-sinc tiers trade taps per output for stopband attenuation.
+    enum class Quality { Linear, Fast, Balanced, High };
+    static constexpr Quality DEFAULT_QUALITY = Quality::Balanced;
+    static constexpr int MAX_SINC_PHASES = 1024;
+
+    Resampler(int inRate, int outRate, int channels, Quality quality = DEFAULT_QUALITY);
     ~Resampler();
 
     Resampler(const Resampler&) = delete;
     Resampler& operator=(const Resampler&) = delete;
 
     std::vector<float> process(const float* input, int sampleCount);
+
+    // Never allocates.  output must hold maxOutputSamples(sampleCount)
+    // samples; returns how many were written, or -1 (with no state change)
+    // when outputCapacity is smaller than that.
+    int process(const float* input, int sampleCount, float* output, int outputCapacity);
+    int maxOutputSamples(int sampleCount) const;
     void reset();
 
+    int inputRate() const { return m_inRate; }
+    int outputRate() const { return m_outRate; }
+    Quality quality() const { return m_quality; }
+    // Taps per output sample; 0 in linear mode.
+    int filterTaps() const { return m_taps; }
+
+    static const char* qualityName(Quality quality);
+    static Kernel bestKernel();
+    static bool isKernelSupported(Kernel kernel);
+    static const char* kernelName(Kernel kernel);
+    Kernel kernel() const { return m_kernel; }
+    bool setKernel(Kernel kernel);
+
 private:
-    enum Mode { Linear, Decim48To16, Interp16To48 } m_mode = Linear;
+    enum Mode { Linear, Decim48To16, Interp16To48, Sinc } m_mode = Linear;
+    static constexpr int INTERP_PHASES = 3;
+
+    // Coefficients for one ratio and tier, built once and shared by every
+    // resampler that uses them.
+    struct SincFilterBank {
+        int phases = 0;
+        int taps = 0;
+        std::vector<float> coeffs; // phase-major, taps per phase
+    };
+    static std::shared_ptr<const SincFilterBank> sincFilterBank(int upFactor, int downFactor, Quality quality);
+
+    using DotProduct = float (*)(const float* a, const float* b, int count);
+
+    int processLinear(const float* input, int sampleCount, float* output);
+    int processDecimation(const float* input, int sampleCount, float* output);
+    int processInterpolation(const float* input, int sampleCount, float* output);
+    int processSinc(const float* input, int sampleCount, float* output);
+    void pushHistory(float sample);
 
     int m_inRate;
     int m_outRate;
     int m_channels;
+    Quality m_quality;
+    Kernel m_kernel = Kernel::Scalar;
+    DotProduct m_dot = nullptr;
 
     // Linear mode state
     std::vector<float> m_prevSamples;
     double m_pos = 0.0;
 
-    // FIR mode state
-    std::deque<float> m_queue;
-    std::vector<float> m_delay;
+    // FIR mode state.  m_history holds every sample twice so the newest
+    // m_taps samples always sit contiguously at m_historyPos, newest first.
+    int m_taps = 0;
+    int m_historyPos = 0;
+    std::vector<float> m_history;
+    int m_decimPhase = 0;
+    std::vector<float> m_decimCoeffs;
+    std::array<std::vector<float>, INTERP_PHASES> m_phaseCoeffs;
+
+    // Sinc mode: output k sits at input k * m_downFactor / m_upFactor.
+    int m_upFactor = 1;
+    int m_downFactor = 1;
+    std::shared_ptr<const SincFilterBank> m_sincBank;
+    int m_sincPhase = 0;
+    // Input samples still to push before the next output is due.
+    int m_sincSkip = 1;
 };
 
 #endif // RESAMPLER_H
@@ -31,6 +31,9 @@ Page {
     required property real txAudioLevelDb
     required property int txTimeoutSeconds
     required property int pttHangTimeMs
+    required property int txPacketizationMs
+    required property int txFrameSizeMs
+    required property int txHeaderSavingsBitsPerSecond
     required property bool tapToTalkButtonVisible
     required property var reflectorClient
     property bool downloadableLanguagesExpanded: false
@@ -55,6 +58,7 @@ Page {
     signal txAudioLevelRequested(real levelDb)
     signal txTimeoutSecondsRequested(int seconds)
     signal pttHangTimeMsRequested(int milliseconds)
+    signal txPacketizationMsRequested(int milliseconds)
     signal tapToTalkButtonVisibleRequested(bool visible)
     signal hardwarePttEnabledRequested(bool enabled)
     signal learnedHardwarePttKeyCodeRequested(int keyCode)
@@ -1268,6 +1272,83 @@ Page {
                     }
                 }
 
+                Frame {
+                    visible: !page.compactSettingsMode || page.compactSection === "radio"
+                    width: parent.width
+                    padding: page.uiMetrics.sectionPadding
+                    implicitHeight: implicitContentHeight + topPadding + bottomPadding
+                    Accessible.role: Accessible.Grouping
+                    Accessible.name: qsTr("Transmit packet size")
+
+                    background: Rectangle {
+                        Accessible.ignored: true
+                        radius: page.uiMetrics.frameRadius
+                        color: page.surfaceColor
+                        border.color: page.borderColor
+                    }
+
+                    contentItem: ColumnLayout {
+                        spacing: 12
+
+                        Label {
+                            text: qsTr("Transmit Packet Size")
+                            font.pixelSize: page.uiMetrics.sectionTitleFontSize
+                            font.bold: true
+                            Accessible.role: Accessible.StaticText
+                            Accessible.name: text
+                        }
+
+                        Label {
+                            Layout.fillWidth: true
+                            text: qsTr("Longer packets send fewer headers and wake the mobile radio less often, for a little more delay. Automatic uses 60 ms on metered networks and longer packets on distant servers. Applies from the next transmission.")
+                            wrapMode: Text.WordWrap
+                            color: "#556070"
+                            Accessible.role: Accessible.StaticText
+                            Accessible.name: text
+                        }
+
+                        GridLayout {
+                            columns: page.compactSettingsMode ? 2 : 4
+                            rowSpacing: 8
+                            columnSpacing: 8
+                            Layout.fillWidth: true
+
+                            Repeater {
+                                model: [
+                                    { milliseconds: 0, label: qsTr("Automatic") },
+                                    { milliseconds: 20, label: qsTr("20 ms") },
+                                    { milliseconds: 40, label: qsTr("40 ms") },
+                                    { milliseconds: 60, label: qsTr("60 ms") }
+                                ]
+
+                                delegate: Button {
+                                    required property var modelData
+
+                                    Layout.fillWidth: true
+                                    text: modelData.label
+                                    highlighted: page.txPacketizationMs === modelData.milliseconds
+                                    Accessible.name: qsTr("Transmit packet size %1").arg(modelData.label)
+                                    onClicked: page.txPacketizationMsRequested(modelData.milliseconds)
+                                }
+                            }
+                        }
+
+                        Label {
+                            Layout.fillWidth: true
+                            text: page.txFrameSizeMs > 20
+                                  ? qsTr("Sending %1 ms packets: %2 packets per second instead of 50, about %3 kbit/s less header traffic.")
+                                        .arg(page.txFrameSizeMs)
+                                        .arg(Math.round(1000 / page.txFrameSizeMs))
+                                        .arg((page.txHeaderSavingsBitsPerSecond / 1000).toFixed(1))
+                                  : qsTr("Sending 20 ms packets: 50 packets per second.")
+                            wrapMode: Text.WordWrap
+                            color: "#556070"
+                            Accessible.role: Accessible.StaticText
+                            Accessible.name: text
+                        }
+                    }
+                }
+
                 Frame {
                     visible: !page.compactSettingsMode || page.compactSection === "radio"
                     width: parent.width
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2025 Silviu YO6SAY
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "TcpFrameReader.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+constexpr int kLengthPrefixBytes = sizeof(uint32_t);
+
+uint32_t loadBigEndian(const char* bytes, int count)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < count; ++i) {
+        value = (value << 8) | static_cast<uint8_t>(bytes[i]);
+    }
+    return value;
+}
+}
+
+bool PayloadReader::take(int count, const char** bytes)
+{
+    if (!m_ok || count < 0 || count > remaining()) {
+        m_ok = false;
+        return false;
+    }
+    *bytes = m_data + m_position;
+    m_position += count;
+    return true;
+}
+
+uint8_t PayloadReader::readU8()
+{
+    const char* bytes = nullptr;
+    return take(1, &bytes) ? static_cast<uint8_t>(bytes[0]) : 0;
+}
+
+uint16_t PayloadReader::readU16()
+{
+    const char* bytes = nullptr;
+    return take(2, &bytes) ? static_cast<uint16_t>(loadBigEndian(bytes, 2)) : 0;
+}
+
+uint32_t PayloadReader::readU32()
+{
+    const char* bytes = nullptr;
+    return take(4, &bytes) ? loadBigEndian(bytes, 4) : 0;
+}
+
+float PayloadReader::readFloat()
+{
+    const uint32_t bits = readU32();
+    float value = 0.0f;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+PayloadReader PayloadReader::readBytes(int count)
+{
+    const char* bytes = nullptr;
+    return take(count, &bytes) ? PayloadReader(bytes, count) : PayloadReader();
+}
+
+PayloadReader PayloadReader::readLengthPrefixed()
+{
+    const int length = readU16();
+    return m_ok ? readBytes(length) : PayloadReader();
+}
+
+TcpFrameReader::TcpFrameReader(uint32_t maxFrameBytes, int initialCapacity)
+    : m_buffer(static_cast<size_t>(std::max(initialCapacity, kLengthPrefixBytes)))
+    , m_maxFrameBytes(maxFrameBytes)
+{
+}
+
+char* TcpFrameReader::prepareWrite(int count)
+{
+    count = std::max(count, 0);
+    if (capacity() - m_writePosition < count) {
+        // Only the unread tail moves, and only because this read needs
+        // the room; the frames already taken never get copied.
+        const int unread = buffered();
+        if (m_readPosition > 0) {
+            if (unread > 0) {
+                std::memmove(m_buffer.data(), m_buffer.data() + m_readPosition, static_cast<size_t>(unread));
+                m_compactedBytes += static_cast<uint64_t>(unread);
+            }
+            m_readPosition = 0;
+            m_writePosition = unread;
+        }
+        if (capacity() - m_writePosition < count) {
+            m_buffer.resize(std::max(m_buffer.size() * 2, static_cast<size_t>(m_writePosition + count)));
+        }
+    }
+    return m_buffer.data() + m_writePosition;
+}
+
+void TcpFrameReader::commitWrite(int count)
+{
+    m_writePosition = std::clamp(m_writePosition + std::max(count, 0), m_writePosition, capacity());
+}
+
+void TcpFrameReader::append(const char* data, int count)
+{
+    if (data == nullptr || count <= 0) {
+        return;
+    }
+    std::memcpy(prepareWrite(count), data, static_cast<size_t>(count));
+    commitWrite(count);
+}
+
+TcpFrameReader::Result TcpFrameReader::next(PayloadReader& payload)
+{
+    if (buffered() < kLengthPrefixBytes) {
+        return Result::NeedMore;
+    }
+
+    const char* frame = m_buffer.data() + m_readPosition;
+    m_lastFrameBytes = loadBigEndian(frame, kLengthPrefixBytes);
+    if (m_lastFrameBytes > m_maxFrameBytes) {
+        return Result::Oversized;
+    }
+    const int payloadBytes = static_cast<int>(m_lastFrameBytes);
+    if (buffered() - kLengthPrefixBytes < payloadBytes) {
+        return Result::NeedMore;
+    }
+
+    payload = PayloadReader(frame + kLengthPrefixBytes, payloadBytes);
+    m_readPosition += kLengthPrefixBytes + payloadBytes;
+    if (m_readPosition == m_writePosition) {
+        // Drained: the next read starts at the front for free.  The view
+        // handed out above still points at bytes nothing has overwritten.
+        m_readPosition = 0;
+        m_writePosition = 0;
+    }
+    return Result::Frame;
+}
+
+void TcpFrameReader::clear()
+{
+    m_readPosition = 0;
+    m_writePosition = 0;
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2025 Silviu YO6SAY
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TCPFRAMEREADER_H
+#define TCPFRAMEREADER_H
+
+#include <cstdint>
+#include <vector>
+
+// Bounds-checked big-endian cursor over bytes it does not own.
+//
+// Copying one is free, so a handler that needs to look ahead reads from a
+// copy.  A read past the end returns zero (or an empty view), leaves the
+// cursor where it was and makes ok() false for good, the way a QDataStream
+// status sticks, so a handler can read every field first and check once.
+class PayloadReader
+{
+public:
+    PayloadReader() = default;
+    PayloadReader(const char* data, int size)
+        : m_data(data), m_size(size > 0 ? size : 0) {}
+
+    uint8_t readU8();
+    uint16_t readU16();
+    uint32_t readU32();
+    float readFloat();
+    // The next count bytes as a view of their own.
+    PayloadReader readBytes(int count);
+    // A 16-bit length followed by that many bytes, as Svxlink sends strings.
+    PayloadReader readLengthPrefixed();
+
+    bool ok() const { return m_ok; }
+    bool atEnd() const { return m_position == m_size; }
+    int remaining() const { return m_size - m_position; }
+    // The unread bytes.
+    const char* data() const { return m_data + m_position; }
+    int size() const { return remaining(); }
+
+private:
+    bool take(int count, const char** bytes);
+
+    const char* m_data = nullptr;
+    int m_size = 0;
+    int m_position = 0;
+    bool m_ok = true;
+};
+
+// Splits the reflector's TCP stream into its 32-bit length-prefixed frames.
+//
+// Socket reads land straight in one reusable buffer and frames are handed
+// out as views into it, so taking a frame moves a cursor instead of
+// memmoving everything behind it and copying the payload.  The unread tail
+// is moved to the front only when a read needs the room, which is at most
+// one partial frame per read however long the burst.
+//
+// A payload view stays valid until the next prepareWrite(), append() or
+// clear().  Owned by the thread that reads the socket; not thread-safe.
+class TcpFrameReader
+{
+public:
+    enum class Result {
+        Frame,
+        NeedMore,
+        // The length prefix is over the limit; the stream cannot be resynced.
+        Oversized
+    };
+
+    static constexpr uint32_t DEFAULT_MAX_FRAME_BYTES = 1024 * 1024;
+
+    explicit TcpFrameReader(uint32_t maxFrameBytes = DEFAULT_MAX_FRAME_BYTES,
+                            int initialCapacity = 16 * 1024);
+
+    // Room for at least count more bytes at the write position; fill it and
+    // then commitWrite() what was actually written.
+    char* prepareWrite(int count);
+    void commitWrite(int count);
+    void append(const char* data, int count);
+
+    Result next(PayloadReader& payload);
+    // Keeps the buffer for the next connection.
+    void clear();
+
+    int buffered() const { return m_writePosition - m_readPosition; }
+    int capacity() const { return static_cast<int>(m_buffer.size()); }
+    uint32_t lastFrameBytes() const { return m_lastFrameBytes; }
+    uint64_t compactedBytes() const { return m_compactedBytes; }
+
+private:
+    std::vector<char> m_buffer;
+    uint32_t m_maxFrameBytes;
+    int m_readPosition = 0;
+    int m_writePosition = 0;
+    uint32_t m_lastFrameBytes = 0;
+    uint64_t m_compactedBytes = 0;
+};
+
+#endif // TCPFRAMEREADER_H
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2025 Silviu YO6SAY
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "TxEncodeThread.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#  include <pthread.h>
+#  include <sched.h>
+#  include <sys/resource.h>
+#endif
+#if defined(__linux__)
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+namespace {
+// THREAD_PRIORITY_URGENT_AUDIO, what AndroidAudioRecordInput asks for.
+constexpr int kUrgentAudioNice = -19;
+}
+
+TxEncodeThread::TxEncodeThread(Handler handler)
+    : m_handler(std::move(handler))
+{
+}
+
+TxEncodeThread::~TxEncodeThread()
+{
+    stop();
+}
+
+bool TxEncodeThread::start()
+{
+    if (isRunning() || !m_handler) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_wakePending = false;
+        m_stopRequested = false;
+    }
+    m_priority.store(Priority::Normal, std::memory_order_release);
+    m_thread = std::thread(&TxEncodeThread::run, this);
+    return true;
+}
+
+void TxEncodeThread::stop()
+{
+    if (!isRunning()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stopRequested = true;
+    }
+    m_wakeCondition.notify_one();
+    m_thread.join();
+}
+
+void TxEncodeThread::wake()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        if (m_wakePending) {
+            return;
+        }
+        m_wakePending = true;
+    }
+    m_wakeCondition.notify_one();
+}
+
+void TxEncodeThread::run()
+{
+    raisePriority();
+
+    std::unique_lock<std::mutex> lock(m_wakeMutex);
+    while (true) {
+        m_wakeCondition.wait(lock, [this]() { return m_wakePending || m_stopRequested; });
+        if (m_stopRequested) {
+            break;
+        }
+        m_wakePending = false;
+
+        lock.unlock();
+        m_handler();
+        lock.lock();
+    }
+}
+
+void TxEncodeThread::raisePriority()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    sched_param param{};
+    param.sched_priority = sched_get_priority_min(SCHED_FIFO) + 1;
+    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0) {
+        m_priority.store(Priority::RealTime, std::memory_order_release);
+        return;
+    }
+#endif
+#if defined(__linux__)
+    // Per-thread on Linux and Android, where a thread is its own task.
+    const auto threadId = static_cast<id_t>(::syscall(SYS_gettid));
+    if (::setpriority(PRIO_PROCESS, threadId, kUrgentAudioNice) == 0) {
+        m_priority.store(Priority::Nice, std::memory_order_release);
+    }
+#endif
+}
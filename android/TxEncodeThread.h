@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2025 Silviu YO6SAY
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TXENCODETHREAD_H
+#define TXENCODETHREAD_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Runs the TX encode stage on a thread of its own so Opus encoding does not
+// wait behind RX decoding, timers and route handling on the AudioEngine
+// event loop.
+//
+// The thread asks for SCHED_FIFO and falls back to nice -19 (Android's
+// THREAD_PRIORITY_URGENT_AUDIO) where that is refused; priority() reports
+// what it got.  It sleeps until wake() and then calls the handler once for
+// however many wakes arrived meanwhile, so the handler should drain
+// everything that is ready.  The handler runs on the encode thread, so it
+// should neither log nor emit queued signals, both of which allocate.
+class TxEncodeThread
+{
+public:
+    enum class Priority {
+        Normal,
+        Nice,
+        RealTime
+    };
+
+    using Handler = std::function<void()>;
+
+    explicit TxEncodeThread(Handler handler);
+    ~TxEncodeThread();
+    TxEncodeThread(const TxEncodeThread&) = delete;
+    TxEncodeThread& operator=(const TxEncodeThread&) = delete;
+
+    bool start();
+    // Returns once the handler has finished and the thread has exited.
+    void stop();
+    bool isRunning() const { return m_thread.joinable(); }
+
+    // Any thread.
+    void wake();
+
+    Priority priority() const { return m_priority.load(std::memory_order_acquire); }
+
+private:
+    void run();
+    void raisePriority();
+
+    Handler m_handler;
+    std::thread m_thread;
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCondition;
+    bool m_wakePending = false;
+    bool m_stopRequested = false;
+    std::atomic<Priority> m_priority{Priority::Normal};
+};
+
+#endif // TXENCODETHREAD_H
@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2025 Silviu YO6SAY
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "UdpAudioSender.h"
+
+#include <cstddef>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#  define LATRY_UDP_AUDIO_SENDER 1
+#  include <cerrno>
+#  include <netinet/in.h>
+#  include <sys/socket.h>
+#  include <sys/uio.h>
+#endif
+
+#if defined(__linux__)
+#  define LATRY_HAVE_SENDMMSG 1
+#endif
+
+namespace {
+void writeBigEndian16(unsigned char* data, uint16_t value)
+{
+    data[0] = static_cast<unsigned char>(value >> 8);
+    data[1] = static_cast<unsigned char>(value & 0xff);
+}
+}
+
+#if defined(LATRY_UDP_AUDIO_SENDER)
+static_assert(sizeof(sockaddr_in6) <= 28,
+              "peer address storage must hold a sockaddr_in6");
+#endif
+
+UdpAudioSender::UdpAudioSender(std::atomic<uint16_t> &sequence)
+    : m_sequence(sequence)
+{
+}
+
+UdpAudioSender::~UdpAudioSender()
+{
+    close();
+}
+
+bool UdpAudioSender::isSupported()
+{
+#if defined(LATRY_UDP_AUDIO_SENDER)
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool UdpAudioSender::open(intptr_t socketDescriptor, const uint8_t* address, int addressLength,
+                          uint16_t port, uint16_t clientId)
+{
+#if defined(LATRY_UDP_AUDIO_SENDER)
+    if (socketDescriptor < 0 || address == nullptr || (addressLength != 4 && addressLength != 16)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_sessionMutex);
+    m_peerAddress.fill(0);
+    if (addressLength == 4) {
+        sockaddr_in peer{};
+        peer.sin_family = AF_INET;
+        peer.sin_port = htons(port);
+        std::memcpy(&peer.sin_addr, address, 4);
+        std::memcpy(m_peerAddress.data(), &peer, sizeof(peer));
+        m_peerAddressLength = sizeof(peer);
+    } else {
+        sockaddr_in6 peer{};
+        peer.sin6_family = AF_INET6;
+        peer.sin6_port = htons(port);
+        std::memcpy(&peer.sin6_addr, address, 16);
+        std::memcpy(m_peerAddress.data(), &peer, sizeof(peer));
+        m_peerAddressLength = sizeof(peer);
+    }
+
+    writeBigEndian16(reinterpret_cast<unsigned char*>(&m_header.type), Svxlink::UdpMsgType::UDP_AUDIO);
+    writeBigEndian16(reinterpret_cast<unsigned char*>(&m_header.clientId), clientId);
+    m_socket = static_cast<int>(socketDescriptor);
+    m_open.store(true, std::memory_order_release);
+    return true;
+#else
+    (void)socketDescriptor;
+    (void)address;
+    (void)addressLength;
+    (void)port;
+    (void)clientId;
+    return false;
+#endif
+}
+
+void UdpAudioSender::close()
+{
+    std::lock_guard<std::mutex> lock(m_sessionMutex);
+    m_open.store(false, std::memory_order_release);
+    m_socket = -1;
+    m_peerAddressLength = 0;
+}
+
+unsigned char* UdpAudioSender::beginFrame()
+{
+    if (m_pendingFrames == POOL_SIZE) {
+        flush();
+    }
+    return m_pool[static_cast<size_t>(m_pendingFrames)].datagram.data() + HEADER_BYTES;
+}
+
+void UdpAudioSender::commitFrame(int payloadBytes)
+{
+    if (payloadBytes <= 0 || payloadBytes > MAX_PAYLOAD_BYTES || m_pendingFrames == POOL_SIZE) {
+        return;
+    }
+    m_pool[static_cast<size_t>(m_pendingFrames)].size = payloadBytes;
+    ++m_pendingFrames;
+}
+
+int UdpAudioSender::flush()
+{
+    if (m_pendingFrames == 0) {
+        return 0;
+    }
+
+    int sent = 0;
+    {
+        // Uncontended except while a session opens or closes.
+        std::lock_guard<std::mutex> lock(m_sessionMutex);
+        if (m_open.load(std::memory_order_relaxed) && m_transmitEnabled.load(std::memory_order_acquire)) {
+            sent = sendPending();
+        }
+    }
+    m_pendingFrames = 0;
+    return sent;
+}
+
+int UdpAudioSender::sendPending()
+{
+#if defined(LATRY_UDP_AUDIO_SENDER)
+    for (int i = 0; i < m_pendingFrames; ++i) {
+        Slot &slot = m_pool[static_cast<size_t>(i)];
+        unsigned char* header = slot.datagram.data();
+        std::memcpy(header, &m_header, sizeof(m_header));
+        writeBigEndian16(header + offsetof(Svxlink::UdpMsgHeader, sequenceNum),
+                         m_sequence.fetch_add(1, std::memory_order_relaxed));
+        writeBigEndian16(header + sizeof(Svxlink::UdpMsgHeader), static_cast<uint16_t>(slot.size));
+    }
+
+    int sent = 0;
+#if defined(LATRY_HAVE_SENDMMSG)
+    std::array<mmsghdr, POOL_SIZE> messages{};
+    std::array<iovec, POOL_SIZE> buffers{};
+    for (int i = 0; i < m_pendingFrames; ++i) {
+        const size_t index = static_cast<size_t>(i);
+        buffers[index].iov_base = m_pool[index].datagram.data();
+        buffers[index].iov_len = static_cast<size_t>(HEADER_BYTES + m_pool[index].size);
+        messages[index].msg_hdr.msg_name = m_peerAddress.data();
+        messages[index].msg_hdr.msg_namelen = m_peerAddressLength;
+        messages[index].msg_hdr.msg_iov = &buffers[index];
+        messages[index].msg_hdr.msg_iovlen = 1;
+    }
+
+    // A partial send leaves the rest for another call; an error drops them.
+    while (sent < m_pendingFrames) {
+        const int result = ::sendmmsg(m_socket, messages.data() + sent,
+                                      static_cast<unsigned int>(m_pendingFrames - sent), MSG_DONTWAIT);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            m_sendErrors.fetch_add(static_cast<uint64_t>(m_pendingFrames - sent), std::memory_order_relaxed);
+            break;
+        }
+        m_batchesSent.fetch_add(1, std::memory_order_relaxed);
+        sent += result;
+    }
+#else
+    for (int i = 0; i < m_pendingFrames; ++i) {
+        const Slot &slot = m_pool[static_cast<size_t>(i)];
+        const ssize_t result = ::sendto(m_socket, slot.datagram.data(), static_cast<size_t>(HEADER_BYTES + slot.size),
+                                        MSG_DONTWAIT, reinterpret_cast<const sockaddr*>(m_peerAddress.data()),
+                                        static_cast<socklen_t>(m_peerAddressLength));
+        if (result < 0) {
+            m_sendErrors.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            ++sent;
+        }
+    }
+    m_batchesSent.fetch_add(1, std::memory_order_relaxed);
+#endif
+    m_datagramsSent.fetch_add(static_cast<uint64_t>(sent), std::memory_order_relaxed);
+    return sent;
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2025 Silviu YO6SAY
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef UDPAUDIOSENDER_H
+#define UDPAUDIOSENDER_H
+
+#include "ReflectorProtocol.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+// Sends encoded TX audio to the reflector straight from the audio thread.
+//
+// The encoder writes each frame into a pooled datagram slot that already
+// sits behind room for the UDP_AUDIO header; commitFrame() records its size
+// and flush() fills in the prebuilt header, the sequence number and the
+// length, then sends every pending slot in one sendmmsg() call on Linux and
+// Android (a sendto loop elsewhere).  The peer address is resolved once per
+// session by open().
+//
+// beginFrame(), commitFrame() and flush() belong to the audio thread;
+// open(), close() and setTransmitEnabled() may be called from any thread.
+// The socket stays owned by its QUdpSocket; close() must be called before
+// that socket is closed.
+class UdpAudioSender
+{
+public:
+    static constexpr int POOL_SIZE = 8;
+    static constexpr int MAX_DATAGRAM_BYTES = 1500;
+    static constexpr int HEADER_BYTES = static_cast<int>(sizeof(Svxlink::MsgUdpAudio));
+    static constexpr int MAX_PAYLOAD_BYTES = MAX_DATAGRAM_BYTES - HEADER_BYTES;
+
+    // Sequence numbers are shared with the heartbeats and flushes the client
+    // sends itself.
+    explicit UdpAudioSender(std::atomic<uint16_t> &sequence);
+    ~UdpAudioSender();
+    UdpAudioSender(const UdpAudioSender&) = delete;
+    UdpAudioSender& operator=(const UdpAudioSender&) = delete;
+
+    static bool isSupported();
+
+    // address is 4 (IPv4) or 16 (IPv6) bytes in network order.
+    bool open(intptr_t socketDescriptor, const uint8_t* address, int addressLength,
+              uint16_t port, uint16_t clientId);
+    void close();
+    bool isOpen() const { return m_open.load(std::memory_order_acquire); }
+
+    // Frames are only sent while transmitting; anything committed while
+    // disabled is dropped at flush().
+    void setTransmitEnabled(bool enabled) { m_transmitEnabled.store(enabled, std::memory_order_release); }
+    bool isActive() const { return isOpen() && m_transmitEnabled.load(std::memory_order_acquire); }
+
+    // Payload area of the next free slot, MAX_PAYLOAD_BYTES long.
+    unsigned char* beginFrame();
+    void commitFrame(int payloadBytes);
+    int pendingFrames() const { return m_pendingFrames; }
+    // Sends all committed frames; returns how many went out.
+    int flush();
+
+    uint64_t datagramsSent() const { return m_datagramsSent.load(std::memory_order_relaxed); }
+    uint64_t batchesSent() const { return m_batchesSent.load(std::memory_order_relaxed); }
+    uint64_t sendErrors() const { return m_sendErrors.load(std::memory_order_relaxed); }
+
+private:
+    int sendPending();
+
+    struct Slot {
+        int size = 0;
+        alignas(8) std::array<unsigned char, MAX_DATAGRAM_BYTES> datagram{};
+    };
+
+    std::atomic<uint16_t> &m_sequence;
+    std::array<Slot, POOL_SIZE> m_pool{};
+    int m_pendingFrames = 0;
+
+    // Session state, written by open()/close() under m_sessionMutex.
+    std::mutex m_sessionMutex;
+    std::atomic<bool> m_open{false};
+    std::atomic<bool> m_transmitEnabled{false};
+    int m_socket = -1;
+    // Room for a sockaddr_in6.
+    alignas(8) std::array<unsigned char, 28> m_peerAddress{};
+    uint32_t m_peerAddressLength = 0;
+    Svxlink::UdpMsgHeader m_header{};
+
+    std::atomic<uint64_t> m_datagramsSent{0};
+    std::atomic<uint64_t> m_batchesSent{0};
+    std::atomic<uint64_t> m_sendErrors{0};
+};
+
+#endif // UDPAUDIOSENDER_H
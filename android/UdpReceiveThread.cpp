@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2025 Silviu YO6SAY
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "UdpReceiveThread.h"
+#include "ReflectorProtocol.h"
+
+#include <array>
+#include <chrono>
+
+#if defined(__unix__) || defined(__APPLE__)
+#  define LATRY_UDP_RECEIVE_THREAD 1
+#  include <cerrno>
+#  include <fcntl.h>
+#  include <poll.h>
+#  include <sys/socket.h>
+#  include <sys/uio.h>
+#  include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#  define LATRY_HAVE_RECVMMSG 1
+#endif
+
+namespace {
+constexpr int kHeaderBytes = 3 * sizeof(uint16_t);
+constexpr int kAudioHeaderBytes = kHeaderBytes + sizeof(uint16_t);
+
+uint16_t readBigEndian16(const unsigned char* data)
+{
+    return static_cast<uint16_t>((data[0] << 8) | data[1]);
+}
+
+int64_t steadyNowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}
+
+UdpReceiveThread::UdpReceiveThread(AudioHandler audioHandler, ControlHandler controlHandler)
+    : m_audioHandler(std::move(audioHandler))
+    , m_controlHandler(std::move(controlHandler))
+{
+}
+
+UdpReceiveThread::~UdpReceiveThread()
+{
+    stop();
+}
+
+bool UdpReceiveThread::isSupported()
+{
+#if defined(LATRY_UDP_RECEIVE_THREAD)
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool UdpReceiveThread::start(intptr_t socketDescriptor)
+{
+#if defined(LATRY_UDP_RECEIVE_THREAD)
+    if (isRunning() || socketDescriptor < 0) {
+        return false;
+    }
+
+    int wakeFds[2] = {-1, -1};
+    if (::pipe(wakeFds) != 0) {
+        return false;
+    }
+    ::fcntl(wakeFds[0], F_SETFL, ::fcntl(wakeFds[0], F_GETFL, 0) | O_NONBLOCK);
+    ::fcntl(wakeFds[1], F_SETFL, ::fcntl(wakeFds[1], F_GETFL, 0) | O_NONBLOCK);
+
+    m_socket = static_cast<int>(socketDescriptor);
+    m_wakeReadFd = wakeFds[0];
+    m_wakeWriteFd = wakeFds[1];
+    m_storage.assign(static_cast<size_t>(BATCH_SIZE) * MAX_DATAGRAM_BYTES, 0);
+    m_stopRequested.store(false, std::memory_order_relaxed);
+    m_thread = std::thread(&UdpReceiveThread::receiveLoop, this);
+    return true;
+#else
+    (void)socketDescriptor;
+    return false;
+#endif
+}
+
+void UdpReceiveThread::stop()
+{
+#if defined(LATRY_UDP_RECEIVE_THREAD)
+    if (!isRunning()) {
+        return;
+    }
+
+    m_stopRequested.store(true, std::memory_order_relaxed);
+    const unsigned char wake = 1;
+    [[maybe_unused]] const ssize_t written = ::write(m_wakeWriteFd, &wake, sizeof(wake));
+    m_thread.join();
+
+    ::close(m_wakeReadFd);
+    ::close(m_wakeWriteFd);
+    m_wakeReadFd = -1;
+    m_wakeWriteFd = -1;
+    m_socket = -1;
+#endif
+}
+
+void UdpReceiveThread::receiveLoop()
+{
+#if defined(LATRY_UDP_RECEIVE_THREAD)
+    std::array<int, BATCH_SIZE> sizes{};
+    std::array<pollfd, 2> fds{};
+    fds[0].fd = m_socket;
+    fds[0].events = POLLIN;
+    fds[1].fd = m_wakeReadFd;
+    fds[1].events = POLLIN;
+
+    while (!m_stopRequested.load(std::memory_order_relaxed)) {
+        if (::poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (fds[1].revents != 0 || (fds[0].revents & (POLLERR | POLLNVAL)) != 0) {
+            break;
+        }
+
+        // Keep reading until the socket is empty; each batch is one syscall.
+        int received = 0;
+        while ((received = receiveBatch(sizes.data())) > 0) {
+            const int64_t arrivalUs = steadyNowUs();
+            m_batchesReceived.fetch_add(1, std::memory_order_relaxed);
+            m_datagramsReceived.fetch_add(static_cast<uint64_t>(received), std::memory_order_relaxed);
+            for (int i = 0; i < received; ++i) {
+                dispatchDatagram(m_storage.data() + static_cast<size_t>(i) * MAX_DATAGRAM_BYTES,
+                                 sizes[static_cast<size_t>(i)], arrivalUs);
+            }
+            if (received < BATCH_SIZE) {
+                break;
+            }
+        }
+        if (received < 0) {
+            break;
+        }
+    }
+#endif
+}
+
+int UdpReceiveThread::receiveBatch(int* sizes)
+{
+#if defined(LATRY_HAVE_RECVMMSG)
+    std::array<mmsghdr, BATCH_SIZE> messages{};
+    std::array<iovec, BATCH_SIZE> buffers{};
+    for (int i = 0; i < BATCH_SIZE; ++i) {
+        buffers[static_cast<size_t>(i)].iov_base = m_storage.data() + static_cast<size_t>(i) * MAX_DATAGRAM_BYTES;
+        buffers[static_cast<size_t>(i)].iov_len = MAX_DATAGRAM_BYTES;
+        messages[static_cast<size_t>(i)].msg_hdr.msg_iov = &buffers[static_cast<size_t>(i)];
+        messages[static_cast<size_t>(i)].msg_hdr.msg_iovlen = 1;
+    }
+
+    const int received = ::recvmmsg(m_socket, messages.data(), BATCH_SIZE, MSG_DONTWAIT, nullptr);
+    if (received < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1;
+    }
+    for (int i = 0; i < received; ++i) {
+        const auto& header = messages[static_cast<size_t>(i)].msg_hdr;
+        // Oversized datagrams are not reflector messages; flag them as such.
+        sizes[i] = (header.msg_flags & MSG_TRUNC) != 0 ? 0 : static_cast<int>(messages[static_cast<size_t>(i)].msg_len);
+    }
+    return received;
+#elif defined(LATRY_UDP_RECEIVE_THREAD)
+    int received = 0;
+    for (; received < BATCH_SIZE; ++received) {
+        const ssize_t size = ::recv(m_socket, m_storage.data() + static_cast<size_t>(received) * MAX_DATAGRAM_BYTES,
+                                    MAX_DATAGRAM_BYTES, MSG_DONTWAIT);
+        if (size < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                break;
+            }
+            return received > 0 ? received : -1;
+        }
+        sizes[received] = static_cast<int>(size);
+    }
+    return received;
+#else
+    (void)sizes;
+    return -1;
+#endif
+}
+
+void UdpReceiveThread::dispatchDatagram(const unsigned char* data, int size, int64_t arrivalUs)
+{
+    if (size < kHeaderBytes) {
+        m_malformedDatagrams.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    const uint16_t type = readBigEndian16(data);
+    if (type == Svxlink::UdpMsgType::UDP_HEARTBEAT) {
+        return;
+    }
+    if (type != Svxlink::UdpMsgType::UDP_AUDIO) {
+        if (m_controlHandler) {
+            m_controlHandler(data, size, arrivalUs);
+        }
+        return;
+    }
+
+    const int audioLength = size >= kAudioHeaderBytes ? readBigEndian16(data + kHeaderBytes) : -1;
+    if (audioLength <= 0 || audioLength > size - kAudioHeaderBytes) {
+        m_malformedDatagrams.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (m_audioHandler) {
+        m_audioHandler(data + kAudioHeaderBytes, audioLength, readBigEndian16(data + 2 * sizeof(uint16_t)),
+                       arrivalUs);
+    }
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2025 Silviu YO6SAY
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef UDPRECEIVETHREAD_H
+#define UDPRECEIVETHREAD_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// Drains the reflector UDP socket on its own thread so received audio does
+// not wait behind QML rendering or JNI callbacks on the GUI event loop.
+//
+// The thread blocks in poll() and reads up to BATCH_SIZE datagrams per
+// wake-up (recvmmsg on Linux/Android, a recvfrom loop elsewhere) into
+// storage allocated once at start().  Headers are parsed in place: audio
+// payloads go straight to the audio handler, heartbeats are dropped, and
+// every other message is passed whole to the control handler.  Handlers run
+// on the receive thread.
+//
+// The socket stays owned by its QUdpSocket, which keeps sending; its owner
+// must stop reading from it while this thread runs and call stop() before
+// closing it.
+class UdpReceiveThread
+{
+public:
+    using AudioHandler = std::function<void(const unsigned char* payload, int size,
+                                            uint16_t sequence, int64_t arrivalUs)>;
+    using ControlHandler = std::function<void(const unsigned char* datagram, int size,
+                                              int64_t arrivalUs)>;
+
+    static constexpr int BATCH_SIZE = 16;
+    static constexpr int MAX_DATAGRAM_BYTES = 2048;
+
+    UdpReceiveThread(AudioHandler audioHandler, ControlHandler controlHandler);
+    ~UdpReceiveThread();
+    UdpReceiveThread(const UdpReceiveThread&) = delete;
+    UdpReceiveThread& operator=(const UdpReceiveThread&) = delete;
+
+    static bool isSupported();
+
+    bool start(intptr_t socketDescriptor);
+    void stop();
+    bool isRunning() const { return m_thread.joinable(); }
+
+    uint64_t datagramsReceived() const { return m_datagramsReceived.load(std::memory_order_relaxed); }
+    uint64_t batchesReceived() const { return m_batchesReceived.load(std::memory_order_relaxed); }
+    uint64_t malformedDatagrams() const { return m_malformedDatagrams.load(std::memory_order_relaxed); }
+
+private:
+    void receiveLoop();
+    int receiveBatch(int* sizes);
+    void dispatchDatagram(const unsigned char* data, int size, int64_t arrivalUs);
+
+    AudioHandler m_audioHandler;
+    ControlHandler m_controlHandler;
+    std::thread m_thread;
+    int m_socket = -1;
+    int m_wakeReadFd = -1;
+    int m_wakeWriteFd = -1;
+    std::atomic<bool> m_stopRequested{false};
+    std::vector<unsigned char> m_storage;
+
+    std::atomic<uint64_t> m_datagramsReceived{0};
+    std::atomic<uint64_t> m_batchesReceived{0};
+    std::atomic<uint64_t> m_malformedDatagrams{0};
+};
+
+#endif // UDPRECEIVETHREAD_H
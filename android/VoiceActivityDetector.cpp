@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2025 Silviu YO6SAY
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "VoiceActivityDetector.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+constexpr int kSampleRate = 16000;
+constexpr int kLowBin = 300 * 512 / kSampleRate;    // ~300 Hz
+constexpr int kHighBin = 4000 * 512 / kSampleRate;  // 4 kHz
+constexpr float kPowerFloor = 1.0e-12f;
+}
+
+VoiceActivityDetector::VoiceActivityDetector()
+{
+    for (int i = 0; i < FRAME_SAMPLES; ++i) {
+        m_window[static_cast<size_t>(i)] =
+                static_cast<float>(0.5 - 0.5 * std::cos(2.0 * kPi * i / (FRAME_SAMPLES - 1)));
+    }
+    for (int i = 0; i < FFT_SIZE / 2; ++i) {
+        m_cos[static_cast<size_t>(i)] = static_cast<float>(std::cos(2.0 * kPi * i / FFT_SIZE));
+        m_sin[static_cast<size_t>(i)] = static_cast<float>(-std::sin(2.0 * kPi * i / FFT_SIZE));
+    }
+    int bits = 0;
+    while ((1 << bits) < FFT_SIZE) {
+        ++bits;
+    }
+    for (int i = 0; i < FFT_SIZE; ++i) {
+        int reversed = 0;
+        for (int b = 0; b < bits; ++b) {
+            reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        m_bitReverse[static_cast<size_t>(i)] = reversed;
+    }
+}
+
+void VoiceActivityDetector::reset()
+{
+    m_hasNoiseFloor = false;
+    m_noiseFloorDb = SILENCE_DB;
+    m_levelDb = SILENCE_DB;
+    m_flatness = 1.0f;
+    m_hangover = HANGOVER_FRAMES;
+}
+
+bool VoiceActivityDetector::process(const float* frame)
+{
+    if (frame == nullptr) {
+        return isActive();
+    }
+
+    double energy = 0.0;
+    for (int i = 0; i < FRAME_SAMPLES; ++i) {
+        energy += static_cast<double>(frame[i]) * frame[i];
+    }
+    const double meanSquare = energy / FRAME_SAMPLES;
+    m_levelDb = std::max(SILENCE_DB, static_cast<float>(10.0 * std::log10(meanSquare + 1.0e-20)));
+
+    // Below the silence level there is nothing to measure the shape of.
+    m_flatness = m_levelDb > SILENCE_DB ? computeFlatness(frame) : 1.0f;
+
+    if (!m_hasNoiseFloor) {
+        m_hasNoiseFloor = true;
+        m_noiseFloorDb = std::min(m_levelDb, INITIAL_NOISE_FLOOR_DB);
+    }
+    const float marginDb = m_levelDb - m_noiseFloorDb;
+    const bool speech = m_levelDb > SILENCE_DB
+            && (marginDb >= LOUD_MARGIN_DB
+                || (marginDb >= SPEECH_MARGIN_DB && m_flatness <= MAX_SPEECH_FLATNESS));
+
+    // Minimum tracking: down at once, up slowly so speech barely moves it.
+    if (m_levelDb < m_noiseFloorDb) {
+        m_noiseFloorDb = m_levelDb;
+    } else {
+        m_noiseFloorDb += std::min(NOISE_FLOOR_RISE_DB, marginDb);
+    }
+
+    if (speech) {
+        m_hangover = HANGOVER_FRAMES;
+    } else if (m_hangover > 0) {
+        --m_hangover;
+    }
+    return isActive();
+}
+
+float VoiceActivityDetector::computeFlatness(const float* frame)
+{
+    for (int i = 0; i < FFT_SIZE; ++i) {
+        const int source = m_bitReverse[static_cast<size_t>(i)];
+        m_re[static_cast<size_t>(i)] = source < FRAME_SAMPLES
+                ? frame[source] * m_window[static_cast<size_t>(source)]
+                : 0.0f;
+        m_im[static_cast<size_t>(i)] = 0.0f;
+    }
+
+    // Iterative radix-2 decimation in time.
+    for (int half = 1; half < FFT_SIZE; half *= 2) {
+        const int step = FFT_SIZE / (2 * half);
+        for (int start = 0; start < FFT_SIZE; start += 2 * half) {
+            for (int k = 0; k < half; ++k) {
+                const size_t a = static_cast<size_t>(start + k);
+                const size_t b = a + static_cast<size_t>(half);
+                const float wr = m_cos[static_cast<size_t>(k * step)];
+                const float wi = m_sin[static_cast<size_t>(k * step)];
+                const float tr = m_re[b] * wr - m_im[b] * wi;
+                const float ti = m_re[b] * wi + m_im[b] * wr;
+                m_re[b] = m_re[a] - tr;
+                m_im[b] = m_im[a] - ti;
+                m_re[a] += tr;
+                m_im[a] += ti;
+            }
+        }
+    }
+
+    double logSum = 0.0;
+    double sum = 0.0;
+    for (int bin = kLowBin; bin <= kHighBin; ++bin) {
+        const size_t i = static_cast<size_t>(bin);
+        const float power = m_re[i] * m_re[i] + m_im[i] * m_im[i] + kPowerFloor;
+        logSum += std::log(power);
+        sum += power;
+    }
+    const int bins = kHighBin - kLowBin + 1;
+    const double arithmeticMean = sum / bins;
+    return static_cast<float>(std::exp(logSum / bins) / arithmeticMean);
+}
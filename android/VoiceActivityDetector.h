@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2025 Silviu YO6SAY
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VOICEACTIVITYDETECTOR_H
+#define VOICEACTIVITYDETECTOR_H
+
+#include <array>
+
+// Per-frame speech / pause decision for TX DTX.
+//
+// Each 20 ms frame at 16 kHz is scored on two features:
+//  - level against a tracked noise floor that follows quiet frames down at
+//    once and creeps up at NOISE_FLOOR_RISE_DB per frame, so steady
+//    background of any loudness settles to "pause";
+//  - spectral flatness (geometric over arithmetic mean power, 300 Hz to
+//    4 kHz) of a Hann-windowed 512-point FFT: about 0.5 for broadband noise,
+//    under 0.2 for clean voiced speech.  MAX_SPEECH_FLATNESS (0.35) sits
+//    between the two, so voiced speech with some noise under it still
+//    counts.
+// A frame is speech when it stands SPEECH_MARGIN_DB above the floor and is
+// no flatter than MAX_SPEECH_FLATNESS, or LOUD_MARGIN_DB above it whatever
+// its shape (plosives, fricatives).  Speech holds the detector active for
+// HANGOVER_FRAMES so word endings and short gaps are not cut.  Starts
+// active.
+class VoiceActivityDetector
+{
+public:
+    static constexpr int FRAME_SAMPLES = 320;
+    static constexpr int HANGOVER_FRAMES = 15;         // 300 ms
+    static constexpr float SPEECH_MARGIN_DB = 9.0f;
+    static constexpr float LOUD_MARGIN_DB = 20.0f;
+    static constexpr float MAX_SPEECH_FLATNESS = 0.35f;
+    static constexpr float NOISE_FLOOR_RISE_DB = 0.05f; // 2.5 dB/s
+    static constexpr float SILENCE_DB = -70.0f;
+    // Where the floor starts unless the first frame is quieter, so an over
+    // that opens with speech does not take the speech for the floor.
+    static constexpr float INITIAL_NOISE_FLOOR_DB = -50.0f;
+
+    VoiceActivityDetector();
+
+    // Forgets the noise floor and goes back to active.
+    void reset();
+
+    // One FRAME_SAMPLES frame; true while speech or its hangover lasts.
+    bool process(const float* frame);
+    bool isActive() const { return m_hangover > 0; }
+
+    float levelDb() const { return m_levelDb; }
+    float noiseFloorDb() const { return m_noiseFloorDb; }
+    float spectralFlatness() const { return m_flatness; }
+
+private:
+    static constexpr int FFT_SIZE = 512;
+
+    float computeFlatness(const float* frame);
+
+    std::array<float, FRAME_SAMPLES> m_window{};
+    std::array<float, FFT_SIZE / 2> m_cos{};
+    std::array<float, FFT_SIZE / 2> m_sin{};
+    std::array<int, FFT_SIZE> m_bitReverse{};
+    std::array<float, FFT_SIZE> m_re{};
+    std::array<float, FFT_SIZE> m_im{};
+
+    bool m_hasNoiseFloor = false;
+    float m_noiseFloorDb = SILENCE_DB;
+    float m_levelDb = SILENCE_DB;
+    float m_flatness = 1.0f;
+    int m_hangover = HANGOVER_FRAMES;
+};
+
+#endif // VOICEACTIVITYDETECTOR_H
@@ -4,13 +4,16 @@ import android.content.Context;
 import android.media.AudioAttributes;
 import android.media.AudioDeviceInfo;
 import android.media.AudioFormat;
+import android.media.AudioManager;
 import android.media.AudioTrack;
 import android.os.Build;
 import android.util.Log;
 
 public final class LatryAudioTrackPlayer {
     private static final String TAG = "LatryAudioTrack";
-    private static final int SAMPLE_RATE = 16000;
+    // The decoder follows the track, so only rates Opus decodes at directly.
+    private static final int FALLBACK_SAMPLE_RATE = 16000;
+    private static final int[] OPUS_SAMPLE_RATES = {48000, 24000, 16000, 12000, 8000};
     private static final int CHANNEL_MASK = AudioFormat.CHANNEL_OUT_MONO;
     private static final int BUFFER_MULTIPLIER = 4;
 
@@ -20,6 +23,7 @@ public final class LatryAudioTrackPlayer {
     private static String currentRouteId = LatryAudioRoutePolicy.ROUTE_SPEAKER;
     private static int currentContentType = AudioAttributes.CONTENT_TYPE_UNKNOWN;
     private static int currentEncoding = AudioFormat.ENCODING_PCM_16BIT;
+    private static int currentSampleRate = FALLBACK_SAMPLE_RATE;
 
     private LatryAudioTrackPlayer() {
     }
@@ -36,8 +40,10 @@ public final class LatryAudioTrackPlayer {
                 encodings = new int[] {AudioFormat.ENCODING_PCM_16BIT};
             }
 
+            int sampleRate = playbackSampleRate();
             for (int encoding : encodings) {
-                if (tryBuildTrack(encoding)) {
+                if (tryBuildTrack(encoding, sampleRate)
+                        || (sampleRate != FALLBACK_SAMPLE_RATE && tryBuildTrack(encoding, FALLBACK_SAMPLE_RATE))) {
                     currentRouteId = normalizeRouteId(routeId);
                     applyPreferredDeviceLocked(currentRouteId);
 
@@ -49,7 +55,7 @@ public final class LatryAudioTrackPlayer {
                         return false;
                     }
 
-                    Log.i(TAG, "AudioTrack started @ " + SAMPLE_RATE + " Hz format="
+                    Log.i(TAG, "AudioTrack started @ " + currentSampleRate + " Hz format="
                             + encodingName(currentEncoding) + " on route " + currentRouteId);
                     return true;
                 }
@@ -60,8 +66,19 @@ public final class LatryAudioTrackPlayer {
         }
     }
 
-    private static boolean tryBuildTrack(int encoding) {
-        int minBufferSize = AudioTrack.getMinBufferSize(SAMPLE_RATE, CHANNEL_MASK, encoding);
+    // The mixer's own rate, so the track plays without a resampling stage.
+    private static int playbackSampleRate() {
+        int nativeRate = AudioTrack.getNativeOutputSampleRate(AudioManager.STREAM_MUSIC);
+        for (int rate : OPUS_SAMPLE_RATES) {
+            if (rate == nativeRate) {
+                return rate;
+            }
+        }
+        return FALLBACK_SAMPLE_RATE;
+    }
+
+    private static boolean tryBuildTrack(int encoding, int sampleRate) {
+        int minBufferSize = AudioTrack.getMinBufferSize(sampleRate, CHANNEL_MASK, encoding);
         if (minBufferSize <= 0) {
             return false;
         }
@@ -72,7 +89,7 @@ public final class LatryAudioTrackPlayer {
                 .setContentType(AudioAttributes.CONTENT_TYPE_SPEECH)
                 .build();
         AudioFormat audioFormat = new AudioFormat.Builder()
-                .setSampleRate(SAMPLE_RATE)
+                .setSampleRate(sampleRate)
                 .setEncoding(encoding)
                 .setChannelMask(CHANNEL_MASK)
                 .build();
@@ -90,7 +107,8 @@ public final class LatryAudioTrackPlayer {
         try {
             audioTrack = builder.build();
         } catch (Exception e) {
-            Log.w(TAG, "Failed to build AudioTrack encoding=" + encodingName(encoding), e);
+            Log.w(TAG, "Failed to build AudioTrack encoding=" + encodingName(encoding)
+                    + " rate=" + sampleRate, e);
             audioTrack = null;
             return false;
         }
@@ -101,6 +119,7 @@ public final class LatryAudioTrackPlayer {
         }
 
         currentEncoding = encoding;
+        currentSampleRate = sampleRate;
         currentContentType = AudioAttributes.CONTENT_TYPE_SPEECH;
         return true;
     }
@@ -190,6 +209,12 @@ public final class LatryAudioTrackPlayer {
         }
     }
 
+    public static int getSampleRate() {
+        synchronized (lock) {
+            return currentSampleRate;
+        }
+    }
+
     public static boolean setPlaybackRoute(Context context, String routeId) {
         synchronized (lock) {
             ensureInitialized(context);
@@ -0,0 +1,107 @@
+// Throughput of AudioLimiter against the original double-precision
+// log()/exp() limiter, on 20 ms TX frames at 16 kHz.
+//
+// The signal sits above the -6 dBFS threshold half of the time so both the
+// attack and the release branch run.  Also reports the largest gain
+// difference from the reference, in dB, and the cost of the 5 ms look-ahead
+// and AGC stages on top.
+//
+//   bench_audio_limiter [seconds]
+
+#include "AudioLimiter.h"
+#include "tests/ReferenceAudioLimiter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+constexpr int kSampleRate = 16000;
+constexpr int kFrameSamples = 320;
+constexpr int kSignalSeconds = 4;
+
+std::vector<float> testSignal()
+{
+    std::vector<float> samples(kSampleRate * kSignalSeconds);
+    for (size_t i = 0; i < samples.size(); ++i) {
+        const float amplitude = (i / (kSampleRate / 4)) % 2 ? 0.9f : 0.1f;
+        samples[i] = amplitude * std::sin(0.37f * static_cast<float>(i));
+    }
+    return samples;
+}
+
+template <typename Limiter>
+double throughputMsps(Limiter& limiter, const std::vector<float>& signal, double seconds)
+{
+    std::vector<float> frame(kFrameSamples);
+    long processed = 0;
+    size_t offset = 0;
+    const auto start = std::chrono::steady_clock::now();
+    const auto deadline = start + std::chrono::duration<double>(seconds);
+    while (std::chrono::steady_clock::now() < deadline) {
+        for (int i = 0; i < 50; ++i) {
+            std::copy_n(signal.begin() + offset, kFrameSamples, frame.begin());
+            limiter.processAudio(frame.data(), kFrameSamples);
+            offset = (offset + kFrameSamples) % signal.size();
+            processed += kFrameSamples;
+        }
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return processed / elapsed / 1.0e6;
+}
+
+double maxGainDifferenceDb(int gainBlockSize, const std::vector<float>& signal)
+{
+    std::vector<float> expected = signal;
+    std::vector<float> actual = signal;
+    ReferenceAudioLimiter reference;
+    AudioLimiter limiter;
+    limiter.setGainBlockSize(gainBlockSize);
+    for (size_t offset = 0; offset < signal.size(); offset += kFrameSamples) {
+        reference.processAudio(expected.data() + offset, kFrameSamples);
+        limiter.processAudio(actual.data() + offset, kFrameSamples);
+    }
+    double worst = 0.0;
+    for (size_t i = 0; i < signal.size(); ++i) {
+        if (std::fabs(signal[i]) > 1.0e-4f) {
+            worst = std::max(worst, std::fabs(20.0 * std::log10(static_cast<double>(actual[i]) / expected[i])));
+        }
+    }
+    return worst;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    const double seconds = argc > 1 ? std::max(0.05, std::atof(argv[1])) : 0.5;
+    const std::vector<float> signal = testSignal();
+
+    ReferenceAudioLimiter reference;
+    const double referenceMsps = throughputMsps(reference, signal, seconds);
+    std::printf("%-22s %12s %10s %14s\n", "limiter", "Msamples/s", "speedup", "max diff (dB)");
+    std::printf("%-22s %12.1f %10s %14s\n", "double log/exp", referenceMsps, "1.0x", "-");
+
+    for (int gainBlockSize : {1, 8, 16}) {
+        AudioLimiter limiter;
+        limiter.setGainBlockSize(gainBlockSize);
+        const double msps = throughputMsps(limiter, signal, seconds);
+        char label[32];
+        std::snprintf(label, sizeof(label), "float, gain block %d", gainBlockSize);
+        char speedup[16];
+        std::snprintf(speedup, sizeof(speedup), "%.1fx", msps / referenceMsps);
+        std::printf("%-22s %12.1f %10s %14.4f\n", label, msps, speedup,
+                    maxGainDifferenceDb(gainBlockSize, signal));
+    }
+
+    AudioLimiter lookAhead;
+    lookAhead.setLookAheadSamples(kSampleRate * 5 / 1000);
+    lookAhead.setAgcEnabled(true);
+    const double msps = throughputMsps(lookAhead, signal, seconds);
+    char speedup[16];
+    std::snprintf(speedup, sizeof(speedup), "%.1fx", msps / referenceMsps);
+    std::printf("%-22s %12.1f %10s %14s\n", "5 ms look-ahead + AGC", msps, speedup, "-");
+    return 0;
+}
@@ -0,0 +1,291 @@
+// Jitter buffer and packet loss concealment over a seeded bad link:
+// underruns, concealed frames and buffering delay for each link profile.
+//
+// A talker encodes 20 ms Opus frames of a voiced test signal as they come
+// due, with in-band FEC sized for the link's loss as the client would.
+// Each packet goes through NetworkImpairment, the model ImpairmentProxy
+// applies, and is handed to a real AudioEngine at its delivery time
+// through enqueueReceivedAudio(), as the UDP receive thread does.  The
+// engine's own queued drain, reordering, FEC and PLC policy and playout
+// timer run in the event loop, and an AudioStreamDevice on its jitter
+// buffer is pulled in 10 ms sink periods, as the audio sink would.
+//
+// It runs in real time, because the jitter buffer's rebuffering follows
+// the steady clock.  A link spec and seed replay the same network.
+//
+//   bench_jitter_impairment [seconds] [seed] [link spec ...]
+
+#include "AudioEngine.h"
+#include "tests/NetworkImpairment.h"
+
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QTimer>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <queue>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr int kSampleRate = AudioEngine::SAMPLE_RATE;
+constexpr int kFrameMs = AudioEngine::FRAME_SIZE_MS;
+constexpr int kFrameSamples = AudioEngine::FRAME_SIZE_SAMPLES;
+constexpr int kSinkPeriodMs = 10;
+constexpr int kSinkPeriodSamples = kSampleRate * kSinkPeriodMs / 1000;
+constexpr int kTickMs = 1;
+constexpr int kMaxPacketBytes = 1275;
+constexpr double kPi = 3.14159265358979323846;
+
+int64_t steadyNowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// The engine logs every concealment gap; stdout is kept for the table.
+void keepWarnings(QtMsgType type, const QMessageLogContext &, const QString &message)
+{
+    if (type != QtDebugMsg && type != QtInfoMsg) {
+        std::fprintf(stderr, "%s\n", qPrintable(message));
+    }
+}
+
+struct Report {
+    int64_t sent = 0;
+    int64_t late = 0;
+    int64_t fecRecovered = 0;
+    int64_t concealed = 0;
+    int64_t skipped = 0;
+    int64_t underruns = 0;
+    int64_t underrunSamples = 0;
+    std::vector<int> targetMs;
+};
+
+struct InFlight {
+    int64_t atUs = 0;
+    uint16_t sequence = 0;
+    std::vector<unsigned char> payload;
+
+    bool operator>(const InFlight &other) const { return atUs > other.atUs; }
+};
+
+// Harmonics of a 140 Hz voice under a 4 Hz syllable envelope.
+void voicedFrame(int64_t firstSample, std::vector<float> &frame)
+{
+    for (int i = 0; i < kFrameSamples; ++i) {
+        const double t = double(firstSample + i) / kSampleRate;
+        double voiced = 0.0;
+        for (int harmonic = 1; harmonic <= 8; ++harmonic) {
+            voiced += std::sin(2.0 * kPi * 140.0 * harmonic * t) / harmonic;
+        }
+        frame[static_cast<size_t>(i)] =
+            static_cast<float>(0.1 * (0.55 + 0.45 * std::sin(2.0 * kPi * 4.0 * t)) * voiced);
+    }
+}
+}
+
+class JitterImpairmentBench
+{
+public:
+    JitterImpairmentBench(const NetworkImpairment::Config &link, uint64_t seed);
+
+    Report run(int seconds);
+    NetworkImpairment::Stats linkStats() const { return m_network.stats(); }
+
+private:
+    void tick();
+    void send();
+    void deliver();
+    // One period of the audio sink pulling AudioStreamDevice.
+    void playout();
+
+    NetworkImpairment m_network;
+    OpusEncoder m_encoder;
+    AudioEngine m_engine;
+    AudioStreamDevice *m_sink = nullptr;
+    Report m_report;
+
+    std::vector<float> m_pcm;
+    std::vector<unsigned char> m_packet;
+    std::vector<float> m_sinkPeriod;
+    std::priority_queue<InFlight, std::vector<InFlight>, std::greater<InFlight>> m_inFlight;
+    uint16_t m_sequence = 0;
+    int64_t m_endUs = 0;
+    int64_t m_nextSendUs = 0;
+    int64_t m_nextSinkUs = 0;
+    bool m_playing = false;
+    bool m_wasShort = false;
+    QEventLoop *m_loop = nullptr;
+};
+
+JitterImpairmentBench::JitterImpairmentBench(const NetworkImpairment::Config &link, uint64_t seed)
+    : m_network(link, seed)
+    , m_encoder(kSampleRate, AudioEngine::CHANNELS, OPUS_APPLICATION_VOIP)
+    , m_pcm(kFrameSamples)
+    , m_packet(kMaxPacketBytes)
+    , m_sinkPeriod(kSinkPeriodSamples)
+{
+    m_encoder.applySvxlinkDefaults();
+    const int lossPercent = std::clamp(static_cast<int>(std::lround(m_network.expectedLoss() * 100.0)), 0, 25);
+    m_encoder.setInbandFec(lossPercent > 0, lossPercent);
+
+    // The receive side as setupAudio() leaves it, minus the audio device.
+    m_engine.initializeAudioComponents();
+    m_engine.m_audioReady = true;
+    m_sink = new AudioStreamDevice(&m_engine.m_jitterBuffer, nullptr, m_engine.m_rxSampleRate,
+                                   m_engine.m_rxSampleRate, QAudioFormat::Float, &m_engine);
+    m_engine.m_audioStreamDevice = m_sink;
+}
+
+Report JitterImpairmentBench::run(int seconds)
+{
+    const int64_t startUs = steadyNowUs();
+    m_endUs = startUs + int64_t(seconds) * 1000000;
+    m_nextSendUs = startUs;
+    m_nextSinkUs = startUs;
+
+    QEventLoop loop;
+    m_loop = &loop;
+    QTimer ticker;
+    ticker.setTimerType(Qt::PreciseTimer);
+    QObject::connect(&ticker, &QTimer::timeout, &loop, [this]() { tick(); });
+    ticker.start(kTickMs);
+    loop.exec();
+    m_loop = nullptr;
+
+    m_report.late = static_cast<int64_t>(m_engine.m_rxLatePackets);
+    m_report.fecRecovered = static_cast<int64_t>(m_engine.m_rxFecRecoveredFrames);
+    m_report.concealed = static_cast<int64_t>(m_engine.m_rxConcealedFrames);
+    m_report.skipped = static_cast<int64_t>(m_engine.m_rxSkippedFrames);
+    return m_report;
+}
+
+void JitterImpairmentBench::tick()
+{
+    const int64_t nowUs = steadyNowUs();
+    if (nowUs >= m_endUs) {
+        m_loop->quit();
+        return;
+    }
+    while (nowUs >= m_nextSendUs) {
+        send();
+    }
+    deliver();
+    while (nowUs >= m_nextSinkUs) {
+        playout();
+        m_nextSinkUs += kSinkPeriodMs * 1000;
+    }
+}
+
+void JitterImpairmentBench::send()
+{
+    voicedFrame(m_report.sent * kFrameSamples, m_pcm);
+    const int bytes = m_encoder.encode(m_pcm.data(), kFrameSamples, m_packet.data(), kMaxPacketBytes);
+    if (bytes > 0) {
+        const NetworkImpairment::Delivery delivery = m_network.submit(m_nextSendUs, bytes);
+        for (int copy = 0; copy < delivery.copies; ++copy) {
+            m_inFlight.push({delivery.atUs[copy], m_sequence,
+                             std::vector<unsigned char>(m_packet.begin(), m_packet.begin() + bytes)});
+        }
+    }
+    ++m_report.sent;
+    ++m_sequence;
+    m_nextSendUs += kFrameMs * 1000;
+}
+
+void JitterImpairmentBench::deliver()
+{
+    // The engine drains its queue in the event loop, after this tick.
+    const int64_t nowUs = steadyNowUs();
+    while (!m_inFlight.empty() && m_inFlight.top().atUs <= nowUs) {
+        const InFlight &packet = m_inFlight.top();
+        m_engine.enqueueReceivedAudio(packet.payload.data(), static_cast<int>(packet.payload.size()),
+                                      packet.sequence, nowUs);
+        m_inFlight.pop();
+    }
+}
+
+void JitterImpairmentBench::playout()
+{
+    const qint64 bytes = m_sink->readData(reinterpret_cast<char *>(m_sinkPeriod.data()),
+                                          kSinkPeriodSamples * static_cast<qint64>(sizeof(float)));
+    const int read = bytes > 0 ? static_cast<int>(bytes / static_cast<qint64>(sizeof(float))) : 0;
+    if (read > 0) {
+        m_playing = true;
+    }
+    if (m_playing) {
+        const bool shortPeriod = read < kSinkPeriodSamples;
+        if (shortPeriod && !m_wasShort) {
+            ++m_report.underruns;
+        }
+        if (shortPeriod) {
+            m_report.underrunSamples += kSinkPeriodSamples - read;
+        }
+        m_wasShort = shortPeriod;
+    }
+    m_report.targetMs.push_back(m_engine.m_jitterEstimator.targetDelayMs());
+}
+
+namespace {
+int percentile(std::vector<int> values, double fraction)
+{
+    if (values.empty()) {
+        return 0;
+    }
+    const size_t index = std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()));
+    std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(index), values.end());
+    return values[index];
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    qInstallMessageHandler(keepWarnings);
+
+    const int seconds = argc > 1 ? std::max(1, std::atoi(argv[1])) : 20;
+    const uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1;
+    std::vector<std::string> specs;
+    for (int i = 3; i < argc; ++i) {
+        specs.emplace_back(argv[i]);
+    }
+    if (specs.empty()) {
+        specs = {"clean", "wifi", "lte", "lte-congested"};
+    }
+
+    std::printf("%d s of 20 ms frames per link, seed %llu, %d ms sink periods\n", seconds,
+                static_cast<unsigned long long>(seed), kSinkPeriodMs);
+    std::printf("%-16s %7s %6s %6s %9s %7s %9s %14s  %s\n", "link", "loss", "late", "fec",
+                "concealed", "skipped", "underruns", "underrun time", "target p50/p95");
+
+    for (const std::string &spec : specs) {
+        NetworkImpairment::Config link;
+        std::string error;
+        if (!NetworkImpairment::parse(spec, link, &error)) {
+            std::fprintf(stderr, "%s: %s\n", spec.c_str(), error.c_str());
+            return 2;
+        }
+
+        JitterImpairmentBench bench(link, seed);
+        const Report report = bench.run(seconds);
+        const NetworkImpairment::Stats linkStats = bench.linkStats();
+        const double lossPercent = report.sent > 0
+            ? 100.0 * double(linkStats.lost + linkStats.overflowed) / double(report.sent) : 0.0;
+        std::printf("%-16s %6.2f%% %6lld %6lld %9lld %7lld %9lld %11.0f ms  %d/%d ms\n",
+                    spec.c_str(), lossPercent,
+                    static_cast<long long>(report.late),
+                    static_cast<long long>(report.fecRecovered),
+                    static_cast<long long>(report.concealed),
+                    static_cast<long long>(report.skipped),
+                    static_cast<long long>(report.underruns),
+                    1000.0 * double(report.underrunSamples) / kSampleRate,
+                    percentile(report.targetMs, 0.5), percentile(report.targetMs, 0.95));
+        std::fflush(stdout);
+    }
+    return 0;
+}
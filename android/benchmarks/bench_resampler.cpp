@@ -0,0 +1,161 @@
+// Throughput and alias rejection of every Resampler quality tier for the
+// capture and playback rates Android devices report.
+//
+// Throughput is input samples per second through the non-allocating
+// process() on the best SIMD kernel.  Stopband attenuation is the worst
+// level, relative to a 1 kHz passband tone, of any input tone that folds
+// (or images) into the lower 45% of the output band.
+//
+//   bench_resampler [seconds]
+
+#include "Resampler.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+constexpr int kChunkMs = 10;
+
+struct RatePair {
+    int inRate;
+    int outRate;
+};
+
+std::vector<float> tone(int sampleRate, double frequency, int count)
+{
+    std::vector<float> samples(static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        samples[static_cast<size_t>(i)] = static_cast<float>(0.5 * std::sin(2.0 * kPi * frequency * i / sampleRate));
+    }
+    return samples;
+}
+
+std::vector<float> resampleAll(const RatePair &rates, Resampler::Quality quality, const std::vector<float> &input)
+{
+    Resampler resampler(rates.inRate, rates.outRate, 1, quality);
+    const int chunk = rates.inRate * kChunkMs / 1000;
+    std::vector<float> output;
+    std::vector<float> scratch(static_cast<size_t>(resampler.maxOutputSamples(chunk)));
+    for (size_t offset = 0; offset + static_cast<size_t>(chunk) <= input.size(); offset += static_cast<size_t>(chunk)) {
+        const int written = resampler.process(input.data() + offset, chunk, scratch.data(), static_cast<int>(scratch.size()));
+        output.insert(output.end(), scratch.begin(), scratch.begin() + written);
+    }
+    return output;
+}
+
+// RMS after the filter has settled.
+double settledRms(const std::vector<float> &samples)
+{
+    const size_t start = samples.size() / 5;
+    double energy = 0.0;
+    for (size_t i = start; i < samples.size(); ++i) {
+        energy += static_cast<double>(samples[i]) * samples[i];
+    }
+    return std::sqrt(energy / std::max<size_t>(1, samples.size() - start));
+}
+
+double stopbandAttenuationDb(const RatePair &rates, Resampler::Quality quality)
+{
+    const int count = rates.inRate / 2;
+    const double reference = settledRms(resampleAll(rates, quality, tone(rates.inRate, 1000.0, count)));
+
+    // Input tones that land in [0, 0.45 * outRate) after folding or imaging.
+    const double lowNyquist = std::min(rates.inRate, rates.outRate) / 2.0;
+    const double highNyquist = std::max(rates.inRate, rates.outRate) / 2.0;
+    double worst = -1.0;
+    if (rates.inRate > rates.outRate) {
+        for (double frequency = rates.outRate - 0.45 * rates.outRate; frequency < highNyquist * 0.98; frequency += 250.0) {
+            worst = std::max(worst, settledRms(resampleAll(rates, quality, tone(rates.inRate, frequency, count))));
+        }
+    } else {
+        // Upsampling: a passband tone f also appears at inRate - f.
+        for (double frequency = 250.0; frequency < lowNyquist * 0.9; frequency += 250.0) {
+            std::vector<float> output = resampleAll(rates, quality, tone(rates.inRate, frequency, count));
+            // Remove the wanted tone with a matched sine fit; what remains is imaging.
+            const size_t start = output.size() / 5;
+            double sinSum = 0.0;
+            double cosSum = 0.0;
+            double norm = 0.0;
+            for (size_t i = start; i < output.size(); ++i) {
+                const double phase = 2.0 * kPi * frequency * static_cast<double>(i) / rates.outRate;
+                sinSum += output[i] * std::sin(phase);
+                cosSum += output[i] * std::cos(phase);
+                norm += std::sin(phase) * std::sin(phase);
+            }
+            const double a = sinSum / norm;
+            const double b = cosSum / norm;
+            double residual = 0.0;
+            for (size_t i = start; i < output.size(); ++i) {
+                const double phase = 2.0 * kPi * frequency * static_cast<double>(i) / rates.outRate;
+                const double error = output[i] - a * std::sin(phase) - b * std::cos(phase);
+                residual += error * error;
+            }
+            worst = std::max(worst, std::sqrt(residual / static_cast<double>(output.size() - start)));
+        }
+    }
+    if (worst < 0.0) {
+        return NAN;  // No input tone can fold that far down.
+    }
+    return 20.0 * std::log10(std::max(worst, 1.0e-12) / reference);
+}
+
+double throughputMsps(const RatePair &rates, Resampler::Quality quality, double seconds)
+{
+    Resampler resampler(rates.inRate, rates.outRate, 1, quality);
+    const int chunk = rates.inRate * kChunkMs / 1000;
+    const std::vector<float> input = tone(rates.inRate, 1000.0, chunk);
+    std::vector<float> output(static_cast<size_t>(resampler.maxOutputSamples(chunk)));
+
+    long long samples = 0;
+    const auto start = std::chrono::steady_clock::now();
+    const auto deadline = start + std::chrono::duration<double>(seconds);
+    float sink = 0.0f;
+    while (std::chrono::steady_clock::now() < deadline) {
+        for (int i = 0; i < 100; ++i) {
+            resampler.process(input.data(), chunk, output.data(), static_cast<int>(output.size()));
+            sink += output[0];
+        }
+        samples += 100LL * chunk;
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (sink == 12345.0f) {
+        std::printf(" ");
+    }
+    return samples / elapsed / 1.0e6;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    const double seconds = argc > 1 ? std::max(0.05, std::atof(argv[1])) : 0.5;
+    const std::array<RatePair, 5> ratePairs{{{44100, 16000}, {16000, 44100}, {8000, 16000}, {48000, 44100}, {48000, 16000}}};
+    const std::array<Resampler::Quality, 4> tiers{
+        Resampler::Quality::Linear, Resampler::Quality::Fast, Resampler::Quality::Balanced, Resampler::Quality::High};
+
+    std::printf("kernel: %s\n", Resampler::kernelName(Resampler::bestKernel()));
+    std::printf("%-14s %-9s %5s %14s %18s\n", "rates", "tier", "taps", "Msamples/s", "stopband (dB)");
+    for (const RatePair &rates : ratePairs) {
+        // 48 kHz <-> 16 kHz always uses the SvxLink filters, whatever the tier.
+        const bool svxlinkFilter = (rates.inRate == 48000 && rates.outRate == 16000)
+                || (rates.inRate == 16000 && rates.outRate == 48000);
+        for (Resampler::Quality quality : tiers) {
+            Resampler probe(rates.inRate, rates.outRate, 1, quality);
+            char label[32];
+            std::snprintf(label, sizeof(label), "%d->%d", rates.inRate, rates.outRate);
+            std::printf("%-14s %-9s %5d %14.1f %18.1f\n", label,
+                        svxlinkFilter ? "svxlink" : Resampler::qualityName(probe.quality()),
+                        probe.filterTaps(), throughputMsps(rates, quality, seconds),
+                        stopbandAttenuationDb(rates, quality));
+            if (svxlinkFilter) {
+                break;
+            }
+        }
+    }
+    return 0;
+}
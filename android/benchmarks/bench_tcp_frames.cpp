@@ -0,0 +1,179 @@
+// Throughput of splitting a reconnect burst of reflector TCP frames the way
+// onTcpReadyRead used to (append to a QByteArray, remove() the length
+// prefix and payload from the front, copy the payload into a QDataStream)
+// versus TcpFrameReader handing out PayloadReader views into one reusable
+// buffer.
+//
+// The burst alternates NODE_JOINED frames with NODE_LIST frames of eight
+// callsigns, as a large reflector sends them right after SERVER_INFO.  It
+// arrives in reads of readBytes bytes; 0 delivers it in a single read, as
+// after the event loop stalled.  Both parsers decode every callsign into a
+// QString so the comparison includes the handlers' own work.
+//
+//   bench_tcp_frames [frames] [readBytes] [runs]
+
+#include "ReflectorProtocol.h"
+#include "TcpFrameReader.h"
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QString>
+#include <QtEndian>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+namespace {
+constexpr int kNodeListCallsigns = 8;
+
+int64_t steadyNowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void appendCallsign(QDataStream &stream, int index)
+{
+    const QByteArray callsign = "YO" + QByteArray::number(index % 10) + "N" + QByteArray::number(index);
+    stream << quint16(callsign.size());
+    stream.writeRawData(callsign.constData(), callsign.size());
+}
+
+QByteArray buildBurst(int frames, int &callsigns)
+{
+    QByteArray burst;
+    callsigns = 0;
+    for (int i = 0; i < frames; ++i) {
+        QByteArray payload;
+        QDataStream stream(&payload, QIODevice::WriteOnly);
+        stream.setByteOrder(QDataStream::BigEndian);
+        if (i % 2 == 0) {
+            stream << quint16(Svxlink::MsgType::NODE_JOINED);
+            appendCallsign(stream, callsigns++);
+        } else {
+            stream << quint16(Svxlink::MsgType::NODE_LIST) << quint16(kNodeListCallsigns);
+            for (int n = 0; n < kNodeListCallsigns; ++n) {
+                appendCallsign(stream, callsigns++);
+            }
+        }
+
+        QByteArray prefix;
+        QDataStream prefixStream(&prefix, QIODevice::WriteOnly);
+        prefixStream.setByteOrder(QDataStream::BigEndian);
+        prefixStream << quint32(payload.size());
+        burst.append(prefix);
+        burst.append(payload);
+    }
+    return burst;
+}
+
+int parseWithByteArray(const QByteArray &burst, int readBytes)
+{
+    QByteArray buffer;
+    int callsigns = 0;
+    for (int offset = 0; offset < burst.size(); offset += readBytes) {
+        buffer.append(burst.constData() + offset, std::min(readBytes, int(burst.size()) - offset));
+
+        while (buffer.size() >= qsizetype(sizeof(quint32))) {
+            const quint32 payloadSize = qFromBigEndian<quint32>(buffer.constData());
+            if (buffer.size() < qsizetype(sizeof(quint32) + payloadSize)) {
+                break;
+            }
+            buffer.remove(0, sizeof(quint32));
+            QByteArray payloadData = buffer.left(payloadSize);
+            buffer.remove(0, payloadSize);
+
+            QDataStream stream(payloadData);
+            stream.setByteOrder(QDataStream::BigEndian);
+            quint16 type = 0;
+            quint16 count = 1;
+            stream >> type;
+            if (type == Svxlink::MsgType::NODE_LIST) {
+                stream >> count;
+            }
+            for (int i = 0; i < count; ++i) {
+                quint16 len = 0;
+                stream >> len;
+                QByteArray data(len, Qt::Uninitialized);
+                if (stream.status() != QDataStream::Ok || stream.readRawData(data.data(), len) != len) {
+                    break;
+                }
+                callsigns += QString::fromUtf8(data).isEmpty() ? 0 : 1;
+            }
+        }
+    }
+    return callsigns;
+}
+
+int parseWithFrameReader(const QByteArray &burst, int readBytes)
+{
+    TcpFrameReader reader;
+    PayloadReader payload;
+    int callsigns = 0;
+    for (int offset = 0; offset < burst.size(); offset += readBytes) {
+        const int count = std::min(readBytes, int(burst.size()) - offset);
+        std::copy_n(burst.constData() + offset, count, reader.prepareWrite(count));
+        reader.commitWrite(count);
+
+        while (reader.next(payload) == TcpFrameReader::Result::Frame) {
+            const quint16 type = payload.readU16();
+            const int names = type == Svxlink::MsgType::NODE_LIST ? payload.readU16() : 1;
+            for (int i = 0; i < names; ++i) {
+                const PayloadReader callsign = payload.readLengthPrefixed();
+                if (!payload.ok()) {
+                    break;
+                }
+                callsigns += QString::fromUtf8(callsign.data(), callsign.size()).isEmpty() ? 0 : 1;
+            }
+        }
+    }
+    return callsigns;
+}
+
+// Median and worst run time in ms.
+void report(const char *name, std::vector<int64_t> runUs, int frames, qsizetype bytes,
+            int decoded, int expected)
+{
+    std::sort(runUs.begin(), runUs.end());
+    const double medianMs = runUs[runUs.size() / 2] / 1000.0;
+    std::printf("%-16s p50 %8.2f ms  max %8.2f ms  %8.2f Mframes/s  %8.1f MB/s%s\n",
+                name, medianMs, runUs.back() / 1000.0,
+                frames / medianMs / 1000.0, bytes / medianMs / 1000.0,
+                decoded == expected ? "" : "  (callsign count mismatch)");
+}
+
+template <typename Parser>
+void run(const char *name, Parser parse, const QByteArray &burst, int readBytes, int runs,
+         int frames, int expected)
+{
+    std::vector<int64_t> runUs;
+    int decoded = 0;
+    for (int i = 0; i < runs; ++i) {
+        const int64_t startUs = steadyNowUs();
+        decoded = parse(burst, readBytes);
+        runUs.push_back(steadyNowUs() - startUs);
+    }
+    report(name, std::move(runUs), frames, burst.size(), decoded, expected);
+}
+}
+
+int main(int argc, char *argv[])
+{
+    const int frames = argc > 1 ? std::max(1, std::atoi(argv[1])) : 10000;
+    const int requestedReadBytes = argc > 2 ? std::max(0, std::atoi(argv[2])) : 0;
+    const int runs = argc > 3 ? std::max(1, std::atoi(argv[3])) : 21;
+
+    int callsigns = 0;
+    const QByteArray burst = buildBurst(frames, callsigns);
+    const int readBytes = requestedReadBytes > 0 ? requestedReadBytes : int(burst.size());
+
+    std::printf("%d frames, %d callsigns, %lld bytes in reads of %d bytes, %d runs\n",
+                frames, callsigns, static_cast<long long>(burst.size()), readBytes, runs);
+    run("QByteArray", parseWithByteArray, burst, readBytes, runs, frames, callsigns);
+    run("TcpFrameReader", parseWithFrameReader, burst, readBytes, runs, frames, callsigns);
+    return 0;
+}
@@ -0,0 +1,258 @@
+// Capture-to-datagram latency of TX audio with every capture block posted
+// to the encoding thread as its own event versus handed over through
+// AudioCaptureQueue with one wake-up per batch, while the same thread is
+// decoding RX audio.
+//
+// A capture thread produces one 20 ms block of 16 kHz PCM every 20 ms, as
+// AndroidAudioRecordInput does.  The encode stage Opus-encodes each block
+// and sends it to a loopback socket with its capture time, and a receiver
+// thread records how long after capture each datagram arrived.  Another
+// thread hands the same stage one RX packet every 20 ms, which it decodes
+// and then stays busy for rxBusyMs, standing in for playout and the rest
+// of the engine thread's RX work.
+//
+//   bench_tx_capture [blocks] [rxBusyMs]
+
+#include "AudioCaptureQueue.h"
+#include "OpusWrapper.h"
+
+#include <QCoreApplication>
+#include <QMetaObject>
+#include <QThread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr int kSampleRate = 16000;
+constexpr int kBlockMs = 20;
+constexpr int kBlockSamples = kSampleRate * kBlockMs / 1000;
+constexpr int kMaxPacketBytes = 1275;
+
+int64_t steadyNowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void spinFor(int64_t us)
+{
+    const int64_t until = steadyNowUs() + us;
+    while (steadyNowUs() < until) {
+    }
+}
+
+// Stands in for AudioEngine: encodes TX and decodes RX on one thread.
+class EncodeStage : public QObject
+{
+public:
+    EncodeStage(bool useCaptureQueue, quint16 port, int rxBusyMs)
+        : m_useCaptureQueue(useCaptureQueue)
+        , m_rxBusyMs(rxBusyMs)
+        , m_encoder(kSampleRate, 1, OPUS_APPLICATION_VOIP)
+        , m_decoder(kSampleRate, 1)
+        , m_socket(::socket(AF_INET, SOCK_DGRAM, 0))
+        , m_datagram(sizeof(int64_t) + kMaxPacketBytes)
+        , m_floatBlock(kBlockSamples)
+        , m_rxPcm(kBlockSamples)
+    {
+        m_encoder.applySvxlinkDefaults();
+        m_address.sin_family = AF_INET;
+        m_address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        m_address.sin_port = htons(port);
+
+        std::vector<float> tone(kBlockSamples);
+        for (int i = 0; i < kBlockSamples; ++i) {
+            tone[static_cast<size_t>(i)] = 0.3f * std::sin(2.0f * 3.14159265f * 440.0f * i / kSampleRate);
+        }
+        m_rxPacket.resize(kMaxPacketBytes);
+        m_rxPacket.resize(static_cast<size_t>(std::max(0, m_encoder.encode(
+            tone.data(), kBlockSamples, m_rxPacket.data(), kMaxPacketBytes))));
+    }
+
+    ~EncodeStage() override { ::close(m_socket); }
+
+    // Capture thread.
+    void captured(const short* samples, int count, int64_t captureUs)
+    {
+        if (!m_useCaptureQueue) {
+            std::vector<short> sampleCopy(samples, samples + count);
+            QMetaObject::invokeMethod(
+                this,
+                [this, sampleCopy = std::move(sampleCopy), captureUs]() {
+                    constexpr float kInt16Scale = 1.0f / 32768.0f;
+                    for (size_t i = 0; i < sampleCopy.size(); ++i) {
+                        m_floatBlock[i] = sampleCopy[i] * kInt16Scale;
+                    }
+                    encodeAndSend(m_floatBlock.data(), static_cast<int>(sampleCopy.size()), captureUs);
+                },
+                Qt::QueuedConnection);
+            return;
+        }
+
+        m_queue.push(samples, count, kSampleRate, captureUs);
+        if (!m_drainScheduled.exchange(true)) {
+            QMetaObject::invokeMethod(this, [this]() { drain(); }, Qt::QueuedConnection);
+        }
+    }
+
+    // RX feeder thread.
+    void received()
+    {
+        QMetaObject::invokeMethod(this, [this]() {
+            m_decoder.decode(m_rxPacket.data(), static_cast<int>(m_rxPacket.size()),
+                             m_rxPcm.data(), kBlockSamples);
+            spinFor(static_cast<int64_t>(m_rxBusyMs) * 1000);
+        }, Qt::QueuedConnection);
+    }
+
+    uint64_t droppedBlocks() const { return m_queue.droppedBlocks(); }
+
+private:
+    void drain()
+    {
+        m_drainScheduled.store(false);
+        while (const AudioCaptureQueue::Block* block = m_queue.front()) {
+            encodeAndSend(block->samples.data(), block->count, block->captureUs);
+            m_queue.pop();
+        }
+    }
+
+    void encodeAndSend(const float* samples, int count, int64_t captureUs)
+    {
+        std::memcpy(m_datagram.data(), &captureUs, sizeof(captureUs));
+        const int encodedBytes = m_encoder.encode(samples, count, m_datagram.data() + sizeof(captureUs),
+                                                  kMaxPacketBytes);
+        if (encodedBytes > 0) {
+            ::sendto(m_socket, m_datagram.data(), sizeof(captureUs) + static_cast<size_t>(encodedBytes), 0,
+                     reinterpret_cast<const sockaddr*>(&m_address), sizeof(m_address));
+        }
+    }
+
+    const bool m_useCaptureQueue;
+    const int m_rxBusyMs;
+    OpusEncoder m_encoder;
+    OpusDecoder m_decoder;
+    int m_socket;
+    sockaddr_in m_address{};
+    std::vector<unsigned char> m_datagram;
+    std::vector<float> m_floatBlock;
+    std::vector<unsigned char> m_rxPacket;
+    std::vector<float> m_rxPcm;
+    AudioCaptureQueue m_queue;
+    std::atomic<bool> m_drainScheduled{false};
+};
+
+std::vector<int64_t> runScenario(bool useCaptureQueue, int blocks, int rxBusyMs)
+{
+    const int receiver = ::socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ::bind(receiver, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    socklen_t addressLength = sizeof(address);
+    ::getsockname(receiver, reinterpret_cast<sockaddr*>(&address), &addressLength);
+    timeval timeout{0, 100000};
+    ::setsockopt(receiver, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    std::vector<int64_t> latencies;
+    latencies.reserve(static_cast<size_t>(blocks));
+    std::atomic<bool> stopReceiving{false};
+    std::thread receiveThread([&]() {
+        unsigned char datagram[sizeof(int64_t) + kMaxPacketBytes];
+        while (!stopReceiving.load()) {
+            if (::recv(receiver, datagram, sizeof(datagram), 0) < static_cast<ssize_t>(sizeof(int64_t))) {
+                continue;
+            }
+            int64_t captureUs = 0;
+            std::memcpy(&captureUs, datagram, sizeof(captureUs));
+            latencies.push_back(steadyNowUs() - captureUs);
+        }
+    });
+
+    QThread encodeThread;
+    EncodeStage encodeStage(useCaptureQueue, ntohs(address.sin_port), rxBusyMs);
+    encodeStage.moveToThread(&encodeThread);
+    encodeThread.start();
+
+    std::atomic<bool> captureDone{false};
+    std::thread rxThread([&]() {
+        // Offset from the capture clock, as two unrelated devices would be.
+        auto next = std::chrono::steady_clock::now() + std::chrono::milliseconds(7);
+        while (!captureDone.load()) {
+            std::this_thread::sleep_until(next);
+            next += std::chrono::milliseconds(kBlockMs);
+            encodeStage.received();
+        }
+    });
+
+    std::vector<short> block(kBlockSamples);
+    auto next = std::chrono::steady_clock::now();
+    for (int i = 0; i < blocks; ++i) {
+        std::this_thread::sleep_until(next);
+        next += std::chrono::milliseconds(kBlockMs);
+        for (int n = 0; n < kBlockSamples; ++n) {
+            block[static_cast<size_t>(n)] = static_cast<short>(
+                8000.0 * std::sin(2.0 * 3.14159265 * 300.0 * (i * kBlockSamples + n) / kSampleRate));
+        }
+        encodeStage.captured(block.data(), kBlockSamples, steadyNowUs());
+    }
+    captureDone.store(true);
+    rxThread.join();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    encodeThread.quit();
+    encodeThread.wait();
+    stopReceiving.store(true);
+    receiveThread.join();
+    ::close(receiver);
+
+    if (encodeStage.droppedBlocks() > 0) {
+        std::printf("  (%llu blocks dropped on a full capture queue)\n",
+                    static_cast<unsigned long long>(encodeStage.droppedBlocks()));
+    }
+    return latencies;
+}
+
+void report(const char* name, std::vector<int64_t> latencies, int blocks)
+{
+    if (latencies.empty()) {
+        std::printf("%-22s no datagrams received\n", name);
+        return;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    const auto percentile = [&latencies](double p) {
+        const size_t index = std::min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()));
+        return latencies[index] / 1000.0;
+    };
+    std::printf("%-22s p50 %6.2f ms  p99 %6.2f ms  max %6.2f ms  (%zu/%d blocks)\n",
+                name, percentile(0.50), percentile(0.99), latencies.back() / 1000.0,
+                latencies.size(), blocks);
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const int blocks = argc > 1 ? std::max(1, std::atoi(argv[1])) : 500;
+    const int rxBusyMs = argc > 2 ? std::clamp(std::atoi(argv[2]), 0, kBlockMs - 1) : 8;
+
+    std::printf("%d capture blocks every %d ms, RX busies the encoding thread %d of every %d ms\n",
+                blocks, kBlockMs, rxBusyMs, kBlockMs);
+    report("event per block", runScenario(false, blocks, rxBusyMs), blocks);
+    report("AudioCaptureQueue", runScenario(true, blocks, rxBusyMs), blocks);
+    return 0;
+}
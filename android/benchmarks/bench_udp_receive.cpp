@@ -0,0 +1,212 @@
+// Receive-to-decode latency of reflector audio with the UDP socket read on
+// the GUI thread versus on UdpReceiveThread, while the GUI thread is kept
+// busy the way QML rendering keeps it busy on a phone.
+//
+// A sender thread emits one UDP_AUDIO datagram every 20 ms carrying its
+// send time.  The receive side hands each payload to a stand-in decode
+// thread through AudioPacketQueue, exactly as AudioEngine does, and the
+// decode thread records how long after sending it saw the packet.
+//
+//   bench_udp_receive [packets] [busyMsPerFrame]
+
+#include "AudioPacketQueue.h"
+#include "ReflectorProtocol.h"
+#include "UdpReceiveThread.h"
+
+#include <QCoreApplication>
+#include <QHostAddress>
+#include <QMetaObject>
+#include <QThread>
+#include <QTimer>
+#include <QUdpSocket>
+#include <QtEndian>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr int kPacketIntervalMs = 20;
+constexpr int kUiFrameIntervalMs = 16;
+constexpr int kPayloadBytes = 60;
+
+int64_t steadyNowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Stands in for AudioEngine: drains the packet queue on its own thread.
+class DecodeStage : public QObject
+{
+public:
+    void enqueue(const unsigned char* payload, int size, uint16_t sequence, int64_t arrivalUs)
+    {
+        if (!m_queue.push(sequence, payload, size, arrivalUs)) {
+            return;
+        }
+        if (!m_drainScheduled.exchange(true)) {
+            QMetaObject::invokeMethod(this, [this]() { drain(); }, Qt::QueuedConnection);
+        }
+    }
+
+    std::vector<int64_t> takeLatencies()
+    {
+        std::vector<int64_t> latencies;
+        QMetaObject::invokeMethod(this, [this, &latencies]() { latencies.swap(m_latenciesUs); },
+                                  Qt::BlockingQueuedConnection);
+        return latencies;
+    }
+
+private:
+    void drain()
+    {
+        m_drainScheduled.store(false);
+        while (const AudioPacketQueue::Packet* packet = m_queue.front()) {
+            int64_t sentUs = 0;
+            std::memcpy(&sentUs, packet->payload.data(), sizeof(sentUs));
+            m_latenciesUs.push_back(steadyNowUs() - sentUs);
+            m_queue.pop();
+        }
+    }
+
+    AudioPacketQueue m_queue;
+    std::atomic<bool> m_drainScheduled{false};
+    std::vector<int64_t> m_latenciesUs;
+};
+
+void sendPackets(quint16 port, int packets)
+{
+    const int sender = ::socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+
+    unsigned char datagram[sizeof(Svxlink::MsgUdpAudio) + kPayloadBytes] = {};
+    auto* message = reinterpret_cast<Svxlink::MsgUdpAudio*>(datagram);
+    message->type = qToBigEndian(Svxlink::UdpMsgType::UDP_AUDIO);
+    message->audioLen = qToBigEndian(static_cast<uint16_t>(kPayloadBytes));
+
+    auto next = std::chrono::steady_clock::now();
+    for (int i = 0; i < packets; ++i) {
+        std::this_thread::sleep_until(next);
+        next += std::chrono::milliseconds(kPacketIntervalMs);
+        message->sequenceNum = qToBigEndian(static_cast<uint16_t>(i));
+        const int64_t sentUs = steadyNowUs();
+        std::memcpy(datagram + sizeof(Svxlink::MsgUdpAudio), &sentUs, sizeof(sentUs));
+        ::sendto(sender, datagram, sizeof(datagram), 0, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    }
+    ::close(sender);
+}
+
+std::vector<int64_t> runScenario(bool useReceiveThread, int packets, int busyMs)
+{
+    QThread decodeThread;
+    DecodeStage decodeStage;
+    decodeStage.moveToThread(&decodeThread);
+    decodeThread.start();
+
+    QUdpSocket socket;
+    socket.bind(QHostAddress::LocalHost, 0);
+
+    QByteArray buffer(2048, Qt::Uninitialized);
+    UdpReceiveThread receiveThread(
+        [&decodeStage](const unsigned char* payload, int size, uint16_t sequence, int64_t arrivalUs) {
+            decodeStage.enqueue(payload, size, sequence, arrivalUs);
+        },
+        nullptr);
+
+    if (useReceiveThread) {
+        receiveThread.start(socket.socketDescriptor());
+    } else {
+        QObject::connect(&socket, &QUdpSocket::readyRead, &socket, [&]() {
+            while (socket.hasPendingDatagrams()) {
+                const qint64 size = socket.readDatagram(buffer.data(), buffer.size());
+                const int64_t arrivalUs = steadyNowUs();
+                if (size < static_cast<qint64>(sizeof(Svxlink::MsgUdpAudio))) {
+                    continue;
+                }
+                const auto* message = reinterpret_cast<const Svxlink::MsgUdpAudio*>(buffer.constData());
+                decodeStage.enqueue(message->audioData, qFromBigEndian(message->audioLen),
+                                    qFromBigEndian(message->sequenceNum), arrivalUs);
+            }
+        });
+    }
+
+    // Each UI frame spends busyMs of its 16 ms on the GUI thread.
+    QTimer uiFrames;
+    uiFrames.setTimerType(Qt::PreciseTimer);
+    uiFrames.setInterval(kUiFrameIntervalMs);
+    QObject::connect(&uiFrames, &QTimer::timeout, [busyMs]() {
+        const int64_t until = steadyNowUs() + busyMs * 1000;
+        while (steadyNowUs() < until) {
+        }
+    });
+    uiFrames.start();
+
+    std::atomic<bool> senderDone{false};
+    std::thread sender([&senderDone, port = socket.localPort(), packets]() {
+        sendPackets(port, packets);
+        senderDone.store(true);
+    });
+
+    QTimer doneCheck;
+    doneCheck.setInterval(50);
+    QObject::connect(&doneCheck, &QTimer::timeout, [&senderDone]() {
+        if (senderDone.load()) {
+            QTimer::singleShot(200, QCoreApplication::instance(), &QCoreApplication::quit);
+        }
+    });
+    doneCheck.start();
+    QCoreApplication::exec();
+
+    sender.join();
+    uiFrames.stop();
+    receiveThread.stop();
+    std::vector<int64_t> latencies = decodeStage.takeLatencies();
+    decodeThread.quit();
+    decodeThread.wait();
+    return latencies;
+}
+
+void report(const char* name, std::vector<int64_t> latencies, int packets)
+{
+    if (latencies.empty()) {
+        std::printf("%-22s no packets received\n", name);
+        return;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    const auto percentile = [&latencies](double p) {
+        const size_t index = std::min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()));
+        return latencies[index] / 1000.0;
+    };
+    std::printf("%-22s p50 %6.2f ms  p99 %6.2f ms  max %6.2f ms  (%zu/%d packets)\n",
+                name, percentile(0.50), percentile(0.99), latencies.back() / 1000.0,
+                latencies.size(), packets);
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const int packets = argc > 1 ? std::max(1, std::atoi(argv[1])) : 500;
+    const int busyMs = argc > 2 ? std::clamp(std::atoi(argv[2]), 0, kUiFrameIntervalMs) : 12;
+
+    std::printf("%d packets every %d ms, GUI thread busy %d of every %d ms\n",
+                packets, kPacketIntervalMs, busyMs, kUiFrameIntervalMs);
+    report("GUI-thread receive", runScenario(false, packets, busyMs), packets);
+    if (UdpReceiveThread::isSupported()) {
+        report("UdpReceiveThread", runScenario(true, packets, busyMs), packets);
+    }
+    return 0;
+}
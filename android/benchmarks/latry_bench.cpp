@@ -0,0 +1,697 @@
+// End-to-end client latency against a local reflector, through a whole
+// ReflectorClient and AudioEngine:
+//
+//   ptt_to_first_udp_audio   pttPressed() until the reflector has the first
+//                            UDP_AUDIO datagram
+//   talker_start_to_audible  TALKER_START and the first UDP_AUDIO packet
+//                            until the first non-silent sample leaves
+//                            AudioStreamDevice::readData()
+//   reconnect_after_drop     the reflector dropping the TCP link until the
+//                            client is back and has registered its UDP port
+//   mouth_to_ear             steady state, from a speech onset reaching the
+//                            talking client until it leaves the listening
+//                            client's readData(): encode, network, decode,
+//                            jitter buffer and resampler
+//
+// A talker and a listener connect to a ReflectorStandIn in a thread of its
+// own, through an ImpairmentProxy when a link spec is given.  No audio
+// device is used: a capture stage feeds the talker's AudioEngine 10 ms
+// blocks of a tone pulsed 200 ms in every second, as a microphone would,
+// and a playout stage pulls the listener's AudioStreamDevice every 10 ms
+// as a 44.1 kHz sink would, so the RX resampler is in the path.  Buffering
+// inside the devices themselves is not counted.
+//
+// The result is JSON on stdout, with percentiles in milliseconds, so runs
+// of two versions can be compared.
+//
+//   latry_bench [iterations] [seed] [link spec]
+
+#include "AudioEngine.h"
+#include "ReflectorClient.h"
+#include "tests/ImpairmentProxy.h"
+#include "tests/NetworkImpairment.h"
+#include "tests/ReflectorStandIn.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <QTimer>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr quint32 kTalkgroup = 9;
+const QString kTalkerCallsign = QStringLiteral("N0TX");
+const QString kListenerCallsign = QStringLiteral("N0RX");
+const QString kScriptedCallsign = QStringLiteral("N0TALK");
+const QByteArray kAuthKey = QByteArrayLiteral("bench-secret");
+
+constexpr int kBlockMs = 10;
+constexpr int kSinkSampleRate = 44100;
+constexpr int kPulseMs = 200;
+constexpr int kPulsePeriodMs = 1000;
+constexpr double kToneHz = 440.0;
+constexpr float kToneAmplitude = 0.5f;
+// Opus leaves silence far below this.
+constexpr float kAudibleLevel = 0.05f;
+// Quiet for this long before an audible block starts a new onset.
+constexpr int kOnsetGapMs = 300;
+constexpr int kOverMs = 400;
+constexpr int kSettleMs = 300;
+// Pulses the adaptive jitter buffer gets to find its depth.
+constexpr int kWarmupPulses = 3;
+constexpr int kTimeoutMs = 5000;
+constexpr int kTxTimeoutSeconds = 3600;
+constexpr double kPi = 3.14159265358979323846;
+
+int64_t steadyNowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Runs the event loop until done() or the timeout.  Sockets and timers are
+// served as they fire, so waiting adds nothing to what is measured.
+bool runUntil(const std::function<bool()> &done, int timeoutMs)
+{
+    if (done()) {
+        return true;
+    }
+    QEventLoop loop;
+    QTimer poll;
+    poll.setTimerType(Qt::PreciseTimer);
+    QElapsedTimer elapsed;
+    elapsed.start();
+    QObject::connect(&poll, &QTimer::timeout, &loop, [&]() {
+        if (done() || elapsed.elapsed() >= timeoutMs) {
+            loop.quit();
+        }
+    });
+    poll.start(1);
+    loop.exec();
+    return done();
+}
+
+void runFor(int ms)
+{
+    runUntil([]() { return false; }, ms);
+}
+
+// Time stamps taken on another thread.
+class Stamps
+{
+public:
+    void add(int64_t us)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_us.push_back(us);
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_us.clear();
+    }
+
+    std::vector<int64_t> values() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_us;
+    }
+
+    // The first at or after sinceUs, or -1.
+    int64_t firstAfter(int64_t sinceUs) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (int64_t us : m_us) {
+            if (us >= sinceUs) {
+                return us;
+            }
+        }
+        return -1;
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<int64_t> m_us;
+};
+
+struct Metric {
+    std::vector<int64_t> latencyUs;
+    int failures = 0;
+};
+
+QJsonObject summarize(Metric metric)
+{
+    QJsonObject summary;
+    summary.insert(QStringLiteral("samples"), static_cast<int>(metric.latencyUs.size()));
+    summary.insert(QStringLiteral("failures"), metric.failures);
+    std::vector<int64_t> &latencies = metric.latencyUs;
+    if (latencies.empty()) {
+        return summary;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    const auto ms = [](int64_t us) { return std::round(us / 10.0) / 100.0; };
+    const auto percentile = [&latencies, &ms](double p) {
+        const size_t index = std::min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()));
+        return ms(latencies[index]);
+    };
+    int64_t totalUs = 0;
+    for (int64_t us : latencies) {
+        totalUs += us;
+    }
+    summary.insert(QStringLiteral("min_ms"), ms(latencies.front()));
+    summary.insert(QStringLiteral("mean_ms"), ms(totalUs / static_cast<int64_t>(latencies.size())));
+    summary.insert(QStringLiteral("p50_ms"), percentile(0.50));
+    summary.insert(QStringLiteral("p90_ms"), percentile(0.90));
+    summary.insert(QStringLiteral("p95_ms"), percentile(0.95));
+    summary.insert(QStringLiteral("p99_ms"), percentile(0.99));
+    summary.insert(QStringLiteral("max_ms"), ms(latencies.back()));
+    return summary;
+}
+
+// The client logs every packet, and every PTT without a microphone; stdout
+// is kept for the result.
+void keepCriticalMessages(QtMsgType type, const QMessageLogContext &, const QString &message)
+{
+    if (type == QtCriticalMsg || type == QtFatalMsg) {
+        std::fprintf(stderr, "%s\n", qPrintable(message));
+    }
+}
+
+// Stands in for the talker's microphone: a 10 ms block of the pulsed tone
+// each time one has been spoken, on the audio thread.
+struct CaptureStage {
+    QTimer *timer = nullptr;
+    int sampleRate = AudioEngine::SAMPLE_RATE;
+    int64_t openedUs = 0;
+    int64_t blocks = 0;
+    double phase = 0.0;
+    std::vector<float> block;
+    // When each pulse began.
+    Stamps onsets;
+};
+
+// Stands in for the listener's audio sink: pulls 10 ms periods of
+// AudioStreamDevice, as the device would, on the audio thread.
+struct PlayoutStage {
+    QTimer *timer = nullptr;
+    int64_t startedUs = 0;
+    int64_t samples = 0;
+    std::vector<float> period;
+    std::atomic<int64_t> lastAudibleUs{std::numeric_limits<int64_t>::min() / 2};
+    // When audio first left readData() after a pause.
+    Stamps onsets;
+};
+}
+
+class LatencyBench
+{
+public:
+    LatencyBench(int iterations, quint64 seed, const QString &linkSpec, const NetworkImpairment::Config &link);
+    ~LatencyBench();
+
+    bool start(QString *error);
+    QJsonObject run();
+
+private:
+    template <typename Function>
+    void onStandIn(Function function)
+    {
+        QMetaObject::invokeMethod(m_standIn, function, Qt::BlockingQueuedConnection);
+    }
+    template <typename Function>
+    static void onAudioThread(ReflectorClient &client, Function function,
+                              Qt::ConnectionType type = Qt::BlockingQueuedConnection)
+    {
+        QMetaObject::invokeMethod(client.m_audioEngine, function, type);
+    }
+
+    bool connectClient(ReflectorClient &client, const QString &callsign);
+    bool isConnected(const ReflectorClient &client) const;
+    void detachAudioDevices(ReflectorClient &client);
+    void attachPlayout();
+    void pullPlayout();
+    void openCapture();
+    void deliverCapture();
+    void closeCapture();
+    // The channel free and the listener quiet again.
+    bool waitForIdle();
+
+    Metric measurePttToFirstAudio();
+    Metric measureTalkerStartToAudible();
+    Metric measureMouthToEar();
+    Metric measureReconnect();
+
+    int m_iterations;
+    quint64 m_seed;
+    QString m_linkSpec;
+    NetworkImpairment::Config m_link;
+
+    QThread m_standInThread;
+    ReflectorStandIn *m_standIn = nullptr;
+    ImpairmentProxy *m_proxy = nullptr;
+    quint16 m_port = 0;
+    // UDP_AUDIO from the talker, and the listener's UDP registrations, as
+    // the stand-in sees them.
+    Stamps m_talkerAudio;
+    Stamps m_listenerRegistered;
+
+    // Before the clients: the stages' timers run until the audio threads go.
+    CaptureStage m_capture;
+    PlayoutStage m_playout;
+    ReflectorClient m_talker;
+    ReflectorClient m_listener;
+};
+
+LatencyBench::LatencyBench(int iterations, quint64 seed, const QString &linkSpec,
+                           const NetworkImpairment::Config &link)
+    : m_iterations(iterations)
+    , m_seed(seed)
+    , m_linkSpec(linkSpec)
+    , m_link(link)
+{
+}
+
+LatencyBench::~LatencyBench()
+{
+    if (m_capture.timer) {
+        onAudioThread(m_talker, [this]() { m_capture.timer->stop(); });
+    }
+    if (m_playout.timer) {
+        onAudioThread(m_listener, [this]() { m_playout.timer->stop(); });
+    }
+    for (ReflectorClient *client : {&m_talker, &m_listener}) {
+        client->disconnectFromServer();
+        client->prepareForShutdown();
+    }
+
+    if (m_standIn) {
+        onStandIn([this]() {
+            if (m_proxy) {
+                m_proxy->close();
+                delete m_proxy;
+            }
+            m_standIn->close();
+        });
+        QObject::connect(&m_standInThread, &QThread::finished, m_standIn, &QObject::deleteLater);
+    }
+    m_standInThread.quit();
+    m_standInThread.wait();
+}
+
+bool LatencyBench::start(QString *error)
+{
+    m_standIn = new ReflectorStandIn;
+    m_standIn->moveToThread(&m_standInThread);
+    m_standInThread.start();
+
+    QObject::connect(m_standIn, &ReflectorStandIn::audioReceived, m_standIn,
+                     [this](const QString &callsign) {
+                         if (callsign == kTalkerCallsign) {
+                             m_talkerAudio.add(steadyNowUs());
+                         }
+                     }, Qt::DirectConnection);
+    QObject::connect(m_standIn, &ReflectorStandIn::udpRegistered, m_standIn,
+                     [this](const QString &callsign) {
+                         if (callsign == kListenerCallsign) {
+                             m_listenerRegistered.add(steadyNowUs());
+                         }
+                     }, Qt::DirectConnection);
+
+    bool listening = false;
+    onStandIn([&]() {
+        m_standIn->addUser(kTalkerCallsign, kAuthKey);
+        m_standIn->addUser(kListenerCallsign, kAuthKey);
+        listening = m_standIn->listen();
+        m_port = m_standIn->port();
+        *error = m_standIn->errorString();
+        if (!listening || m_linkSpec.isEmpty()) {
+            return;
+        }
+
+        // Next to the stand-in, in its thread.
+        m_proxy = new ImpairmentProxy;
+        m_proxy->setUpstream(QHostAddress(QHostAddress::LocalHost), m_port);
+        m_proxy->setUplink(m_link);
+        m_proxy->setDownlink(m_link);
+        m_proxy->setSeed(m_seed);
+        listening = m_proxy->listen();
+        m_port = m_proxy->port();
+        *error = m_proxy->errorString();
+    });
+    if (!listening) {
+        return false;
+    }
+
+    for (ReflectorClient *client : {&m_talker, &m_listener}) {
+        // Release at once, so an over ends where the measurement does, and
+        // let the mouth-to-ear over run as long as it needs.
+        client->setPttHangTimeMs(0);
+        client->setTxTimeoutSeconds(kTxTimeoutSeconds);
+    }
+    if (!connectClient(m_talker, kTalkerCallsign) || !connectClient(m_listener, kListenerCallsign)) {
+        *error = QStringLiteral("The clients did not connect to the stand-in");
+        return false;
+    }
+    detachAudioDevices(m_talker);
+    detachAudioDevices(m_listener);
+    attachPlayout();
+    return true;
+}
+
+QJsonObject LatencyBench::run()
+{
+    QJsonObject metrics;
+    metrics.insert(QStringLiteral("ptt_to_first_udp_audio"), summarize(measurePttToFirstAudio()));
+    metrics.insert(QStringLiteral("talker_start_to_audible"), summarize(measureTalkerStartToAudible()));
+    metrics.insert(QStringLiteral("mouth_to_ear"), summarize(measureMouthToEar()));
+    metrics.insert(QStringLiteral("reconnect_after_drop"), summarize(measureReconnect()));
+
+    QJsonObject result;
+    result.insert(QStringLiteral("version"), QStringLiteral(LATRY_VERSION_NAME));
+    result.insert(QStringLiteral("qt"), QString::fromLatin1(qVersion()));
+    result.insert(QStringLiteral("iterations"), m_iterations);
+    result.insert(QStringLiteral("seed"), QString::number(m_seed));
+    result.insert(QStringLiteral("link"), m_linkSpec.isEmpty() ? QStringLiteral("direct") : m_linkSpec);
+    result.insert(QStringLiteral("sink_sample_rate"), kSinkSampleRate);
+    result.insert(QStringLiteral("metrics"), metrics);
+    return result;
+}
+
+// --- Setup ---
+
+bool LatencyBench::connectClient(ReflectorClient &client, const QString &callsign)
+{
+    client.connectToServer(QStringLiteral("127.0.0.1"), m_port, QString::fromUtf8(kAuthKey), callsign,
+                           kTalkgroup, QString());
+    return runUntil([&]() { return isConnected(client) && client.m_audioReady; }, kTimeoutMs);
+}
+
+bool LatencyBench::isConnected(const ReflectorClient &client) const
+{
+    return client.connectionStatus() == QStringLiteral("Connected to TG %1").arg(kTalkgroup);
+}
+
+void LatencyBench::detachAudioDevices(ReflectorClient &client)
+{
+    // Whatever devices the machine has stay silent; the stages take their
+    // place.  The sink is stopped rather than deleted, so a reconnect
+    // finds the output set up and leaves it alone.
+    onAudioThread(client, [&client]() {
+        AudioEngine *engine = client.m_audioEngine;
+        if (engine->m_audioSink) {
+            engine->m_audioSink->stop();
+        }
+    });
+}
+
+void LatencyBench::attachPlayout()
+{
+    onAudioThread(m_listener, [this]() {
+        AudioEngine *engine = m_listener.m_audioEngine;
+        engine->configureRxSampleRate(kSinkSampleRate);
+        engine->m_outputResampler.reset();
+        if (engine->m_rxSampleRate != kSinkSampleRate) {
+            engine->m_outputResampler = std::make_unique<Resampler>(engine->m_rxSampleRate, kSinkSampleRate,
+                                                                    AudioEngine::CHANNELS);
+        }
+        if (engine->m_audioStreamDevice) {
+            engine->m_audioStreamDevice->deleteLater();
+        }
+        engine->m_audioStreamDevice = new AudioStreamDevice(&engine->m_jitterBuffer,
+                                                            engine->m_outputResampler.get(),
+                                                            engine->m_rxSampleRate, kSinkSampleRate,
+                                                            QAudioFormat::Float, engine);
+        engine->m_outputFormat.setSampleRate(kSinkSampleRate);
+        engine->m_outputFormat.setChannelCount(AudioEngine::CHANNELS);
+        engine->m_outputFormat.setSampleFormat(QAudioFormat::Float);
+
+        m_playout.timer = new QTimer(engine);
+        m_playout.timer->setTimerType(Qt::PreciseTimer);
+        QObject::connect(m_playout.timer, &QTimer::timeout, engine, [this]() { pullPlayout(); });
+        m_playout.startedUs = steadyNowUs();
+        m_playout.samples = 0;
+        m_playout.timer->start(kBlockMs);
+    });
+}
+
+// --- Stages ---
+
+void LatencyBench::pullPlayout()
+{
+    // Paced by the clock rather than by tick count, as the device is; what
+    // readData() cannot fill is an underrun and is not asked for again.
+    const int64_t nowUs = steadyNowUs();
+    const int64_t due = (nowUs - m_playout.startedUs) * kSinkSampleRate / 1000000 - m_playout.samples;
+    if (due <= 0) {
+        return;
+    }
+    m_playout.samples += due;
+    if (m_playout.period.size() < static_cast<size_t>(due)) {
+        m_playout.period.resize(static_cast<size_t>(due));
+    }
+
+    const qint64 bytes = m_listener.m_audioEngine->m_audioStreamDevice->readData(
+        reinterpret_cast<char *>(m_playout.period.data()), due * static_cast<qint64>(sizeof(float)));
+    const int count = bytes > 0 ? static_cast<int>(bytes / static_cast<qint64>(sizeof(float))) : 0;
+    const bool audible = std::any_of(m_playout.period.begin(), m_playout.period.begin() + count,
+                                     [](float sample) { return std::fabs(sample) > kAudibleLevel; });
+    if (!audible) {
+        return;
+    }
+    if (nowUs - m_playout.lastAudibleUs.load() >= kOnsetGapMs * 1000LL) {
+        m_playout.onsets.add(nowUs);
+    }
+    m_playout.lastAudibleUs.store(nowUs);
+}
+
+void LatencyBench::openCapture()
+{
+    // Queued behind the startRecording() that pttPressed() just queued.
+    onAudioThread(m_talker, [this]() {
+        AudioEngine *engine = m_talker.m_audioEngine;
+        if (engine->m_audioInputDevice) {
+            // A real microphone; only the test signal goes out.
+            QObject::disconnect(engine->m_audioInputDevice, &QIODevice::readyRead,
+                                engine, &AudioEngine::onAudioInputReadyRead);
+            engine->m_audioSource->stop();
+            engine->m_audioInputDevice = nullptr;
+        } else if (!engine->m_recording) {
+            // No capture device, so startRecording() gave up before it
+            // started the transmission; start it as it would have.
+            engine->resetTxForTransmission();
+            engine->m_recording = true;
+        }
+
+        if (!m_capture.timer) {
+            m_capture.timer = new QTimer(engine);
+            m_capture.timer->setTimerType(Qt::PreciseTimer);
+            QObject::connect(m_capture.timer, &QTimer::timeout, engine, [this]() { deliverCapture(); });
+        }
+        m_capture.sampleRate = engine->m_txSampleRate;
+        m_capture.block.resize(static_cast<size_t>(m_capture.sampleRate * kBlockMs / 1000));
+        m_capture.openedUs = steadyNowUs();
+        m_capture.blocks = 0;
+        m_capture.phase = 0.0;
+        m_capture.timer->start(kBlockMs);
+    }, Qt::QueuedConnection);
+}
+
+void LatencyBench::deliverCapture()
+{
+    AudioEngine *engine = m_talker.m_audioEngine;
+    const int64_t elapsedUs = steadyNowUs() - m_capture.openedUs;
+    const double step = 2.0 * kPi * kToneHz / m_capture.sampleRate;
+    while ((m_capture.blocks + 1) * kBlockMs * 1000LL <= elapsedUs) {
+        const int64_t blockMs = m_capture.blocks * kBlockMs;
+        const bool pulse = blockMs % kPulsePeriodMs < kPulseMs;
+        if (blockMs % kPulsePeriodMs == 0) {
+            m_capture.onsets.add(m_capture.openedUs + blockMs * 1000);
+        }
+        for (float &sample : m_capture.block) {
+            sample = pulse ? kToneAmplitude * static_cast<float>(std::sin(m_capture.phase)) : 0.0f;
+            m_capture.phase = std::fmod(m_capture.phase + step, 2.0 * kPi);
+        }
+        engine->processCapturedFloatSamples(m_capture.block.data(), static_cast<int>(m_capture.block.size()));
+        ++m_capture.blocks;
+    }
+}
+
+void LatencyBench::closeCapture()
+{
+    onAudioThread(m_talker, [this]() {
+        if (m_capture.timer) {
+            m_capture.timer->stop();
+        }
+    }, Qt::QueuedConnection);
+}
+
+bool LatencyBench::waitForIdle()
+{
+    return runUntil([this]() {
+        if (m_talker.pttActive() || !isConnected(m_talker) || !isConnected(m_listener)) {
+            return false;
+        }
+        if (steadyNowUs() - m_playout.lastAudibleUs.load() < kSettleMs * 1000LL) {
+            return false;
+        }
+        QString talker;
+        onStandIn([&]() { talker = m_standIn->talker(kTalkgroup); });
+        return talker.isEmpty();
+    }, kTimeoutMs);
+}
+
+// --- Measurements ---
+
+Metric LatencyBench::measurePttToFirstAudio()
+{
+    Metric metric;
+    for (int i = 0; i < m_iterations; ++i) {
+        if (!waitForIdle()) {
+            ++metric.failures;
+            continue;
+        }
+
+        m_talkerAudio.clear();
+        const int64_t pressedUs = steadyNowUs();
+        m_talker.pttPressed();
+        openCapture();
+        if (runUntil([&]() { return m_talkerAudio.firstAfter(pressedUs) >= 0; }, kTimeoutMs)) {
+            metric.latencyUs.push_back(m_talkerAudio.firstAfter(pressedUs) - pressedUs);
+        } else {
+            ++metric.failures;
+        }
+
+        runFor(kOverMs);
+        m_talker.pttReleased();
+        closeCapture();
+    }
+    return metric;
+}
+
+Metric LatencyBench::measureTalkerStartToAudible()
+{
+    Metric metric;
+    const QList<QByteArray> tone = ReflectorStandIn::encodeTone(kToneHz, kOverMs);
+    for (int i = 0; i < m_iterations; ++i) {
+        if (!waitForIdle()) {
+            ++metric.failures;
+            continue;
+        }
+
+        // TALKER_START and the first packet go out together.
+        int64_t startedUs = 0;
+        bool started = false;
+        onStandIn([&]() {
+            startedUs = steadyNowUs();
+            started = m_standIn->startScriptedTalker(kScriptedCallsign, kTalkgroup, tone);
+        });
+        if (started && runUntil([&]() { return m_playout.onsets.firstAfter(startedUs) >= 0; }, kTimeoutMs)) {
+            metric.latencyUs.push_back(m_playout.onsets.firstAfter(startedUs) - startedUs);
+        } else {
+            ++metric.failures;
+        }
+    }
+    return metric;
+}
+
+Metric LatencyBench::measureMouthToEar()
+{
+    Metric metric;
+    if (!waitForIdle()) {
+        metric.failures = m_iterations;
+        return metric;
+    }
+
+    // One long over, so the jitter buffer settles; each pulse is a sample.
+    m_capture.onsets.clear();
+    m_talker.pttPressed();
+    openCapture();
+    runFor((kWarmupPulses + m_iterations + 1) * kPulsePeriodMs);
+    m_talker.pttReleased();
+    closeCapture();
+
+    const std::vector<int64_t> mouth = m_capture.onsets.values();
+    const std::vector<int64_t> ear = m_playout.onsets.values();
+    for (int pulse = kWarmupPulses; pulse < kWarmupPulses + m_iterations; ++pulse) {
+        if (pulse >= static_cast<int>(mouth.size())) {
+            ++metric.failures;
+            continue;
+        }
+        // Heard before the next pulse was spoken, or lost.
+        const int64_t spokenUs = mouth[static_cast<size_t>(pulse)];
+        const auto heard = std::find_if(ear.begin(), ear.end(), [spokenUs](int64_t us) {
+            return us >= spokenUs && us < spokenUs + kPulsePeriodMs * 1000LL;
+        });
+        if (heard != ear.end()) {
+            metric.latencyUs.push_back(*heard - spokenUs);
+        } else {
+            ++metric.failures;
+        }
+    }
+    return metric;
+}
+
+Metric LatencyBench::measureReconnect()
+{
+    Metric metric;
+    for (int i = 0; i < m_iterations; ++i) {
+        if (!waitForIdle()) {
+            ++metric.failures;
+            continue;
+        }
+
+        int64_t droppedUs = 0;
+        onStandIn([&]() {
+            droppedUs = steadyNowUs();
+            m_standIn->dropClient(kListenerCallsign);
+        });
+        if (runUntil([&]() { return m_listenerRegistered.firstAfter(droppedUs) >= 0; }, kTimeoutMs)) {
+            metric.latencyUs.push_back(m_listenerRegistered.firstAfter(droppedUs) - droppedUs);
+        } else {
+            ++metric.failures;
+        }
+    }
+    return metric;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    qInstallMessageHandler(keepCriticalMessages);
+
+    const int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 20;
+    const quint64 seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1;
+    const QString linkSpec = argc > 3 ? QString::fromLocal8Bit(argv[3]) : QString();
+    NetworkImpairment::Config link;
+    std::string error;
+    if (!linkSpec.isEmpty() && !NetworkImpairment::parse(linkSpec.toStdString(), link, &error)) {
+        std::fprintf(stderr, "%s: %s\n", qPrintable(linkSpec), error.c_str());
+        return 2;
+    }
+
+    LatencyBench bench(iterations, seed, linkSpec, link);
+    QString startError;
+    if (!bench.start(&startError)) {
+        std::fprintf(stderr, "%s\n", qPrintable(startError));
+        return 1;
+    }
+    std::printf("%s", QJsonDocument(bench.run()).toJson(QJsonDocument::Indented).constData());
+    return 0;
+}
@@ -0,0 +1,59 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+// Replaces the global allocation functions so a test can assert that a code
+// path does not touch the heap.  Include from exactly one translation unit
+// of a test executable.
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace AllocationCounterDetail {
+inline std::atomic<bool> counting{false};
+inline std::atomic<long> allocations{0};
+}
+
+void* operator new(std::size_t size)
+{
+    if (AllocationCounterDetail::counting.load(std::memory_order_relaxed)) {
+        AllocationCounterDetail::allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* memory = std::malloc(size > 0 ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+// Counts allocations made by any thread while an instance is alive.
+class AllocationCounter
+{
+public:
+    AllocationCounter()
+    {
+        AllocationCounterDetail::allocations.store(0, std::memory_order_relaxed);
+        AllocationCounterDetail::counting.store(true, std::memory_order_relaxed);
+    }
+
+    ~AllocationCounter()
+    {
+        AllocationCounterDetail::counting.store(false, std::memory_order_relaxed);
+    }
+
+    AllocationCounter(const AllocationCounter&) = delete;
+    AllocationCounter& operator=(const AllocationCounter&) = delete;
+
+    long count() const { return AllocationCounterDetail::allocations.load(std::memory_order_relaxed); }
+};
+
+#endif // ALLOCATIONCOUNTER_H
@@ -0,0 +1,321 @@
+#include "ImpairmentProxy.h"
+
+#include <QDebug>
+#include <QNetworkDatagram>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUdpSocket>
+
+#include <algorithm>
+
+namespace {
+constexpr int kListenAttempts = 16;
+}
+
+ImpairmentProxy::ImpairmentProxy(QObject *parent)
+    : QObject(parent)
+    , m_tcpServer(new QTcpServer(this))
+    , m_udpSocket(new QUdpSocket(this))
+    , m_deliveryTimer(new QTimer(this))
+    , m_uplink(NetworkImpairment::Config())
+    , m_downlink(NetworkImpairment::Config())
+    , m_tcpUplink(NetworkImpairment::Config())
+    , m_tcpDownlink(NetworkImpairment::Config())
+{
+    connect(m_tcpServer, &QTcpServer::newConnection, this, &ImpairmentProxy::onNewConnection);
+    connect(m_udpSocket, &QUdpSocket::readyRead, this, &ImpairmentProxy::onClientDatagrams);
+
+    m_deliveryTimer->setSingleShot(true);
+    m_deliveryTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_deliveryTimer, &QTimer::timeout, this, &ImpairmentProxy::onDeliveryTimer);
+}
+
+ImpairmentProxy::~ImpairmentProxy()
+{
+    close();
+}
+
+// --- Setup ---
+
+void ImpairmentProxy::setUpstream(const QHostAddress &address, quint16 port)
+{
+    m_upstreamAddress = address;
+    m_upstreamPort = port;
+}
+
+bool ImpairmentProxy::listen(const QHostAddress &address, quint16 port)
+{
+    close();
+
+    if (m_upstreamAddress.isNull() || m_upstreamPort == 0) {
+        m_errorString = QStringLiteral("No upstream reflector set");
+        return false;
+    }
+
+    // Each model gets a seed of its own, so TCP traffic does not shift the
+    // UDP impairment and the two directions are independent.
+    m_uplink.setConfig(m_uplinkConfig);
+    m_uplink.reset(m_seed * 4);
+    m_downlink.setConfig(m_downlinkConfig);
+    m_downlink.reset(m_seed * 4 + 1);
+    m_tcpUplink.setConfig(m_uplinkConfig);
+    m_tcpUplink.reset(m_seed * 4 + 2);
+    m_tcpDownlink.setConfig(m_downlinkConfig);
+    m_tcpDownlink.reset(m_seed * 4 + 3);
+    m_clock.start();
+
+    const int attempts = port == 0 ? kListenAttempts : 1;
+    for (int attempt = 0; attempt < attempts; ++attempt) {
+        if (!m_tcpServer->listen(address, port)) {
+            m_errorString = m_tcpServer->errorString();
+            return false;
+        }
+        if (m_udpSocket->bind(address, m_tcpServer->serverPort())) {
+            m_port = m_tcpServer->serverPort();
+            m_errorString.clear();
+            return true;
+        }
+        m_errorString = m_udpSocket->errorString();
+        m_tcpServer->close();
+    }
+    return false;
+}
+
+void ImpairmentProxy::close()
+{
+    m_deliveryTimer->stop();
+    m_pending = decltype(m_pending)();
+
+    std::vector<quint32> ids;
+    for (const auto &entry : m_connections) {
+        ids.push_back(entry.first);
+    }
+    for (quint32 id : ids) {
+        closeConnection(id);
+    }
+
+    for (auto &entry : m_peers) {
+        entry.second.upstream->disconnect(this);
+        entry.second.upstream->deleteLater();
+    }
+    m_peers.clear();
+
+    m_tcpServer->close();
+    m_udpSocket->close();
+    m_port = 0;
+}
+
+ImpairmentProxy::Stats ImpairmentProxy::stats() const
+{
+    return {m_uplink.stats(), m_downlink.stats(), m_tcpUplink.stats(), m_tcpDownlink.stats()};
+}
+
+// --- Scheduling ---
+
+void ImpairmentProxy::schedule(qint64 atUs, Action action, Direction direction, quint32 id,
+                               const QByteArray &data)
+{
+    m_pending.push({atUs, m_nextOrder++, action, direction, id, data});
+    armDeliveryTimer();
+}
+
+void ImpairmentProxy::armDeliveryTimer()
+{
+    if (m_pending.empty()) {
+        m_deliveryTimer->stop();
+        return;
+    }
+    const qint64 waitUs = std::max<qint64>(0, m_pending.top().atUs - nowUs());
+    m_deliveryTimer->start(static_cast<int>((waitUs + 999) / 1000));
+}
+
+void ImpairmentProxy::onDeliveryTimer()
+{
+    const qint64 now = nowUs();
+    while (!m_pending.empty() && m_pending.top().atUs <= now) {
+        const Pending pending = m_pending.top();
+        m_pending.pop();
+        deliver(pending);
+    }
+    armDeliveryTimer();
+}
+
+void ImpairmentProxy::deliver(const Pending &pending)
+{
+    if (pending.action == Action::Datagram) {
+        const auto peer = m_peers.find(pending.id);
+        if (peer == m_peers.end()) {
+            return;
+        }
+        if (pending.direction == Direction::Uplink) {
+            peer->second.upstream->writeDatagram(pending.data, m_upstreamAddress, m_upstreamPort);
+        } else {
+            m_udpSocket->writeDatagram(pending.data, peer->second.address, peer->second.port);
+        }
+        return;
+    }
+
+    const auto connection = m_connections.find(pending.id);
+    if (connection == m_connections.end()) {
+        return;
+    }
+    if (pending.action == Action::Close) {
+        closeConnection(pending.id);
+        return;
+    }
+
+    if (pending.direction == Direction::Downlink) {
+        connection->second.client->write(pending.data);
+    } else if (connection->second.upstream->state() == QAbstractSocket::ConnectedState) {
+        connection->second.upstream->write(pending.data);
+    } else {
+        connection->second.pendingUplink.append(pending.data);
+    }
+}
+
+// --- TCP ---
+
+void ImpairmentProxy::onNewConnection()
+{
+    while (QTcpSocket *client = m_tcpServer->nextPendingConnection()) {
+        const quint32 id = m_nextConnectionId++;
+        auto *upstream = new QTcpSocket(this);
+        m_connections[id] = Connection{client, upstream, {}};
+
+        connect(client, &QTcpSocket::readyRead, this, [this, id]() { onTcpReadyRead(id, Direction::Uplink); });
+        connect(client, &QTcpSocket::disconnected, this, [this, id]() { onTcpDisconnected(id, Direction::Uplink); });
+        connect(upstream, &QTcpSocket::connected, this, [this, id]() { onUpstreamConnected(id); });
+        connect(upstream, &QTcpSocket::readyRead, this, [this, id]() { onTcpReadyRead(id, Direction::Downlink); });
+        connect(upstream, &QTcpSocket::disconnected, this, [this, id]() { onTcpDisconnected(id, Direction::Downlink); });
+        connect(upstream, &QTcpSocket::errorOccurred, this, [this, id, upstream](QAbstractSocket::SocketError error) {
+            // A remote close also arrives as disconnected(), behind the data.
+            if (error != QAbstractSocket::RemoteHostClosedError) {
+                qWarning() << "ImpairmentProxy - upstream connection failed:" << upstream->errorString();
+                closeConnection(id);
+            }
+        });
+
+        upstream->connectToHost(m_upstreamAddress, m_upstreamPort);
+    }
+}
+
+void ImpairmentProxy::onUpstreamConnected(quint32 id)
+{
+    const auto connection = m_connections.find(id);
+    if (connection == m_connections.end() || connection->second.pendingUplink.isEmpty()) {
+        return;
+    }
+    connection->second.upstream->write(connection->second.pendingUplink);
+    connection->second.pendingUplink.clear();
+}
+
+void ImpairmentProxy::onTcpReadyRead(quint32 id, Direction direction)
+{
+    const auto connection = m_connections.find(id);
+    if (connection == m_connections.end()) {
+        return;
+    }
+
+    QTcpSocket *source = direction == Direction::Uplink ? connection->second.client : connection->second.upstream;
+    const QByteArray data = source->readAll();
+    if (data.isEmpty()) {
+        return;
+    }
+    NetworkImpairment &model = direction == Direction::Uplink ? m_tcpUplink : m_tcpDownlink;
+    schedule(model.submitStream(nowUs(), static_cast<int>(data.size())), Action::Stream, direction, id, data);
+}
+
+void ImpairmentProxy::onTcpDisconnected(quint32 id, Direction direction)
+{
+    // The close goes through the same link as the data, so it cannot
+    // overtake bytes still in flight.
+    NetworkImpairment &model = direction == Direction::Uplink ? m_tcpUplink : m_tcpDownlink;
+    schedule(model.submitStream(nowUs(), 0), Action::Close, direction, id, {});
+}
+
+void ImpairmentProxy::closeConnection(quint32 id)
+{
+    const auto connection = m_connections.find(id);
+    if (connection == m_connections.end()) {
+        return;
+    }
+
+    for (QTcpSocket *socket : {connection->second.client, connection->second.upstream}) {
+        socket->disconnect(this);
+        if (socket->state() == QAbstractSocket::ConnectedState) {
+            // Deleting the socket would abort it; let it flush first.
+            connect(socket, &QAbstractSocket::disconnected, socket, &QObject::deleteLater);
+            socket->disconnectFromHost();
+        } else {
+            socket->abort();
+            socket->deleteLater();
+        }
+    }
+    m_connections.erase(connection);
+}
+
+// --- UDP ---
+
+quint32 ImpairmentProxy::peerFor(const QHostAddress &address, quint16 port)
+{
+    for (const auto &entry : m_peers) {
+        if (entry.second.port == port && entry.second.address.isEqual(address)) {
+            return entry.first;
+        }
+    }
+
+    const quint32 peerId = m_nextPeerId++;
+    auto *upstream = new QUdpSocket(this);
+    const QHostAddress any = m_upstreamAddress.protocol() == QAbstractSocket::IPv6Protocol
+                                 ? QHostAddress(QHostAddress::AnyIPv6)
+                                 : QHostAddress(QHostAddress::AnyIPv4);
+    if (!upstream->bind(any, 0)) {
+        qWarning() << "ImpairmentProxy - upstream UDP bind failed:" << upstream->errorString();
+    }
+    connect(upstream, &QUdpSocket::readyRead, this, [this, peerId]() { onUpstreamDatagrams(peerId); });
+
+    UdpPeer &peer = m_peers[peerId];
+    peer.address = address;
+    peer.port = port;
+    peer.upstream = upstream;
+    return peerId;
+}
+
+void ImpairmentProxy::onClientDatagrams()
+{
+    while (m_udpSocket->hasPendingDatagrams()) {
+        const QNetworkDatagram datagram = m_udpSocket->receiveDatagram();
+        if (!datagram.isValid()) {
+            continue;
+        }
+        const quint32 peerId = peerFor(datagram.senderAddress(), static_cast<quint16>(datagram.senderPort()));
+
+        const QByteArray data = datagram.data();
+        const NetworkImpairment::Delivery delivery = m_uplink.submit(nowUs(), static_cast<int>(data.size()));
+        for (int copy = 0; copy < delivery.copies; ++copy) {
+            schedule(delivery.atUs[copy], Action::Datagram, Direction::Uplink, peerId, data);
+        }
+    }
+}
+
+void ImpairmentProxy::onUpstreamDatagrams(quint32 peerId)
+{
+    const auto peer = m_peers.find(peerId);
+    if (peer == m_peers.end()) {
+        return;
+    }
+
+    QUdpSocket *upstream = peer->second.upstream;
+    while (upstream->hasPendingDatagrams()) {
+        const QNetworkDatagram datagram = upstream->receiveDatagram();
+        if (!datagram.isValid()) {
+            continue;
+        }
+        const QByteArray data = datagram.data();
+        const NetworkImpairment::Delivery delivery = m_downlink.submit(nowUs(), static_cast<int>(data.size()));
+        for (int copy = 0; copy < delivery.copies; ++copy) {
+            schedule(delivery.atUs[copy], Action::Datagram, Direction::Downlink, peerId, data);
+        }
+    }
+}
@@ -0,0 +1,143 @@
+#ifndef IMPAIRMENTPROXY_H
+#define IMPAIRMENTPROXY_H
+
+#include "NetworkImpairment.h"
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QObject>
+#include <QString>
+
+#include <map>
+#include <queue>
+#include <vector>
+
+class QTcpServer;
+class QTcpSocket;
+class QTimer;
+class QUdpSocket;
+
+// A reflector-shaped relay that degrades the link in between, so a client
+// can be run against the stand-in, or a real reflector, over a
+// reproducible bad network.
+//
+// Point the client at port() instead of the reflector.  Each TCP
+// connection is relayed over its own upstream connection and each client
+// UDP endpoint over its own upstream socket, so the reflector sees an
+// ordinary client at the proxy's address.  Datagrams go through the
+// uplink or downlink NetworkImpairment; TCP goes through a stream model of
+// the same link, in order and lossless but stalled by retransmissions.
+// All four models are seeded from setSeed(), so a seed replays the same
+// impairment as long as the traffic is the same.
+//
+// Like ReflectorStandIn, it lives in the thread it was created in.
+class ImpairmentProxy : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Stats {
+        NetworkImpairment::Stats uplink;
+        NetworkImpairment::Stats downlink;
+        NetworkImpairment::Stats tcpUplink;
+        NetworkImpairment::Stats tcpDownlink;
+    };
+
+    explicit ImpairmentProxy(QObject *parent = nullptr);
+    ~ImpairmentProxy() override;
+
+    // Call from the proxy's thread.
+    quint16 port() const { return m_port; }
+    QString errorString() const { return m_errorString; }
+    Stats stats() const;
+
+    // Take effect on the next listen().
+    void setUpstream(const QHostAddress &address, quint16 port);
+    void setUplink(const NetworkImpairment::Config &config) { m_uplinkConfig = config; }
+    void setDownlink(const NetworkImpairment::Config &config) { m_downlinkConfig = config; }
+    void setSeed(quint64 seed) { m_seed = seed; }
+
+public slots:
+    // Port 0 picks one that is free for both TCP and UDP.
+    bool listen(const QHostAddress &address = QHostAddress(QHostAddress::LocalHost), quint16 port = 0);
+    void close();
+
+private slots:
+    void onNewConnection();
+    void onClientDatagrams();
+    void onDeliveryTimer();
+
+private:
+    enum class Direction { Uplink, Downlink };
+
+    struct Connection {
+        QTcpSocket *client = nullptr;
+        QTcpSocket *upstream = nullptr;
+        // Client bytes held until the upstream connection is up.
+        QByteArray pendingUplink;
+    };
+
+    struct UdpPeer {
+        QHostAddress address;
+        quint16 port = 0;
+        QUdpSocket *upstream = nullptr;
+    };
+
+    enum class Action { Datagram, Stream, Close };
+
+    struct Pending {
+        qint64 atUs = 0;
+        quint64 order = 0;
+        Action action = Action::Datagram;
+        Direction direction = Direction::Uplink;
+        quint32 id = 0;
+        QByteArray data;
+    };
+
+    struct Later {
+        bool operator()(const Pending &a, const Pending &b) const
+        {
+            return a.atUs != b.atUs ? a.atUs > b.atUs : a.order > b.order;
+        }
+    };
+
+    qint64 nowUs() const { return m_clock.nsecsElapsed() / 1000; }
+    void schedule(qint64 atUs, Action action, Direction direction, quint32 id, const QByteArray &data);
+    void deliver(const Pending &pending);
+    void armDeliveryTimer();
+
+    void onTcpReadyRead(quint32 id, Direction direction);
+    void onTcpDisconnected(quint32 id, Direction direction);
+    void onUpstreamConnected(quint32 id);
+    void closeConnection(quint32 id);
+    void onUpstreamDatagrams(quint32 peerId);
+    // The peer for a client UDP endpoint, created on its first datagram.
+    quint32 peerFor(const QHostAddress &address, quint16 port);
+
+    QTcpServer *m_tcpServer = nullptr;
+    QUdpSocket *m_udpSocket = nullptr;
+    QTimer *m_deliveryTimer = nullptr;
+    QElapsedTimer m_clock;
+    quint16 m_port = 0;
+    QString m_errorString;
+
+    QHostAddress m_upstreamAddress;
+    quint16 m_upstreamPort = 0;
+    NetworkImpairment::Config m_uplinkConfig;
+    NetworkImpairment::Config m_downlinkConfig;
+    quint64 m_seed = 1;
+    NetworkImpairment m_uplink;
+    NetworkImpairment m_downlink;
+    NetworkImpairment m_tcpUplink;
+    NetworkImpairment m_tcpDownlink;
+
+    std::map<quint32, Connection> m_connections;
+    quint32 m_nextConnectionId = 1;
+    std::map<quint32, UdpPeer> m_peers;
+    quint32 m_nextPeerId = 1;
+    std::priority_queue<Pending, std::vector<Pending>, Later> m_pending;
+    quint64 m_nextOrder = 0;
+};
+
+#endif // IMPAIRMENTPROXY_H
@@ -0,0 +1,335 @@
+#include "NetworkImpairment.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kParetoShape = 3.0;
+// Linux's floor for the TCP retransmission timeout.
+constexpr int64_t kMinRetransmitUs = 200000;
+
+uint64_t splitMix64(uint64_t &state)
+{
+    uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+std::string trimmed(const std::string &text)
+{
+    const size_t first = text.find_first_not_of(" \t");
+    if (first == std::string::npos) {
+        return {};
+    }
+    const size_t last = text.find_last_not_of(" \t");
+    return text.substr(first, last - first + 1);
+}
+
+bool parseProbability(const std::string &value, double &out)
+{
+    char *end = nullptr;
+    errno = 0;
+    const double parsed = std::strtod(value.c_str(), &end);
+    if (errno != 0 || end == value.c_str() || *end != '\0' || !(parsed >= 0.0 && parsed <= 1.0)) {
+        return false;
+    }
+    out = parsed;
+    return true;
+}
+
+bool parseMilliseconds(const std::string &value, int &out)
+{
+    char *end = nullptr;
+    errno = 0;
+    const long parsed = std::strtol(value.c_str(), &end, 10);
+    if (errno != 0 || end == value.c_str() || *end != '\0' || parsed < 0 || parsed > 600000) {
+        return false;
+    }
+    out = static_cast<int>(parsed);
+    return true;
+}
+
+bool profileConfig(const std::string &name, NetworkImpairment::Config &config)
+{
+    NetworkImpairment::Config profile;
+    if (name == "clean") {
+        // Defaults: a perfect link.
+    } else if (name == "lte") {
+        profile.delayMs = 40;
+        profile.jitterMs = 15;
+        profile.loss = 0.002;
+        profile.burstEnter = 0.005;
+        profile.burstExit = 0.4;
+        profile.burstLoss = 0.5;
+    } else if (name == "lte-congested") {
+        profile.delayMs = 80;
+        profile.jitterMs = 60;
+        profile.distribution = NetworkImpairment::DelayDistribution::Pareto;
+        profile.loss = 0.01;
+        profile.burstEnter = 0.02;
+        profile.burstExit = 0.25;
+        profile.burstLoss = 0.7;
+        profile.reorder = 0.005;
+        profile.duplicate = 0.002;
+        profile.rateKbps = 256;
+        profile.queueLimitMs = 600;
+    } else if (name == "wifi") {
+        profile.delayMs = 5;
+        profile.jitterMs = 10;
+        profile.distribution = NetworkImpairment::DelayDistribution::Uniform;
+        profile.loss = 0.005;
+        profile.burstEnter = 0.01;
+        profile.burstExit = 0.5;
+        profile.burstLoss = 0.8;
+        profile.reorder = 0.01;
+        profile.duplicate = 0.005;
+    } else {
+        return false;
+    }
+    config = profile;
+    return true;
+}
+}
+
+NetworkImpairment::NetworkImpairment(const Config &config, uint64_t seed)
+    : m_config(config)
+{
+    reset(seed);
+}
+
+void NetworkImpairment::reset(uint64_t seed)
+{
+    m_state = seed;
+    m_stats = Stats();
+    m_bad = false;
+    m_hasSpareNormal = false;
+    m_spareNormal = 0.0;
+    m_linkFreeUs = 0;
+    m_lastInOrderUs = 0;
+    m_lastStreamUs = 0;
+}
+
+double NetworkImpairment::nextUniform()
+{
+    // 53 random bits: uniform on [0, 1).
+    return static_cast<double>(splitMix64(m_state) >> 11) * 0x1.0p-53;
+}
+
+double NetworkImpairment::nextNormal()
+{
+    if (m_hasSpareNormal) {
+        m_hasSpareNormal = false;
+        return m_spareNormal;
+    }
+
+    // Box-Muller; 1 - u keeps the logarithm finite.
+    const double radius = std::sqrt(-2.0 * std::log(1.0 - nextUniform()));
+    const double angle = 2.0 * kPi * nextUniform();
+    m_spareNormal = radius * std::sin(angle);
+    m_hasSpareNormal = true;
+    return radius * std::cos(angle);
+}
+
+int64_t NetworkImpairment::sampleDelayUs()
+{
+    const double delayUs = m_config.delayMs * 1000.0;
+    const double jitterUs = m_config.jitterMs * 1000.0;
+    double sampled = delayUs;
+    switch (m_config.distribution) {
+    case DelayDistribution::Constant:
+        break;
+    case DelayDistribution::Uniform:
+        sampled += jitterUs * (2.0 * nextUniform() - 1.0);
+        break;
+    case DelayDistribution::Normal:
+        sampled += jitterUs * nextNormal();
+        break;
+    case DelayDistribution::Pareto:
+        // Lomax with scale (shape - 1) * jitter, so the mean excess is jitter.
+        sampled += jitterUs * (kParetoShape - 1.0)
+                   * (std::pow(1.0 - nextUniform(), -1.0 / kParetoShape) - 1.0);
+        break;
+    }
+    return static_cast<int64_t>(std::max(0.0, sampled));
+}
+
+bool NetworkImpairment::nextLost()
+{
+    // Transition first, then lose with the new state's rate.
+    if (m_bad) {
+        if (m_config.burstExit > 0.0 && nextUniform() < m_config.burstExit) {
+            m_bad = false;
+        }
+    } else if (m_config.burstEnter > 0.0 && nextUniform() < m_config.burstEnter) {
+        m_bad = true;
+    }
+
+    const double loss = m_bad ? m_config.burstLoss : m_config.loss;
+    return loss > 0.0 && nextUniform() < loss;
+}
+
+double NetworkImpairment::expectedLoss() const
+{
+    const double transitions = m_config.burstEnter + m_config.burstExit;
+    if (transitions <= 0.0) {
+        return m_config.loss;
+    }
+    const double badShare = m_config.burstEnter / transitions;
+    return (1.0 - badShare) * m_config.loss + badShare * m_config.burstLoss;
+}
+
+int64_t NetworkImpairment::serializationUs(int bytes) const
+{
+    if (m_config.rateKbps <= 0) {
+        return 0;
+    }
+    return static_cast<int64_t>(bytes) * 8 * 1000 / m_config.rateKbps;
+}
+
+NetworkImpairment::Delivery NetworkImpairment::submit(int64_t sendUs, int bytes)
+{
+    Delivery delivery;
+    ++m_stats.packets;
+
+    int64_t departUs = sendUs;
+    if (m_config.rateKbps > 0) {
+        const int64_t startUs = std::max(m_linkFreeUs, sendUs);
+        if (m_config.queueLimitMs > 0 && startUs - sendUs > m_config.queueLimitMs * int64_t(1000)) {
+            ++m_stats.overflowed;
+            return delivery;
+        }
+        m_linkFreeUs = startUs + serializationUs(bytes);
+        departUs = m_linkFreeUs;
+    }
+
+    if (nextLost()) {
+        ++m_stats.lost;
+        return delivery;
+    }
+
+    if (m_config.reorder > 0.0 && nextUniform() < m_config.reorder) {
+        // Skips the delay, overtaking whatever is still in flight.
+        ++m_stats.reordered;
+        delivery.atUs[0] = departUs;
+    } else {
+        delivery.atUs[0] = std::max(departUs + sampleDelayUs(), m_lastInOrderUs);
+        m_lastInOrderUs = delivery.atUs[0];
+    }
+    delivery.copies = 1;
+
+    if (m_config.duplicate > 0.0 && nextUniform() < m_config.duplicate) {
+        ++m_stats.duplicated;
+        delivery.atUs[1] = departUs + sampleDelayUs();
+        delivery.copies = 2;
+    }
+    return delivery;
+}
+
+int64_t NetworkImpairment::submitStream(int64_t sendUs, int bytes)
+{
+    ++m_stats.packets;
+
+    int64_t departUs = sendUs;
+    if (m_config.rateKbps > 0) {
+        // TCP backs off instead of overflowing the queue.
+        m_linkFreeUs = std::max(m_linkFreeUs, sendUs) + serializationUs(bytes);
+        departUs = m_linkFreeUs;
+    }
+
+    int64_t atUs = departUs + sampleDelayUs();
+    if (nextLost()) {
+        ++m_stats.retransmitted;
+        const int64_t rtoUs = 2 * m_config.delayMs * int64_t(1000) + 4 * m_config.jitterMs * int64_t(1000);
+        atUs += std::max(kMinRetransmitUs, rtoUs);
+    }
+
+    // Head-of-line blocking: nothing overtakes a segment being retransmitted.
+    atUs = std::max(atUs, m_lastStreamUs);
+    m_lastStreamUs = atUs;
+    return atUs;
+}
+
+bool NetworkImpairment::parse(const std::string &spec, Config &config, std::string *error)
+{
+    auto fail = [error](const std::string &message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+
+    Config parsed = config;
+    size_t position = 0;
+    bool first = true;
+    while (position <= spec.size()) {
+        const size_t comma = std::min(spec.find(',', position), spec.size());
+        const std::string item = trimmed(spec.substr(position, comma - position));
+        position = comma + 1;
+        if (item.empty()) {
+            first = false;
+            continue;
+        }
+
+        const size_t equals = item.find('=');
+        if (equals == std::string::npos) {
+            if (!first) {
+                return fail("profile '" + item + "' must come first");
+            }
+            if (!profileConfig(item, parsed)) {
+                return fail("unknown profile '" + item + "'");
+            }
+            first = false;
+            continue;
+        }
+        first = false;
+
+        const std::string key = trimmed(item.substr(0, equals));
+        const std::string value = trimmed(item.substr(equals + 1));
+        bool ok = true;
+        if (key == "delay") {
+            ok = parseMilliseconds(value, parsed.delayMs);
+        } else if (key == "jitter") {
+            ok = parseMilliseconds(value, parsed.jitterMs);
+        } else if (key == "rate") {
+            ok = parseMilliseconds(value, parsed.rateKbps);
+        } else if (key == "queue") {
+            ok = parseMilliseconds(value, parsed.queueLimitMs);
+        } else if (key == "loss") {
+            ok = parseProbability(value, parsed.loss);
+        } else if (key == "burst-loss") {
+            ok = parseProbability(value, parsed.burstLoss);
+        } else if (key == "burst-enter") {
+            ok = parseProbability(value, parsed.burstEnter);
+        } else if (key == "burst-exit") {
+            ok = parseProbability(value, parsed.burstExit);
+        } else if (key == "reorder") {
+            ok = parseProbability(value, parsed.reorder);
+        } else if (key == "dup") {
+            ok = parseProbability(value, parsed.duplicate);
+        } else if (key == "dist") {
+            if (value == "constant") {
+                parsed.distribution = DelayDistribution::Constant;
+            } else if (value == "uniform") {
+                parsed.distribution = DelayDistribution::Uniform;
+            } else if (value == "normal") {
+                parsed.distribution = DelayDistribution::Normal;
+            } else if (value == "pareto") {
+                parsed.distribution = DelayDistribution::Pareto;
+            } else {
+                ok = false;
+            }
+        } else {
+            return fail("unknown key '" + key + "'");
+        }
+        if (!ok) {
+            return fail("bad value for " + key + ": '" + value + "'");
+        }
+    }
+
+    config = parsed;
+    return true;
+}
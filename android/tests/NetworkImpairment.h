@@ -0,0 +1,106 @@
+#ifndef NETWORKIMPAIRMENT_H
+#define NETWORKIMPAIRMENT_H
+
+#include <cstdint>
+#include <string>
+
+// Seeded model of one direction of a bad link, for reproducing the jitter
+// and loss users see on congested mobile networks.
+//
+// Each packet handed to submit() is, in this order:
+//  - queued behind earlier ones at the bandwidth cap, and tail-dropped when
+//    that queue holds more than queueLimitMs of traffic;
+//  - lost according to a Gilbert-Elliott chain: a good and a bad state with
+//    their own loss rates, entered and left with burstEnter / burstExit per
+//    packet, so losses come in bursts the way fading and handovers cause;
+//  - delayed by delayMs plus jitter drawn from the chosen distribution.
+//    Packets stay in order, as they do through a radio bearer, unless
+//    reorder picks one to skip the delay and overtake those in flight;
+//  - duplicated with an independently drawn delay.
+//
+// submitStream() is the TCP side: nothing is lost or reordered, but a
+// segment the loss chain picks waits a retransmission timeout, and every
+// later one waits behind it.
+//
+// The random sequence depends only on the seed and the packets submitted,
+// and is drawn without the implementation-defined std:: distributions, so
+// a seed reproduces the same run on any platform.
+class NetworkImpairment
+{
+public:
+    enum class DelayDistribution {
+        Constant,
+        Uniform,
+        Normal,
+        // Heavy tail; jitterMs is the mean extra delay.
+        Pareto
+    };
+
+    struct Config {
+        int delayMs = 0;
+        int jitterMs = 0;
+        DelayDistribution distribution = DelayDistribution::Normal;
+        double loss = 0.0;          // in the good state
+        double burstLoss = 1.0;     // in the bad state
+        double burstEnter = 0.0;    // good -> bad, per packet
+        double burstExit = 1.0;     // bad -> good, per packet
+        double reorder = 0.0;
+        double duplicate = 0.0;
+        int rateKbps = 0;           // 0 is unlimited
+        int queueLimitMs = 0;       // 0 never drops at the cap
+    };
+
+    struct Delivery {
+        int copies = 0;
+        int64_t atUs[2] = {0, 0};
+    };
+
+    struct Stats {
+        int64_t packets = 0;
+        int64_t lost = 0;
+        int64_t overflowed = 0;
+        int64_t reordered = 0;
+        int64_t duplicated = 0;
+        int64_t retransmitted = 0;
+    };
+
+    explicit NetworkImpairment(const Config &config, uint64_t seed = 1);
+
+    // Restarts the random sequence, the loss chain and the queue.
+    void reset(uint64_t seed);
+    void setConfig(const Config &config) { m_config = config; }
+    const Config &config() const { return m_config; }
+    const Stats &stats() const { return m_stats; }
+
+    Delivery submit(int64_t sendUs, int bytes);
+    int64_t submitStream(int64_t sendUs, int bytes);
+
+    // Long-run loss rate of the Gilbert-Elliott chain.
+    double expectedLoss() const;
+
+    // A comma-separated list of key=value pairs, optionally starting with
+    // the name of a profile to override:
+    //   lte,delay=80,jitter=40,dist=pareto,loss=0.01,burst-enter=0.02,
+    //   burst-exit=0.3,burst-loss=0.7,reorder=0.01,dup=0.005,rate=128,queue=400
+    // Profiles: clean, lte, lte-congested, wifi.
+    static bool parse(const std::string &spec, Config &config, std::string *error = nullptr);
+
+private:
+    double nextUniform();
+    double nextNormal();
+    int64_t sampleDelayUs();
+    bool nextLost();
+    int64_t serializationUs(int bytes) const;
+
+    Config m_config;
+    Stats m_stats;
+    uint64_t m_state = 0;
+    bool m_bad = false;
+    bool m_hasSpareNormal = false;
+    double m_spareNormal = 0.0;
+    int64_t m_linkFreeUs = 0;
+    int64_t m_lastInOrderUs = 0;
+    int64_t m_lastStreamUs = 0;
+};
+
+#endif // NETWORKIMPAIRMENT_H
@@ -0,0 +1,45 @@
+#ifndef REFERENCEAUDIOLIMITER_H
+#define REFERENCEAUDIOLIMITER_H
+
+// The original double-precision AudioLimiter, one log() and one exp() per
+// sample.  Kept as the reference the float/SIMD limiter is held to.
+
+#include <cmath>
+
+class ReferenceAudioLimiter {
+public:
+    void processAudio(float* samples, int count) {
+        for (int i = 0; i < count; ++i) {
+            double rectified = std::fabs(samples[i]) + DC_OFFSET;
+            double overDb = std::log(rectified) * LOG_2_DB - thresholdDb_;
+            if (overDb < 0.0) {
+                overDb = 0.0;
+            }
+            overDb += DC_OFFSET;
+
+            if (overDb > envDb_) {
+                envDb_ = overDb + ATTACK_COEF * (envDb_ - overDb);
+            } else {
+                envDb_ = overDb + RELEASE_COEF * (envDb_ - overDb);
+            }
+
+            overDb = envDb_ - DC_OFFSET;
+            double gainReduction = std::exp(overDb * (ratio_ - 1.0) * DB_2_LOG);
+            samples[i] = outputGain_ * samples[i] * gainReduction;
+        }
+    }
+
+private:
+    double thresholdDb_ = -6.0;
+    double ratio_ = 0.1;
+    double outputGain_ = 1.0;
+    double envDb_ = DC_OFFSET;
+
+    static constexpr double ATTACK_COEF = 0.99;
+    static constexpr double RELEASE_COEF = 0.9995;
+    static constexpr double DC_OFFSET = 1.0E-25;
+    static constexpr double LOG_2_DB = 8.6858896380650365530225783783321;
+    static constexpr double DB_2_LOG = 0.11512925464970228420089957273422;
+};
+
+#endif // REFERENCEAUDIOLIMITER_H
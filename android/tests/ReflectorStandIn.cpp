@@ -0,0 +1,827 @@
+#include "ReflectorStandIn.h"
+
+#include "OpusWrapper.h"
+#include "ReflectorCodec.h"
+#include "ReflectorProtocol.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QMessageAuthenticationCode>
+#include <QNetworkDatagram>
+#include <QRandomGenerator>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUdpSocket>
+#include <QtEndian>
+#include <QtMath>
+
+#include <cmath>
+#include <vector>
+
+namespace Codec = Svxlink::Codec;
+namespace MsgType = Svxlink::MsgType;
+namespace UdpMsgType = Svxlink::UdpMsgType;
+
+namespace {
+// The rate the client's Opus encoder runs at.
+constexpr int kSvxlinkSampleRate = 16000;
+constexpr int kMaxOpusPacketBytes = 4000;
+constexpr int kTalkerTimeoutTickMs = 100;
+constexpr int kListenAttempts = 16;
+
+QString toQString(const PayloadReader &bytes)
+{
+    return QString::fromUtf8(bytes.data(), bytes.size());
+}
+}
+
+// --- Encoding ---
+
+template <typename Message, typename... Values>
+void ReflectorStandIn::send(Client &client, const Values &...values)
+{
+    const int frameBytes = Message::frameSize(values...);
+    if (frameBytes < 0 || client.socket->state() != QAbstractSocket::ConnectedState) {
+        return;
+    }
+    QByteArray frame(frameBytes, Qt::Uninitialized);
+    Message::encodeFrame(frame.data(), frameBytes, values...);
+    client.socket->write(frame);
+}
+
+template <typename Message, typename... Values>
+void ReflectorStandIn::sendDatagram(Client &client, const Values &...values)
+{
+    const int datagramBytes = Message::size(values...);
+    if (datagramBytes < 0 || client.udpPort == 0) {
+        return;
+    }
+    QByteArray datagram(datagramBytes, Qt::Uninitialized);
+    Message::encode(datagram.data(), datagramBytes, client.clientId, client.udpSequence++, values...);
+    m_udpSocket->writeDatagram(datagram, client.udpAddress, client.udpPort);
+}
+
+ReflectorStandIn::ReflectorStandIn(QObject *parent)
+    : QObject(parent)
+    , m_tcpServer(new QTcpServer(this))
+    , m_udpSocket(new QUdpSocket(this))
+    , m_heartbeatTimer(new QTimer(this))
+    , m_talkerTimeoutTimer(new QTimer(this))
+{
+    m_clock.start();
+
+    connect(m_tcpServer, &QTcpServer::newConnection, this, &ReflectorStandIn::onNewConnection);
+    connect(m_udpSocket, &QUdpSocket::readyRead, this, &ReflectorStandIn::onUdpReadyRead);
+
+    m_heartbeatTimer->setInterval(DEFAULT_HEARTBEAT_INTERVAL_MS);
+    connect(m_heartbeatTimer, &QTimer::timeout, this, &ReflectorStandIn::onHeartbeatTimer);
+
+    m_talkerTimeoutTimer->setInterval(kTalkerTimeoutTickMs);
+    connect(m_talkerTimeoutTimer, &QTimer::timeout, this, &ReflectorStandIn::onTalkerTimeoutTimer);
+}
+
+ReflectorStandIn::~ReflectorStandIn()
+{
+    close();
+}
+
+// --- Setup ---
+
+bool ReflectorStandIn::listen(const QHostAddress &address, quint16 port)
+{
+    close();
+
+    // The TCP port is picked first; another process can hold the same UDP
+    // port, so an ephemeral pick is retried.
+    const int attempts = port == 0 ? kListenAttempts : 1;
+    for (int attempt = 0; attempt < attempts; ++attempt) {
+        if (!m_tcpServer->listen(address, port)) {
+            m_errorString = m_tcpServer->errorString();
+            return false;
+        }
+        if (m_udpSocket->bind(address, m_tcpServer->serverPort())) {
+            m_port = m_tcpServer->serverPort();
+            m_errorString.clear();
+            m_heartbeatTimer->start();
+            m_talkerTimeoutTimer->start();
+            return true;
+        }
+        m_errorString = m_udpSocket->errorString();
+        m_tcpServer->close();
+    }
+    return false;
+}
+
+void ReflectorStandIn::close()
+{
+    m_heartbeatTimer->stop();
+    m_talkerTimeoutTimer->stop();
+    for (auto &entry : m_scriptedTalkers) {
+        entry.second->timer->stop();
+        entry.second->timer->deleteLater();
+    }
+    m_scriptedTalkers.clear();
+    m_talkers.clear();
+
+    std::map<quint16, std::unique_ptr<Client>> clients;
+    clients.swap(m_clients);
+    for (auto &entry : clients) {
+        QTcpSocket *socket = entry.second->socket;
+        socket->disconnect(this);
+        socket->abort();
+        socket->deleteLater();
+    }
+
+    m_tcpServer->close();
+    m_udpSocket->close();
+    m_port = 0;
+}
+
+void ReflectorStandIn::addUser(const QString &callsign, const QByteArray &authKey)
+{
+    m_users.insert(callsign, authKey);
+}
+
+void ReflectorStandIn::setHeartbeatIntervalMs(int milliseconds)
+{
+    if (milliseconds <= 0) {
+        m_heartbeatTimer->stop();
+        return;
+    }
+    m_heartbeatTimer->setInterval(milliseconds);
+    if (m_port != 0) {
+        m_heartbeatTimer->start();
+    }
+}
+
+void ReflectorStandIn::setTalkerTimeoutMs(int milliseconds)
+{
+    m_talkerTimeoutMs = qMax(kTalkerTimeoutTickMs, milliseconds);
+}
+
+// --- Queries ---
+
+QStringList ReflectorStandIn::connectedCallsigns() const
+{
+    QStringList callsigns;
+    for (const auto &entry : m_clients) {
+        if (entry.second->authenticated) {
+            callsigns.append(entry.second->callsign);
+        }
+    }
+    return callsigns;
+}
+
+quint32 ReflectorStandIn::selectedTalkgroup(const QString &callsign) const
+{
+    const Client *client = findClient(callsign);
+    return client ? client->talkgroup : 0;
+}
+
+QList<quint32> ReflectorStandIn::monitoredTalkgroups(const QString &callsign) const
+{
+    const Client *client = findClient(callsign);
+    return client ? client->monitored : QList<quint32>();
+}
+
+QByteArray ReflectorStandIn::nodeInfo(const QString &callsign) const
+{
+    const Client *client = findClient(callsign);
+    return client ? client->nodeInfo : QByteArray();
+}
+
+QString ReflectorStandIn::talker(quint32 talkgroup) const
+{
+    const auto it = m_talkers.constFind(talkgroup);
+    return it != m_talkers.constEnd() ? it->callsign : QString();
+}
+
+ReflectorStandIn::Client *ReflectorStandIn::findClient(const QString &callsign) const
+{
+    for (const auto &entry : m_clients) {
+        if (entry.second->authenticated && entry.second->callsign == callsign) {
+            return entry.second.get();
+        }
+    }
+    return nullptr;
+}
+
+// --- TCP ---
+
+void ReflectorStandIn::onNewConnection()
+{
+    while (QTcpSocket *socket = m_tcpServer->nextPendingConnection()) {
+        while (m_nextClientId == 0 || m_clients.count(m_nextClientId) > 0) {
+            ++m_nextClientId;
+        }
+        const quint16 clientId = m_nextClientId++;
+
+        auto client = std::make_unique<Client>();
+        client->clientId = clientId;
+        client->socket = socket;
+        m_clients.emplace(clientId, std::move(client));
+
+        connect(socket, &QTcpSocket::readyRead, this, [this, clientId]() { onTcpReadyRead(clientId); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, clientId]() { onTcpDisconnected(clientId); });
+    }
+}
+
+void ReflectorStandIn::onTcpReadyRead(quint16 clientId)
+{
+    const auto it = m_clients.find(clientId);
+    if (it == m_clients.end()) {
+        return;
+    }
+    Client &client = *it->second;
+
+    while (client.socket->bytesAvailable() > 0) {
+        const qint64 available = client.socket->bytesAvailable();
+        const qint64 bytesRead = client.socket->read(client.frames.prepareWrite(int(available)), available);
+        if (bytesRead <= 0) {
+            break;
+        }
+        client.frames.commitWrite(int(bytesRead));
+
+        PayloadReader payload;
+        TcpFrameReader::Result result;
+        while ((result = client.frames.next(payload)) == TcpFrameReader::Result::Frame) {
+            handleFrame(client, payload);
+            if (m_clients.count(clientId) == 0) {
+                return;
+            }
+        }
+        if (result == TcpFrameReader::Result::Oversized) {
+            reject(client, QStringLiteral("Protocol error"));
+            return;
+        }
+    }
+}
+
+void ReflectorStandIn::onTcpDisconnected(quint16 clientId)
+{
+    const auto it = m_clients.find(clientId);
+    if (it == m_clients.end()) {
+        return;
+    }
+    std::unique_ptr<Client> client = std::move(it->second);
+    m_clients.erase(it);
+    client->socket->deleteLater();
+
+    if (!client->authenticated) {
+        return;
+    }
+    QList<quint32> talkgroups;
+    for (auto talker = m_talkers.constBegin(); talker != m_talkers.constEnd(); ++talker) {
+        if (talker->clientId == clientId) {
+            talkgroups.append(talker.key());
+        }
+    }
+    for (quint32 talkgroup : talkgroups) {
+        stopTalker(talkgroup);
+    }
+    const QByteArray callsign = client->callsign.toUtf8();
+    for (auto &entry : m_clients) {
+        if (entry.second->authenticated) {
+            send<Codec::NodeLeft>(*entry.second, Codec::bytesOf(callsign));
+        }
+    }
+    emit clientDisconnected(client->callsign);
+}
+
+void ReflectorStandIn::handleFrame(Client &client, PayloadReader payload)
+{
+    const quint16 messageType = payload.readU16();
+    if (!payload.ok()) {
+        return;
+    }
+
+    if (!client.authenticated) {
+        switch (messageType) {
+        case MsgType::PROTO_VER: {
+            quint16 major = 0;
+            quint16 minor = 0;
+            if (!Codec::ProtoVer::decodeFields(payload, major, minor)) {
+                reject(client, QStringLiteral("Protocol error"));
+                return;
+            }
+            if (major > Svxlink::Protocol::MAJOR_VER) {
+                send<Codec::ProtoVerDowngrade>(client, Svxlink::Protocol::MAJOR_VER,
+                                               Svxlink::Protocol::MINOR_VER);
+                return;
+            }
+            if (major < Svxlink::Protocol::MAJOR_VER) {
+                reject(client, QStringLiteral("Unsupported protocol version"));
+                return;
+            }
+            client.challenge.resize(Svxlink::Protocol::CHALLENGE_LEN);
+            QRandomGenerator::global()->fillRange(reinterpret_cast<quint32 *>(client.challenge.data()),
+                                                  Svxlink::Protocol::CHALLENGE_LEN / int(sizeof(quint32)));
+            send<Codec::AuthChallenge>(client, Codec::bytesOf(client.challenge));
+            return;
+        }
+        case MsgType::AUTH_RESPONSE:
+            handleAuthResponse(client, payload);
+            return;
+        case MsgType::HEARTBEAT:
+            return;
+        default:
+            reject(client, QStringLiteral("Protocol error"));
+            return;
+        }
+    }
+
+    switch (messageType) {
+    case MsgType::HEARTBEAT:
+        break;
+    case MsgType::SELECT_TG: {
+        quint32 talkgroup = 0;
+        if (Codec::SelectTg::decodeFields(payload, talkgroup)) {
+            handleSelectTalkgroup(client, talkgroup);
+        }
+        break;
+    }
+    case MsgType::TG_MONITOR: {
+        Codec::TalkgroupList::View talkgroups;
+        if (!Codec::TgMonitor::decodeFields(payload, talkgroups)) {
+            break;
+        }
+        client.monitored.clear();
+        quint32 talkgroup = 0;
+        while (talkgroups.next(talkgroup)) {
+            client.monitored.append(talkgroup);
+        }
+        break;
+    }
+    case MsgType::NODE_INFO: {
+        PayloadReader json;
+        if (Codec::NodeInfo::decodeFields(payload, json)) {
+            client.nodeInfo = QByteArray(json.data(), json.size());
+        }
+        break;
+    }
+    default:
+        // REQUEST_QSY, STATE_EVENT and the rest go to other nodes on a
+        // real reflector; nothing here listens for them.
+        break;
+    }
+}
+
+void ReflectorStandIn::handleAuthResponse(Client &client, PayloadReader &payload)
+{
+    PayloadReader callsignBytes;
+    PayloadReader digest;
+    if (client.challenge.isEmpty() || !Codec::AuthResponse::decodeFields(payload, callsignBytes, digest)) {
+        reject(client, QStringLiteral("Protocol error"));
+        return;
+    }
+
+    const QString callsign = toQString(callsignBytes);
+    const auto user = m_users.constFind(callsign);
+    const QByteArray expected = user == m_users.constEnd()
+            ? QByteArray()
+            : QMessageAuthenticationCode::hash(client.challenge, *user, QCryptographicHash::Sha1);
+    client.challenge.clear();
+    if (expected.isEmpty() || expected != QByteArray(digest.data(), digest.size())) {
+        client.callsign = callsign;
+        reject(client, QStringLiteral("Access denied"));
+        return;
+    }
+    if (findClient(callsign) != nullptr) {
+        client.callsign = callsign;
+        reject(client, QStringLiteral("Already connected"));
+        return;
+    }
+
+    client.callsign = callsign;
+    client.authenticated = true;
+    send<Codec::AuthOk>(client);
+    send<Codec::ServerInfo>(client, quint16(0), client.clientId);
+
+    std::vector<QByteArray> others;
+    for (const auto &entry : m_clients) {
+        if (entry.second->authenticated && entry.second.get() != &client) {
+            others.push_back(entry.second->callsign.toUtf8());
+        }
+    }
+    std::vector<Codec::Bytes> callsigns;
+    callsigns.reserve(others.size());
+    for (const QByteArray &other : others) {
+        callsigns.push_back(Codec::bytesOf(other));
+    }
+    send<Codec::NodeList>(client, Codec::spanOf(callsigns));
+
+    const QByteArray joined = callsign.toUtf8();
+    for (auto &entry : m_clients) {
+        if (entry.second->authenticated && entry.second.get() != &client) {
+            send<Codec::NodeJoined>(*entry.second, Codec::bytesOf(joined));
+        }
+    }
+    emit clientAuthenticated(callsign, client.clientId);
+}
+
+void ReflectorStandIn::handleSelectTalkgroup(Client &client, quint32 talkgroup)
+{
+    if (client.talkgroup == talkgroup) {
+        return;
+    }
+    const auto talker = m_talkers.constFind(client.talkgroup);
+    if (talker != m_talkers.constEnd() && talker->clientId == client.clientId) {
+        stopTalker(client.talkgroup);
+    }
+    client.talkgroup = talkgroup;
+    emit talkgroupSelected(client.callsign, talkgroup);
+
+    // A late joiner hears who is already talking.
+    const auto current = m_talkers.constFind(talkgroup);
+    if (talkgroup != 0 && current != m_talkers.constEnd()) {
+        const QByteArray callsign = current->callsign.toUtf8();
+        send<Codec::TalkerStart>(client, talkgroup, Codec::bytesOf(callsign));
+    }
+}
+
+void ReflectorStandIn::reject(Client &client, const QString &reason)
+{
+    send<Codec::Error>(client, Codec::bytesOf(reason.toLatin1()));
+    emit clientRejected(client.callsign, reason);
+    client.socket->disconnectFromHost();
+}
+
+void ReflectorStandIn::requestQsy(const QString &callsign, quint32 talkgroup)
+{
+    if (Client *client = findClient(callsign)) {
+        send<Codec::RequestQsy>(*client, talkgroup);
+    }
+}
+
+void ReflectorStandIn::dropClient(const QString &callsign)
+{
+    if (Client *client = findClient(callsign)) {
+        client->socket->abort();
+    }
+}
+
+// --- UDP ---
+
+void ReflectorStandIn::onUdpReadyRead()
+{
+    while (m_udpSocket->hasPendingDatagrams()) {
+        const QNetworkDatagram datagram = m_udpSocket->receiveDatagram();
+        if (datagram.isValid()) {
+            handleDatagram(datagram.data(), datagram.senderAddress(), quint16(datagram.senderPort()));
+        }
+    }
+}
+
+void ReflectorStandIn::handleDatagram(const QByteArray &bytes, const QHostAddress &sender, quint16 senderPort)
+{
+    const PayloadReader datagram(bytes.constData(), int(bytes.size()));
+    PayloadReader header = datagram;
+    const quint16 messageType = header.readU16();
+    const quint16 clientId = header.readU16();
+    const quint16 sequence = header.readU16();
+    if (!header.ok()) {
+        return;
+    }
+
+    const auto it = m_clients.find(clientId);
+    if (it == m_clients.end() || !it->second->authenticated) {
+        return;
+    }
+    Client &client = *it->second;
+    // SvxReflector only takes datagrams from the host the TCP link is from.
+    if (!sender.isEqual(client.socket->peerAddress(), QHostAddress::TolerantConversion)) {
+        return;
+    }
+    const bool registered = client.udpPort != 0;
+    client.udpAddress = sender;
+    client.udpPort = senderPort;
+    if (!registered) {
+        emit udpRegistered(client.callsign);
+    }
+
+    switch (messageType) {
+    case UdpMsgType::UDP_HEARTBEAT:
+        sendDatagram<Codec::UdpHeartbeat>(client);
+        break;
+    case UdpMsgType::UDP_AUDIO: {
+        quint16 ignoredId = 0;
+        quint16 ignoredSequence = 0;
+        PayloadReader opus;
+        if (Codec::UdpAudio::decode(datagram, ignoredId, ignoredSequence, opus)) {
+            handleClientAudio(client, sequence, opus);
+        }
+        break;
+    }
+    case UdpMsgType::UDP_FLUSH_SAMPLES:
+        handleClientFlush(client);
+        break;
+    default:
+        break;
+    }
+}
+
+void ReflectorStandIn::handleClientAudio(Client &client, quint16 sequence, const PayloadReader &opus)
+{
+    const quint32 talkgroup = client.talkgroup;
+    if (talkgroup == 0) {
+        return;
+    }
+    const auto current = m_talkers.constFind(talkgroup);
+    if (current == m_talkers.constEnd()) {
+        startTalker(talkgroup, client.callsign, client.clientId);
+    } else if (current->clientId != client.clientId) {
+        // The channel is taken; SvxReflector drops the second talker.
+        return;
+    }
+    m_talkers[talkgroup].lastAudioMs = m_clock.elapsed();
+
+    emit audioReceived(client.callsign, talkgroup, sequence, opus.size());
+    if (opus.size() > 0) {
+        relayAudio(talkgroup, client.clientId, opus.data(), opus.size());
+    }
+}
+
+void ReflectorStandIn::handleClientFlush(Client &client)
+{
+    const auto current = m_talkers.constFind(client.talkgroup);
+    if (current != m_talkers.constEnd() && current->clientId == client.clientId) {
+        stopTalker(client.talkgroup);
+    }
+    sendDatagram<Codec::UdpAllSamplesFlushed>(client);
+}
+
+// --- Talkers ---
+
+QList<ReflectorStandIn::Client *> ReflectorStandIn::listeners(quint32 talkgroup)
+{
+    QList<Client *> clients;
+    for (auto &entry : m_clients) {
+        Client &client = *entry.second;
+        if (client.authenticated && (client.talkgroup == talkgroup || client.monitored.contains(talkgroup))) {
+            clients.append(&client);
+        }
+    }
+    return clients;
+}
+
+void ReflectorStandIn::startTalker(quint32 talkgroup, const QString &callsign, quint16 clientId)
+{
+    Talker talker;
+    talker.callsign = callsign;
+    talker.clientId = clientId;
+    talker.lastAudioMs = m_clock.elapsed();
+    m_talkers.insert(talkgroup, talker);
+
+    const QByteArray callsignBytes = callsign.toUtf8();
+    for (Client *client : listeners(talkgroup)) {
+        send<Codec::TalkerStart>(*client, talkgroup, Codec::bytesOf(callsignBytes));
+    }
+    emit talkerStarted(talkgroup, callsign);
+}
+
+void ReflectorStandIn::stopTalker(quint32 talkgroup)
+{
+    const auto it = m_talkers.find(talkgroup);
+    if (it == m_talkers.end()) {
+        return;
+    }
+    const Talker talker = *it;
+    m_talkers.erase(it);
+
+    relayFlush(talkgroup, talker.clientId);
+    const QByteArray callsignBytes = talker.callsign.toUtf8();
+    for (Client *client : listeners(talkgroup)) {
+        send<Codec::TalkerStop>(*client, talkgroup, Codec::bytesOf(callsignBytes));
+    }
+    emit talkerStopped(talkgroup, talker.callsign);
+}
+
+void ReflectorStandIn::relayAudio(quint32 talkgroup, quint16 fromClientId, const char *opus, int size)
+{
+    for (auto &entry : m_clients) {
+        Client &client = *entry.second;
+        if (client.authenticated && client.clientId != fromClientId && client.talkgroup == talkgroup) {
+            sendDatagram<Codec::UdpAudio>(client, Codec::Bytes{opus, size});
+        }
+    }
+}
+
+void ReflectorStandIn::relayFlush(quint32 talkgroup, quint16 fromClientId)
+{
+    for (auto &entry : m_clients) {
+        Client &client = *entry.second;
+        if (client.authenticated && client.clientId != fromClientId && client.talkgroup == talkgroup) {
+            sendDatagram<Codec::UdpFlushSamples>(client);
+        }
+    }
+}
+
+void ReflectorStandIn::onTalkerTimeoutTimer()
+{
+    const qint64 nowMs = m_clock.elapsed();
+    QList<quint32> expired;
+    for (auto it = m_talkers.constBegin(); it != m_talkers.constEnd(); ++it) {
+        // Scripted talkers end with their script.
+        if (it->clientId != 0 && nowMs - it->lastAudioMs >= m_talkerTimeoutMs) {
+            expired.append(it.key());
+        }
+    }
+    for (quint32 talkgroup : expired) {
+        stopTalker(talkgroup);
+    }
+}
+
+void ReflectorStandIn::onHeartbeatTimer()
+{
+    for (auto &entry : m_clients) {
+        Client &client = *entry.second;
+        if (!client.authenticated) {
+            continue;
+        }
+        send<Codec::Heartbeat>(client);
+        sendDatagram<Codec::UdpHeartbeat>(client);
+    }
+}
+
+// --- Scripted talkers ---
+
+bool ReflectorStandIn::startScriptedTalker(const QString &callsign, quint32 talkgroup,
+                                           const QList<QByteArray> &opusPackets, int frameMs)
+{
+    if (talkgroup == 0 || m_talkers.contains(talkgroup) || m_scriptedTalkers.count(callsign) > 0) {
+        return false;
+    }
+
+    auto script = std::make_unique<ScriptedTalker>();
+    script->callsign = callsign;
+    script->talkgroup = talkgroup;
+    script->packets = opusPackets;
+    script->frameMs = qMax(1, frameMs);
+    script->timer = new QTimer(this);
+    script->timer->setTimerType(Qt::PreciseTimer);
+    script->timer->setInterval(script->frameMs);
+    connect(script->timer, &QTimer::timeout, this, [this, callsign]() { advanceScriptedTalker(callsign); });
+    ScriptedTalker &started = *script;
+    m_scriptedTalkers.emplace(callsign, std::move(script));
+
+    startTalker(talkgroup, callsign, 0);
+    started.clock.start();
+    started.timer->start();
+    // The first packet goes out with TALKER_START, as a live node's does.
+    advanceScriptedTalker(callsign);
+    return true;
+}
+
+void ReflectorStandIn::stopScriptedTalker(const QString &callsign)
+{
+    if (m_scriptedTalkers.count(callsign) > 0) {
+        finishScriptedTalker(callsign);
+    }
+}
+
+void ReflectorStandIn::advanceScriptedTalker(const QString &callsign)
+{
+    const auto it = m_scriptedTalkers.find(callsign);
+    if (it == m_scriptedTalkers.end()) {
+        return;
+    }
+    ScriptedTalker &script = *it->second;
+
+    // Paced by the clock rather than by tick count, so a late timer
+    // catches up instead of stretching the stream.
+    const qint64 elapsedMs = script.clock.elapsed();
+    while (script.nextPacket < script.packets.size()
+           && qint64(script.nextPacket) * script.frameMs <= elapsedMs) {
+        const QByteArray &packet = script.packets.at(script.nextPacket++);
+        relayAudio(script.talkgroup, 0, packet.constData(), int(packet.size()));
+    }
+    if (m_talkers.contains(script.talkgroup)) {
+        m_talkers[script.talkgroup].lastAudioMs = m_clock.elapsed();
+    }
+
+    if (script.nextPacket >= script.packets.size()) {
+        finishScriptedTalker(callsign);
+    }
+}
+
+void ReflectorStandIn::finishScriptedTalker(const QString &callsign)
+{
+    const auto it = m_scriptedTalkers.find(callsign);
+    std::unique_ptr<ScriptedTalker> script = std::move(it->second);
+    m_scriptedTalkers.erase(it);
+    script->timer->stop();
+    script->timer->deleteLater();
+
+    const auto talker = m_talkers.constFind(script->talkgroup);
+    if (talker != m_talkers.constEnd() && talker->clientId == 0 && talker->callsign == callsign) {
+        stopTalker(script->talkgroup);
+    }
+    emit scriptedTalkerFinished(callsign);
+}
+
+// --- Audio sources ---
+
+QList<QByteArray> ReflectorStandIn::readOggOpusPackets(const QString &path, QString *error)
+{
+    const auto fail = [error](const QString &message) {
+        if (error) {
+            *error = message;
+        }
+        return QList<QByteArray>();
+    };
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return fail(file.errorString());
+    }
+    const QByteArray data = file.readAll();
+
+    // RFC 3533 pages: a 27-byte header, a segment table, then the segments.
+    // A packet is the run of segments up to one shorter than 255 bytes and
+    // may carry on into the next page.  Only the first stream is read.
+    QList<QByteArray> packets;
+    QByteArray packet;
+    quint32 streamSerial = 0;
+    bool haveStream = false;
+    int packetIndex = 0;
+    qsizetype offset = 0;
+    while (offset + 27 <= data.size()) {
+        const char *page = data.constData() + offset;
+        if (qstrncmp(page, "OggS", 4) != 0 || page[4] != 0) {
+            return fail(QStringLiteral("Not an Ogg stream"));
+        }
+        const quint32 serial = qFromLittleEndian<quint32>(page + 14);
+        const int segmentCount = quint8(page[26]);
+        qsizetype body = offset + 27 + segmentCount;
+        if (body > data.size()) {
+            return fail(QStringLiteral("Truncated Ogg page"));
+        }
+        qsizetype bodyBytes = 0;
+        for (int i = 0; i < segmentCount; ++i) {
+            bodyBytes += quint8(page[27 + i]);
+        }
+        if (body + bodyBytes > data.size()) {
+            return fail(QStringLiteral("Truncated Ogg page"));
+        }
+        if (!haveStream) {
+            streamSerial = serial;
+            haveStream = true;
+        }
+
+        if (serial == streamSerial) {
+            for (int i = 0; i < segmentCount; ++i) {
+                const int lacing = quint8(page[27 + i]);
+                packet.append(data.constData() + body, lacing);
+                body += lacing;
+                if (lacing == 255) {
+                    continue;
+                }
+                if (packetIndex == 0 && !packet.startsWith("OpusHead")) {
+                    return fail(QStringLiteral("Not an Ogg Opus stream"));
+                }
+                // OpusHead and OpusTags come first.
+                if (packetIndex >= 2 && !packet.isEmpty()) {
+                    packets.append(packet);
+                }
+                ++packetIndex;
+                packet.clear();
+            }
+        }
+        offset += 27 + segmentCount + bodyBytes;
+    }
+
+    if (packetIndex == 0) {
+        return fail(QStringLiteral("Not an Ogg Opus stream"));
+    }
+    return packets;
+}
+
+QList<QByteArray> ReflectorStandIn::encodeTone(double frequencyHz, int durationMs, int frameMs,
+                                               float amplitude)
+{
+    const int frameSamples = kSvxlinkSampleRate * frameMs / 1000;
+    const int frameCount = frameMs > 0 ? durationMs / frameMs : 0;
+
+    OpusEncoder encoder(kSvxlinkSampleRate, 1, OPUS_APPLICATION_VOIP);
+    encoder.applySvxlinkDefaults();
+
+    QList<QByteArray> packets;
+    packets.reserve(frameCount);
+    std::vector<float> pcm(size_t(qMax(0, frameSamples)));
+    unsigned char encoded[kMaxOpusPacketBytes];
+    const double phaseStep = 2.0 * M_PI * frequencyHz / kSvxlinkSampleRate;
+    double phase = 0.0;
+    for (int frame = 0; frame < frameCount; ++frame) {
+        for (float &sample : pcm) {
+            sample = amplitude * float(qSin(phase));
+            phase = std::fmod(phase + phaseStep, 2.0 * M_PI);
+        }
+        const int bytes = encoder.encode(pcm.data(), frameSamples, encoded, kMaxOpusPacketBytes);
+        if (bytes <= 0) {
+            break;
+        }
+        packets.append(QByteArray(reinterpret_cast<const char *>(encoded), bytes));
+    }
+    return packets;
+}
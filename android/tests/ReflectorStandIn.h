@@ -0,0 +1,180 @@
+#ifndef REFLECTORSTANDIN_H
+#define REFLECTORSTANDIN_H
+
+#include "TcpFrameReader.h"
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QHostAddress>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+#include <map>
+#include <memory>
+
+class QTcpServer;
+class QTcpSocket;
+class QTimer;
+class QUdpSocket;
+
+// A localhost SvxReflector for tests and benchmarks, so the client can be
+// exercised end to end without a network.
+//
+// It speaks the server side of ReflectorProtocol.h: PROTO_VER, the HMAC
+// challenge against the users added with addUser(), AUTH_OK and
+// SERVER_INFO, NODE_LIST/NODE_JOINED/NODE_LEFT, SELECT_TG and TG_MONITOR,
+// and TCP and UDP heartbeats.  UDP audio from a client makes it the talker
+// on its talkgroup (TALKER_START to everyone selecting or monitoring it)
+// and is relayed to the other clients that selected the talkgroup, until
+// UDP_FLUSH_SAMPLES or the talker timeout stops it.
+//
+// A scripted talker streams Opus packets onto a talkgroup at their frame
+// rate, as a remote node would: from an Ogg Opus file (readOggOpusPackets())
+// or a synthesized tone (encodeTone()).
+//
+// TCP and UDP share one port, as on SvxReflector.  The stand-in lives in
+// the thread it was created in; a test that blocks on its own sockets, or
+// a benchmark that should not share an event loop with the client, moves
+// it to a QThread and calls the slots through QMetaObject::invokeMethod.
+class ReflectorStandIn : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DEFAULT_HEARTBEAT_INTERVAL_MS = 10000;
+    static constexpr int DEFAULT_TALKER_TIMEOUT_MS = 3000;
+
+    explicit ReflectorStandIn(QObject *parent = nullptr);
+    ~ReflectorStandIn() override;
+
+    // Call from the stand-in's thread.
+    quint16 port() const { return m_port; }
+    QString errorString() const { return m_errorString; }
+    QStringList connectedCallsigns() const;
+    quint32 selectedTalkgroup(const QString &callsign) const;
+    QList<quint32> monitoredTalkgroups(const QString &callsign) const;
+    QByteArray nodeInfo(const QString &callsign) const;
+    QString talker(quint32 talkgroup) const;
+
+    // Packets from an Ogg Opus file, without the OpusHead and OpusTags
+    // headers; empty, with error set, if the file is not one.
+    static QList<QByteArray> readOggOpusPackets(const QString &path, QString *error = nullptr);
+    // A sine at the SvxLink rate, encoded the way the client encodes.
+    static QList<QByteArray> encodeTone(double frequencyHz, int durationMs, int frameMs = 20,
+                                        float amplitude = 0.5f);
+
+public slots:
+    // Port 0 picks one that is free for both TCP and UDP.
+    bool listen(const QHostAddress &address = QHostAddress(QHostAddress::LocalHost), quint16 port = 0);
+    void close();
+
+    void addUser(const QString &callsign, const QByteArray &authKey);
+    // 0 stops the heartbeats, to let a client's liveness watchdog fire.
+    void setHeartbeatIntervalMs(int milliseconds);
+    void setTalkerTimeoutMs(int milliseconds);
+
+    // False if the talkgroup already has a talker.
+    bool startScriptedTalker(const QString &callsign, quint32 talkgroup,
+                             const QList<QByteArray> &opusPackets, int frameMs = 20);
+    void stopScriptedTalker(const QString &callsign);
+
+    // Drops the TCP connection without a word, as a dead link would.
+    void dropClient(const QString &callsign);
+    void requestQsy(const QString &callsign, quint32 talkgroup);
+
+signals:
+    void clientAuthenticated(const QString &callsign, quint16 clientId);
+    void clientRejected(const QString &callsign, const QString &reason);
+    void clientDisconnected(const QString &callsign);
+    void udpRegistered(const QString &callsign);
+    void talkgroupSelected(const QString &callsign, quint32 talkgroup);
+    void talkerStarted(quint32 talkgroup, const QString &callsign);
+    void talkerStopped(quint32 talkgroup, const QString &callsign);
+    // UDP_AUDIO from a connected client, as it arrives.
+    void audioReceived(const QString &callsign, quint32 talkgroup, quint16 sequence, int bytes);
+    void scriptedTalkerFinished(const QString &callsign);
+
+private slots:
+    void onNewConnection();
+    void onUdpReadyRead();
+    void onHeartbeatTimer();
+    void onTalkerTimeoutTimer();
+
+private:
+    struct Client {
+        quint16 clientId = 0;
+        QTcpSocket *socket = nullptr;
+        TcpFrameReader frames;
+        QByteArray challenge;
+        QString callsign;
+        bool authenticated = false;
+        quint32 talkgroup = 0;
+        QList<quint32> monitored;
+        QByteArray nodeInfo;
+        QHostAddress udpAddress;
+        quint16 udpPort = 0;
+        quint16 udpSequence = 0;
+    };
+
+    struct Talker {
+        QString callsign;
+        // 0 for a scripted talker.
+        quint16 clientId = 0;
+        qint64 lastAudioMs = 0;
+    };
+
+    struct ScriptedTalker {
+        QString callsign;
+        quint32 talkgroup = 0;
+        QList<QByteArray> packets;
+        int frameMs = 20;
+        int nextPacket = 0;
+        QElapsedTimer clock;
+        QTimer *timer = nullptr;
+    };
+
+    void onTcpReadyRead(quint16 clientId);
+    void onTcpDisconnected(quint16 clientId);
+    void handleFrame(Client &client, PayloadReader payload);
+    void handleAuthResponse(Client &client, PayloadReader &payload);
+    void handleSelectTalkgroup(Client &client, quint32 talkgroup);
+    void handleDatagram(const QByteArray &datagram, const QHostAddress &sender, quint16 senderPort);
+    void handleClientAudio(Client &client, quint16 sequence, const PayloadReader &opus);
+    void handleClientFlush(Client &client);
+    void reject(Client &client, const QString &reason);
+
+    void startTalker(quint32 talkgroup, const QString &callsign, quint16 clientId);
+    void stopTalker(quint32 talkgroup);
+    void relayAudio(quint32 talkgroup, quint16 fromClientId, const char *opus, int size);
+    void relayFlush(quint32 talkgroup, quint16 fromClientId);
+    void advanceScriptedTalker(const QString &callsign);
+    void finishScriptedTalker(const QString &callsign);
+
+    template <typename Message, typename... Values>
+    void send(Client &client, const Values &...values);
+    template <typename Message, typename... Values>
+    void sendDatagram(Client &client, const Values &...values);
+    // Clients that selected or monitor the talkgroup.
+    QList<Client *> listeners(quint32 talkgroup);
+    Client *findClient(const QString &callsign) const;
+
+    QTcpServer *m_tcpServer = nullptr;
+    QUdpSocket *m_udpSocket = nullptr;
+    QTimer *m_heartbeatTimer = nullptr;
+    QTimer *m_talkerTimeoutTimer = nullptr;
+    QElapsedTimer m_clock;
+    quint16 m_port = 0;
+    QString m_errorString;
+    int m_talkerTimeoutMs = DEFAULT_TALKER_TIMEOUT_MS;
+
+    QHash<QString, QByteArray> m_users;
+    std::map<quint16, std::unique_ptr<Client>> m_clients;
+    quint16 m_nextClientId = 1;
+    QHash<quint32, Talker> m_talkers;
+    std::map<QString, std::unique_ptr<ScriptedTalker>> m_scriptedTalkers;
+};
+
+#endif // REFLECTORSTANDIN_H
@@ -0,0 +1,148 @@
+// Standalone ImpairmentProxy: relays a reflector's TCP and UDP port through
+// a seeded bad link, so the app on a phone or desktop can be pointed at it
+// and a user's report replayed.
+//
+//   latry_impairment_proxy --upstream reflector.example.org:5300 \
+//       --listen 5300 --link lte-congested --seed 7
+//
+// --link sets both directions; --uplink and --downlink override one.  See
+// NetworkImpairment::parse() for the spec syntax.
+
+#include "ImpairmentProxy.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QHostInfo>
+#include <QTimer>
+
+#include <cstdio>
+
+namespace {
+bool parseLink(const QString &spec, NetworkImpairment::Config &config, const char *name)
+{
+    std::string error;
+    if (!NetworkImpairment::parse(spec.toStdString(), config, &error)) {
+        std::fprintf(stderr, "--%s: %s\n", name, error.c_str());
+        return false;
+    }
+    return true;
+}
+
+void printStats(const char *name, const NetworkImpairment::Stats &stats)
+{
+    std::printf("  %-13s %8lld packets %6lld lost %6lld overflowed %6lld reordered %6lld duplicated"
+                " %6lld retransmitted\n",
+                name,
+                static_cast<long long>(stats.packets),
+                static_cast<long long>(stats.lost),
+                static_cast<long long>(stats.overflowed),
+                static_cast<long long>(stats.reordered),
+                static_cast<long long>(stats.duplicated),
+                static_cast<long long>(stats.retransmitted));
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Relays a reflector through a seeded, impaired link."));
+    parser.addHelpOption();
+    const QCommandLineOption upstreamOption(QStringLiteral("upstream"),
+                                            QStringLiteral("Reflector to relay to."),
+                                            QStringLiteral("host:port"));
+    const QCommandLineOption listenOption(QStringLiteral("listen"),
+                                          QStringLiteral("TCP and UDP port to listen on (0 picks one)."),
+                                          QStringLiteral("port"), QStringLiteral("0"));
+    const QCommandLineOption bindOption(QStringLiteral("bind"),
+                                        QStringLiteral("Address to listen on."),
+                                        QStringLiteral("address"), QStringLiteral("127.0.0.1"));
+    const QCommandLineOption linkOption(QStringLiteral("link"),
+                                        QStringLiteral("Impairment of both directions."),
+                                        QStringLiteral("spec"), QStringLiteral("clean"));
+    const QCommandLineOption uplinkOption(QStringLiteral("uplink"),
+                                          QStringLiteral("Impairment towards the reflector."),
+                                          QStringLiteral("spec"));
+    const QCommandLineOption downlinkOption(QStringLiteral("downlink"),
+                                            QStringLiteral("Impairment towards the client."),
+                                            QStringLiteral("spec"));
+    const QCommandLineOption seedOption(QStringLiteral("seed"),
+                                        QStringLiteral("Seed of the impairment."),
+                                        QStringLiteral("n"), QStringLiteral("1"));
+    const QCommandLineOption statsOption(QStringLiteral("stats-interval"),
+                                         QStringLiteral("Seconds between statistics, 0 for none."),
+                                         QStringLiteral("seconds"), QStringLiteral("10"));
+    parser.addOptions({upstreamOption, listenOption, bindOption, linkOption, uplinkOption,
+                       downlinkOption, seedOption, statsOption});
+    parser.process(app);
+
+    const QString upstream = parser.value(upstreamOption);
+    const int colon = upstream.lastIndexOf(QLatin1Char(':'));
+    bool portOk = false;
+    const uint upstreamPort = colon > 0 ? upstream.mid(colon + 1).toUInt(&portOk) : 0;
+    if (!portOk || upstreamPort == 0 || upstreamPort > 65535) {
+        std::fprintf(stderr, "--upstream must be host:port\n");
+        return 2;
+    }
+    const QHostInfo host = QHostInfo::fromName(upstream.left(colon));
+    if (host.addresses().isEmpty()) {
+        std::fprintf(stderr, "Cannot resolve %s: %s\n", qPrintable(upstream.left(colon)),
+                     qPrintable(host.errorString()));
+        return 2;
+    }
+
+    NetworkImpairment::Config uplink;
+    if (!parseLink(parser.value(linkOption), uplink, "link")) {
+        return 2;
+    }
+    NetworkImpairment::Config downlink = uplink;
+    if (parser.isSet(uplinkOption) && !parseLink(parser.value(uplinkOption), uplink, "uplink")) {
+        return 2;
+    }
+    if (parser.isSet(downlinkOption) && !parseLink(parser.value(downlinkOption), downlink, "downlink")) {
+        return 2;
+    }
+
+    bool seedOk = false;
+    const quint64 seed = parser.value(seedOption).toULongLong(&seedOk);
+    bool listenOk = false;
+    const uint listenPort = parser.value(listenOption).toUInt(&listenOk);
+    if (!seedOk || !listenOk || listenPort > 65535) {
+        std::fprintf(stderr, "--seed and --listen must be numbers\n");
+        return 2;
+    }
+
+    ImpairmentProxy proxy;
+    proxy.setUpstream(host.addresses().constFirst(), static_cast<quint16>(upstreamPort));
+    proxy.setUplink(uplink);
+    proxy.setDownlink(downlink);
+    proxy.setSeed(seed);
+    if (!proxy.listen(QHostAddress(parser.value(bindOption)), static_cast<quint16>(listenPort))) {
+        std::fprintf(stderr, "Cannot listen: %s\n", qPrintable(proxy.errorString()));
+        return 1;
+    }
+    std::printf("Relaying %s:%d to %s:%u, seed %llu; expected loss %.2f%% up, %.2f%% down\n",
+                qPrintable(parser.value(bindOption)), proxy.port(),
+                qPrintable(host.addresses().constFirst().toString()), upstreamPort,
+                static_cast<unsigned long long>(seed),
+                100.0 * NetworkImpairment(uplink).expectedLoss(),
+                100.0 * NetworkImpairment(downlink).expectedLoss());
+    std::fflush(stdout);
+
+    QTimer statsTimer;
+    const int statsSeconds = parser.value(statsOption).toInt();
+    if (statsSeconds > 0) {
+        QObject::connect(&statsTimer, &QTimer::timeout, &proxy, [&proxy]() {
+            const ImpairmentProxy::Stats stats = proxy.stats();
+            printStats("udp uplink", stats.uplink);
+            printStats("udp downlink", stats.downlink);
+            printStats("tcp uplink", stats.tcpUplink);
+            printStats("tcp downlink", stats.tcpDownlink);
+            std::fflush(stdout);
+        });
+        statsTimer.start(statsSeconds * 1000);
+    }
+
+    return app.exec();
+}
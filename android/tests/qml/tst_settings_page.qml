@@ -67,6 +67,9 @@ TestCase {
             txAudioLevelDb: 0
             txTimeoutSeconds: 175
             pttHangTimeMs: 100
+            txPacketizationMs: 0
+            txFrameSizeMs: 20
+            txHeaderSavingsBitsPerSecond: 0
             tapToTalkButtonVisible: testCase.tapToTalkButtonVisible
             reflectorClient: reflectorClientStub
         }
@@ -108,6 +111,9 @@ TestCase {
             txAudioLevelDb: 0
             txTimeoutSeconds: 175
             pttHangTimeMs: 100
+            txPacketizationMs: 0
+            txFrameSizeMs: 20
+            txHeaderSavingsBitsPerSecond: 0
             tapToTalkButtonVisible: testCase.tapToTalkButtonVisible
             reflectorClient: reflectorClientStub
         }
@@ -0,0 +1,147 @@
+#include <QtTest>
+
+#include "AudioCaptureQueue.h"
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+class AudioCaptureQueueTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void deliversBlocksInPushOrder();
+    void convertsInt16ToFloat();
+    void splitsBlocksLongerThanASlot();
+    void dropsNewestWhenFullAndCountsIt();
+    void queuedDurationFollowsPushAndPop();
+    void producerAndConsumerThreadsSeeEveryBlock();
+};
+
+void AudioCaptureQueueTest::deliversBlocksInPushOrder()
+{
+    AudioCaptureQueue queue(8);
+    const std::vector<float> first(320, 0.25f);
+    const std::vector<float> second(160, -0.5f);
+
+    QVERIFY(queue.push(first.data(), static_cast<int>(first.size()), 16000, 1000));
+    QVERIFY(queue.push(second.data(), static_cast<int>(second.size()), 16000, 2000));
+
+    QCOMPARE(queue.size(), 2);
+    QVERIFY(queue.front() != nullptr);
+    QCOMPARE(queue.front()->count, 320);
+    QCOMPARE(queue.front()->sampleRate, 16000);
+    QCOMPARE(queue.front()->captureUs, int64_t(1000));
+    QCOMPARE(queue.front()->samples[319], 0.25f);
+    queue.pop();
+
+    QCOMPARE(queue.front()->count, 160);
+    QCOMPARE(queue.front()->samples[0], -0.5f);
+    queue.pop();
+
+    QVERIFY(queue.front() == nullptr);
+    QCOMPARE(queue.size(), 0);
+}
+
+void AudioCaptureQueueTest::convertsInt16ToFloat()
+{
+    AudioCaptureQueue queue(4);
+    const std::vector<short> samples{16384, -32768, 0};
+
+    QVERIFY(queue.push(samples.data(), static_cast<int>(samples.size()), 48000, 0));
+
+    QCOMPARE(queue.front()->count, 3);
+    QCOMPARE(queue.front()->samples[0], 0.5f);
+    QCOMPARE(queue.front()->samples[1], -1.0f);
+    QCOMPARE(queue.front()->samples[2], 0.0f);
+}
+
+void AudioCaptureQueueTest::splitsBlocksLongerThanASlot()
+{
+    AudioCaptureQueue queue(4);
+    std::vector<float> samples(AudioCaptureQueue::MAX_BLOCK_SAMPLES * 2 + 10, 0.0f);
+    samples.back() = 1.0f;
+
+    QVERIFY(queue.push(samples.data(), static_cast<int>(samples.size()), 96000, 0));
+
+    QCOMPARE(queue.size(), 3);
+    QCOMPARE(queue.front()->count, AudioCaptureQueue::MAX_BLOCK_SAMPLES);
+    queue.pop();
+    queue.pop();
+    QCOMPARE(queue.front()->count, 10);
+    QCOMPARE(queue.front()->samples[9], 1.0f);
+}
+
+void AudioCaptureQueueTest::dropsNewestWhenFullAndCountsIt()
+{
+    AudioCaptureQueue queue(2);
+    std::vector<float> samples(320, 0.0f);
+
+    samples[0] = 1.0f;
+    QVERIFY(queue.push(samples.data(), 320, 16000, 0));
+    samples[0] = 2.0f;
+    QVERIFY(queue.push(samples.data(), 320, 16000, 0));
+    samples[0] = 3.0f;
+    QVERIFY(!queue.push(samples.data(), 320, 16000, 0));
+
+    QCOMPARE(queue.droppedBlocks(), uint64_t(1));
+    QCOMPARE(queue.size(), 2);
+    QCOMPARE(queue.front()->samples[0], 1.0f);
+}
+
+void AudioCaptureQueueTest::queuedDurationFollowsPushAndPop()
+{
+    AudioCaptureQueue queue(8);
+    std::vector<float> samples(960, 0.0f);
+
+    queue.push(samples.data(), 320, 16000, 0);
+    queue.push(samples.data(), 960, 48000, 0);
+    QCOMPARE(queue.queuedUs(), int64_t(40000));
+
+    queue.pop();
+    QCOMPARE(queue.queuedUs(), int64_t(20000));
+
+    queue.clear();
+    QCOMPARE(queue.queuedUs(), int64_t(0));
+    QVERIFY(queue.front() == nullptr);
+}
+
+void AudioCaptureQueueTest::producerAndConsumerThreadsSeeEveryBlock()
+{
+    AudioCaptureQueue queue(16);
+    constexpr int kBlocks = 20000;
+
+    std::thread producer([&queue]() {
+        std::vector<float> samples(320, 0.0f);
+        for (int i = 0; i < kBlocks; ++i) {
+            samples[0] = static_cast<float>(i);
+            while (!queue.push(samples.data(), static_cast<int>(samples.size()), 16000, i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    int received = 0;
+    bool inOrder = true;
+    while (received < kBlocks) {
+        const AudioCaptureQueue::Block* block = queue.front();
+        if (block == nullptr) {
+            std::this_thread::yield();
+            continue;
+        }
+        inOrder = inOrder && block->captureUs == received
+                && block->samples[0] == static_cast<float>(received);
+        queue.pop();
+        ++received;
+    }
+    producer.join();
+
+    QVERIFY(inOrder);
+    QCOMPARE(queue.size(), 0);
+    QCOMPARE(queue.queuedUs(), int64_t(0));
+}
+
+QTEST_APPLESS_MAIN(AudioCaptureQueueTest)
+
+#include "tst_audio_capture_queue.moc"
@@ -1,14 +1,24 @@
 #include <QtTest>
 
 #include "AudioEngine.h"
+#include "AllocationCounter.h"
 
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <limits>
+#include <random>
 #include <thread>
 #include <vector>
 
 #include <opus.h>
 
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
 class AudioEngineTest : public QObject
 {
     Q_OBJECT
@@ -17,19 +27,44 @@ private slots:
     void initializeAudioComponentsUsesVoipEncoderApplication();
     void startupPrimingBuffersUntilTargetThenEncodesFrames();
     void startupLeadInEmitsTwoSilentFrames();
+    void startupLeadInGoesOutAsOneUdpBatch();
     void flushPendingSamplesPadsPartialFrame();
-    void processCapturedInt16SamplesEncodesAtNativeRate();
+    void queuedInt16CaptureEncodesAtNativeRate();
+    void queuedInt16CaptureReusesTheCaptureRateResampler();
     void queuedNativeFloatCaptureEncodesViaEventLoop();
     void queuedNativeFloatCaptureDropsAfterStop();
+    void queuedCaptureBeyondTxBacklogIsDropped();
+    void txEncodeThreadEncodesWithoutTheEventLoop();
     void processReceivedAudioDropsStaleOutOfOrderPackets();
     void processReceivedAudioCapsPacketLossConcealmentFrames();
     void processReceivedAudioTreatsSequenceZeroAsRealPacket();
     void processReceivedAudioHandlesSequenceWraparound();
+    void processReceivedAudioReordersPacketsWithoutConcealment();
+    void processReceivedAudioDropsPacketArrivingAfterItsSlotWasConcealed();
+    void processReceivedAudioRetargetsAdaptivePrebuffer();
+    void singleLostPacketIsRecoveredFromFollowingPacketFec();
+    void lostPacketWithoutLbrrIsConcealedNotRecovered();
+    void txFecFollowsMeasuredDownlinkLoss();
+    void txEncoderFollowsNetworkTransport();
+    void queuedReceivePathDoesNotAllocateInSteadyState();
+    void queuedFlushOnlyDropsAudioQueuedBeforeIt();
     void txGainLevelIsClampedAndApplied();
+    void txLookAheadTailIsEncodedOnDrain();
+    void txLookAheadLatencyIsReportedWhenApplied();
+    void txPacketizationPacksLongerFramesBetweenTransmissions();
+    void txDtxPausesNeedNoConcealmentAtReceiver();
+    void deviceRateCodecNeedsNoResamplers();
 
 private:
     void configureEncoder(AudioEngine &engine);
     QByteArray encodeFramePacket(float sampleValue = 0.2f);
+    std::vector<QByteArray> encodeVoicedPackets(int count, bool inbandFec);
+    void receiveWithFecTestLosses(AudioEngine &engine, const std::vector<QByteArray> &packets);
+
+    // Packet 5 is a single loss (FEC when the next packet has LBRR) and
+    // 9..10 a double loss (PLC only).
+    static constexpr int kFecTestPackets = 12;
+    static constexpr int kFecTestLostPacket = 5;
 };
 
 void AudioEngineTest::configureEncoder(AudioEngine &engine)
@@ -66,6 +101,59 @@ QByteArray AudioEngineTest::encodeFramePacket(float sampleValue)
     return QByteArray(reinterpret_cast<const char*>(buffer.data()), encodedSize);
 }
 
+std::vector<QByteArray> AudioEngineTest::encodeVoicedPackets(int count, bool inbandFec)
+{
+    OpusEncoder encoder(AudioEngine::SAMPLE_RATE,
+                        AudioEngine::CHANNELS,
+                        OPUS_APPLICATION_VOIP);
+    if (encoder.m_encoder == nullptr) {
+        return {};
+    }
+
+    encoder.applySvxlinkDefaults();
+    encoder.setInbandFec(inbandFec, 20);
+
+    // A harmonic "vowel" whose pitch and level change every frame: SILK only
+    // codes LBRR for frames its VAD rates as speech, and concealment cannot
+    // pass for the lost frame by extending the one before it.
+    constexpr std::array<double, 4> kPitchHz{120.0, 180.0, 140.0, 210.0};
+    constexpr std::array<double, 4> kLevel{0.2, 0.4, 0.3, 0.15};
+    std::vector<QByteArray> packets;
+    std::vector<float> samples(AudioEngine::FRAME_SIZE_SAMPLES);
+    std::vector<unsigned char> buffer(4000);
+    double phase = 0.0;
+    for (int frame = 0; frame < count; ++frame) {
+        const size_t shape = static_cast<size_t>(frame) % kPitchHz.size();
+        for (int i = 0; i < AudioEngine::FRAME_SIZE_SAMPLES; ++i) {
+            phase = std::fmod(phase + 2.0 * M_PI * kPitchHz[shape] / AudioEngine::SAMPLE_RATE, 2.0 * M_PI);
+            double value = 0.0;
+            for (int harmonic = 1; harmonic <= 8; ++harmonic) {
+                value += std::sin(harmonic * phase) / harmonic;
+            }
+            samples[static_cast<size_t>(i)] = static_cast<float>(kLevel[shape] * value);
+        }
+        const int encodedSize = encoder.encode(samples.data(), AudioEngine::FRAME_SIZE_SAMPLES,
+                                               buffer.data(), static_cast<int>(buffer.size()));
+        if (encodedSize <= 0) {
+            return {};
+        }
+        packets.emplace_back(reinterpret_cast<const char*>(buffer.data()), encodedSize);
+    }
+    return packets;
+}
+
+void AudioEngineTest::receiveWithFecTestLosses(AudioEngine &engine, const std::vector<QByteArray> &packets)
+{
+    for (int sequence = 0; sequence < static_cast<int>(packets.size()); ++sequence) {
+        if (sequence == kFecTestLostPacket || sequence == 9 || sequence == 10) {
+            continue;
+        }
+        engine.processReceivedAudio(packets[static_cast<size_t>(sequence)], static_cast<quint16>(sequence),
+                                    sequence * AudioEngine::FRAME_SIZE_MS * 1000);
+        engine.releaseBufferedPackets(false, 10000000 + sequence);
+    }
+}
+
 void AudioEngineTest::initializeAudioComponentsUsesVoipEncoderApplication()
 {
     AudioEngine engine;
@@ -95,14 +183,13 @@ void AudioEngineTest::startupPrimingBuffersUntilTargetThenEncodesFrames()
     engine.processCapturedFloatSamples(samples.data(), static_cast<int>(samples.size()));
 
     QCOMPARE(encodedSpy.count(), 0);
-    QCOMPARE(engine.m_txStartupBuffer.size(), samples.size());
+    QCOMPARE(engine.m_pendingInputSamples.size(), samples.size());
     QVERIFY(engine.m_txStartupPrimingActive);
 
     engine.processCapturedFloatSamples(samples.data(), static_cast<int>(samples.size()));
 
     QCOMPARE(encodedSpy.count(), 2);
     QVERIFY(!engine.m_txStartupPrimingActive);
-    QVERIFY(engine.m_txStartupBuffer.empty());
     QVERIFY(engine.m_pendingInputSamples.empty());
 }
 
@@ -121,6 +208,54 @@ void AudioEngineTest::startupLeadInEmitsTwoSilentFrames()
         QVERIFY(!encodedSpy.at(i).at(0).toByteArray().isEmpty());
 }
 
+void AudioEngineTest::startupLeadInGoesOutAsOneUdpBatch()
+{
+    const int receiver = ::socket(AF_INET, SOCK_DGRAM, 0);
+    const int sender = ::socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ::bind(receiver, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    socklen_t length = sizeof(address);
+    ::getsockname(receiver, reinterpret_cast<sockaddr*>(&address), &length);
+
+    std::atomic<uint16_t> sequence{10};
+    UdpAudioSender udpSender(sequence);
+    QVERIFY(udpSender.open(sender, reinterpret_cast<const uint8_t*>(&address.sin_addr), 4,
+                           ntohs(address.sin_port), 77));
+    udpSender.setTransmitEnabled(true);
+
+    AudioEngine engine;
+    configureEncoder(engine);
+    engine.setUdpAudioSender(&udpSender);
+    QSignalSpy encodedSpy(&engine, &AudioEngine::audioDataEncoded);
+
+    engine.prepareTxStartupPriming();
+    engine.sendTxStartupLeadIn();
+
+    QCOMPARE(encodedSpy.count(), 0);
+    QCOMPARE(udpSender.datagramsSent(), uint64_t(2));
+#if defined(__linux__)
+    QCOMPARE(udpSender.batchesSent(), uint64_t(1));
+#endif
+    QCOMPARE(sequence.load(), uint16_t(12));
+
+    std::array<unsigned char, 2048> datagram{};
+    const ssize_t size = ::recv(receiver, datagram.data(), datagram.size(), 0);
+    QVERIFY(size > UdpAudioSender::HEADER_BYTES);
+    QCOMPARE(static_cast<int>((datagram[6] << 8) | datagram[7]), static_cast<int>(size) - UdpAudioSender::HEADER_BYTES);
+
+    // Without PTT the engine falls back to the signal, which the client drops.
+    udpSender.setTransmitEnabled(false);
+    engine.sendTxStartupLeadIn();
+    QCOMPARE(encodedSpy.count(), 2);
+    QCOMPARE(udpSender.datagramsSent(), uint64_t(2));
+
+    udpSender.close();
+    ::close(receiver);
+    ::close(sender);
+}
+
 void AudioEngineTest::flushPendingSamplesPadsPartialFrame()
 {
     AudioEngine engine;
@@ -128,14 +263,15 @@ void AudioEngineTest::flushPendingSamplesPadsPartialFrame()
 
     QSignalSpy encodedSpy(&engine, &AudioEngine::audioDataEncoded);
 
-    engine.m_pendingInputSamples.assign(AudioEngine::FRAME_SIZE_SAMPLES / 2, 0.1f);
+    std::vector<float> halfFrame(AudioEngine::FRAME_SIZE_SAMPLES / 2, 0.1f);
+    engine.m_pendingInputSamples.push(halfFrame.data(), static_cast<int>(halfFrame.size()));
     engine.flushPendingTxSamples();
 
     QCOMPARE(encodedSpy.count(), 1);
     QVERIFY(engine.m_pendingInputSamples.empty());
 }
 
-void AudioEngineTest::processCapturedInt16SamplesEncodesAtNativeRate()
+void AudioEngineTest::queuedInt16CaptureEncodesAtNativeRate()
 {
     AudioEngine engine;
     configureEncoder(engine);
@@ -144,11 +280,47 @@ void AudioEngineTest::processCapturedInt16SamplesEncodesAtNativeRate()
     QSignalSpy encodedSpy(&engine, &AudioEngine::audioDataEncoded);
 
     std::vector<short> samples(AudioEngine::FRAME_SIZE_SAMPLES, 4096);
-    engine.processCapturedInt16Samples(samples.data(),
-                                       static_cast<int>(samples.size()),
-                                       AudioEngine::SAMPLE_RATE);
+    engine.queueCapturedInt16Samples(samples.data(),
+                                     static_cast<int>(samples.size()),
+                                     AudioEngine::SAMPLE_RATE);
+    engine.drainCapturedAudio();
 
     QCOMPARE(encodedSpy.count(), 1);
+    QCOMPARE(engine.m_txCaptureQueue.size(), 0);
+}
+
+void AudioEngineTest::queuedInt16CaptureReusesTheCaptureRateResampler()
+{
+    // 44.1 kHz capture, as startAndroidCaptureInput() leaves it: the
+    // resampler is built up front and the encode path only reuses it.
+    AudioEngine engine;
+    engine.initializeAudioComponents();
+    engine.m_inputFormat.setSampleRate(44100);
+    engine.m_inputFormat.setSampleFormat(QAudioFormat::Int16);
+    engine.configureTxSampleRate(44100);
+    const Resampler* resampler = engine.m_inputResampler.get();
+    QVERIFY(resampler != nullptr);
+    const size_t resampledCapacity = engine.m_resampledInputBuffer.size();
+    engine.m_recording = true;
+
+    QSignalSpy encodedSpy(&engine, &AudioEngine::audioDataEncoded);
+    std::vector<short> samples(441, 4096);
+    for (int i = 0; i < 10; ++i) {
+        engine.queueCapturedInt16Samples(samples.data(), static_cast<int>(samples.size()), 44100);
+        engine.drainCapturedAudio();
+    }
+    QVERIFY(engine.m_inputResampler.get() == resampler);
+    QCOMPARE(engine.m_resampledInputBuffer.size(), resampledCapacity);
+    QVERIFY(encodedSpy.count() > 0);
+    QCOMPARE(engine.m_txCaptureRateMismatches, 0);
+
+    // A block at a rate nothing was built for is dropped, not resampled.
+    const int encoded = encodedSpy.count();
+    engine.queueCapturedInt16Samples(samples.data(), static_cast<int>(samples.size()), 32000);
+    engine.drainCapturedAudio();
+    QVERIFY(engine.m_inputResampler.get() == resampler);
+    QCOMPARE(engine.m_txCaptureRateMismatches, 1);
+    QCOMPARE(encodedSpy.count(), encoded);
 }
 
 void AudioEngineTest::queuedNativeFloatCaptureEncodesViaEventLoop()
@@ -200,6 +372,89 @@ void AudioEngineTest::queuedNativeFloatCaptureDropsAfterStop()
     QVERIFY(engine.m_pendingInputSamples.empty());
 }
 
+void AudioEngineTest::queuedCaptureBeyondTxBacklogIsDropped()
+{
+    AudioEngine engine;
+    configureEncoder(engine);
+    engine.m_recording = true;
+
+    QSignalSpy encodedSpy(&engine, &AudioEngine::audioDataEncoded);
+    std::vector<float> samples(AudioEngine::FRAME_SIZE_SAMPLES, 0.25f);
+
+    // 400 ms of capture queued while the engine thread was stalled.
+    constexpr int kQueuedFrames = 20;
+    std::thread worker([&engine, &samples]() {
+        for (int i = 0; i < kQueuedFrames; ++i) {
+            engine.queueCapturedNativeFloatSamples(samples.data(),
+                                                   static_cast<int>(samples.size()),
+                                                   AudioEngine::SAMPLE_RATE);
+        }
+    });
+    worker.join();
+
+    // Only the newest DEFAULT_TX_MAX_BACKLOG_MS (plus the chunk at its
+    // edge) goes out; the rest is dropped rather than sent late.
+    const int keptFrames = AudioEngine::DEFAULT_TX_MAX_BACKLOG_MS / AudioEngine::FRAME_SIZE_MS + 1;
+    QTRY_COMPARE(encodedSpy.count(), keptFrames);
+    QCOMPARE(engine.m_txCaptureQueue.queuedUs(), static_cast<qint64>(0));
+    QCOMPARE(engine.m_txBacklogDroppedUs,
+             static_cast<qint64>(kQueuedFrames - keptFrames) * AudioEngine::FRAME_SIZE_MS * 1000);
+    QVERIFY(engine.m_pendingInputSamples.empty());
+}
+
+void AudioEngineTest::txEncodeThreadEncodesWithoutTheEventLoop()
+{
+    AudioEngine engine;
+    configureEncoder(engine);
+    engine.m_recording = true;
+    engine.setTxEncodeThreadEnabled(true);
+    engine.startTxEncodeThread();
+    QVERIFY(engine.m_txEncodeThreadActive.load());
+
+    std::atomic<int> encodedFrames{0};
+    connect(&engine, &AudioEngine::audioDataEncoded, &engine,
+            [&encodedFrames]() { ++encodedFrames; }, Qt::DirectConnection);
+    QSignalSpy statsSpy(&engine, &AudioEngine::txEncodeStatsChanged);
+    QSignalSpy meterSpy(&engine, &AudioEngine::txMeterLevelsChanged);
+
+    std::vector<float> samples(AudioEngine::FRAME_SIZE_SAMPLES, 0.25f);
+    constexpr int kCapturedFrames = 3;
+    std::thread capture([&engine, &samples]() {
+        for (int i = 0; i < kCapturedFrames; ++i) {
+            engine.queueCapturedNativeFloatSamples(samples.data(),
+                                                   static_cast<int>(samples.size()),
+                                                   AudioEngine::SAMPLE_RATE);
+        }
+    });
+    capture.join();
+
+    // This thread never returns to its event loop while waiting.  The
+    // encode thread emits nothing; packets and meter levels wait for it.
+    for (int i = 0; i < 200 && engine.m_txPacketQueue.size() < kCapturedFrames; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    QCOMPARE(engine.m_txPacketQueue.size(), kCapturedFrames);
+    QCOMPARE(encodedFrames.load(), 0);
+    QVERIFY(meterSpy.isEmpty());
+    QVERIFY(!engine.m_txCaptureDrainScheduled.load());
+
+    engine.stopTxEncodeThread();
+    QVERIFY(!engine.m_txEncodeThreadActive.load());
+    QCOMPARE(engine.m_txEncodedPackets, kCapturedFrames);
+    QCOMPARE(encodedFrames.load(), kCapturedFrames);
+    QCOMPARE(engine.m_txPacketQueue.size(), 0);
+
+    engine.onMeterDecayTimer();
+    QVERIFY(!meterSpy.isEmpty());
+    QVERIFY(meterSpy.first().at(0).toFloat() > 0.0f);
+
+    engine.m_recording = false;
+    engine.flushPendingTxSamples();
+    QCOMPARE(statsSpy.count(), 1);
+    QVERIFY(statsSpy.at(0).at(1).toInt() >= statsSpy.at(0).at(0).toInt());
+    QCOMPARE(engine.m_txEncodedPackets, 0);
+}
+
 void AudioEngineTest::processReceivedAudioDropsStaleOutOfOrderPackets()
 {
     AudioEngine engine;
@@ -236,11 +491,13 @@ void AudioEngineTest::processReceivedAudioCapsPacketLossConcealmentFrames()
     const QByteArray packet = encodeFramePacket();
     QVERIFY(!packet.isEmpty());
 
-    threeFrameGapEngine.processReceivedAudio(packet, 200);
-    threeFrameGapEngine.processReceivedAudio(packet, 204);
+    threeFrameGapEngine.processReceivedAudio(packet, 200, 0);
+    threeFrameGapEngine.processReceivedAudio(packet, 204, 80000);
+    threeFrameGapEngine.releaseBufferedPackets(false, 1000000);
 
-    fourFrameGapEngine.processReceivedAudio(packet, 200);
-    fourFrameGapEngine.processReceivedAudio(packet, 205);
+    fourFrameGapEngine.processReceivedAudio(packet, 200, 0);
+    fourFrameGapEngine.processReceivedAudio(packet, 205, 100000);
+    fourFrameGapEngine.releaseBufferedPackets(false, 1000000);
 
     QCOMPARE(threeFrameGapEngine.m_lastAudioSeq, quint16(204));
     QCOMPARE(fourFrameGapEngine.m_lastAudioSeq, quint16(205));
@@ -263,7 +520,8 @@ void AudioEngineTest::processReceivedAudioTreatsSequenceZeroAsRealPacket()
     QCOMPARE(engine.m_jitterBuffer.samplesInBuffer(),
              static_cast<unsigned>(AudioEngine::FRAME_SIZE_SAMPLES));
 
-    engine.processReceivedAudio(packet, 2);
+    engine.processReceivedAudio(packet, 2, 40000);
+    engine.releaseBufferedPackets(false, 1000000);
 
     QCOMPARE(engine.m_lastAudioSeq, quint16(2));
     QCOMPARE(engine.m_jitterBuffer.samplesInBuffer(),
@@ -287,6 +545,286 @@ void AudioEngineTest::processReceivedAudioHandlesSequenceWraparound()
              static_cast<unsigned>(AudioEngine::FRAME_SIZE_SAMPLES * 2));
 }
 
+void AudioEngineTest::processReceivedAudioReordersPacketsWithoutConcealment()
+{
+    AudioEngine engine;
+    engine.initializeAudioComponents();
+    engine.m_audioReady = true;
+
+    const QByteArray packet = encodeFramePacket();
+    QVERIFY(!packet.isEmpty());
+
+    engine.processReceivedAudio(packet, 10, 0);
+    engine.processReceivedAudio(packet, 12, 40000);
+
+    QCOMPARE(engine.m_lastAudioSeq, quint16(10));
+    QCOMPARE(engine.m_packetBuffer.heldCount(), 1);
+    QVERIFY(engine.m_packetPlayoutTimer->isActive());
+
+    engine.processReceivedAudio(packet, 11, 45000);
+
+    QCOMPARE(engine.m_lastAudioSeq, quint16(12));
+    QCOMPARE(engine.m_packetBuffer.heldCount(), 0);
+    QVERIFY(!engine.m_packetPlayoutTimer->isActive());
+    QCOMPARE(engine.m_jitterBuffer.samplesInBuffer(),
+             static_cast<unsigned>(AudioEngine::FRAME_SIZE_SAMPLES * 3));
+}
+
+void AudioEngineTest::processReceivedAudioDropsPacketArrivingAfterItsSlotWasConcealed()
+{
+    AudioEngine engine;
+    engine.initializeAudioComponents();
+    engine.m_audioReady = true;
+
+    const QByteArray packet = encodeFramePacket();
+    QVERIFY(!packet.isEmpty());
+
+    engine.processReceivedAudio(packet, 10, 0);
+    engine.processReceivedAudio(packet, 12, 40000);
+
+    // Held past the prebuffer depth: the slot is due, so PLC fills it.
+    engine.releaseBufferedPackets(false, 40000 + AudioEngine::DEFAULT_PREBUF_MS * 1000);
+
+    QCOMPARE(engine.m_lastAudioSeq, quint16(12));
+    const unsigned bufferedSamples = engine.m_jitterBuffer.samplesInBuffer();
+    QCOMPARE(bufferedSamples, static_cast<unsigned>(AudioEngine::FRAME_SIZE_SAMPLES * 3));
+
+    engine.processReceivedAudio(packet, 11, 250000);
+
+    QCOMPARE(engine.m_jitterBuffer.samplesInBuffer(), bufferedSamples);
+    QCOMPARE(engine.m_lastAudioSeq, quint16(12));
+}
+
+void AudioEngineTest::processReceivedAudioRetargetsAdaptivePrebuffer()
+{
+    AudioEngine engine;
+    engine.initializeAudioComponents();
+    engine.m_audioReady = true;
+
+    const QByteArray packet = encodeFramePacket();
+    QVERIFY(!packet.isEmpty());
+
+    QSignalSpy statsSpy(&engine, &AudioEngine::jitterBufferStatsChanged);
+    for (int i = 0; i < 60; ++i) {
+        engine.processReceivedAudio(packet, static_cast<quint16>(i),
+                                    1000000 + i * AudioEngine::FRAME_SIZE_MS * 1000);
+    }
+    // Reported from the meter timer, not the decode path.
+    QVERIFY(statsSpy.isEmpty());
+    engine.onMeterDecayTimer();
+
+    // A perfectly paced stream only needs the minimum two-frame depth.
+    QCOMPARE(engine.m_jitterBuffer.prebufSamples(),
+             static_cast<unsigned>(AudioEngine::FRAME_SIZE_SAMPLES * 2));
+    QVERIFY(!statsSpy.isEmpty());
+    QCOMPARE(statsSpy.last().at(0).toInt(), 2 * AudioEngine::FRAME_SIZE_MS);
+
+    engine.setAdaptiveJitterBufferEnabled(false);
+
+    QCOMPARE(engine.m_jitterBuffer.prebufSamples(),
+             static_cast<unsigned>(AudioEngine::SAMPLE_RATE / 1000 * AudioEngine::DEFAULT_PREBUF_MS));
+    QCOMPARE(statsSpy.last().at(0).toInt(), AudioEngine::DEFAULT_PREBUF_MS);
+}
+
+void AudioEngineTest::singleLostPacketIsRecoveredFromFollowingPacketFec()
+{
+    constexpr int kFrame = AudioEngine::FRAME_SIZE_SAMPLES;
+    const std::vector<QByteArray> packets = encodeVoicedPackets(kFecTestPackets, true);
+    QCOMPARE(static_cast<int>(packets.size()), kFecTestPackets);
+    const QByteArray& following = packets[kFecTestLostPacket + 1];
+    QVERIFY(OpusDecoder::packetHasLbrr(reinterpret_cast<const unsigned char*>(following.constData()),
+                                       static_cast<int>(following.size())));
+
+    AudioEngine engine;
+    engine.initializeAudioComponents();
+    engine.m_audioReady = true;
+    receiveWithFecTestLosses(engine, packets);
+
+    QCOMPARE(engine.m_lastAudioSeq, quint16(kFecTestPackets - 1));
+    QCOMPARE(engine.m_rxFecRecoveredFrames, quint64(1));
+    QCOMPARE(engine.m_jitterBuffer.samplesInBuffer(),
+             static_cast<unsigned>(kFrame * kFecTestPackets));
+    QVERIFY(engine.m_rxLossFraction > 0.0);
+
+    // Reference: the lost packet decoded in order.  Concealment: what the
+    // same decoder state produces without it.
+    OpusDecoder reference(AudioEngine::SAMPLE_RATE, AudioEngine::CHANNELS);
+    OpusDecoder concealer(AudioEngine::SAMPLE_RATE, AudioEngine::CHANNELS);
+    std::vector<float> expected(kFrame);
+    std::vector<float> concealed(kFrame);
+    for (int sequence = 0; sequence < kFecTestLostPacket; ++sequence) {
+        const QByteArray& packet = packets[static_cast<size_t>(sequence)];
+        const auto* payload = reinterpret_cast<const unsigned char*>(packet.constData());
+        QCOMPARE(reference.decode(payload, static_cast<int>(packet.size()), expected.data(), kFrame), kFrame);
+        QCOMPARE(concealer.decode(payload, static_cast<int>(packet.size()), concealed.data(), kFrame), kFrame);
+    }
+    const QByteArray& lost = packets[kFecTestLostPacket];
+    QCOMPARE(reference.decode(reinterpret_cast<const unsigned char*>(lost.constData()),
+                              static_cast<int>(lost.size()), expected.data(), kFrame), kFrame);
+    QCOMPARE(concealer.decode(nullptr, 0, concealed.data(), kFrame), kFrame);
+
+    std::vector<float> played(static_cast<size_t>(kFrame * kFecTestPackets));
+    QCOMPARE(engine.m_jitterBuffer.readSamples(played.data(), static_cast<int>(played.size())),
+             kFrame * kFecTestPackets);
+    const float* recovered = played.data() + kFecTestLostPacket * kFrame;
+
+    double fecError = 0.0;
+    double plcError = 0.0;
+    for (int i = 0; i < kFrame; ++i) {
+        fecError += std::pow(recovered[i] - expected[static_cast<size_t>(i)], 2.0);
+        plcError += std::pow(concealed[static_cast<size_t>(i)] - expected[static_cast<size_t>(i)], 2.0);
+    }
+    QVERIFY2(fecError < 0.5 * plcError,
+             qPrintable(QStringLiteral("FEC error %1 vs PLC error %2").arg(fecError).arg(plcError)));
+}
+
+void AudioEngineTest::lostPacketWithoutLbrrIsConcealedNotRecovered()
+{
+    const std::vector<QByteArray> packets = encodeVoicedPackets(kFecTestPackets, false);
+    QCOMPARE(static_cast<int>(packets.size()), kFecTestPackets);
+    const QByteArray& following = packets[kFecTestLostPacket + 1];
+    QVERIFY(!OpusDecoder::packetHasLbrr(reinterpret_cast<const unsigned char*>(following.constData()),
+                                        static_cast<int>(following.size())));
+
+    AudioEngine engine;
+    engine.initializeAudioComponents();
+    engine.m_audioReady = true;
+    receiveWithFecTestLosses(engine, packets);
+
+    // The lost frame is still concealed, but PLC is not FEC.
+    QCOMPARE(engine.m_lastAudioSeq, quint16(kFecTestPackets - 1));
+    QCOMPARE(engine.m_rxFecRecoveredFrames, quint64(0));
+    QCOMPARE(engine.m_jitterBuffer.samplesInBuffer(),
+             static_cast<unsigned>(AudioEngine::FRAME_SIZE_SAMPLES * kFecTestPackets));
+}
+
+void AudioEngineTest::txFecFollowsMeasuredDownlinkLoss()
+{
+    AudioEngine engine;
+    engine.initializeAudioComponents();
+    QVERIFY(engine.m_encoder != nullptr);
+    ::OpusEncoder* encoder = engine.m_encoder->m_encoder;
+
+    int fec = -1;
+    int lossPercent = -1;
+    QCOMPARE(opus_encoder_ctl(encoder, OPUS_GET_INBAND_FEC(&fec)), OPUS_OK);
+    QCOMPARE(fec, 0);
+
+    engine.setTxFecEnabled(true);
+    QCOMPARE(opus_encoder_ctl(encoder, OPUS_GET_INBAND_FEC(&fec)), OPUS_OK);
+    QCOMPARE(opus_encoder_ctl(encoder, OPUS_GET_PACKET_LOSS_PERC(&lossPercent)), OPUS_OK);
+    QCOMPARE(fec, 1);
+    QCOMPARE(lossPercent, 2);
+
+    engine.m_rxLossFraction = 0.08;
+    engine.applyTxEncoderSettings();
+    QCOMPARE(opus_encoder_ctl(encoder, OPUS_GET_PACKET_LOSS_PERC(&lossPercent)), OPUS_OK);
+    QCOMPARE(lossPercent, 8);
+
+    engine.setTxFecEnabled(false);
+    QCOMPARE(opus_encoder_ctl(encoder, OPUS_GET_INBAND_FEC(&fec)), OPUS_OK);
+    QCOMPARE(opus_encoder_ctl(encoder, OPUS_GET_PACKET_LOSS_PERC(&lossPercent)), OPUS_OK);
+    QCOMPARE(fec, 0);
+    QCOMPARE(lossPercent, 0);
+}
+
+void AudioEngineTest::txEncoderFollowsNetworkTransport()
+{
+    AudioEngine engine;
+    engine.initializeAudioComponents();
+    QVERIFY(engine.m_encoder != nullptr);
+    ::OpusEncoder* encoder = engine.m_encoder->m_encoder;
+
+    opus_int32 bitrate = 0;
+    opus_int32 bandwidth = 0;
+    QCOMPARE(opus_encoder_ctl(encoder, OPUS_GET_BITRATE(&bitrate)), OPUS_OK);
+    QCOMPARE(bitrate, 20000);
+
+    engine.setNetworkTransport(2, true);
+    QCOMPARE(opus_encoder_ctl(encoder, OPUS_GET_BITRATE(&bitrate)), OPUS_OK);
+    QCOMPARE(bitrate, OpusEncoderController::METERED_BITRATE);
+
+    engine.setNetworkTransport(2, false);
+    QCOMPARE(opus_encoder_ctl(encoder, OPUS_GET_BITRATE(&bitrate)), OPUS_OK);
+    QCOMPARE(bitrate, OpusEncoderController::CELLULAR_BITRATE);
+
+    engine.m_rxLossFraction = 0.15;
+    engine.applyTxEncoderSettings();
+    QCOMPARE(opus_encoder_ctl(encoder, OPUS_GET_MAX_BANDWIDTH(&bandwidth)), OPUS_OK);
+    QCOMPARE(bandwidth, OPUS_BANDWIDTH_NARROWBAND);
+}
+
+void AudioEngineTest::queuedReceivePathDoesNotAllocateInSteadyState()
+{
+    AudioEngine engine;
+    engine.initializeAudioComponents();
+    engine.m_audioReady = true;
+
+    const QByteArray packet = encodeFramePacket();
+    QVERIFY(!packet.isEmpty());
+    const auto* payload = reinterpret_cast<const unsigned char*>(packet.constData());
+    const int size = static_cast<int>(packet.size());
+
+    // Queued receivers, as ReflectorClient's are: a signal emitted from the
+    // decode path would allocate its event here.
+    QObject receiver;
+    connect(&engine, &AudioEngine::jitterBufferStatsChanged, &receiver, [](int, float) {},
+            Qt::QueuedConnection);
+    connect(&engine, &AudioEngine::rxMeterLevelsChanged, &receiver, [](float, float) {},
+            Qt::QueuedConnection);
+
+    // Warm up: the decoder, reorder slots and jitter buffer settle first.
+    quint16 sequence = 0;
+    for (int i = 0; i < 30; ++i, ++sequence) {
+        QVERIFY(engine.m_rxPacketQueue.push(sequence, payload, size, qint64(sequence) * 20000));
+        engine.drainReceivedAudio();
+    }
+
+    long allocations = 0;
+    {
+        AllocationCounter counter;
+        for (int i = 0; i < 100; ++i, ++sequence) {
+            engine.m_rxPacketQueue.push(sequence, payload, size, qint64(sequence) * 20000);
+            engine.drainReceivedAudio();
+            engine.m_jitterBuffer.clear();
+        }
+        engine.concealLostFrames(2);
+        engine.recoverLostFrameFromFec(payload, size);
+        allocations = counter.count();
+    }
+
+    QCOMPARE(allocations, 0L);
+    QCOMPARE(engine.m_lastAudioSeq, quint16(sequence - 1));
+    QCOMPARE(engine.m_rxPacketQueue.size(), 0);
+}
+
+void AudioEngineTest::queuedFlushOnlyDropsAudioQueuedBeforeIt()
+{
+    AudioEngine engine;
+    engine.initializeAudioComponents();
+    engine.m_audioReady = true;
+
+    const QByteArray packet = encodeFramePacket();
+    QVERIFY(!packet.isEmpty());
+    const auto* payload = reinterpret_cast<const unsigned char*>(packet.constData());
+    const int size = static_cast<int>(packet.size());
+
+    QVERIFY(engine.enqueueReceivedAudio(payload, size, 100, 0));
+    engine.drainReceivedAudio();
+    const unsigned oneFrame = engine.m_jitterBuffer.samplesInBuffer();
+    QVERIFY(oneFrame > 0);
+
+    // The end of one over and the start of the next arrive in one batch.
+    QVERIFY(engine.enqueueReceivedAudio(payload, size, 101, 20000));
+    engine.enqueueReceivedFlush();
+    QVERIFY(engine.enqueueReceivedAudio(payload, size, 7, 40000));
+    engine.drainReceivedAudio();
+
+    QCOMPARE(engine.m_lastAudioSeq, quint16(7));
+    QCOMPARE(engine.m_jitterBuffer.samplesInBuffer(), oneFrame);
+    QCOMPARE(engine.m_rxPacketQueue.size(), 0);
+}
+
 void AudioEngineTest::txGainLevelIsClampedAndApplied()
 {
     AudioEngine engine;
@@ -303,6 +841,229 @@ void AudioEngineTest::txGainLevelIsClampedAndApplied()
     QVERIFY(samples[1] < -0.39f);
 }
 
+void AudioEngineTest::txLookAheadTailIsEncodedOnDrain()
+{
+    AudioEngine engine;
+    configureEncoder(engine);
+    QSignalSpy latencySpy(&engine, &AudioEngine::txProcessingLatencyChanged);
+    QSignalSpy encodedSpy(&engine, &AudioEngine::audioDataEncoded);
+
+    engine.setTxLookAheadMs(100);
+    QCOMPARE(latencySpy.count(), 1);
+    QCOMPARE(latencySpy.at(0).at(0).toInt(), AudioEngine::FRAME_SIZE_MS);
+    QCOMPARE(engine.m_audioLimiter.latencySamples(), AudioEngine::FRAME_SIZE_SAMPLES);
+
+    // One frame in, one frame of the delay line's silence out.
+    engine.m_recording = true;
+    std::vector<float> samples(AudioEngine::FRAME_SIZE_SAMPLES, 0.25f);
+    engine.processCapturedFloatSamples(samples.data(), static_cast<int>(samples.size()));
+    QCOMPARE(encodedSpy.count(), 1);
+    QVERIFY(engine.m_pendingInputSamples.empty());
+
+    // Releasing PTT pushes the captured frame out instead of dropping it.
+    engine.m_recording = false;
+    engine.drainTxLimiter();
+    QCOMPARE(engine.m_pendingInputSamples.size(), samples.size());
+    QVERIFY(std::fabs(engine.m_pendingInputSamples.frame()[AudioEngine::FRAME_SIZE_SAMPLES - 1] - 0.25f) < 1.0e-4f);
+    engine.encodeReadyTxFrames();
+    QCOMPARE(encodedSpy.count(), 2);
+    QVERIFY(engine.m_pendingInputSamples.empty());
+}
+
+void AudioEngineTest::txLookAheadLatencyIsReportedWhenApplied()
+{
+    AudioEngine engine;
+    configureEncoder(engine);
+    QSignalSpy latencySpy(&engine, &AudioEngine::txProcessingLatencyChanged);
+
+    // Mid-transmission the limiter keeps its delay line, so nothing changes yet.
+    engine.m_recording = true;
+    engine.setTxLookAheadMs(5);
+    QCOMPARE(latencySpy.count(), 0);
+    QCOMPARE(engine.m_audioLimiter.latencySamples(), 0);
+
+    engine.m_recording = false;
+    engine.resetTxForTransmission();
+    QCOMPARE(latencySpy.count(), 1);
+    QCOMPARE(latencySpy.at(0).at(0).toInt(), 5);
+    QCOMPARE(engine.m_audioLimiter.latencySamples(), AudioEngine::FRAME_SIZE_SAMPLES / 4);
+
+    // The next transmission starts at the same latency; no repeat.
+    engine.resetTxForTransmission();
+    QCOMPARE(latencySpy.count(), 1);
+}
+
+void AudioEngineTest::txPacketizationPacksLongerFramesBetweenTransmissions()
+{
+    AudioEngine engine;
+    configureEncoder(engine);
+    QSignalSpy frameSizeSpy(&engine, &AudioEngine::txFrameSizeChanged);
+    QSignalSpy encodedSpy(&engine, &AudioEngine::audioDataEncoded);
+
+    engine.setTxPacketizationMs(60);
+    QCOMPARE(frameSizeSpy.count(), 1);
+    QCOMPARE(frameSizeSpy.at(0).at(0).toInt(), 60);
+
+    // One 60 ms packet for three 20 ms capture chunks, and a lead-in of
+    // one packet instead of two.
+    engine.m_recording = true;
+    engine.prepareTxStartupPriming();
+    engine.sendTxStartupLeadIn();
+    QCOMPARE(encodedSpy.count(), 1);
+    std::vector<float> samples(AudioEngine::FRAME_SIZE_SAMPLES, 0.25f);
+    for (int i = 0; i < 4; ++i) {
+        engine.processCapturedFloatSamples(samples.data(), static_cast<int>(samples.size()));
+    }
+    QCOMPARE(encodedSpy.count(), 2);
+    const QByteArray packet = encodedSpy.at(1).at(0).toByteArray();
+    QCOMPARE(opus_packet_get_nb_samples(reinterpret_cast<const unsigned char*>(packet.constData()),
+                                        packet.size(), AudioEngine::SAMPLE_RATE),
+             AudioEngine::MAX_FRAME_SIZE_SAMPLES);
+
+    // A change while transmitting waits for the next over.
+    engine.setTxPacketizationMs(20);
+    QCOMPARE(frameSizeSpy.count(), 1);
+    QCOMPARE(engine.m_txFrameSamples, AudioEngine::MAX_FRAME_SIZE_SAMPLES);
+
+    // The partial packet left at release is padded, not dropped.
+    engine.m_recording = false;
+    engine.flushPendingTxSamples();
+    QCOMPARE(encodedSpy.count(), 3);
+    QVERIFY(engine.m_pendingInputSamples.empty());
+
+    engine.applyTxEncoderSettings();
+    QCOMPARE(frameSizeSpy.count(), 2);
+    QCOMPARE(engine.m_txFrameSamples, AudioEngine::FRAME_SIZE_SAMPLES);
+}
+
+void AudioEngineTest::txDtxPausesNeedNoConcealmentAtReceiver()
+{
+    AudioEngine sender;
+    configureEncoder(sender);
+    sender.setTxDtxEnabled(true);
+    sender.m_recording = true;
+    QSignalSpy encodedSpy(&sender, &AudioEngine::audioDataEncoded);
+
+    // 1 s of voiced speech, 2 s of background noise with PTT still held,
+    // then 1 s of speech again.
+    constexpr int kFrames = 200;
+    constexpr double kPi = 3.14159265358979323846;
+    std::mt19937 rng(3);
+    std::normal_distribution<float> noise(0.0f, 0.002f);
+    std::vector<float> frame(AudioEngine::FRAME_SIZE_SAMPLES);
+    std::vector<qint64> sentAtUs;
+    int pausePackets = 0;
+    for (int i = 0; i < kFrames; ++i) {
+        const bool talking = i < 50 || i >= 150;
+        for (int n = 0; n < AudioEngine::FRAME_SIZE_SAMPLES; ++n) {
+            const double t = static_cast<double>(i * AudioEngine::FRAME_SIZE_SAMPLES + n) / AudioEngine::SAMPLE_RATE;
+            float sample = noise(rng);
+            if (talking) {
+                double voiced = 0.0;
+                for (int harmonic = 1; harmonic <= 12; ++harmonic) {
+                    voiced += std::sin(2.0 * kPi * 140.0 * harmonic * t) / harmonic;
+                }
+                sample += static_cast<float>(0.05 * (0.55 + 0.45 * std::sin(2.0 * kPi * 4.0 * t)) * voiced);
+            }
+            frame[static_cast<size_t>(n)] = sample;
+        }
+        const int before = encodedSpy.count();
+        sender.processCapturedFloatSamples(frame.data(), static_cast<int>(frame.size()));
+        for (int p = before; p < encodedSpy.count(); ++p) {
+            sentAtUs.push_back(static_cast<qint64>(i) * AudioEngine::FRAME_SIZE_MS * 1000);
+            pausePackets += talking ? 0 : 1;
+        }
+    }
+
+    // Speech goes out whole; the pause only its hangover and a keep-alive
+    // every 400 ms, well inside SvxReflector's 3 s talker timeout.
+    QCOMPARE(static_cast<int>(sentAtUs.size()) - pausePackets, 100);
+    QVERIFY2(pausePackets >= VoiceActivityDetector::HANGOVER_FRAMES + 3
+                 && pausePackets <= VoiceActivityDetector::HANGOVER_FRAMES + 5,
+             qPrintable(QString::number(pausePackets)));
+    for (size_t p = 1; p < sentAtUs.size(); ++p) {
+        QVERIFY(sentAtUs[p] - sentAtUs[p - 1] <= 400000);
+    }
+
+    // Sequence numbers run on across the pauses, so the receiver neither
+    // conceals nor counts loss, and does not mistake the gaps for jitter.
+    AudioEngine receiver;
+    receiver.initializeAudioComponents();
+    receiver.m_audioReady = true;
+    for (int p = 0; p < encodedSpy.count(); ++p) {
+        receiver.processReceivedAudio(encodedSpy.at(p).at(0).toByteArray(), static_cast<quint16>(p),
+                                      1000000 + sentAtUs[static_cast<size_t>(p)]);
+    }
+    QCOMPARE(receiver.m_rxLossFraction.load(), 0.0);
+    QCOMPARE(receiver.m_rxFecRecoveredFrames, quint64(0));
+    QCOMPARE(receiver.m_jitterEstimator.targetDelayMs(), 2 * AudioEngine::FRAME_SIZE_MS);
+}
+
+void AudioEngineTest::deviceRateCodecNeedsNoResamplers()
+{
+    // A 48 kHz microphone feeds the encoder directly; the bandwidth cap
+    // stays on and only the VAD gets a 16 kHz tap.
+    AudioEngine sender;
+    sender.initializeAudioComponents();
+    sender.setTxDtxEnabled(true);
+    sender.configureTxSampleRate(48000);
+    QCOMPARE(sender.m_txSampleRate, 48000);
+    QVERIFY(sender.m_inputResampler == nullptr);
+    QVERIFY(sender.m_txVadResampler != nullptr);
+    QCOMPARE(sender.m_txFrameSamples, 960);
+    QCOMPARE(sender.m_audioLimiter.sampleRate(), 48000);
+    opus_int32 maxBandwidth = 0;
+    QCOMPARE(opus_encoder_ctl(sender.m_encoder->m_encoder, OPUS_GET_MAX_BANDWIDTH(&maxBandwidth)), OPUS_OK);
+    QCOMPARE(maxBandwidth, OPUS_BANDWIDTH_MEDIUMBAND);
+
+    // Rates Opus does not take stay at 16 kHz behind the resampler.
+    AudioEngine fallback;
+    fallback.initializeAudioComponents();
+    fallback.configureTxSampleRate(44100);
+    QCOMPARE(fallback.m_txSampleRate, AudioEngine::SAMPLE_RATE);
+    QVERIFY(fallback.m_inputResampler != nullptr);
+
+    sender.m_recording = true;
+    QSignalSpy encodedSpy(&sender, &AudioEngine::audioDataEncoded);
+    constexpr int kFrames = 10;
+    constexpr double kPi = 3.14159265358979323846;
+    std::vector<float> frame(960);
+    for (int i = 0; i < kFrames; ++i) {
+        for (int n = 0; n < 960; ++n) {
+            const double t = static_cast<double>(i * 960 + n) / 48000.0;
+            double voiced = 0.0;
+            for (int harmonic = 1; harmonic <= 12; ++harmonic) {
+                voiced += std::sin(2.0 * kPi * 140.0 * harmonic * t) / harmonic;
+            }
+            frame[static_cast<size_t>(n)] = static_cast<float>(0.05 * voiced);
+        }
+        sender.processCapturedNativeFloatSamples(frame.data(), static_cast<int>(frame.size()), 48000);
+    }
+    QCOMPARE(encodedSpy.count(), kFrames);
+    QCOMPARE(sender.m_txDtxHeldPackets, quint64(0));
+    QVERIFY(sender.m_inputResampler == nullptr);
+
+    // A 48 kHz output decodes straight into the jitter buffer.
+    AudioEngine receiver;
+    receiver.initializeAudioComponents();
+    receiver.configureRxSampleRate(48000);
+    receiver.m_audioReady = true;
+    QCOMPARE(receiver.m_jitterBuffer.prebufSamples(),
+             static_cast<unsigned>(48 * receiver.m_jitterEstimator.targetDelayMs()));
+    for (int p = 0; p < encodedSpy.count(); ++p) {
+        receiver.processReceivedAudio(encodedSpy.at(p).at(0).toByteArray(), static_cast<quint16>(p),
+                                      1000000 + p * AudioEngine::FRAME_SIZE_MS * 1000);
+    }
+    QCOMPARE(receiver.m_lastDecodedFrameSamples, 960);
+    QCOMPARE(receiver.m_jitterBuffer.samplesInBuffer(), static_cast<unsigned>(kFrames * 960));
+
+    // The transcriber's tap is back at 16 kHz.
+    int tapSamples = 960;
+    AudioEngine::svxlinkRateTap(receiver.m_transcriptionResampler.get(), receiver.m_rxFrameBuffer.data(),
+                                tapSamples, receiver.m_transcriptionTapBuffer);
+    QCOMPARE(tapSamples, AudioEngine::FRAME_SIZE_SAMPLES);
+}
+
 QTEST_GUILESS_MAIN(AudioEngineTest)
 
 #include "tst_audio_engine.moc"
@@ -0,0 +1,117 @@
+#include <QtTest>
+
+#include "AudioFrameRing.h"
+
+#include <numeric>
+#include <vector>
+
+class AudioFrameRingTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void framesAreContiguousAcrossTheWrap();
+    void padsPartialFrameWithSilence();
+    void overflowDropsOldestWholeFrames();
+    void oversizedPushKeepsNewestSamples();
+    void configureRoundsCapacityToFrames();
+};
+
+namespace {
+std::vector<float> ramp(float first, int count)
+{
+    std::vector<float> samples(static_cast<size_t>(count));
+    std::iota(samples.begin(), samples.end(), first);
+    return samples;
+}
+}
+
+void AudioFrameRingTest::framesAreContiguousAcrossTheWrap()
+{
+    AudioFrameRing ring(4, 12);
+    float next = 0.0f;
+    float expected = 0.0f;
+
+    // Odd-sized writes walk the write position around the ring many times.
+    for (int round = 0; round < 20; ++round) {
+        const int count = 1 + round % 5;
+        const std::vector<float> samples = ramp(next, count);
+        QCOMPARE(ring.push(samples.data(), count), 0);
+        next += static_cast<float>(count);
+
+        while (ring.hasFrame()) {
+            const float* frame = ring.frame();
+            for (int i = 0; i < 4; ++i) {
+                QCOMPARE(frame[i], expected);
+                expected += 1.0f;
+            }
+            ring.popFrame();
+        }
+    }
+    QCOMPARE(ring.size(), static_cast<int>(next - expected));
+    QCOMPARE(ring.droppedSamples(), uint64_t(0));
+}
+
+void AudioFrameRingTest::padsPartialFrameWithSilence()
+{
+    AudioFrameRing ring(4, 8);
+    const std::vector<float> samples = ramp(1.0f, 6);
+    ring.push(samples.data(), 6);
+
+    QCOMPARE(ring.padToFrame(), 2);
+    QCOMPARE(ring.size(), 8);
+    ring.popFrame();
+    QCOMPARE(ring.frame()[1], 6.0f);
+    QCOMPARE(ring.frame()[2], 0.0f);
+    QCOMPARE(ring.frame()[3], 0.0f);
+    QCOMPARE(ring.padToFrame(), 0);
+}
+
+void AudioFrameRingTest::overflowDropsOldestWholeFrames()
+{
+    AudioFrameRing ring(4, 8);
+    const std::vector<float> first = ramp(0.0f, 7);
+    ring.push(first.data(), 7);
+
+    // Three more do not fit: the oldest frame goes, the partial one stays.
+    const std::vector<float> more = ramp(7.0f, 3);
+    QCOMPARE(ring.push(more.data(), 3), 4);
+    QCOMPARE(ring.droppedSamples(), uint64_t(4));
+    QCOMPARE(ring.size(), 6);
+    QVERIFY(ring.hasFrame());
+    QCOMPARE(ring.frame()[0], 4.0f);
+    QCOMPARE(ring.frame()[3], 7.0f);
+    ring.popFrame();
+    QVERIFY(!ring.hasFrame());
+    QCOMPARE(ring.size(), 2);
+}
+
+void AudioFrameRingTest::oversizedPushKeepsNewestSamples()
+{
+    AudioFrameRing ring(4, 8);
+    const std::vector<float> partial = ramp(100.0f, 2);
+    ring.push(partial.data(), 2);
+
+    const std::vector<float> burst = ramp(0.0f, 20);
+    QCOMPARE(ring.push(burst.data(), 20), 14);
+    QCOMPARE(ring.size(), 8);
+    QCOMPARE(ring.frame()[0], 12.0f);
+    ring.popFrame();
+    QCOMPARE(ring.frame()[3], 19.0f);
+}
+
+void AudioFrameRingTest::configureRoundsCapacityToFrames()
+{
+    AudioFrameRing ring;
+    ring.configure(960, 4000);
+    QCOMPARE(ring.frameSamples(), 960);
+    QCOMPARE(ring.capacity(), 4800);
+
+    ring.configure(320, 100);
+    QCOMPARE(ring.capacity(), 640);
+    QVERIFY(ring.empty());
+}
+
+QTEST_APPLESS_MAIN(AudioFrameRingTest)
+
+#include "tst_audio_frame_ring.moc"
@@ -2,7 +2,12 @@
 
 #include "AudioJitterBuffer.h"
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
 
 class AudioJitterBufferTest : public QObject
 {
@@ -13,6 +18,11 @@ private slots:
     void underrunReentersPrebufferForShortGaps();
     void resizeAndPrebufferClampResetState();
     void overflowDropsTheOldestHalfOfBufferedSamples();
+    void stalledConsumerKeepsTheNewestSamples();
+    void bulkTransfersWrapAroundTheRing();
+    void clearDropsBufferedSamplesWithoutTouchingReader();
+    void concurrentProducerConsumerPreservesSampleOrder();
+    void readLatencyUnderWriterContention();
 };
 
 void AudioJitterBufferTest::prebufferBlocksPlaybackUntilThresholdIsReached()
@@ -107,6 +117,157 @@ void AudioJitterBufferTest::overflowDropsTheOldestHalfOfBufferedSamples()
     QVERIFY(output == expected);
 }
 
+void AudioJitterBufferTest::stalledConsumerKeepsTheNewestSamples()
+{
+    // Write several ring's worth without reading: the producer must keep
+    // replacing the oldest audio instead of refusing the newest.
+    AudioJitterBuffer buffer(8);
+    std::array<float, 3> input{};
+    for (int i = 0; i < 40; ++i) {
+        for (size_t j = 0; j < input.size(); ++j)
+            input[j] = static_cast<float>(i * 3 + static_cast<int>(j));
+        buffer.writeSamples(input.data(), static_cast<int>(input.size()));
+    }
+
+    std::array<float, 8> output{};
+    const int read = buffer.readSamples(output.data(), static_cast<int>(output.size()));
+    QVERIFY(read > 0);
+    QVERIFY(read < 8);
+    for (int i = 1; i < read; ++i)
+        QCOMPARE(output[static_cast<size_t>(i)], output[static_cast<size_t>(i - 1)] + 1.0f);
+    QCOMPARE(output[static_cast<size_t>(read - 1)], 119.0f);
+}
+
+void AudioJitterBufferTest::bulkTransfersWrapAroundTheRing()
+{
+    AudioJitterBuffer buffer(8);
+    std::array<float, 5> input{};
+    std::array<float, 5> output{};
+
+    for (int round = 0; round < 10; ++round) {
+        for (size_t i = 0; i < input.size(); ++i)
+            input[i] = static_cast<float>(round * 10 + static_cast<int>(i));
+
+        buffer.writeSamples(input.data(), static_cast<int>(input.size()));
+        QCOMPARE(buffer.samplesInBuffer(), 5u);
+        QCOMPARE(buffer.readSamples(output.data(), static_cast<int>(output.size())), 5);
+        QVERIFY(output == input);
+    }
+}
+
+void AudioJitterBufferTest::clearDropsBufferedSamplesWithoutTouchingReader()
+{
+    AudioJitterBuffer buffer(8);
+    const std::array<float, 3> stale{1.0f, 2.0f, 3.0f};
+    const std::array<float, 2> fresh{7.0f, 8.0f};
+    std::array<float, 4> output{9.0f, 9.0f, 9.0f, 9.0f};
+
+    buffer.writeSamples(stale.data(), static_cast<int>(stale.size()));
+    buffer.clear();
+    QVERIFY(buffer.empty());
+
+    buffer.writeSamples(fresh.data(), static_cast<int>(fresh.size()));
+    QCOMPARE(buffer.readSamples(output.data(), static_cast<int>(output.size())), 2);
+
+    const std::array<float, 4> expected{7.0f, 8.0f, 0.0f, 0.0f};
+    QVERIFY(output == expected);
+}
+
+void AudioJitterBufferTest::concurrentProducerConsumerPreservesSampleOrder()
+{
+    constexpr int kFrameSamples = 320;
+    constexpr int kFrames = 4000;
+    AudioJitterBuffer buffer(kFrameSamples * 24);
+
+    std::atomic<bool> producerDone{false};
+    std::thread producer([&buffer, &producerDone]() {
+        std::vector<float> frame(kFrameSamples);
+        for (int f = 0; f < kFrames; ++f) {
+            for (int i = 0; i < kFrameSamples; ++i)
+                frame[static_cast<size_t>(i)] = static_cast<float>(f * kFrameSamples + i);
+            buffer.writeSamples(frame.data(), kFrameSamples);
+            if ((f & 7) == 0)
+                std::this_thread::yield();
+        }
+        producerDone.store(true, std::memory_order_release);
+    });
+
+    // Every sample the consumer sees must be newer than the previous one.
+    // Gaps are allowed (overflow drops), reordering or torn data is not.
+    std::vector<float> output(256);
+    float lastValue = -1.0f;
+    bool ordered = true;
+    int received = 0;
+    while (true) {
+        const bool done = producerDone.load(std::memory_order_acquire);
+        const int read = buffer.readSamples(output.data(), static_cast<int>(output.size()));
+        for (int i = 0; i < read; ++i) {
+            const float value = output[static_cast<size_t>(i)];
+            if (value <= lastValue)
+                ordered = false;
+            lastValue = value;
+        }
+        received += read;
+        if (done && read == 0 && buffer.empty())
+            break;
+    }
+    producer.join();
+
+    QVERIFY(ordered);
+    QVERIFY(received > 0);
+    QCOMPARE(lastValue, static_cast<float>(kFrames * kFrameSamples - 1));
+}
+
+void AudioJitterBufferTest::readLatencyUnderWriterContention()
+{
+    // The playback thread must never wait on the decode thread.  Hammer the
+    // buffer from a writer and record how long each reader call takes; with
+    // no lock the worst case is a copy, not a scheduler round-trip.  Every
+    // sample read must be one the writer wrote or underrun fill, never a
+    // torn or half-written slot.
+    constexpr int kFrameSamples = 320;
+    constexpr int kReads = 20000;
+    constexpr float kWritten = 0.25f;
+    // Far above a 320-sample copy, far below a scheduler quantum.
+    constexpr qint64 kMaxP99Ns = 1000000;
+    AudioJitterBuffer buffer(kFrameSamples * 24);
+
+    std::atomic<bool> stop{false};
+    std::thread writer([&buffer, &stop]() {
+        std::vector<float> frame(kFrameSamples, kWritten);
+        while (!stop.load(std::memory_order_relaxed))
+            buffer.writeSamples(frame.data(), kFrameSamples);
+    });
+
+    std::vector<float> output(kFrameSamples);
+    std::vector<qint64> latenciesNs;
+    latenciesNs.reserve(kReads);
+    qint64 samplesRead = 0;
+    int unexpectedSamples = 0;
+    for (int i = 0; i < kReads; ++i) {
+        const auto begin = std::chrono::steady_clock::now();
+        samplesRead += buffer.readSamples(output.data(), kFrameSamples);
+        const auto end = std::chrono::steady_clock::now();
+        latenciesNs.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+        unexpectedSamples += static_cast<int>(std::count_if(output.begin(), output.end(), [](float value) {
+            return value != kWritten && value != 0.0f;
+        }));
+    }
+    stop.store(true, std::memory_order_relaxed);
+    writer.join();
+
+    QCOMPARE(unexpectedSamples, 0);
+    QVERIFY(samplesRead > 0);
+
+    std::sort(latenciesNs.begin(), latenciesNs.end());
+    const qint64 p50 = latenciesNs[latenciesNs.size() / 2];
+    const qint64 p99 = latenciesNs[latenciesNs.size() * 99 / 100];
+    const qint64 maxNs = latenciesNs.back();
+    qInfo() << "readSamples under contention: p50" << p50 << "ns, p99" << p99
+            << "ns, max" << maxNs << "ns over" << kReads << "reads";
+    QVERIFY2(p99 < kMaxP99Ns, qPrintable(QStringLiteral("p99 read latency %1 ns").arg(p99)));
+}
+
 QTEST_APPLESS_MAIN(AudioJitterBufferTest)
 
 #include "tst_audio_jitter_buffer.moc"
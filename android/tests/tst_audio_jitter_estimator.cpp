@@ -0,0 +1,164 @@
+#include <QtTest>
+
+#include "AudioJitterEstimator.h"
+
+#include <cstdint>
+#include <random>
+
+class AudioJitterEstimatorTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void keepsInitialTargetUntilEnoughPackets();
+    void steadyArrivalsConvergeToMinimumTarget();
+    void jitteryArrivalsRaiseTarget();
+    void lowerUnderrunProbabilityNeedsDeeperBuffer();
+    void sequenceWrapDoesNotLookLikeJitter();
+    void newTalkSpurtKeepsStatistics();
+    void senderPausesDoNotLookLikeJitter();
+    void networkStallsStillRaiseTarget();
+};
+
+namespace {
+constexpr int64_t kFrameUs = 20000;
+
+void feedSteady(AudioJitterEstimator &estimator, int packets, uint16_t firstSequence = 0, int64_t startUs = 0)
+{
+    for (int i = 0; i < packets; ++i) {
+        estimator.addArrival(static_cast<uint16_t>(firstSequence + i), startUs + i * kFrameUs);
+    }
+}
+
+void feedJittery(AudioJitterEstimator &estimator, int packets, int maxExtraDelayUs, unsigned seed = 1)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> extraDelay(0, maxExtraDelayUs);
+    for (int i = 0; i < packets; ++i) {
+        estimator.addArrival(static_cast<uint16_t>(i), i * kFrameUs + extraDelay(rng));
+    }
+}
+}
+
+void AudioJitterEstimatorTest::keepsInitialTargetUntilEnoughPackets()
+{
+    AudioJitterEstimator estimator;
+    const int initialTarget = estimator.targetDelayMs();
+
+    feedSteady(estimator, 10);
+
+    QCOMPARE(estimator.targetDelayMs(), initialTarget);
+    QCOMPARE(estimator.packetCount(), 10);
+}
+
+void AudioJitterEstimatorTest::steadyArrivalsConvergeToMinimumTarget()
+{
+    AudioJitterEstimator estimator;
+    estimator.setTargetLimitsMs(40, 400);
+
+    feedSteady(estimator, 500);
+
+    QCOMPARE(estimator.targetDelayMs(), 40);
+    QVERIFY(estimator.jitterMs() < 0.01);
+}
+
+void AudioJitterEstimatorTest::jitteryArrivalsRaiseTarget()
+{
+    AudioJitterEstimator estimator;
+    estimator.setTargetLimitsMs(40, 400);
+
+    feedJittery(estimator, 1000, 100000);
+
+    // Uniform 0..100 ms extra delay, 2 % underrun: ~98 ms quantile + one frame.
+    QVERIFY2(estimator.targetDelayMs() >= 100 && estimator.targetDelayMs() <= 140,
+             qPrintable(QString::number(estimator.targetDelayMs())));
+    // RFC 3550 J for the difference of two uniform 0..a variables is ~a/3.
+    QVERIFY2(estimator.jitterMs() > 20.0 && estimator.jitterMs() < 45.0,
+             qPrintable(QString::number(estimator.jitterMs())));
+}
+
+void AudioJitterEstimatorTest::lowerUnderrunProbabilityNeedsDeeperBuffer()
+{
+    AudioJitterEstimator relaxed;
+    relaxed.setTargetLimitsMs(0, 600);
+    relaxed.setUnderrunProbability(0.2);
+    AudioJitterEstimator strict;
+    strict.setTargetLimitsMs(0, 600);
+    strict.setUnderrunProbability(0.01);
+
+    feedJittery(relaxed, 1000, 100000, 7);
+    feedJittery(strict, 1000, 100000, 7);
+
+    QVERIFY(strict.targetDelayMs() > relaxed.targetDelayMs());
+}
+
+void AudioJitterEstimatorTest::sequenceWrapDoesNotLookLikeJitter()
+{
+    AudioJitterEstimator estimator;
+    estimator.setTargetLimitsMs(40, 400);
+
+    feedSteady(estimator, 200, 65500);
+
+    QCOMPARE(estimator.targetDelayMs(), 40);
+    QVERIFY(estimator.jitterMs() < 0.01);
+}
+
+void AudioJitterEstimatorTest::newTalkSpurtKeepsStatistics()
+{
+    AudioJitterEstimator estimator;
+    estimator.setTargetLimitsMs(40, 400);
+    feedJittery(estimator, 500, 100000);
+    const int target = estimator.targetDelayMs();
+
+    // The next talker starts with an unrelated sequence number and clock offset.
+    estimator.startNewTalkSpurt();
+    estimator.addArrival(4242, 987654321);
+
+    QCOMPARE(estimator.targetDelayMs(), target);
+    QVERIFY(estimator.jitterMs() > 10.0);
+}
+
+void AudioJitterEstimatorTest::senderPausesDoNotLookLikeJitter()
+{
+    AudioJitterEstimator estimator;
+    estimator.setTargetLimitsMs(40, 400);
+
+    // DTX: talk spurts of 40 packets with 0.1 - 2 s pauses in between, and
+    // no sequence numbers skipped across the pauses.
+    uint16_t sequence = 0;
+    int64_t nowUs = 0;
+    for (int spurt = 0; spurt < 20; ++spurt) {
+        nowUs += (100 + spurt * 100) * 1000;
+        feedSteady(estimator, 40, sequence, nowUs);
+        sequence = static_cast<uint16_t>(sequence + 40);
+        nowUs += 40 * kFrameUs;
+    }
+
+    QCOMPARE(estimator.targetDelayMs(), 40);
+    QVERIFY2(estimator.jitterMs() < 1.0, qPrintable(QString::number(estimator.jitterMs())));
+}
+
+void AudioJitterEstimatorTest::networkStallsStillRaiseTarget()
+{
+    AudioJitterEstimator estimator;
+    estimator.setTargetLimitsMs(40, 400);
+
+    // Every 50th packet the network holds the stream for 100 ms and then
+    // delivers the backlog in a burst.
+    int64_t stallUs = 0;
+    for (int i = 0; i < 1000; ++i) {
+        const int64_t sentUs = i * kFrameUs;
+        if (i % 50 == 25) {
+            stallUs = sentUs + 100000;
+        }
+        estimator.addArrival(static_cast<uint16_t>(i), std::max(sentUs, stallUs));
+    }
+
+    // Five of every fifty packets are 20 - 100 ms late: the 2 % quantile
+    // sits around 60 ms.
+    QVERIFY2(estimator.targetDelayMs() >= 60, qPrintable(QString::number(estimator.targetDelayMs())));
+}
+
+QTEST_APPLESS_MAIN(AudioJitterEstimatorTest)
+
+#include "tst_audio_jitter_estimator.moc"
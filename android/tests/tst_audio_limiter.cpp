@@ -1,10 +1,13 @@
 #include <QtTest>
 
 #include "AudioLimiter.h"
+#include "ReferenceAudioLimiter.h"
 
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <random>
+#include <vector>
 
 class AudioLimiterTest : public QObject
 {
@@ -14,8 +17,77 @@ private slots:
     void silenceRemainsSilent();
     void belowThresholdSignalPassesThrough();
     void hotSignalIsAttenuated();
+    void tracksReferenceLimiterWithinHundredthOfDb();
+    void gainBlockCurveStaysCloseToPerSampleGain();
+    void lookAheadCatchesTransientWithoutOvershoot();
+    void lookAheadDelaysByLatencyAndFlushesWithSilence();
+    void sampleRateKeepsAttackAndReleaseTimes();
+    void agcRaisesQuietSpeechAndHoldsThroughPauses();
 };
 
+namespace {
+// Speech-like test signal: tones and noise bursts swept from -40 dBFS to
+// +6 dBFS with gaps of silence, so attack, hold and release all get hit.
+std::vector<float> dynamicSignal()
+{
+    std::mt19937 rng(7);
+    std::normal_distribution<float> noise(0.0f, 0.3f);
+    std::vector<float> samples;
+    for (int segment = 0; segment < 24; ++segment) {
+        const float amplitude = std::pow(10.0f, (-40.0f + 2.0f * segment) / 20.0f);
+        const int length = 800 + 157 * segment;
+        for (int i = 0; i < length; ++i) {
+            const float tone = std::sin(0.2f * i + segment) + (segment % 3 == 0 ? noise(rng) : 0.0f);
+            samples.push_back(amplitude * tone);
+        }
+        samples.insert(samples.end(), segment % 4 == 0 ? 1600 : 40, 0.0f);
+    }
+    return samples;
+}
+
+std::vector<float> tone(float amplitude, int count)
+{
+    std::vector<float> samples(static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        samples[static_cast<size_t>(i)] = amplitude * std::sin(0.3f * static_cast<float>(i));
+    }
+    return samples;
+}
+
+float peakOf(const std::vector<float>& samples)
+{
+    float peak = 0.0f;
+    for (float sample : samples) {
+        peak = std::max(peak, std::fabs(sample));
+    }
+    return peak;
+}
+
+void processInFrames(AudioLimiter& limiter, std::vector<float>& samples)
+{
+    for (size_t offset = 0; offset < samples.size(); offset += 320) {
+        limiter.processAudio(samples.data() + offset,
+                             std::min(320, static_cast<int>(samples.size() - offset)));
+    }
+}
+
+// Largest per-sample difference in applied gain, in dB.
+double maxGainDifferenceDb(const std::vector<float>& input,
+                           const std::vector<float>& expected,
+                           const std::vector<float>& actual)
+{
+    double worst = 0.0;
+    for (size_t i = 0; i < input.size(); ++i) {
+        if (std::fabs(input[i]) < 1.0e-4f) {
+            continue;
+        }
+        const double difference = 20.0 * std::log10(static_cast<double>(actual[i]) / expected[i]);
+        worst = std::max(worst, std::fabs(difference));
+    }
+    return worst;
+}
+}
+
 void AudioLimiterTest::silenceRemainsSilent()
 {
     AudioLimiter limiter;
@@ -53,6 +125,149 @@ void AudioLimiterTest::hotSignalIsAttenuated()
     QVERIFY(samples.back() < 0.7f);
 }
 
+void AudioLimiterTest::tracksReferenceLimiterWithinHundredthOfDb()
+{
+    const std::vector<float> input = dynamicSignal();
+    std::vector<float> expected = input;
+    std::vector<float> actual = input;
+
+    ReferenceAudioLimiter reference;
+    reference.processAudio(expected.data(), static_cast<int>(expected.size()));
+
+    // Odd chunk sizes exercise the SIMD tails and block boundaries.
+    AudioLimiter limiter;
+    const std::array<int, 5> chunks{320, 1, 7, 64, 203};
+    for (size_t offset = 0, chunk = 0; offset < actual.size(); ++chunk) {
+        const int count = std::min(chunks[chunk % chunks.size()], static_cast<int>(actual.size() - offset));
+        limiter.processAudio(actual.data() + offset, count);
+        offset += static_cast<size_t>(count);
+    }
+
+    const double worst = maxGainDifferenceDb(input, expected, actual);
+    QVERIFY2(worst < 0.01, qPrintable(QString::number(worst)));
+}
+
+void AudioLimiterTest::gainBlockCurveStaysCloseToPerSampleGain()
+{
+    const std::vector<float> input = dynamicSignal();
+    std::vector<float> expected = input;
+    std::vector<float> actual = input;
+
+    AudioLimiter perSample;
+    AudioLimiter perBlock;
+    perBlock.setGainBlockSize(16);
+    QCOMPARE(perBlock.gainBlockSize(), 16);
+    for (size_t offset = 0; offset < input.size(); offset += 320) {
+        const int count = std::min(320, static_cast<int>(input.size() - offset));
+        perSample.processAudio(expected.data() + offset, count);
+        perBlock.processAudio(actual.data() + offset, count);
+    }
+
+    const double worst = maxGainDifferenceDb(input, expected, actual);
+    QVERIFY2(worst < 0.5, qPrintable(QString::number(worst)));
+}
+
+void AudioLimiterTest::lookAheadCatchesTransientWithoutOvershoot()
+{
+    // Silence, then a full-scale burst: 6 dB over threshold, 0.6 dB over
+    // after 10:1 compression.
+    std::vector<float> input(1600, 0.0f);
+    const std::vector<float> burst = tone(1.0f, 3200);
+    input.insert(input.end(), burst.begin(), burst.end());
+    const float ceiling = std::pow(10.0f, (-6.0f + 0.6f) / 20.0f);
+
+    std::vector<float> feedForward = input;
+    AudioLimiter plain;
+    processInFrames(plain, feedForward);
+    QVERIFY(peakOf(feedForward) > ceiling * 1.3f);
+
+    std::vector<float> lookedAhead = input;
+    lookedAhead.resize(input.size() + 80, 0.0f);
+    AudioLimiter limiter;
+    limiter.setLookAheadSamples(80);
+    processInFrames(limiter, lookedAhead);
+    QVERIFY2(peakOf(lookedAhead) <= ceiling * 1.002f, qPrintable(QString::number(peakOf(lookedAhead))));
+
+    // Settles on the same 10:1 curve as the feed-forward limiter.
+    const std::vector<float> tail(lookedAhead.end() - 400, lookedAhead.end() - 80);
+    QVERIFY(peakOf(tail) > ceiling * 0.95f);
+}
+
+void AudioLimiterTest::lookAheadDelaysByLatencyAndFlushesWithSilence()
+{
+    AudioLimiter limiter;
+    limiter.setLookAheadSamples(1000);
+    QCOMPARE(limiter.lookAheadSamples(), AudioLimiter::MAX_LOOKAHEAD_SAMPLES);
+    limiter.setLookAheadSamples(160);
+    QCOMPARE(limiter.latencySamples(), 160);
+
+    // Below threshold: the limiter is a pure delay.
+    const std::vector<float> input = tone(0.25f, 500);
+    std::vector<float> output = input;
+    output.resize(input.size() + static_cast<size_t>(limiter.latencySamples()), 0.0f);
+    processInFrames(limiter, output);
+
+    for (int i = 0; i < 160; ++i) {
+        QCOMPARE(output[static_cast<size_t>(i)], 0.0f);
+    }
+    for (size_t i = 0; i < input.size(); ++i) {
+        QVERIFY(std::fabs(output[i + 160] - input[i]) < 1.0e-5f);
+    }
+
+    // reset() drops whatever was still in the delay line.
+    std::vector<float> more = tone(0.25f, 100);
+    limiter.processAudio(more.data(), static_cast<int>(more.size()));
+    limiter.reset();
+    std::vector<float> silence(200, 0.0f);
+    limiter.processAudio(silence.data(), static_cast<int>(silence.size()));
+    QCOMPARE(peakOf(silence), 0.0f);
+}
+
+void AudioLimiterTest::agcRaisesQuietSpeechAndHoldsThroughPauses()
+{
+    AudioLimiter limiter;
+    limiter.setAgcEnabled(true);
+
+    // -33 dBFS RMS: 15 dB under target, so the gain climbs for seconds.
+    std::vector<float> quiet = tone(0.0316f, 16000 * 8);
+    processInFrames(limiter, quiet);
+    const float raised = limiter.agcGainDb();
+    QVERIFY2(raised > 10.0f && raised <= AudioLimiter::AGC_MAX_GAIN_DB, qPrintable(QString::number(raised)));
+
+    std::vector<float> pause(16000 * 4, 0.0f);
+    processInFrames(limiter, pause);
+    QCOMPARE(limiter.agcGainDb(), raised);
+
+    // A hot talker pulls it back down within about a second.
+    std::vector<float> loud = tone(0.5f, 16000);
+    processInFrames(limiter, loud);
+    QVERIFY2(limiter.agcGainDb() < 0.0f, qPrintable(QString::number(limiter.agcGainDb())));
+
+    limiter.setAgcEnabled(false);
+    QCOMPARE(limiter.agcGainDb(), 0.0f);
+}
+
+void AudioLimiterTest::sampleRateKeepsAttackAndReleaseTimes()
+{
+    // 100 ms 6 dB over threshold, then 10 ms well below: the gain is still
+    // on its way back, and by as much at 48 kHz as at 16 kHz.
+    const auto gainAfterRelease = [](int sampleRate) {
+        AudioLimiter limiter;
+        limiter.setSampleRate(sampleRate);
+        const size_t samplesPerMs = static_cast<size_t>(sampleRate / 1000);
+        std::vector<float> samples(100 * samplesPerMs, 1.0f);
+        samples.resize(110 * samplesPerMs, 0.25f);
+        processInFrames(limiter, samples);
+        return samples.back() / 0.25f;
+    };
+
+    const float at16k = gainAfterRelease(16000);
+    const float at48k = gainAfterRelease(48000);
+    QVERIFY2(at16k < 0.8f, qPrintable(QString::number(at16k)));
+    const double differenceDb = 20.0 * std::log10(static_cast<double>(at48k) / at16k);
+    QVERIFY2(std::fabs(differenceDb) < 0.05, qPrintable(QString::number(differenceDb)));
+}
+
 QTEST_APPLESS_MAIN(AudioLimiterTest)
 
 #include "tst_audio_limiter.moc"
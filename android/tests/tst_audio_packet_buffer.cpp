@@ -0,0 +1,131 @@
+#include <QtTest>
+
+#include "AudioPacketBuffer.h"
+
+#include <array>
+#include <cstdint>
+
+class AudioPacketBufferTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void releasesInOrderPacketsImmediately();
+    void holdsPacketsBehindAGapUntilItFills();
+    void rejectsLateAndDuplicatePackets();
+    void reportsJumpsBeyondTheWindow();
+    void skipToDropsHeldPacketsBeforeTheNewAnchor();
+    void handlesSequenceWraparound();
+};
+
+namespace {
+AudioPacketBuffer::InsertResult insertPacket(AudioPacketBuffer &buffer, uint16_t sequence, int64_t arrivalUs = 0)
+{
+    const std::array<unsigned char, 3> payload{static_cast<unsigned char>(sequence & 0xff), 0x55, 0xaa};
+    return buffer.insert(sequence, payload.data(), static_cast<int>(payload.size()), arrivalUs);
+}
+}
+
+void AudioPacketBufferTest::releasesInOrderPacketsImmediately()
+{
+    AudioPacketBuffer buffer;
+
+    QCOMPARE(insertPacket(buffer, 100), AudioPacketBuffer::InsertResult::Accepted);
+    QVERIFY(buffer.next() != nullptr);
+    QCOMPARE(buffer.next()->sequence, uint16_t(100));
+    QCOMPARE(buffer.next()->payload.size(), size_t(3));
+    QCOMPARE(buffer.gapBeforeNextHeld(), 0);
+
+    buffer.advance();
+
+    QCOMPARE(buffer.heldCount(), 0);
+    QCOMPARE(buffer.nextSequence(), uint16_t(101));
+    QCOMPARE(buffer.gapBeforeNextHeld(), -1);
+}
+
+void AudioPacketBufferTest::holdsPacketsBehindAGapUntilItFills()
+{
+    AudioPacketBuffer buffer;
+    insertPacket(buffer, 10, 1000);
+    buffer.advance();
+
+    insertPacket(buffer, 13, 2000);
+    insertPacket(buffer, 12, 3000);
+
+    QVERIFY(buffer.next() == nullptr);
+    QCOMPARE(buffer.heldCount(), 2);
+    QCOMPARE(buffer.gapBeforeNextHeld(), 1);
+    QCOMPARE(buffer.oldestHeldArrivalUs(), int64_t(2000));
+
+    QCOMPARE(insertPacket(buffer, 11, 4000), AudioPacketBuffer::InsertResult::Accepted);
+
+    for (uint16_t expected = 11; expected <= 13; ++expected) {
+        QVERIFY(buffer.next() != nullptr);
+        QCOMPARE(buffer.next()->sequence, expected);
+        buffer.advance();
+    }
+    QCOMPARE(buffer.heldCount(), 0);
+}
+
+void AudioPacketBufferTest::rejectsLateAndDuplicatePackets()
+{
+    AudioPacketBuffer buffer;
+    insertPacket(buffer, 50);
+    buffer.advance();
+    insertPacket(buffer, 52);
+
+    QCOMPARE(insertPacket(buffer, 49), AudioPacketBuffer::InsertResult::Late);
+    QCOMPARE(insertPacket(buffer, 50), AudioPacketBuffer::InsertResult::Late);
+    QCOMPARE(insertPacket(buffer, 52), AudioPacketBuffer::InsertResult::Duplicate);
+    QCOMPARE(buffer.heldCount(), 1);
+}
+
+void AudioPacketBufferTest::reportsJumpsBeyondTheWindow()
+{
+    AudioPacketBuffer buffer(16);
+    insertPacket(buffer, 0);
+
+    QCOMPARE(insertPacket(buffer, 15), AudioPacketBuffer::InsertResult::Accepted);
+    QCOMPARE(insertPacket(buffer, 16), AudioPacketBuffer::InsertResult::TooFarAhead);
+    QCOMPARE(buffer.heldCount(), 2);
+}
+
+void AudioPacketBufferTest::skipToDropsHeldPacketsBeforeTheNewAnchor()
+{
+    AudioPacketBuffer buffer(16);
+    insertPacket(buffer, 0);
+    insertPacket(buffer, 3);
+    insertPacket(buffer, 5);
+
+    buffer.skipTo(4);
+
+    QCOMPARE(buffer.nextSequence(), uint16_t(4));
+    QCOMPARE(buffer.heldCount(), 1);
+    QCOMPARE(buffer.gapBeforeNextHeld(), 1);
+
+    buffer.skipTo(1000);
+
+    QCOMPARE(buffer.nextSequence(), uint16_t(1000));
+    QCOMPARE(buffer.heldCount(), 0);
+    QCOMPARE(insertPacket(buffer, 1000), AudioPacketBuffer::InsertResult::Accepted);
+}
+
+void AudioPacketBufferTest::handlesSequenceWraparound()
+{
+    AudioPacketBuffer buffer;
+    insertPacket(buffer, 65534);
+    buffer.advance();
+
+    QCOMPARE(insertPacket(buffer, 0), AudioPacketBuffer::InsertResult::Accepted);
+    QCOMPARE(insertPacket(buffer, 65535), AudioPacketBuffer::InsertResult::Accepted);
+
+    QCOMPARE(buffer.next()->sequence, uint16_t(65535));
+    buffer.advance();
+    QCOMPARE(buffer.next()->sequence, uint16_t(0));
+    buffer.advance();
+    QCOMPARE(buffer.heldCount(), 0);
+}
+
+QTEST_APPLESS_MAIN(AudioPacketBufferTest)
+
+#include "tst_audio_packet_buffer.moc"
@@ -0,0 +1,152 @@
+#include <QtTest>
+
+#include "AudioPacketQueue.h"
+
+#include <array>
+#include <cstdint>
+#include <thread>
+
+class AudioPacketQueueTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void deliversPacketsInPushOrder();
+    void dropsWhenFullAndCountsIt();
+    void rejectsOversizedPayloads();
+    void clearDiscardsQueuedPackets();
+    void flushMarkerKeepsItsPlaceInTheStream();
+    void producerAndConsumerThreadsSeeEveryPacket();
+};
+
+namespace {
+bool pushPacket(AudioPacketQueue &queue, uint16_t sequence, int64_t arrivalUs = 0)
+{
+    const std::array<unsigned char, 3> payload{static_cast<unsigned char>(sequence & 0xff),
+                                               static_cast<unsigned char>(sequence >> 8), 0xaa};
+    return queue.push(sequence, payload.data(), static_cast<int>(payload.size()), arrivalUs);
+}
+}
+
+void AudioPacketQueueTest::deliversPacketsInPushOrder()
+{
+    AudioPacketQueue queue(8);
+
+    QVERIFY(pushPacket(queue, 7, 1000));
+    QVERIFY(pushPacket(queue, 9, 2000));
+
+    QCOMPARE(queue.size(), 2);
+    QVERIFY(queue.front() != nullptr);
+    QCOMPARE(queue.front()->sequence, uint16_t(7));
+    QCOMPARE(queue.front()->arrivalUs, int64_t(1000));
+    QCOMPARE(queue.front()->size, 3);
+    QCOMPARE(queue.front()->payload[0], static_cast<unsigned char>(7));
+    queue.pop();
+
+    QCOMPARE(queue.front()->sequence, uint16_t(9));
+    queue.pop();
+
+    QVERIFY(queue.front() == nullptr);
+    QCOMPARE(queue.size(), 0);
+}
+
+void AudioPacketQueueTest::dropsWhenFullAndCountsIt()
+{
+    AudioPacketQueue queue(4);
+    QCOMPARE(queue.capacity(), 4);
+
+    for (uint16_t sequence = 0; sequence < 4; ++sequence) {
+        QVERIFY(pushPacket(queue, sequence));
+    }
+    QVERIFY(!pushPacket(queue, 4));
+
+    QCOMPARE(queue.droppedPackets(), uint64_t(1));
+    QCOMPARE(queue.size(), 4);
+    QCOMPARE(queue.front()->sequence, uint16_t(0));
+}
+
+void AudioPacketQueueTest::rejectsOversizedPayloads()
+{
+    AudioPacketQueue queue;
+    std::array<unsigned char, AudioPacketQueue::MAX_PAYLOAD_BYTES + 1> payload{};
+
+    QVERIFY(!queue.push(1, payload.data(), static_cast<int>(payload.size()), 0));
+    QVERIFY(queue.push(1, payload.data(), AudioPacketQueue::MAX_PAYLOAD_BYTES, 0));
+    QCOMPARE(queue.droppedPackets(), uint64_t(1));
+    QCOMPARE(queue.size(), 1);
+}
+
+void AudioPacketQueueTest::clearDiscardsQueuedPackets()
+{
+    AudioPacketQueue queue(8);
+    pushPacket(queue, 1);
+    pushPacket(queue, 2);
+
+    queue.clear();
+
+    QVERIFY(queue.front() == nullptr);
+    QVERIFY(pushPacket(queue, 3));
+    QCOMPARE(queue.front()->sequence, uint16_t(3));
+}
+
+void AudioPacketQueueTest::flushMarkerKeepsItsPlaceInTheStream()
+{
+    AudioPacketQueue queue(4);
+
+    QVERIFY(pushPacket(queue, 10));
+    QVERIFY(queue.pushFlush());
+    QVERIFY(pushPacket(queue, 1));
+
+    QVERIFY(!queue.front()->flush);
+    QCOMPARE(queue.front()->sequence, uint16_t(10));
+    queue.pop();
+    QVERIFY(queue.front()->flush);
+    QCOMPARE(queue.front()->size, 0);
+    queue.pop();
+    QVERIFY(!queue.front()->flush);
+    QCOMPARE(queue.front()->sequence, uint16_t(1));
+    queue.pop();
+
+    QVERIFY(pushPacket(queue, 2));
+    QVERIFY(pushPacket(queue, 3));
+    QVERIFY(pushPacket(queue, 4));
+    QVERIFY(pushPacket(queue, 5));
+    QVERIFY(!queue.pushFlush());
+}
+
+void AudioPacketQueueTest::producerAndConsumerThreadsSeeEveryPacket()
+{
+    AudioPacketQueue queue(16);
+    constexpr int kPackets = 20000;
+
+    std::thread producer([&queue]() {
+        for (int i = 0; i < kPackets; ++i) {
+            while (!pushPacket(queue, static_cast<uint16_t>(i), i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    int received = 0;
+    bool inOrder = true;
+    while (received < kPackets) {
+        const AudioPacketQueue::Packet* packet = queue.front();
+        if (packet == nullptr) {
+            std::this_thread::yield();
+            continue;
+        }
+        inOrder = inOrder && packet->sequence == static_cast<uint16_t>(received)
+                && packet->arrivalUs == received
+                && packet->payload[0] == static_cast<unsigned char>(received & 0xff);
+        queue.pop();
+        ++received;
+    }
+    producer.join();
+
+    QVERIFY(inOrder);
+    QCOMPARE(queue.size(), 0);
+}
+
+QTEST_APPLESS_MAIN(AudioPacketQueueTest)
+
+#include "tst_audio_packet_queue.moc"
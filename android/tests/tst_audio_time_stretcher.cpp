@@ -0,0 +1,161 @@
+#include <QtTest>
+
+#include "AudioJitterBuffer.h"
+#include "AudioTimeStretcher.h"
+
+#include <cmath>
+#include <vector>
+
+class AudioTimeStretcherTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void passesThroughAtTargetDepth();
+    void acceleratesWhenAboveTarget();
+    void deceleratesWhenBelowTarget();
+    void preservesPitchAndContinuity();
+    void returnsShortReadWhenSourceRunsDry();
+};
+
+namespace {
+constexpr int kSampleRate = 16000;
+constexpr int kFrame = 320;
+constexpr double kPi = 3.14159265358979323846;
+
+std::vector<float> tone(int count, double frequency, int offset = 0)
+{
+    std::vector<float> samples(static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        samples[static_cast<size_t>(i)] =
+                0.5f * static_cast<float>(std::sin(2.0 * kPi * frequency * (offset + i) / kSampleRate));
+    }
+    return samples;
+}
+
+// Keeps the jitter buffer at a constant depth while reading one frame per
+// step, and returns everything read.
+std::vector<float> playAtDepth(AudioJitterBuffer &buffer, AudioTimeStretcher &stretcher,
+                               int depthFrames, int steps, int &consumed)
+{
+    std::vector<float> output;
+    int written = 0;
+    const std::vector<float> source = tone(kFrame * (depthFrames + steps * 2), 200.0);
+    for (int step = 0; step < steps; ++step) {
+        while (static_cast<int>(buffer.samplesInBuffer()) < depthFrames * kFrame) {
+            buffer.writeSamples(source.data() + written, kFrame);
+            written += kFrame;
+        }
+        std::vector<float> frame(kFrame, 0.0f);
+        const int produced = stretcher.read(frame.data(), kFrame);
+        output.insert(output.end(), frame.begin(), frame.begin() + produced);
+    }
+    consumed = written - static_cast<int>(buffer.samplesInBuffer());
+    return output;
+}
+}
+
+void AudioTimeStretcherTest::passesThroughAtTargetDepth()
+{
+    AudioJitterBuffer buffer(kFrame * 24);
+    buffer.setPrebufSamples(kFrame * 4);
+    AudioTimeStretcher stretcher(&buffer, kSampleRate);
+
+    int consumed = 0;
+    const std::vector<float> output = playAtDepth(buffer, stretcher, 4, 100, consumed);
+
+    QCOMPARE(static_cast<int>(output.size()), kFrame * 100);
+    QCOMPARE(consumed, kFrame * 100);
+    QCOMPARE(stretcher.removedSamples(), int64_t(0));
+    QCOMPARE(stretcher.insertedSamples(), int64_t(0));
+
+    const std::vector<float> expected = tone(kFrame * 100, 200.0);
+    for (size_t i = 0; i < output.size(); ++i) {
+        QCOMPARE(output[i], expected[i]);
+    }
+}
+
+void AudioTimeStretcherTest::acceleratesWhenAboveTarget()
+{
+    AudioJitterBuffer buffer(kFrame * 24);
+    buffer.setPrebufSamples(kFrame * 2);
+    AudioTimeStretcher stretcher(&buffer, kSampleRate);
+
+    int consumed = 0;
+    const std::vector<float> output = playAtDepth(buffer, stretcher, 8, 200, consumed);
+
+    QCOMPARE(static_cast<int>(output.size()), kFrame * 200);
+    QVERIFY(stretcher.removedSamples() > 0);
+    QCOMPARE(stretcher.insertedSamples(), int64_t(0));
+    // Everything taken from the jitter buffer was played, cut, or is staged.
+    const int staged = static_cast<int>(stretcher.samplesReadyForPlayback() - buffer.samplesReadyForPlayback());
+    QCOMPARE(consumed, static_cast<int>(output.size() + stretcher.removedSamples()) + staged);
+    // Capped at a few percent of the output.
+    QVERIFY(stretcher.removedSamples() <= static_cast<int64_t>(output.size() * 0.06));
+}
+
+void AudioTimeStretcherTest::deceleratesWhenBelowTarget()
+{
+    AudioJitterBuffer buffer(kFrame * 24);
+    buffer.setPrebufSamples(kFrame * 6);
+    AudioTimeStretcher stretcher(&buffer, kSampleRate);
+
+    // Prime past the prebuffer, then keep the depth well below target.
+    const std::vector<float> prime = tone(kFrame * 6, 200.0);
+    buffer.writeSamples(prime.data(), static_cast<int>(prime.size()));
+    std::vector<float> frame(kFrame);
+    stretcher.read(frame.data(), kFrame);
+
+    int consumed = 0;
+    const std::vector<float> output = playAtDepth(buffer, stretcher, 3, 200, consumed);
+
+    QVERIFY(stretcher.insertedSamples() > 0);
+    QCOMPARE(stretcher.removedSamples(), int64_t(0));
+    QVERIFY(stretcher.insertedSamples() <= static_cast<int64_t>(output.size() * 0.06));
+}
+
+void AudioTimeStretcherTest::preservesPitchAndContinuity()
+{
+    AudioJitterBuffer buffer(kFrame * 24);
+    buffer.setPrebufSamples(kFrame * 2);
+    AudioTimeStretcher stretcher(&buffer, kSampleRate);
+
+    int consumed = 0;
+    const std::vector<float> output = playAtDepth(buffer, stretcher, 8, 200, consumed);
+    QVERIFY(stretcher.removedSamples() > 0);
+
+    // A 200 Hz tone at 0.5 amplitude moves at most ~0.04 per sample; a
+    // splice that is not period aligned would jump far more.
+    float maxStep = 0.0f;
+    int crossings = 0;
+    for (size_t i = 1; i < output.size(); ++i) {
+        maxStep = std::max(maxStep, std::fabs(output[i] - output[i - 1]));
+        if (output[i - 1] < 0.0f && output[i] >= 0.0f) {
+            ++crossings;
+        }
+    }
+    QVERIFY2(maxStep < 0.06f, qPrintable(QString::number(maxStep)));
+
+    const double seconds = static_cast<double>(output.size()) / kSampleRate;
+    const double frequency = crossings / seconds;
+    QVERIFY2(std::fabs(frequency - 200.0) < 3.0, qPrintable(QString::number(frequency)));
+}
+
+void AudioTimeStretcherTest::returnsShortReadWhenSourceRunsDry()
+{
+    AudioJitterBuffer buffer(kFrame * 24);
+    AudioTimeStretcher stretcher(&buffer, kSampleRate);
+
+    std::vector<float> frame(kFrame, 1.0f);
+    QCOMPARE(stretcher.read(frame.data(), kFrame), 0);
+
+    const std::vector<float> half = tone(kFrame / 2, 200.0);
+    buffer.writeSamples(half.data(), static_cast<int>(half.size()));
+
+    QCOMPARE(stretcher.read(frame.data(), kFrame), kFrame / 2);
+    QCOMPARE(stretcher.samplesReadyForPlayback(), 0u);
+}
+
+QTEST_APPLESS_MAIN(AudioTimeStretcherTest)
+
+#include "tst_audio_time_stretcher.moc"
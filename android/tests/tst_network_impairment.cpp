@@ -0,0 +1,227 @@
+#include <QtTest>
+
+#include "NetworkImpairment.h"
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class NetworkImpairmentTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void sameSeedReproducesTheSameRun();
+    void lossComesInBurstsAtTheGilbertElliottRate();
+    void jitterKeepsOrderUnlessAPacketIsReordered();
+    void duplicatesAreDeliveredTwice();
+    void bandwidthCapQueuesAndDropsPastTheLimit();
+    void streamRetransmitsLossesWithHeadOfLineBlocking();
+    void parsesProfilesWithOverrides();
+    void rejectsMalformedSpecs();
+};
+
+namespace {
+constexpr int64_t kFrameUs = 20000;
+constexpr int kPacketBytes = 60;
+
+NetworkImpairment::Config congested()
+{
+    NetworkImpairment::Config config;
+    NetworkImpairment::parse("lte-congested", config);
+    return config;
+}
+}
+
+void NetworkImpairmentTest::sameSeedReproducesTheSameRun()
+{
+    NetworkImpairment first(congested(), 42);
+    NetworkImpairment second(congested(), 42);
+    NetworkImpairment other(congested(), 43);
+
+    bool differs = false;
+    for (int i = 0; i < 2000; ++i) {
+        const NetworkImpairment::Delivery a = first.submit(i * kFrameUs, kPacketBytes);
+        const NetworkImpairment::Delivery b = second.submit(i * kFrameUs, kPacketBytes);
+        const NetworkImpairment::Delivery c = other.submit(i * kFrameUs, kPacketBytes);
+        QCOMPARE(a.copies, b.copies);
+        for (int copy = 0; copy < a.copies; ++copy) {
+            QCOMPARE(a.atUs[copy], b.atUs[copy]);
+        }
+        differs = differs || a.copies != c.copies || (a.copies > 0 && a.atUs[0] != c.atUs[0]);
+    }
+    QVERIFY(differs);
+
+    first.reset(42);
+    second.reset(42);
+    QCOMPARE(first.submit(0, kPacketBytes).atUs[0], second.submit(0, kPacketBytes).atUs[0]);
+    QCOMPARE(first.stats().packets, int64_t(1));
+}
+
+void NetworkImpairmentTest::lossComesInBurstsAtTheGilbertElliottRate()
+{
+    NetworkImpairment::Config config;
+    config.loss = 0.0;
+    config.burstLoss = 1.0;
+    config.burstEnter = 0.02;
+    config.burstExit = 0.25;
+    NetworkImpairment impairment(config, 7);
+
+    constexpr int kPackets = 200000;
+    int bursts = 0;
+    bool previousLost = false;
+    for (int i = 0; i < kPackets; ++i) {
+        const bool lost = impairment.submit(i * kFrameUs, kPacketBytes).copies == 0;
+        if (lost && !previousLost) {
+            ++bursts;
+        }
+        previousLost = lost;
+    }
+
+    // p / (p + r) of the packets, in bursts of 1 / r on average.
+    const double lossRate = double(impairment.stats().lost) / kPackets;
+    QVERIFY(std::abs(lossRate - impairment.expectedLoss()) < 0.01);
+    const double meanBurst = double(impairment.stats().lost) / bursts;
+    QVERIFY2(meanBurst > 3.5 && meanBurst < 4.5, qPrintable(QString::number(meanBurst)));
+}
+
+void NetworkImpairmentTest::jitterKeepsOrderUnlessAPacketIsReordered()
+{
+    NetworkImpairment::Config config;
+    config.delayMs = 50;
+    config.jitterMs = 40;
+    NetworkImpairment inOrder(config, 3);
+
+    int64_t previousUs = 0;
+    for (int i = 0; i < 5000; ++i) {
+        const NetworkImpairment::Delivery delivery = inOrder.submit(i * kFrameUs, kPacketBytes);
+        QCOMPARE(delivery.copies, 1);
+        QVERIFY(delivery.atUs[0] >= previousUs);
+        QVERIFY(delivery.atUs[0] >= i * kFrameUs);
+        previousUs = delivery.atUs[0];
+    }
+
+    config.reorder = 0.05;
+    NetworkImpairment reordering(config, 3);
+    int overtaken = 0;
+    previousUs = 0;
+    for (int i = 0; i < 5000; ++i) {
+        const NetworkImpairment::Delivery delivery = reordering.submit(i * kFrameUs, kPacketBytes);
+        if (delivery.atUs[0] < previousUs) {
+            ++overtaken;
+        }
+        previousUs = std::max(previousUs, delivery.atUs[0]);
+    }
+    QVERIFY(reordering.stats().reordered > 150);
+    QVERIFY(overtaken > 150);
+    QVERIFY(overtaken <= reordering.stats().reordered);
+}
+
+void NetworkImpairmentTest::duplicatesAreDeliveredTwice()
+{
+    NetworkImpairment::Config config;
+    config.delayMs = 30;
+    config.duplicate = 0.1;
+    NetworkImpairment impairment(config, 11);
+
+    int copies = 0;
+    for (int i = 0; i < 10000; ++i) {
+        const NetworkImpairment::Delivery delivery = impairment.submit(i * kFrameUs, kPacketBytes);
+        copies += delivery.copies;
+        if (delivery.copies == 2) {
+            QVERIFY(delivery.atUs[1] >= i * kFrameUs);
+        }
+    }
+
+    QCOMPARE(int64_t(copies), 10000 + impairment.stats().duplicated);
+    QVERIFY(impairment.stats().duplicated > 800 && impairment.stats().duplicated < 1200);
+}
+
+void NetworkImpairmentTest::bandwidthCapQueuesAndDropsPastTheLimit()
+{
+    NetworkImpairment::Config config;
+    config.rateKbps = 64;
+    config.queueLimitMs = 100;
+    NetworkImpairment impairment(config, 1);
+
+    // 1000 bytes take 125 ms at 64 kbit/s.
+    NetworkImpairment::Delivery delivery = impairment.submit(0, 1000);
+    QCOMPARE(delivery.atUs[0], int64_t(125000));
+    delivery = impairment.submit(0, 100);
+    QCOMPARE(delivery.copies, 0);
+    QCOMPARE(impairment.stats().overflowed, int64_t(1));
+
+    // Within the limit, the packet waits for the link.
+    delivery = impairment.submit(30000, 100);
+    QCOMPARE(delivery.atUs[0], int64_t(125000 + 12500));
+}
+
+void NetworkImpairmentTest::streamRetransmitsLossesWithHeadOfLineBlocking()
+{
+    NetworkImpairment::Config config;
+    config.delayMs = 40;
+    config.jitterMs = 20;
+    config.loss = 0.05;
+    NetworkImpairment impairment(config, 5);
+
+    int64_t previousUs = 0;
+    int64_t largestGapUs = 0;
+    for (int i = 0; i < 5000; ++i) {
+        const int64_t atUs = impairment.submitStream(i * kFrameUs, kPacketBytes);
+        QVERIFY(atUs >= previousUs);
+        QVERIFY(atUs >= i * kFrameUs);
+        largestGapUs = std::max(largestGapUs, atUs - i * kFrameUs);
+        previousUs = atUs;
+    }
+
+    QCOMPARE(impairment.stats().lost, int64_t(0));
+    QVERIFY(impairment.stats().retransmitted > 150);
+    QVERIFY(largestGapUs >= 200000);
+}
+
+void NetworkImpairmentTest::parsesProfilesWithOverrides()
+{
+    NetworkImpairment::Config config;
+    std::string error;
+    QVERIFY(NetworkImpairment::parse("lte, delay=120, dist=pareto, burst-exit=0.5, rate=96", config, &error));
+    QCOMPARE(config.delayMs, 120);
+    QCOMPARE(config.jitterMs, 15);
+    QCOMPARE(config.distribution, NetworkImpairment::DelayDistribution::Pareto);
+    QCOMPARE(config.burstExit, 0.5);
+    QCOMPARE(config.rateKbps, 96);
+
+    QVERIFY(NetworkImpairment::parse("jitter=5", config, &error));
+    QCOMPARE(config.delayMs, 120);
+    QCOMPARE(config.jitterMs, 5);
+
+    QVERIFY(NetworkImpairment::parse("clean", config, &error));
+    QCOMPARE(config.delayMs, 0);
+    QCOMPARE(NetworkImpairment(config).expectedLoss(), 0.0);
+}
+
+void NetworkImpairmentTest::rejectsMalformedSpecs()
+{
+    NetworkImpairment::Config config;
+    config.delayMs = 33;
+    std::string error;
+
+    const std::vector<std::string> specs = {
+        "satellite",
+        "delay=10,lte",
+        "loss=1.5",
+        "delay=-1",
+        "jitter=ten",
+        "dist=gamma",
+        "latency=5",
+    };
+    for (const std::string &spec : specs) {
+        error.clear();
+        QVERIFY2(!NetworkImpairment::parse(spec, config, &error), spec.c_str());
+        QVERIFY(!error.empty());
+    }
+    QCOMPARE(config.delayMs, 33);
+}
+
+QTEST_APPLESS_MAIN(NetworkImpairmentTest)
+#include "tst_network_impairment.moc"
@@ -0,0 +1,201 @@
+#include <QtTest>
+
+#include "OpusEncoderController.h"
+
+using Bandwidth = OpusEncoderController::Bandwidth;
+using Transport = OpusEncoderController::Transport;
+
+class OpusEncoderControllerTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void defaultsMatchSvxlinkProfile();
+    void meteredAndCellularLinksSaveData();
+    void lossSizesFecAndNarrowsBandwidthWithHysteresis();
+    void sendErrorsBackOffAndRecoverSlowly();
+    void slowEncodesLowerComplexity();
+    void packetizationFollowsLinkUnlessFixed();
+};
+
+void OpusEncoderControllerTest::defaultsMatchSvxlinkProfile()
+{
+    OpusEncoderController controller;
+    controller.setTransport(Transport::Wifi, false);
+
+    QVERIFY(!controller.update());
+    const OpusEncoderController::Settings& settings = controller.settings();
+    QCOMPARE(settings.bitrate, 20000);
+    QCOMPARE(settings.bandwidth, Bandwidth::Mediumband);
+    QCOMPARE(settings.complexity, 10);
+    QVERIFY(!settings.inbandFec);
+    QCOMPARE(settings.expectedLossPercent, 0);
+}
+
+void OpusEncoderControllerTest::meteredAndCellularLinksSaveData()
+{
+    OpusEncoderController controller;
+
+    controller.setTransport(Transport::Cellular, false);
+    QVERIFY(controller.update());
+    QCOMPARE(controller.settings().bitrate, OpusEncoderController::CELLULAR_BITRATE);
+    QCOMPARE(controller.settings().bandwidth, Bandwidth::Mediumband);
+
+    controller.setTransport(Transport::Wifi, true);
+    QVERIFY(controller.update());
+    QCOMPARE(controller.settings().bitrate, OpusEncoderController::METERED_BITRATE);
+
+    // No FEC headroom on a metered link, however lossy.
+    controller.setFecEnabled(true);
+    controller.setLossFraction(0.08);
+    controller.update();
+    QCOMPARE(controller.settings().bitrate, OpusEncoderController::METERED_BITRATE);
+    QCOMPARE(controller.settings().expectedLossPercent, 8);
+
+    controller.setTransport(Transport::Ethernet, false);
+    controller.setFecEnabled(false);
+    controller.setLossFraction(0.0);
+    QVERIFY(controller.update());
+    QCOMPARE(controller.settings().bitrate, OpusEncoderController::DEFAULT_BITRATE);
+}
+
+void OpusEncoderControllerTest::lossSizesFecAndNarrowsBandwidthWithHysteresis()
+{
+    OpusEncoderController controller;
+    controller.setTransport(Transport::Wifi, false);
+    controller.setFecEnabled(true);
+
+    QVERIFY(controller.update());
+    QVERIFY(controller.settings().inbandFec);
+    QCOMPARE(controller.settings().expectedLossPercent, 2);
+    QCOMPARE(controller.settings().bitrate, 20000);
+
+    controller.setLossFraction(0.07);
+    controller.update();
+    QCOMPARE(controller.settings().expectedLossPercent, 7);
+    QCOMPARE(controller.settings().bitrate, 24000);
+    QCOMPARE(controller.settings().bandwidth, Bandwidth::Mediumband);
+
+    controller.setLossFraction(0.12);
+    controller.update();
+    QCOMPARE(controller.settings().bandwidth, Bandwidth::Narrowband);
+
+    // Stays narrow until loss is well below where it narrowed.
+    controller.setLossFraction(0.08);
+    controller.update();
+    QCOMPARE(controller.settings().bandwidth, Bandwidth::Narrowband);
+    controller.setLossFraction(0.05);
+    controller.update();
+    QCOMPARE(controller.settings().bandwidth, Bandwidth::Mediumband);
+
+    controller.setLossFraction(0.9);
+    controller.update();
+    QCOMPARE(controller.settings().expectedLossPercent, 25);
+    QCOMPARE(controller.settings().bitrate, OpusEncoderController::MAX_BITRATE);
+}
+
+void OpusEncoderControllerTest::sendErrorsBackOffAndRecoverSlowly()
+{
+    OpusEncoderController controller;
+    controller.setTransport(Transport::Cellular, false);
+    controller.update();
+
+    controller.reportSendErrors(3);
+    QVERIFY(controller.update());
+    QCOMPARE(controller.settings().bitrate, 14000);
+    controller.reportSendErrors(5);
+    controller.update();
+    QCOMPARE(controller.settings().bitrate, 12000);
+    controller.reportSendErrors(9);
+    controller.update();
+    QCOMPARE(controller.settings().bitrate, 10000);
+    QCOMPARE(controller.settings().bandwidth, Bandwidth::Narrowband);
+
+    // The counter did not move: clean intervals, one step back per ten.
+    for (int i = 0; i < 9; ++i) {
+        controller.reportSendErrors(9);
+        QVERIFY(!controller.update());
+    }
+    controller.reportSendErrors(9);
+    QVERIFY(controller.update());
+    QCOMPARE(controller.settings().bitrate, 12000);
+
+    // A new sender restarting its count is not read as a burst of errors.
+    controller.reportSendErrors(0);
+    controller.update();
+    QVERIFY(controller.settings().bitrate >= 12000);
+
+    for (int i = 0; i < 20; ++i) {
+        controller.reportSendErrors(static_cast<uint64_t>(i + 1));
+        controller.update();
+    }
+    QCOMPARE(controller.settings().bitrate, OpusEncoderController::MIN_BITRATE);
+}
+
+void OpusEncoderControllerTest::slowEncodesLowerComplexity()
+{
+    OpusEncoderController controller;
+    controller.update();
+
+    for (int interval = 0; interval < 4; ++interval) {
+        for (int frame = 0; frame < OpusEncoderController::UPDATE_INTERVAL_FRAMES; ++frame) {
+            controller.reportEncodeTime(9000, 20000);
+        }
+        controller.update();
+    }
+    QVERIFY(controller.settings().complexity < 10);
+    const int lowered = controller.settings().complexity;
+    QVERIFY(lowered >= OpusEncoderController::MIN_COMPLEXITY);
+
+    for (int interval = 0; interval < 20; ++interval) {
+        for (int frame = 0; frame < OpusEncoderController::UPDATE_INTERVAL_FRAMES; ++frame) {
+            controller.reportEncodeTime(500, 20000);
+        }
+        controller.update();
+    }
+    QCOMPARE(controller.settings().complexity, OpusEncoderController::MAX_COMPLEXITY);
+}
+
+void OpusEncoderControllerTest::packetizationFollowsLinkUnlessFixed()
+{
+    OpusEncoderController controller;
+    controller.setTransport(Transport::Cellular, false);
+    controller.update();
+    QCOMPARE(controller.settings().frameSizeMs, 20);
+
+    controller.setRoundTripMs(180);
+    QVERIFY(controller.update());
+    QCOMPARE(controller.settings().frameSizeMs, 40);
+
+    controller.setRoundTripMs(320);
+    QVERIFY(controller.update());
+    QCOMPARE(controller.settings().frameSizeMs, 60);
+
+    controller.setRoundTripMs(40);
+    QVERIFY(controller.update());
+    QCOMPARE(controller.settings().frameSizeMs, 20);
+
+    controller.setTransport(Transport::Cellular, true);
+    QVERIFY(controller.update());
+    QCOMPARE(controller.settings().frameSizeMs, 60);
+
+    // A fixed choice wins over the link, rounded to a whole 20 ms frame.
+    controller.setPacketization(20);
+    QVERIFY(controller.update());
+    QCOMPARE(controller.settings().frameSizeMs, 20);
+    controller.setPacketization(45);
+    QCOMPARE(controller.packetization(), 40);
+    controller.setPacketization(100);
+    QCOMPARE(controller.packetization(), 60);
+    controller.setPacketization(0);
+    QCOMPARE(controller.packetization(), 0);
+
+    // 50 packets/s of headers at 20 ms, a third of that at 60 ms.
+    QCOMPARE(OpusEncoderController::overheadBytesPerSecond(20), 1800);
+    QCOMPARE(OpusEncoderController::overheadBytesPerSecond(40), 900);
+    QCOMPARE(OpusEncoderController::overheadBytesPerSecond(60), 600);
+}
+
+QTEST_APPLESS_MAIN(OpusEncoderControllerTest)
+
+#include "tst_opus_encoder_controller.moc"
@@ -102,7 +102,6 @@ private slots:
     void languageUnavailableErrorDisablesLiveTranscription();
     void sanitizeCustomNodeInfoEntriesDropsReservedAndEmptyValues();
     void setAudioRouteStateNormalizesAndOrdersRoutes();
-    void shouldHandleTalkerStartUsesPriorityRules();
     void talkgroupSelectionTimeoutRevertsToMonitorMode();
     void sendProtoVerWritesExpectedFrame();
     void authChallengeFrameProducesAuthResponse();
@@ -111,6 +110,7 @@ private slots:
     void nodeListFrameDecodesLengthPrefixedEntries();
     void nodeJoinLeaveFramesDecodeLengthPrefixedCallsigns();
     void malformedNodeFramesAreIgnoredWithoutDisconnect();
+    void framesSplitAcrossReadsAreReassembled();
     void validatedNetworkLossMovesClientToWaitingState();
     void validatedNetworkRestorationSchedulesImmediateReconnect();
     void validatedRouteChangeForcesReconnect();
@@ -133,6 +133,8 @@ private:
     QByteArray framedPayload(const QByteArray &payload) const;
     QByteArray decodeSingleOutgoingPayload(FakeTcpSocket *socket) const;
     void feedIncomingPayload(ReflectorClient &client, FakeTcpSocket *socket, const QByteArray &payload);
+    QByteArray heartbeatPayload() const;
+    void markConnected(ReflectorClient &client, quint32 talkgroup);
 };
 
 FakeTcpSocket *ReflectorClientTest::installFakeTcpSocket(ReflectorClient &client)
@@ -181,11 +183,26 @@ void ReflectorClientTest::feedIncomingPayload(ReflectorClient &client, FakeTcpSo
     client.onTcpReadyRead();
 }
 
+QByteArray ReflectorClientTest::heartbeatPayload() const
+{
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::BigEndian);
+    stream << quint16(Svxlink::MsgType::HEARTBEAT);
+    return payload;
+}
+
+void ReflectorClientTest::markConnected(ReflectorClient &client, quint32 talkgroup)
+{
+    client.m_state = ReflectorClient::Connected;
+    client.m_session.m_state = ReflectorSession::State::Connected;
+    client.m_session.m_talkgroup = talkgroup;
+}
+
 void ReflectorClientTest::parseMonitoredTalkgroupsSpecNormalizesEntries()
 {
     const auto parsed = ReflectorClient::parseMonitoredTalkgroupsSpec(
-        QStringLiteral("  3100+, abc, 0, 3200++, 3100, 91+++ "),
-        9);
+        QStringLiteral("  3100+, abc, 0, 3200++, 3100, 91+++ "));
 
     QCOMPARE(parsed.normalizedSpec, QStringLiteral("3100+,3200++,91+++"));
     QCOMPARE(parsed.configured.size(), 3);
@@ -195,7 +212,6 @@ void ReflectorClientTest::parseMonitoredTalkgroupsSpecNormalizesEntries()
     QCOMPARE(parsed.configured.at(1).priority, quint8(2));
     QCOMPARE(parsed.configured.at(2).talkgroup, 91u);
     QCOMPARE(parsed.configured.at(2).priority, quint8(3));
-    QCOMPARE(parsed.activeTalkgroups, QList<quint32>({9u, 3100u, 3200u, 91u}));
 }
 
 void ReflectorClientTest::updateProfileConfigurationNormalizesTalkgroupTimeout()
@@ -203,8 +219,8 @@ void ReflectorClientTest::updateProfileConfigurationNormalizesTalkgroupTimeout()
     ReflectorClient client;
 
     client.updateProfileConfiguration(91, QStringLiteral("3100+"), 45);
-    QCOMPARE(client.m_defaultTalkgroup, 91u);
-    QCOMPARE(client.m_monitoredTalkgroups, QList<quint32>({91u, 3100u}));
+    QCOMPARE(client.m_session.defaultTalkgroup(), 91u);
+    QCOMPARE(client.m_session.monitoredTalkgroups(), std::vector<uint32_t>({91u, 3100u}));
     QCOMPARE(client.m_tgSelectTimeoutSeconds, 45);
 
     client.updateProfileConfiguration(91, QStringLiteral("3100+"), 0);
@@ -407,7 +423,7 @@ void ReflectorClientTest::androidNetworkHandoverWhilePttActiveQueuesResume()
     client.m_port = 5337;
     client.m_authKey = QByteArrayLiteral("secret");
     client.m_callsign = QStringLiteral("YO6SAY");
-    client.m_talkgroup = 9;
+    client.m_session.m_talkgroup = 9;
     client.m_state = ReflectorClient::Connected;
     client.m_pttActive = true;
 
@@ -697,51 +713,29 @@ void ReflectorClientTest::setAudioRouteStateNormalizesAndOrdersRoutes()
     QCOMPARE(client.m_currentAudioRoute, QStringLiteral("speaker"));
 }
 
-void ReflectorClientTest::shouldHandleTalkerStartUsesPriorityRules()
-{
-    ReflectorClient client;
-    client.m_state = ReflectorClient::Connected;
-    client.m_defaultTalkgroup = 91;
-    client.applyMonitoredTalkgroups(QStringLiteral("3100+,3200++"));
-
-    client.m_talkgroup = 0;
-    client.m_usePriorityMode = true;
-    QVERIFY(client.shouldHandleTalkerStart(3100));
-    QCOMPARE(client.m_talkgroup, 3100u);
-
-    client.m_talkgroup = 3100;
-    client.m_usePriorityMode = true;
-    QVERIFY(client.shouldHandleTalkerStart(3200));
-    QCOMPARE(client.m_talkgroup, 3200u);
-
-    client.m_talkgroup = 3100;
-    client.m_usePriorityMode = false;
-    QVERIFY(!client.shouldHandleTalkerStart(3200));
-    QCOMPARE(client.m_talkgroup, 3100u);
-}
-
 void ReflectorClientTest::talkgroupSelectionTimeoutRevertsToMonitorMode()
 {
     ReflectorClient client;
     installFakeTcpSocket(client);
 
-    client.m_state = ReflectorClient::Connected;
-    client.m_talkgroup = 91;
+    markConnected(client, 91);
     client.updateProfileConfiguration(91, QStringLiteral("3100+"), 2);
 
-    QVERIFY(client.m_talkgroupSelectionTimer->isActive());
-    QCOMPARE(client.m_tgSelectTimeoutCounter, 2);
+    QVERIFY(client.m_session.talkgroupSelectionTimerActive());
+    QVERIFY(client.m_sessionTimer->isActive());
+    QCOMPARE(client.m_session.talkgroupSelectSecondsLeft(), 2);
     QCOMPARE(client.m_connectionStatus, QStringLiteral("Connected to TG 91"));
 
-    client.onTalkgroupSelectionTimer();
-    QCOMPARE(client.m_talkgroup, 91u);
-    QCOMPARE(client.m_tgSelectTimeoutCounter, 1);
+    const qint64 startMs = client.sessionNowMs();
+    client.advanceSession(startMs + ReflectorSession::TALKGROUP_SELECTION_TICK_MS);
+    QCOMPARE(client.m_session.selectedTalkgroup(), 91u);
+    QCOMPARE(client.m_session.talkgroupSelectSecondsLeft(), 1);
 
-    client.onTalkgroupSelectionTimer();
-    QCOMPARE(client.m_talkgroup, 0u);
+    client.advanceSession(startMs + 2 * ReflectorSession::TALKGROUP_SELECTION_TICK_MS);
+    QCOMPARE(client.m_session.selectedTalkgroup(), 0u);
     QCOMPARE(client.m_connectionStatus, QStringLiteral("Connected in monitor mode"));
-    QCOMPARE(client.m_tgSelectTimeoutCounter, 0);
-    QVERIFY(!client.m_talkgroupSelectionTimer->isActive());
+    QCOMPARE(client.m_session.talkgroupSelectSecondsLeft(), 0);
+    QVERIFY(!client.m_session.talkgroupSelectionTimerActive());
 }
 
 void ReflectorClientTest::sendProtoVerWritesExpectedFrame()
@@ -749,7 +743,8 @@ void ReflectorClientTest::sendProtoVerWritesExpectedFrame()
     ReflectorClient client;
     FakeTcpSocket *socket = installFakeTcpSocket(client);
 
-    client.sendProtoVer();
+    client.m_session.transportConnected(client.sessionNowMs());
+    client.drainSession();
 
     const QByteArray payload = decodeSingleOutgoingPayload(socket);
     QVERIFY(!payload.isEmpty());
@@ -773,6 +768,7 @@ void ReflectorClientTest::authChallengeFrameProducesAuthResponse()
 
     client.m_authKey = QByteArray("secret");
     client.m_callsign = QStringLiteral("YO6SAY");
+    client.configureSession();
 
     QByteArray challenge(Svxlink::Protocol::CHALLENGE_LEN, '\0');
     for (int i = 0; i < challenge.size(); ++i)
@@ -818,6 +814,7 @@ void ReflectorClientTest::errorFrameClearsCachedAuthKey()
 
     client.m_state = ReflectorClient::Authenticating;
     client.m_authKey = QByteArray("secret");
+    client.configureSession();
 
     QByteArray payload;
     QDataStream stream(&payload, QIODevice::WriteOnly);
@@ -840,8 +837,7 @@ void ReflectorClientTest::requestQsyFrameUpdatesTalkgroupAndResponds()
     FakeTcpSocket *socket = installFakeTcpSocket(client);
     QSignalSpy qsySpy(&client, &ReflectorClient::qsyRequested);
 
-    client.m_state = ReflectorClient::Connected;
-    client.m_talkgroup = 91;
+    markConnected(client, 91);
     client.refreshConnectionStatus();
     QCOMPARE(client.m_connectionStatus, QStringLiteral("Connected to TG 91"));
 
@@ -854,7 +850,7 @@ void ReflectorClientTest::requestQsyFrameUpdatesTalkgroupAndResponds()
 
     QCOMPARE(qsySpy.count(), 1);
     QCOMPARE(qsySpy.at(0).at(0).toUInt(), 3200u);
-    QCOMPARE(client.m_talkgroup, 3200u);
+    QCOMPARE(client.m_session.selectedTalkgroup(), 3200u);
     QCOMPARE(client.m_connectionStatus, QStringLiteral("Connected to TG 3200"));
 
     const QByteArray responsePayload = decodeSingleOutgoingPayload(socket);
@@ -981,6 +977,39 @@ void ReflectorClientTest::malformedNodeFramesAreIgnoredWithoutDisconnect()
     QCOMPARE(leftSpy.count(), 0);
 }
 
+void ReflectorClientTest::framesSplitAcrossReadsAreReassembled()
+{
+    ReflectorClient client;
+    FakeTcpSocket *socket = installFakeTcpSocket(client);
+    QSignalSpy joinedSpy(&client, &ReflectorClient::nodeJoined);
+
+    QByteArray burst;
+    for (const QByteArray &callsign : {QByteArray("YO6SAY"), QByteArray("A2"), QByteArray("N0CALL")}) {
+        QByteArray payload;
+        QDataStream stream(&payload, QIODevice::WriteOnly);
+        stream.setByteOrder(QDataStream::BigEndian);
+        stream << quint16(Svxlink::MsgType::NODE_JOINED);
+        stream << quint16(callsign.size());
+        stream.writeRawData(callsign.constData(), callsign.size());
+        burst.append(framedPayload(payload));
+    }
+
+    // Split mid-prefix and mid-payload; each read hands over what it has.
+    const QList<int> cuts = {3, 11, burst.size()};
+    int offset = 0;
+    for (int cut : cuts) {
+        socket->queueIncoming(burst.mid(offset, cut - offset));
+        client.onTcpReadyRead();
+        offset = cut;
+    }
+
+    QCOMPARE(joinedSpy.count(), 3);
+    QCOMPARE(joinedSpy.at(0).at(0).toString(), QStringLiteral("YO6SAY"));
+    QCOMPARE(joinedSpy.at(1).at(0).toString(), QStringLiteral("A2"));
+    QCOMPARE(joinedSpy.at(2).at(0).toString(), QStringLiteral("N0CALL"));
+    QCOMPARE(client.m_session.bufferedTcpBytes(), 0);
+}
+
 void ReflectorClientTest::validatedNetworkLossMovesClientToWaitingState()
 {
     ReflectorClient client;
@@ -989,7 +1018,7 @@ void ReflectorClientTest::validatedNetworkLossMovesClientToWaitingState()
     client.m_port = 5337;
     client.m_authKey = QByteArrayLiteral("secret");
     client.m_callsign = QStringLiteral("YO6SAY");
-    client.m_talkgroup = 9;
+    client.m_session.m_talkgroup = 9;
     client.m_state = ReflectorClient::Connected;
 
     client.handleAndroidNetworkStateChanged(1, 1, true, true, 1, false, false, false);
@@ -1010,7 +1039,7 @@ void ReflectorClientTest::validatedNetworkRestorationSchedulesImmediateReconnect
     client.m_port = 5337;
     client.m_authKey = QByteArrayLiteral("secret");
     client.m_callsign = QStringLiteral("YO6SAY");
-    client.m_talkgroup = 9;
+    client.m_session.m_talkgroup = 9;
     client.m_state = ReflectorClient::Disconnected;
     client.m_connectionStatus = QStringLiteral("Waiting for validated network...");
     client.m_waitingForValidatedNetwork = true;
@@ -1033,7 +1062,7 @@ void ReflectorClientTest::validatedRouteChangeForcesReconnect()
     client.m_port = 5337;
     client.m_authKey = QByteArrayLiteral("secret");
     client.m_callsign = QStringLiteral("YO6SAY");
-    client.m_talkgroup = 9;
+    client.m_session.m_talkgroup = 9;
     client.m_state = ReflectorClient::Connected;
 
     client.handleAndroidNetworkStateChanged(1, 1, true, true, 1, false, false, false);
@@ -1048,17 +1077,19 @@ void ReflectorClientTest::validatedRouteChangeForcesReconnect()
 void ReflectorClientTest::inboundHeartbeatsArmProtocolLivenessWatchdog()
 {
     ReflectorClient client;
+    FakeTcpSocket *socket = installFakeTcpSocket(client);
 
-    client.m_state = ReflectorClient::Connected;
+    markConnected(client, 0);
+    const QByteArray heartbeat = heartbeatPayload();
 
-    client.noteInboundProtocolHeartbeat();
-    QVERIFY(!client.m_protocolLivenessTimer->isActive());
+    feedIncomingPayload(client, socket, heartbeat);
+    QCOMPARE(client.m_session.livenessTimeoutMs(), 0);
 
     QTest::qWait(10);
-    client.noteInboundProtocolHeartbeat();
+    feedIncomingPayload(client, socket, heartbeat);
 
-    QVERIFY(client.m_protocolLivenessTimer->isActive());
-    QVERIFY(client.protocolLivenessTimeoutMs() >= 15000);
+    QVERIFY(client.m_sessionTimer->isActive());
+    QVERIFY(client.m_session.livenessTimeoutMs() >= ReflectorSession::MIN_LIVENESS_TIMEOUT_MS);
 }
 
 void ReflectorClientTest::protocolLivenessTimeoutSchedulesReconnect()
@@ -1069,15 +1100,16 @@ void ReflectorClientTest::protocolLivenessTimeoutSchedulesReconnect()
     client.m_port = 5337;
     client.m_authKey = QByteArrayLiteral("secret");
     client.m_callsign = QStringLiteral("YO6SAY");
-    client.m_talkgroup = 9;
-    client.m_state = ReflectorClient::Connected;
+    FakeTcpSocket *socket = installFakeTcpSocket(client);
+    markConnected(client, 9);
+    const QByteArray heartbeat = heartbeatPayload();
 
-    client.noteInboundProtocolHeartbeat();
+    feedIncomingPayload(client, socket, heartbeat);
     QTest::qWait(10);
-    client.noteInboundProtocolHeartbeat();
-    QVERIFY(client.m_protocolLivenessTimer->isActive());
+    feedIncomingPayload(client, socket, heartbeat);
+    QVERIFY(client.m_session.livenessTimeoutMs() > 0);
 
-    client.onProtocolLivenessTimeout();
+    client.advanceSession(client.sessionNowMs() + client.m_session.livenessTimeoutMs());
 
     QCOMPARE(client.m_state, ReflectorClient::Disconnected);
     QVERIFY(client.m_reconnectTimer->isActive());
@@ -1114,30 +1146,27 @@ void ReflectorClientTest::prepareForShutdownStopsAllTimers()
     ReflectorClient client;
 
     // Start every timer so we can verify they get stopped.
-    client.m_heartbeatTimer->start(1000);
+    client.m_sessionTimer->start(1000);
     client.m_txTimer->start(1000);
     client.m_pttHangTimer->start(1000);
     client.m_connectTimer->start(1000);
     client.m_audioTimeoutTimer->start(1000);
-    client.m_talkgroupSelectionTimer->start(1000);
     client.m_transcriptionSupportRefreshTimer->start(1000);
 
-    QVERIFY(client.m_heartbeatTimer->isActive());
+    QVERIFY(client.m_sessionTimer->isActive());
     QVERIFY(client.m_txTimer->isActive());
     QVERIFY(client.m_pttHangTimer->isActive());
     QVERIFY(client.m_connectTimer->isActive());
     QVERIFY(client.m_audioTimeoutTimer->isActive());
-    QVERIFY(client.m_talkgroupSelectionTimer->isActive());
     QVERIFY(client.m_transcriptionSupportRefreshTimer->isActive());
 
     client.prepareForShutdown();
 
-    QVERIFY(!client.m_heartbeatTimer->isActive());
+    QVERIFY(!client.m_sessionTimer->isActive());
     QVERIFY(!client.m_txTimer->isActive());
     QVERIFY(!client.m_pttHangTimer->isActive());
     QVERIFY(!client.m_connectTimer->isActive());
     QVERIFY(!client.m_audioTimeoutTimer->isActive());
-    QVERIFY(!client.m_talkgroupSelectionTimer->isActive());
     QVERIFY(!client.m_transcriptionSupportRefreshTimer->isActive());
 }
 
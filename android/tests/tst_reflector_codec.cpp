@@ -0,0 +1,217 @@
+#include <QtTest>
+
+#include "ReflectorCodec.h"
+
+#include <array>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace Svxlink;
+
+class ReflectorCodecTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void frameIsWrittenWithLengthPrefixInPlace();
+    void authResponseMatchesHandWrittenLayout();
+    void listsRoundTrip();
+    void fixedFieldsArePaddedAndFloatsBigEndian();
+    void udpAudioRoundTrips();
+    void truncatedFieldsFailToDecode();
+    void encodeRejectsTooSmallBuffers();
+};
+
+namespace {
+std::string bytes(std::initializer_list<int> values)
+{
+    std::string out;
+    for (int value : values) {
+        out.push_back(static_cast<char>(value));
+    }
+    return out;
+}
+
+std::string text(const PayloadReader &view)
+{
+    return std::string(view.data(), static_cast<size_t>(view.size()));
+}
+
+template <typename Message, typename... Values>
+std::string frameOf(const Values &...values)
+{
+    std::vector<char> buffer(static_cast<size_t>(Message::frameSize(values...)));
+    const int written = Message::encodeFrame(buffer.data(), static_cast<int>(buffer.size()), values...);
+    return std::string(buffer.data(), static_cast<size_t>(written));
+}
+}
+
+void ReflectorCodecTest::frameIsWrittenWithLengthPrefixInPlace()
+{
+    QCOMPARE(frameOf<Codec::ProtoVer>(Protocol::MAJOR_VER, Protocol::MINOR_VER),
+             bytes({0, 0, 0, 6, 0, 5, 0, 2, 0, 0}));
+    QCOMPARE(frameOf<Codec::SelectTg>(uint32_t(2260591)),
+             bytes({0, 0, 0, 6, 0, 106, 0x00, 0x22, 0x7e, 0x6f}));
+    QCOMPARE(frameOf<Codec::Heartbeat>(), bytes({0, 0, 0, 2, 0, 1}));
+
+    // The frame a reader splits off decodes to what went in.
+    const std::string frame = frameOf<Codec::ServerInfo>(uint16_t(0), uint16_t(4321));
+    TcpFrameReader reader;
+    reader.append(frame.data(), static_cast<int>(frame.size()));
+    PayloadReader payload;
+    QCOMPARE(reader.next(payload), TcpFrameReader::Result::Frame);
+    uint16_t reserved = 1;
+    uint16_t clientId = 0;
+    QVERIFY(Codec::ServerInfo::decode(payload, reserved, clientId));
+    QCOMPARE(reserved, uint16_t(0));
+    QCOMPARE(clientId, uint16_t(4321));
+    uint32_t talkgroup = 0;
+    QVERIFY(!Codec::SelectTg::decode(payload, talkgroup));
+}
+
+void ReflectorCodecTest::authResponseMatchesHandWrittenLayout()
+{
+    const std::string callsign("YO6SAY");
+    const std::string digest(Protocol::DIGEST_LEN, '\x5a');
+    const std::string frame = frameOf<Codec::AuthResponse>(Codec::bytesOf(callsign), Codec::bytesOf(digest));
+
+    std::string expected = bytes({0, 0, 0, 2 + 2 + 6 + 2 + 20, 0, 11, 0, 6});
+    expected += callsign + bytes({0, 20}) + digest;
+    QCOMPARE(frame, expected);
+
+    PayloadReader payload(frame.data() + 4, static_cast<int>(frame.size()) - 4);
+    PayloadReader decodedCallsign;
+    PayloadReader decodedDigest;
+    QVERIFY(Codec::AuthResponse::decode(payload, decodedCallsign, decodedDigest));
+    QCOMPARE(text(decodedCallsign), callsign);
+    QCOMPARE(text(decodedDigest), digest);
+    // Views point into the frame, not at copies.
+    QVERIFY(decodedCallsign.data() == frame.data() + 8);
+}
+
+void ReflectorCodecTest::listsRoundTrip()
+{
+    const std::vector<uint32_t> talkgroups = {91, 2260, 226};
+    const std::string monitor = frameOf<Codec::TgMonitor>(Codec::spanOf(talkgroups));
+    QCOMPARE(monitor, bytes({0, 0, 0, 16, 0, 107, 0, 3, 0, 0, 0, 91, 0, 0, 0x08, 0xd4, 0, 0, 0, 0xe2}));
+
+    const std::string first("YO6SAY");
+    const std::string second("A2");
+    const std::array<Codec::Bytes, 2> callsigns = {Codec::bytesOf(first), Codec::bytesOf(second)};
+    const std::string list = frameOf<Codec::NodeList>(Codec::Span<Codec::Bytes>{callsigns.data(), 2});
+
+    PayloadReader payload(list.data() + 4, static_cast<int>(list.size()) - 4);
+    Codec::StringList::View nodes;
+    QVERIFY(Codec::NodeList::decode(payload, nodes));
+    QCOMPARE(nodes.count, 2);
+    PayloadReader callsign;
+    QVERIFY(nodes.next(callsign));
+    QCOMPARE(text(callsign), first);
+    QVERIFY(nodes.next(callsign));
+    QCOMPARE(text(callsign), second);
+    QVERIFY(!nodes.next(callsign));
+
+    const std::string source("YO6SAY");
+    const std::string name("Voter:rx");
+    const std::string message("1");
+    const std::string event = frameOf<Codec::StateEvent>(std::array<Codec::Bytes, 3>{
+        Codec::bytesOf(source), Codec::bytesOf(name), Codec::bytesOf(message)});
+    QCOMPARE(event.substr(4, 8), bytes({0, 110, 0, 6, 0, 8, 0, 1}));
+    PayloadReader eventPayload(event.data() + 4, static_cast<int>(event.size()) - 4);
+    std::array<PayloadReader, 3> strings;
+    QVERIFY(Codec::StateEvent::decode(eventPayload, strings));
+    QCOMPARE(text(strings[0]), source);
+    QCOMPARE(text(strings[1]), name);
+    QCOMPARE(text(strings[2]), message);
+}
+
+void ReflectorCodecTest::fixedFieldsArePaddedAndFloatsBigEndian()
+{
+    const std::string callsign("YO6SAY");
+    const std::string frame = frameOf<Codec::SignalStrength>(1.0f, -2.0f, Codec::bytesOf(callsign));
+    QCOMPARE(static_cast<int>(frame.size()), 4 + static_cast<int>(sizeof(MsgSignalStrength)));
+    QCOMPARE(frame.substr(6, 8), bytes({0x3f, 0x80, 0, 0, 0xc0, 0, 0, 0}));
+    QCOMPARE(frame.substr(14), callsign + std::string(14, '\0'));
+
+    PayloadReader payload(frame.data() + 4, static_cast<int>(frame.size()) - 4);
+    float signal = 0.0f;
+    float squelch = 0.0f;
+    PayloadReader field;
+    QVERIFY(Codec::SignalStrength::decode(payload, signal, squelch, field));
+    QCOMPARE(signal, 1.0f);
+    QCOMPARE(squelch, -2.0f);
+    QCOMPARE(field.size(), Protocol::CALLSIGN_LEN);
+
+    // Longer values are cut to the field.
+    const std::string longCallsign(30, 'X');
+    const std::string status = frameOf<Codec::TxStatus>(uint8_t(1), Codec::bytesOf(longCallsign));
+    QCOMPARE(static_cast<int>(status.size()), 4 + static_cast<int>(sizeof(MsgTxStatus)));
+    QCOMPARE(status.substr(7), std::string(Protocol::CALLSIGN_LEN, 'X'));
+}
+
+void ReflectorCodecTest::udpAudioRoundTrips()
+{
+    const std::string opus("\x78\x01\x02\x03", 4);
+    char datagram[64];
+    const int size = Codec::UdpAudio::encode(datagram, sizeof(datagram), 4321, 65535, Codec::bytesOf(opus));
+    QCOMPARE(size, static_cast<int>(sizeof(MsgUdpAudio)) + 4);
+    QCOMPARE(std::string(datagram, 8), bytes({0, 101, 0x10, 0xe1, 0xff, 0xff, 0, 4}));
+
+    uint16_t clientId = 0;
+    uint16_t sequence = 0;
+    PayloadReader audio;
+    QVERIFY(Codec::UdpAudio::decode(PayloadReader(datagram, size), clientId, sequence, audio));
+    QCOMPARE(clientId, uint16_t(4321));
+    QCOMPARE(sequence, uint16_t(65535));
+    QCOMPARE(text(audio), opus);
+
+    QVERIFY(!Codec::UdpHeartbeat::decode(PayloadReader(datagram, size), clientId, sequence));
+    QCOMPARE(Codec::UdpFlushSamples::encode(datagram, sizeof(datagram), 7, 8), 6);
+    QCOMPARE(std::string(datagram, 6), bytes({0, 102, 0, 7, 0, 8}));
+}
+
+void ReflectorCodecTest::truncatedFieldsFailToDecode()
+{
+    // NODE_JOINED claiming a 6-byte callsign with only 3 bytes present.
+    const std::string joined = bytes({0, 102, 0, 6}) + "YO6";
+    PayloadReader callsign;
+    QVERIFY(!Codec::NodeJoined::decode(PayloadReader(joined.data(), static_cast<int>(joined.size())), callsign));
+
+    // A NODE_LIST whose second entry runs past the end hands out nothing.
+    const std::string list = bytes({0, 101, 0, 2, 0, 2}) + "A2" + bytes({0, 6}) + "YO6";
+    Codec::StringList::View nodes;
+    QVERIFY(!Codec::NodeList::decode(PayloadReader(list.data(), static_cast<int>(list.size())), nodes));
+    QCOMPARE(nodes.count, 0);
+
+    // V1 TALKER_START does not parse as V2.
+    const std::string talker = bytes({0, 104, 0, 6}) + "YO6SAY";
+    uint32_t talkgroup = 0;
+    PayloadReader payload(talker.data() + 2, static_cast<int>(talker.size()) - 2);
+    PayloadReader probe = payload;
+    QVERIFY(!Codec::TalkerStart::decodeFields(probe, talkgroup, callsign));
+    QVERIFY(Codec::TalkerStartV1::decodeFields(payload, callsign));
+    QCOMPARE(text(callsign), std::string("YO6SAY"));
+
+    // A short UDP_AUDIO is rejected.
+    const std::string audio = bytes({0, 101, 0, 1, 0, 2, 0, 9, 1, 2});
+    uint16_t clientId = 0;
+    uint16_t sequence = 0;
+    QVERIFY(!Codec::UdpAudio::decode(PayloadReader(audio.data(), static_cast<int>(audio.size())),
+                                     clientId, sequence, callsign));
+}
+
+void ReflectorCodecTest::encodeRejectsTooSmallBuffers()
+{
+    char buffer[10];
+    QCOMPARE(Codec::ProtoVer::encodeFrame(buffer, 9, 2, 0), 0);
+    QCOMPARE(Codec::ProtoVer::encodeFrame(buffer, 10, 2, 0), 10);
+
+    const std::string tooLong(70000, 'x');
+    QCOMPARE(Codec::NodeInfo::frameSize(Codec::bytesOf(tooLong)), -1);
+    std::vector<char> large(80000);
+    QCOMPARE(Codec::NodeInfo::encodeFrame(large.data(), static_cast<int>(large.size()), Codec::bytesOf(tooLong)), 0);
+}
+
+QTEST_APPLESS_MAIN(ReflectorCodecTest)
+#include "tst_reflector_codec.moc"
@@ -1,16 +1,21 @@
 #include <QtTest>
 
+#include "ImpairmentProxy.h"
+#include "ReflectorClient.h"
 #include "ReflectorProtocol.h"
+#include "ReflectorStandIn.h"
 
 #include <QByteArray>
 #include <QCryptographicHash>
 #include <QDataStream>
 #include <QElapsedTimer>
+#include <QHash>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QMessageAuthenticationCode>
 #include <QNetworkProxy>
 #include <QTcpSocket>
+#include <QThread>
 #include <QUdpSocket>
 #include <QtEndian>
 
@@ -29,10 +34,20 @@ private:
     };
 
 private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void handshakeAgainstStandIn();
+    void wrongAuthKeyIsRejected();
+    void udpAudioIsRelayedWithinTalkgroup();
+    void reflectorClientFollowsScriptedTalker();
+    void reflectorClientFollowsTalkerOverImpairedLink();
     void handshakeAgainstConfiguredReflector();
 
 private:
     Config loadConfig() const;
+    Config standInConfig(const QString &callsign) const;
+    template <typename Function>
+    void onStandIn(Function function);
     static QByteArray framePayload(const QByteArray &payload);
     static quint16 payloadType(const QByteArray &payload);
     static QString decodeErrorPayload(const QByteArray &payload);
@@ -45,15 +60,33 @@ private:
     static QByteArray tgMonitorPayload(quint32 talkgroup);
     static QByteArray heartbeatPayload();
     static QByteArray udpHeartbeatPayload(quint16 clientId, quint16 sequence);
+    static QByteArray udpPayload(quint16 type, quint16 clientId, quint16 sequence,
+                                 const QByteArray &audio = QByteArray());
     QByteArray readFrame(QTcpSocket &socket, int timeoutMs);
-
-    QByteArray m_tcpBuffer;
+    QByteArray readFrameOfType(QTcpSocket &socket, quint16 type, int timeoutMs);
+    static QByteArray readDatagramOfType(QUdpSocket &socket, quint16 type, int timeoutMs);
+    QByteArray readChallenge(QTcpSocket &socket, int timeoutMs);
+    void connectAndChallenge(const Config &config, QTcpSocket &tcpSocket, QByteArray &challenge);
+    void authenticate(const Config &config, QTcpSocket &tcpSocket, QUdpSocket &udpSocket, quint16 &clientId);
+    void disconnectSocket(QTcpSocket &tcpSocket, int timeoutMs);
+
+    // One read buffer per socket, as the relay test reads two at once.
+    QHash<QTcpSocket *, QByteArray> m_tcpBuffers;
+    // In a thread of its own, so the blocking socket calls here do not
+    // starve it.
+    QThread m_standInThread;
+    ReflectorStandIn *m_standIn = nullptr;
+    quint16 m_standInPort = 0;
 };
 
+namespace {
+const QByteArray kStandInAuthKey = QByteArrayLiteral("stand-in-secret");
+}
+
 ReflectorLiveIntegrationTest::Config ReflectorLiveIntegrationTest::loadConfig() const
 {
     Config config;
-    config.host = qEnvironmentVariable("LATRY_LIVE_REFLECTOR_HOST", QStringLiteral("reflector-test.brainic.ro"));
+    config.host = qEnvironmentVariable("LATRY_LIVE_REFLECTOR_HOST");
     config.callsign = qEnvironmentVariable("LATRY_LIVE_REFLECTOR_CALLSIGN");
     config.authKey = qEnvironmentVariable("LATRY_LIVE_REFLECTOR_AUTH_KEY").toUtf8();
 
@@ -78,6 +111,55 @@ ReflectorLiveIntegrationTest::Config ReflectorLiveIntegrationTest::loadConfig()
     return config;
 }
 
+ReflectorLiveIntegrationTest::Config ReflectorLiveIntegrationTest::standInConfig(const QString &callsign) const
+{
+    Config config;
+    config.host = QStringLiteral("127.0.0.1");
+    config.port = m_standInPort;
+    config.callsign = callsign;
+    config.authKey = kStandInAuthKey;
+    config.timeoutMs = 5000;
+    return config;
+}
+
+template <typename Function>
+void ReflectorLiveIntegrationTest::onStandIn(Function function)
+{
+    QMetaObject::invokeMethod(m_standIn, function, Qt::BlockingQueuedConnection);
+}
+
+void ReflectorLiveIntegrationTest::initTestCase()
+{
+    m_standIn = new ReflectorStandIn;
+    m_standIn->moveToThread(&m_standInThread);
+    connect(&m_standInThread, &QThread::finished, m_standIn, &QObject::deleteLater);
+    m_standInThread.start();
+
+    bool listening = false;
+    QString error;
+    onStandIn([&]() {
+        for (const QString &callsign : {QStringLiteral("N0CALL"), QStringLiteral("N0ONE"),
+                                        QStringLiteral("N0TWO"), QStringLiteral("N0CLNT"),
+                                        QStringLiteral("N0LOSS")}) {
+            m_standIn->addUser(callsign, kStandInAuthKey);
+        }
+        listening = m_standIn->listen();
+        m_standInPort = m_standIn->port();
+        error = m_standIn->errorString();
+    });
+    QVERIFY2(listening, qPrintable(error));
+}
+
+void ReflectorLiveIntegrationTest::cleanupTestCase()
+{
+    if (m_standIn) {
+        onStandIn([&]() { m_standIn->close(); });
+    }
+    m_standInThread.quit();
+    m_standInThread.wait();
+    m_standIn = nullptr;
+}
+
 QByteArray ReflectorLiveIntegrationTest::framePayload(const QByteArray &payload)
 {
     QByteArray frame;
@@ -206,62 +288,148 @@ QByteArray ReflectorLiveIntegrationTest::udpHeartbeatPayload(quint16 clientId, q
     return datagram;
 }
 
+QByteArray ReflectorLiveIntegrationTest::udpPayload(quint16 type, quint16 clientId, quint16 sequence,
+                                                    const QByteArray &audio)
+{
+    QByteArray datagram;
+    QDataStream stream(&datagram, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::BigEndian);
+    stream << type << clientId << sequence;
+    if (type == Svxlink::UdpMsgType::UDP_AUDIO) {
+        stream << quint16(audio.size());
+        stream.writeRawData(audio.constData(), audio.size());
+    }
+    return datagram;
+}
+
 QByteArray ReflectorLiveIntegrationTest::readFrame(QTcpSocket &socket, int timeoutMs)
 {
     QElapsedTimer timer;
     timer.start();
+    QByteArray &buffer = m_tcpBuffers[&socket];
 
     while (timer.elapsed() < timeoutMs) {
-        if (m_tcpBuffer.size() >= int(sizeof(quint32))) {
+        if (buffer.size() >= int(sizeof(quint32))) {
             const quint32 payloadSize = qFromBigEndian<quint32>(
-                reinterpret_cast<const uchar *>(m_tcpBuffer.constData()));
+                reinterpret_cast<const uchar *>(buffer.constData()));
             if (payloadSize > 1024 * 1024) {
                 QTest::qFail("Received oversized TCP frame from reflector", __FILE__, __LINE__);
                 return {};
             }
 
-            if (m_tcpBuffer.size() >= int(sizeof(quint32) + payloadSize)) {
-                m_tcpBuffer.remove(0, sizeof(quint32));
-                const QByteArray payload = m_tcpBuffer.left(payloadSize);
-                m_tcpBuffer.remove(0, payloadSize);
+            if (buffer.size() >= int(sizeof(quint32) + payloadSize)) {
+                buffer.remove(0, sizeof(quint32));
+                const QByteArray payload = buffer.left(payloadSize);
+                buffer.remove(0, payloadSize);
                 return payload;
             }
         }
 
-        m_tcpBuffer.append(socket.readAll());
-        if (m_tcpBuffer.size() >= int(sizeof(quint32))) {
-            continue;
+        buffer.append(socket.readAll());
+        if (buffer.size() >= int(sizeof(quint32))) {
+            const quint32 payloadSize = qFromBigEndian<quint32>(
+                reinterpret_cast<const uchar *>(buffer.constData()));
+            if (buffer.size() >= int(sizeof(quint32) + payloadSize)) {
+                continue;
+            }
         }
 
         const int remainingMs = qMax(1, timeoutMs - int(timer.elapsed()));
         if (!socket.waitForReadyRead(remainingMs)) {
             break;
         }
-        m_tcpBuffer.append(socket.readAll());
+        buffer.append(socket.readAll());
     }
 
     return {};
 }
 
-void ReflectorLiveIntegrationTest::handshakeAgainstConfiguredReflector()
+QByteArray ReflectorLiveIntegrationTest::readFrameOfType(QTcpSocket &socket, quint16 type, int timeoutMs)
 {
-    const QString enabled = qEnvironmentVariable("LATRY_ENABLE_LIVE_REFLECTOR_TESTS").trimmed().toLower();
-    if (!(enabled == QLatin1String("1") || enabled == QLatin1String("true") || enabled == QLatin1String("yes"))) {
-        QSKIP("Live reflector integration test is disabled. Set LATRY_ENABLE_LIVE_REFLECTOR_TESTS=1 to run it.");
+    QElapsedTimer timer;
+    timer.start();
+
+    while (timer.elapsed() < timeoutMs) {
+        const QByteArray payload = readFrame(socket, qMax(1, timeoutMs - int(timer.elapsed())));
+        if (payload.isEmpty()) {
+            break;
+        }
+        if (payloadType(payload) == type) {
+            return payload;
+        }
     }
 
-    const Config config = loadConfig();
-    if (config.host.isEmpty() || config.callsign.isEmpty() || config.authKey.isEmpty()) {
-        QSKIP("Missing live reflector configuration. Set LATRY_LIVE_REFLECTOR_CALLSIGN and LATRY_LIVE_REFLECTOR_AUTH_KEY.");
+    return {};
+}
+
+QByteArray ReflectorLiveIntegrationTest::readDatagramOfType(QUdpSocket &socket, quint16 type, int timeoutMs)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    while (timer.elapsed() < timeoutMs) {
+        while (socket.hasPendingDatagrams()) {
+            QByteArray datagram(int(socket.pendingDatagramSize()), Qt::Uninitialized);
+            const qint64 bytesRead = socket.readDatagram(datagram.data(), datagram.size());
+            if (bytesRead >= qint64(sizeof(Svxlink::UdpMsgHeader)) && payloadType(datagram) == type) {
+                datagram.resize(int(bytesRead));
+                return datagram;
+            }
+        }
+        socket.waitForReadyRead(qMax(1, timeoutMs - int(timer.elapsed())));
     }
 
-    m_tcpBuffer.clear();
+    return {};
+}
 
-    QTcpSocket tcpSocket;
-    tcpSocket.setProxy(QNetworkProxy::NoProxy);
+QByteArray ReflectorLiveIntegrationTest::readChallenge(QTcpSocket &socket, int timeoutMs)
+{
+    QElapsedTimer timer;
+    timer.start();
 
-    QUdpSocket udpSocket;
-    QVERIFY2(udpSocket.bind(QHostAddress::AnyIPv4, 0), qPrintable(udpSocket.errorString()));
+    while (timer.elapsed() < timeoutMs) {
+        const QByteArray payload = readFrame(socket, qMax(1, timeoutMs - int(timer.elapsed())));
+        if (payload.isEmpty()) {
+            QTest::qFail("Timed out waiting for AUTH_CHALLENGE", __FILE__, __LINE__);
+            return {};
+        }
+
+        switch (payloadType(payload)) {
+        case Svxlink::MsgType::PROTO_VER:
+        case Svxlink::MsgType::HEARTBEAT:
+            break;
+        case Svxlink::MsgType::AUTH_CHALLENGE: {
+            QDataStream stream(payload);
+            stream.setByteOrder(QDataStream::BigEndian);
+            quint16 type = 0;
+            quint16 len = 0;
+            stream >> type >> len;
+            QByteArray challenge(len, Qt::Uninitialized);
+            if (len > 0) {
+                stream.readRawData(challenge.data(), len);
+            }
+            return challenge;
+        }
+        case Svxlink::MsgType::ERROR:
+            QTest::qFail(qPrintable(QStringLiteral("Server rejected pre-auth handshake: %1").arg(decodeErrorPayload(payload))),
+                         __FILE__, __LINE__);
+            return {};
+        case Svxlink::MsgType::PROTO_VER_DOWNGRADE:
+            QTest::qFail("Server requested unsupported protocol downgrade", __FILE__, __LINE__);
+            return {};
+        default:
+            break;
+        }
+    }
+
+    return {};
+}
+
+void ReflectorLiveIntegrationTest::connectAndChallenge(const Config &config, QTcpSocket &tcpSocket,
+                                                       QByteArray &challenge)
+{
+    m_tcpBuffers.remove(&tcpSocket);
+    tcpSocket.setProxy(QNetworkProxy::NoProxy);
 
     tcpSocket.connectToHost(config.host, config.port);
     QVERIFY2(tcpSocket.waitForConnected(config.timeoutMs), qPrintable(tcpSocket.errorString()));
@@ -269,49 +437,27 @@ void ReflectorLiveIntegrationTest::handshakeAgainstConfiguredReflector()
     tcpSocket.write(framePayload(protoVerPayload()));
     QVERIFY2(tcpSocket.waitForBytesWritten(config.timeoutMs), qPrintable(tcpSocket.errorString()));
 
-    QByteArray challenge;
-    {
-        QElapsedTimer timer;
-        timer.start();
+    challenge = readChallenge(tcpSocket, config.timeoutMs);
+    QCOMPARE(challenge.size(), Svxlink::Protocol::CHALLENGE_LEN);
+}
 
-        while (timer.elapsed() < config.timeoutMs && challenge.isEmpty()) {
-            const QByteArray payload = readFrame(tcpSocket, qMax(1, config.timeoutMs - int(timer.elapsed())));
-            QVERIFY2(!payload.isEmpty(), "Timed out waiting for AUTH_CHALLENGE");
+void ReflectorLiveIntegrationTest::authenticate(const Config &config, QTcpSocket &tcpSocket,
+                                                QUdpSocket &udpSocket, quint16 &clientId)
+{
+    QVERIFY2(udpSocket.bind(QHostAddress::AnyIPv4, 0), qPrintable(udpSocket.errorString()));
 
-            switch (payloadType(payload)) {
-            case Svxlink::MsgType::PROTO_VER:
-            case Svxlink::MsgType::HEARTBEAT:
-                break;
-            case Svxlink::MsgType::AUTH_CHALLENGE: {
-                QDataStream stream(payload);
-                stream.setByteOrder(QDataStream::BigEndian);
-                quint16 type = 0;
-                quint16 len = 0;
-                stream >> type >> len;
-                challenge.resize(len);
-                if (len > 0) {
-                    stream.readRawData(challenge.data(), len);
-                }
-                break;
-            }
-            case Svxlink::MsgType::ERROR:
-                QFAIL(qPrintable(QStringLiteral("Server rejected pre-auth handshake: %1").arg(decodeErrorPayload(payload))));
-            case Svxlink::MsgType::PROTO_VER_DOWNGRADE:
-                QFAIL("Server requested unsupported protocol downgrade");
-            default:
-                break;
-            }
-        }
+    QByteArray challenge;
+    connectAndChallenge(config, tcpSocket, challenge);
+    if (QTest::currentTestFailed()) {
+        return;
     }
 
-    QCOMPARE(challenge.size(), Svxlink::Protocol::CHALLENGE_LEN);
-
     tcpSocket.write(framePayload(authResponsePayload(config.callsign, config.authKey, challenge)));
     QVERIFY2(tcpSocket.waitForBytesWritten(config.timeoutMs), qPrintable(tcpSocket.errorString()));
 
     bool sawAuthOk = false;
     bool sawServerInfo = false;
-    quint16 clientId = 0;
+    clientId = 0;
     {
         QElapsedTimer timer;
         timer.start();
@@ -360,6 +506,270 @@ void ReflectorLiveIntegrationTest::handshakeAgainstConfiguredReflector()
     const QByteArray udpHeartbeat = udpHeartbeatPayload(clientId, 0);
     const qint64 udpBytes = udpSocket.writeDatagram(udpHeartbeat, tcpSocket.peerAddress(), config.port);
     QCOMPARE(udpBytes, qint64(udpHeartbeat.size()));
+}
+
+void ReflectorLiveIntegrationTest::disconnectSocket(QTcpSocket &tcpSocket, int timeoutMs)
+{
+    tcpSocket.disconnectFromHost();
+    if (tcpSocket.state() != QAbstractSocket::UnconnectedState) {
+        QVERIFY2(tcpSocket.waitForDisconnected(timeoutMs)
+                     || tcpSocket.state() == QAbstractSocket::UnconnectedState,
+                 qPrintable(tcpSocket.errorString()));
+    }
+    m_tcpBuffers.remove(&tcpSocket);
+}
+
+void ReflectorLiveIntegrationTest::handshakeAgainstStandIn()
+{
+    const Config config = standInConfig(QStringLiteral("N0CALL"));
+
+    QTcpSocket tcpSocket;
+    QUdpSocket udpSocket;
+    quint16 clientId = 0;
+    authenticate(config, tcpSocket, udpSocket, clientId);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    // The stand-in answers the registering heartbeat, as SvxReflector does.
+    QVERIFY(!readDatagramOfType(udpSocket, Svxlink::UdpMsgType::UDP_HEARTBEAT, config.timeoutMs).isEmpty());
+
+    quint32 selectedTalkgroup = 0;
+    QList<quint32> monitored;
+    QByteArray nodeInfo;
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < config.timeoutMs && (selectedTalkgroup == 0 || nodeInfo.isEmpty())) {
+        QTest::qWait(10);
+        onStandIn([&]() {
+            selectedTalkgroup = m_standIn->selectedTalkgroup(config.callsign);
+            monitored = m_standIn->monitoredTalkgroups(config.callsign);
+            nodeInfo = m_standIn->nodeInfo(config.callsign);
+        });
+    }
+    QCOMPARE(selectedTalkgroup, config.talkgroup);
+    QCOMPARE(monitored, QList<quint32>({config.talkgroup}));
+    QCOMPARE(QJsonDocument::fromJson(nodeInfo).object().value(QStringLiteral("callsign")).toString(),
+             config.callsign);
+
+    disconnectSocket(tcpSocket, config.timeoutMs);
+}
+
+void ReflectorLiveIntegrationTest::wrongAuthKeyIsRejected()
+{
+    Config config = standInConfig(QStringLiteral("N0CALL"));
+    config.authKey = QByteArrayLiteral("not-the-key");
+
+    QTcpSocket tcpSocket;
+    QByteArray challenge;
+    connectAndChallenge(config, tcpSocket, challenge);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    tcpSocket.write(framePayload(authResponsePayload(config.callsign, config.authKey, challenge)));
+    QVERIFY2(tcpSocket.waitForBytesWritten(config.timeoutMs), qPrintable(tcpSocket.errorString()));
+
+    const QByteArray error = readFrameOfType(tcpSocket, Svxlink::MsgType::ERROR, config.timeoutMs);
+    QVERIFY2(!error.isEmpty(), "Expected ERROR for a wrong auth key");
+    QCOMPARE(decodeErrorPayload(error), QStringLiteral("Access denied"));
+
+    QVERIFY(tcpSocket.state() == QAbstractSocket::UnconnectedState
+            || tcpSocket.waitForDisconnected(config.timeoutMs));
+    m_tcpBuffers.remove(&tcpSocket);
+}
+
+void ReflectorLiveIntegrationTest::udpAudioIsRelayedWithinTalkgroup()
+{
+    const Config talkerConfig = standInConfig(QStringLiteral("N0ONE"));
+    const Config listenerConfig = standInConfig(QStringLiteral("N0TWO"));
+
+    QTcpSocket talkerTcp;
+    QUdpSocket talkerUdp;
+    quint16 talkerId = 0;
+    authenticate(talkerConfig, talkerTcp, talkerUdp, talkerId);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    QTcpSocket listenerTcp;
+    QUdpSocket listenerUdp;
+    quint16 listenerId = 0;
+    authenticate(listenerConfig, listenerTcp, listenerUdp, listenerId);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+    QVERIFY(talkerId != listenerId);
+    // Both heartbeats answered: both UDP ports are registered.
+    QVERIFY(!readDatagramOfType(talkerUdp, Svxlink::UdpMsgType::UDP_HEARTBEAT, talkerConfig.timeoutMs).isEmpty());
+    QVERIFY(!readDatagramOfType(listenerUdp, Svxlink::UdpMsgType::UDP_HEARTBEAT, listenerConfig.timeoutMs).isEmpty());
+
+    const QByteArray opus = QByteArrayLiteral("\x78\x01\x02\x03");
+    talkerUdp.writeDatagram(udpPayload(Svxlink::UdpMsgType::UDP_AUDIO, talkerId, 1, opus),
+                            talkerTcp.peerAddress(), talkerConfig.port);
+
+    const QByteArray talkerStart = readFrameOfType(listenerTcp, Svxlink::MsgType::TALKER_START,
+                                                   listenerConfig.timeoutMs);
+    QVERIFY2(!talkerStart.isEmpty(), "Expected TALKER_START on the listener");
+    {
+        QDataStream stream(talkerStart);
+        stream.setByteOrder(QDataStream::BigEndian);
+        quint16 type = 0;
+        quint32 talkgroup = 0;
+        quint16 callsignLen = 0;
+        stream >> type >> talkgroup >> callsignLen;
+        QByteArray callsign(callsignLen, Qt::Uninitialized);
+        stream.readRawData(callsign.data(), callsign.size());
+        QCOMPARE(talkgroup, listenerConfig.talkgroup);
+        QCOMPARE(QString::fromUtf8(callsign), talkerConfig.callsign);
+    }
+
+    const QByteArray relayed = readDatagramOfType(listenerUdp, Svxlink::UdpMsgType::UDP_AUDIO,
+                                                  listenerConfig.timeoutMs);
+    QVERIFY2(!relayed.isEmpty(), "Expected the audio relayed to the listener");
+    {
+        QDataStream stream(relayed);
+        stream.setByteOrder(QDataStream::BigEndian);
+        quint16 type = 0;
+        quint16 clientId = 0;
+        quint16 sequence = 0;
+        quint16 audioLen = 0;
+        stream >> type >> clientId >> sequence >> audioLen;
+        QByteArray audio(audioLen, Qt::Uninitialized);
+        stream.readRawData(audio.data(), audio.size());
+        QCOMPARE(clientId, listenerId);
+        QCOMPARE(audio, opus);
+    }
+
+    talkerUdp.writeDatagram(udpPayload(Svxlink::UdpMsgType::UDP_FLUSH_SAMPLES, talkerId, 2),
+                            talkerTcp.peerAddress(), talkerConfig.port);
+    QVERIFY(!readDatagramOfType(talkerUdp, Svxlink::UdpMsgType::UDP_ALL_SAMPLES_FLUSHED,
+                                talkerConfig.timeoutMs).isEmpty());
+    QVERIFY(!readDatagramOfType(listenerUdp, Svxlink::UdpMsgType::UDP_FLUSH_SAMPLES,
+                                listenerConfig.timeoutMs).isEmpty());
+    QVERIFY(!readFrameOfType(listenerTcp, Svxlink::MsgType::TALKER_STOP, listenerConfig.timeoutMs).isEmpty());
+
+    disconnectSocket(listenerTcp, listenerConfig.timeoutMs);
+    disconnectSocket(talkerTcp, talkerConfig.timeoutMs);
+}
+
+void ReflectorLiveIntegrationTest::reflectorClientFollowsScriptedTalker()
+{
+    const Config config = standInConfig(QStringLiteral("N0CLNT"));
+    const QList<QByteArray> tone = ReflectorStandIn::encodeTone(440.0, 600);
+    QVERIFY(!tone.isEmpty());
+
+    ReflectorClient client;
+    client.connectToServer(config.host, config.port, QString::fromUtf8(config.authKey), config.callsign,
+                           config.talkgroup, QString());
+    QTRY_COMPARE_WITH_TIMEOUT(client.connectionStatus(),
+                              QStringLiteral("Connected to TG %1").arg(config.talkgroup), config.timeoutMs);
+
+    // TALKER_START only reaches a client the stand-in knows is listening.
+    bool started = false;
+    QElapsedTimer timer;
+    timer.start();
+    while (!started && timer.elapsed() < config.timeoutMs) {
+        QTest::qWait(10);
+        onStandIn([&]() {
+            if (m_standIn->selectedTalkgroup(config.callsign) == config.talkgroup) {
+                started = m_standIn->startScriptedTalker(QStringLiteral("N0TALK"), config.talkgroup, tone);
+            }
+        });
+    }
+    QVERIFY(started);
+
+    QTRY_COMPARE_WITH_TIMEOUT(client.currentTalker(), QStringLiteral("N0TALK"), config.timeoutMs);
+    QTRY_COMPARE_WITH_TIMEOUT(client.currentTalker(), QString(), config.timeoutMs);
+
+    client.disconnectFromServer();
+    QTRY_VERIFY_WITH_TIMEOUT(client.isDisconnected(), config.timeoutMs);
+}
+
+void ReflectorLiveIntegrationTest::reflectorClientFollowsTalkerOverImpairedLink()
+{
+    Config config = standInConfig(QStringLiteral("N0LOSS"));
+    const QList<QByteArray> tone = ReflectorStandIn::encodeTone(440.0, 1000);
+    QVERIFY(!tone.isEmpty());
+
+    NetworkImpairment::Config link;
+    QVERIFY(NetworkImpairment::parse("lte,reorder=0.02,dup=0.02", link));
+
+    // Next to the stand-in, in its thread.
+    auto *proxy = new ImpairmentProxy;
+    proxy->setUpstream(QHostAddress(QHostAddress::LocalHost), m_standInPort);
+    proxy->setUplink(link);
+    proxy->setDownlink(link);
+    proxy->setSeed(2400);
+    proxy->moveToThread(&m_standInThread);
+    auto onProxy = [proxy](auto function) {
+        QMetaObject::invokeMethod(proxy, function, Qt::BlockingQueuedConnection);
+    };
+
+    bool listening = false;
+    QString error;
+    onProxy([&]() {
+        listening = proxy->listen();
+        config.port = proxy->port();
+        error = proxy->errorString();
+    });
+    QVERIFY2(listening, qPrintable(error));
+
+    ReflectorClient client;
+    client.connectToServer(config.host, config.port, QString::fromUtf8(config.authKey), config.callsign,
+                           config.talkgroup, QString());
+    QTRY_COMPARE_WITH_TIMEOUT(client.connectionStatus(),
+                              QStringLiteral("Connected to TG %1").arg(config.talkgroup), config.timeoutMs);
+
+    bool started = false;
+    QElapsedTimer timer;
+    timer.start();
+    while (!started && timer.elapsed() < config.timeoutMs) {
+        QTest::qWait(10);
+        onStandIn([&]() {
+            if (m_standIn->selectedTalkgroup(config.callsign) == config.talkgroup) {
+                started = m_standIn->startScriptedTalker(QStringLiteral("N0TALK"), config.talkgroup, tone);
+            }
+        });
+    }
+    QVERIFY(started);
+
+    QTRY_COMPARE_WITH_TIMEOUT(client.currentTalker(), QStringLiteral("N0TALK"), config.timeoutMs);
+    QTRY_COMPARE_WITH_TIMEOUT(client.currentTalker(), QString(), config.timeoutMs);
+
+    client.disconnectFromServer();
+    QTRY_VERIFY_WITH_TIMEOUT(client.isDisconnected(), config.timeoutMs);
+
+    ImpairmentProxy::Stats stats;
+    onProxy([&]() {
+        stats = proxy->stats();
+        proxy->close();
+        proxy->deleteLater();
+    });
+    QVERIFY(stats.uplink.packets > 0);
+    QVERIFY(stats.downlink.packets > 0);
+    QVERIFY(stats.tcpDownlink.packets > 0);
+}
+
+void ReflectorLiveIntegrationTest::handshakeAgainstConfiguredReflector()
+{
+    const QString enabled = qEnvironmentVariable("LATRY_ENABLE_LIVE_REFLECTOR_TESTS").trimmed().toLower();
+    if (!(enabled == QLatin1String("1") || enabled == QLatin1String("true") || enabled == QLatin1String("yes"))) {
+        QSKIP("Live reflector integration test is disabled. Set LATRY_ENABLE_LIVE_REFLECTOR_TESTS=1 to run it.");
+    }
+
+    const Config config = loadConfig();
+    if (config.host.isEmpty() || config.callsign.isEmpty() || config.authKey.isEmpty()) {
+        QSKIP("Missing live reflector configuration. Set LATRY_LIVE_REFLECTOR_HOST, LATRY_LIVE_REFLECTOR_CALLSIGN and LATRY_LIVE_REFLECTOR_AUTH_KEY.");
+    }
+
+    QTcpSocket tcpSocket;
+    QUdpSocket udpSocket;
+    quint16 clientId = 0;
+    authenticate(config, tcpSocket, udpSocket, clientId);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
 
     // The reflector may send a node list or heartbeat. The important part here is
     // that it does not immediately reject the authenticated session after post-auth frames.
@@ -384,12 +794,7 @@ void ReflectorLiveIntegrationTest::handshakeAgainstConfiguredReflector()
                  || tcpSocket.state() == QAbstractSocket::ClosingState,
              qPrintable(tcpSocket.errorString()));
 
-    tcpSocket.disconnectFromHost();
-    if (tcpSocket.state() != QAbstractSocket::UnconnectedState) {
-        QVERIFY2(tcpSocket.waitForDisconnected(3000)
-                     || tcpSocket.state() == QAbstractSocket::UnconnectedState,
-                 qPrintable(tcpSocket.errorString()));
-    }
+    disconnectSocket(tcpSocket, 3000);
 }
 
 QTEST_GUILESS_MAIN(ReflectorLiveIntegrationTest)
@@ -0,0 +1,451 @@
+#include <QtTest>
+
+#include "ReflectorSession.h"
+#include "ReflectorCodec.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace Svxlink;
+
+class ReflectorSessionTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void handshakeAnswersChallengeAndStartsSession();
+    void monitorListPutsDefaultTalkgroupFirst();
+    void talkerStartFollowsMonitorPriorities();
+    void ownTalkerStartDisplacesCurrentTalker();
+    void selectionTimeoutFallsBackToMonitorMode();
+    void heartbeatsAndLivenessFollowTheClock();
+    void udpAudioBecomesEventsAndSharesSequence();
+    void serverErrorDropsRejectedCredentials();
+    void oversizedFrameFailsTheConnection();
+    void garbageInputIsReportedNotFatal();
+};
+
+namespace {
+using Type = ReflectorSession::Event::Type;
+using Origin = ReflectorSession::TalkgroupSelectionOrigin;
+
+template <typename Message, typename... Values>
+std::string frameOf(const Values &...values)
+{
+    std::string frame(static_cast<size_t>(Message::frameSize(values...)), '\0');
+    Message::encodeFrame(&frame[0], static_cast<int>(frame.size()), values...);
+    return frame;
+}
+
+template <typename Message, typename... Values>
+std::string datagramOf(uint16_t clientId, uint16_t sequence, const Values &...values)
+{
+    std::string datagram(static_cast<size_t>(Message::size(values...)), '\0');
+    Message::encode(&datagram[0], static_cast<int>(datagram.size()), clientId, sequence, values...);
+    return datagram;
+}
+
+void receive(ReflectorSession &session, const std::string &bytes, int64_t nowMs)
+{
+    session.receiveTcp(bytes.data(), static_cast<int>(bytes.size()), nowMs);
+}
+
+std::string takeTcp(ReflectorSession &session)
+{
+    std::string out(session.tcpOutput(), static_cast<size_t>(session.tcpOutputBytes()));
+    session.clearTcpOutput();
+    return out;
+}
+
+std::vector<std::string> takeDatagrams(ReflectorSession &session)
+{
+    std::vector<std::string> datagrams;
+    const char *data = nullptr;
+    int size = 0;
+    while (session.nextDatagram(data, size)) {
+        datagrams.emplace_back(data, static_cast<size_t>(size));
+    }
+    return datagrams;
+}
+
+std::vector<ReflectorSession::Event> takeEvents(ReflectorSession &session)
+{
+    std::vector<ReflectorSession::Event> events;
+    ReflectorSession::Event event;
+    while (session.nextEvent(event)) {
+        events.push_back(event);
+    }
+    return events;
+}
+
+std::string hex(const std::string &bytes)
+{
+    static const char digits[] = "0123456789abcdef";
+    std::string out;
+    for (unsigned char byte : bytes) {
+        out.push_back(digits[byte >> 4]);
+        out.push_back(digits[byte & 0x0f]);
+    }
+    return out;
+}
+
+// Runs the handshake at time 0 and drops what it produced.
+void connectSession(ReflectorSession &session, uint32_t talkgroup)
+{
+    session.open(talkgroup, 0);
+    session.transportConnected(0);
+    receive(session, frameOf<Codec::ServerInfo>(uint16_t(0), uint16_t(7)), 0);
+    takeTcp(session);
+    takeDatagrams(session);
+    takeEvents(session);
+}
+
+std::string talkerStart(uint32_t talkgroup, const std::string &callsign)
+{
+    return frameOf<Codec::TalkerStart>(talkgroup, Codec::bytesOf(callsign));
+}
+}
+
+void ReflectorSessionTest::handshakeAnswersChallengeAndStartsSession()
+{
+    ReflectorSession session;
+    session.setCredentials("N0CALL", "Jefe");
+    session.setNodeInfo("{}", 0);
+    session.setMonitoredTalkgroups(91, {{3100, 1}}, 0);
+    QVERIFY(takeTcp(session).empty());
+
+    session.open(91, 0);
+    QCOMPARE(session.state(), ReflectorSession::State::Connecting);
+    std::vector<ReflectorSession::Event> events = takeEvents(session);
+    QCOMPARE(events.size(), size_t(1));
+    QCOMPARE(events[0].type, Type::TalkgroupChanged);
+    QCOMPARE(events[0].talkgroup, 91u);
+
+    session.transportConnected(10);
+    QCOMPARE(session.state(), ReflectorSession::State::Authenticating);
+    QCOMPARE(takeTcp(session), frameOf<Codec::ProtoVer>(Protocol::MAJOR_VER, Protocol::MINOR_VER));
+
+    // RFC 2202 test case 2.
+    const std::string challenge("what do ya want for nothing?");
+    receive(session, frameOf<Codec::AuthChallenge>(Codec::bytesOf(challenge)), 20);
+    const std::string response = takeTcp(session);
+    PayloadReader payload(response.data() + 4, static_cast<int>(response.size()) - 4);
+    PayloadReader callsign;
+    PayloadReader digest;
+    QVERIFY(Codec::AuthResponse::decode(payload, callsign, digest));
+    QCOMPARE(std::string(callsign.data(), static_cast<size_t>(callsign.size())), std::string("N0CALL"));
+    QCOMPARE(hex(std::string(digest.data(), static_cast<size_t>(digest.size()))),
+             std::string("effcdf6ae5eb2fa2d27416d5f184df9c259a7c79"));
+
+    receive(session, frameOf<Codec::AuthOk>() + frameOf<Codec::ServerInfo>(uint16_t(0), uint16_t(4321)), 30);
+    QCOMPARE(session.state(), ReflectorSession::State::Connected);
+    QCOMPARE(session.clientId(), uint16_t(4321));
+
+    const std::vector<uint32_t> monitored{91, 3100};
+    const std::string nodeInfo("{}");
+    QCOMPARE(takeTcp(session),
+             frameOf<Codec::NodeInfo>(Codec::bytesOf(nodeInfo))
+             + frameOf<Codec::SelectTg>(uint32_t(91))
+             + frameOf<Codec::TgMonitor>(Codec::spanOf(monitored)));
+    const std::vector<std::string> datagrams = takeDatagrams(session);
+    QCOMPARE(datagrams.size(), size_t(1));
+    QCOMPARE(datagrams[0], datagramOf<Codec::UdpHeartbeat>(4321, 0));
+
+    events = takeEvents(session);
+    QCOMPARE(events.size(), size_t(1));
+    QCOMPARE(events[0].type, Type::Authenticated);
+    QCOMPARE(events[0].value, 4321u);
+
+    // The selection countdown ticks first; the heartbeat follows.
+    QCOMPARE(session.nextTimeoutMs(), int64_t(30 + ReflectorSession::TALKGROUP_SELECTION_TICK_MS));
+    QVERIFY(session.talkgroupSelectionTimerActive());
+}
+
+void ReflectorSessionTest::monitorListPutsDefaultTalkgroupFirst()
+{
+    ReflectorSession session;
+    session.setMonitoredTalkgroups(9, {{3100, 1}, {3200, 2}, {9, 0}, {91, 3}}, 0);
+    QCOMPARE(session.monitoredTalkgroups(), std::vector<uint32_t>({9, 3100, 3200, 91}));
+    QVERIFY(takeTcp(session).empty());
+
+    // Active talkgroups for "3100+, abc, 0, 3200++, 3100, 91+++" on TG 9:
+    // the default first, no zero and no repeats.
+    session.setMonitoredTalkgroups(9, {{3100, 1}, {0, 0}, {3200, 2}, {3100, 1}, {91, 3}}, 0);
+    QCOMPARE(session.monitoredTalkgroups(), std::vector<uint32_t>({9u, 3100u, 3200u, 91u}));
+
+    connectSession(session, 9);
+    session.setMonitoredTalkgroups(0, {{3100, 1}}, 0);
+    const std::vector<uint32_t> monitored{3100};
+    QCOMPARE(takeTcp(session), frameOf<Codec::TgMonitor>(Codec::spanOf(monitored)));
+
+    session.clearMonitoredTalkgroups();
+    QVERIFY(session.monitoredTalkgroups().empty());
+    QCOMPARE(session.defaultTalkgroup(), 0u);
+}
+
+void ReflectorSessionTest::talkerStartFollowsMonitorPriorities()
+{
+    ReflectorSession session;
+    session.setCredentials("N0CALL", "key");
+    session.setMonitoredTalkgroups(91, {{3100, 1}, {3200, 2}}, 0);
+    connectSession(session, 0);
+
+    // TG 0 is only the local parking state.
+    receive(session, talkerStart(0, "YO6SAY"), 0);
+    QVERIFY(takeEvents(session).empty());
+
+    // Unmonitored talkgroups are ignored.
+    receive(session, talkerStart(4000, "YO6SAY"), 0);
+    QVERIFY(takeEvents(session).empty());
+
+    // From TG 0 any monitored talkgroup is activated.
+    receive(session, talkerStart(3100, "YO6SAY"), 0);
+    QCOMPARE(session.selectedTalkgroup(), 3100u);
+    QCOMPARE(takeTcp(session), frameOf<Codec::SelectTg>(uint32_t(3100)));
+    std::vector<ReflectorSession::Event> events = takeEvents(session);
+    QCOMPARE(events.size(), size_t(2));
+    QCOMPARE(events[0].type, Type::TalkgroupChanged);
+    QCOMPARE(events[1].type, Type::TalkerStarted);
+    QCOMPARE(events[1].text, std::string("YO6SAY"));
+    QCOMPARE(events[1].talkgroup, 3100u);
+
+    // A higher priority takes over while priority mode is on.
+    receive(session, talkerStart(3200, "YO2LOJ"), 0);
+    QCOMPARE(session.selectedTalkgroup(), 3200u);
+    QCOMPARE(session.currentTalker(), std::string("YO2LOJ"));
+    takeTcp(session);
+    takeEvents(session);
+
+    // A lower one does not.
+    receive(session, talkerStart(3100, "YO6SAY"), 0);
+    QCOMPARE(session.selectedTalkgroup(), 3200u);
+    QVERIFY(takeEvents(session).empty());
+
+    // A manual selection pins the talkgroup.
+    QVERIFY(session.selectTalkgroup(3100, Origin::Manual, 0));
+    QVERIFY(!session.usesPriorityMode());
+    takeTcp(session);
+    takeEvents(session);
+    receive(session, talkerStart(3200, "YO2LOJ"), 0);
+    QCOMPARE(session.selectedTalkgroup(), 3100u);
+    QVERIFY(takeTcp(session).empty());
+
+    // A TALKER_STOP for someone else leaves the current talker alone.
+    receive(session, talkerStart(3100, "YO6SAY"), 0);
+    takeEvents(session);
+    receive(session, frameOf<Codec::TalkerStop>(uint32_t(3100), Codec::bytesOf(std::string("YO2LOJ"))), 0);
+    QVERIFY(takeEvents(session).empty());
+    receive(session, frameOf<Codec::TalkerStopV1>(Codec::bytesOf(std::string("YO6SAY"))), 0);
+    events = takeEvents(session);
+    QCOMPARE(events.size(), size_t(1));
+    QCOMPARE(events[0].type, Type::TalkerStopped);
+    QVERIFY(session.currentTalker().empty());
+}
+
+void ReflectorSessionTest::ownTalkerStartDisplacesCurrentTalker()
+{
+    ReflectorSession session;
+    session.setCredentials("N0CALL", "key");
+    connectSession(session, 91);
+
+    // V1 servers send no talkgroup, so there is nothing to filter on.
+    receive(session, frameOf<Codec::TalkerStartV1>(Codec::bytesOf(std::string("YO6SAY"))), 0);
+    QCOMPARE(session.currentTalker(), std::string("YO6SAY"));
+    takeEvents(session);
+
+    receive(session, talkerStart(91, "N0CALL"), 0);
+    const std::vector<ReflectorSession::Event> events = takeEvents(session);
+    QCOMPARE(events.size(), size_t(1));
+    QCOMPARE(events[0].type, Type::TalkerStopped);
+    QCOMPARE(events[0].text, std::string("YO6SAY"));
+    QVERIFY(session.currentTalker().empty());
+}
+
+void ReflectorSessionTest::selectionTimeoutFallsBackToMonitorMode()
+{
+    ReflectorSession session;
+    session.setTalkgroupSelectTimeoutSeconds(2);
+    session.setMonitoredTalkgroups(91, {}, 0);
+    connectSession(session, 91);
+    QCOMPARE(session.talkgroupSelectSecondsLeft(), 2);
+
+    // A busy channel holds the countdown.
+    session.setChannelBusy(true);
+    session.advance(1000);
+    QCOMPARE(session.talkgroupSelectSecondsLeft(), 2);
+    session.setChannelBusy(false);
+
+    session.advance(2000);
+    QCOMPARE(session.talkgroupSelectSecondsLeft(), 1);
+    QCOMPARE(session.selectedTalkgroup(), 91u);
+
+    session.advance(3000);
+    QCOMPARE(session.selectedTalkgroup(), 0u);
+    QVERIFY(session.usesPriorityMode());
+    QVERIFY(!session.talkgroupSelectionTimerActive());
+    QCOMPARE(takeTcp(session), frameOf<Codec::SelectTg>(uint32_t(0)));
+    const std::vector<ReflectorSession::Event> events = takeEvents(session);
+    QCOMPARE(events.size(), size_t(1));
+    QCOMPARE(events[0].type, Type::TalkgroupChanged);
+    QCOMPARE(events[0].talkgroup, 0u);
+
+    // Transmitting from TG 0 goes back to the default talkgroup.
+    QVERIFY(session.beginTransmit(3500));
+    QCOMPARE(session.selectedTalkgroup(), 91u);
+    QVERIFY(!session.usesPriorityMode());
+    QCOMPARE(session.talkgroupSelectSecondsLeft(), 2);
+
+    session.clearMonitoredTalkgroups();
+    session.selectTalkgroup(0, Origin::Manual, 3500);
+    QVERIFY(!session.beginTransmit(3500));
+}
+
+void ReflectorSessionTest::heartbeatsAndLivenessFollowTheClock()
+{
+    ReflectorSession session;
+    connectSession(session, 0);
+    QCOMPARE(session.nextTimeoutMs(), int64_t(ReflectorSession::HEARTBEAT_INTERVAL_MS));
+
+    session.advance(4999);
+    QVERIFY(takeTcp(session).empty());
+    session.advance(5000);
+    QCOMPARE(takeTcp(session), frameOf<Codec::Heartbeat>());
+    QCOMPARE(takeDatagrams(session).size(), size_t(1));
+
+    // A stall sends one heartbeat, not the backlog.
+    session.advance(23000);
+    QCOMPARE(takeTcp(session), frameOf<Codec::Heartbeat>());
+    QCOMPARE(session.nextTimeoutMs(), int64_t(28000));
+
+    // The watchdog arms once two server heartbeats give it a cadence.
+    receive(session, frameOf<Codec::Heartbeat>(), 24000);
+    QCOMPARE(session.livenessTimeoutMs(), 0);
+    receive(session, frameOf<Codec::Heartbeat>(), 34000);
+    QCOMPARE(session.livenessTimeoutMs(), 30000);
+    receive(session, frameOf<Codec::Heartbeat>(), 35000);
+    QCOMPARE(session.livenessTimeoutMs(), 30000);
+
+    session.advance(64999);
+    QCOMPARE(session.state(), ReflectorSession::State::Connected);
+    takeEvents(session);
+    session.advance(65000);
+    QCOMPARE(session.state(), ReflectorSession::State::Disconnected);
+    const std::vector<ReflectorSession::Event> events = takeEvents(session);
+    QCOMPARE(events.size(), size_t(1));
+    QCOMPARE(events[0].type, Type::LivenessExpired);
+    QCOMPARE(session.nextTimeoutMs(), int64_t(-1));
+}
+
+void ReflectorSessionTest::udpAudioBecomesEventsAndSharesSequence()
+{
+    ReflectorSession session;
+    connectSession(session, 91);
+    QCOMPARE(session.udpSequence().load(), uint16_t(1));
+
+    const std::string opus("\x01\x02\x03", 3);
+    const std::string audio = datagramOf<Codec::UdpAudio>(1, 44, Codec::bytesOf(opus));
+    session.receiveDatagram(audio.data(), static_cast<int>(audio.size()), 0);
+    std::vector<ReflectorSession::Event> events = takeEvents(session);
+    QCOMPARE(events.size(), size_t(1));
+    QCOMPARE(events[0].type, Type::AudioReceived);
+    QCOMPARE(events[0].sequence, uint16_t(44));
+    QCOMPARE(std::string(events[0].data, static_cast<size_t>(events[0].size)), opus);
+
+    const std::string flush = datagramOf<Codec::UdpFlushSamples>(1, 45);
+    session.receiveDatagram(flush.data(), static_cast<int>(flush.size()), 0);
+    events = takeEvents(session);
+    QCOMPARE(events.size(), size_t(1));
+    QCOMPARE(events[0].type, Type::FlushSamples);
+
+    // Whoever else sends audio draws from the same counter.
+    session.udpSequence().fetch_add(5);
+    session.sendAudio(opus.data(), static_cast<int>(opus.size()));
+    session.sendFlushSamples();
+    const std::vector<std::string> datagrams = takeDatagrams(session);
+    QCOMPARE(datagrams.size(), size_t(2));
+    QCOMPARE(datagrams[0], datagramOf<Codec::UdpAudio>(7, 6, Codec::bytesOf(opus)));
+    QCOMPARE(datagrams[1], datagramOf<Codec::UdpFlushSamples>(7, 7));
+}
+
+void ReflectorSessionTest::serverErrorDropsRejectedCredentials()
+{
+    ReflectorSession session;
+    session.setCredentials("N0CALL", "Jefe");
+    session.open(91, 0);
+    session.transportConnected(0);
+    takeTcp(session);
+    takeEvents(session);
+
+    receive(session, frameOf<Codec::Error>(Codec::bytesOf(std::string("ACCESS DENIED"))), 0);
+    QCOMPARE(session.state(), ReflectorSession::State::Disconnected);
+    const std::vector<ReflectorSession::Event> events = takeEvents(session);
+    QCOMPARE(events.size(), size_t(1));
+    QCOMPARE(events[0].type, Type::ServerError);
+    QVERIFY(events[0].flag);
+    QCOMPARE(events[0].text, std::string("ACCESS DENIED"));
+
+    // The next challenge is answered with an empty key.
+    const std::string challenge("what do ya want for nothing?");
+    receive(session, frameOf<Codec::AuthChallenge>(Codec::bytesOf(challenge)), 0);
+    const std::string response = takeTcp(session);
+    QVERIFY(response.find(std::string("\xef\xfc\xdf\x6a", 4)) == std::string::npos);
+}
+
+void ReflectorSessionTest::oversizedFrameFailsTheConnection()
+{
+    ReflectorSession session;
+    connectSession(session, 91);
+
+    const std::string prefix("\x7f\xff\xff\xff", 4);
+    receive(session, frameOf<Codec::Heartbeat>() + prefix, 0);
+    QCOMPARE(session.state(), ReflectorSession::State::Disconnected);
+    QCOMPARE(session.bufferedTcpBytes(), 0);
+    const std::vector<ReflectorSession::Event> events = takeEvents(session);
+    QCOMPARE(events.size(), size_t(1));
+    QCOMPARE(events[0].type, Type::FrameTooLarge);
+    QCOMPARE(events[0].value, 0x7fffffffu);
+}
+
+void ReflectorSessionTest::garbageInputIsReportedNotFatal()
+{
+    ReflectorSession session;
+    connectSession(session, 91);
+
+    receive(session, frameOf<Codec::Message<999>>() + std::string("\x00\x00\x00\x02\x00\x65", 6), 0);
+    std::vector<ReflectorSession::Event> events = takeEvents(session);
+    QCOMPARE(events.size(), size_t(2));
+    QCOMPARE(events[0].type, Type::UnknownMessage);
+    QCOMPARE(events[0].value, 999u);
+    QCOMPARE(events[1].type, Type::MalformedMessage);
+    QCOMPARE(events[1].value, uint32_t(MsgType::NODE_LIST));
+    QCOMPARE(session.state(), ReflectorSession::State::Connected);
+
+    // Random frames of known types; none may crash or stop the session
+    // answering.
+    std::mt19937 random(2025);
+    const uint16_t types[] = {1, 5, 6, 10, 12, 13, 100, 101, 102, 103, 104, 105, 107, 109, 110, 112, 113};
+    for (int i = 0; i < 20000; ++i) {
+        std::string frame(4, '\0');
+        const int payloadBytes = 2 + static_cast<int>(random() % 40);
+        frame[3] = static_cast<char>(payloadBytes);
+        const uint16_t type = types[random() % (sizeof(types) / sizeof(types[0]))];
+        frame.push_back(static_cast<char>(type >> 8));
+        frame.push_back(static_cast<char>(type));
+        for (int j = 2; j < payloadBytes; ++j) {
+            frame.push_back(static_cast<char>(random() % 4 == 0 ? random() : random() % 8));
+        }
+        receive(session, frame, i);
+
+        const std::string datagram = frame.substr(4);
+        session.receiveDatagram(datagram.data(), static_cast<int>(datagram.size()), i);
+        takeTcp(session);
+        takeDatagrams(session);
+        takeEvents(session);
+    }
+    QCOMPARE(session.bufferedTcpBytes(), 0);
+}
+
+QTEST_APPLESS_MAIN(ReflectorSessionTest)
+
+#include "tst_reflector_session.moc"
@@ -1,10 +1,12 @@
 #include <QtTest>
 
 #include "Resampler.h"
+#include "AllocationCounter.h"
 
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <random>
 #include <vector>
 
 namespace {
@@ -23,6 +25,64 @@ void verifyVectorClose(const std::vector<float>& actual,
                                 .arg(expected[i], 0, 'f', 6)));
     }
 }
+
+std::vector<float> noise(int count, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    std::vector<float> samples(static_cast<size_t>(count));
+    for (float &sample : samples) {
+        sample = distribution(generator);
+    }
+    return samples;
+}
+
+std::vector<float> sine(int sampleRate, double frequency, int count)
+{
+    std::vector<float> samples(static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        samples[static_cast<size_t>(i)] =
+                static_cast<float>(0.5 * std::sin(2.0 * 3.14159265358979323846 * frequency * i / sampleRate));
+    }
+    return samples;
+}
+
+// RMS of the second half, after the filter has settled.
+double settledRms(const std::vector<float> &samples)
+{
+    double energy = 0.0;
+    for (size_t i = samples.size() / 2; i < samples.size(); ++i) {
+        energy += static_cast<double>(samples[i]) * samples[i];
+    }
+    return std::sqrt(energy / static_cast<double>(samples.size() - samples.size() / 2));
+}
+
+double levelDb(int inRate, int outRate, Resampler::Quality quality, double frequency)
+{
+    Resampler resampler(inRate, outRate, 1, quality);
+    const std::vector<float> input = sine(inRate, frequency, inRate / 4);
+    return 20.0 * std::log10(settledRms(resampler.process(input.data(), static_cast<int>(input.size())))
+                             / (0.5 / std::sqrt(2.0)));
+}
+
+// Feeds input through in uneven chunks via the non-allocating overload.
+std::vector<float> processInChunks(Resampler &resampler, const std::vector<float> &input)
+{
+    std::vector<float> output;
+    std::vector<float> chunkOutput;
+    size_t offset = 0;
+    int chunk = 1;
+    while (offset < input.size()) {
+        const int count = std::min(chunk, static_cast<int>(input.size() - offset));
+        chunkOutput.resize(static_cast<size_t>(resampler.maxOutputSamples(count)));
+        const int written = resampler.process(input.data() + offset, count,
+                                              chunkOutput.data(), static_cast<int>(chunkOutput.size()));
+        output.insert(output.end(), chunkOutput.begin(), chunkOutput.begin() + written);
+        offset += static_cast<size_t>(count);
+        chunk = chunk % 97 + 13;
+    }
+    return output;
+}
 } // namespace
 
 class ResamplerTest : public QObject
@@ -33,11 +93,17 @@ private slots:
     void linearModeInterpolatesPredictably();
     void resetRestoresLinearModeState();
     void specializedModesProduceExpectedFrameCounts();
+    void chunkedProcessingMatchesSingleCall();
+    void nonAllocatingProcessRejectsShortOutput();
+    void simdKernelsMatchScalarKernel();
+    void processIntoCallerBufferDoesNotAllocate();
+    void sincModeRejectsAliasesThatLinearModeFolds();
+    void sincTiersTradeTapsForAttenuation();
 };
 
 void ResamplerTest::linearModeInterpolatesPredictably()
 {
-    Resampler resampler(2, 4, 1);
+    Resampler resampler(2, 4, 1, Resampler::Quality::Linear);
     const std::array<float, 2> input{2.0f, 4.0f};
 
     const auto output = resampler.process(input.data(), static_cast<int>(input.size()));
@@ -47,7 +113,7 @@ void ResamplerTest::linearModeInterpolatesPredictably()
 
 void ResamplerTest::resetRestoresLinearModeState()
 {
-    Resampler resampler(2, 4, 1);
+    Resampler resampler(2, 4, 1, Resampler::Quality::Linear);
     const std::array<float, 2> input{2.0f, 4.0f};
 
     const auto firstPass = resampler.process(input.data(), static_cast<int>(input.size()));
@@ -90,6 +156,131 @@ void ResamplerTest::specializedModesProduceExpectedFrameCounts()
     verifyVectorClose(interpolatedAfterReset, interpolated);
 }
 
+void ResamplerTest::chunkedProcessingMatchesSingleCall()
+{
+    const std::vector<float> input = noise(4800, 1);
+    const std::array<std::array<int, 2>, 3> ratePairs{{{48000, 16000}, {16000, 48000}, {44100, 16000}}};
+
+    for (const auto &rates : ratePairs) {
+        Resampler whole(rates[0], rates[1], 1);
+        Resampler chunked(rates[0], rates[1], 1);
+
+        const std::vector<float> expected = whole.process(input.data(), static_cast<int>(input.size()));
+        verifyVectorClose(processInChunks(chunked, input), expected);
+    }
+}
+
+void ResamplerTest::nonAllocatingProcessRejectsShortOutput()
+{
+    Resampler interpolator(16000, 48000, 1);
+    const std::vector<float> input = noise(160, 2);
+    QCOMPARE(interpolator.maxOutputSamples(160), 480);
+
+    std::vector<float> output(479);
+    QCOMPARE(interpolator.process(input.data(), 160, output.data(), 479), -1);
+
+    Resampler reference(16000, 48000, 1);
+    output.resize(480);
+    QCOMPARE(interpolator.process(input.data(), 160, output.data(), 480), 480);
+    verifyVectorClose(output, reference.process(input.data(), 160), 0.0f);
+
+    Resampler decimator(48000, 16000, 1);
+    const std::array<float, 2> pair{0.5f, 0.5f};
+    QCOMPARE(decimator.maxOutputSamples(2), 0);
+    QCOMPARE(decimator.process(pair.data(), 2, nullptr, 0), 0);
+    QCOMPARE(decimator.maxOutputSamples(1), 1);
+}
+
+void ResamplerTest::simdKernelsMatchScalarKernel()
+{
+    const std::vector<float> input = noise(9600, 3);
+    const std::array<Resampler::Kernel, 3> kernels{
+        Resampler::Kernel::Sse, Resampler::Kernel::Avx2, Resampler::Kernel::Neon};
+    const std::array<std::array<int, 2>, 2> ratePairs{{{48000, 16000}, {16000, 48000}}};
+
+    for (const auto &rates : ratePairs) {
+        Resampler scalar(rates[0], rates[1], 1);
+        QVERIFY(scalar.setKernel(Resampler::Kernel::Scalar));
+        const std::vector<float> expected = scalar.process(input.data(), static_cast<int>(input.size()));
+
+        for (Resampler::Kernel kernel : kernels) {
+            Resampler resampler(rates[0], rates[1], 1);
+            if (!resampler.setKernel(kernel)) {
+                QVERIFY(!Resampler::isKernelSupported(kernel));
+                continue;
+            }
+            verifyVectorClose(resampler.process(input.data(), static_cast<int>(input.size())), expected, 1.0e-6f);
+        }
+    }
+    QVERIFY(Resampler::isKernelSupported(Resampler::bestKernel()));
+}
+
+void ResamplerTest::processIntoCallerBufferDoesNotAllocate()
+{
+    Resampler decimator(48000, 16000, 1);
+    Resampler interpolator(16000, 48000, 1);
+    Resampler linear(44100, 16000, 1);
+    const std::vector<float> input = noise(960, 4);
+    std::vector<float> output(3 * input.size());
+
+    long allocations = 0;
+    {
+        AllocationCounter counter;
+        for (int i = 0; i < 20; ++i) {
+            decimator.process(input.data(), 960, output.data(), static_cast<int>(output.size()));
+            interpolator.process(input.data(), 320, output.data(), static_cast<int>(output.size()));
+            linear.process(input.data(), 882, output.data(), static_cast<int>(output.size()));
+        }
+        allocations = counter.count();
+    }
+    QCOMPARE(allocations, 0L);
+}
+
+void ResamplerTest::sincModeRejectsAliasesThatLinearModeFolds()
+{
+    // 12 kHz at 44.1 kHz folds to 4 kHz at 16 kHz.
+    const double linearAlias = levelDb(44100, 16000, Resampler::Quality::Linear, 12000.0);
+    const double sincAlias = levelDb(44100, 16000, Resampler::Quality::Balanced, 12000.0);
+    QVERIFY2(linearAlias > -20.0, qPrintable(QString::number(linearAlias)));
+    QVERIFY2(sincAlias < -70.0, qPrintable(QString::number(sincAlias)));
+
+    const double passband = levelDb(44100, 16000, Resampler::Quality::Balanced, 1000.0);
+    QVERIFY2(std::fabs(passband) < 0.1, qPrintable(QString::number(passband)));
+
+    // 8 kHz SCO capture: images of a 3 kHz tone land at 5 kHz.
+    const double upsampled = levelDb(8000, 16000, Resampler::Quality::Balanced, 3000.0);
+    QVERIFY2(std::fabs(upsampled) < 0.1, qPrintable(QString::number(upsampled)));
+    Resampler interpolator(8000, 16000, 1);
+    QCOMPARE(interpolator.maxOutputSamples(80), 161);
+    const std::vector<float> input = sine(8000, 3000.0, 80);
+    QCOMPARE(interpolator.process(input.data(), 80).size(), size_t(160));
+}
+
+void ResamplerTest::sincTiersTradeTapsForAttenuation()
+{
+    const std::array<Resampler::Quality, 3> tiers{
+        Resampler::Quality::Fast, Resampler::Quality::Balanced, Resampler::Quality::High};
+
+    int previousTaps = 0;
+    double previousAlias = 0.0;
+    for (Resampler::Quality quality : tiers) {
+        Resampler resampler(44100, 16000, 1, quality);
+        QCOMPARE(resampler.quality(), quality);
+        QVERIFY(resampler.filterTaps() > previousTaps);
+        previousTaps = resampler.filterTaps();
+
+        const double alias = levelDb(44100, 16000, quality, 10000.0);
+        // High sits near the float noise floor, so only require a clear step.
+        QVERIFY2(alias < previousAlias - 5.0, qPrintable(QString::number(alias)));
+        previousAlias = alias;
+    }
+
+    // The SvxLink filters and multichannel audio ignore the tier.
+    QCOMPARE(Resampler(48000, 16000, 1, Resampler::Quality::High).filterTaps(),
+             Resampler(48000, 16000, 1, Resampler::Quality::Fast).filterTaps());
+    QCOMPARE(Resampler(44100, 16000, 2).quality(), Resampler::Quality::Linear);
+}
+
 QTEST_APPLESS_MAIN(ResamplerTest)
 
 #include "tst_resampler.moc"
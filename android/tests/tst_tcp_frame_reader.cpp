@@ -0,0 +1,185 @@
+#include <QtTest>
+
+#include "TcpFrameReader.h"
+
+#include <cstring>
+#include <string>
+
+class TcpFrameReaderTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void framesSplitAcrossReadsAreReassembled();
+    void burstIsTakenWithoutCompaction();
+    void partialTailMovesOnlyWhenRoomIsNeeded();
+    void oversizedLengthIsRejected();
+    void payloadReadsAreBoundsChecked();
+};
+
+namespace {
+std::string frame(const std::string &payload)
+{
+    const uint32_t size = static_cast<uint32_t>(payload.size());
+    std::string bytes;
+    bytes.push_back(static_cast<char>(size >> 24));
+    bytes.push_back(static_cast<char>(size >> 16));
+    bytes.push_back(static_cast<char>(size >> 8));
+    bytes.push_back(static_cast<char>(size));
+    return bytes + payload;
+}
+
+// A NODE_JOINED payload: type 102, then a length-prefixed callsign.
+std::string nodeJoined(const std::string &callsign)
+{
+    std::string payload("\x00\x66", 2);
+    payload.push_back(static_cast<char>(callsign.size() >> 8));
+    payload.push_back(static_cast<char>(callsign.size()));
+    return payload + callsign;
+}
+
+std::string text(const PayloadReader &bytes)
+{
+    return std::string(bytes.data(), static_cast<size_t>(bytes.size()));
+}
+}
+
+void TcpFrameReaderTest::framesSplitAcrossReadsAreReassembled()
+{
+    TcpFrameReader reader;
+    const std::string stream = frame(nodeJoined("YO6SAY")) + frame(nodeJoined("A2")) + frame(std::string());
+    PayloadReader payload;
+    std::string callsigns;
+    int frames = 0;
+
+    // One byte per read is the worst a socket can split a stream.
+    for (char byte : stream) {
+        reader.append(&byte, 1);
+        while (reader.next(payload) == TcpFrameReader::Result::Frame) {
+            ++frames;
+            if (payload.atEnd()) {
+                continue;
+            }
+            QCOMPARE(payload.readU16(), uint16_t(102));
+            callsigns += text(payload.readLengthPrefixed()) + ",";
+            QVERIFY(payload.ok());
+            QVERIFY(payload.atEnd());
+        }
+    }
+
+    QCOMPARE(frames, 3);
+    QCOMPARE(callsigns, std::string("YO6SAY,A2,"));
+    QCOMPARE(reader.buffered(), 0);
+}
+
+void TcpFrameReaderTest::burstIsTakenWithoutCompaction()
+{
+    TcpFrameReader reader(TcpFrameReader::DEFAULT_MAX_FRAME_BYTES, 64 * 1024);
+    std::string burst;
+    for (int i = 0; i < 2000; ++i) {
+        burst += frame(nodeJoined("N" + std::to_string(i)));
+    }
+    QVERIFY(burst.size() < 64 * 1024);
+
+    reader.append(burst.data(), static_cast<int>(burst.size()));
+    PayloadReader payload;
+    int frames = 0;
+    while (reader.next(payload) == TcpFrameReader::Result::Frame) {
+        // Views point into the reader's own buffer, not at copies.
+        QCOMPARE(payload.readU16(), uint16_t(102));
+        QCOMPARE(text(payload.readLengthPrefixed()), "N" + std::to_string(frames));
+        ++frames;
+    }
+
+    QCOMPARE(frames, 2000);
+    QCOMPARE(reader.compactedBytes(), uint64_t(0));
+    QCOMPARE(reader.capacity(), 64 * 1024);
+    QCOMPARE(reader.buffered(), 0);
+}
+
+void TcpFrameReaderTest::partialTailMovesOnlyWhenRoomIsNeeded()
+{
+    TcpFrameReader reader(TcpFrameReader::DEFAULT_MAX_FRAME_BYTES, 32);
+    const std::string first = frame(nodeJoined("YO6SAY"));
+    const std::string second = frame(nodeJoined("YO6ABC"));
+    QCOMPARE(first.size(), size_t(14));
+
+    // A whole frame and the first 10 bytes of the next fill 24 of 32 bytes.
+    const std::string stream = first + second;
+    reader.append(stream.data(), 24);
+    PayloadReader payload;
+    QCOMPARE(reader.next(payload), TcpFrameReader::Result::Frame);
+    QCOMPARE(reader.next(payload), TcpFrameReader::Result::NeedMore);
+    QCOMPARE(reader.buffered(), 10);
+
+    // The remaining 4 bytes fit behind the tail, so nothing moves.
+    reader.append(stream.data() + 24, 4);
+    QCOMPARE(reader.compactedBytes(), uint64_t(0));
+    QCOMPARE(reader.next(payload), TcpFrameReader::Result::Frame);
+    payload.readU16();
+    QCOMPARE(text(payload.readLengthPrefixed()), std::string("YO6ABC"));
+
+    // Drained, so the next read starts at the front without a move.
+    reader.append(stream.data(), 24);
+    QCOMPARE(reader.compactedBytes(), uint64_t(0));
+    QCOMPARE(reader.next(payload), TcpFrameReader::Result::Frame);
+
+    // 14 bytes do not fit behind the tail, so the 10-byte partial frame,
+    // and nothing else, moves to the front.
+    const std::string more = stream.substr(24, 4) + first.substr(0, 10);
+    reader.append(more.data(), static_cast<int>(more.size()));
+    QCOMPARE(reader.compactedBytes(), uint64_t(10));
+    QCOMPARE(reader.capacity(), 32);
+    QCOMPARE(reader.next(payload), TcpFrameReader::Result::Frame);
+    payload.readU16();
+    QCOMPARE(text(payload.readLengthPrefixed()), std::string("YO6ABC"));
+    QCOMPARE(reader.next(payload), TcpFrameReader::Result::NeedMore);
+    QCOMPARE(reader.buffered(), 10);
+}
+
+void TcpFrameReaderTest::oversizedLengthIsRejected()
+{
+    TcpFrameReader reader(1024);
+    const char header[] = {0x00, 0x00, 0x04, 0x01};
+    reader.append(header, sizeof(header));
+
+    PayloadReader payload;
+    QCOMPARE(reader.next(payload), TcpFrameReader::Result::Oversized);
+    QCOMPARE(reader.lastFrameBytes(), uint32_t(1025));
+
+    reader.clear();
+    QCOMPARE(reader.buffered(), 0);
+    QCOMPARE(reader.next(payload), TcpFrameReader::Result::NeedMore);
+}
+
+void TcpFrameReaderTest::payloadReadsAreBoundsChecked()
+{
+    // NODE_JOINED claiming a 6-byte callsign with only 3 bytes present.
+    const char bytes[] = {0x00, 0x66, 0x00, 0x06, 'Y', 'O', '6'};
+    PayloadReader payload(bytes, sizeof(bytes));
+
+    QCOMPARE(payload.readU16(), uint16_t(102));
+    const PayloadReader callsign = payload.readLengthPrefixed();
+    QVERIFY(!payload.ok());
+    QCOMPARE(callsign.size(), 0);
+
+    // Failure sticks and later reads return zero.
+    QCOMPARE(payload.readU8(), uint8_t(0));
+    QCOMPARE(payload.readU32(), uint32_t(0));
+    QVERIFY(!payload.ok());
+
+    // A copy probes ahead without moving the original.
+    PayloadReader original(bytes, sizeof(bytes));
+    PayloadReader probe = original;
+    QCOMPARE(probe.readU32(), uint32_t(0x00660006));
+    QCOMPARE(original.remaining(), int(sizeof(bytes)));
+
+    const char floatBytes[] = {0x3f, (char)0x80, 0x00, 0x00};
+    PayloadReader floats(floatBytes, sizeof(floatBytes));
+    QCOMPARE(floats.readFloat(), 1.0f);
+    QVERIFY(floats.atEnd());
+    QVERIFY(floats.ok());
+}
+
+QTEST_APPLESS_MAIN(TcpFrameReaderTest)
+#include "tst_tcp_frame_reader.moc"
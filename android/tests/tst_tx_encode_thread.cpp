@@ -0,0 +1,104 @@
+#include <QtTest>
+
+#include "TxEncodeThread.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+class TxEncodeThreadTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void handlerRunsOnlyWhenWoken();
+    void handlerRunsOnTheEncodeThread();
+    void stopWaitsForTheRunningHandler();
+    void restartsAfterStop();
+};
+
+namespace {
+bool waitFor(const std::atomic<int> &counter, int expected)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (counter.load() < expected) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+}
+
+void TxEncodeThreadTest::handlerRunsOnlyWhenWoken()
+{
+    std::atomic<int> calls{0};
+    TxEncodeThread thread([&calls]() { ++calls; });
+
+    QVERIFY(thread.start());
+    QVERIFY(!thread.start());
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    QCOMPARE(calls.load(), 0);
+
+    thread.wake();
+    QVERIFY(waitFor(calls, 1));
+    thread.stop();
+    QVERIFY(!thread.isRunning());
+    QCOMPARE(calls.load(), 1);
+}
+
+void TxEncodeThreadTest::handlerRunsOnTheEncodeThread()
+{
+    std::atomic<int> calls{0};
+    std::thread::id handlerThread;
+    TxEncodeThread thread([&]() {
+        handlerThread = std::this_thread::get_id();
+        ++calls;
+    });
+
+    thread.start();
+    thread.wake();
+    QVERIFY(waitFor(calls, 1));
+    thread.stop();
+
+    QVERIFY(handlerThread != std::this_thread::get_id());
+}
+
+void TxEncodeThreadTest::stopWaitsForTheRunningHandler()
+{
+    std::atomic<int> started{0};
+    std::atomic<bool> finished{false};
+    TxEncodeThread thread([&]() {
+        ++started;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        finished = true;
+    });
+
+    thread.start();
+    thread.wake();
+    QVERIFY(waitFor(started, 1));
+    thread.stop();
+
+    QVERIFY(finished.load());
+}
+
+void TxEncodeThreadTest::restartsAfterStop()
+{
+    std::atomic<int> calls{0};
+    TxEncodeThread thread([&calls]() { ++calls; });
+
+    thread.start();
+    thread.wake();
+    QVERIFY(waitFor(calls, 1));
+    thread.stop();
+
+    QVERIFY(thread.start());
+    thread.wake();
+    QVERIFY(waitFor(calls, 2));
+    thread.stop();
+}
+
+QTEST_APPLESS_MAIN(TxEncodeThreadTest)
+
+#include "tst_tx_encode_thread.moc"
@@ -0,0 +1,208 @@
+#include <QtTest>
+
+#include "AllocationCounter.h"
+#include "UdpAudioSender.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+class UdpAudioSenderTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void sendsFramesBehindPrebuiltHeader();
+    void sendsBurstInOneBatch();
+    void dropsFramesWhileNotTransmitting();
+    void flushesWhenPoolFills();
+    void sendPathDoesNotAllocate();
+};
+
+namespace {
+constexpr uint16_t kClientId = 0x1234;
+
+// A bound loopback receiver and an unconnected socket to send from.
+struct SocketPair {
+    int receiver = -1;
+    int sender = -1;
+    sockaddr_in address{};
+
+    SocketPair()
+    {
+        receiver = ::socket(AF_INET, SOCK_DGRAM, 0);
+        sender = ::socket(AF_INET, SOCK_DGRAM, 0);
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ::bind(receiver, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        socklen_t length = sizeof(address);
+        ::getsockname(receiver, reinterpret_cast<sockaddr*>(&address), &length);
+    }
+
+    ~SocketPair()
+    {
+        ::close(receiver);
+        ::close(sender);
+    }
+
+    bool openSender(UdpAudioSender &udpSender) const
+    {
+        return udpSender.open(sender, reinterpret_cast<const uint8_t*>(&address.sin_addr), 4,
+                              ntohs(address.sin_port), kClientId);
+    }
+
+    std::vector<unsigned char> receive() const
+    {
+        std::vector<unsigned char> datagram(2048);
+        const ssize_t size = ::recv(receiver, datagram.data(), datagram.size(), MSG_DONTWAIT);
+        datagram.resize(size > 0 ? static_cast<size_t>(size) : 0);
+        return datagram;
+    }
+
+    std::vector<unsigned char> receiveWaiting() const
+    {
+        for (int attempt = 0; attempt < 200; ++attempt) {
+            std::vector<unsigned char> datagram = receive();
+            if (!datagram.empty()) {
+                return datagram;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return {};
+    }
+};
+
+uint16_t readBigEndian16(const std::vector<unsigned char> &data, size_t offset)
+{
+    return static_cast<uint16_t>((data[offset] << 8) | data[offset + 1]);
+}
+
+void commitPayload(UdpAudioSender &sender, unsigned char fill, int size)
+{
+    std::memset(sender.beginFrame(), fill, static_cast<size_t>(size));
+    sender.commitFrame(size);
+}
+}
+
+void UdpAudioSenderTest::sendsFramesBehindPrebuiltHeader()
+{
+    SocketPair sockets;
+    std::atomic<uint16_t> sequence{500};
+    UdpAudioSender sender(sequence);
+    QVERIFY(sockets.openSender(sender));
+    sender.setTransmitEnabled(true);
+    QVERIFY(sender.isActive());
+
+    commitPayload(sender, 0x5a, 37);
+    QCOMPARE(sender.flush(), 1);
+
+    const std::vector<unsigned char> datagram = sockets.receiveWaiting();
+    QCOMPARE(static_cast<int>(datagram.size()), UdpAudioSender::HEADER_BYTES + 37);
+    QCOMPARE(readBigEndian16(datagram, 0), Svxlink::UdpMsgType::UDP_AUDIO);
+    QCOMPARE(readBigEndian16(datagram, 2), kClientId);
+    QCOMPARE(readBigEndian16(datagram, 4), uint16_t(500));
+    QCOMPARE(readBigEndian16(datagram, 6), uint16_t(37));
+    QCOMPARE(datagram.back(), static_cast<unsigned char>(0x5a));
+    QCOMPARE(sequence.load(), uint16_t(501));
+}
+
+void UdpAudioSenderTest::sendsBurstInOneBatch()
+{
+    SocketPair sockets;
+    std::atomic<uint16_t> sequence{0};
+    UdpAudioSender sender(sequence);
+    QVERIFY(sockets.openSender(sender));
+    sender.setTransmitEnabled(true);
+
+    for (int i = 0; i < 3; ++i) {
+        commitPayload(sender, static_cast<unsigned char>(i), 20 + i);
+    }
+    QCOMPARE(sender.pendingFrames(), 3);
+    QCOMPARE(sender.flush(), 3);
+    QCOMPARE(sender.pendingFrames(), 0);
+    QCOMPARE(sender.datagramsSent(), uint64_t(3));
+#if defined(__linux__)
+    QCOMPARE(sender.batchesSent(), uint64_t(1));
+#endif
+
+    for (uint16_t i = 0; i < 3; ++i) {
+        const std::vector<unsigned char> datagram = sockets.receiveWaiting();
+        QCOMPARE(readBigEndian16(datagram, 4), i);
+        QCOMPARE(readBigEndian16(datagram, 6), uint16_t(20 + i));
+    }
+}
+
+void UdpAudioSenderTest::dropsFramesWhileNotTransmitting()
+{
+    SocketPair sockets;
+    std::atomic<uint16_t> sequence{7};
+    UdpAudioSender sender(sequence);
+    QVERIFY(sockets.openSender(sender));
+    QVERIFY(!sender.isActive());
+
+    commitPayload(sender, 1, 10);
+    QCOMPARE(sender.flush(), 0);
+    QCOMPARE(sender.pendingFrames(), 0);
+
+    sender.setTransmitEnabled(true);
+    sender.close();
+    QVERIFY(!sender.isActive());
+    commitPayload(sender, 1, 10);
+    QCOMPARE(sender.flush(), 0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    QVERIFY(sockets.receive().empty());
+    QCOMPARE(sequence.load(), uint16_t(7));
+}
+
+void UdpAudioSenderTest::flushesWhenPoolFills()
+{
+    SocketPair sockets;
+    std::atomic<uint16_t> sequence{0};
+    UdpAudioSender sender(sequence);
+    QVERIFY(sockets.openSender(sender));
+    sender.setTransmitEnabled(true);
+
+    for (int i = 0; i <= UdpAudioSender::POOL_SIZE; ++i) {
+        commitPayload(sender, static_cast<unsigned char>(i), 12);
+    }
+
+    QCOMPARE(sender.datagramsSent(), uint64_t(UdpAudioSender::POOL_SIZE));
+    QCOMPARE(sender.pendingFrames(), 1);
+    QCOMPARE(sender.flush(), 1);
+    QCOMPARE(sequence.load(), uint16_t(UdpAudioSender::POOL_SIZE + 1));
+}
+
+void UdpAudioSenderTest::sendPathDoesNotAllocate()
+{
+    SocketPair sockets;
+    std::atomic<uint16_t> sequence{0};
+    UdpAudioSender sender(sequence);
+    QVERIFY(sockets.openSender(sender));
+    sender.setTransmitEnabled(true);
+
+    long allocations = 0;
+    {
+        AllocationCounter counter;
+        for (int i = 0; i < 50; ++i) {
+            commitPayload(sender, static_cast<unsigned char>(i), 60);
+            sender.flush();
+        }
+        allocations = counter.count();
+    }
+
+    QCOMPARE(allocations, 0L);
+    QCOMPARE(sender.datagramsSent(), uint64_t(50));
+}
+
+QTEST_APPLESS_MAIN(UdpAudioSenderTest)
+
+#include "tst_udp_audio_sender.moc"
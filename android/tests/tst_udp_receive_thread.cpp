@@ -0,0 +1,218 @@
+#include <QtTest>
+
+#include "UdpReceiveThread.h"
+#include "ReflectorProtocol.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class UdpReceiveThreadTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void deliversAudioPayloadsParsedInPlace();
+    void passesControlMessagesAndDropsHeartbeats();
+    void countsMalformedDatagrams();
+    void stopsAndRestartsOnTheSameSocket();
+};
+
+namespace {
+struct ReceivedAudio {
+    uint16_t sequence = 0;
+    std::vector<unsigned char> payload;
+};
+
+struct Collector {
+    std::mutex mutex;
+    std::vector<ReceivedAudio> audio;
+    std::vector<std::vector<unsigned char>> control;
+
+    UdpReceiveThread::AudioHandler audioHandler()
+    {
+        return [this](const unsigned char* payload, int size, uint16_t sequence, int64_t) {
+            std::lock_guard<std::mutex> lock(mutex);
+            audio.push_back({sequence, std::vector<unsigned char>(payload, payload + size)});
+        };
+    }
+
+    UdpReceiveThread::ControlHandler controlHandler()
+    {
+        return [this](const unsigned char* datagram, int size, int64_t) {
+            std::lock_guard<std::mutex> lock(mutex);
+            control.emplace_back(datagram, datagram + size);
+        };
+    }
+
+    size_t audioCount()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return audio.size();
+    }
+
+    size_t controlCount()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return control.size();
+    }
+};
+
+// A bound loopback receiver and a sender connected to it.
+struct SocketPair {
+    int receiver = -1;
+    int sender = -1;
+
+    SocketPair()
+    {
+        receiver = ::socket(AF_INET, SOCK_DGRAM, 0);
+        sender = ::socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ::bind(receiver, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        socklen_t length = sizeof(address);
+        ::getsockname(receiver, reinterpret_cast<sockaddr*>(&address), &length);
+        ::connect(sender, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    }
+
+    ~SocketPair()
+    {
+        ::close(receiver);
+        ::close(sender);
+    }
+
+    void send(const std::vector<unsigned char> &datagram) const
+    {
+        ::send(sender, datagram.data(), datagram.size(), 0);
+    }
+};
+
+void appendBigEndian16(std::vector<unsigned char> &datagram, uint16_t value)
+{
+    datagram.push_back(static_cast<unsigned char>(value >> 8));
+    datagram.push_back(static_cast<unsigned char>(value & 0xff));
+}
+
+std::vector<unsigned char> udpMessage(uint16_t type, uint16_t sequence)
+{
+    std::vector<unsigned char> datagram;
+    appendBigEndian16(datagram, type);
+    appendBigEndian16(datagram, 42);
+    appendBigEndian16(datagram, sequence);
+    return datagram;
+}
+
+std::vector<unsigned char> audioMessage(uint16_t sequence, int payloadSize)
+{
+    std::vector<unsigned char> datagram = udpMessage(Svxlink::UdpMsgType::UDP_AUDIO, sequence);
+    appendBigEndian16(datagram, static_cast<uint16_t>(payloadSize));
+    for (int i = 0; i < payloadSize; ++i) {
+        datagram.push_back(static_cast<unsigned char>(sequence + i));
+    }
+    return datagram;
+}
+
+template<typename Predicate>
+bool waitFor(Predicate predicate)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+}
+
+void UdpReceiveThreadTest::deliversAudioPayloadsParsedInPlace()
+{
+    SocketPair sockets;
+    Collector collector;
+    UdpReceiveThread thread(collector.audioHandler(), collector.controlHandler());
+    QVERIFY(thread.start(sockets.receiver));
+
+    for (uint16_t sequence = 100; sequence < 140; ++sequence) {
+        sockets.send(audioMessage(sequence, 40));
+    }
+
+    QVERIFY(waitFor([&collector]() { return collector.audioCount() == 40; }));
+    thread.stop();
+
+    QCOMPARE(collector.audio.front().sequence, uint16_t(100));
+    QCOMPARE(collector.audio.back().sequence, uint16_t(139));
+    QCOMPARE(collector.audio.back().payload.size(), size_t(40));
+    QCOMPARE(collector.audio.back().payload[1], static_cast<unsigned char>(140));
+    QCOMPARE(thread.datagramsReceived(), uint64_t(40));
+    QVERIFY(thread.batchesReceived() <= thread.datagramsReceived());
+    QCOMPARE(collector.controlCount(), size_t(0));
+}
+
+void UdpReceiveThreadTest::passesControlMessagesAndDropsHeartbeats()
+{
+    SocketPair sockets;
+    Collector collector;
+    UdpReceiveThread thread(collector.audioHandler(), collector.controlHandler());
+    QVERIFY(thread.start(sockets.receiver));
+
+    sockets.send(udpMessage(Svxlink::UdpMsgType::UDP_HEARTBEAT, 1));
+    sockets.send(udpMessage(Svxlink::UdpMsgType::UDP_FLUSH_SAMPLES, 2));
+    sockets.send(audioMessage(3, 10));
+
+    QVERIFY(waitFor([&collector]() { return collector.audioCount() == 1; }));
+    thread.stop();
+
+    QCOMPARE(thread.datagramsReceived(), uint64_t(3));
+    QCOMPARE(collector.control.size(), size_t(1));
+    QCOMPARE(collector.control.front(), udpMessage(Svxlink::UdpMsgType::UDP_FLUSH_SAMPLES, 2));
+}
+
+void UdpReceiveThreadTest::countsMalformedDatagrams()
+{
+    SocketPair sockets;
+    Collector collector;
+    UdpReceiveThread thread(collector.audioHandler(), collector.controlHandler());
+    QVERIFY(thread.start(sockets.receiver));
+
+    sockets.send({0x00, 0x65});
+    std::vector<unsigned char> overstated = audioMessage(5, 10);
+    overstated[7] = 200;
+    sockets.send(overstated);
+    sockets.send(audioMessage(6, 10));
+
+    QVERIFY(waitFor([&collector]() { return collector.audioCount() == 1; }));
+    thread.stop();
+
+    QCOMPARE(thread.malformedDatagrams(), uint64_t(2));
+    QCOMPARE(collector.audio.front().sequence, uint16_t(6));
+}
+
+void UdpReceiveThreadTest::stopsAndRestartsOnTheSameSocket()
+{
+    SocketPair sockets;
+    Collector collector;
+    UdpReceiveThread thread(collector.audioHandler(), collector.controlHandler());
+
+    QVERIFY(thread.start(sockets.receiver));
+    QVERIFY(!thread.start(sockets.receiver));
+    thread.stop();
+    QVERIFY(!thread.isRunning());
+
+    QVERIFY(thread.start(sockets.receiver));
+    sockets.send(audioMessage(9, 4));
+    QVERIFY(waitFor([&collector]() { return collector.audioCount() == 1; }));
+    thread.stop();
+}
+
+QTEST_APPLESS_MAIN(UdpReceiveThreadTest)
+
+#include "tst_udp_receive_thread.moc"
@@ -0,0 +1,176 @@
+#include <QtTest>
+
+#include "VoiceActivityDetector.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+class VoiceActivityDetectorTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void flatnessSeparatesNoiseFromVoicedSpeech();
+    void steadyNoiseSettlesToPause();
+    void speechOverNoiseStaysActive();
+    void hangoverHoldsWordEndings();
+    void overOpeningWithSpeechIsDetected();
+    void resetReturnsToActive();
+};
+
+namespace {
+constexpr int kFrame = VoiceActivityDetector::FRAME_SAMPLES;
+constexpr int kFramesPerSecond = 50;
+constexpr double kPi = 3.14159265358979323846;
+
+class Signal
+{
+public:
+    explicit Signal(unsigned seed = 1) : m_rng(seed) {}
+
+    // Gaussian noise at levelDb RMS.
+    void noise(std::vector<float>& frame, float levelDb)
+    {
+        std::normal_distribution<float> gauss(0.0f, std::pow(10.0f, levelDb / 20.0f));
+        for (float& sample : frame) {
+            sample = gauss(m_rng);
+        }
+    }
+
+    // Vowel-like harmonic series on a 140 Hz pitch with a 4 Hz syllable
+    // envelope, added to the frame at roughly levelDb RMS.
+    void addSpeech(std::vector<float>& frame, float levelDb)
+    {
+        const double amplitude = std::pow(10.0, levelDb / 20.0) * 0.6;
+        for (float& sample : frame) {
+            const double t = static_cast<double>(m_speechSample++) / 16000.0;
+            const double envelope = 0.55 + 0.45 * std::sin(2.0 * kPi * 4.0 * t);
+            double value = 0.0;
+            for (int harmonic = 1; harmonic * 140 < 4000; ++harmonic) {
+                const double frequency = harmonic * 140.0;
+                // Two broad formants around 600 Hz and 1.8 kHz
+                const double formant = 1.0 / (1.0 + std::pow((frequency - 600.0) / 300.0, 2.0))
+                        + 0.5 / (1.0 + std::pow((frequency - 1800.0) / 400.0, 2.0));
+                value += formant * std::sin(2.0 * kPi * frequency * t);
+            }
+            sample += static_cast<float>(amplitude * envelope * value);
+        }
+    }
+
+private:
+    std::mt19937 m_rng;
+    long m_speechSample = 0;
+};
+
+int countActive(VoiceActivityDetector& vad, Signal& signal, int frames, float noiseDb, float speechDb)
+{
+    std::vector<float> frame(kFrame);
+    int active = 0;
+    for (int i = 0; i < frames; ++i) {
+        signal.noise(frame, noiseDb);
+        if (speechDb > VoiceActivityDetector::SILENCE_DB) {
+            signal.addSpeech(frame, speechDb);
+        }
+        active += vad.process(frame.data()) ? 1 : 0;
+    }
+    return active;
+}
+}
+
+void VoiceActivityDetectorTest::flatnessSeparatesNoiseFromVoicedSpeech()
+{
+    VoiceActivityDetector vad;
+    Signal signal;
+    std::vector<float> frame(kFrame);
+
+    double noiseFlatness = 0.0;
+    for (int i = 0; i < 20; ++i) {
+        signal.noise(frame, -40.0f);
+        vad.process(frame.data());
+        noiseFlatness += vad.spectralFlatness() / 20.0;
+    }
+
+    double speechFlatness = 0.0;
+    for (int i = 0; i < 20; ++i) {
+        signal.noise(frame, -60.0f);
+        signal.addSpeech(frame, -20.0f);
+        vad.process(frame.data());
+        speechFlatness += vad.spectralFlatness() / 20.0;
+    }
+
+    QVERIFY2(noiseFlatness > 0.45, qPrintable(QString::number(noiseFlatness)));
+    QVERIFY2(speechFlatness < 0.2, qPrintable(QString::number(speechFlatness)));
+}
+
+void VoiceActivityDetectorTest::steadyNoiseSettlesToPause()
+{
+    // Quiet room and loud street: both become "pause" once the floor has
+    // caught up, the loud one after a few seconds.
+    for (const float noiseDb : {-55.0f, -40.0f, -25.0f}) {
+        VoiceActivityDetector vad;
+        Signal signal;
+        countActive(vad, signal, 6 * kFramesPerSecond, noiseDb, VoiceActivityDetector::SILENCE_DB);
+        QVERIFY2(!vad.isActive(), qPrintable(QString::number(noiseDb)));
+        QCOMPARE(countActive(vad, signal, kFramesPerSecond, noiseDb, VoiceActivityDetector::SILENCE_DB), 0);
+    }
+}
+
+void VoiceActivityDetectorTest::speechOverNoiseStaysActive()
+{
+    VoiceActivityDetector vad;
+    Signal signal;
+    countActive(vad, signal, 2 * kFramesPerSecond, -45.0f, VoiceActivityDetector::SILENCE_DB);
+    QVERIFY(!vad.isActive());
+
+    // Every frame of a 5 s over, including the syllable dips.
+    const int frames = 5 * kFramesPerSecond;
+    QCOMPARE(countActive(vad, signal, frames, -45.0f, -22.0f), frames);
+    // The floor has not crept up into the speech.
+    QVERIFY2(vad.noiseFloorDb() < -35.0f, qPrintable(QString::number(vad.noiseFloorDb())));
+}
+
+void VoiceActivityDetectorTest::hangoverHoldsWordEndings()
+{
+    VoiceActivityDetector vad;
+    Signal signal;
+    countActive(vad, signal, kFramesPerSecond, -50.0f, VoiceActivityDetector::SILENCE_DB);
+    countActive(vad, signal, kFramesPerSecond, -50.0f, -20.0f);
+    QVERIFY(vad.isActive());
+
+    std::vector<float> frame(kFrame);
+    int hangoverFrames = 0;
+    for (int i = 0; i < 2 * VoiceActivityDetector::HANGOVER_FRAMES; ++i) {
+        signal.noise(frame, -50.0f);
+        if (!vad.process(frame.data())) {
+            break;
+        }
+        ++hangoverFrames;
+    }
+    QCOMPARE(hangoverFrames, VoiceActivityDetector::HANGOVER_FRAMES - 1);
+}
+
+void VoiceActivityDetectorTest::overOpeningWithSpeechIsDetected()
+{
+    VoiceActivityDetector vad;
+    Signal signal;
+
+    const int frames = 3 * kFramesPerSecond;
+    QCOMPARE(countActive(vad, signal, frames, -50.0f, -20.0f), frames);
+}
+
+void VoiceActivityDetectorTest::resetReturnsToActive()
+{
+    VoiceActivityDetector vad;
+    Signal signal;
+    countActive(vad, signal, 2 * kFramesPerSecond, -45.0f, VoiceActivityDetector::SILENCE_DB);
+    QVERIFY(!vad.isActive());
+
+    vad.reset();
+    QVERIFY(vad.isActive());
+    QCOMPARE(vad.noiseFloorDb(), VoiceActivityDetector::SILENCE_DB);
+}
+
+QTEST_APPLESS_MAIN(VoiceActivityDetectorTest)
+
+#include "tst_voice_activity_detector.moc"
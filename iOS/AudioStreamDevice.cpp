@@ -128,17 +128,18 @@ qint64 AudioStreamDevice::writeData(const char*, qint64)
 
 qint64 AudioStreamDevice::bytesAvailable() const
 {
-    const int availableNativeSamples = m_jitterBuffer->samplesInBuffer();
+    const int availableNativeSamples = m_jitterBuffer->samplesReadyForPlayback();
     const int bytesPerSample = (m_sampleFormat == QAudioFormat::Int16) ? sizeof(qint16) : sizeof(float);
 
 #if defined(Q_OS_IOS)
     // iOS prebuffering check: only log when prebuffering to monitor performance
     // Audio flows through normally to prevent silence issues
     const int minPrebufSamples = m_jitterBuffer->prebufSamples();
-    if (availableNativeSamples > 0 && availableNativeSamples < minPrebufSamples) {
+    const int bufferedNativeSamples = m_jitterBuffer->samplesInBuffer();
+    if (availableNativeSamples == 0 && bufferedNativeSamples > 0) {
         static int logCount = 0;
         if (++logCount <= 5) { // Only log first 5 times to avoid spam
-            qDebug() << "AudioStreamDevice: iOS prebuffering - have" << availableNativeSamples << "need" << minPrebufSamples;
+            qDebug() << "AudioStreamDevice: iOS prebuffering - have" << bufferedNativeSamples << "need" << minPrebufSamples;
         }
     }
 #endif
@@ -17,6 +17,7 @@
 
 #include "ReflectorClient.h"
 #include "ReflectorProtocol.h"
+#include "ReflectorCodec.h"
 #include <QMessageAuthenticationCode>
 #include <QCryptographicHash>
 #include <QAudioDevice>
@@ -268,40 +269,33 @@ void ReflectorClient::initializeAudioEngine()
     connect(this, &ReflectorClient::activityResumed, m_audioEngine, &AudioEngine::onActivityResumed);
 }
 
-void ReflectorClient::sendFrame(const QByteArray &payload)
+template <typename Message, typename... Values>
+void ReflectorClient::sendMessage(const Values &...values)
 {
     if (m_tcpSocket->state() != QAbstractSocket::ConnectedState) return;
-    QByteArray frame;
-    QDataStream stream(&frame, QIODevice::WriteOnly);
-    stream.setByteOrder(QDataStream::BigEndian);
-    stream << (uint32_t)payload.size();
-    frame.append(payload);
-    m_tcpSocket->write(frame);
+    const int frameBytes = Message::frameSize(values...);
+    if (frameBytes < 0) {
+        qWarning() << "ReflectorClient::sendMessage - Message type" << Message::TYPE
+                   << "has a field too long to encode, not sent";
+        return;
+    }
+    if (m_tcpSendBuffer.size() < frameBytes) {
+        m_tcpSendBuffer.resize(frameBytes);
+    }
+    Message::encodeFrame(m_tcpSendBuffer.data(), frameBytes, values...);
+    m_tcpSocket->write(m_tcpSendBuffer.constData(), frameBytes);
 }
 
 void ReflectorClient::sendProtoVer()
 {
-    QByteArray payload;
-    QDataStream stream(&payload, QIODevice::WriteOnly);
-    stream.setByteOrder(QDataStream::BigEndian);
-    stream << (quint16)Svxlink::MsgType::PROTO_VER;
-    stream << (quint16)Svxlink::Protocol::MAJOR_VER;
-    stream << (quint16)Svxlink::Protocol::MINOR_VER;
-    sendFrame(payload);
+    sendMessage<Svxlink::Codec::ProtoVer>(Svxlink::Protocol::MAJOR_VER, Svxlink::Protocol::MINOR_VER);
 }
 
 void ReflectorClient::sendAuthResponse(const QByteArray &hmac)
 {
-    QByteArray payload;
-    QDataStream stream(&payload, QIODevice::WriteOnly);
-    stream.setByteOrder(QDataStream::BigEndian);
-    QByteArray callsignData = m_callsign.toUtf8();
-    stream << (quint16)Svxlink::MsgType::AUTH_RESPONSE;
-    stream << (quint16)callsignData.size();
-    stream.writeRawData(callsignData.constData(), callsignData.size());
-    stream << (quint16)hmac.size();
-    stream.writeRawData(hmac.constData(), hmac.size());
-    sendFrame(payload);
+    const QByteArray callsignData = m_callsign.toUtf8();
+    sendMessage<Svxlink::Codec::AuthResponse>(Svxlink::Codec::bytesOf(callsignData),
+                                              Svxlink::Codec::bytesOf(hmac));
 }
 
 void ReflectorClient::sendNodeInfo()
@@ -317,33 +311,18 @@ void ReflectorClient::sendNodeInfo()
 #endif
     nodeInfoJson["Website"] = "https://latry.app";
     QJsonDocument doc(nodeInfoJson);
-    QByteArray jsonData = doc.toJson(QJsonDocument::Compact);
-    QByteArray payload;
-    QDataStream stream(&payload, QIODevice::WriteOnly);
-    stream.setByteOrder(QDataStream::BigEndian);
-    stream << (quint16)Svxlink::MsgType::NODE_INFO;
-    stream << (quint16)jsonData.size();
-    stream.writeRawData(jsonData.constData(), jsonData.size());
-    sendFrame(payload);
+    const QByteArray jsonData = doc.toJson(QJsonDocument::Compact);
+    sendMessage<Svxlink::Codec::NodeInfo>(Svxlink::Codec::bytesOf(jsonData));
 }
 
 void ReflectorClient::sendSelectTG(quint32 talkgroup)
 {
-    QByteArray payload;
-    QDataStream stream(&payload, QIODevice::WriteOnly);
-    stream.setByteOrder(QDataStream::BigEndian);
-    stream << (quint16)Svxlink::MsgType::SELECT_TG;
-    stream << talkgroup;
-    sendFrame(payload);
+    sendMessage<Svxlink::Codec::SelectTg>(talkgroup);
 }
 
 void ReflectorClient::sendHeartbeat()
 {
-    QByteArray payload;
-    QDataStream stream(&payload, QIODevice::WriteOnly);
-    stream.setByteOrder(QDataStream::BigEndian);
-    stream << (quint16)Svxlink::MsgType::HEARTBEAT;
-    sendFrame(payload);
+    sendMessage<Svxlink::Codec::Heartbeat>();
 }
 
 // --- UI and State Management ---
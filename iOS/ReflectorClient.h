@@ -133,7 +133,9 @@ private:
     ReflectorClient(const ReflectorClient&) = delete;
     ReflectorClient& operator=(const ReflectorClient&) = delete;
 
-    void sendFrame(const QByteArray &payload);
+    // Encodes a Svxlink::Codec message straight into m_tcpSendBuffer.
+    template <typename Message, typename... Values>
+    void sendMessage(const Values &...values);
     void sendProtoVer();
     void sendAuthResponse(const QByteArray &hmac);
     void sendNodeInfo();
@@ -179,6 +181,7 @@ private:
     QUdpSocket* m_udpSocket = nullptr;
     QTimer* m_heartbeatTimer = nullptr;
     QByteArray m_tcpBuffer;
+    QByteArray m_tcpSendBuffer;
     QString m_host;
     int m_port;
     QByteArray m_authKey;